@@ -0,0 +1,291 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "building-bvh.h"
+#include "building-list.h"
+#include "building.h"
+#include <ns3/log.h>
+#include <algorithm>
+#include <cmath>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("BuildingBvh");
+
+namespace {
+
+/// Most buildings in a leaf
+const uint32_t LEAF_SIZE = 4;
+
+/// Margin of the inner boxes in the line test, so rounding never prunes a
+/// subtree whose buildings the line touches
+const double LINE_MARGIN = 1e-6;
+
+/// Orders the boundaries by their center along an axis
+struct CenterLess
+{
+  CenterLess (int axis) : m_axis (axis) {}
+  double Center (const Box &b) const
+  {
+    switch (m_axis)
+      {
+      case 0:
+        return b.xMin + b.xMax;
+      case 1:
+        return b.yMin + b.yMax;
+      default:
+        return b.zMin + b.zMax;
+      }
+  }
+  bool operator() (const Box &a, const Box &b) const
+  {
+    return Center (a) < Center (b);
+  }
+  int m_axis;
+};
+
+bool
+Overlaps (const Box &a, const Box &b)
+{
+  return a.xMin <= b.xMax && b.xMin <= a.xMax
+    && a.yMin <= b.yMax && b.yMin <= a.yMax
+    && a.zMin <= b.zMax && b.zMin <= a.zMax;
+}
+
+} // anonymous namespace
+
+BuildingBvh::BuildingBvh ()
+  : m_nBuildings (0),
+    m_built (false)
+{
+}
+
+void
+BuildingBvh::Build (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_nodes.clear ();
+  m_boxes.clear ();
+  for (BuildingList::Iterator bit = BuildingList::Begin (); bit != BuildingList::End (); ++bit)
+    {
+      m_boxes.push_back ((*bit)->GetBoundaries ());
+    }
+  m_nBuildings = m_boxes.size ();
+  m_built = true;
+  if (!m_boxes.empty ())
+    {
+      m_nodes.reserve (2 * (m_boxes.size () / LEAF_SIZE + 1));
+      BuildNode (0, m_boxes.size ());
+    }
+  NS_LOG_LOGIC ("BVH of " << m_nBuildings << " buildings in " << m_nodes.size () << " nodes");
+}
+
+uint32_t
+BuildingBvh::BuildNode (uint32_t begin, uint32_t end)
+{
+  uint32_t index = m_nodes.size ();
+  m_nodes.push_back (Node ());
+  Box box = m_boxes[begin];
+  for (uint32_t i = begin + 1; i < end; ++i)
+    {
+      box.xMin = std::min (box.xMin, m_boxes[i].xMin);
+      box.xMax = std::max (box.xMax, m_boxes[i].xMax);
+      box.yMin = std::min (box.yMin, m_boxes[i].yMin);
+      box.yMax = std::max (box.yMax, m_boxes[i].yMax);
+      box.zMin = std::min (box.zMin, m_boxes[i].zMin);
+      box.zMax = std::max (box.zMax, m_boxes[i].zMax);
+    }
+  m_nodes[index].box = box;
+
+  if (end - begin <= LEAF_SIZE)
+    {
+      m_nodes[index].first = begin;
+      m_nodes[index].count = end - begin;
+      return index;
+    }
+
+  // split at the median along the longest side
+  int axis = 0;
+  double size = box.xMax - box.xMin;
+  if (box.yMax - box.yMin > size)
+    {
+      axis = 1;
+      size = box.yMax - box.yMin;
+    }
+  if (box.zMax - box.zMin > size)
+    {
+      axis = 2;
+    }
+  uint32_t middle = begin + (end - begin) / 2;
+  std::nth_element (m_boxes.begin () + begin, m_boxes.begin () + middle,
+                    m_boxes.begin () + end, CenterLess (axis));
+
+  BuildNode (begin, middle);
+  uint32_t second = BuildNode (middle, end);
+  m_nodes[index].first = second;
+  m_nodes[index].count = 0;
+  return index;
+}
+
+void
+BuildingBvh::Update (void) const
+{
+  if (!m_built || m_nBuildings != BuildingList::GetNBuildings ())
+    {
+      const_cast<BuildingBvh *> (this)->Build ();
+    }
+}
+
+uint32_t
+BuildingBvh::GetNBuildings (void) const
+{
+  Update ();
+  return m_nBuildings;
+}
+
+bool
+BuildingBvh::IsLineIntersectBox (const Vector &l1, const Vector &l2, const Box &box)
+{
+  Vector boxSize (0.5 * (box.xMax - box.xMin),
+                  0.5 * (box.yMax - box.yMin),
+                  0.5 * (box.zMax - box.zMin));
+  Vector boxCenter (box.xMin + boxSize.x,
+                    box.yMin + boxSize.y,
+                    box.zMin + boxSize.z);
+
+  // put the line in box space
+  Vector lb1 (l1.x - boxCenter.x, l1.y - boxCenter.y, l1.z - boxCenter.z);
+  Vector lb2 (l2.x - boxCenter.x, l2.y - boxCenter.y, l2.z - boxCenter.z);
+
+  // line midpoint and extent
+  Vector lMid (0.5 * (lb1.x + lb2.x), 0.5 * (lb1.y + lb2.y), 0.5 * (lb1.z + lb2.z));
+  Vector l (lb1.x - lMid.x, lb1.y - lMid.y, lb1.z - lMid.z);
+  Vector lExt (std::abs (l.x), std::abs (l.y), std::abs (l.z));
+
+  // separating axis test: the box axes, then the cross products of the line
+  // with each axis
+  if (std::abs (lMid.x) > boxSize.x + lExt.x)
+    {
+      return false;
+    }
+  if (std::abs (lMid.y) > boxSize.y + lExt.y)
+    {
+      return false;
+    }
+  if (std::abs (lMid.z) > boxSize.z + lExt.z)
+    {
+      return false;
+    }
+  if (std::abs (lMid.y * l.z - lMid.z * l.y) > (boxSize.y * lExt.z + boxSize.z * lExt.y))
+    {
+      return false;
+    }
+  if (std::abs (lMid.x * l.z - lMid.z * l.x) > (boxSize.x * lExt.z + boxSize.z * lExt.x))
+    {
+      return false;
+    }
+  if (std::abs (lMid.x * l.y - lMid.y * l.x) > (boxSize.x * lExt.y + boxSize.y * lExt.x))
+    {
+      return false;
+    }
+  return true;
+}
+
+bool
+BuildingBvh::IsLineIntersectBuildings (const Vector &l1, const Vector &l2) const
+{
+  Update ();
+  if (m_nodes.empty ())
+    {
+      return false;
+    }
+  uint32_t stack[64];
+  uint32_t top = 0;
+  stack[top++] = 0;
+  while (top > 0)
+    {
+      const Node &node = m_nodes[stack[--top]];
+      Box box = node.box;
+      box.xMin -= LINE_MARGIN;
+      box.xMax += LINE_MARGIN;
+      box.yMin -= LINE_MARGIN;
+      box.yMax += LINE_MARGIN;
+      box.zMin -= LINE_MARGIN;
+      box.zMax += LINE_MARGIN;
+      if (!IsLineIntersectBox (l1, l2, box))
+        {
+          continue;
+        }
+      if (node.count > 0)
+        {
+          for (uint32_t i = node.first; i < node.first + node.count; ++i)
+            {
+              if (IsLineIntersectBox (l1, l2, m_boxes[i]))
+                {
+                  return true;
+                }
+            }
+        }
+      else
+        {
+          // the depth is about log2 of the number of leaves
+          NS_ASSERT (top + 2 <= 64);
+          stack[top++] = node.first;
+          stack[top++] = &node - &m_nodes[0] + 1;
+        }
+    }
+  return false;
+}
+
+void
+BuildingBvh::GetBuildings (const Box &range, std::vector<Box> &boundaries) const
+{
+  Update ();
+  if (m_nodes.empty ())
+    {
+      return;
+    }
+  uint32_t stack[64];
+  uint32_t top = 0;
+  stack[top++] = 0;
+  while (top > 0)
+    {
+      const Node &node = m_nodes[stack[--top]];
+      if (!Overlaps (node.box, range))
+        {
+          continue;
+        }
+      if (node.count > 0)
+        {
+          for (uint32_t i = node.first; i < node.first + node.count; ++i)
+            {
+              if (Overlaps (m_boxes[i], range))
+                {
+                  boundaries.push_back (m_boxes[i]);
+                }
+            }
+        }
+      else
+        {
+          NS_ASSERT (top + 2 <= 64);
+          stack[top++] = node.first;
+          stack[top++] = &node - &m_nodes[0] + 1;
+        }
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,103 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef BUILDING_BVH_H_
+#define BUILDING_BVH_H_
+
+#include <vector>
+#include <ns3/box.h>
+#include <ns3/vector.h>
+
+namespace ns3 {
+
+/**
+ * \ingroup buildings
+ *
+ * Bounding volume hierarchy over the boundaries of the buildings in
+ * BuildingList, to find the buildings crossed by a line (e.g., to tell LOS
+ * from NLOS) without testing every building.
+ *
+ * The hierarchy is built on the first query, and built again when the number
+ * of buildings in BuildingList changes. Call Build () after changing the
+ * boundaries of a building already in the list.
+ */
+class BuildingBvh
+{
+public:
+  BuildingBvh ();
+
+  /**
+   * Build the hierarchy over the buildings currently in BuildingList.
+   */
+  void Build (void);
+
+  /**
+   * \return the number of buildings in the hierarchy
+   */
+  uint32_t GetNBuildings (void) const;
+
+  /**
+   * \param l1 first end of the line
+   * \param l2 second end of the line
+   * \return true if the line crosses the boundaries of any building
+   */
+  bool IsLineIntersectBuildings (const Vector &l1, const Vector &l2) const;
+
+  /**
+   * Find the buildings whose boundaries overlap a box, borders included.
+   *
+   * \param range the box to look up
+   * \param boundaries the boundaries of the buildings found are appended here
+   */
+  void GetBuildings (const Box &range, std::vector<Box> &boundaries) const;
+
+  /**
+   * Separating axis test of a line against a box.
+   *
+   * \param l1 first end of the line
+   * \param l2 second end of the line
+   * \param box the box
+   * \return true if the line crosses the box
+   */
+  static bool IsLineIntersectBox (const Vector &l1, const Vector &l2, const Box &box);
+
+private:
+  /// A node of the hierarchy, either inner (count == 0) or leaf
+  struct Node
+  {
+    Box box;         ///< union of the boundaries below this node
+    uint32_t first;  ///< inner: index of the second child (the first one follows this node); leaf: first building
+    uint32_t count;  ///< leaf: number of buildings
+  };
+
+  /// Build the hierarchy if BuildingList changed since the last build
+  void Update (void) const;
+  /**
+   * Build the subtree over m_boxes[begin, end)
+   * \return the index of its root node
+   */
+  uint32_t BuildNode (uint32_t begin, uint32_t end);
+
+  std::vector<Node> m_nodes;  ///< the nodes, in depth-first order
+  std::vector<Box> m_boxes;   ///< the boundaries of the buildings, in leaf order
+  uint32_t m_nBuildings;      ///< buildings in BuildingList at the last build
+  bool m_built;               ///< whether Build () was called
+};
+
+} // namespace ns3
+
+#endif /* BUILDING_BVH_H_ */
@@ -0,0 +1,82 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "building-los-cache.h"
+#include "building-list.h"
+#include <ns3/log.h>
+#include <ns3/assert.h>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("BuildingLosCache");
+
+BuildingLosCache::BuildingLosCache ()
+  : m_tolerance (0),
+    m_nBuildings (0)
+{
+}
+
+void
+BuildingLosCache::SetTolerance (double tolerance)
+{
+  NS_ASSERT_MSG (tolerance >= 0, "negative tolerance " << tolerance);
+  m_tolerance = tolerance;
+}
+
+double
+BuildingLosCache::GetTolerance (void) const
+{
+  return m_tolerance;
+}
+
+bool
+BuildingLosCache::Lookup (Ptr<const MobilityModel> a, Ptr<const MobilityModel> b, bool &blocked)
+{
+  if (m_nBuildings != BuildingList::GetNBuildings ())
+    {
+      Clear ();
+      m_nBuildings = BuildingList::GetNBuildings ();
+      return false;
+    }
+  std::map<Key, Entry>::const_iterator it = m_entries.find (std::make_pair (a, b));
+  if (it == m_entries.end ()
+      || CalculateDistance (a->GetPosition (), it->second.a) > m_tolerance
+      || CalculateDistance (b->GetPosition (), it->second.b) > m_tolerance)
+    {
+      return false;
+    }
+  blocked = it->second.blocked;
+  return true;
+}
+
+void
+BuildingLosCache::Store (Ptr<const MobilityModel> a, Ptr<const MobilityModel> b, bool blocked)
+{
+  Entry &entry = m_entries[std::make_pair (a, b)];
+  entry.a = a->GetPosition ();
+  entry.b = b->GetPosition ();
+  entry.blocked = blocked;
+}
+
+void
+BuildingLosCache::Clear (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_entries.clear ();
+}
+
+} // namespace ns3
@@ -0,0 +1,90 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef BUILDING_LOS_CACHE_H_
+#define BUILDING_LOS_CACHE_H_
+
+#include <map>
+#include <ns3/ptr.h>
+#include <ns3/vector.h>
+#include <ns3/mobility-model.h>
+
+namespace ns3 {
+
+/**
+ * \ingroup buildings
+ *
+ * Keeps whether the buildings block each link, so that the LOS/NLOS test of
+ * a link is only done again once one of its ends moved farther than a
+ * tolerance from where it was at the last test. With a tolerance of 0 the
+ * result is only reused while neither end moved. All the results are
+ * dropped when buildings are added to BuildingList.
+ */
+class BuildingLosCache
+{
+public:
+  BuildingLosCache ();
+
+  /**
+   * \param tolerance the distance in meters the ends of a link can move
+   * before its result is tested again
+   */
+  void SetTolerance (double tolerance);
+  /**
+   * \return the distance in meters the ends of a link can move before its
+   * result is tested again
+   */
+  double GetTolerance (void) const;
+
+  /**
+   * \param a the first end of the link
+   * \param b the second end of the link
+   * \param blocked set to the stored result, if any
+   * \return true if the stored result of the link still holds
+   */
+  bool Lookup (Ptr<const MobilityModel> a, Ptr<const MobilityModel> b, bool &blocked);
+  /**
+   * Store the result of the link at the current positions of its ends.
+   *
+   * \param a the first end of the link
+   * \param b the second end of the link
+   * \param blocked whether the buildings block the link
+   */
+  void Store (Ptr<const MobilityModel> a, Ptr<const MobilityModel> b, bool blocked);
+  /**
+   * Drop all the results.
+   */
+  void Clear (void);
+
+private:
+  /// The result of a link and where its ends were
+  struct Entry
+  {
+    Vector a;      ///< position of the first end
+    Vector b;      ///< position of the second end
+    bool blocked;  ///< whether the buildings block the link
+  };
+  typedef std::pair<Ptr<const MobilityModel>, Ptr<const MobilityModel> > Key;
+
+  std::map<Key, Entry> m_entries;  ///< the results by link
+  double m_tolerance;              ///< distance the ends can move, in meters
+  uint32_t m_nBuildings;           ///< buildings in BuildingList when the results were stored
+};
+
+} // namespace ns3
+
+#endif /* BUILDING_LOS_CACHE_H_ */
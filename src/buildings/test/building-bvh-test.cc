@@ -0,0 +1,211 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/log.h"
+#include "ns3/test.h"
+#include <ns3/building.h>
+#include <ns3/building-list.h>
+#include <ns3/building-bvh.h>
+#include <ns3/building-los-cache.h>
+#include <ns3/constant-position-mobility-model.h>
+#include <ns3/simulator.h>
+#include <cfloat>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("BuildingBvhTest");
+
+/**
+ * Checks the BVH queries against a test of every building, over a grid of
+ * city blocks and random lines between street level and rooftops.
+ */
+class BuildingBvhTestCase : public TestCase
+{
+public:
+  BuildingBvhTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /// Linear congruential generator, so that every run sees the same lines
+  double NextRandom (double max);
+
+  uint32_t m_seed;
+};
+
+BuildingBvhTestCase::BuildingBvhTestCase ()
+  : TestCase ("BVH queries match a test of every building"),
+    m_seed (1)
+{
+}
+
+double
+BuildingBvhTestCase::NextRandom (double max)
+{
+  m_seed = m_seed * 1103515245 + 12345;
+  return max * (m_seed >> 8) / (double) (1 << 24);
+}
+
+void
+BuildingBvhTestCase::DoRun ()
+{
+  // 20 x 20 blocks of 40 m with 10 m streets, of varying heights
+  for (uint32_t i = 0; i < 20; i++)
+    {
+      for (uint32_t j = 0; j < 20; j++)
+        {
+          Ptr<Building> b = CreateObject<Building> ();
+          b->SetBoundaries (Box (i * 50.0, i * 50.0 + 40, j * 50.0, j * 50.0 + 40,
+                                 0, 10 + (i * 7 + j * 3) % 30));
+        }
+    }
+  // a building on the street, sharing the borders of two blocks
+  Ptr<Building> b = CreateObject<Building> ();
+  b->SetBoundaries (Box (40, 50, 0, 40, 0, 5));
+
+  BuildingBvh bvh;
+  NS_TEST_ASSERT_MSG_EQ (bvh.GetNBuildings (), 401u, "wrong number of buildings");
+
+  uint32_t nBlocked = 0;
+  for (uint32_t n = 0; n < 2000; n++)
+    {
+      Vector l1 (NextRandom (1000), NextRandom (1000), NextRandom (45));
+      Vector l2 (NextRandom (1000), NextRandom (1000), NextRandom (45));
+      if (n % 4 == 0)
+        {
+          // along a street
+          l1.x = l2.x = 45;
+        }
+      bool blocked = false;
+      for (BuildingList::Iterator bit = BuildingList::Begin (); bit != BuildingList::End (); ++bit)
+        {
+          if (BuildingBvh::IsLineIntersectBox (l1, l2, (*bit)->GetBoundaries ()))
+            {
+              blocked = true;
+              break;
+            }
+        }
+      nBlocked += blocked;
+      NS_TEST_ASSERT_MSG_EQ (bvh.IsLineIntersectBuildings (l1, l2), blocked,
+                             "wrong LOS between " << l1 << " and " << l2);
+
+      Box range (std::min (l1.x, l2.x), std::max (l1.x, l2.x),
+                 std::min (l1.y, l2.y), std::max (l1.y, l2.y), -DBL_MAX, DBL_MAX);
+      uint32_t nOverlaps = 0;
+      for (BuildingList::Iterator bit = BuildingList::Begin (); bit != BuildingList::End (); ++bit)
+        {
+          Box boundaries = (*bit)->GetBoundaries ();
+          if (boundaries.xMin <= range.xMax && range.xMin <= boundaries.xMax
+              && boundaries.yMin <= range.yMax && range.yMin <= boundaries.yMax)
+            {
+              nOverlaps++;
+            }
+        }
+      std::vector<Box> found;
+      bvh.GetBuildings (range, found);
+      NS_TEST_ASSERT_MSG_EQ (found.size (), nOverlaps, "wrong buildings in " << range.xMin << " "
+                             << range.xMax << " " << range.yMin << " " << range.yMax);
+    }
+  // both cases should be common
+  NS_TEST_ASSERT_MSG_GT (nBlocked, 200u, "too few blocked lines");
+  NS_TEST_ASSERT_MSG_LT (nBlocked, 1800u, "too few lines in LOS");
+
+  // touching the border of the building on the street
+  NS_TEST_ASSERT_MSG_EQ (bvh.IsLineIntersectBuildings (Vector (45, 45, 0), Vector (45, 45, 100)), false,
+                         "line on the street should be in LOS");
+  NS_TEST_ASSERT_MSG_EQ (bvh.IsLineIntersectBuildings (Vector (45, 40, 0), Vector (45, 40, 100)), true,
+                         "line on the border of a building should be blocked");
+
+  // the BVH follows the buildings added later
+  Ptr<Building> tower = CreateObject<Building> ();
+  tower->SetBoundaries (Box (1000, 1010, 1000, 1010, 0, 100));
+  NS_TEST_ASSERT_MSG_EQ (bvh.IsLineIntersectBuildings (Vector (990, 1005, 50), Vector (1020, 1005, 50)), true,
+                         "line through the new building should be blocked");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * Checks that BuildingLosCache only keeps a result while the ends of the
+ * link stay within the tolerance.
+ */
+class BuildingLosCacheTestCase : public TestCase
+{
+public:
+  BuildingLosCacheTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+BuildingLosCacheTestCase::BuildingLosCacheTestCase ()
+  : TestCase ("LOS cache follows the moves of the ends of a link")
+{
+}
+
+void
+BuildingLosCacheTestCase::DoRun ()
+{
+  Ptr<ConstantPositionMobilityModel> a = CreateObject<ConstantPositionMobilityModel> ();
+  Ptr<ConstantPositionMobilityModel> b = CreateObject<ConstantPositionMobilityModel> ();
+  a->SetPosition (Vector (0, 0, 1.5));
+  b->SetPosition (Vector (100, 0, 10));
+
+  BuildingLosCache cache;
+  bool blocked = false;
+  NS_TEST_ASSERT_MSG_EQ (cache.Lookup (a, b, blocked), false, "empty cache should miss");
+  cache.Store (a, b, true);
+  NS_TEST_ASSERT_MSG_EQ (cache.Lookup (a, b, blocked), true, "link should be cached");
+  NS_TEST_ASSERT_MSG_EQ (blocked, true, "wrong cached result");
+  NS_TEST_ASSERT_MSG_EQ (cache.Lookup (b, a, blocked), false, "links are cached by direction");
+
+  // with no tolerance, any move drops the result
+  a->SetPosition (Vector (0.01, 0, 1.5));
+  NS_TEST_ASSERT_MSG_EQ (cache.Lookup (a, b, blocked), false, "moved link should miss");
+
+  cache.SetTolerance (1.0);
+  cache.Store (a, b, false);
+  a->SetPosition (Vector (0.5, 0.5, 1.5));
+  b->SetPosition (Vector (100, -0.9, 10));
+  NS_TEST_ASSERT_MSG_EQ (cache.Lookup (a, b, blocked), true, "link within the tolerance should hit");
+  NS_TEST_ASSERT_MSG_EQ (blocked, false, "wrong cached result");
+  b->SetPosition (Vector (100, -1.1, 10));
+  NS_TEST_ASSERT_MSG_EQ (cache.Lookup (a, b, blocked), false, "link past the tolerance should miss");
+
+  // new buildings drop every result
+  cache.Store (a, b, false);
+  NS_TEST_ASSERT_MSG_EQ (cache.Lookup (a, b, blocked), true, "link should be cached");
+  Ptr<Building> building = CreateObject<Building> ();
+  building->SetBoundaries (Box (40, 60, -10, 10, 0, 20));
+  NS_TEST_ASSERT_MSG_EQ (cache.Lookup (a, b, blocked), false, "new building should drop the results");
+
+  Simulator::Destroy ();
+}
+
+class BuildingBvhTestSuite : public TestSuite
+{
+public:
+  BuildingBvhTestSuite ();
+};
+
+BuildingBvhTestSuite::BuildingBvhTestSuite ()
+  : TestSuite ("building-bvh", UNIT)
+{
+  AddTestCase (new BuildingBvhTestCase, TestCase::QUICK);
+  AddTestCase (new BuildingLosCacheTestCase, TestCase::QUICK);
+}
+
+static BuildingBvhTestSuite buildingBvhTestSuiteInstance;
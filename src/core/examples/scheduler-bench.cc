@@ -0,0 +1,288 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <algorithm>
+#include <stdlib.h>
+#include "ns3/simulator.h"
+#include "ns3/nstime.h"
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/object-factory.h"
+#include "ns3/scheduler.h"
+#include "ns3/map-scheduler.h"
+#include "ns3/heap-scheduler.h"
+#include "ns3/list-scheduler.h"
+#include "ns3/calendar-scheduler.h"
+#include "ns3/ladder-scheduler.h"
+
+/**
+ * \file
+ * \ingroup scheduler
+ * Benchmark of the event schedulers on an event trace.
+ *
+ * The trace lists, in time order, when each event was scheduled and its
+ * delay, both in nanoseconds, one event per line:
+ * \verbatim
+   <time> <delay> \endverbatim
+ *
+ * Without --trace, a trace is made up after the events of NR cells:
+ * slots of 125 us, symbol events, data channel events 1 ns after each
+ * symbol and HARQ timers per UE. --record writes it to a file.
+ *
+ * Each scheduler runs the trace twice: once directly, inserting and
+ * removing the events, and once through Simulator::Schedule, which also
+ * allocates the events.
+ * Sample usage:  ./waf --run 'scheduler-bench --cells=10 --ues=20 --slots=8000'
+ */
+
+using namespace ns3;
+
+/** An event of the trace. */
+struct TraceEvent
+{
+  uint64_t time;   /**< When the event was scheduled, in ns. */
+  uint64_t delay;  /**< Delay of the event, in ns. */
+};
+
+/**
+ * Order trace events by the time they were scheduled.
+ *
+ * \param [in] a The first event.
+ * \param [in] b The second event.
+ * \returns \c true if \c a was scheduled before \c b
+ */
+static bool
+ScheduledBefore (const TraceEvent &a, const TraceEvent &b)
+{
+  return a.time < b.time;
+}
+
+/**
+ * Add an event to the trace.
+ *
+ * \param [in,out] trace The trace.
+ * \param [in] time When the event is scheduled.
+ * \param [in] delay The delay of the event.
+ */
+static void
+Add (std::vector<TraceEvent> &trace, uint64_t time, uint64_t delay)
+{
+  TraceEvent ev;
+  ev.time = time;
+  ev.delay = delay;
+  trace.push_back (ev);
+}
+
+/**
+ * Make up a trace of NR cells.
+ *
+ * \param [in] nCells The number of cells.
+ * \param [in] nUes The number of UEs per cell.
+ * \param [in] nSlots The number of slots.
+ * \returns The trace.
+ */
+static std::vector<TraceEvent>
+MakeNrTrace (uint32_t nCells, uint32_t nUes, uint32_t nSlots)
+{
+  const uint64_t slot = 125000;
+  const uint64_t symbol = slot / 14;
+  std::vector<TraceEvent> trace;
+  for (uint64_t s = 0; s < nSlots; s++)
+    {
+      for (uint32_t c = 0; c < nCells; c++)
+        {
+          uint64_t start = s * slot + c;
+          Add (trace, start, slot);
+          for (uint64_t k = 0; k < 14; k++)
+            {
+              Add (trace, start, k * symbol);
+              Add (trace, start + k * symbol, 1);
+            }
+          for (uint32_t u = 0; u < nUes; u++)
+            {
+              // reception of the data of a UE, then its HARQ feedback 4 slots later
+              uint64_t rx = start + (u % 14) * symbol + 1;
+              Add (trace, rx, symbol);
+              Add (trace, rx + symbol, 4 * slot);
+            }
+        }
+    }
+  std::stable_sort (trace.begin (), trace.end (), ScheduledBefore);
+  return trace;
+}
+
+/**
+ * Run the trace on a scheduler.
+ *
+ * \param [in] factory The scheduler factory.
+ * \param [in] trace The trace.
+ * \returns The time taken in ms.
+ */
+static int64_t
+RunScheduler (ObjectFactory factory, const std::vector<TraceEvent> &trace)
+{
+  Ptr<Scheduler> scheduler = factory.Create<Scheduler> ();
+  SystemWallClockMs time;
+  time.Start ();
+  uint32_t uid = 0;
+  for (std::vector<TraceEvent>::const_iterator i = trace.begin (); i != trace.end (); ++i)
+    {
+      while (!scheduler->IsEmpty () && scheduler->PeekNext ().key.m_ts <= i->time)
+        {
+          scheduler->RemoveNext ();
+        }
+      Scheduler::Event ev;
+      ev.impl = 0;
+      ev.key.m_ts = i->time + i->delay;
+      ev.key.m_uid = uid++;
+      ev.key.m_context = 0;
+      scheduler->Insert (ev);
+    }
+  while (!scheduler->IsEmpty ())
+    {
+      scheduler->RemoveNext ();
+    }
+  return time.End ();
+}
+
+/** The trace run by Replay. */
+static const std::vector<TraceEvent> *g_trace;
+
+/** The events of the trace. */
+static void
+Nothing (void)
+{
+}
+
+/**
+ * Schedule the events of the trace scheduled now, then the next Replay.
+ *
+ * \param [in] i The index in the trace of the first event scheduled now.
+ */
+static void
+Replay (uint32_t i)
+{
+  const std::vector<TraceEvent> &trace = *g_trace;
+  uint64_t now = trace[i].time;
+  for (; i < trace.size () && trace[i].time == now; i++)
+    {
+      Simulator::Schedule (NanoSeconds (trace[i].delay), &Nothing);
+    }
+  if (i < trace.size ())
+    {
+      Simulator::Schedule (NanoSeconds (trace[i].time - now), &Replay, i);
+    }
+}
+
+/**
+ * Run the trace through the simulator.
+ *
+ * \param [in] factory The scheduler factory.
+ * \param [in] trace The trace.
+ * \returns The time taken in ms.
+ */
+static int64_t
+RunSimulator (ObjectFactory factory, const std::vector<TraceEvent> &trace)
+{
+  Simulator::SetScheduler (factory);
+  g_trace = &trace;
+  SystemWallClockMs time;
+  time.Start ();
+  Simulator::Schedule (NanoSeconds (trace[0].time), &Replay, 0);
+  Simulator::Run ();
+  int64_t ms = time.End ();
+  Simulator::Destroy ();
+  return ms;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t nCells = 10;
+  uint32_t nUes = 20;
+  uint32_t nSlots = 8000;
+  bool list = false;
+  std::string traceFile;
+  std::string recordFile;
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark the event schedulers on an event trace");
+  cmd.AddValue ("cells", "number of cells of the NR trace", nCells);
+  cmd.AddValue ("ues", "number of UEs per cell of the NR trace", nUes);
+  cmd.AddValue ("slots", "number of slots of the NR trace", nSlots);
+  cmd.AddValue ("list", "also run the ListScheduler, which is slow with many events", list);
+  cmd.AddValue ("trace", "file of the trace to run instead of the NR trace", traceFile);
+  cmd.AddValue ("record", "file to write the trace to", recordFile);
+  cmd.Parse (argc, argv);
+
+  std::vector<TraceEvent> trace;
+  if (traceFile.empty ())
+    {
+      trace = MakeNrTrace (nCells, nUes, nSlots);
+    }
+  else
+    {
+      std::ifstream in (traceFile.c_str ());
+      if (!in.is_open ())
+        {
+          std::cerr << "Can't open file " << traceFile << std::endl;
+          exit (1);
+        }
+      TraceEvent ev;
+      while (in >> ev.time >> ev.delay)
+        {
+          trace.push_back (ev);
+        }
+      std::stable_sort (trace.begin (), trace.end (), ScheduledBefore);
+    }
+  if (trace.empty ())
+    {
+      std::cerr << "Empty trace" << std::endl;
+      exit (1);
+    }
+  if (!recordFile.empty ())
+    {
+      std::ofstream out (recordFile.c_str ());
+      for (std::vector<TraceEvent>::const_iterator i = trace.begin (); i != trace.end (); ++i)
+        {
+          out << i->time << " " << i->delay << "\n";
+        }
+    }
+
+  std::vector<TypeId> types;
+  if (list)
+    {
+      types.push_back (ListScheduler::GetTypeId ());
+    }
+  types.push_back (MapScheduler::GetTypeId ());
+  types.push_back (HeapScheduler::GetTypeId ());
+  types.push_back (CalendarScheduler::GetTypeId ());
+  types.push_back (LadderScheduler::GetTypeId ());
+
+  std::cout << trace.size () << " events" << std::endl;
+  for (std::vector<TypeId>::const_iterator i = types.begin (); i != types.end (); ++i)
+    {
+      ObjectFactory factory;
+      factory.SetTypeId (*i);
+      int64_t schedulerMs = RunScheduler (factory, trace);
+      int64_t simulatorMs = RunSimulator (factory, trace);
+      std::cout << i->GetName () << ": scheduler " << schedulerMs << " ms, simulator "
+                << simulatorMs << " ms" << std::endl;
+    }
+  return 0;
+}
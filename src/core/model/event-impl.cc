@@ -31,6 +31,69 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("EventImpl");
 
+namespace {
+
+/** Size step of the free lists, in bytes. */
+const std::size_t POOL_GRANULE = 16;
+/** Number of free lists: events up to 256 bytes are pooled. */
+const std::size_t POOL_CLASSES = 16;
+/** Most blocks kept in a free list; the others are freed. */
+const uint32_t POOL_MAX_FREE = 1024;
+
+/** A free block of a free list. */
+struct FreeBlock
+{
+  FreeBlock *next;  /**< The next free block. */
+};
+
+/**
+ * The free lists of the thread, by size. These are plain arrays, so that
+ * the events deleted while the thread exits still find them; the blocks
+ * left in the lists of a thread are not freed when it exits.
+ */
+thread_local FreeBlock *g_freeLists[POOL_CLASSES];
+/** The number of blocks in each free list of the thread. */
+thread_local uint32_t g_nFree[POOL_CLASSES];
+
+} // anonymous namespace
+
+void *
+EventImpl::operator new (std::size_t size)
+{
+  std::size_t i = (size - 1) / POOL_GRANULE;
+  if (i >= POOL_CLASSES)
+    {
+      return ::operator new (size);
+    }
+  FreeBlock *block = g_freeLists[i];
+  if (block == 0)
+    {
+      return ::operator new ((i + 1) * POOL_GRANULE);
+    }
+  g_freeLists[i] = block->next;
+  g_nFree[i]--;
+  return block;
+}
+
+void
+EventImpl::operator delete (void *p, std::size_t size)
+{
+  if (p == 0)
+    {
+      return;
+    }
+  std::size_t i = (size - 1) / POOL_GRANULE;
+  if (i >= POOL_CLASSES || g_nFree[i] >= POOL_MAX_FREE)
+    {
+      ::operator delete (p);
+      return;
+    }
+  FreeBlock *block = static_cast<FreeBlock *> (p);
+  block->next = g_freeLists[i];
+  g_freeLists[i] = block;
+  g_nFree[i]++;
+}
+
 EventImpl::~EventImpl ()
 {
   NS_LOG_FUNCTION (this);
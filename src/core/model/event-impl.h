@@ -21,6 +21,7 @@
 #define EVENT_IMPL_H
 
 #include <stdint.h>
+#include <cstddef>
 #include "simple-ref-count.h"
 
 /**
@@ -66,6 +67,26 @@ public:
    */
   bool IsCancelled (void);
 
+  /**
+   * Allocate the memory of an event.
+   *
+   * Small events, such as those made by MakeEvent(), are taken from
+   * free lists of the calling thread, sorted by size, so that scheduling
+   * an event does not usually call malloc.
+   *
+   * \param [in] size The size of the event.
+   * \returns The memory of the event.
+   */
+  static void * operator new (std::size_t size);
+  /**
+   * Release the memory of an event, into the free lists of the calling
+   * thread if it is small.
+   *
+   * \param [in] p The memory of the event.
+   * \param [in] size The size of the event.
+   */
+  static void operator delete (void *p, std::size_t size);
+
 protected:
   /**
    * Implementation for Invoke().
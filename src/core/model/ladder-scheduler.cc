@@ -0,0 +1,323 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ladder-scheduler.h"
+#include "event-impl.h"
+#include <algorithm>
+#include "assert.h"
+#include "log.h"
+
+/**
+ * \file
+ * \ingroup scheduler
+ * Implementation of ns3::LadderScheduler class.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("LadderScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED (LadderScheduler);
+
+namespace {
+
+/** Buckets with more events than this are split rather than sorted. */
+const uint32_t BUCKET_THRESHOLD = 50;
+/** Most rungs in the ladder. */
+const uint32_t MAX_RUNGS = 8;
+/** Most buckets in a rung. */
+const uint32_t MAX_BUCKETS = 65536;
+
+/**
+ * Compare (later than) two events, to keep Bottom sorted from the latest
+ * to the earliest.
+ *
+ * \param [in] a The first event.
+ * \param [in] b The second event.
+ * \returns \c true if \c a is later than \c b
+ */
+inline bool
+Later (const Scheduler::Event &a, const Scheduler::Event &b)
+{
+  return b.key < a.key;
+}
+
+} // anonymous namespace
+
+TypeId
+LadderScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::LadderScheduler")
+    .SetParent<Scheduler> ()
+    .SetGroupName ("Core")
+    .AddConstructor<LadderScheduler> ()
+  ;
+  return tid;
+}
+
+LadderScheduler::LadderScheduler ()
+  : m_topStart (0),
+    m_topMin (0),
+    m_topMax (0),
+    m_nRungs (0),
+    m_size (0)
+{
+  NS_LOG_FUNCTION (this);
+  // the rungs never move, so that Refill can hold on to their buckets
+  m_rungs.resize (MAX_RUNGS);
+  for (uint32_t i = 0; i < MAX_RUNGS; i++)
+    {
+      m_rungs[i].nBuckets = 0;
+      m_rungs[i].start = 0;
+      m_rungs[i].width = 1;
+      m_rungs[i].current = 0;
+      m_rungs[i].size = 0;
+    }
+}
+
+LadderScheduler::~LadderScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+uint32_t
+LadderScheduler::FindRung (uint64_t ts) const
+{
+  for (uint32_t i = 0; i < m_nRungs; i++)
+    {
+      const Rung &rung = m_rungs[i];
+      if (ts >= rung.start + rung.current * rung.width)
+        {
+          return i;
+        }
+    }
+  return m_nRungs;
+}
+
+void
+LadderScheduler::InsertBottom (const Event &ev)
+{
+  m_bottom.insert (std::upper_bound (m_bottom.begin (), m_bottom.end (), ev, Later), ev);
+
+  if (m_bottom.size () > BUCKET_THRESHOLD && m_nRungs < MAX_RUNGS
+      && m_bottom.front ().key.m_ts != m_bottom.back ().key.m_ts)
+    {
+      // move Bottom into a new rung, up to the start of the rung above
+      uint64_t end = m_topStart;
+      if (m_nRungs > 0)
+        {
+          const Rung &rung = m_rungs[m_nRungs - 1];
+          end = rung.start + rung.current * rung.width;
+        }
+      NS_LOG_LOGIC ("spawn rung " << m_nRungs << " from " << m_bottom.size () << " events in bottom");
+      SpawnRung (m_bottom, m_bottom.back ().key.m_ts, end);
+    }
+}
+
+void
+LadderScheduler::SpawnRung (std::vector<Event> &events, uint64_t start, uint64_t end)
+{
+  NS_LOG_FUNCTION (this << events.size () << start << end);
+  NS_ASSERT (m_nRungs < MAX_RUNGS);
+  NS_ASSERT (end > start);
+
+  uint64_t span = end - start;
+  uint64_t nBuckets = std::min<uint64_t> (std::max<uint64_t> (events.size (), 2), MAX_BUCKETS);
+  uint64_t width = span / nBuckets + (span % nBuckets != 0 ? 1 : 0);
+  nBuckets = span / width + (span % width != 0 ? 1 : 0);
+
+  Rung &rung = m_rungs[m_nRungs++];
+  if (rung.buckets.size () < nBuckets)
+    {
+      rung.buckets.resize (nBuckets);
+    }
+  rung.nBuckets = nBuckets;
+  rung.start = start;
+  rung.width = width;
+  rung.current = 0;
+  rung.size = events.size ();
+  for (std::vector<Event>::const_iterator i = events.begin (); i != events.end (); ++i)
+    {
+      NS_ASSERT (i->key.m_ts >= start && i->key.m_ts < end);
+      rung.buckets[(i->key.m_ts - start) / width].push_back (*i);
+    }
+  events.clear ();
+}
+
+void
+LadderScheduler::FillBottom (std::vector<Event> &events)
+{
+  NS_LOG_FUNCTION (this << events.size ());
+  NS_ASSERT (m_bottom.empty ());
+  // hand the storage of Bottom over to the bucket, rather than copying
+  m_bottom.swap (events);
+  std::sort (m_bottom.begin (), m_bottom.end (), Later);
+}
+
+void
+LadderScheduler::Refill (void)
+{
+  while (m_bottom.empty () && m_size > 0)
+    {
+      if (m_nRungs == 0)
+        {
+          NS_ASSERT (!m_top.empty ());
+          uint64_t end = m_topMax + 1;
+          m_topStart = end;
+          if (m_top.size () > BUCKET_THRESHOLD && m_topMax != m_topMin)
+            {
+              SpawnRung (m_top, m_topMin, end);
+            }
+          else
+            {
+              FillBottom (m_top);
+            }
+          continue;
+        }
+
+      Rung &rung = m_rungs[m_nRungs - 1];
+      if (rung.size == 0)
+        {
+          m_nRungs--;
+          continue;
+        }
+      while (rung.buckets[rung.current].empty ())
+        {
+          rung.current++;
+        }
+      Bucket &bucket = rung.buckets[rung.current];
+      uint64_t bucketStart = rung.start + rung.current * rung.width;
+      rung.current++;
+      rung.size -= bucket.size ();
+      if (bucket.size () > BUCKET_THRESHOLD && rung.width > 1 && m_nRungs < MAX_RUNGS)
+        {
+          SpawnRung (bucket, bucketStart, bucketStart + rung.width);
+        }
+      else
+        {
+          FillBottom (bucket);
+        }
+    }
+}
+
+void
+LadderScheduler::Insert (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  uint64_t ts = ev.key.m_ts;
+  if (ts >= m_topStart)
+    {
+      if (m_top.empty ())
+        {
+          m_topMin = ts;
+          m_topMax = ts;
+        }
+      else
+        {
+          m_topMin = std::min (m_topMin, ts);
+          m_topMax = std::max (m_topMax, ts);
+        }
+      m_top.push_back (ev);
+    }
+  else
+    {
+      uint32_t i = FindRung (ts);
+      if (i < m_nRungs)
+        {
+          Rung &rung = m_rungs[i];
+          rung.buckets[(ts - rung.start) / rung.width].push_back (ev);
+          rung.size++;
+        }
+      else
+        {
+          InsertBottom (ev);
+        }
+    }
+  m_size++;
+  Refill ();
+}
+
+bool
+LadderScheduler::IsEmpty (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_size == 0;
+}
+
+Scheduler::Event
+LadderScheduler::PeekNext (void) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+  return m_bottom.back ();
+}
+
+Scheduler::Event
+LadderScheduler::RemoveNext (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+  Event ev = m_bottom.back ();
+  m_bottom.pop_back ();
+  m_size--;
+  Refill ();
+  return ev;
+}
+
+void
+LadderScheduler::Remove (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  NS_ASSERT (!IsEmpty ());
+  uint64_t ts = ev.key.m_ts;
+  Bucket *bucket;
+  if (ts >= m_topStart)
+    {
+      bucket = &m_top;
+    }
+  else
+    {
+      uint32_t i = FindRung (ts);
+      if (i == m_nRungs)
+        {
+          std::vector<Event>::iterator it = std::lower_bound (m_bottom.begin (), m_bottom.end (), ev, Later);
+          NS_ASSERT (it != m_bottom.end () && it->key.m_uid == ev.key.m_uid);
+          m_bottom.erase (it);
+          m_size--;
+          Refill ();
+          return;
+        }
+      Rung &rung = m_rungs[i];
+      bucket = &rung.buckets[(ts - rung.start) / rung.width];
+      rung.size--;
+    }
+
+  for (Bucket::iterator it = bucket->begin (); it != bucket->end (); ++it)
+    {
+      if (it->key.m_uid == ev.key.m_uid)
+        {
+          NS_ASSERT (ev.impl == it->impl);
+          *it = bucket->back ();
+          bucket->pop_back ();
+          m_size--;
+          Refill ();
+          return;
+        }
+    }
+  NS_ASSERT (false);
+}
+
+} // namespace ns3
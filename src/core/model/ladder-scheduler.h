@@ -0,0 +1,141 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LADDER_SCHEDULER_H
+#define LADDER_SCHEDULER_H
+
+#include "scheduler.h"
+#include <stdint.h>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * Declaration of ns3::LadderScheduler class.
+ */
+
+namespace ns3 {
+
+class EventImpl;
+
+/**
+ * \ingroup scheduler
+ * \brief a ladder queue event scheduler
+ *
+ * This event scheduler implements the ladder queue described in
+ * "Ladder Queue: An O(1) Priority Queue Structure for Large-Scale
+ * Discrete Event Simulation" by W. T. Tang, R. S. M. Goh and
+ * I. L.-J. Thng (ACM TOMACS, 2005). The events are kept in three tiers:
+ *  - Top: an unsorted vector of the events farther than the ladder;
+ *  - the ladder: rungs of buckets, each rung splitting one bucket of
+ *    the rung above into thinner buckets, down to buckets small enough
+ *    to be sorted;
+ *  - Bottom: a sorted vector of the earliest events, from which the
+ *    events are removed.
+ *
+ * Unlike the CalendarScheduler, the ladder never resizes a whole tier:
+ * only the buckets about to be dequeued are split or sorted. It suits
+ * event lists with many events in a short horizon, e.g., slot and symbol
+ * events of NR simulations. The buckets are plain vectors whose storage
+ * is kept across rungs, so that the steady state does not allocate.
+ */
+class LadderScheduler : public Scheduler
+{
+public:
+  /**
+   *  Register this type.
+   *  \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  LadderScheduler ();
+  /** Destructor. */
+  virtual ~LadderScheduler ();
+
+  // Inherited
+  virtual void Insert (const Scheduler::Event &ev);
+  virtual bool IsEmpty (void) const;
+  virtual Scheduler::Event PeekNext (void) const;
+  virtual Scheduler::Event RemoveNext (void);
+  virtual void Remove (const Scheduler::Event &ev);
+
+private:
+  /** A bucket of a rung: unsorted Events. */
+  typedef std::vector<Scheduler::Event> Bucket;
+
+  /** A rung of the ladder. */
+  struct Rung
+  {
+    std::vector<Bucket> buckets;  /**< The buckets; only the first nBuckets are used. */
+    uint32_t nBuckets;            /**< Number of buckets in use. */
+    uint64_t start;               /**< Time of the start of the first bucket. */
+    uint64_t width;               /**< Duration of a bucket. */
+    uint32_t current;             /**< Index of the next bucket to dequeue. */
+    uint32_t size;                /**< Number of events in the rung. */
+  };
+
+  /**
+   * Find the rung of an event.
+   *
+   * \param [in] ts The time of the event.
+   * \returns The index of the rung, or m_nRungs for Bottom.
+   */
+  uint32_t FindRung (uint64_t ts) const;
+  /**
+   * Insert an Event into Bottom.
+   *
+   * \param [in] ev The Event.
+   */
+  void InsertBottom (const Scheduler::Event &ev);
+  /**
+   * Add a rung below the others and move events into it.
+   *
+   * \param [in,out] events The events, all in [start, end); emptied.
+   * \param [in] start The start of the rung.
+   * \param [in] end The end of the rung.
+   */
+  void SpawnRung (std::vector<Scheduler::Event> &events, uint64_t start, uint64_t end);
+  /**
+   * Sort events into Bottom.
+   *
+   * \param [in,out] events The events, all earlier than the ladder; emptied.
+   */
+  void FillBottom (std::vector<Scheduler::Event> &events);
+  /** Move the earliest events into Bottom, if it is empty. */
+  void Refill (void);
+
+  /** Top: the events at or after m_topStart, unsorted. */
+  std::vector<Scheduler::Event> m_top;
+  /** Start of Top. */
+  uint64_t m_topStart;
+  /** Earliest time in Top. */
+  uint64_t m_topMin;
+  /** Latest time in Top. */
+  uint64_t m_topMax;
+  /** The rungs, from the widest; only the first m_nRungs are used. */
+  std::vector<Rung> m_rungs;
+  /** Number of rungs in use. */
+  uint32_t m_nRungs;
+  /** Bottom: the earliest events, sorted from the latest to the earliest. */
+  std::vector<Scheduler::Event> m_bottom;
+  /** Number of events in the queue. */
+  uint32_t m_size;
+};
+
+} // namespace ns3
+
+#endif /* LADDER_SCHEDULER_H */
@@ -23,6 +23,9 @@
 #include "ns3/heap-scheduler.h"
 #include "ns3/map-scheduler.h"
 #include "ns3/calendar-scheduler.h"
+#include "ns3/ladder-scheduler.h"
+#include <set>
+#include <vector>
 
 using namespace ns3;
 
@@ -459,6 +462,102 @@ SimulatorTemplateTestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+class SchedulerOrderTestCase : public TestCase
+{
+public:
+  SchedulerOrderTestCase (ObjectFactory schedulerFactory);
+  virtual void DoRun (void);
+  uint32_t NextRandom (uint32_t max);
+  uint32_t m_seed;
+  ObjectFactory m_schedulerFactory;
+};
+
+SchedulerOrderTestCase::SchedulerOrderTestCase (ObjectFactory schedulerFactory)
+  : TestCase ("Check the order of many events with " +
+              schedulerFactory.GetTypeId ().GetName ()),
+    m_seed (1),
+    m_schedulerFactory (schedulerFactory)
+{
+}
+
+uint32_t
+SchedulerOrderTestCase::NextRandom (uint32_t max)
+{
+  m_seed = m_seed * 1103515245 + 12345;
+  return (m_seed >> 8) % max;
+}
+
+void
+SchedulerOrderTestCase::DoRun (void)
+{
+  // the events are never invoked, so they need no implementation
+  Ptr<Scheduler> scheduler = m_schedulerFactory.Create<Scheduler> ();
+  std::set<Scheduler::EventKey> expected;
+  std::vector<Scheduler::Event> inserted;
+  uint64_t now = 0;
+  uint32_t uid = 0;
+  for (uint32_t n = 0; n < 20000; n++)
+    {
+      // bursts of events at the same time, near events and far events
+      uint32_t count = NextRandom (4) == 0 ? 1 + NextRandom (100) : 1;
+      uint64_t delay;
+      switch (NextRandom (4))
+        {
+        case 0:
+          delay = NextRandom (2);
+          break;
+        case 1:
+          delay = NextRandom (125000);
+          break;
+        case 2:
+          delay = NextRandom (4) * 125000;
+          break;
+        default:
+          delay = NextRandom (1000000000);
+          break;
+        }
+      for (uint32_t i = 0; i < count; i++)
+        {
+          Scheduler::Event ev;
+          ev.impl = 0;
+          ev.key.m_ts = now + delay;
+          ev.key.m_uid = uid++;
+          ev.key.m_context = 0;
+          scheduler->Insert (ev);
+          expected.insert (ev.key);
+          inserted.push_back (ev);
+        }
+
+      if (NextRandom (8) == 0)
+        {
+          Scheduler::Event ev = inserted[NextRandom (inserted.size ())];
+          if (expected.erase (ev.key) != 0)
+            {
+              scheduler->Remove (ev);
+            }
+        }
+
+      uint32_t nRemoved = NextRandom (3) + count - 1;
+      for (uint32_t i = 0; i < nRemoved && !expected.empty (); i++)
+        {
+          Scheduler::Event next = scheduler->PeekNext ();
+          NS_TEST_ASSERT_MSG_EQ (next.key.m_uid, expected.begin ()->m_uid, "wrong next event");
+          Scheduler::Event ev = scheduler->RemoveNext ();
+          NS_TEST_ASSERT_MSG_EQ (ev.key.m_uid, expected.begin ()->m_uid, "wrong event removed");
+          now = ev.key.m_ts;
+          expected.erase (expected.begin ());
+        }
+      NS_TEST_ASSERT_MSG_EQ (scheduler->IsEmpty (), expected.empty (), "wrong emptiness");
+    }
+  while (!expected.empty ())
+    {
+      Scheduler::Event ev = scheduler->RemoveNext ();
+      NS_TEST_ASSERT_MSG_EQ (ev.key.m_uid, expected.begin ()->m_uid, "wrong event removed");
+      expected.erase (expected.begin ());
+    }
+  NS_TEST_ASSERT_MSG_EQ (scheduler->IsEmpty (), true, "events left");
+}
+
 class SimulatorTestSuite : public TestSuite
 {
 public:
@@ -475,5 +574,16 @@ public:
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
     factory.SetTypeId (CalendarScheduler::GetTypeId ());
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (LadderScheduler::GetTypeId ());
+    AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+
+    factory.SetTypeId (MapScheduler::GetTypeId ());
+    AddTestCase (new SchedulerOrderTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (HeapScheduler::GetTypeId ());
+    AddTestCase (new SchedulerOrderTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (CalendarScheduler::GetTypeId ());
+    AddTestCase (new SchedulerOrderTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (LadderScheduler::GetTypeId ());
+    AddTestCase (new SchedulerOrderTestCase (factory), TestCase::QUICK);
   }
 } g_simulatorTestSuite;
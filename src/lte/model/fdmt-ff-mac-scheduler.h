@@ -32,6 +32,7 @@
 #include <ns3/nstime.h>
 #include <ns3/lte-amc.h>
 #include <ns3/lte-ffr-sap.h>
+#include <ns3/ff-mac-rbg-allocator.h>
 
 // value for SINR outside the range defined by FF-API, used to indicate that there
 // is no CQI for this element
@@ -175,6 +176,11 @@ private:
 
   Ptr<LteAmc> m_amc;
 
+  /// Achievable rate metric of the DL RBG assignment.
+  typedef FfMacRateMetric<SbMeasResult_s, LteAmc, LteFfrSapProvider> DlRateMetric;
+  FfMacRbgAllocator<DlRateMetric> m_dlRbgAllocator; ///< DL RBG assignment, kept across TTIs.
+  DlRateMetric m_dlRbgMetric; ///< Metric of the DL RBG assignment.
+
   /*
    * Vectors of UE's LC info
   */
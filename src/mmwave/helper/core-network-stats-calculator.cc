@@ -21,6 +21,7 @@
 
 #include "core-network-stats-calculator.h"
 #include "ns3/string.h"
+#include "ns3/boolean.h"
 #include "ns3/nstime.h"
 #include <ns3/log.h>
 #include <vector>
@@ -33,6 +34,7 @@ NS_LOG_COMPONENT_DEFINE ("CoreNetworkStatsCalculator");
 NS_OBJECT_ENSURE_REGISTERED (CoreNetworkStatsCalculator);
 
 CoreNetworkStatsCalculator::CoreNetworkStatsCalculator ()
+  : m_binaryOutput (false)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -59,6 +61,12 @@ CoreNetworkStatsCalculator::GetTypeId (void)
                    StringValue ("MmeStats.txt"),
                    MakeStringAccessor (&CoreNetworkStatsCalculator::SetMmeOutputFilename),
                    MakeStringChecker ())
+    .AddAttribute ("BinaryOutput",
+                   "Write the packets in the columnar binary format of ColumnarTraceFile "
+                   "instead of text.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&CoreNetworkStatsCalculator::m_binaryOutput),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
@@ -74,12 +82,29 @@ CoreNetworkStatsCalculator::LogX2Packet (std::string path, uint16_t sourceCellId
 {
   NS_LOG_FUNCTION (this << "LogX2Packet" << sourceCellId << targetCellId << size << delay);
 
-  if (!m_x2OutFile.is_open ())
+  if (m_binaryOutput)
+    {
+      if (m_x2Columns == 0)
+        {
+          m_x2Columns = Create<ColumnarTraceFile> (GetX2OutputFilename ());
+          m_x2Columns->AddColumn ("time", ColumnarTraceFile::DOUBLE);
+          m_x2Columns->AddColumn ("sourceCellId", ColumnarTraceFile::UINT16);
+          m_x2Columns->AddColumn ("targetCellId", ColumnarTraceFile::UINT16);
+          m_x2Columns->AddColumn ("size", ColumnarTraceFile::UINT32);
+          m_x2Columns->AddColumn ("delay", ColumnarTraceFile::UINT64);
+          m_x2Columns->AddColumn ("data", ColumnarTraceFile::UINT8);
+        }
+      m_x2Columns->Put (Simulator::Now ().GetNanoSeconds () / 1.0e9).Put (sourceCellId).Put (targetCellId)
+        .Put (size).Put (delay).Put (data);
+      return;
+    }
+
+  if (m_x2OutFile == 0)
   {
-  	m_x2OutFile.open (GetX2OutputFilename ().c_str ());
+  	m_x2OutFile = AsyncTraceFile::Open (GetX2OutputFilename ());
   }
 
-  m_x2OutFile << Simulator::Now ().GetNanoSeconds () / 1.0e9 << " " << sourceCellId << " " << targetCellId << " " << size << " " << delay << " " << data << std::endl;
+  m_x2OutFile->GetStream () << Simulator::Now ().GetNanoSeconds () / 1.0e9 << " " << sourceCellId << " " << targetCellId << " " << size << " " << delay << " " << data << "\n";
 }
 
 void
@@ -87,12 +112,28 @@ CoreNetworkStatsCalculator::LogMmePacket (std::string path, uint16_t sourceCellI
 {
   NS_LOG_FUNCTION (this << "LogX2Packet" << sourceCellId << targetCellId << size << delay);
 
-  if (!m_mmeOutFile.is_open ())
+  if (m_binaryOutput)
+    {
+      if (m_mmeColumns == 0)
+        {
+          m_mmeColumns = Create<ColumnarTraceFile> (GetMmeOutputFilename ());
+          m_mmeColumns->AddColumn ("time", ColumnarTraceFile::DOUBLE);
+          m_mmeColumns->AddColumn ("sourceCellId", ColumnarTraceFile::UINT16);
+          m_mmeColumns->AddColumn ("targetCellId", ColumnarTraceFile::UINT16);
+          m_mmeColumns->AddColumn ("size", ColumnarTraceFile::UINT32);
+          m_mmeColumns->AddColumn ("delay", ColumnarTraceFile::UINT64);
+        }
+      m_mmeColumns->Put (Simulator::Now ().GetNanoSeconds () / 1.0e9).Put (sourceCellId).Put (targetCellId)
+        .Put (size).Put (delay);
+      return;
+    }
+
+  if (m_mmeOutFile == 0)
   {
-    m_mmeOutFile.open (GetMmeOutputFilename ().c_str ());
+    m_mmeOutFile = AsyncTraceFile::Open (GetMmeOutputFilename ());
   }
 
-  m_mmeOutFile << Simulator::Now ().GetNanoSeconds () / 1.0e9 << " " << sourceCellId << " " << targetCellId << " " << size << " " << delay << std::endl;
+  m_mmeOutFile->GetStream () << Simulator::Now ().GetNanoSeconds () / 1.0e9 << " " << sourceCellId << " " << targetCellId << " " << size << " " << delay << "\n";
 }
 
 std::string
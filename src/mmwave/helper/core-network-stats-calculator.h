@@ -29,7 +29,8 @@
 #include "ns3/lte-common.h"
 #include <string>
 #include <map>
-#include <fstream>
+#include "ns3/async-trace-file.h"
+#include "ns3/columnar-trace-file.h"
 
 namespace ns3 {
 
@@ -55,8 +56,12 @@ private:
   std::string m_mmeOutFileName;
   std::string m_x2OutFileName;
 
-  std::ofstream m_x2OutFile;
-  std::ofstream m_mmeOutFile;
+  Ptr<AsyncTraceFile> m_x2OutFile;
+  Ptr<AsyncTraceFile> m_mmeOutFile;
+
+  bool m_binaryOutput;                 ///< true if the packets are written in binary format
+  Ptr<ColumnarTraceFile> m_x2Columns;  ///< the X2 packets, in binary format
+  Ptr<ColumnarTraceFile> m_mmeColumns; ///< the S1-MME packets, in binary format
 
 };
 
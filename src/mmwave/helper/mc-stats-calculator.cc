@@ -42,18 +42,6 @@ McStatsCalculator::McStatsCalculator ()
 McStatsCalculator::~McStatsCalculator ()
 {
   NS_LOG_FUNCTION (this);
-  if(m_mmWaveOutFile.is_open())
-  {
-    m_mmWaveOutFile.close();
-  }
-  if(m_lteOutFile.is_open())
-  {
-    m_lteOutFile.close();
-  }
-  if(m_cellInTimeOutFile.is_open())
-  {
-    m_cellInTimeOutFile.close();
-  }
 }
 
 TypeId
@@ -131,18 +119,18 @@ McStatsCalculator::SwitchToLte (uint64_t imsi, uint16_t cellId, uint16_t rnti)
 {
   NS_LOG_FUNCTION (this << "SwitchToLte" << cellId << imsi << rnti);
 
-  if (!m_lteOutFile.is_open ())
+  if (m_lteOutFile == 0)
   {
-  	m_lteOutFile.open (GetLteOutputFilename ().c_str ());
+  	m_lteOutFile = AsyncTraceFile::Open (GetLteOutputFilename ());
   }
 
-  m_lteOutFile << "SwitchToLte " << Simulator::Now ().GetNanoSeconds () / 1.0e9 << " " << imsi << " " << cellId << " " << rnti << " " << std::endl;
+  m_lteOutFile->GetStream () << "SwitchToLte " << Simulator::Now ().GetNanoSeconds () / 1.0e9 << " " << imsi << " " << cellId << " " << rnti << " " << "\n";
 
-  if(!m_cellInTimeOutFile.is_open())
+  if (m_cellInTimeOutFile == 0)
   {
-    m_cellInTimeOutFile.open (GetCellIdInTimeOutputFilename().c_str());
+    m_cellInTimeOutFile = AsyncTraceFile::Open (GetCellIdInTimeOutputFilename());
   }
-  m_cellInTimeOutFile << Simulator::Now ().GetNanoSeconds () / 1.0e9 << " " << imsi << " " << cellId << " " << rnti << " " << std::endl;
+  m_cellInTimeOutFile->GetStream () << Simulator::Now ().GetNanoSeconds () / 1.0e9 << " " << imsi << " " << cellId << " " << rnti << " " << "\n";
 }
 
 void
@@ -150,18 +138,18 @@ McStatsCalculator::SwitchToMmWave (uint64_t imsi, uint16_t cellId, uint16_t rnti
 {
   NS_LOG_FUNCTION (this << "SwitchToMmWave " << cellId << imsi << rnti);
 
-  if (!m_mmWaveOutFile.is_open ())
+  if (m_mmWaveOutFile == 0)
   {
-    m_mmWaveOutFile.open (GetMmWaveOutputFilename ().c_str ());
+    m_mmWaveOutFile = AsyncTraceFile::Open (GetMmWaveOutputFilename ());
   }
 
-  m_mmWaveOutFile << "SwitchToMmWave " << Simulator::Now ().GetNanoSeconds () / 1.0e9 << " " << imsi << " " << cellId << " " << rnti << " " << std::endl;
+  m_mmWaveOutFile->GetStream () << "SwitchToMmWave " << Simulator::Now ().GetNanoSeconds () / 1.0e9 << " " << imsi << " " << cellId << " " << rnti << " " << "\n";
 
-  if(!m_cellInTimeOutFile.is_open())
+  if (m_cellInTimeOutFile == 0)
   {
-    m_cellInTimeOutFile.open (GetCellIdInTimeOutputFilename().c_str());
+    m_cellInTimeOutFile = AsyncTraceFile::Open (GetCellIdInTimeOutputFilename());
   }
-  m_cellInTimeOutFile << Simulator::Now ().GetNanoSeconds () / 1.0e9 << " " << imsi << " " << cellId << " " << rnti << " " << std::endl;
+  m_cellInTimeOutFile->GetStream () << Simulator::Now ().GetNanoSeconds () / 1.0e9 << " " << imsi << " " << cellId << " " << rnti << " " << "\n";
 }
 
 } // namespace ns3
@@ -28,7 +28,7 @@
 #include "ns3/lte-common.h"
 #include <string>
 #include <map>
-#include <fstream>
+#include "ns3/async-trace-file.h"
 
 namespace ns3
 {
@@ -82,9 +82,9 @@ private:
 
   std::string m_cellInTimeFilename;
 
-  std::ofstream m_lteOutFile;
-  std::ofstream m_mmWaveOutFile;
-  std::ofstream m_cellInTimeOutFile;
+  Ptr<AsyncTraceFile> m_lteOutFile;
+  Ptr<AsyncTraceFile> m_mmWaveOutFile;
+  Ptr<AsyncTraceFile> m_cellInTimeOutFile;
 };
 
 } // namespace ns3
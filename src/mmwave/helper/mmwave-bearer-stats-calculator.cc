@@ -32,6 +32,7 @@
 
 #include "mmwave-bearer-stats-calculator.h"
 #include "ns3/string.h"
+#include "ns3/boolean.h"
 #include "ns3/nstime.h"
 #include <ns3/log.h>
 #include <vector>
@@ -46,14 +47,16 @@ NS_OBJECT_ENSURE_REGISTERED ( MmWaveBearerStatsCalculator);
 MmWaveBearerStatsCalculator::MmWaveBearerStatsCalculator ()
   : m_firstWrite (true),
     m_pendingOutput (false), 
-    m_protocolType ("RLC")
+    m_protocolType ("RLC"),
+    m_binaryOutput (false)
 {
   NS_LOG_FUNCTION (this);
 }
 
 MmWaveBearerStatsCalculator::MmWaveBearerStatsCalculator (std::string protocolType)
   : m_firstWrite (true),
-    m_pendingOutput (false)
+    m_pendingOutput (false),
+    m_binaryOutput (false)
 {
   NS_LOG_FUNCTION (this);
   m_protocolType = protocolType;
@@ -101,10 +104,31 @@ MmWaveBearerStatsCalculator::GetTypeId (void)
                    StringValue ("UlPdcpStats.txt"),
                    MakeStringAccessor (&MmWaveBearerStatsCalculator::SetUlPdcpOutputFilename),
                    MakeStringChecker ())
+    .AddAttribute ("BinaryOutput",
+                   "Write the PDUs in the columnar binary format of ColumnarTraceFile "
+                   "instead of text.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&MmWaveBearerStatsCalculator::m_binaryOutput),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
 
+Ptr<ColumnarTraceFile>
+MmWaveBearerStatsCalculator::CreateColumns (std::string filename)
+{
+  Ptr<ColumnarTraceFile> columns = Create<ColumnarTraceFile> (filename);
+  columns->AddColumn ("type", ColumnarTraceFile::UINT8);
+  columns->AddColumn ("time", ColumnarTraceFile::DOUBLE);
+  columns->AddColumn ("cellId", ColumnarTraceFile::UINT16);
+  columns->AddColumn ("IMSI", ColumnarTraceFile::UINT64);
+  columns->AddColumn ("RNTI", ColumnarTraceFile::UINT16);
+  columns->AddColumn ("LCID", ColumnarTraceFile::UINT8);
+  columns->AddColumn ("size", ColumnarTraceFile::UINT32);
+  columns->AddColumn ("delay", ColumnarTraceFile::UINT64);
+  return columns;
+}
+
 void
 MmWaveBearerStatsCalculator::DoDispose ()
 {
@@ -146,22 +170,33 @@ MmWaveBearerStatsCalculator::UlTxPdu (uint16_t cellId, uint64_t imsi, uint16_t r
 {
   NS_LOG_FUNCTION (this << "UlTxPdu" << cellId << imsi << rnti << (uint32_t) lcid << packetSize);
 
-  if (!m_ulOutFile.is_open ())
+  if (m_binaryOutput)
+    {
+      if (m_ulColumns == 0)
+        {
+          m_ulColumns = CreateColumns (GetUlOutputFilename ());
+        }
+      m_ulColumns->Put (0).Put (Simulator::Now ().GetNanoSeconds () / 1.0e9).Put (cellId).Put (imsi)
+        .Put (rnti).Put (lcid).Put (packetSize).Put ((uint64_t) 0);
+      return;
+    }
+
+  if (m_ulOutFile == 0)
   {
-  	m_ulOutFile.open (GetUlOutputFilename ().c_str ());
+  	m_ulOutFile = AsyncTraceFile::Open (GetUlOutputFilename ());
   }
 
   // if (m_protocolType == "RLC")
   // {
-  // 	m_ulOutFile << "R ";
+  // 	m_ulOutFile->GetStream () << "R ";
   // }
   // else
   // {
-  // 	m_ulOutFile << "P ";
+  // 	m_ulOutFile->GetStream () << "P ";
   // }
 
-  m_ulOutFile << "Tx " << Simulator::Now ().GetNanoSeconds () / 1.0e9 << " "<< cellId << " "
-  		<< rnti << " " << (uint32_t) lcid << " " << packetSize << " " << std::endl;
+  m_ulOutFile->GetStream () << "Tx " << Simulator::Now ().GetNanoSeconds () / 1.0e9 << " "<< cellId << " "
+  		<< rnti << " " << (uint32_t) lcid << " " << packetSize << " " << "\n";
 
   /*ImsiLcidPair_t p (imsi, lcid);
   if (Simulator::Now () >= m_startTime)
@@ -179,22 +214,33 @@ MmWaveBearerStatsCalculator::DlTxPdu (uint16_t cellId, uint64_t imsi, uint16_t r
 {
   NS_LOG_FUNCTION (this << "DlTxPDU" << cellId << imsi << rnti << (uint32_t) lcid << packetSize);
 
-  if (!m_dlOutFile.is_open ())
+  if (m_binaryOutput)
+    {
+      if (m_dlColumns == 0)
+        {
+          m_dlColumns = CreateColumns (GetDlOutputFilename ());
+        }
+      m_dlColumns->Put (0).Put (Simulator::Now ().GetNanoSeconds () / 1.0e9).Put (cellId).Put (imsi)
+        .Put (rnti).Put (lcid).Put (packetSize).Put ((uint64_t) 0);
+      return;
+    }
+
+  if (m_dlOutFile == 0)
   {
-  	m_dlOutFile.open (GetDlOutputFilename ().c_str ());
+  	m_dlOutFile = AsyncTraceFile::Open (GetDlOutputFilename ());
   }
 
   // if (m_protocolType == "RLC")
   // {
-  // 	m_dlOutFile << "R ";
+  // 	m_dlOutFile->GetStream () << "R ";
   // }
   // else
   // {
-  // 	m_dlOutFile << "P ";
+  // 	m_dlOutFile->GetStream () << "P ";
   // }
 
-  m_dlOutFile << "Tx " << Simulator::Now ().GetNanoSeconds () / 1.0e9 << " "<< cellId << " "
-  		<< rnti << " " << (uint32_t) lcid << " " << packetSize << " " << std::endl;
+  m_dlOutFile->GetStream () << "Tx " << Simulator::Now ().GetNanoSeconds () / 1.0e9 << " "<< cellId << " "
+  		<< rnti << " " << (uint32_t) lcid << " " << packetSize << " " << "\n";
 
 
   /*ImsiLcidPair_t p (imsi, lcid);
@@ -214,22 +260,33 @@ MmWaveBearerStatsCalculator::UlRxPdu (uint16_t cellId, uint64_t imsi, uint16_t r
 {
   NS_LOG_FUNCTION (this << "UlRxPDU" << cellId << imsi << rnti << (uint32_t) lcid << packetSize << delay);
 
-  if (!m_ulOutFile.is_open ())
+  if (m_binaryOutput)
+    {
+      if (m_ulColumns == 0)
+        {
+          m_ulColumns = CreateColumns (GetUlOutputFilename ());
+        }
+      m_ulColumns->Put (1).Put (Simulator::Now ().GetNanoSeconds () / 1.0e9).Put (cellId).Put (imsi)
+        .Put (rnti).Put (lcid).Put (packetSize).Put (delay);
+      return;
+    }
+
+  if (m_ulOutFile == 0)
   {
-  	m_ulOutFile.open (GetUlOutputFilename ().c_str ());
+  	m_ulOutFile = AsyncTraceFile::Open (GetUlOutputFilename ());
   }
 
   // if (m_protocolType == "RLC")
   // {
-  // 	m_ulOutFile << "R ";
+  // 	m_ulOutFile->GetStream () << "R ";
   // }
   // else
   // {
-  // 	m_ulOutFile << "P ";
+  // 	m_ulOutFile->GetStream () << "P ";
   // }
 
-  m_ulOutFile << "Rx " << Simulator::Now ().GetNanoSeconds () / 1.0e9 << " "<< cellId << " "
-  		<< rnti << " " << (uint32_t) lcid << " " << packetSize << " " << delay << std::endl;
+  m_ulOutFile->GetStream () << "Rx " << Simulator::Now ().GetNanoSeconds () / 1.0e9 << " "<< cellId << " "
+  		<< rnti << " " << (uint32_t) lcid << " " << packetSize << " " << delay << "\n";
 
   /*ImsiLcidPair_t p (imsi, lcid);
   if (Simulator::Now () >= m_startTime)
@@ -256,22 +313,33 @@ MmWaveBearerStatsCalculator::DlRxPdu (uint16_t cellId, uint64_t imsi, uint16_t r
 {
   NS_LOG_FUNCTION (this << "DlRxPDU" << cellId << imsi << rnti << (uint32_t) lcid << packetSize << delay);
 
-  if (!m_dlOutFile.is_open ())
+  if (m_binaryOutput)
+    {
+      if (m_dlColumns == 0)
+        {
+          m_dlColumns = CreateColumns (GetDlOutputFilename ());
+        }
+      m_dlColumns->Put (1).Put (Simulator::Now ().GetNanoSeconds () / 1.0e9).Put (cellId).Put (imsi)
+        .Put (rnti).Put (lcid).Put (packetSize).Put (delay);
+      return;
+    }
+
+  if (m_dlOutFile == 0)
   {
-  	m_dlOutFile.open (GetDlOutputFilename ().c_str ());
+  	m_dlOutFile = AsyncTraceFile::Open (GetDlOutputFilename ());
   }
 
   // if (m_protocolType == "RLC")
   // {
-  // 	m_dlOutFile << "R ";
+  // 	m_dlOutFile->GetStream () << "R ";
   // }
   // else
   // {
-  // 	m_dlOutFile << "P ";
+  // 	m_dlOutFile->GetStream () << "P ";
   // }
 
-  m_dlOutFile << "Rx " << Simulator::Now ().GetNanoSeconds () / 1.0e9 << " "<< cellId << " "
-  		<< rnti << " " << (uint32_t) lcid << " " << packetSize << " " << delay << std::endl;
+  m_dlOutFile->GetStream () << "Rx " << Simulator::Now ().GetNanoSeconds () / 1.0e9 << " "<< cellId << " "
+  		<< rnti << " " << (uint32_t) lcid << " " << packetSize << " " << delay << "\n";
 
  /* ImsiLcidPair_t p (imsi, lcid);
   if (Simulator::Now () >= m_startTime)
@@ -300,59 +368,30 @@ MmWaveBearerStatsCalculator::ShowResults (void)
   NS_LOG_FUNCTION (this << GetUlOutputFilename ().c_str () << GetDlOutputFilename ().c_str ());
   NS_LOG_INFO ("Write Rlc Stats in " << GetUlOutputFilename ().c_str () << " and in " << GetDlOutputFilename ().c_str ());
 
-  std::ofstream ulOutFile;
-  std::ofstream dlOutFile;
+  Ptr<AsyncTraceFile> ulOutFile = AsyncTraceFile::Open (GetUlOutputFilename (), AsyncTraceFile::TEXT, !m_firstWrite);
+  Ptr<AsyncTraceFile> dlOutFile = AsyncTraceFile::Open (GetDlOutputFilename (), AsyncTraceFile::TEXT, !m_firstWrite);
 
   if (m_firstWrite == true)
     {
-      ulOutFile.open (GetUlOutputFilename ().c_str ());
-      if (!ulOutFile.is_open ())
-        {
-          NS_LOG_ERROR ("Can't open file " << GetUlOutputFilename ().c_str ());
-          return;
-        }
-
-      dlOutFile.open (GetDlOutputFilename ().c_str ());
-      if (!dlOutFile.is_open ())
-        {
-          NS_LOG_ERROR ("Can't open file " << GetDlOutputFilename ().c_str ());
-          return;
-        }
       m_firstWrite = false;
-      ulOutFile << "% start\tend\tCellId\tIMSI\tRNTI\tLCID\tnTxPDUs\tTxBytes\tnRxPDUs\tRxBytes\t";
-      ulOutFile << "delay\tstdDev\tmin\tmax\t";
-      ulOutFile << "PduSize\tstdDev\tmin\tmax";
-      ulOutFile << std::endl;
-      dlOutFile << "% start\tend\tCellId\tIMSI\tRNTI\tLCID\tnTxPDUs\tTxBytes\tnRxPDUs\tRxBytes\t";
-      dlOutFile << "delay\tstdDev\tmin\tmax\t";
-      dlOutFile << "PduSize\tstdDev\tmin\tmax";
-      dlOutFile << std::endl;
+      ulOutFile->GetStream () << "% start\tend\tCellId\tIMSI\tRNTI\tLCID\tnTxPDUs\tTxBytes\tnRxPDUs\tRxBytes\t";
+      ulOutFile->GetStream () << "delay\tstdDev\tmin\tmax\t";
+      ulOutFile->GetStream () << "PduSize\tstdDev\tmin\tmax";
+      ulOutFile->GetStream () << "\n";
+      dlOutFile->GetStream () << "% start\tend\tCellId\tIMSI\tRNTI\tLCID\tnTxPDUs\tTxBytes\tnRxPDUs\tRxBytes\t";
+      dlOutFile->GetStream () << "delay\tstdDev\tmin\tmax\t";
+      dlOutFile->GetStream () << "PduSize\tstdDev\tmin\tmax";
+      dlOutFile->GetStream () << "\n";
     }
-  else
-    {
-      ulOutFile.open (GetUlOutputFilename ().c_str (), std::ios_base::app);
-      if (!ulOutFile.is_open ())
-        {
-          NS_LOG_ERROR ("Can't open file " << GetUlOutputFilename ().c_str ());
-          return;
-        }
 
-      dlOutFile.open (GetDlOutputFilename ().c_str (), std::ios_base::app);
-      if (!dlOutFile.is_open ())
-        {
-          NS_LOG_ERROR ("Can't open file " << GetDlOutputFilename ().c_str ());
-          return;
-        }
-    }
-
-  WriteUlResults (ulOutFile);
-  WriteDlResults (dlOutFile);
+  WriteUlResults (ulOutFile->GetStream ());
+  WriteDlResults (dlOutFile->GetStream ());
   m_pendingOutput = false;
 
 }
 
 void
-MmWaveBearerStatsCalculator::WriteUlResults (std::ofstream& outFile)
+MmWaveBearerStatsCalculator::WriteUlResults (std::ostream& outFile)
 {
   NS_LOG_FUNCTION (this);
 
@@ -391,14 +430,12 @@ MmWaveBearerStatsCalculator::WriteUlResults (std::ofstream& outFile)
         {
           outFile << (*it) << "\t";
         }
-      outFile << std::endl;
+      outFile << "\n";
     }
-
-  outFile.close ();
 }
 
 void
-MmWaveBearerStatsCalculator::WriteDlResults (std::ofstream& outFile)
+MmWaveBearerStatsCalculator::WriteDlResults (std::ostream& outFile)
 {
   NS_LOG_FUNCTION (this);
 
@@ -436,10 +473,8 @@ MmWaveBearerStatsCalculator::WriteDlResults (std::ofstream& outFile)
         {
           outFile << (*it) << "\t";
         }
-      outFile << std::endl;
+      outFile << "\n";
     }
-
-  outFile.close ();
 }
 
 void
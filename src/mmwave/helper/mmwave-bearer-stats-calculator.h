@@ -37,7 +37,8 @@
 #include "ns3/lte-common.h"
 #include <string>
 #include <map>
-#include <fstream>
+#include "ns3/async-trace-file.h"
+#include "ns3/columnar-trace-file.h"
 
 namespace ns3
 {
@@ -355,6 +356,15 @@ public:
   GetDlPduSizeStats (uint64_t imsi, uint8_t lcid);
 
 private:
+  /**
+   * Open a binary PDU file and declare its columns; the type column is 0
+   * for a transmitted PDU and 1 for a received one.
+   * @param filename the name of the file
+   * @return the file
+   */
+  static Ptr<ColumnarTraceFile>
+  CreateColumns (std::string filename);
+
   /**
    * Called after each epoch to write collected
    * statistics to output files. During first call
@@ -367,18 +377,18 @@ private:
   /**
    * Writes collected statistics to UL output file and
    * closes UL output file.
-   * @param outFile ofstream for UL statistics
+   * @param outFile stream for UL statistics
    */
   void
-  WriteUlResults (std::ofstream& outFile);
+  WriteUlResults (std::ostream& outFile);
 
   /**
    * Writes collected statistics to DL output file and
    * closes DL output file.
-   * @param outFile ofstream for DL statistics
+   * @param outFile stream for DL statistics
    */
   void
-  WriteDlResults (std::ofstream& outFile);
+  WriteDlResults (std::ostream& outFile);
 
   /**
    * Erases collected statistics
@@ -454,8 +464,16 @@ private:
    */
   std::string m_ulPdcpOutputFilename;
 
-  std::ofstream m_dlOutFile;
-  std::ofstream m_ulOutFile;
+  Ptr<AsyncTraceFile> m_dlOutFile;
+  Ptr<AsyncTraceFile> m_ulOutFile;
+
+  /**
+   * true if the PDUs are written in the columnar binary format
+   */
+  bool m_binaryOutput;
+
+  Ptr<ColumnarTraceFile> m_dlColumns; ///< the downlink PDUs, in binary format
+  Ptr<ColumnarTraceFile> m_ulColumns; ///< the uplink PDUs, in binary format
 };
 
 } // namespace ns3
@@ -177,35 +177,6 @@ MmWaveBearerStatsConnector::MmWaveBearerStatsConnector ()
 MmWaveBearerStatsConnector::~MmWaveBearerStatsConnector ()
 {
   NS_LOG_FUNCTION (this);
-  if(m_enbHandoverStartOutFile.is_open())
-  {
-    m_enbHandoverStartOutFile.close();
-  }
-  if(m_ueHandoverStartOutFile.is_open())
-  {
-    m_ueHandoverStartOutFile.close();
-  }
-  if(m_enbHandoverEndOutFile.is_open())
-  {
-    m_enbHandoverEndOutFile.close();
-  }
-  if(m_ueHandoverEndOutFile.is_open())
-  {
-    m_ueHandoverEndOutFile.close();
-  }
-
-  if(m_cellIdInTimeHandoverOutFile.is_open())
-  {
-    m_cellIdInTimeHandoverOutFile.close();
-  }
-  if(m_mmWaveSinrOutFile.is_open())
-  {
-    m_mmWaveSinrOutFile.close();
-  }
-  if(m_lteSinrOutFile.is_open())
-  {
-    m_lteSinrOutFile.close();
-  }
 }
 
 TypeId
@@ -403,11 +374,11 @@ void
 MmWaveBearerStatsConnector::PrintMmWaveSinr (uint64_t imsi, uint16_t cellId, long double sinr)
 {
   NS_LOG_FUNCTION(this << " PrintMmWaveSinr " << Simulator::Now().GetSeconds());
-  if(!m_mmWaveSinrOutFile.is_open ())
+  if (m_mmWaveSinrOutFile == 0)
   {
-    m_mmWaveSinrOutFile.open(GetMmWaveSinrOutputFilename() .c_str());
+    m_mmWaveSinrOutFile = AsyncTraceFile::Open (GetMmWaveSinrOutputFilename());
   }
-  m_mmWaveSinrOutFile << Simulator::Now().GetNanoSeconds()/1.0e9 << " " << imsi << " " << cellId << " " << 10*std::log10(sinr) << std::endl;
+  m_mmWaveSinrOutFile->GetStream () << Simulator::Now().GetNanoSeconds()/1.0e9 << " " << imsi << " " << cellId << " " << 10*std::log10(sinr) << "\n";
 }
 
 void 
@@ -420,11 +391,11 @@ void
 MmWaveBearerStatsConnector::PrintLteSinr (uint16_t rnti, uint16_t cellId, double sinr)
 {
   NS_LOG_FUNCTION(this << " PrintLteSinr " << Simulator::Now().GetSeconds());
-  if(!m_lteSinrOutFile.is_open ())
+  if (m_lteSinrOutFile == 0)
   {
-    m_lteSinrOutFile.open(GetLteSinrOutputFilename() .c_str());
+    m_lteSinrOutFile = AsyncTraceFile::Open (GetLteSinrOutputFilename());
   }
-  m_lteSinrOutFile << Simulator::Now().GetNanoSeconds()/1.0e9 << " " << rnti << " " << cellId << " " << sinr << std::endl;
+  m_lteSinrOutFile->GetStream () << Simulator::Now().GetNanoSeconds()/1.0e9 << " " << rnti << " " << cellId << " " << sinr << "\n";
 }
 
 std::string 
@@ -513,50 +484,50 @@ void
 MmWaveBearerStatsConnector::PrintEnbStartHandover(uint64_t imsi, uint16_t sourceCellid, uint16_t targetCellId, uint16_t rnti)
 {
   NS_LOG_FUNCTION(this << " NotifyHandoverStartEnb " << Simulator::Now().GetSeconds());
-  if(!m_enbHandoverStartOutFile.is_open ())
+  if (m_enbHandoverStartOutFile == 0)
   {
-    m_enbHandoverStartOutFile.open(GetEnbHandoverStartOutputFilename() .c_str());
+    m_enbHandoverStartOutFile = AsyncTraceFile::Open (GetEnbHandoverStartOutputFilename());
   }
-  m_enbHandoverStartOutFile << Simulator::Now().GetNanoSeconds()/1.0e9 << " " << imsi << " " << rnti << " " << sourceCellid << " " << targetCellId << std::endl;
+  m_enbHandoverStartOutFile->GetStream () << Simulator::Now().GetNanoSeconds()/1.0e9 << " " << imsi << " " << rnti << " " << sourceCellid << " " << targetCellId << "\n";
 }
 
 void 
 MmWaveBearerStatsConnector::PrintEnbEndHandover(uint64_t imsi, uint16_t targetCellId, uint16_t rnti)
 {
   NS_LOG_FUNCTION("NotifyHandoverOkEnb " << Simulator::Now().GetSeconds());
-  if(!m_enbHandoverEndOutFile.is_open ())
+  if (m_enbHandoverEndOutFile == 0)
   {
-    m_enbHandoverEndOutFile.open(GetEnbHandoverEndOutputFilename() .c_str());
+    m_enbHandoverEndOutFile = AsyncTraceFile::Open (GetEnbHandoverEndOutputFilename());
   }
-  m_enbHandoverEndOutFile << Simulator::Now().GetNanoSeconds()/1.0e9 << " " << imsi << " " << rnti << " " << targetCellId << std::endl;
+  m_enbHandoverEndOutFile->GetStream () << Simulator::Now().GetNanoSeconds()/1.0e9 << " " << imsi << " " << rnti << " " << targetCellId << "\n";
 }
 
 void 
 MmWaveBearerStatsConnector::PrintUeStartHandover(uint64_t imsi, uint16_t sourceCellid, uint16_t targetCellId, uint16_t rnti)
 {
   NS_LOG_FUNCTION("NotifyHandoverStartUe " << Simulator::Now().GetSeconds());
-  if(!m_ueHandoverStartOutFile.is_open ())
+  if (m_ueHandoverStartOutFile == 0)
   {
-    m_ueHandoverStartOutFile.open(GetUeHandoverStartOutputFilename() .c_str());
+    m_ueHandoverStartOutFile = AsyncTraceFile::Open (GetUeHandoverStartOutputFilename());
   }
-  m_ueHandoverStartOutFile << Simulator::Now().GetNanoSeconds()/1.0e9 << " " << imsi << " " << rnti << " " << sourceCellid << " " << targetCellId << std::endl;
+  m_ueHandoverStartOutFile->GetStream () << Simulator::Now().GetNanoSeconds()/1.0e9 << " " << imsi << " " << rnti << " " << sourceCellid << " " << targetCellId << "\n";
 }
 
 void 
 MmWaveBearerStatsConnector::PrintUeEndHandover(uint64_t imsi, uint16_t targetCellId, uint16_t rnti)
 {
   NS_LOG_FUNCTION("NotifyHandoverOkUe " << Simulator::Now().GetSeconds());
-  if(!m_ueHandoverEndOutFile.is_open ())
+  if (m_ueHandoverEndOutFile == 0)
   {
-    m_ueHandoverEndOutFile.open(GetUeHandoverEndOutputFilename() .c_str());
+    m_ueHandoverEndOutFile = AsyncTraceFile::Open (GetUeHandoverEndOutputFilename());
   }
-  m_ueHandoverEndOutFile << Simulator::Now().GetNanoSeconds()/1.0e9 << " " << imsi << " " << rnti << " " << targetCellId << std::endl;
+  m_ueHandoverEndOutFile->GetStream () << Simulator::Now().GetNanoSeconds()/1.0e9 << " " << imsi << " " << rnti << " " << targetCellId << "\n";
 
-  if(!m_cellIdInTimeHandoverOutFile.is_open ())
+  if (m_cellIdInTimeHandoverOutFile == 0)
   {
-    m_cellIdInTimeHandoverOutFile.open(GetCellIdStatsOutputFilename() .c_str());
+    m_cellIdInTimeHandoverOutFile = AsyncTraceFile::Open (GetCellIdStatsOutputFilename());
   }
-  m_cellIdInTimeHandoverOutFile << Simulator::Now().GetNanoSeconds()/1.0e9 << " " << imsi << " " << rnti << " " << targetCellId << std::endl;
+  m_cellIdInTimeHandoverOutFile->GetStream () << Simulator::Now().GetNanoSeconds()/1.0e9 << " " << imsi << " " << rnti << " " << targetCellId << "\n";
 }
 
 void 
@@ -39,7 +39,7 @@
 #include <ns3/simple-ref-count.h>
 #include <ns3/ptr.h>
 #include "mc-stats-calculator.h"
-#include <fstream>
+#include "ns3/async-trace-file.h"
 #include "ns3/object.h"
 #include <string>
 
@@ -360,13 +360,13 @@ private:
   std::string m_mmWaveSinrOutputFilename;
   std::string m_lteSinrOutputFilename;
 
-  std::ofstream m_enbHandoverStartOutFile;
-  std::ofstream  m_ueHandoverStartOutFile;
-  std::ofstream m_enbHandoverEndOutFile;
-  std::ofstream  m_ueHandoverEndOutFile;
-  std::ofstream m_cellIdInTimeHandoverOutFile;
-  std::ofstream m_mmWaveSinrOutFile;
-  std::ofstream m_lteSinrOutFile;
+  Ptr<AsyncTraceFile> m_enbHandoverStartOutFile;
+  Ptr<AsyncTraceFile> m_ueHandoverStartOutFile;
+  Ptr<AsyncTraceFile> m_enbHandoverEndOutFile;
+  Ptr<AsyncTraceFile> m_ueHandoverEndOutFile;
+  Ptr<AsyncTraceFile> m_cellIdInTimeHandoverOutFile;
+  Ptr<AsyncTraceFile> m_mmWaveSinrOutFile;
+  Ptr<AsyncTraceFile> m_lteSinrOutFile;
 };
 
 
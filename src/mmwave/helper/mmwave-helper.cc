@@ -39,6 +39,7 @@
 #include <string>
 #include <sstream>
 #include "mmwave-helper.h"
+#include "mmwave-partition-helper.h"
 #include <ns3/abort.h>
 #include <ns3/multi-model-spectrum-channel.h>
 #include <ns3/uinteger.h>
@@ -1646,7 +1647,11 @@ MmWaveHelper::InstallSingleEnbDevice (Ptr<Node> n)
 
 	device->Initialize ();
 
-	m_channel->AddRx (dlPhy);
+	if (MmWavePartitionHelper::IsLocal (n))
+	{
+		// the cells of other ranks of a distributed simulation are not on the channel
+		m_channel->AddRx (dlPhy);
+	}
 
 
 	if (m_epcHelper != 0)
@@ -1882,7 +1887,11 @@ MmWaveHelper::InstallSingleEnbDevice_2 (Ptr<Node> n)
 
 	device->Initialize ();
 
-	m_channel_2->AddRx (dlPhy);
+	if (MmWavePartitionHelper::IsLocal (n))
+	{
+		// the cells of other ranks of a distributed simulation are not on the channel
+		m_channel_2->AddRx (dlPhy);
+	}
 
 
 	if (m_epcHelper != 0)
@@ -0,0 +1,359 @@
+ /* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+ /*
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <ns3/log.h>
+#include <ns3/abort.h>
+#include <ns3/simulator.h>
+#include <ns3/packet.h>
+#include <ns3/mobility-model.h>
+#include <ns3/mpi-interface.h>
+#include <ns3/point-to-point-helper.h>
+#include <ns3/data-rate.h>
+#include <ns3/mmwave-enb-net-device.h>
+#include <ns3/mmwave-ue-net-device.h>
+#include <ns3/mc-ue-net-device.h>
+#include <ns3/mmwave-enb-phy.h>
+#include <ns3/mmwave-ue-phy.h>
+#include <ns3/mmwave-spectrum-phy.h>
+#include <ns3/mmwave-spectrum-value-helper.h>
+#include "mmwave-partition-helper.h"
+#include <algorithm>
+#include <cstring>
+#include <cfloat>
+#include <cmath>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("MmWavePartitionHelper");
+
+NS_OBJECT_ENSURE_REGISTERED (MmWavePartitionHelper);
+
+namespace {
+
+/// Protocol number of the interference messages; the anchor nodes have no IP stack
+const uint16_t INTERFERENCE_PROTOCOL = 0x0800;
+
+/// Orders eNB indices by their position along an axis
+struct PositionLess
+{
+	PositionLess (const std::vector<Vector> &positions, bool alongX)
+		: m_positions (positions), m_alongX (alongX) {}
+	bool operator() (uint32_t a, uint32_t b) const
+	{
+		return m_alongX ? m_positions[a].x < m_positions[b].x : m_positions[a].y < m_positions[b].y;
+	}
+	const std::vector<Vector> &m_positions;
+	bool m_alongX;
+};
+
+} // anonymous namespace
+
+MmWavePartitionHelper::MmWavePartitionHelper ()
+{
+	NS_LOG_FUNCTION (this);
+}
+
+MmWavePartitionHelper::~MmWavePartitionHelper ()
+{
+	NS_LOG_FUNCTION (this);
+}
+
+TypeId
+MmWavePartitionHelper::GetTypeId (void)
+{
+	static TypeId tid = TypeId ("ns3::MmWavePartitionHelper")
+		.SetParent<Object> ()
+		.AddConstructor<MmWavePartitionHelper> ()
+	;
+	return tid;
+}
+
+void
+MmWavePartitionHelper::DoDispose (void)
+{
+	NS_LOG_FUNCTION (this);
+	m_enbDevices = NetDeviceContainer ();
+	m_localUePhys.clear ();
+	m_pathloss = 0;
+	m_spectrumModel = 0;
+	m_slotEnergy.clear ();
+	m_remoteDevices = NetDeviceContainer ();
+	Object::DoDispose ();
+}
+
+uint32_t
+MmWavePartitionHelper::GetNRanks (void) const
+{
+	return MpiInterface::IsEnabled () ? MpiInterface::GetSize () : 1;
+}
+
+void
+MmWavePartitionHelper::SetEnbPositions (const std::vector<Vector> &positions)
+{
+	NS_LOG_FUNCTION (this << positions.size ());
+	m_enbPositions = positions;
+	m_enbRanks.assign (positions.size (), 0);
+	std::vector<uint32_t> enbs (positions.size ());
+	for (uint32_t i = 0; i < enbs.size (); i++)
+	{
+		enbs[i] = i;
+	}
+	Partition (enbs, 0, enbs.size (), 0, GetNRanks ());
+}
+
+void
+MmWavePartitionHelper::Partition (std::vector<uint32_t> &enbs, uint32_t begin, uint32_t end,
+                                  uint32_t firstRank, uint32_t nRanks)
+{
+	if (nRanks == 1 || end - begin <= 1)
+	{
+		for (uint32_t i = begin; i < end; i++)
+		{
+			m_enbRanks[enbs[i]] = firstRank;
+		}
+		return;
+	}
+
+	// cut the cells along the longest side of their bounding box, with as many
+	// cells on each side as ranks
+	double xMin = DBL_MAX, xMax = -DBL_MAX, yMin = DBL_MAX, yMax = -DBL_MAX;
+	for (uint32_t i = begin; i < end; i++)
+	{
+		const Vector &p = m_enbPositions[enbs[i]];
+		xMin = std::min (xMin, p.x);
+		xMax = std::max (xMax, p.x);
+		yMin = std::min (yMin, p.y);
+		yMax = std::max (yMax, p.y);
+	}
+	uint32_t firstRanks = nRanks / 2;
+	uint32_t middle = begin + (uint64_t)(end - begin) * firstRanks / nRanks;
+	std::nth_element (enbs.begin () + begin, enbs.begin () + middle, enbs.begin () + end,
+	                  PositionLess (m_enbPositions, xMax - xMin >= yMax - yMin));
+	Partition (enbs, begin, middle, firstRank, firstRanks);
+	Partition (enbs, middle, end, firstRank + firstRanks, nRanks - firstRanks);
+}
+
+uint32_t
+MmWavePartitionHelper::GetEnbRank (uint32_t i) const
+{
+	NS_ASSERT (i < m_enbRanks.size ());
+	return m_enbRanks[i];
+}
+
+uint32_t
+MmWavePartitionHelper::GetRank (const Vector &position) const
+{
+	NS_ABORT_MSG_IF (m_enbPositions.empty (), "SetEnbPositions must be called first");
+	uint32_t nearest = 0;
+	double minDistance = DBL_MAX;
+	for (uint32_t i = 0; i < m_enbPositions.size (); i++)
+	{
+		double distance = CalculateDistance (position, m_enbPositions[i]);
+		if (distance < minDistance)
+		{
+			minDistance = distance;
+			nearest = i;
+		}
+	}
+	return m_enbRanks[nearest];
+}
+
+NodeContainer
+MmWavePartitionHelper::CreateEnbNodes (void) const
+{
+	NodeContainer nodes;
+	for (uint32_t i = 0; i < m_enbRanks.size (); i++)
+	{
+		nodes.Add (CreateObject<Node> (m_enbRanks[i]));
+	}
+	return nodes;
+}
+
+Ptr<Node>
+MmWavePartitionHelper::CreateUeNode (const Vector &position) const
+{
+	return CreateObject<Node> (GetRank (position));
+}
+
+bool
+MmWavePartitionHelper::IsLocal (Ptr<const Node> node)
+{
+	return !MpiInterface::IsEnabled () || node->GetSystemId () == MpiInterface::GetSystemId ();
+}
+
+void
+MmWavePartitionHelper::EnableRemoteInterference (NetDeviceContainer enbDevices, NetDeviceContainer ueDevices,
+                                                 Ptr<PropagationLossModel> pathloss)
+{
+	NS_LOG_FUNCTION (this);
+	NS_ABORT_MSG_IF (enbDevices.GetN () != m_enbRanks.size (), "One eNB device per eNB position is needed");
+	NS_ABORT_MSG_IF (enbDevices.GetN () == 0, "No eNB devices");
+	uint32_t nRanks = GetNRanks ();
+	if (nRanks == 1)
+	{
+		return;
+	}
+
+	m_enbDevices = enbDevices;
+	m_pathloss = pathloss;
+	Ptr<MmWavePhyMacCommon> config = DynamicCast<MmWaveEnbNetDevice> (enbDevices.Get (0))->GetPhy ()->GetConfigurationParameters ();
+	m_slotPeriod = Seconds (config->GetTti ());
+	m_spectrumModel = MmWaveSpectrumValueHelper::GetSpectrumModel (config);
+
+	m_slotEnergy.assign (enbDevices.GetN (), 0);
+	for (uint32_t i = 0; i < enbDevices.GetN (); i++)
+	{
+		Ptr<MmWaveEnbNetDevice> enb = DynamicCast<MmWaveEnbNetDevice> (enbDevices.Get (i));
+		NS_ABORT_MSG_IF (enb == 0, "Not an mmWave eNB device");
+		if (IsLocal (enb->GetNode ()))
+		{
+			enb->GetPhy ()->GetDlSpectrumPhy ()->TraceConnectWithoutContext ("TxDataStart",
+				MakeCallback (&MmWavePartitionHelper::TxDataStart, this).Bind (i));
+		}
+	}
+
+	m_localUePhys.clear ();
+	for (uint32_t i = 0; i < ueDevices.GetN (); i++)
+	{
+		if (!IsLocal (ueDevices.Get (i)->GetNode ()))
+		{
+			continue;
+		}
+		Ptr<MmWaveUeNetDevice> ue = DynamicCast<MmWaveUeNetDevice> (ueDevices.Get (i));
+		Ptr<McUeNetDevice> mcUe = DynamicCast<McUeNetDevice> (ueDevices.Get (i));
+		if (ue != 0)
+		{
+			m_localUePhys.push_back (ue->GetPhy ()->GetDlSpectrumPhy ());
+		}
+		else if (mcUe != 0)
+		{
+			m_localUePhys.push_back (mcUe->GetMmWavePhy ()->GetDlSpectrumPhy ());
+		}
+		else
+		{
+			NS_FATAL_ERROR ("Not an mmWave or MC UE device");
+		}
+	}
+
+	// one anchor node per rank and a link between each pair, whose delay is the lookahead
+	NodeContainer anchors;
+	for (uint32_t r = 0; r < nRanks; r++)
+	{
+		anchors.Add (CreateObject<Node> (r));
+	}
+	PointToPointHelper p2p;
+	p2p.SetDeviceAttribute ("DataRate", DataRateValue (DataRate ("100Gb/s")));
+	p2p.SetChannelAttribute ("Delay", TimeValue (m_slotPeriod));
+	uint32_t rank = MpiInterface::GetSystemId ();
+	for (uint32_t r = 0; r < nRanks; r++)
+	{
+		for (uint32_t s = r + 1; s < nRanks; s++)
+		{
+			NetDeviceContainer link = p2p.Install (anchors.Get (r), anchors.Get (s));
+			if (r == rank)
+			{
+				m_remoteDevices.Add (link.Get (0));
+			}
+			else if (s == rank)
+			{
+				m_remoteDevices.Add (link.Get (1));
+			}
+		}
+	}
+	anchors.Get (rank)->RegisterProtocolHandler (MakeCallback (&MmWavePartitionHelper::Receive, this),
+	                                             INTERFERENCE_PROTOCOL, 0);
+
+	Simulator::Schedule (m_slotPeriod, &MmWavePartitionHelper::SendSlot, this);
+}
+
+void
+MmWavePartitionHelper::TxDataStart (uint32_t enb, Ptr<const SpectrumValue> psd, Time duration)
+{
+	NS_LOG_FUNCTION (this << enb << duration);
+	if (m_slotEnergy[enb] == 0)
+	{
+		m_slotEnergy[enb] = Create<SpectrumValue> (psd->GetSpectrumModel ());
+	}
+	*m_slotEnergy[enb] += *psd * duration.GetSeconds ();
+}
+
+void
+MmWavePartitionHelper::SendSlot (void)
+{
+	NS_LOG_FUNCTION (this);
+	// one record per eNB that transmitted: its index, then its average PSD over the slot
+	uint32_t nBands = m_spectrumModel->GetNumBands ();
+	std::vector<uint8_t> buffer;
+	std::vector<double> psd (nBands);
+	for (uint32_t i = 0; i < m_slotEnergy.size (); i++)
+	{
+		if (m_slotEnergy[i] == 0)
+		{
+			continue;
+		}
+		NS_ASSERT (m_slotEnergy[i]->GetSpectrumModel ()->GetNumBands () == nBands);
+		for (uint32_t b = 0; b < nBands; b++)
+		{
+			psd[b] = (*m_slotEnergy[i])[b] / m_slotPeriod.GetSeconds ();
+		}
+		uint32_t offset = buffer.size ();
+		buffer.resize (offset + sizeof (uint32_t) + nBands * sizeof (double));
+		std::memcpy (&buffer[offset], &i, sizeof (uint32_t));
+		std::memcpy (&buffer[offset + sizeof (uint32_t)], &psd[0], nBands * sizeof (double));
+		m_slotEnergy[i] = 0;
+	}
+
+	if (!buffer.empty ())
+	{
+		for (uint32_t d = 0; d < m_remoteDevices.GetN (); d++)
+		{
+			Ptr<NetDevice> device = m_remoteDevices.Get (d);
+			device->Send (Create<Packet> (&buffer[0], buffer.size ()), device->GetBroadcast (), INTERFERENCE_PROTOCOL);
+		}
+	}
+	Simulator::Schedule (m_slotPeriod, &MmWavePartitionHelper::SendSlot, this);
+}
+
+void
+MmWavePartitionHelper::Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol,
+                                const Address &from, const Address &to, NetDevice::PacketType packetType)
+{
+	NS_LOG_FUNCTION (this << packet->GetSize ());
+	uint32_t nBands = m_spectrumModel->GetNumBands ();
+	uint32_t recordSize = sizeof (uint32_t) + nBands * sizeof (double);
+	NS_ASSERT (packet->GetSize () % recordSize == 0);
+	std::vector<uint8_t> buffer (packet->GetSize ());
+	packet->CopyData (&buffer[0], buffer.size ());
+
+	SpectrumValue psd (m_spectrumModel);
+	for (uint32_t offset = 0; offset < buffer.size (); offset += recordSize)
+	{
+		uint32_t enb;
+		std::memcpy (&enb, &buffer[offset], sizeof (uint32_t));
+		NS_ASSERT (enb < m_enbDevices.GetN ());
+		std::memcpy (&psd[0], &buffer[offset + sizeof (uint32_t)], nBands * sizeof (double));
+
+		Ptr<MobilityModel> enbMobility = m_enbDevices.Get (enb)->GetNode ()->GetObject<MobilityModel> ();
+		for (std::vector<Ptr<MmWaveSpectrumPhy> >::iterator ue = m_localUePhys.begin (); ue != m_localUePhys.end (); ++ue)
+		{
+			double gainDb = m_pathloss->CalcRxPower (0.0, enbMobility, (*ue)->GetMobility ());
+			Ptr<SpectrumValue> rxPsd = Create<SpectrumValue> (psd * std::pow (10.0, gainDb / 10.0));
+			(*ue)->AddRemoteInterference (rxPsd, m_slotPeriod);
+		}
+	}
+}
+
+}
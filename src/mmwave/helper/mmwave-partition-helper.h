@@ -0,0 +1,167 @@
+ /* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+ /*
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef SRC_MMWAVE_HELPER_MMWAVE_PARTITION_HELPER_H_
+#define SRC_MMWAVE_HELPER_MMWAVE_PARTITION_HELPER_H_
+
+#include <ns3/object.h>
+#include <ns3/node.h>
+#include <ns3/node-container.h>
+#include <ns3/net-device-container.h>
+#include <ns3/vector.h>
+#include <ns3/nstime.h>
+#include <ns3/spectrum-value.h>
+#include <ns3/propagation-loss-model.h>
+#include <vector>
+
+namespace ns3 {
+
+class Packet;
+class Address;
+class MmWaveSpectrumPhy;
+
+/**
+ * \brief Splits an mmWave deployment across the ranks of a distributed (MPI) run
+ *
+ * Each rank owns a cluster of cells, found by recursive bisection of the eNB
+ * positions, and the UEs nearest to them. Every rank builds the whole
+ * scenario, with the nodes created on their rank by CreateEnbNodes and
+ * CreateUeNode: the devices of the other ranks are replicas whose PHYs never
+ * start their subframes and are not added to the channel, so a rank only
+ * simulates the radio of its own cells. The X2 and S1 links between nodes of
+ * different ranks become remote point-to-point links, as PointToPointHelper
+ * does for any pair of nodes on different ranks.
+ *
+ * The interference between cells of different ranks is exchanged by
+ * EnableRemoteInterference: every slot, each rank sends to the others the
+ * average DL PSD transmitted by each of its cells over the slot, on
+ * point-to-point links whose delay is one slot, which is the lookahead of the
+ * run. The receiving rank applies the pathloss to each of its UEs and adds
+ * the result as interference for one slot from the arrival of the message,
+ * i.e., two slots after the transmissions. Beamforming gains are not applied
+ * to the remote interference.
+ *
+ * The same calls must be made on every rank, in the same order, so that the
+ * nodes get the same ids everywhere. Without MPI there is a single rank and
+ * the helper creates plain nodes.
+ */
+class MmWavePartitionHelper : public Object
+{
+public:
+	MmWavePartitionHelper ();
+	virtual ~MmWavePartitionHelper ();
+	static TypeId GetTypeId (void);
+	virtual void DoDispose (void);
+
+	/**
+	 * \brief Partition the cells
+	 * \param positions the positions of the eNBs
+	 */
+	void SetEnbPositions (const std::vector<Vector> &positions);
+
+	/**
+	 * \return the number of ranks of the run
+	 */
+	uint32_t GetNRanks (void) const;
+
+	/**
+	 * \param i the index of an eNB in the positions
+	 * \return the rank of the eNB
+	 */
+	uint32_t GetEnbRank (uint32_t i) const;
+
+	/**
+	 * \param position a position
+	 * \return the rank of the eNB nearest to the position
+	 */
+	uint32_t GetRank (const Vector &position) const;
+
+	/**
+	 * \return one node per eNB position, each on the rank of its eNB
+	 */
+	NodeContainer CreateEnbNodes (void) const;
+
+	/**
+	 * \param position the position of the UE
+	 * \return a node on the rank of the eNB nearest to the position
+	 */
+	Ptr<Node> CreateUeNode (const Vector &position) const;
+
+	/**
+	 * \param node a node
+	 * \return true if the node belongs to this rank
+	 */
+	static bool IsLocal (Ptr<const Node> node);
+
+	/**
+	 * \brief Exchange the DL interference between the cells of different ranks
+	 *
+	 * \param enbDevices the mmWave eNB devices, in the order of the positions
+	 * \param ueDevices the mmWave or MC UE devices
+	 * \param pathloss the propagation loss model of the DL channel
+	 */
+	void EnableRemoteInterference (NetDeviceContainer enbDevices, NetDeviceContainer ueDevices,
+	                               Ptr<PropagationLossModel> pathloss);
+
+private:
+	/**
+	 * \brief Assign ranks to a range of the eNBs
+	 * \param enbs the indices of the eNBs, reordered by the bisection
+	 * \param begin the start of the range
+	 * \param end the end of the range
+	 * \param firstRank the first rank of the range
+	 * \param nRanks the number of ranks of the range
+	 */
+	void Partition (std::vector<uint32_t> &enbs, uint32_t begin, uint32_t end,
+	                uint32_t firstRank, uint32_t nRanks);
+
+	/**
+	 * \brief Add a DL transmission of a local eNB to the energy of the slot
+	 * \param enb the index of the eNB
+	 * \param psd the transmitted PSD
+	 * \param duration the duration of the transmission
+	 */
+	void TxDataStart (uint32_t enb, Ptr<const SpectrumValue> psd, Time duration);
+
+	/**
+	 * \brief Send the average PSD of the local eNBs over the last slot to the other ranks
+	 */
+	void SendSlot (void);
+
+	/**
+	 * \brief Apply the PSD of the eNBs of another rank to the local UEs
+	 */
+	void Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol,
+	              const Address &from, const Address &to, NetDevice::PacketType packetType);
+
+	std::vector<Vector> m_enbPositions;
+	std::vector<uint32_t> m_enbRanks;
+
+	NetDeviceContainer m_enbDevices;
+	std::vector<Ptr<MmWaveSpectrumPhy> > m_localUePhys;
+	Ptr<PropagationLossModel> m_pathloss;
+	Ptr<const SpectrumModel> m_spectrumModel;
+	Time m_slotPeriod;
+
+	/// DL energy (PSD times seconds) of each local eNB in the current slot, 0 when it did not transmit
+	std::vector<Ptr<SpectrumValue> > m_slotEnergy;
+	/// devices of the links to the other ranks
+	NetDeviceContainer m_remoteDevices;
+};
+
+}
+
+#endif /* SRC_MMWAVE_HELPER_MMWAVE_PARTITION_HELPER_H_ */
@@ -42,7 +42,7 @@ NS_LOG_COMPONENT_DEFINE ("MmWavePhyRxTrace");
 
 NS_OBJECT_ENSURE_REGISTERED (MmWavePhyRxTrace);
 
-std::ofstream MmWavePhyRxTrace::m_rxPacketTraceFile;
+Ptr<AsyncTraceFile> MmWavePhyRxTrace::m_rxPacketTraceFile;
 std::string MmWavePhyRxTrace::m_rxPacketTraceFilename;
 
 MmWavePhyRxTrace::MmWavePhyRxTrace()
@@ -51,10 +51,6 @@ MmWavePhyRxTrace::MmWavePhyRxTrace()
 
 MmWavePhyRxTrace::~MmWavePhyRxTrace()
 {
-	if (m_rxPacketTraceFile.is_open ())
-	{
-		m_rxPacketTraceFile.close ();
-	}
 }
 
 TypeId
@@ -180,19 +176,15 @@ MmWavePhyRxTrace::ReportDLTbSize (uint64_t imsi, uint64_t tbSize)
 void
 MmWavePhyRxTrace::RxPacketTraceUeCallback (Ptr<MmWavePhyRxTrace> phyStats, std::string path, RxPacketTraceParams params)
 {
-	if (!m_rxPacketTraceFile.is_open())
+	if (m_rxPacketTraceFile == 0)
 	{
 		m_rxPacketTraceFilename = "RxPacketTrace.txt";
-		m_rxPacketTraceFile.open(m_rxPacketTraceFilename.c_str ());
-		if (!m_rxPacketTraceFile.is_open())
-		{
-			NS_FATAL_ERROR ("Could not open tracefile");
-		}
+		m_rxPacketTraceFile = AsyncTraceFile::Open (m_rxPacketTraceFilename);
 	}
-	m_rxPacketTraceFile << "DL\t" << params.m_frameNum << "\t" << (unsigned)params.m_sfNum << "\t" << (unsigned)params.m_symStart
+	m_rxPacketTraceFile->GetStream () << "DL\t" << params.m_frameNum << "\t" << (unsigned)params.m_sfNum << "\t" << (unsigned)params.m_symStart
 			<< "\t" << (unsigned)params.m_numSym << "\t" << params.m_cellId
 			<< "\t" << params.m_rnti << "\t" << params.m_tbSize << "\t" << (unsigned)params.m_mcs << "\t" << (unsigned)params.m_rv << "\t"
-			<< 10*std::log10(params.m_sinr) << "\t" << " \t" << params.m_corrupt << "\t" <<  params.m_tbler << std::endl;
+			<< 10*std::log10(params.m_sinr) << "\t" << " \t" << params.m_corrupt << "\t" <<  params.m_tbler << "\n";
 
 	if (params.m_corrupt)
 	{
@@ -205,20 +197,16 @@ MmWavePhyRxTrace::RxPacketTraceUeCallback (Ptr<MmWavePhyRxTrace> phyStats, std::
 void
 MmWavePhyRxTrace::RxPacketTraceEnbCallback (Ptr<MmWavePhyRxTrace> phyStats, std::string path, RxPacketTraceParams params)
 {
-	if (!m_rxPacketTraceFile.is_open())
+	if (m_rxPacketTraceFile == 0)
 	{
 		m_rxPacketTraceFilename = "RxPacketTrace.txt";
-		m_rxPacketTraceFile.open(m_rxPacketTraceFilename.c_str ());
-		m_rxPacketTraceFile << "\tframe\tsubF\t1stSym\tsymbol#\tcellId\trnti\ttbSize\tmcs\trv\tSINR(dB)\tcorrupt\tTBler" << std::endl;
-		if (!m_rxPacketTraceFile.is_open())
-		{
-			NS_FATAL_ERROR ("Could not open tracefile");
-		}
+		m_rxPacketTraceFile = AsyncTraceFile::Open (m_rxPacketTraceFilename);
+		m_rxPacketTraceFile->GetStream () << "\tframe\tsubF\t1stSym\tsymbol#\tcellId\trnti\ttbSize\tmcs\trv\tSINR(dB)\tcorrupt\tTBler\n";
 	}
-	m_rxPacketTraceFile << "UL\t" << params.m_frameNum << "\t" << (unsigned)params.m_sfNum << "\t" << (unsigned)params.m_symStart
+	m_rxPacketTraceFile->GetStream () << "UL\t" << params.m_frameNum << "\t" << (unsigned)params.m_sfNum << "\t" << (unsigned)params.m_symStart
 				<< "\t" << (unsigned)params.m_numSym << "\t" << params.m_cellId
 				<< "\t" << params.m_rnti << "\t" << params.m_tbSize << "\t" << (unsigned)params.m_mcs << "\t" << (unsigned)params.m_rv << "\t"
-				<< 10*std::log10(params.m_sinr) << " \t" << params.m_corrupt << "\t" << params.m_tbler << std::endl;
+				<< 10*std::log10(params.m_sinr) << " \t" << params.m_corrupt << "\t" << params.m_tbler << "\n";
 
 		if (params.m_corrupt)
 		{
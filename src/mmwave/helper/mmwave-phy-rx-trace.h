@@ -31,6 +31,7 @@
 #include <ns3/object.h>
 #include <ns3/spectrum-value.h>
 #include <ns3/mmwave-phy-mac-common.h>
+#include <ns3/async-trace-file.h>
 #include <fstream>
 #include <iostream>
 
@@ -59,7 +60,7 @@ private:
 	//void ReportPacketCountEnb (EnbPhyPacketCountParameter param);
 	//void ReportDLTbSize (uint64_t imsi, uint64_t tbSize);
 
-	static std::ofstream m_rxPacketTraceFile;
+	static Ptr<AsyncTraceFile> m_rxPacketTraceFile;
 	static std::string m_rxPacketTraceFilename;
 };
 
@@ -29,6 +29,7 @@
 #include <ns3/math.h>
 #include <ns3/simulator.h>
 #include "ns3/double.h"
+#include <algorithm>
 #include <ns3/node.h>//180714-jskim14
 #include <ns3/mobility-model.h> //180714-jskim14
 #include <ns3/mmwave-ue-net-device.h> //180718-jskim14
@@ -88,6 +89,8 @@ AntennaArrayModel::AntennaArrayModel()
 	:m_minAngle (0),m_maxAngle(2*M_PI), m_alpha(0), m_beta(0*M_PI/180), m_gamma(0), m_pol(45*M_PI/180)
 {
 	m_omniTx = false;
+	m_beamVersion = 0;
+	m_orientationVersion = 0;
 }
 
 AntennaArrayModel::~AntennaArrayModel()
@@ -174,14 +177,23 @@ AntennaArrayModel::SetBeamformingVector (complexVector_t antennaWeights, Ptr<Net
 		}
 	}
 	m_beamformingVector = antennaWeights;
+	m_beamVersion++;
+	if (device != 0)
+	{
+		m_beamVersionMap[device] = m_beamVersion;
+	}
 }
 
 void
 AntennaArrayModel::ChangeBeamformingVector (Ptr<NetDevice> device)
 {
-	m_omniTx = false;
 	std::map< Ptr<NetDevice>, complexVector_t >::iterator it = m_beamformingVectorMap.find (device);
 	NS_ASSERT_MSG (it != m_beamformingVectorMap.end (), "could not find");
+	if (m_omniTx || m_beamformingVector != it->second)
+	{
+		m_beamVersion++;
+	}
+	m_omniTx = false;
 	m_beamformingVector = it->second;
 }
 
@@ -198,7 +210,11 @@ AntennaArrayModel::GetBeamformingVector ()
 void
 AntennaArrayModel::ChangeToOmniTx ()
 {
-	m_omniTx = true;
+	if (!m_omniTx)
+	{
+		m_omniTx = true;
+		m_beamVersion++;
+	}
 }
 
 bool
@@ -363,6 +379,7 @@ AntennaArrayModel::SetToSector (uint32_t sector, uint32_t antennaNum)
 		cmplxVector. at(i) = cmplxVector. at(i)/sqrt(weightSum);
 	}
 	m_beamformingVector = cmplxVector;
+	m_beamVersion++;
 }
 
 // We add the two 'Get radiation pattern function' for implementing polarization. 2018.07.11 shlim.
@@ -531,6 +548,7 @@ AntennaArrayModel::SetSector (uint8_t sector, uint8_t *antennaNum, double elevat
 		tempVector.push_back(exp(std::complex<double>(0, phase))*power);
 	}
 	m_beamformingVector = tempVector;
+	m_beamVersion++;
 }
 
 //180702-jskim14-antenna parameters setting function
@@ -561,7 +579,6 @@ AntennaArrayModel::SetDigitalBeamformingVector()
 void
 AntennaArrayModel::SetAntennaWeightMatrix ()
 {
-	m_antennaWeightMat.clear();
 	double beamNum = 0;
 	uint16_t antNum = 0;
 	//Vector location = m_netDevice->GetNode()->GetObject<MobilityModel>()->GetPosition();
@@ -573,13 +590,12 @@ AntennaArrayModel::SetAntennaWeightMatrix ()
 			beamNum = m_vTxruNum*m_hTxruNum*m_polarNum;
 			antNum = m_vAntennaNum*m_hAntennaNum*m_polarNum;
 			NS_LOG_INFO("1-D full connection mode: " << "# of beams=" << (double)beamNum << " # of antenna elements=" << (unsigned)antNum);	
-			complex2DVector_t tempWeightMat(antNum, complexVector_t(beamNum, 0));
+			m_antennaWeightMat.Resize(antNum, beamNum);
 			for(int beamInd=0; beamInd<beamNum; beamInd++)
 			{
 				double elevation = 180/beamNum*(beamInd+1);
 				double vAngle_radian = elevation*M_PI/180;
 				NS_LOG_INFO("1-D full connection mode: " << "elevation angle: " << (double)elevation << " degree");	
-				//complex2DVector_t tempVec(antNum, complexVector_t(beamNum, 0));
 				for(int antInd=0; antInd<antNum; antInd++)
 				{
 					int startAntInd = m_vAntennaNum*(beamInd/m_vTxruNum);
@@ -590,15 +606,14 @@ AntennaArrayModel::SetAntennaWeightMatrix ()
 						double phase = -2*M_PI*(cos(vAngle_radian)*(loc.z));
 						double power = 1/sqrt(m_vAntennaNum);
 						NS_LOG_INFO("1-D full connection mode: " << " antenna ind: " << (int)antInd << " antenna location: x=" << (double)loc.x << ", y=" << (double)loc.y << ", z=" << (double)loc.z);	
-						tempWeightMat[antInd][beamInd] = exp(std::complex<double>(0, phase))*power;
-						NS_LOG_INFO("Antenna weight=" << tempWeightMat[antInd][beamInd]);
+						m_antennaWeightMat(antInd, beamInd) = exp(std::complex<double>(0, phase))*power;
+						NS_LOG_INFO("Antenna weight=" << m_antennaWeightMat(antInd, beamInd));
 					}
 					else
 					{
-						tempWeightMat[antInd][beamInd] = 0;
+						m_antennaWeightMat(antInd, beamInd) = 0;
 					}
 				}
-				m_antennaWeightMat = tempWeightMat;
 			}
 			break;
 		}
@@ -619,7 +634,7 @@ AntennaArrayModel::SetAntennaWeightMatrix ()
 			}
 			//jskim14-end
 			NS_LOG_INFO("2-D full connection mode: " << "# of beams=" << (double)beamNum << " # of antenna elements=" << (unsigned)antNum);	
-			complex2DVector_t tempWeightMat(antNum, complexVector_t(beamNum, 0));
+			m_antennaWeightMat.Resize(antNum, beamNum);
 			for(int vBeamInd=0; vBeamInd<vBeamNum; vBeamInd++)
 			{
 				double elevation = 180/vBeamNum*(vBeamInd+1);
@@ -645,11 +660,10 @@ AntennaArrayModel::SetAntennaWeightMatrix ()
 						double psi = std::arg(temp);
 						double pPhase = -(pInd-1)*psi;					
 						NS_LOG_INFO("2-D full connection mode: " << " antenna ind: " << (int)antInd << " antenna location: x=" << (double)loc.x << ", y=" << (double)loc.y << ", z=" << (double)loc.z);	
-						tempWeightMat[antInd][hBeamInd*m_vTxruNum+vBeamInd] = exp(std::complex<double>(0, vPhase))*vPower*exp(std::complex<double>(0, hPhase))*hPower*exp(std::complex<double>(0,pPhase));
-						NS_LOG_INFO("Antenna weight=" << tempWeightMat[antInd][hBeamInd*m_vTxruNum+vBeamInd]);
+						m_antennaWeightMat(antInd, hBeamInd*m_vTxruNum+vBeamInd) = exp(std::complex<double>(0, vPhase))*vPower*exp(std::complex<double>(0, hPhase))*hPower*exp(std::complex<double>(0,pPhase));
+						NS_LOG_INFO("Antenna weight=" << m_antennaWeightMat(antInd, hBeamInd*m_vTxruNum+vBeamInd));
 					}
 				}
-				m_antennaWeightMat = tempWeightMat;
 			}
 			break;
 		}
@@ -662,8 +676,8 @@ AntennaArrayModel::SetAntennaWeightMatrix ()
 //jskim14-end
 
 //180709-jskim14-add get antenna weight matrix
-complex2DVector_t
-AntennaArrayModel::GetAntennaWeightMatrix()
+const ComplexMatrix&
+AntennaArrayModel::GetAntennaWeightMatrix() const
 {
 	return m_antennaWeightMat;
 }
@@ -677,6 +691,8 @@ AntennaArrayModel::SetAntennaRotation (double alpha, double beta, double gamma,
 	m_beta = beta*M_PI/180;
 	m_gamma = gamma*M_PI/180;
 	m_pol = pol*M_PI/180;
+	m_beamVersion++;
+	m_orientationVersion = m_beamVersion;
 }
 //jskim14-end
 
@@ -700,4 +716,22 @@ AntennaArrayModel::GetTxruNum ()
 }
 //jskim14-end
 
+uint32_t
+AntennaArrayModel::GetBeamVersion () const
+{
+	return m_beamVersion;
+}
+
+uint32_t
+AntennaArrayModel::GetBeamVersion (Ptr<NetDevice> device) const
+{
+	uint32_t version = m_beamVersion;
+	std::map<Ptr<NetDevice>, uint32_t>::const_iterator it = m_beamVersionMap.find (device);
+	if (it != m_beamVersionMap.end ())
+	{
+		version = it->second;
+	}
+	return std::max (version, m_orientationVersion);
+}
+
 } /* namespace ns3 */
@@ -28,11 +28,11 @@
 #include <complex>
 #include <ns3/net-device.h>
 #include <map>
+#include <ns3/mmwave-complex-matrix.h>
 
 namespace ns3 {
 
 typedef std::vector< std::complex<double> > complexVector_t;
-typedef std::vector<complexVector_t> complex2DVector_t; //180704-jskim14-for antenna weight matrix
 
 class AntennaArrayModel: public AntennaModel {
 public:
@@ -58,12 +58,25 @@ public:
 	void SetAntParams (uint8_t connectMode, uint8_t vAntNum, uint8_t hAntNum, uint8_t polarNum, uint8_t vTxrusNum, uint8_t hTxrusNum, Ptr<NetDevice> device); //180702-jskim14-antenna parameters setting function
     void SetDigitalBeamformingVector(); //180822-jskim14-set digital beamforming vector
 	void SetAntennaWeightMatrix(); //180704-jskim14-set analog beamforming vector
-	complex2DVector_t GetAntennaWeightMatrix(); //180709-jskim14-get analog beamforming weight matrix
+	const ComplexMatrix& GetAntennaWeightMatrix() const; //180709-jskim14-get analog beamforming weight matrix
 	//void SetPrecodingVector(); //180726-jskim14-set digital precoding vector
 	//complex2DVector_t GetPrecodingVector(); //180726-jskim14-get digital precoding vector
 	void SetAntennaRotation (double alpha, double beta, double gamma, double pol); //180715-jskim14-add set antenna roation
 	Ptr<NetDevice> GetNetDevice (); //180717-jskim14
 	Vector GetTxruNum (); //180718-jskim14
+	/**
+	 * @returns a counter incremented every time the beamforming vector, the
+	 * omni mode or the orientation of the array changes, which lets the users
+	 * of the array detect a change of its gain cheaply
+	 */
+	uint32_t GetBeamVersion () const;
+	/**
+	 * @returns the value of the beam version when the beamforming vector
+	 * towards device or the orientation of the array last changed. Unlike
+	 * GetBeamVersion (), it does not move when the array only switches
+	 * between the stored beams of several devices
+	 */
+	uint32_t GetBeamVersion (Ptr<NetDevice> device) const;
 
 private:
 	bool m_omniTx;
@@ -71,6 +84,9 @@ private:
 	double m_maxAngle;
 	complexVector_t m_beamformingVector;
 	std::map<Ptr<NetDevice>, complexVector_t> m_beamformingVectorMap;
+	uint32_t m_beamVersion;
+	std::map<Ptr<NetDevice>, uint32_t> m_beamVersionMap; // beam version when the vector of each device was stored
+	uint32_t m_orientationVersion; // beam version when the array was last rotated
 
 	double m_disV; //antenna spacing in the vertical direction in terms of wave length.
 	double m_disH; //antenna spacing in the horizontal direction in terms of wave length.
@@ -84,7 +100,7 @@ private:
 	Ptr<NetDevice> m_netDevice; //180714-jskim14
 
 	//uint64_t m_noAntennas; //180702-jskim14-add the number of antenna elements
-	complex2DVector_t m_antennaWeightMat; //180704-jskim14-antenna weight matrix for anamlog bemaforming
+	ComplexMatrix m_antennaWeightMat; //180704-jskim14-antenna weight matrix for anamlog bemaforming
 
 	double m_alpha; // bearing angle in radian
     double m_beta;  // downtilt angle in radian
@@ -39,6 +39,8 @@
 #include "ns3/config-store.h"
 #include <utility>
 #include <iostream>
+#include <algorithm>
+#include <cfloat>
 #include "mmwave-beamforming.h"
 
 
@@ -757,11 +759,84 @@ BuildingsObstaclePropagationLossModel::GetTypeId (void)
 	static TypeId tid = TypeId ("ns3::BuildingsObstaclePropagationLossModel")
 		.SetParent<BuildingsPropagationLossModel> ()
 		.AddConstructor<BuildingsObstaclePropagationLossModel> ()
+		.AddAttribute ("LosCacheTolerance",
+					"Distance in meters either end of a link can move before its LOS/NLOS condition is "
+					"tested again against the buildings (0 tests it again after any move)",
+					DoubleValue (0.0),
+					MakeDoubleAccessor (&BuildingsObstaclePropagationLossModel::SetLosCacheTolerance,
+										&BuildingsObstaclePropagationLossModel::GetLosCacheTolerance),
+					MakeDoubleChecker<double> (0.0))
 	;
 	return tid;
 }
 
 
+bool
+BuildingsObstaclePropagationLossModel::IsBlocked (Vector a, Vector b) const
+{
+	Vector locationA = a;
+	Vector locationB = b;
+	Angles pathAngles (locationB, locationA);
+	double angle = pathAngles.phi;
+	if (angle >= M_PI/2 || angle < -M_PI/2)
+	{
+		locationA = b;
+		locationB = a;
+		Angles pathAngles (locationB, locationA);
+		angle = pathAngles.phi;
+	}
+
+	// only the buildings overlapping the bounding box of the path can meet the conditions below
+	std::vector<Box> candidates;
+	m_buildingBvh.GetBuildings (Box (std::min (a.x, b.x), std::max (a.x, b.x),
+									 std::min (a.y, b.y), std::max (a.y, b.y),
+									 -DBL_MAX, DBL_MAX), candidates);
+	for (std::vector<Box>::const_iterator bit = candidates.begin (); bit != candidates.end (); ++bit)
+	{
+		const Box &boundaries = *bit;
+		if (angle >=0 && angle < M_PI/2 )
+		{
+			Vector loc1(boundaries.xMin,boundaries.yMin,boundaries.zMin); //sjkang
+			Vector loc2(boundaries.xMax,boundaries.yMax,boundaries.zMin); //sjkang
+
+			Angles angles1 (loc1,locationA);
+			Angles angles2 (loc2,locationA);
+
+			if (angle > angles1.phi && angle < angles2.phi && locationB.x > boundaries.xMin && locationB.y > boundaries.yMin
+					&& angles1.phi < M_PI/2 && angles2.phi <M_PI/2 && locationA.x<boundaries.xMax &&
+					locationA.y<boundaries.yMax ) //sjkang1206
+			{
+				return true;
+			}
+		}
+		else if (angle >= -M_PI/2 && angle < 0)
+		{
+			Vector loc1(boundaries.xMin,boundaries.yMin,boundaries.zMin);
+			Vector loc2(boundaries.xMax,boundaries.yMax,boundaries.zMin);
+			Angles angles1 (loc1,locationA);
+			Angles angles2 (loc2,locationA);
+			if (angle >angles1.phi && angle < angles2.phi && locationB.x>boundaries.xMin && locationB.y<boundaries.yMax
+					&& locationA.x < boundaries.xMin  ) //sjkang1206
+			{
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+void
+BuildingsObstaclePropagationLossModel::SetLosCacheTolerance (double tolerance)
+{
+	m_losCache.SetTolerance (tolerance);
+}
+
+double
+BuildingsObstaclePropagationLossModel::GetLosCacheTolerance (void) const
+{
+	return m_losCache.GetTolerance ();
+}
+
 double
 BuildingsObstaclePropagationLossModel::DoCalcRxPower (double txPowerDbm, Ptr<MobilityModel> a, Ptr<MobilityModel> b) const
 {	
@@ -785,62 +860,13 @@ BuildingsObstaclePropagationLossModel::GetLoss (Ptr<MobilityModel> a, Ptr<Mobili
 	if (a1->IsOutdoor () && b1->IsOutdoor ())
 	{
 		/*Determine LOS or NLOS*/
-		bool los = true;
-		for (BuildingList::Iterator bit = BuildingList::Begin (); bit != BuildingList::End (); ++bit)
+		bool blocked;
+		if (!m_losCache.Lookup (a, b, blocked))
 		{
-			Box boundaries = (*bit)->GetBoundaries ();
-			Vector locationA = a->GetPosition ();
-			Vector locationB = b->GetPosition ();
-			Angles pathAngles (locationB, locationA);
-			double angle = pathAngles.phi;
-		//	std::cout << angle << std::endl;
-			if (angle >= M_PI/2 || angle < -M_PI/2)
-			{
-				locationA = b->GetPosition ();
-				locationB = a->GetPosition ();
-				Angles pathAngles (locationB, locationA);
-				angle = pathAngles.phi;
-			}
-
-			if (angle >=0 && angle < M_PI/2 )
-			{
-			//	Vector loc1(boundaries.xMax,boundaries.yMin,boundaries.zMin);
-				Vector loc1(boundaries.xMin,boundaries.yMin,boundaries.zMin); //sjkang
-
-				//Vector loc2(boundaries.xMin,boundaries.yMax,boundaries.zMin);
-				Vector loc2(boundaries.xMax,boundaries.yMax,boundaries.zMin); //sjkang
-
-				Angles angles1 (loc1,locationA);
-				Angles angles2 (loc2,locationA);
-
-				if (angle > angles1.phi && angle < angles2.phi && locationB.x > boundaries.xMin && locationB.y > boundaries.yMin
-						&& angles1.phi < M_PI/2 && angles2.phi <M_PI/2 && locationA.x<boundaries.xMax &&
-						locationA.y<boundaries.yMax ) //sjkang1206
-				{
-					los = false;
-
-					break;
-				}
-			}
-			else if (angle >= -M_PI/2 && angle < 0)
-			{
-				Vector loc1(boundaries.xMin,boundaries.yMin,boundaries.zMin);
-				Vector loc2(boundaries.xMax,boundaries.yMax,boundaries.zMin);
-				Angles angles1 (loc1,locationA);
-				Angles angles2 (loc2,locationA);
-				if (angle >angles1.phi && angle < angles2.phi && locationB.x>boundaries.xMin && locationB.y<boundaries.yMax
-						&& locationA.x < boundaries.xMin  ) //sjkang1206
-				{
-					los = false;
-					//std::cout << "minus  " <<std::endl;;
-
-					break;
-
-				}
-
-			}
-
+			blocked = IsBlocked (a->GetPosition (), b->GetPosition ());
+			m_losCache.Store (a, b, blocked);
 		}
+		bool los = !blocked;
 
 		int nlosSamples = m_losTracker->GetNlosSamples(a,b); // sample to be used in the Aditya's traces
 		int losSamples = m_losTracker->GetLosSamples(a,b); // sample to be used in the Aditya's traces
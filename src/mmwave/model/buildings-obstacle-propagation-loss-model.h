@@ -30,6 +30,8 @@
 #define BUILDINGS_OBSTACLE_PROPAGATION_LOSS_MODEL_H_
 
 #include <ns3/buildings-propagation-loss-model.h>
+#include <ns3/building-bvh.h>
+#include <ns3/building-los-cache.h>
 #include "mmwave-los-tracker.h"
 #include <ns3/simulator.h>
 #include "mmwave-phy-mac-common.h"
@@ -63,6 +65,12 @@ public:
 	void SetLosTracker (Ptr<MmWaveLosTracker> losTracker);
 	bool additionalPath= false;
 private:
+	/**
+	 * \return true if a building blocks the path between a and b
+	 */
+	bool IsBlocked (Vector a, Vector b) const;
+	void SetLosCacheTolerance (double tolerance);
+	double GetLosCacheTolerance (void) const;
 	double mmWaveLosLoss (Ptr<MobilityModel> a, Ptr<MobilityModel> b) const;
 	double mmWaveNlosLoss (Ptr<MobilityModel> a, Ptr<MobilityModel> b) const;
 	double m_frequency;
@@ -70,6 +78,8 @@ private:
 	Ptr<MmWaveBeamforming> m_beamforming, m_beamforming_2;//sjkang
 	Ptr<MmWaveLosTracker> m_losTracker;
 	Ptr<MmWavePhyMacCommon> m_phyMacConfig;
+	BuildingBvh m_buildingBvh;
+	mutable BuildingLosCache m_losCache;
 };
 
 }
@@ -27,6 +27,8 @@
 
 #include "ns3/mmwave-3gpp-propagation-loss-model.h"
 #include <ns3/buildings-propagation-loss-model.h>
+#include <ns3/building-bvh.h>
+#include <ns3/building-los-cache.h>
 #include <ns3/simulator.h>
 #include "mmwave-phy-mac-common.h"
 #include <fstream>
@@ -49,10 +51,12 @@ public:
 	char GetChannelCondition(Ptr<MobilityModel> a, Ptr<MobilityModel> b);
 
 private:
-	//The IsLineIntersectBuildings method is based on
-	//ISLineInBox method implemented in Bounding Box Types.
+	//The IsLineIntersectBuildings method looks the line up in a BVH of the buildings,
+	//whose line test is based on the ISLineInBox method implemented in Bounding Box Types.
 	//Link: http://www.3dkingdoms.com/weekly/weekly.php?a=21.
 	bool IsLineIntersectBuildings (Vector L1, Vector L2 ) const;
+	void SetLosCacheTolerance (double tolerance);
+	double GetLosCacheTolerance (void) const;
 	void LocationTrace (Vector enbLoc, Vector ueLoc, bool los) const;
 	double mmWaveLosLoss (Ptr<MobilityModel> a, Ptr<MobilityModel> b) const;
 	double mmWaveNlosLoss (Ptr<MobilityModel> a, Ptr<MobilityModel> b) const;
@@ -63,6 +67,8 @@ private:
 	Ptr<MmWave3gppPropagationLossModel> m_3gppLos;
 	Ptr<MmWave3gppPropagationLossModel> m_3gppNlos;
 	mutable channelConditionMap_t m_conditionMap;
+	BuildingBvh m_buildingBvh;
+	mutable BuildingLosCache m_losCache;
 	bool m_updateCondition;
 	mutable Time m_prevTime;
 	Ptr<MmWavePhyMacCommon> m_phyMacConfig;
@@ -39,6 +39,7 @@
 #include <random> // std::default_random_engine
 #include <ns3/boolean.h>
 #include <ns3/integer.h>
+#include <ns3/uinteger.h>
 #include "mmwave-spectrum-value-helper.h"
 
 namespace ns3
@@ -48,6 +49,49 @@ NS_LOG_COMPONENT_DEFINE("MmWave3gppChannel");
 
 NS_OBJECT_ENSURE_REGISTERED(MmWave3gppChannel);
 
+/**
+ * Beamforming gain of one link, applied by MultiModelSpectrumChannel on a worker thread
+ */
+class MmWave3gppRxPsdTask : public SpectrumRxPsdTask
+{
+public:
+	MmWave3gppRxPsdTask(const MmWave3gppChannel *channel);
+	virtual void Apply(SpectrumValue &psd);
+	virtual void Finish(const SpectrumValue &psd);
+
+	bool m_beamformed; // false if the link is received without beamforming gain
+	PreparedLink3gpp m_prep;
+
+private:
+	const MmWave3gppChannel *m_channel;
+	SubbandGainScratch m_scratch; // the scratch of the channel belongs to the simulator thread
+	doubleVector_t m_rxValues; // PSD before the gain, for the log
+	double m_rxSum;
+	double m_gainSum;
+};
+
+namespace
+{
+
+/*
+ * Sums needed by MmWave3gppChannel::LogLinkGain, the gain of a band is the ratio
+ * between the PSD after and before the beamforming gain
+ */
+void
+SumLinkGain(Values::const_iterator rx, Values::const_iterator rxEnd, Values::const_iterator bf,
+			double &rxSum, double &gainSum)
+{
+	rxSum = 0;
+	gainSum = 0;
+	for (; rx != rxEnd; ++rx, ++bf)
+	{
+		rxSum += *rx;
+		gainSum += (*bf) / (*rx);
+	}
+}
+
+} // anonymous namespace
+
 //Table 7.5-3: Ray offset angles within a cluster, given for rms angle spread normalized to 1.
 static const double offSetAlpha[20] = {
 	0.0447, -0.0447, 0.1413, -0.1413, 0.2492, -0.2492, 0.3715, -0.3715, 0.5129, -0.5129, 0.6797, -0.6797, 0.8844, -0.8844, 1.1481, -1.1481, 1.5195, -1.5195, 2.1551, -2.1551};
@@ -192,6 +236,26 @@ MmWave3gppChannel::GetTypeId(void)
 										  BooleanValue(false),
 										  MakeBooleanAccessor(&MmWave3gppChannel::m_cellScan),
 										  MakeBooleanChecker())
+							.AddAttribute("HierarchicalBeamSearch",
+										  "Use the coarse-then-fine beam search, only the best BeamSearchCandidates tx and rx beams of a narrowband stage are scored over the whole band",
+										  BooleanValue(false),
+										  MakeBooleanAccessor(&MmWave3gppChannel::m_hierarchicalBeamSearch),
+										  MakeBooleanChecker())
+							.AddAttribute("BeamSearchCandidates",
+										  "Number of tx and rx beams kept by the coarse stage of the hierarchical beam search",
+										  UintegerValue(4),
+										  MakeUintegerAccessor(&MmWave3gppChannel::m_beamSearchCandidates),
+										  MakeUintegerChecker<uint16_t>(1))
+							.AddAttribute("ChannelCache",
+										  "Reuse the beamforming gain of a static link until its channel realization or its beams change",
+										  BooleanValue(true),
+										  MakeBooleanAccessor(&MmWave3gppChannel::m_channelCache),
+										  MakeBooleanChecker())
+							.AddAttribute("ChannelCacheDistance",
+										  "Displacement of the tx or rx node, in meters, after which a cached beamforming gain is recomputed",
+										  DoubleValue(1.0),
+										  MakeDoubleAccessor(&MmWave3gppChannel::m_channelCacheDistance),
+										  MakeDoubleChecker<double>(0.0))
 							.AddAttribute("Blockage",
 										  "Enable blockage model A (sec 7.6.4.1)",
 										  BooleanValue(false),
@@ -227,6 +291,7 @@ MmWave3gppChannel::~MmWave3gppChannel()
 void MmWave3gppChannel::DoDispose()
 {
 	NS_LOG_FUNCTION(this);
+	m_linkCache.clear();
 }
 
 void MmWave3gppChannel::SetConfigurationParameters(Ptr<MmWavePhyMacCommon> ptrConfig)
@@ -439,16 +504,9 @@ void MmWave3gppChannel::Initial(NetDeviceContainer ueDevices, NetDeviceContainer
 	m_forceInitialBfComputation = false;
 }
 
-Ptr<SpectrumValue>
-MmWave3gppChannel::DoCalcRxPowerSpectralDensity(Ptr<const SpectrumValue> txPsd,
-												Ptr<const MobilityModel> a,
-												Ptr<const MobilityModel> b) const
+void
+MmWave3gppChannel::ClassifyLink(Ptr<NetDevice> txDevice, Ptr<NetDevice> rxDevice, LinkCache3gpp &link) const
 {
-	NS_LOG_FUNCTION(this);
-	Ptr<SpectrumValue> rxPsd = Copy(txPsd);
-
-	Ptr<NetDevice> txDevice = a->GetObject<Node>()->GetDevice(0);
-	Ptr<NetDevice> rxDevice = b->GetObject<Node>()->GetDevice(0);
 	Ptr<MmWaveEnbNetDevice> txEnb =
 		DynamicCast<MmWaveEnbNetDevice>(txDevice);
 	Ptr<McUeNetDevice> rxMcUe =
@@ -458,100 +516,84 @@ MmWave3gppChannel::DoCalcRxPowerSpectralDensity(Ptr<const SpectrumValue> txPsd,
 	Ptr<MmWaveUeNetDevice> rxUe =
 		DynamicCast<MmWaveUeNetDevice>(rxDevice);
 
-	bool downlink = false;
-	bool downlinkMc = false;
-	bool uplink = false;
-	bool uplinkMc = false;
+	link.m_classified = true;
+	link.m_beamformed = true;
+	link.m_downlink = false;
+	link.m_downlinkMc = false;
+	link.m_uplink = false;
+	link.m_uplinkMc = false;
 
-	/* txAntennaNum[0]-number of vertical antenna elements
-	 * txAntennaNum[1]-number of horizontal antenna elements*/
+	/* link.m_txAntennaNum[0]-number of vertical antenna elements
+	 * link.m_txAntennaNum[1]-number of horizontal antenna elements*/
 	//180709-jskim14
-	/* txAntennaNum[2]-number of polarization dimension (1 or 2)*/
-
-	//180709-jskim14-extend array for adding polarization dimension
-	int arraySize;
-	if (m_nrTxMode == 1)
-	{
-		arraySize = 3;
-	}
-	else
-	{
-		arraySize = 2;
-	}
-	uint8_t txAntennaNum[arraySize];
-	uint8_t rxAntennaNum[arraySize];
-	//jskim14-end
-	Ptr<AntennaArrayModel> txAntennaArray, rxAntennaArray;
+	/* link.m_txAntennaNum[2]-number of polarization dimension (1 or 2)*/
 
-	Vector locUT;
 	if (txEnb != 0 && rxUe != 0 && rxMcUe == 0)
 	{
-		NS_LOG_INFO("this is downlink case, a tx " << a->GetPosition() << " b rx " << b->GetPosition());
-		downlink = true;
+		NS_LOG_INFO("this is downlink case");
+		link.m_downlink = true;
 
 		//180709-jskim14-consider NR tx mode
 		if (m_nrTxMode == 1)
 		{
-			txAntennaNum[0] = txEnb->GetVAntennaNum();
-			txAntennaNum[1] = txEnb->GetHAntennaNum();
-			txAntennaNum[2] = txEnb->GetPolarNum();
-			rxAntennaNum[0] = rxUe->GetVAntennaNum();
-			rxAntennaNum[1] = rxUe->GetHAntennaNum();
-			rxAntennaNum[2] = rxUe->GetPolarNum();
+			link.m_txAntennaNum[0] = txEnb->GetVAntennaNum();
+			link.m_txAntennaNum[1] = txEnb->GetHAntennaNum();
+			link.m_txAntennaNum[2] = txEnb->GetPolarNum();
+			link.m_rxAntennaNum[0] = rxUe->GetVAntennaNum();
+			link.m_rxAntennaNum[1] = rxUe->GetHAntennaNum();
+			link.m_rxAntennaNum[2] = rxUe->GetPolarNum();
 		}
 		else
 		{
-			txAntennaNum[0] = sqrt(txEnb->GetAntennaNum());
-			txAntennaNum[1] = sqrt(txEnb->GetAntennaNum());
-			rxAntennaNum[0] = sqrt(rxUe->GetAntennaNum());
-			rxAntennaNum[1] = sqrt(rxUe->GetAntennaNum());
+			link.m_txAntennaNum[0] = sqrt(txEnb->GetAntennaNum());
+			link.m_txAntennaNum[1] = sqrt(txEnb->GetAntennaNum());
+			link.m_rxAntennaNum[0] = sqrt(rxUe->GetAntennaNum());
+			link.m_rxAntennaNum[1] = sqrt(rxUe->GetAntennaNum());
 		}
 		//jskim14-end
 
-		txAntennaArray = DynamicCast<AntennaArrayModel>(
+		link.m_txAntennaArray = DynamicCast<AntennaArrayModel>(
 			txEnb->GetPhy()->GetDlSpectrumPhy()->GetRxAntenna());
-		rxAntennaArray = DynamicCast<AntennaArrayModel>(
+		link.m_rxAntennaArray = DynamicCast<AntennaArrayModel>(
 			rxUe->GetPhy()->GetDlSpectrumPhy()->GetRxAntenna());
-		locUT = b->GetPosition();
 	}
 	else if (txEnb != 0 && rxMcUe != 0 && rxUe == 0)
 	{
-		NS_LOG_INFO("this is MC downlink case, a tx " << a->GetPosition() << " b rx " << b->GetPosition());
-		downlinkMc = true;
+		NS_LOG_INFO("this is MC downlink case");
+		link.m_downlinkMc = true;
 
 		//180709-jskim14-consider NR tx mode
 		if (m_nrTxMode == 1)
 		{
-			txAntennaNum[0] = txEnb->GetVAntennaNum();
-			txAntennaNum[1] = txEnb->GetHAntennaNum();
-			txAntennaNum[2] = txEnb->GetPolarNum();
-			rxAntennaNum[0] = rxMcUe->GetVAntennaNum();
-			rxAntennaNum[1] = rxMcUe->GetHAntennaNum();
-			rxAntennaNum[2] = rxMcUe->GetPolarNum();
+			link.m_txAntennaNum[0] = txEnb->GetVAntennaNum();
+			link.m_txAntennaNum[1] = txEnb->GetHAntennaNum();
+			link.m_txAntennaNum[2] = txEnb->GetPolarNum();
+			link.m_rxAntennaNum[0] = rxMcUe->GetVAntennaNum();
+			link.m_rxAntennaNum[1] = rxMcUe->GetHAntennaNum();
+			link.m_rxAntennaNum[2] = rxMcUe->GetPolarNum();
 		}
 		else
 		{
-			txAntennaNum[0] = sqrt(txEnb->GetAntennaNum());
-			txAntennaNum[1] = sqrt(txEnb->GetAntennaNum());
-			rxAntennaNum[0] = sqrt(rxMcUe->GetAntennaNum());
-			rxAntennaNum[1] = sqrt(rxMcUe->GetAntennaNum());
+			link.m_txAntennaNum[0] = sqrt(txEnb->GetAntennaNum());
+			link.m_txAntennaNum[1] = sqrt(txEnb->GetAntennaNum());
+			link.m_rxAntennaNum[0] = sqrt(rxMcUe->GetAntennaNum());
+			link.m_rxAntennaNum[1] = sqrt(rxMcUe->GetAntennaNum());
 		}
 		//jskim14-end
 
-		txAntennaArray = DynamicCast<AntennaArrayModel>(
+		link.m_txAntennaArray = DynamicCast<AntennaArrayModel>(
 			txEnb->GetPhy()->GetDlSpectrumPhy()->GetRxAntenna());
 		if (isAdditionalMmWavePhy)
-			rxAntennaArray = DynamicCast<AntennaArrayModel>(
+			link.m_rxAntennaArray = DynamicCast<AntennaArrayModel>(
 				rxMcUe->GetMmWavePhy_2()->GetDlSpectrumPhy()->GetRxAntenna());
 		else
-			rxAntennaArray = DynamicCast<AntennaArrayModel>(
+			link.m_rxAntennaArray = DynamicCast<AntennaArrayModel>(
 				rxMcUe->GetMmWavePhy()->GetDlSpectrumPhy()->GetRxAntenna()); //sjkang1125
-		locUT = b->GetPosition();
 	}
 	else if (txEnb == 0 && rxUe == 0 && txMcUe == 0 && rxMcUe == 0)
 	{
-		NS_LOG_INFO("this is uplink case, a tx " << a->GetPosition() << " b rx " << b->GetPosition());
-		uplink = true;
+		NS_LOG_INFO("this is uplink case");
+		link.m_uplink = true;
 		Ptr<MmWaveUeNetDevice> txUe =
 			DynamicCast<MmWaveUeNetDevice>(txDevice);
 		Ptr<MmWaveEnbNetDevice> rxEnb =
@@ -560,71 +602,138 @@ MmWave3gppChannel::DoCalcRxPowerSpectralDensity(Ptr<const SpectrumValue> txPsd,
 		//180709-jskim14-consider NR tx mode
 		if (m_nrTxMode == 1)
 		{
-			txAntennaNum[0] = txUe->GetVAntennaNum();
-			txAntennaNum[1] = txUe->GetHAntennaNum();
-			txAntennaNum[2] = txUe->GetPolarNum();
-			rxAntennaNum[0] = rxEnb->GetVAntennaNum();
-			rxAntennaNum[1] = rxEnb->GetHAntennaNum();
-			rxAntennaNum[2] = rxEnb->GetPolarNum();
+			link.m_txAntennaNum[0] = txUe->GetVAntennaNum();
+			link.m_txAntennaNum[1] = txUe->GetHAntennaNum();
+			link.m_txAntennaNum[2] = txUe->GetPolarNum();
+			link.m_rxAntennaNum[0] = rxEnb->GetVAntennaNum();
+			link.m_rxAntennaNum[1] = rxEnb->GetHAntennaNum();
+			link.m_rxAntennaNum[2] = rxEnb->GetPolarNum();
 		}
 		else
 		{
-			txAntennaNum[0] = sqrt(txUe->GetAntennaNum());
-			txAntennaNum[1] = sqrt(txUe->GetAntennaNum());
-			rxAntennaNum[0] = sqrt(rxEnb->GetAntennaNum());
-			rxAntennaNum[1] = sqrt(rxEnb->GetAntennaNum());
+			link.m_txAntennaNum[0] = sqrt(txUe->GetAntennaNum());
+			link.m_txAntennaNum[1] = sqrt(txUe->GetAntennaNum());
+			link.m_rxAntennaNum[0] = sqrt(rxEnb->GetAntennaNum());
+			link.m_rxAntennaNum[1] = sqrt(rxEnb->GetAntennaNum());
 		}
 		//jskim14-end
 
-		txAntennaArray = DynamicCast<AntennaArrayModel>(
+		link.m_txAntennaArray = DynamicCast<AntennaArrayModel>(
 			txUe->GetPhy()->GetDlSpectrumPhy()->GetRxAntenna());
-		rxAntennaArray = DynamicCast<AntennaArrayModel>(
+		link.m_rxAntennaArray = DynamicCast<AntennaArrayModel>(
 			rxEnb->GetPhy()->GetDlSpectrumPhy()->GetRxAntenna());
-		locUT = a->GetPosition();
 	}
 	else if (txEnb == 0 && rxUe == 0 && txMcUe != 0 && rxMcUe == 0)
 	{
-		NS_LOG_INFO("this is MC uplink case, a tx " << a->GetPosition() << " b rx " << b->GetPosition());
-		uplinkMc = true;
+		NS_LOG_INFO("this is MC uplink case");
+		link.m_uplinkMc = true;
 		Ptr<MmWaveEnbNetDevice> rxEnb =
 			DynamicCast<MmWaveEnbNetDevice>(rxDevice);
 
 		//180709-jskim14-consider NR tx mode
 		if (m_nrTxMode == 1)
 		{
-			txAntennaNum[0] = txMcUe->GetVAntennaNum();
-			txAntennaNum[1] = txMcUe->GetHAntennaNum();
-			txAntennaNum[2] = txMcUe->GetPolarNum();
-			rxAntennaNum[0] = rxEnb->GetVAntennaNum();
-			rxAntennaNum[1] = rxEnb->GetHAntennaNum();
-			rxAntennaNum[2] = rxEnb->GetPolarNum();
+			link.m_txAntennaNum[0] = txMcUe->GetVAntennaNum();
+			link.m_txAntennaNum[1] = txMcUe->GetHAntennaNum();
+			link.m_txAntennaNum[2] = txMcUe->GetPolarNum();
+			link.m_rxAntennaNum[0] = rxEnb->GetVAntennaNum();
+			link.m_rxAntennaNum[1] = rxEnb->GetHAntennaNum();
+			link.m_rxAntennaNum[2] = rxEnb->GetPolarNum();
 		}
 		else
 		{
-			txAntennaNum[0] = sqrt(txMcUe->GetAntennaNum());
-			txAntennaNum[1] = sqrt(txMcUe->GetAntennaNum());
-			rxAntennaNum[0] = sqrt(rxEnb->GetAntennaNum());
-			rxAntennaNum[1] = sqrt(rxEnb->GetAntennaNum());
+			link.m_txAntennaNum[0] = sqrt(txMcUe->GetAntennaNum());
+			link.m_txAntennaNum[1] = sqrt(txMcUe->GetAntennaNum());
+			link.m_rxAntennaNum[0] = sqrt(rxEnb->GetAntennaNum());
+			link.m_rxAntennaNum[1] = sqrt(rxEnb->GetAntennaNum());
 		}
 		//jskim14-end
 
 		if (isAdditionalMmWavePhy) //sjkang1125
-			txAntennaArray = DynamicCast<AntennaArrayModel>(
+			link.m_txAntennaArray = DynamicCast<AntennaArrayModel>(
 				txMcUe->GetMmWavePhy_2()->GetDlSpectrumPhy()->GetRxAntenna());
 		else
-			txAntennaArray = DynamicCast<AntennaArrayModel>(
+			link.m_txAntennaArray = DynamicCast<AntennaArrayModel>(
 				txMcUe->GetMmWavePhy()->GetDlSpectrumPhy()->GetRxAntenna());
 
-		rxAntennaArray = DynamicCast<AntennaArrayModel>(
+		link.m_rxAntennaArray = DynamicCast<AntennaArrayModel>(
 			rxEnb->GetPhy()->GetDlSpectrumPhy()->GetRxAntenna());
-		locUT = a->GetPosition();
 	}
 	else
 	{
-		NS_LOG_INFO("enb to enb or ue to ue transmission, skip beamforming a tx " << a->GetPosition() << " b rx " << b->GetPosition());
+		link.m_beamformed = false;
+	}
+}
+
+Ptr<SpectrumValue>
+MmWave3gppChannel::DoCalcRxPowerSpectralDensity(Ptr<const SpectrumValue> txPsd,
+												Ptr<const MobilityModel> a,
+												Ptr<const MobilityModel> b) const
+{
+	NS_LOG_FUNCTION(this);
+	Ptr<SpectrumValue> rxPsd = Copy(txPsd);
+	PreparedLink3gpp prep;
+	if (!PrepareLink(rxPsd, a, b, prep))
+	{
 		return rxPsd;
 	}
 
+	Ptr<SpectrumValue> bfPsd = Copy<SpectrumValue>(rxPsd);
+	ApplyLinkGain(prep, *bfPsd, m_gainScratch);
+	double rxSum, gainSum;
+	SumLinkGain(rxPsd->ConstValuesBegin(), rxPsd->ConstValuesEnd(), bfPsd->ConstValuesBegin(), rxSum, gainSum);
+	LogLinkGain(prep, rxSum, gainSum, rxPsd->GetSpectrumModel()->GetNumBands());
+	return bfPsd;
+}
+
+Ptr<SpectrumRxPsdTask>
+MmWave3gppChannel::DoPrepareRxPowerSpectralDensity(Ptr<const SpectrumValue> psd,
+												Ptr<const MobilityModel> a,
+												Ptr<const MobilityModel> b) const
+{
+	NS_LOG_FUNCTION(this);
+	Ptr<MmWave3gppRxPsdTask> task = Create<MmWave3gppRxPsdTask>(this);
+	task->m_beamformed = PrepareLink(psd, a, b, task->m_prep);
+	return task;
+}
+
+bool
+MmWave3gppChannel::PrepareLink(Ptr<const SpectrumValue> rxPsd, Ptr<const MobilityModel> a,
+							   Ptr<const MobilityModel> b, PreparedLink3gpp &prep) const
+{
+	NS_LOG_FUNCTION(this);
+
+	Ptr<NetDevice> txDevice = a->GetObject<Node>()->GetDevice(0);
+	Ptr<NetDevice> rxDevice = b->GetObject<Node>()->GetDevice(0);
+	key_t key = std::make_pair(txDevice, rxDevice);
+
+	//the device types of a pair never change, so the link is classified only at its first transmission
+	LinkCache3gpp &link = m_linkCache[key];
+	if (!link.m_classified)
+	{
+		ClassifyLink(txDevice, rxDevice, link);
+	}
+	if (!link.m_beamformed)
+	{
+		NS_LOG_INFO("enb to enb or ue to ue transmission, skip beamforming a tx " << a->GetPosition() << " b rx " << b->GetPosition());
+		return false;
+	}
+	NS_LOG_INFO("this is " << (link.m_downlink || link.m_downlinkMc ? "downlink" : "uplink") << " case, a tx " << a->GetPosition() << " b rx " << b->GetPosition());
+
+	bool downlink = link.m_downlink;
+	bool downlinkMc = link.m_downlinkMc;
+	bool uplink = link.m_uplink;
+	bool uplinkMc = link.m_uplinkMc;
+	/* txAntennaNum[0]-number of vertical antenna elements
+	 * txAntennaNum[1]-number of horizontal antenna elements*/
+	//180709-jskim14
+	/* txAntennaNum[2]-number of polarization dimension (1 or 2)*/
+	uint8_t *txAntennaNum = link.m_txAntennaNum;
+	uint8_t *rxAntennaNum = link.m_rxAntennaNum;
+	Ptr<AntennaArrayModel> txAntennaArray = link.m_txAntennaArray;
+	Ptr<AntennaArrayModel> rxAntennaArray = link.m_rxAntennaArray;
+	Vector locUT = (downlink || downlinkMc) ? b->GetPosition() : a->GetPosition();
+
 	//180813-jskim14-move this condition to the after channelParams declaration
 	/*if (txAntennaArray->IsOmniTx() || rxAntennaArray->IsOmniTx())
 	{
@@ -651,7 +760,6 @@ MmWave3gppChannel::DoCalcRxPowerSpectralDensity(Ptr<const SpectrumValue> txPsd,
 	Vector txSpeed = a->GetVelocity();
 	Vector relativeSpeed(rxSpeed.x - txSpeed.x, rxSpeed.y - txSpeed.y, rxSpeed.z - txSpeed.z);
 
-	key_t key = std::make_pair(txDevice, rxDevice);
 	key_t keyReverse = std::make_pair(rxDevice, txDevice);
 
 	std::map<key_t, Ptr<Params3gpp>>::iterator it = m_channelMap.find(key);
@@ -662,7 +770,7 @@ MmWave3gppChannel::DoCalcRxPowerSpectralDensity(Ptr<const SpectrumValue> txPsd,
 	//180820-jskim14-update analog beamforming vector periodically
 	if (txAntennaArray->IsOmniTx() || rxAntennaArray->IsOmniTx()) //control
 	{
-		if (txEnb != 0 && rxMcUe != 0 && rxUe == 0) //downlink
+		if (downlinkMc) //downlink
 		{
 			if ((m_nrTxMode == 1) && (!m_cellScan))
 			{
@@ -703,7 +811,7 @@ MmWave3gppChannel::DoCalcRxPowerSpectralDensity(Ptr<const SpectrumValue> txPsd,
 			}
 		}
 		//omi transmission, do nothing.
-		return rxPsd;
+		return false;
 	}
 
 	bool reverseLink = false;
@@ -772,7 +880,7 @@ MmWave3gppChannel::DoCalcRxPowerSpectralDensity(Ptr<const SpectrumValue> txPsd,
 		double y = a->GetPosition().y - b->GetPosition().y;
 		double distance2D = sqrt(x * x + y * y);
 		double hUT, hBS;
-		if (rxUe != 0 || rxMcUe != 0)
+		if (downlink || downlinkMc)
 		{
 			hUT = b->GetPosition().z;
 			hBS = a->GetPosition().z;
@@ -925,7 +1033,7 @@ MmWave3gppChannel::DoCalcRxPowerSpectralDensity(Ptr<const SpectrumValue> txPsd,
 				NS_LOG_INFO("channelParams->m_txW.size() == 0 " << (channelParams->m_txW.size() == 0));
 				NS_LOG_INFO("channelParams->m_rxW.size() == 0 " << (channelParams->m_rxW.size() == 0));
 				m_channelMap[key] = channelParams;
-				return rxPsd;
+				return false;
 			}
 		}
 
@@ -942,20 +1050,89 @@ MmWave3gppChannel::DoCalcRxPowerSpectralDensity(Ptr<const SpectrumValue> txPsd,
 		channelParams = (*itReverse).second;
 	}
 
-	Ptr<SpectrumValue> bfPsd = CalBeamformingGain(rxPsd, channelParams, relativeSpeed);
+	prep.m_link = &link;
+	prep.m_params = channelParams;
+	prep.m_speed = relativeSpeed;
+	prep.m_time = Simulator::Now().GetSeconds();
+	prep.m_reverseLink = reverseLink;
+	prep.m_cachedGain = m_channelCache && relativeSpeed.GetLength() == 0;
+	NS_LOG_INFO("Relative speed=" << relativeSpeed.x << ", " << relativeSpeed.y << ", " << relativeSpeed.z);
+	if (prep.m_cachedGain)
+	{
+		//without relative motion there is no Doppler term, so the gain of every subband only depends on
+		//the channel realization and on the beams, which are both reflected in channelParams.
+		bool moved = CalculateDistance(link.m_txPosition, a->GetPosition()) > m_channelCacheDistance ||
+					 CalculateDistance(link.m_rxPosition, b->GetPosition()) > m_channelCacheDistance;
+		if (link.m_gain == 0 || link.m_params != channelParams || link.m_longTermVersion != channelParams->m_longTermVersion ||
+			link.m_gain->GetSpectrumModel() != rxPsd->GetSpectrumModel() || moved)
+		{
+			NS_LOG_LOGIC("Refresh the cached beamforming gain");
+			Ptr<SpectrumValue> flatPsd = Create<SpectrumValue>(rxPsd->GetSpectrumModel());
+			(*flatPsd) = 1.0;
+			CalBeamformingGain(*flatPsd, *channelParams, relativeSpeed, prep.m_time, m_gainScratch);
+			link.m_gain = flatPsd;
+			link.m_params = channelParams;
+			link.m_longTermVersion = channelParams->m_longTermVersion;
+			link.m_txPosition = a->GetPosition();
+			link.m_rxPosition = b->GetPosition();
+		}
+	}
+	return true;
+}
 
-	SpectrumValue bfGain = (*bfPsd) / (*rxPsd);
-	uint8_t nbands = bfGain.GetSpectrumModel()->GetNumBands();
-	double avgRxPsd = Sum(*rxPsd) / nbands;
-	if (reverseLink == false)
+void
+MmWave3gppChannel::ApplyLinkGain(const PreparedLink3gpp &prep, SpectrumValue &psd, SubbandGainScratch &scratch) const
+{
+	if (prep.m_cachedGain)
 	{
-		NS_LOG_UNCOND("****** DL BF gain == " << 10 * std::log10(Sum(bfGain) / nbands) << ", RX PSD[dB]=" << 10 * log10(avgRxPsd)); // print avg bf gain
+		psd *= (*prep.m_link->m_gain);
 	}
 	else
 	{
-		NS_LOG_DEBUG("****** UL BF gain == " << 10 * std::log10(Sum(bfGain) / nbands) << " RX PSD " << Sum(*rxPsd) / nbands);
+		CalBeamformingGain(psd, *prep.m_params, prep.m_speed, prep.m_time, scratch);
+	}
+}
+
+void
+MmWave3gppChannel::LogLinkGain(const PreparedLink3gpp &prep, double rxSum, double gainSum, uint8_t nbands) const
+{
+	if (prep.m_reverseLink == false)
+	{
+		NS_LOG_UNCOND("****** DL BF gain == " << 10 * std::log10(gainSum / nbands) << ", RX PSD[dB]=" << 10 * log10(rxSum / nbands)); // print avg bf gain
+	}
+	else
+	{
+		NS_LOG_DEBUG("****** UL BF gain == " << 10 * std::log10(gainSum / nbands) << " RX PSD " << rxSum / nbands);
+	}
+}
+
+MmWave3gppRxPsdTask::MmWave3gppRxPsdTask(const MmWave3gppChannel *channel)
+	: m_beamformed(false),
+	  m_channel(channel),
+	  m_rxSum(0),
+	  m_gainSum(0)
+{
+}
+
+void
+MmWave3gppRxPsdTask::Apply(SpectrumValue &psd)
+{
+	if (!m_beamformed)
+	{
+		return;
+	}
+	m_rxValues.assign(psd.ConstValuesBegin(), psd.ConstValuesEnd());
+	m_channel->ApplyLinkGain(m_prep, psd, m_scratch);
+	SumLinkGain(m_rxValues.begin(), m_rxValues.end(), psd.ConstValuesBegin(), m_rxSum, m_gainSum);
+}
+
+void
+MmWave3gppRxPsdTask::Finish(const SpectrumValue &psd)
+{
+	if (m_beamformed)
+	{
+		m_channel->LogLinkGain(m_prep, m_rxSum, m_gainSum, m_rxValues.size());
 	}
-	return bfPsd;
 }
 
 void MmWave3gppChannel::LongTermCovMatrixBeamforming(Ptr<Params3gpp> params) const
@@ -1106,18 +1283,15 @@ void MmWave3gppChannel::LongTermCovMatrixBeamforming(Ptr<Params3gpp> params) con
 	params->m_rxW = antennaWeights;
 }
 
-Ptr<SpectrumValue>
-MmWave3gppChannel::CalBeamformingGain(Ptr<const SpectrumValue> txPsd, Ptr<Params3gpp> params, Vector speed) const
+void
+MmWave3gppChannel::CalBeamformingGain(SpectrumValue &psd, const Params3gpp &params, Vector speed,
+									  double slotTime, SubbandGainScratch &scratch) const
 {
-	NS_LOG_FUNCTION(this);
-
-	Ptr<SpectrumValue> tempPsd = Copy<SpectrumValue>(txPsd);
+	//no logging here, this is called by MmWave3gppRxPsdTask::Apply on worker threads
 
 	//180714-jskim14
 	Vector relativeSpeed = speed;
-	NS_LOG_INFO("Relative speed=" << relativeSpeed.x << ", " << relativeSpeed.y << ", " << relativeSpeed.z);
 	Angles velocity_angle = Angles(relativeSpeed);
-	NS_LOG_INFO("Velocity angle: theta=" << velocity_angle.theta * 180 / M_PI << ", phi=" << velocity_angle.phi * 180 / M_PI);
 	//jskim14-end
 
 	//NS_ASSERT_MSG (params->m_delay.size()==params->m_channel.at(0).at(0).size(), "the cluster number of channel and delay spread should be the same");
@@ -1127,14 +1301,21 @@ MmWave3gppChannel::CalBeamformingGain(Ptr<const SpectrumValue> txPsd, Ptr<Params
 	//NS_ASSERT_MSG (params->m_angle.at(1).size()==params->m_channel.at(0).at(0).size(), "the cluster number of channel and ZOA should be the same");
 
 	//channel[rx][tx][cluster]
-	uint8_t numCluster = params->m_delay.size();
+	uint8_t numCluster = params.m_delay.size();
 	//uint8_t txAntenna = params->m_txW.size();
 	//uint8_t rxAntenna = params->m_rxW.size();
 	//the update of Doppler is simplified by only taking the center angle of each cluster in to consideration.
-	Values::iterator vit = tempPsd->ValuesBegin();
-	uint16_t iSubband = 0;
-	double slotTime = Simulator::Now().GetSeconds();
-	complexVector_t doppler;
+	double f0 = m_phyMacConfig->GetCenterFrequency() - GetSystemBandwidth() / 2;
+	double chunkWidth = m_phyMacConfig->GetChunkWidth();
+
+	//Per cluster, the term of subband s is longTerm*doppler*exp(-j*2*pi*(f0+s*chunkWidth)*delay),
+	//so it is generated by recurrence with the rotator exp(-j*2*pi*chunkWidth*delay) instead of one exp per subband.
+	//The terms are kept as separate real and imaginary arrays so that the cluster loops vectorize.
+	scratch.Resize(numCluster);
+	double *termRe = scratch.m_termRe.data();
+	double *termIm = scratch.m_termIm.data();
+	double *rotRe = scratch.m_rotRe.data();
+	double *rotIm = scratch.m_rotIm.data();
 	for (uint8_t cIndex = 0; cIndex < numCluster; cIndex++)
 	{
 		double temp_doppler;
@@ -1145,30 +1326,38 @@ MmWave3gppChannel::CalBeamformingGain(Ptr<const SpectrumValue> txPsd, Ptr<Params
 		else
 		{
 			//cluster angle angle[direction][n],where, direction = 0(aoa), 1(zoa).
-			temp_doppler = 2 * M_PI * (sin(params->m_angle.at(ZOA_INDEX).at(cIndex) * M_PI / 180) * cos(params->m_angle.at(AOA_INDEX).at(cIndex) * M_PI / 180) * speed.x * (sin(velocity_angle.theta) * cos(velocity_angle.phi)) + sin(params->m_angle.at(ZOA_INDEX).at(cIndex) * M_PI / 180) * sin(params->m_angle.at(AOA_INDEX).at(cIndex) * M_PI / 180) * speed.y * (sin(velocity_angle.theta) * sin(velocity_angle.phi)) + cos(params->m_angle.at(ZOA_INDEX).at(cIndex) * M_PI / 180) * speed.z * cos(velocity_angle.theta)) * slotTime * m_phyMacConfig->GetCenterFrequency() / 3e8;
+			temp_doppler = 2 * M_PI * (sin(params.m_angle.at(ZOA_INDEX).at(cIndex) * M_PI / 180) * cos(params.m_angle.at(AOA_INDEX).at(cIndex) * M_PI / 180) * speed.x * (sin(velocity_angle.theta) * cos(velocity_angle.phi)) + sin(params.m_angle.at(ZOA_INDEX).at(cIndex) * M_PI / 180) * sin(params.m_angle.at(AOA_INDEX).at(cIndex) * M_PI / 180) * speed.y * (sin(velocity_angle.theta) * sin(velocity_angle.phi)) + cos(params.m_angle.at(ZOA_INDEX).at(cIndex) * M_PI / 180) * speed.z * cos(velocity_angle.theta)) * slotTime * m_phyMacConfig->GetCenterFrequency() / 3e8;
 		}
-		doppler.push_back(exp(std::complex<double>(0, temp_doppler)));
+		double delay = params.m_delay.at(cIndex);
+		std::complex<double> term = params.m_longTerm.at(cIndex) * exp(std::complex<double>(0, temp_doppler - 2 * M_PI * f0 * delay));
+		termRe[cIndex] = term.real();
+		termIm[cIndex] = term.imag();
+		rotRe[cIndex] = cos(-2 * M_PI * chunkWidth * delay);
+		rotIm[cIndex] = sin(-2 * M_PI * chunkWidth * delay);
 	}
 
-	while (vit != tempPsd->ValuesEnd())
+	for (Values::iterator vit = psd.ValuesBegin(); vit != psd.ValuesEnd(); vit++)
 	{
-		std::complex<double> subsbandGain(0.0, 0.0);
 		if ((*vit) != 0.00)
 		{
-			double fsb = m_phyMacConfig->GetCenterFrequency() - GetSystemBandwidth() / 2 + m_phyMacConfig->GetChunkWidth() * iSubband;
+			double gainRe = 0;
+			double gainIm = 0;
 			for (uint8_t cIndex = 0; cIndex < numCluster; cIndex++)
 			{
-				double delay = -2 * M_PI * fsb * (params->m_delay.at(cIndex));
-				std::complex<double> txSum(0, 0);
-
-				subsbandGain = subsbandGain + params->m_longTerm.at(cIndex) * exp(std::complex<double>(0, delay)) * doppler.at(cIndex);
+				gainRe += termRe[cIndex];
+				gainIm += termIm[cIndex];
 			}
-			*vit = (*vit) * (norm(subsbandGain));
+			*vit = (*vit) * (gainRe * gainRe + gainIm * gainIm);
+		}
+		//move every cluster term to the next subband
+		for (uint8_t cIndex = 0; cIndex < numCluster; cIndex++)
+		{
+			double re = termRe[cIndex] * rotRe[cIndex] - termIm[cIndex] * rotIm[cIndex];
+			double im = termRe[cIndex] * rotIm[cIndex] + termIm[cIndex] * rotRe[cIndex];
+			termRe[cIndex] = re;
+			termIm[cIndex] = im;
 		}
-		vit++;
-		iSubband++;
 	}
-	return tempPsd;
 }
 
 double
@@ -1203,6 +1392,20 @@ void MmWave3gppChannel::SetNrTxMode(uint8_t nrTxMode)
 }
 // jskim14-end
 
+void MmWave3gppChannel::GetActiveSubbands(Ptr<const SpectrumValue> txPsd, doubleVector_t &subbandFreq) const
+{
+	subbandFreq.clear();
+	double fsb = m_phyMacConfig->GetCenterFrequency() - GetSystemBandwidth() / 2;
+	for (Values::const_iterator vit = txPsd->ConstValuesBegin(); vit != txPsd->ConstValuesEnd(); vit++)
+	{
+		if ((*vit) != 0.00)
+		{
+			subbandFreq.push_back(fsb);
+		}
+		fsb += m_phyMacConfig->GetChunkWidth();
+	}
+}
+
 void MmWave3gppChannel::CalLongTerm(Ptr<Params3gpp> params) const
 {
 	//180709-jskim14-consider NR tx mode
@@ -1210,8 +1413,8 @@ void MmWave3gppChannel::CalLongTerm(Ptr<Params3gpp> params) const
 	uint16_t rxAntenna;
 	if (m_nrTxMode == 1)
 	{
-		txAntenna = params->m_txWMat.size(); //actually, this is vector.
-		rxAntenna = params->m_rxWMat.size(); //actually, this is vector.
+		txAntenna = params->m_txWMat.GetNumRows(); //actually, this is vector.
+		rxAntenna = params->m_rxWMat.GetNumRows(); //actually, this is vector.
 	}
 	else
 	{
@@ -1238,7 +1441,7 @@ void MmWave3gppChannel::CalLongTerm(Ptr<Params3gpp> params) const
 				//180709-jskim14-consider NR tx mode
 				if (m_nrTxMode == 1)
 				{
-					rxSum = rxSum + std::conj(params->m_rxWMat[rxIndex][0]) * params->m_channel.at(rxIndex).at(txIndex).at(cIndex);
+					rxSum = rxSum + std::conj(params->m_rxWMat(rxIndex, 0)) * params->m_channel.at(rxIndex).at(txIndex).at(cIndex);
 					//NS_LOG_UNCOND("RX beamvector[" << (unsigned)rxIndex << "]=" << params->m_rxWMat[rxIndex][0] << "Channel[" << (unsigned)rxIndex << "][" << (unsigned)txIndex << "][" << (unsigned)cIndex << "]=" << params->m_channel.at(rxIndex).at(txIndex).at(cIndex));
 				}
 				else
@@ -1251,7 +1454,7 @@ void MmWave3gppChannel::CalLongTerm(Ptr<Params3gpp> params) const
 			//180709-jskim14-consider NR tx mode
 			if (m_nrTxMode == 1)
 			{
-				txSum = txSum + params->m_txWMat[txIndex][0] * rxSum;
+				txSum = txSum + params->m_txWMat(txIndex, 0) * rxSum;
 			}
 			else
 			//jskim14-end
@@ -1263,6 +1466,7 @@ void MmWave3gppChannel::CalLongTerm(Ptr<Params3gpp> params) const
 		//NS_LOG_UNCOND("Cluster power[" << (unsigned)cIndex << "]=" << txSum);
 	}
 	params->m_longTerm = longTerm;
+	params->m_longTermVersion++;
 }
 
 Ptr<ParamsTable>
@@ -3396,44 +3600,48 @@ MmWave3gppChannel::UpdateChannel(Ptr<Params3gpp> params3gpp, Ptr<ParamsTable> ta
 void MmWave3gppChannel::BeamSearchBeamforming(Ptr<const SpectrumValue> txPsd, Ptr<Params3gpp> params, Ptr<AntennaArrayModel> txAntenna,
 											  Ptr<AntennaArrayModel> rxAntenna, uint8_t *txAntennaNum, uint8_t *rxAntennaNum) const
 {
-	double max = 0, maxTx = 0, maxRx = 0, maxTxTheta = 0, maxRxTheta = 0;
 	NS_LOG_UNCOND("BeamSearchBeamforming method at time " << Simulator::Now().GetSeconds());
-	for (uint16_t txTheta = 60; txTheta < 121; txTheta = txTheta + 10)
+	//the sector codebook, beam index = thetaIndex * (number of sectors) + sector
+	const uint16_t minTheta = 60, maxTheta = 120, thetaStep = 10;
+	uint16_t thetaNum = (maxTheta - minTheta) / thetaStep + 1;
+	uint16_t txSectorNum = txAntennaNum[1] + 1;
+	uint16_t rxSectorNum = rxAntennaNum[1] + 1;
+	ComplexMatrix txCodebook(txAntennaNum[0] * txAntennaNum[1], thetaNum * txSectorNum);
+	ComplexMatrix rxCodebook(rxAntennaNum[0] * rxAntennaNum[1], thetaNum * rxSectorNum);
+	for (uint16_t thetaIndex = 0; thetaIndex < thetaNum; thetaIndex++)
 	{
-		for (uint16_t tx = 0; tx <= txAntennaNum[1]; tx++)
+		uint16_t theta = minTheta + thetaIndex * thetaStep;
+		for (uint16_t tx = 0; tx < txSectorNum; tx++)
 		{
-			for (uint16_t rxTheta = 60; rxTheta < 121; rxTheta = rxTheta + 10)
+			txAntenna->SetSector(tx, txAntennaNum, theta);
+			complexVector_t weights = txAntenna->GetBeamformingVector();
+			for (uint16_t i = 0; i < weights.size(); i++)
 			{
-				for (uint16_t rx = 0; rx <= rxAntennaNum[1]; rx++)
-				{
-					NS_LOG_LOGIC("txTheta " << txTheta << " rxTheta " << rxTheta << " tx sector " << (M_PI * (double)tx / (double)txAntennaNum[1] - 0.5 * M_PI) / (M_PI)*180 << " rx sector " << (M_PI * (double)rx / (double)rxAntennaNum[1] - 0.5 * M_PI) / (M_PI)*180);
-
-					txAntenna->SetSector(tx, txAntennaNum, txTheta);
-					rxAntenna->SetSector(rx, rxAntennaNum, rxTheta);
-					params->m_txW = txAntenna->GetBeamformingVector();
-					params->m_rxW = rxAntenna->GetBeamformingVector();
-					CalLongTerm(params);
-					Ptr<SpectrumValue> bfPsd = CalBeamformingGain(txPsd, params, Vector(0, 0, 0));
-
-					SpectrumValue bfGain = (*bfPsd) / (*txPsd);
-					uint8_t nbands = bfGain.GetSpectrumModel()->GetNumBands();
-					double power = Sum(bfGain) / nbands;
-
-					NS_LOG_LOGIC("gain " << power);
-					if (max < power)
-					{
-						max = power;
-						maxTx = tx;
-						maxRx = rx;
-						maxTxTheta = txTheta;
-						maxRxTheta = rxTheta;
-					}
-				}
+				txCodebook(i, thetaIndex * txSectorNum + tx) = weights[i];
+			}
+		}
+		for (uint16_t rx = 0; rx < rxSectorNum; rx++)
+		{
+			rxAntenna->SetSector(rx, rxAntennaNum, theta);
+			complexVector_t weights = rxAntenna->GetBeamformingVector();
+			for (uint16_t i = 0; i < weights.size(); i++)
+			{
+				rxCodebook(i, thetaIndex * rxSectorNum + rx) = weights[i];
 			}
 		}
 	}
+
+	doubleVector_t subbandFreq;
+	GetActiveSubbands(txPsd, subbandFreq);
+	m_beamSweep.SetHierarchical(m_hierarchicalBeamSearch, m_beamSearchCandidates);
+	MmWaveBeamSweep::Result best = m_beamSweep.Sweep(params->m_channel, params->m_delay, txCodebook, rxCodebook, subbandFreq);
+
+	uint16_t maxTx = best.m_txBeam % txSectorNum;
+	uint16_t maxRx = best.m_rxBeam % rxSectorNum;
+	uint16_t maxTxTheta = minTheta + (best.m_txBeam / txSectorNum) * thetaStep;
+	uint16_t maxRxTheta = minTheta + (best.m_rxBeam / rxSectorNum) * thetaStep;
 	NS_LOG_LOGIC("maxTx " << maxTx << " txAntennaNum[1] " << (uint16_t)txAntennaNum[1]);
-	NS_LOG_LOGIC("max gain " << max << " maxTx " << (M_PI * (double)maxTx / (double)txAntennaNum[1] - 0.5 * M_PI) / (M_PI)*180 << " maxRx " << (M_PI * (double)maxRx / (double)rxAntennaNum[1] - 0.5 * M_PI) / (M_PI)*180 << " maxTxTheta " << maxTxTheta << " maxRxTheta " << maxRxTheta);
+	NS_LOG_LOGIC("max gain " << best.m_gain << " maxTx " << (M_PI * (double)maxTx / (double)txAntennaNum[1] - 0.5 * M_PI) / (M_PI)*180 << " maxRx " << (M_PI * (double)maxRx / (double)rxAntennaNum[1] - 0.5 * M_PI) / (M_PI)*180 << " maxTxTheta " << maxTxTheta << " maxRxTheta " << maxRxTheta);
 	txAntenna->SetSector(maxTx, txAntennaNum, maxTxTheta);
 	rxAntenna->SetSector(maxRx, rxAntennaNum, maxRxTheta);
 	params->m_txW = txAntenna->GetBeamformingVector();
@@ -3444,61 +3652,24 @@ void MmWave3gppChannel::BeamSearchBeamforming(Ptr<const SpectrumValue> txPsd, Pt
 void MmWave3gppChannel::IdealBeamforming(Ptr<const SpectrumValue> txPsd, Ptr<Params3gpp> params, Ptr<AntennaArrayModel> txAntenna,
 										 Ptr<AntennaArrayModel> rxAntenna, uint8_t *txAntennaNum, uint8_t *rxAntennaNum) const
 {
-	complex2DVector_t txWeight = txAntenna->GetAntennaWeightMatrix();
-	complex2DVector_t rxWeight = rxAntenna->GetAntennaWeightMatrix();
-	NS_LOG_INFO("# of Tx antenna element: " << txWeight.size() << ", # of Tx beams: " << txWeight[0].size());
-	NS_LOG_INFO("# of Rx antenna element: " << rxWeight.size() << ", # of Rx beams: " << rxWeight[0].size());
-	uint16_t txBeamNum = txWeight[0].size();
-	uint16_t rxBeamNum = rxWeight[0].size();
+	const ComplexMatrix &txWeight = txAntenna->GetAntennaWeightMatrix();
+	const ComplexMatrix &rxWeight = rxAntenna->GetAntennaWeightMatrix();
+	NS_LOG_INFO("# of Tx antenna element: " << txWeight.GetNumRows() << ", # of Tx beams: " << txWeight.GetNumCols());
+	NS_LOG_INFO("# of Rx antenna element: " << rxWeight.GetNumRows() << ", # of Rx beams: " << rxWeight.GetNumCols());
+	uint16_t txBeamNum = txWeight.GetNumCols();
+	uint16_t rxBeamNum = rxWeight.GetNumCols();
 
 	// Vector txTxru = txAntenna->GetTxruNum();
 	// Vector rxTxru = rxAntenna->GetTxruNum();
 
-	double max = 0, maxTx = 0, maxRx = 0;
-	for (uint16_t tx = 0; tx < txBeamNum; tx++)
-	{
-		complex2DVector_t txBSMat(txBeamNum, complexVector_t(1, 0)); //Initialize Tx beam selection matrix
-		for (uint16_t cI = 0; cI < 1; cI++)
-		{
-			txBSMat[tx][cI] = 1;
-		}
-		for (uint16_t rx = 0; rx < rxBeamNum; rx++)
-		{
-			// uint16_t vTx = tx % (uint16_t)txTxru.x;
-			// uint16_t hTx = tx / (uint16_t)txTxru.x;
-			// uint16_t vRx = rx % (uint16_t)rxTxru.x;
-			// uint16_t hRx = rx / (uint16_t)rxTxru.x;
-			//hBeamInd*m_vTxruNum+vBeamInd
-			//NS_LOG_INFO("Tx index=" << tx << ", elevation degree=" << (double)180 / (txTxru.x) * (vTx + 1) << ", azimuth degree=" << (double)360 / (txTxru.y * txTxru.z) * (hTx + 1) - 180 <<
-			//		 	  ", Rx index=" << rx << ", elevation degree=" << (double)180 / (rxTxru.x) * (vRx + 1) << ", azimuth degree=" << (double)360 / (rxTxru.y * rxTxru.z) * (hRx + 1) - 180);
-			NS_LOG_INFO("Tx elevation: index=" << tx << ", degree=" << (double)180 / txBeamNum * (tx + 1) << ", rx elevation: index=" << rx << ", degree=" << (double)180 / rxBeamNum * (rx + 1));
-
-			complex2DVector_t rxBSMat(rxBeamNum, complexVector_t(1, 0)); //Initialize Rx beam selection matrix
-			for (uint16_t cI = 0; cI < 1; cI++)
-			{
-				rxBSMat[rx][cI] = 1;
-			}
-			params->m_txWMat = Multiplication(txWeight, txBSMat);
-			params->m_rxWMat = Multiplication(rxWeight, rxBSMat);
-
-			CalLongTerm(params);
-			Ptr<SpectrumValue> bfPsd = CalBeamformingGain(txPsd, params, Vector(0, 0, 0));
-			SpectrumValue bfGain = (*bfPsd) / (*txPsd);
-			uint8_t nbands = bfGain.GetSpectrumModel()->GetNumBands();
-			double power = Sum(bfGain) / nbands;
-			double priorPower = Sum(*txPsd) / nbands;
-			double afterPower = Sum(*bfPsd) / nbands;
-
-			NS_LOG_INFO("Gain=" << power << ", Prior power=" << priorPower << ", After power=" << afterPower << ", nbands=" << (unsigned)nbands);
-
-			if (max < power)
-			{
-				max = power;
-				maxTx = tx;
-				maxRx = rx;
-			}
-		}
-	}
+	//score every (tx beam, rx beam) pair of the weight matrices in one batched sweep
+	doubleVector_t subbandFreq;
+	GetActiveSubbands(txPsd, subbandFreq);
+	m_beamSweep.SetHierarchical(m_hierarchicalBeamSearch, m_beamSearchCandidates);
+	MmWaveBeamSweep::Result best = m_beamSweep.Sweep(params->m_channel, params->m_delay, txWeight, rxWeight, subbandFreq);
+	double max = best.m_gain;
+	uint16_t maxTx = best.m_txBeam;
+	uint16_t maxRx = best.m_rxBeam;
 
 	// uint16_t vTx = (uint16_t)maxTx % (uint16_t)txTxru.x;
 	// uint16_t hTx = (uint16_t)maxTx / (uint16_t)txTxru.x;
@@ -3508,171 +3679,14 @@ void MmWave3gppChannel::IdealBeamforming(Ptr<const SpectrumValue> txPsd, Ptr<Par
 	//			  ", Max Rx index=" << maxRx << ", elevation degree=" << (double)180 / (rxTxru.x) * (vRx + 1) << ", azimuth degree=" << (double)120 / (rxTxru.y * rxTxru.z) * (hRx + 1) - 120);
 	NS_LOG_UNCOND("maxTx elevation: index=" << maxTx << ", degree=" << (double)180 / txBeamNum * (maxTx + 1) << ", maxRx elevation: index=" << maxRx << ", degree=" << (double)180 / rxBeamNum * (maxRx + 1));
 	NS_LOG_UNCOND("Gain [dB]=" << 10 * std::log10(max));
-	complex2DVector_t maxTxBSMat(txBeamNum, complexVector_t(1, 0)); //Initialize Tx beam selection matrix
-	for (uint16_t cI = 0; cI < 1; cI++)
-	{
-		maxTxBSMat[maxTx][cI] = 1;
-	}
-	complex2DVector_t maxRxBSMat(rxBeamNum, complexVector_t(1, 0)); //Initialize Rx beam selection matrix
-	for (uint16_t cI = 0; cI < 1; cI++)
-	{
-		maxRxBSMat[maxRx][cI] = 1;
-	}
-	params->m_txWMat = Multiplication(txWeight, maxTxBSMat);
-	params->m_rxWMat = Multiplication(rxWeight, maxRxBSMat);
-}
-
-complex2DVector_t
-MmWave3gppChannel::Multiplication(complex2DVector_t mtx1, complex2DVector_t mtx2) const
-{
-	int r1 = mtx1.size();
-	int c1 = mtx1[0].size();
-	int r2 = mtx2.size();
-	int c2 = mtx2[0].size();
-
-	if (c1 != r2)
-	{
-		NS_FATAL_ERROR("Matrix multiplication error !");
-	}
-
-	complex2DVector_t mtx3(r1, complexVector_t(c2, 0));
-	for (int i = 0; i < r1; i++)
-	{
-		for (int j = 0; j < c2; j++)
-		{
-			mtx3[i][j] = 0;
-			for (int k = 0; k < r2; k++)
-			{
-				mtx3[i][j] += mtx1[i][k] * mtx2[k][j];
-			}
-		}
-	}
-	return mtx3;
-}
-
-complex2DVector_t
-MmWave3gppChannel::Transpose(complex2DVector_t mtx)
-{
-	int r = mtx.size();
-	int c = mtx[0].size();
-
-	complex2DVector_t temp(c, std::vector<std::complex<double>>(r, 0));
-
-	for (int i = 0; i < r; i++)
-	{
-		for (int j = 0; j < c; j++)
-		{
-			temp[j][i] = mtx[i][j];
-		}
-	}
-	return temp;
+	ComplexMatrix txBSMat(txBeamNum, 1); //Tx beam selection matrix
+	ComplexMatrix rxBSMat(rxBeamNum, 1); //Rx beam selection matrix
+	txBSMat(maxTx, 0) = 1;
+	rxBSMat(maxRx, 0) = 1;
+	ComplexMatrix::Multiply(txWeight, txBSMat, params->m_txWMat);
+	ComplexMatrix::Multiply(rxWeight, rxBSMat, params->m_rxWMat);
 }
 
-std::complex<double>
-MmWave3gppChannel::Determinant(complex2DVector_t mtx, int size)
-{
-	std::complex<double> det = std::complex<double>(0, 0);
-
-	if (size < 1)
-	{ /* Error */
-	}
-	else if (size == 1)
-	{ /* Shouldn't get used */
-		det = mtx[0][0];
-	}
-	else if (size == 2)
-	{
-		det = mtx[0][0] * mtx[1][1] - mtx[1][0] * mtx[0][1];
-	}
-	else
-	{
-		int i, j, j1, j2;
-		complex2DVector_t m(size, complexVector_t(size, 0));
-		for (j1 = 0; j1 < size; j1++)
-		{
-			for (i = 1; i < size; i++)
-			{
-				j2 = 0;
-				for (j = 0; j < size; j++)
-				{
-					if (j == j1)
-						continue;
-					m[i - 1][j2] = mtx[i][j];
-					j2++;
-				}
-			}
-			det += std::pow(-1.0, j1 + 2.0) * mtx[0][j1] * Determinant(m, size - 1);
-		}
-	}
-	//NS_LOG_ERROR("determinant: "<<det);
-	//NS_LOG_ERROR("mtx: "<<mtx[0][0]<<"  "<<mtx[0][1]<<"  "<<mtx[1][0]<<"  "<<mtx[1][1]);
-	return det;
-}
-
-complex2DVector_t
-MmWave3gppChannel::Inverse(complex2DVector_t mtx)
-{
-	int i, j, ii, jj, i1, j1;
-	std::complex<double> det;
-
-	int size = mtx.size();
-	complex2DVector_t c(size, complexVector_t(size, 0));
-	complex2DVector_t cmtx(size, complexVector_t(size, 0));
-	complex2DVector_t temp(size, complexVector_t(size, 0));
-
-	for (j = 0; j < size; j++)
-	{
-		for (i = 0; i < size; i++)
-		{
-			/* Form the adjoint a_ij */
-			i1 = 0;
-			for (ii = 0; ii < size; ii++)
-			{
-				if (ii == i)
-					continue;
-				j1 = 0;
-				for (jj = 0; jj < size; jj++)
-				{
-					if (jj == j)
-						continue;
-					c[i1][j1] = mtx[ii][jj];
-					j1++;
-				}
-				i1++;
-			}
-
-			/* Calculate the determinate */
-			det = Determinant(c, size - 1);
-
-			/* Fill in the elements of the cofactor */
-			cmtx[i][j] = std::pow(-1.0, i + j + 2.0) * det;
-		}
-	}
-	temp = Transpose(cmtx);
-	std::complex<double> determinant = Determinant(mtx, size);
-	for (int i = 0; i < size; i++)
-		for (int j = 0; j < size; j++)
-			temp[i][j] /= determinant;
-
-	return temp;
-}
-
-complex2DVector_t
-MmWave3gppChannel::Hermitian(complex2DVector_t mtx)
-{
-	complex2DVector_t temp = Transpose(mtx);
-	int r = temp.size();
-	int c = temp[0].size();
-
-	for (int i = 0; i < r; i++)
-	{
-		for (int j = 0; j < c; j++)
-		{
-			temp[i][j] = std::conj(temp[i][j]);
-		}
-	}
-	return temp;
-}
 //jskim14-end
 
 doubleVector_t
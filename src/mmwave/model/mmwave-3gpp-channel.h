@@ -40,6 +40,8 @@
 #include "ns3/mmwave-phy-mac-common.h"
 #include "ns3/mmwave-3gpp-propagation-loss-model.h"
 #include <ns3/antenna-array-model.h>
+#include <ns3/mmwave-complex-matrix.h>
+#include <ns3/mmwave-beam-sweep.h>
 #include "ns3/mmwave-3gpp-buildings-propagation-loss-model.h"
 
 #define AOA_INDEX 0
@@ -78,11 +80,12 @@ struct Params3gpp : public SimpleRefCount<Params3gpp>
 	doubleVector_t  		m_delay; // cluster delay.
 	double2DVector_t		m_angle; //cluster angle angle[direction][n], where direction = 0(aoa), 1(zoa), 2(aod), 3(zod) in degree.
 	complexVector_t 		m_longTerm; // long term conponet.
+	uint32_t				m_longTermVersion = 0; // incremented every time m_longTerm is recomputed
 
 	double2DVector_t		m_nonSelfBlocking; // store the blockages
 
-	complex2DVector_t		m_txWMat; //180709-jskim14-tx weight matrix
-	complex2DVector_t		m_rxWMat; //180709-jskim14-rx weight matrix
+	ComplexMatrix			m_txWMat; //180709-jskim14-tx weight matrix
+	ComplexMatrix			m_rxWMat; //180709-jskim14-rx weight matrix
 
 	/*The following parameters are stored for spatial consistent updating*/
 	Vector m_preLocUT; // location of UT when generating the previous channel
@@ -170,12 +173,72 @@ struct ParamsTable: public Object
 
 };
 
+/**
+ * Per-cluster scratch arrays of MmWave3gppChannel::CalBeamformingGain, in SoA layout
+ */
+struct SubbandGainScratch
+{
+	doubleVector_t m_termRe; // real part of the current subband term of each cluster
+	doubleVector_t m_termIm; // imaginary part of the current subband term of each cluster
+	doubleVector_t m_rotRe; // real part of the per-subband phase rotator of each cluster
+	doubleVector_t m_rotIm; // imaginary part of the per-subband phase rotator of each cluster
+
+	void Resize (uint8_t numCluster)
+	{
+		m_termRe.resize (numCluster);
+		m_termIm.resize (numCluster);
+		m_rotRe.resize (numCluster);
+		m_rotIm.resize (numCluster);
+	}
+};
+
+/**
+ * Per-link state of MmWave3gppChannel, kept across DoCalcRxPowerSpectralDensity calls.
+ * The first part classifies the link, the second part caches the frequency domain
+ * beamforming gain of a link without relative motion.
+ */
+struct LinkCache3gpp
+{
+	bool m_classified = false;
+	bool m_beamformed = false; // false for eNB to eNB and UE to UE links
+	bool m_downlink = false;
+	bool m_downlinkMc = false;
+	bool m_uplink = false;
+	bool m_uplinkMc = false;
+	uint8_t m_txAntennaNum[3] = {0, 0, 0}; // vertical, horizontal, polarization
+	uint8_t m_rxAntennaNum[3] = {0, 0, 0};
+	Ptr<AntennaArrayModel> m_txAntennaArray;
+	Ptr<AntennaArrayModel> m_rxAntennaArray;
+
+	Ptr<SpectrumValue> m_gain; // linear gain of every subband, null if not computed yet
+	Ptr<Params3gpp> m_params; // channel realization the gain was computed from
+	uint32_t m_longTermVersion = 0; // beam state the gain was computed from
+	Vector m_txPosition;
+	Vector m_rxPosition;
+};
+
+/**
+ * Beamforming gain computation of one MmWave3gppChannel link, as prepared on the simulator thread.
+ * Everything it points to is only read while the gain is applied.
+ */
+struct PreparedLink3gpp
+{
+	LinkCache3gpp *m_link = 0;
+	Ptr<Params3gpp> m_params;
+	Vector m_speed; // relative speed between UE and eNB
+	double m_time = 0; // time [s] of the Doppler phase
+	bool m_reverseLink = false;
+	bool m_cachedGain = false; // true to apply m_link->m_gain instead of computing the gain
+};
+
 /**
  * \brief This class implements the fading computation of the 3GPP TR 38.900 channel model and performs the 
  * beamforming gain computation. It implements the SpectrumPropagationLossModel interface
  */
 class MmWave3gppChannel : public SpectrumPropagationLossModel
 {
+	friend class MmWave3gppRxPsdTask;
+
 public:
 
 	/** 
@@ -235,6 +298,14 @@ public:
 	 void SetNrTxMode (uint8_t nrTxMode); // 180628-jskim14, set NR tx mode in 3gpp channel
 private:
 
+	/**
+	 * Find the direction of a link and the antenna arrays of its end points
+	 * @params the tx device
+	 * @params the rx device
+	 * @params the link state to fill
+	 */
+	void ClassifyLink (Ptr<NetDevice> txDevice, Ptr<NetDevice> rxDevice, LinkCache3gpp &link) const;
+
 	/**
 	 * Inherited from SpectrumPropagationLossModel, it returns the PSD at the receiver
 	 * @params the transmitted PSD
@@ -246,6 +317,47 @@ private:
 														Ptr<const MobilityModel> a,
 														Ptr<const MobilityModel> b) const;
 
+	/**
+	 * Inherited from SpectrumPropagationLossModel, the returned task applies the beamforming gain
+	 * @params the PSD to be received
+	 * @params the mobility model of the transmitter
+	 * @params the mobility model of the receiver
+	 * @returns the task applying the beamforming gain to the PSD
+	 */
+	Ptr<SpectrumRxPsdTask> DoPrepareRxPowerSpectralDensity (Ptr<const SpectrumValue> psd,
+														Ptr<const MobilityModel> a,
+														Ptr<const MobilityModel> b) const;
+
+	/**
+	 * Run the channel and beam updates of a link, i.e., everything DoCalcRxPowerSpectralDensity
+	 * does on the shared state, and collect what the beamforming gain computation needs
+	 * @params the PSD to be received
+	 * @params the mobility model of the transmitter
+	 * @params the mobility model of the receiver
+	 * @params the prepared computation
+	 * @returns false if the PSD is received without beamforming gain
+	 */
+	bool PrepareLink (Ptr<const SpectrumValue> rxPsd, Ptr<const MobilityModel> a,
+			Ptr<const MobilityModel> b, PreparedLink3gpp &prep) const;
+
+	/**
+	 * Apply the beamforming gain of a prepared link. It only reads the shared state,
+	 * so it can run on a worker thread with its own scratch
+	 * @params the prepared computation
+	 * @params the PSD, modified in place
+	 * @params the scratch state of CalBeamformingGain
+	 */
+	void ApplyLinkGain (const PreparedLink3gpp &prep, SpectrumValue &psd, SubbandGainScratch &scratch) const;
+
+	/**
+	 * Print the average beamforming gain of a link
+	 * @params the prepared computation
+	 * @params the sum of the PSD before the gain
+	 * @params the sum over the bands of the ratio between the PSD after and before the gain
+	 * @params the number of bands
+	 */
+	void LogLinkGain (const PreparedLink3gpp &prep, double rxSum, double gainSum, uint8_t nbands) const;
+
 	/**
 	 * Get a new realization of the channel
 	 * @params the ParamsTable for the specific scenario
@@ -292,6 +404,13 @@ private:
 	 */
 	void LongTermCovMatrixBeamforming (Ptr<Params3gpp> params) const;
 	
+	/**
+	 * Collect the center frequency of the subbands where the tx PSD is not zero
+	 * @params the tx PSD
+	 * @params the output frequencies
+	 */
+	void GetActiveSubbands (Ptr<const SpectrumValue> txPsd, doubleVector_t &subbandFreq) const;
+
 	/**
 	 * Scan all sectors with predefined code book and select the one returns maximum gain.
 	 * The BF vector is stored in the Params3gpp object passed as parameter
@@ -303,11 +422,6 @@ private:
 	//180709-jskim14-find optimal beamforming
 	void IdealBeamforming (Ptr<const SpectrumValue> txPsd, Ptr<Params3gpp> params, Ptr<AntennaArrayModel> txAntenna,
 			Ptr<AntennaArrayModel> rxAntenna, uint8_t *txAntennaNum, uint8_t *rxAntennaNum) const;
-	complex2DVector_t Multiplication (complex2DVector_t mtx1, complex2DVector_t mtx2) const;
-	complex2DVector_t Transpose (complex2DVector_t mtx);
-	std::complex<double> Determinant (complex2DVector_t mtx, int size);
-	complex2DVector_t Inverse (complex2DVector_t mtx);
-	complex2DVector_t Hermitian (complex2DVector_t mtx);
 	//jskim14-end
 
 	/**
@@ -319,13 +433,14 @@ private:
 	/**
 	 * Compute the BF gain, apply frequency selectivity by phase-shifting with the cluster delays
 	 * and scale the txPsd to get the rxPsd
-	 * @params the tx PSD
+	 * @params the tx PSD, scaled in place to the rx PSD
 	 * @params the channel realizationin as a Params3gpp object
 	 * @params the relative speed between UE and eNB
-	 * @returns the rx PSD
+	 * @params the time [s] of the Doppler phase
+	 * @params the per-cluster scratch state
 	 */
-	Ptr<SpectrumValue> CalBeamformingGain (Ptr<const SpectrumValue> txPsd,
-												Ptr<Params3gpp> params, Vector speed) const;
+	void CalBeamformingGain (SpectrumValue &psd, const Params3gpp &params, Vector speed,
+			double slotTime, SubbandGainScratch &scratch) const;
 	
 	/**
 	 * Returns the bandwidth used in a scenario
@@ -367,6 +482,13 @@ private:
 
 	mutable std::map< key_t, int > m_connectedPair;
 	mutable std::map< key_t, Ptr<Params3gpp> > m_channelMap;
+	mutable std::map< key_t, LinkCache3gpp > m_linkCache;
+	bool m_channelCache; // reuse the beamforming gain of static links
+	double m_channelCacheDistance; // displacement after which a cached gain is recomputed
+	mutable MmWaveBeamSweep m_beamSweep; // scratch state of the beam search
+	mutable SubbandGainScratch m_gainScratch; // scratch state of CalBeamformingGain on the simulator thread
+	bool m_hierarchicalBeamSearch;
+	uint16_t m_beamSearchCandidates;
 
 	Ptr<UniformRandomVariable> m_uniformRv;
 	Ptr<UniformRandomVariable> m_uniformRvBlockage;
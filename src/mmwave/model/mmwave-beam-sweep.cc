@@ -0,0 +1,225 @@
+ /* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+ /*
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "mmwave-beam-sweep.h"
+#include <ns3/log.h>
+#include <ns3/assert.h>
+#include <algorithm>
+#include <cmath>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("MmWaveBeamSweep");
+
+MmWaveBeamSweep::MmWaveBeamSweep ()
+	: m_hierarchical (false),
+	  m_candidates (4),
+	  m_numCluster (0)
+{
+}
+
+void
+MmWaveBeamSweep::SetHierarchical (bool hierarchical, uint16_t candidates)
+{
+	NS_ASSERT_MSG (candidates > 0, "the hierarchical search needs at least one candidate beam");
+	m_hierarchical = hierarchical;
+	m_candidates = candidates;
+}
+
+MmWaveBeamSweep::Result
+MmWaveBeamSweep::Sweep (const complex3DVector_t &channel, const doubleVector_t &delay,
+		const ComplexMatrix &txCodebook, const ComplexMatrix &rxCodebook,
+		const doubleVector_t &subbandFreq)
+{
+	uint16_t rxAntenna = channel.size ();
+	uint16_t txAntenna = channel.at (0).size ();
+	m_numCluster = delay.size ();
+	uint16_t txBeamNum = txCodebook.GetNumCols ();
+	uint16_t rxBeamNum = rxCodebook.GetNumCols ();
+	NS_ASSERT_MSG (txCodebook.GetNumRows () == txAntenna, "the tx codebook does not match the channel size");
+	NS_ASSERT_MSG (rxCodebook.GetNumRows () == rxAntenna, "the rx codebook does not match the channel size");
+	NS_LOG_INFO ("Beam sweep over " << txBeamNum << " tx beams, " << rxBeamNum << " rx beams, "
+			<< (unsigned) m_numCluster << " clusters and " << subbandFreq.size () << " subbands");
+
+	Result result;
+	result.m_txBeam = 0;
+	result.m_rxBeam = 0;
+	result.m_gain = 0;
+
+	//H[u][s][n] as a (u*numCluster+n) x s matrix, then projected on every tx beam at once
+	m_channel.Resize (rxAntenna * m_numCluster, txAntenna);
+	for (uint16_t rxIndex = 0; rxIndex < rxAntenna; rxIndex++)
+	{
+		for (uint16_t txIndex = 0; txIndex < txAntenna; txIndex++)
+		{
+			const complexVector_t &clusters = channel[rxIndex][txIndex];
+			for (uint16_t cIndex = 0; cIndex < m_numCluster; cIndex++)
+			{
+				m_channel (rxIndex * m_numCluster + cIndex, txIndex) = clusters[cIndex];
+			}
+		}
+	}
+	ComplexMatrix::Multiply (m_channel, txCodebook, m_txProj);
+
+	//coarse tx stage: narrowband power with an omnidirectional rx side
+	m_txBeams.clear ();
+	if (m_hierarchical && m_candidates < txBeamNum)
+	{
+		m_score.assign (txBeamNum, 0);
+		for (uint16_t row = 0; row < m_txProj.GetNumRows (); row++)
+		{
+			const std::complex<double> *proj = m_txProj[row];
+			for (uint16_t tx = 0; tx < txBeamNum; tx++)
+			{
+				m_score[tx] += std::norm (proj[tx]);
+			}
+		}
+		SelectBest (m_score, m_candidates, m_txBeams);
+	}
+	else
+	{
+		for (uint16_t tx = 0; tx < txBeamNum; tx++)
+		{
+			m_txBeams.push_back (tx);
+		}
+	}
+	uint16_t txSelected = m_txBeams.size ();
+
+	//gather the selected tx beams as a u x (n*txSelected+j) matrix and project on every rx beam at once
+	m_txSelected.Resize (rxAntenna, m_numCluster * txSelected);
+	for (uint16_t rxIndex = 0; rxIndex < rxAntenna; rxIndex++)
+	{
+		for (uint16_t cIndex = 0; cIndex < m_numCluster; cIndex++)
+		{
+			const std::complex<double> *proj = m_txProj[rxIndex * m_numCluster + cIndex];
+			std::complex<double> *selected = m_txSelected[rxIndex] + cIndex * txSelected;
+			for (uint16_t j = 0; j < txSelected; j++)
+			{
+				selected[j] = proj[m_txBeams[j]];
+			}
+		}
+	}
+	m_rxCodebookH.Resize (rxBeamNum, rxAntenna);
+	for (uint16_t rxIndex = 0; rxIndex < rxAntenna; rxIndex++)
+	{
+		for (uint16_t rx = 0; rx < rxBeamNum; rx++)
+		{
+			m_rxCodebookH (rx, rxIndex) = std::conj (rxCodebook (rxIndex, rx));
+		}
+	}
+	ComplexMatrix::Multiply (m_rxCodebookH, m_txSelected, m_rxProj);
+
+	//coarse rx stage: narrowband power over the selected tx beams
+	m_rxBeams.clear ();
+	if (m_hierarchical && m_candidates < rxBeamNum)
+	{
+		m_score.assign (rxBeamNum, 0);
+		for (uint16_t rx = 0; rx < rxBeamNum; rx++)
+		{
+			const std::complex<double> *proj = m_rxProj[rx];
+			for (uint16_t col = 0; col < m_rxProj.GetNumCols (); col++)
+			{
+				m_score[rx] += std::norm (proj[col]);
+			}
+		}
+		SelectBest (m_score, m_candidates, m_rxBeams);
+	}
+	else
+	{
+		for (uint16_t rx = 0; rx < rxBeamNum; rx++)
+		{
+			m_rxBeams.push_back (rx);
+		}
+	}
+
+	if (subbandFreq.empty ())
+	{
+		NS_LOG_WARN ("No active subband, the first beam pair is selected");
+		return result;
+	}
+
+	m_phasor.Resize (m_numCluster, subbandFreq.size ());
+	for (uint16_t cIndex = 0; cIndex < m_numCluster; cIndex++)
+	{
+		for (uint16_t sbIndex = 0; sbIndex < subbandFreq.size (); sbIndex++)
+		{
+			double phase = -2 * M_PI * subbandFreq[sbIndex] * delay[cIndex];
+			m_phasor (cIndex, sbIndex) = std::exp (std::complex<double> (0, phase));
+		}
+	}
+
+	ScorePairs (result);
+	return result;
+}
+
+void
+MmWaveBeamSweep::ScorePairs (Result &result)
+{
+	uint16_t txSelected = m_txBeams.size ();
+	uint16_t numSubband = m_phasor.GetNumCols ();
+	double max = -1;
+	m_pairLongTerm.Resize (txSelected, m_numCluster);
+	for (uint16_t i = 0; i < m_rxBeams.size (); i++)
+	{
+		//long term component of every selected tx beam for this rx beam
+		const std::complex<double> *proj = m_rxProj[m_rxBeams[i]];
+		for (uint16_t cIndex = 0; cIndex < m_numCluster; cIndex++)
+		{
+			for (uint16_t j = 0; j < txSelected; j++)
+			{
+				m_pairLongTerm (j, cIndex) = proj[cIndex * txSelected + j];
+			}
+		}
+		//frequency response of all these pairs in one multiplication
+		ComplexMatrix::Multiply (m_pairLongTerm, m_phasor, m_pairGain);
+		for (uint16_t j = 0; j < txSelected; j++)
+		{
+			const std::complex<double> *gain = m_pairGain[j];
+			double power = 0;
+			for (uint16_t sbIndex = 0; sbIndex < numSubband; sbIndex++)
+			{
+				power += std::norm (gain[sbIndex]);
+			}
+			power /= numSubband;
+			NS_LOG_LOGIC ("tx beam " << m_txBeams[j] << " rx beam " << m_rxBeams[i] << " gain " << power);
+			if (power > max)
+			{
+				max = power;
+				result.m_txBeam = m_txBeams[j];
+				result.m_rxBeam = m_rxBeams[i];
+				result.m_gain = power;
+			}
+		}
+	}
+}
+
+void
+MmWaveBeamSweep::SelectBest (const doubleVector_t &score, uint16_t n, std::vector<uint16_t> &best)
+{
+	best.resize (score.size ());
+	for (uint16_t i = 0; i < score.size (); i++)
+	{
+		best[i] = i;
+	}
+	n = std::min<uint16_t> (n, score.size ());
+	std::partial_sort (best.begin (), best.begin () + n, best.end (),
+			[&score] (uint16_t a, uint16_t b) { return score[a] > score[b]; });
+	best.resize (n);
+	std::sort (best.begin (), best.end ());
+}
+
+} // namespace ns3
@@ -0,0 +1,113 @@
+ /* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+ /*
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef MMWAVE_BEAM_SWEEP_H_
+#define MMWAVE_BEAM_SWEEP_H_
+
+#include <complex>
+#include <vector>
+#include <stdint.h>
+#include <ns3/mmwave-complex-matrix.h>
+
+namespace ns3 {
+
+typedef std::vector<double> doubleVector_t;
+typedef std::vector< std::complex<double> > complexVector_t;
+typedef std::vector<complexVector_t> complex2DVector_t;
+typedef std::vector<complex2DVector_t> complex3DVector_t;
+
+/**
+ * \brief Batched beam sweep over a pair of codebooks for one channel realization.
+ *
+ * The channel tensor H[u][s][n] is projected onto the whole tx codebook once
+ * and onto the rx codebook once, which gives the long term component of every
+ * (tx beam, rx beam) pair. All the pairs are then scored together against the
+ * per-cluster subband phasors, i.e. the score of a pair is the average over the
+ * active subbands of |sum_n longTerm[n] * exp(-j*2*pi*f*tau_n)|^2, the same
+ * value MmWave3gppChannel::CalBeamformingGain computes with zero relative speed.
+ *
+ * In hierarchical mode only the best tx beams (rx side omnidirectional) and,
+ * for those, the best rx beams are kept from a narrowband coarse stage, and the
+ * wideband score is evaluated only on the surviving pairs.
+ *
+ * The scratch buffers are kept across calls, so a sweep does not allocate
+ * once the codebook and channel sizes are stable.
+ */
+class MmWaveBeamSweep
+{
+public:
+	struct Result
+	{
+		uint16_t m_txBeam;
+		uint16_t m_rxBeam;
+		double m_gain; // average linear beamforming gain over the active subbands
+	};
+
+	MmWaveBeamSweep ();
+
+	/**
+	 * Enable the coarse-then-fine search
+	 * @param true to enable the hierarchical search
+	 * @param the number of tx and rx beams kept by the coarse stage
+	 */
+	void SetHierarchical (bool hierarchical, uint16_t candidates);
+
+	/**
+	 * Find the best beam pair
+	 * @params the channel matrix H[u][s][n]
+	 * @params the cluster delays
+	 * @params the tx codebook, one beam per column (s x number of tx beams)
+	 * @params the rx codebook, one beam per column (u x number of rx beams)
+	 * @params the center frequency of each active subband
+	 * @returns the selected pair and its gain
+	 */
+	Result Sweep (const complex3DVector_t &channel, const doubleVector_t &delay,
+			const ComplexMatrix &txCodebook, const ComplexMatrix &rxCodebook,
+			const doubleVector_t &subbandFreq);
+
+private:
+	/**
+	 * Score the pairs (m_rxBeams[i], m_txBeams[j]) from the long term
+	 * components in m_rxProj, and keep the best one in result
+	 */
+	void ScorePairs (Result &result);
+
+	/**
+	 * Indices of the n largest values of score
+	 */
+	static void SelectBest (const doubleVector_t &score, uint16_t n, std::vector<uint16_t> &best);
+
+	bool m_hierarchical;
+	uint16_t m_candidates;
+
+	uint16_t m_numCluster;
+	ComplexMatrix m_channel; // H laid out as (u*numCluster+n) x s
+	ComplexMatrix m_txProj; // H projected on the tx codebook, (u*numCluster+n) x txBeams
+	ComplexMatrix m_txSelected; // selected columns of m_txProj, u x (n*selected tx beams+j)
+	ComplexMatrix m_rxCodebookH; // Hermitian of the rx codebook
+	ComplexMatrix m_rxProj; // long term component, rxBeams x (n*selected tx beams+j)
+	ComplexMatrix m_phasor; // exp(-j*2*pi*f*tau_n), numCluster x subbands
+	ComplexMatrix m_pairLongTerm; // tx beams x numCluster for one rx beam
+	ComplexMatrix m_pairGain; // tx beams x subbands for one rx beam
+	std::vector<uint16_t> m_txBeams;
+	std::vector<uint16_t> m_rxBeams;
+	doubleVector_t m_score;
+};
+
+} // namespace ns3
+
+#endif /* MMWAVE_BEAM_SWEEP_H_ */
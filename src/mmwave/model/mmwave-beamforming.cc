@@ -30,7 +30,6 @@
 #include "mmwave-beamforming.h"
 
 #include <ns3/log.h>
-#include <fstream>
 #include <ns3/simulator.h>
 #include <ns3/abort.h>
 #include <ns3/mmwave-enb-net-device.h>
@@ -53,11 +52,11 @@ NS_OBJECT_ENSURE_REGISTERED (MmWaveBeamforming);
 // period of updating channel matrix
 static const uint32_t g_numInstance = 100;
 
-complex2DVector_t g_enbAntennaInstance; //100 instance of txW
-complex2DVector_t g_ueAntennaInstance; //100 instance of rxW
-complex3DVector_t g_enbSpatialInstance; //this stores 100 instance of txE
-complex3DVector_t g_ueSpatialInstance; //this stores 100 instance of rxE
-double2DVector_t g_smallScaleFadingInstance;    //this stores 100 instance of sigma vector
+Ptr<const MmWaveTableFile> g_enbAntennaInstance; //100 instance of txW, one per row
+Ptr<const MmWaveTableFile> g_ueAntennaInstance; //100 instance of rxW, one per row
+Ptr<const MmWaveTableFile> g_enbSpatialInstance; //this stores 100 instance of txE, pathNum rows per instance
+Ptr<const MmWaveTableFile> g_ueSpatialInstance; //this stores 100 instance of rxE, pathNum rows per instance
+Ptr<const MmWaveTableFile> g_smallScaleFadingInstance;    //this stores 100 instance of sigma vector, one per row
 
 /*
  * The delay spread and Doppler shift is not based on measurement data at this time
@@ -79,7 +78,7 @@ MmWaveBeamforming::MmWaveBeamforming (uint32_t enbAntenna, uint32_t ueAntenna)
 	m_ueSpeed (0.0),
 	m_update(true)
 {
-	if (g_smallScaleFadingInstance.empty ())
+	if (g_smallScaleFadingInstance == 0)
 	LoadFile();
 	m_uniformRV = CreateObject<UniformRandomVariable> ();
 	Initialize();
@@ -138,50 +137,6 @@ MmWaveBeamforming::GetConfigurationParameters (void) const
 	return m_phyMacConfig;
 }
 
-std::complex<double>
-MmWaveBeamforming::ParseComplex (std::string strCmplx)
-{
-    double re = 0.00;
-    double im = 0.00;
-    size_t findj = 0;
-    std::complex<double> out_complex;
-
-    findj = strCmplx.find("i");
-    if( findj == std::string::npos )
-    {
-        im = -1.00;
-    }
-    else
-    {
-        strCmplx[findj] = '\0';
-    }
-    if( ( strCmplx.find("+",1) == std::string::npos && strCmplx.find("-",1) == std::string::npos ) && im != -1 )
-    {
-        /* No real value */
-        re = -1.00;
-    }
-    std::stringstream stream( strCmplx );
-    if( re != -1.00 )
-    {
-        stream>>re;
-    }
-    else
-    {
-        re = 0;
-    }
-    if( im != -1 )
-    {
-        stream>>im;
-    }
-    else
-    {
-        im = 0.00;
-    }
-    //  std::cout<<" ---  "<<re<<"  "<<im<<std::endl;
-    out_complex = std::complex<double>(re,im);
-    return out_complex;
-}
-
 void
 MmWaveBeamforming::LoadFile()
 {
@@ -198,27 +153,8 @@ MmWaveBeamforming::LoadSmallScaleFading ()
 {
 	std::string filename = "src/mmwave/model/BeamFormingMatrix/SmallScaleFading.txt";
 	NS_LOG_FUNCTION (this << "Loading SmallScaleFading file " << filename);
-	std::ifstream singlefile;
-	singlefile.open (filename.c_str (), std::ifstream::in);
-
-	NS_LOG_INFO (this << " File: " << filename);
-	NS_ASSERT_MSG(singlefile.good (), " SmallScaleFading file not found");
-    std::string line;
-    std::string token;
-    while( std::getline(singlefile, line) ) //Parse each line of the file
-    {
-    	doubleVector_t path;
-        std::istringstream stream(line);
-        while( getline(stream,token,',') ) //Parse each comma separated string in a line
-        {
-            double sigma = 0.00;
-            std::stringstream stream( token );
-            stream>>sigma;
-        	path.push_back(sigma);
-		}
-        g_smallScaleFadingInstance.push_back (path);
-	}
-	NS_LOG_INFO ("SmallScaleFading[instance:"<<g_smallScaleFadingInstance.size()<<"][path:"<<g_smallScaleFadingInstance[0].size()<<"]");
+	g_smallScaleFadingInstance = MmWaveTableFile::Get (filename, MmWaveTableFile::REAL);
+	NS_LOG_INFO ("SmallScaleFading[instance:"<<g_smallScaleFadingInstance->GetNumRows ()<<"][path:"<<g_smallScaleFadingInstance->GetRowSize (0)<<"]");
 }
 
 void
@@ -226,26 +162,8 @@ MmWaveBeamforming::LoadEnbAntenna ()
 {
 	std::string filename = "src/mmwave/model/BeamFormingMatrix/TxAntenna.txt";
 	NS_LOG_FUNCTION (this << "Loading TxAntenna file " << filename);
-	std::ifstream singlefile;
-	std::complex<double> complexVar;
-	singlefile.open (filename.c_str (), std::ifstream::in);
-
-	NS_LOG_INFO (this << " File: " << filename);
-	NS_ASSERT_MSG(singlefile.good (), " TxAntenna file not found");
-    std::string line;
-    std::string token;
-    while( std::getline(singlefile, line) ) //Parse each line of the file
-    {
-    	complexVector_t txAntenna;
-        std::istringstream stream(line);
-        while( getline(stream,token,',') ) //Parse each comma separated string in a line
-        {
-        	complexVar = ParseComplex(token);
-		    txAntenna.push_back(complexVar);
-		}
-		g_enbAntennaInstance.push_back(txAntenna);
-	}
-    NS_LOG_INFO ("TxAntenna[instance:"<<g_enbAntennaInstance.size()<<"][antennaSize:"<<g_enbAntennaInstance[0].size()<<"]");
+	g_enbAntennaInstance = MmWaveTableFile::Get (filename, MmWaveTableFile::COMPLEX);
+	NS_LOG_INFO ("TxAntenna[instance:"<<g_enbAntennaInstance->GetNumRows ()<<"][antennaSize:"<<g_enbAntennaInstance->GetRowSize (0)<<"]");
 }
 
 
@@ -254,27 +172,8 @@ MmWaveBeamforming::LoadUeAntenna ()
 {
 	std::string filename = "src/mmwave/model/BeamFormingMatrix/RxAntenna.txt";
 	NS_LOG_FUNCTION (this << "Loading RxAntenna file " << filename);
-	std::ifstream singlefile;
-	std::complex<double> complexVar;
-	singlefile.open (filename.c_str (), std::ifstream::in);
-
-	NS_LOG_INFO (this << " File: " << filename);
-	NS_ASSERT_MSG(singlefile.good (), " RxAntenna file not found");
-
-    std::string line;
-    std::string token;
-    while( std::getline(singlefile, line) ) //Parse each line of the file
-    {
-    	complexVector_t rxAntenna;
-		std::istringstream stream(line);
-		while( getline(stream,token,',') ) //Parse each comma separated string in a line
-		{
-			complexVar = ParseComplex(token);
-		    rxAntenna.push_back(complexVar);
-		}
-		g_ueAntennaInstance.push_back(rxAntenna);
-	}
-    NS_LOG_INFO ("RxAntenna[instance:"<<g_ueAntennaInstance.size()<<"][antennaSize:"<<g_ueAntennaInstance[0].size()<<"]");
+	g_ueAntennaInstance = MmWaveTableFile::Get (filename, MmWaveTableFile::COMPLEX);
+	NS_LOG_INFO ("RxAntenna[instance:"<<g_ueAntennaInstance->GetNumRows ()<<"][antennaSize:"<<g_ueAntennaInstance->GetRowSize (0)<<"]");
 }
 
 void
@@ -282,35 +181,9 @@ MmWaveBeamforming::LoadEnbSpatialSignature ()
 {
 	std::string filename = "src/mmwave/model/BeamFormingMatrix/TxSpatialSigniture.txt";
 	NS_LOG_FUNCTION (this << "Loading TxspatialSigniture file " << filename);
-	std::ifstream singlefile;
-	std::string line;
-	std::string token;
-
-	uint16_t counter = 1;
-	std::complex<double> complexVar;
-	complex2DVector_t txSpatialMatrix;
-	singlefile.open (filename.c_str (), std::ifstream::in);
-
-	NS_ASSERT_MSG (singlefile.good (), "TxSpatialSigniture file not found");
-
-    while( std::getline(singlefile, line) ) //Parse each line of the file
-    {
-    	complexVector_t txSpatialElement;
-		std::istringstream stream(line);
-		while( getline(stream,token,',') ) //Parse each comma separated string in a line
-		{
-			complexVar = ParseComplex(token);
-			txSpatialElement.push_back(complexVar);
-		}
-		txSpatialMatrix.push_back(txSpatialElement);
-		if(counter % m_pathNum ==0 )
-		{
-			g_enbSpatialInstance.push_back(txSpatialMatrix);
-			txSpatialMatrix.clear();
-		}
-	    counter++;
-    }
-    NS_LOG_INFO ("TxspatialSigniture[instance:"<<g_enbSpatialInstance.size()<<"][path:"<<g_enbSpatialInstance[0].size()<<"][antennaSize:"<<g_enbSpatialInstance[0][0].size()<<"]");
+	g_enbSpatialInstance = MmWaveTableFile::Get (filename, MmWaveTableFile::COMPLEX);
+	NS_ASSERT_MSG (g_enbSpatialInstance->GetNumRows () % m_pathNum == 0, "TxSpatialSigniture rows are not a multiple of the path number");
+	NS_LOG_INFO ("TxspatialSigniture[instance:"<<g_enbSpatialInstance->GetNumRows () / m_pathNum<<"][path:"<<m_pathNum<<"][antennaSize:"<<g_enbSpatialInstance->GetRowSize (0)<<"]");
 }
 
 void
@@ -318,35 +191,21 @@ MmWaveBeamforming::LoadUeSpatialSignature ()
 {
 	std::string strFilename = "src/mmwave/model/BeamFormingMatrix/RxSpatialSigniture.txt";
 	NS_LOG_FUNCTION (this << "Loading RxspatialSigniture file " << strFilename);
-	std::ifstream singlefile;
-	std::complex<double> complexVar;
-	complex2DVector_t rxSpatialMatrix;
-	singlefile.open (strFilename.c_str (), std::ifstream::in);
-
-	NS_LOG_INFO (this << " File: " << strFilename);
-	NS_ASSERT_MSG (singlefile.good (), " RxSpatialSigniture file not found");
-
-	std::string line;
-	std::string token;
-	int counter = 1;
-	while (std::getline(singlefile, line) ) //Parse each line of the file
+	g_ueSpatialInstance = MmWaveTableFile::Get (strFilename, MmWaveTableFile::COMPLEX);
+	NS_ASSERT_MSG (g_ueSpatialInstance->GetNumRows () % m_pathNum == 0, "RxSpatialSigniture rows are not a multiple of the path number");
+	NS_LOG_INFO ("RxspatialSigniture[instance:"<<g_ueSpatialInstance->GetNumRows () / m_pathNum<<"][path:"<<m_pathNum<<"][antennaSize:"<<g_ueSpatialInstance->GetRowSize (0)<<"]");
+}
+
+void
+MmWaveBeamforming::CopyComplexRows (Ptr<const MmWaveTableFile> table, uint32_t firstRow, uint32_t numRows,
+		complex2DVector_t &out) const
+{
+	out.resize (numRows);
+	for (uint32_t i = 0; i < numRows; i++)
 	{
-		 complexVector_t rxSpatialElement;
-	     std::istringstream stream(line);
-	     while (getline(stream,token,',') ) //Parse each comma separated string in a line
-	     {
-	    	 complexVar = ParseComplex (token);
-	    	 rxSpatialElement.push_back (complexVar);
-	     }
-	     rxSpatialMatrix.push_back (rxSpatialElement);
-	     if (counter % m_pathNum == 0)
-	     {
-		   	 g_ueSpatialInstance.push_back (rxSpatialMatrix);
-		   	 rxSpatialMatrix.clear ();
-		 }
-	     counter++;
+		const std::complex<double> *row = table->GetComplexRow (firstRow + i);
+		out[i].assign (row, row + table->GetRowSize (firstRow + i));
 	}
-	NS_LOG_INFO ("RxspatialSigniture[instance:"<<g_ueSpatialInstance.size()<<"][path:"<<g_ueSpatialInstance[0].size()<<"][antennaSize:"<<g_ueSpatialInstance[0][0].size()<<"]");
 }
 
 
@@ -422,11 +281,14 @@ MmWaveBeamforming::SetChannelMatrix (Ptr<NetDevice> ueDevice,  Ptr<NetDevice> en
 	NS_LOG_UNCOND (Simulator::Now().GetSeconds() <<" ************* UPDATING CHANNEL MATRIX (instance " << randomInstance << ") *************");
 
 	Ptr<BeamformingParams> bfParams = Create<BeamformingParams> ();
-	bfParams->m_enbW = g_enbAntennaInstance.at (randomInstance);
-	bfParams->m_ueW = g_ueAntennaInstance.at (randomInstance);
-	bfParams->m_channelMatrix.m_enbSpatialMatrix = g_enbSpatialInstance.at (randomInstance);
-	bfParams->m_channelMatrix.m_ueSpatialMatrix = g_ueSpatialInstance.at (randomInstance);
-	bfParams->m_channelMatrix.m_powerFraction = g_smallScaleFadingInstance.at (randomInstance);
+	const std::complex<double> *enbW = g_enbAntennaInstance->GetComplexRow (randomInstance);
+	bfParams->m_enbW.assign (enbW, enbW + g_enbAntennaInstance->GetRowSize (randomInstance));
+	const std::complex<double> *ueW = g_ueAntennaInstance->GetComplexRow (randomInstance);
+	bfParams->m_ueW.assign (ueW, ueW + g_ueAntennaInstance->GetRowSize (randomInstance));
+	CopyComplexRows (g_enbSpatialInstance, randomInstance * m_pathNum, m_pathNum, bfParams->m_channelMatrix.m_enbSpatialMatrix);
+	CopyComplexRows (g_ueSpatialInstance, randomInstance * m_pathNum, m_pathNum, bfParams->m_channelMatrix.m_ueSpatialMatrix);
+	const double *powerFraction = g_smallScaleFadingInstance->GetRealRow (randomInstance);
+	bfParams->m_channelMatrix.m_powerFraction.assign (powerFraction, powerFraction + g_smallScaleFadingInstance->GetRowSize (randomInstance));
 	bfParams->m_beam = GetLongTermFading (bfParams);
 
 	//Ptr<BeamformingParams> bfParams_2 = Create<BeamformingParams> ();
@@ -47,6 +47,7 @@
 #include <ns3/mmwave-phy-mac-common.h>
 #include <ns3/random-variable-stream.h>
 #include <ns3/antenna-array-model.h>
+#include <ns3/mmwave-table-file.h>
 
 
 
@@ -127,12 +128,6 @@ public:
 
     bool isAdditionalMmWavePhy=false;
 private:
-	/**
-	* \breif Get complex number from a string
-	* \param strCmplx a string store complex bumber i.e. 3+2i,
-	* \return a complex number of the string
-	*/
-	std::complex<double> ParseComplex (std::string strCmplx);
 	/**
 	* \breif Load file which store small scale fading sigma vector
 	*/
@@ -154,6 +149,15 @@ private:
 	*/
 	void LoadUeSpatialSignature ();
 	/**
+	* \breif Copy consecutive rows of a complex table, e.g. the paths of a spatial signature instance
+	* \param table the table
+	* \param firstRow the first row to copy
+	* \param numRows the number of rows to copy
+	* \param out the matrix receiving the rows
+	*/
+	void CopyComplexRows (Ptr<const MmWaveTableFile> table, uint32_t firstRow, uint32_t numRows,
+			complex2DVector_t &out) const;
+	/**
 	* \breif Calculate beamforming gain and fading distortion in frequency and time
 	* \param txPsd set of values vs frequency representing the
 	*              transmission power. See SpectrumChannel for details.
@@ -42,7 +42,7 @@
 #include <ns3/mmwave-enb-phy.h>
 #include <ns3/double.h>
 #include <algorithm>
-#include <fstream>
+#include <ns3/mmwave-table-file.h>
 
 
 namespace ns3{
@@ -117,31 +117,19 @@ MmWaveChannelRaytracing::LoadTraces()
 {
 	std::string filename = "src/mmwave/model/Raytracing/traces10cm.txt";
 	NS_LOG_FUNCTION (this << "Loading Raytracing file " << filename);
-	std::ifstream singlefile;
-	singlefile.open (filename.c_str (), std::ifstream::in);
+	if (!g_path.empty ())
+	{
+		return;
+	}
+	Ptr<const MmWaveTableFile> traces = MmWaveTableFile::Get (filename, MmWaveTableFile::REAL);
 
 	NS_LOG_INFO (this << " File: " << filename);
-	NS_ASSERT_MSG(singlefile.good (), " Raytracing file not found");
-    std::string line;
-    std::string token;
-    uint16_t counter = 0;
-    while( std::getline(singlefile, line) ) //Parse each line of the file
-    {
-    	if(counter == 8)
-    	{
-    		counter = 0;
-    	}
-    	doubleVector_t path;
-        std::istringstream stream(line);
-        while( getline(stream,token,',') ) //Parse each comma separated string in a line
-        {
-            double sigma = 0.00;
-            std::stringstream stream( token );
-            stream>>sigma;
-        	path.push_back(sigma);
-		}
+	for (uint32_t row = 0; row < traces->GetNumRows (); row++) //Each trace is made of 8 rows
+	{
+		const double *values = traces->GetRealRow (row);
+		doubleVector_t path (values, values + traces->GetRowSize (row));
 
-		switch (counter)
+		switch (row % 8)
 		{
 		case 0:
 			g_path.push_back (path.at (0));
@@ -171,7 +159,6 @@ MmWaveChannelRaytracing::LoadTraces()
 			NS_FATAL_ERROR("Never call this");
 			break;
 		}
-		counter++;
 	}
 
 	/*NS_LOG_UNCOND(g_path.size());
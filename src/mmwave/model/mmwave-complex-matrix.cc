@@ -0,0 +1,317 @@
+ /* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+ /*
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "mmwave-complex-matrix.h"
+#include <ns3/log.h>
+#include <ns3/assert.h>
+#include <ns3/fatal-error.h>
+#include <algorithm>
+#include <cmath>
+
+#if defined (__GNUC__) && (defined (__x86_64__) || defined (__i386__))
+#define MMWAVE_COMPLEX_MATRIX_AVX2 1
+#include <immintrin.h>
+#endif
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("ComplexMatrix");
+
+namespace {
+
+/*
+ * Row kernel of the GEMM: c[0..n) += a * b[0..n).
+ * std::complex<double> is layout compatible with double[2], so two complex
+ * numbers fit in one 256 bit register as (re0, im0, re1, im1).
+ */
+void
+AxpyScalar (std::complex<double> a, const std::complex<double> *b, std::complex<double> *c, uint16_t n)
+{
+	for (uint16_t j = 0; j < n; j++)
+	{
+		c[j] += a * b[j];
+	}
+}
+
+#ifdef MMWAVE_COMPLEX_MATRIX_AVX2
+__attribute__ ((target ("avx2,fma"))) void
+AxpyAvx2 (std::complex<double> a, const std::complex<double> *b, std::complex<double> *c, uint16_t n)
+{
+	const double *pb = reinterpret_cast<const double *> (b);
+	double *pc = reinterpret_cast<double *> (c);
+	__m256d ar = _mm256_set1_pd (a.real ());
+	__m256d ai = _mm256_set1_pd (a.imag ());
+	uint16_t j = 0;
+	for (; j + 2 <= n; j += 2)
+	{
+		__m256d vb = _mm256_loadu_pd (pb + 2 * j);
+		__m256d vc = _mm256_loadu_pd (pc + 2 * j);
+		// (im, re) swapped copy of b, then (ar*br - ai*bi, ar*bi + ai*br)
+		__m256d bSwap = _mm256_permute_pd (vb, 0x5);
+		__m256d prod = _mm256_fmaddsub_pd (ar, vb, _mm256_mul_pd (ai, bSwap));
+		_mm256_storeu_pd (pc + 2 * j, _mm256_add_pd (vc, prod));
+	}
+	for (; j < n; j++)
+	{
+		c[j] += a * b[j];
+	}
+}
+#endif
+
+typedef void (*AxpyKernel) (std::complex<double>, const std::complex<double> *, std::complex<double> *, uint16_t);
+
+AxpyKernel
+SelectAxpyKernel ()
+{
+#ifdef MMWAVE_COMPLEX_MATRIX_AVX2
+	__builtin_cpu_init ();
+	if (__builtin_cpu_supports ("avx2") && __builtin_cpu_supports ("fma"))
+	{
+		return &AxpyAvx2;
+	}
+#endif
+	return &AxpyScalar;
+}
+
+const AxpyKernel g_axpy = SelectAxpyKernel ();
+
+} // anonymous namespace
+
+ComplexMatrix::ComplexMatrix ()
+	: m_rows (0),
+	  m_cols (0)
+{
+}
+
+ComplexMatrix::ComplexMatrix (uint16_t rows, uint16_t cols, std::complex<double> value)
+	: m_rows (rows),
+	  m_cols (cols),
+	  m_data ((size_t) rows * cols, value)
+{
+}
+
+void
+ComplexMatrix::Resize (uint16_t rows, uint16_t cols, std::complex<double> value)
+{
+	m_rows = rows;
+	m_cols = cols;
+	m_data.assign ((size_t) rows * cols, value);
+}
+
+void
+ComplexMatrix::Fill (std::complex<double> value)
+{
+	std::fill (m_data.begin (), m_data.end (), value);
+}
+
+void
+ComplexMatrix::GetColumn (uint16_t col, complexVector_t &out) const
+{
+	NS_ASSERT_MSG (col < m_cols, "column index out of range");
+	out.resize (m_rows);
+	for (uint16_t i = 0; i < m_rows; i++)
+	{
+		out[i] = m_data[i * m_cols + col];
+	}
+}
+
+ComplexMatrix
+ComplexMatrix::Transpose () const
+{
+	ComplexMatrix temp (m_cols, m_rows);
+	for (uint16_t i = 0; i < m_rows; i++)
+	{
+		for (uint16_t j = 0; j < m_cols; j++)
+		{
+			temp (j, i) = (*this) (i, j);
+		}
+	}
+	return temp;
+}
+
+ComplexMatrix
+ComplexMatrix::Hermitian () const
+{
+	ComplexMatrix temp (m_cols, m_rows);
+	for (uint16_t i = 0; i < m_rows; i++)
+	{
+		for (uint16_t j = 0; j < m_cols; j++)
+		{
+			temp (j, i) = std::conj ((*this) (i, j));
+		}
+	}
+	return temp;
+}
+
+void
+ComplexMatrix::Multiply (const ComplexMatrix &a, const ComplexMatrix &b, ComplexMatrix &c)
+{
+	if (a.m_cols != b.m_rows)
+	{
+		NS_FATAL_ERROR ("Matrix multiplication error !");
+	}
+	NS_ASSERT_MSG (&c != &a && &c != &b, "the result of the multiplication cannot alias an operand");
+
+	if (c.m_rows == a.m_rows && c.m_cols == b.m_cols)
+	{
+		c.Fill (std::complex<double> (0, 0));
+	}
+	else
+	{
+		c.Resize (a.m_rows, b.m_cols);
+	}
+
+	// i-k-j order, so that the innermost loop streams over contiguous rows of b and c
+	for (uint16_t i = 0; i < a.m_rows; i++)
+	{
+		std::complex<double> *cRow = c[i];
+		for (uint16_t k = 0; k < a.m_cols; k++)
+		{
+			std::complex<double> aik = a (i, k);
+			if (aik != std::complex<double> (0, 0))
+			{
+				g_axpy (aik, b[k], cRow, b.m_cols);
+			}
+		}
+	}
+}
+
+ComplexMatrix
+ComplexMatrix::Multiply (const ComplexMatrix &a, const ComplexMatrix &b)
+{
+	ComplexMatrix c;
+	Multiply (a, b, c);
+	return c;
+}
+
+int
+ComplexMatrix::LuDecompose (ComplexMatrix &lu, std::vector<uint16_t> &perm)
+{
+	uint16_t n = lu.m_rows;
+	perm.resize (n);
+	for (uint16_t i = 0; i < n; i++)
+	{
+		perm[i] = i;
+	}
+
+	int sign = 1;
+	for (uint16_t k = 0; k < n; k++)
+	{
+		// partial pivoting: pick the largest remaining element of column k
+		uint16_t pivot = k;
+		double maxAbs = std::abs (lu (k, k));
+		for (uint16_t i = k + 1; i < n; i++)
+		{
+			double value = std::abs (lu (i, k));
+			if (value > maxAbs)
+			{
+				maxAbs = value;
+				pivot = i;
+			}
+		}
+		if (maxAbs == 0)
+		{
+			return 0;
+		}
+		if (pivot != k)
+		{
+			std::swap_ranges (lu[k], lu[k] + n, lu[pivot]);
+			std::swap (perm[k], perm[pivot]);
+			sign = -sign;
+		}
+
+		std::complex<double> inv = std::complex<double> (1, 0) / lu (k, k);
+		for (uint16_t i = k + 1; i < n; i++)
+		{
+			std::complex<double> factor = lu (i, k) * inv;
+			lu (i, k) = factor;
+			if (factor != std::complex<double> (0, 0))
+			{
+				g_axpy (-factor, lu[k] + k + 1, lu[i] + k + 1, n - k - 1);
+			}
+		}
+	}
+	return sign;
+}
+
+std::complex<double>
+ComplexMatrix::Determinant () const
+{
+	NS_ASSERT_MSG (m_rows == m_cols, "the determinant is only defined for square matrices");
+	if (m_rows == 0)
+	{
+		return std::complex<double> (0, 0);
+	}
+	ComplexMatrix lu = *this;
+	std::vector<uint16_t> perm;
+	int sign = LuDecompose (lu, perm);
+	if (sign == 0)
+	{
+		return std::complex<double> (0, 0);
+	}
+	std::complex<double> det ((double) sign, 0);
+	for (uint16_t i = 0; i < m_rows; i++)
+	{
+		det *= lu (i, i);
+	}
+	return det;
+}
+
+ComplexMatrix
+ComplexMatrix::Inverse () const
+{
+	NS_ASSERT_MSG (m_rows == m_cols, "the inverse is only defined for square matrices");
+	uint16_t n = m_rows;
+	ComplexMatrix lu = *this;
+	std::vector<uint16_t> perm;
+	if (LuDecompose (lu, perm) == 0)
+	{
+		NS_FATAL_ERROR ("Matrix inversion error, the matrix is singular !");
+	}
+
+	// solve L U x = P e_j for every column j of the identity
+	ComplexMatrix inv (n, n);
+	complexVector_t x (n);
+	for (uint16_t j = 0; j < n; j++)
+	{
+		for (uint16_t i = 0; i < n; i++)
+		{
+			std::complex<double> sum = (perm[i] == j) ? std::complex<double> (1, 0) : std::complex<double> (0, 0);
+			for (uint16_t k = 0; k < i; k++)
+			{
+				sum -= lu (i, k) * x[k];
+			}
+			x[i] = sum;
+		}
+		for (int i = n - 1; i >= 0; i--)
+		{
+			std::complex<double> sum = x[i];
+			for (uint16_t k = i + 1; k < n; k++)
+			{
+				sum -= lu (i, k) * x[k];
+			}
+			x[i] = sum / lu (i, i);
+		}
+		for (uint16_t i = 0; i < n; i++)
+		{
+			inv (i, j) = x[i];
+		}
+	}
+	return inv;
+}
+
+} // namespace ns3
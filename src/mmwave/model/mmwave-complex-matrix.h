@@ -0,0 +1,126 @@
+ /* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+ /*
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef MMWAVE_COMPLEX_MATRIX_H_
+#define MMWAVE_COMPLEX_MATRIX_H_
+
+#include <complex>
+#include <vector>
+#include <stdint.h>
+
+namespace ns3 {
+
+typedef std::vector< std::complex<double> > complexVector_t;
+
+/**
+ * \brief Small dense complex matrix with a contiguous row-major buffer.
+ *
+ * This is the storage used for the hybrid beamforming weight matrices
+ * (antenna elements x beams) of the AntennaArrayModel and the Params3gpp
+ * channel realization. Element (i,j) can be accessed either as m(i,j) or as
+ * m[i][j]. The arithmetic kernels never allocate per row, and the complex
+ * GEMM uses an AVX2/FMA kernel when the CPU supports it.
+ */
+class ComplexMatrix
+{
+public:
+	ComplexMatrix ();
+	ComplexMatrix (uint16_t rows, uint16_t cols, std::complex<double> value = std::complex<double> (0, 0));
+
+	/**
+	 * Resize the matrix, all the elements are set to value
+	 */
+	void Resize (uint16_t rows, uint16_t cols, std::complex<double> value = std::complex<double> (0, 0));
+	void Fill (std::complex<double> value);
+
+	uint16_t GetNumRows () const { return m_rows; }
+	uint16_t GetNumCols () const { return m_cols; }
+	bool IsEmpty () const { return m_data.empty (); }
+
+	/**
+	 * Number of rows, kept for compatibility with the former vector-of-vector type
+	 */
+	size_t size () const { return m_rows; }
+
+	std::complex<double>& operator() (uint16_t row, uint16_t col) { return m_data[row * m_cols + col]; }
+	const std::complex<double>& operator() (uint16_t row, uint16_t col) const { return m_data[row * m_cols + col]; }
+	std::complex<double>* operator[] (uint16_t row) { return &m_data[row * m_cols]; }
+	const std::complex<double>* operator[] (uint16_t row) const { return &m_data[row * m_cols]; }
+
+	std::complex<double>* GetData () { return m_data.data (); }
+	const std::complex<double>* GetData () const { return m_data.data (); }
+
+	/**
+	 * Copy one column of the matrix into a vector
+	 * @param the column index
+	 * @param the output vector, resized to the number of rows
+	 */
+	void GetColumn (uint16_t col, complexVector_t &out) const;
+
+	/**
+	 * @returns the transpose of the matrix
+	 */
+	ComplexMatrix Transpose () const;
+
+	/**
+	 * @returns the conjugate (Hermitian) transpose of the matrix
+	 */
+	ComplexMatrix Hermitian () const;
+
+	/**
+	 * Compute the determinant with an LU decomposition with partial pivoting
+	 * @returns the determinant, the matrix must be square
+	 */
+	std::complex<double> Determinant () const;
+
+	/**
+	 * Compute the inverse with an LU decomposition with partial pivoting
+	 * @returns the inverse, the matrix must be square and not singular
+	 */
+	ComplexMatrix Inverse () const;
+
+	/**
+	 * Compute c = a * b. The storage of c is reused when its size already matches,
+	 * c must not alias a or b
+	 * @param the left operand (r1 x c1)
+	 * @param the right operand (c1 x c2)
+	 * @param the result (r1 x c2)
+	 */
+	static void Multiply (const ComplexMatrix &a, const ComplexMatrix &b, ComplexMatrix &c);
+
+	/**
+	 * @returns a * b
+	 */
+	static ComplexMatrix Multiply (const ComplexMatrix &a, const ComplexMatrix &b);
+
+private:
+	/**
+	 * In-place LU decomposition with partial pivoting of a square matrix stored in lu
+	 * @param the matrix, overwritten with L (unit diagonal, below) and U (on and above the diagonal)
+	 * @param the row permutation
+	 * @returns +1 or -1 (permutation parity), 0 if the matrix is singular
+	 */
+	static int LuDecompose (ComplexMatrix &lu, std::vector<uint16_t> &perm);
+
+	uint16_t m_rows;
+	uint16_t m_cols;
+	complexVector_t m_data;
+};
+
+} // namespace ns3
+
+#endif /* MMWAVE_COMPLEX_MATRIX_H_ */
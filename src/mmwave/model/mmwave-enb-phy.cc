@@ -124,6 +124,18 @@ MmWaveEnbPhy::GetTypeId (void)
 	               DoubleValue (25.6),
 	               MakeDoubleAccessor (&MmWaveEnbPhy::m_ueUpdateSinrPeriod),
 	               MakeDoubleChecker<double> ())
+	.AddAttribute ("PeriodicLinkBudgetUpdate",
+	               "If true, recompute the link budget of all the UEs every 125 microseconds (debug mode). "
+	               "If false, the link budget of a UE is only recomputed after a mobility, beam or attachment change, "
+	               "unless a LOS tracker or a time-varying channel model is used",
+	               BooleanValue (false),
+	               MakeBooleanAccessor (&MmWaveEnbPhy::m_periodicLinkBudgetUpdate),
+	               MakeBooleanChecker())
+	.AddAttribute ("LinkBudgetMaxAge",
+	               "If positive, the cached link budget of a UE is also recomputed when it is older than this value",
+	               TimeValue (Seconds (0)),
+	               MakeTimeAccessor (&MmWaveEnbPhy::m_linkBudgetMaxAge),
+	               MakeTimeChecker ())
 	.AddAttribute("Transient",
 				  "Transient period (in microseconds) in which just collect SINR values without filtering the sample",
 				  IntegerValue (320000),
@@ -214,12 +226,16 @@ MmWaveEnbPhy::DoInitialize (void)
 		NS_ASSERT_MSG((double)m_transient/m_updateSinrPeriod >= 16, "Window too small to compute the variance according to the ApplyFilter method");
 	}
 	Simulator::Schedule(MicroSeconds(0), &MmWaveEnbPhy::UpdateUeSinrEstimate, this);
-	Simulator::Schedule(MicroSeconds(0), &MmWaveEnbPhy::CallPathloss, this);
+	if (m_periodicLinkBudgetUpdate)
+	{
+		Simulator::Schedule(MicroSeconds(0), &MmWaveEnbPhy::CallPathloss, this);
+	}
 	MmWavePhy::DoInitialize ();
 }
 void
 MmWaveEnbPhy::DoDispose (void)
 {
+	m_linkBudgetMap.clear ();
 
 }
 
@@ -581,163 +597,22 @@ void
 MmWaveEnbPhy::CallPathloss()
 {
 	/* THIS METHOD IS JUST USED TO LOOK THROUGH THE ALL EXPERIMENTAL SINR ADITYA'S TRACE
-	EVEN WHEN THE SINR COMPUTATION IS NOT REQUIRED (SINCE THE SINR TRACE IS MADE EVERY 125MICROSECONDS) */
- NS_LOG_FUNCTION(this);
+	EVEN WHEN THE SINR COMPUTATION IS NOT REQUIRED (SINCE THE SINR TRACE IS MADE EVERY 125MICROSECONDS).
+	It is only scheduled when PeriodicLinkBudgetUpdate is true, and it recomputes the link budget of every UE. */
+	NS_LOG_FUNCTION(this);
+	if (!IsLocal ())
+	{
+		return;
+	}
 	Ptr<SpectrumValue> noisePsd = MmWaveSpectrumValueHelper::CreateNoisePowerSpectralDensity (m_phyMacConfig, m_noiseFigure);
 	Ptr<SpectrumValue> totalReceivedPsd = Create <SpectrumValue> (SpectrumValue(noisePsd->GetSpectrumModel()));
 
 	for(std::map<uint64_t, Ptr<NetDevice> >::iterator ue = m_ueAttachedImsiMap.begin(); ue != m_ueAttachedImsiMap.end(); ++ue)
 	{
-		// distinguish between MC and MmWaveNetDevice
-		Ptr<MmWaveUeNetDevice> ueNetDevice = DynamicCast<MmWaveUeNetDevice> (ue->second);
-		Ptr<McUeNetDevice> mcUeDev = DynamicCast<McUeNetDevice> (ue->second);
-		Ptr<MmWaveUePhy> uePhy;
-
-		// get tx power
-		double ueTxPower = 0;
-		if(ueNetDevice != 0) 
-		{
-			uePhy = ueNetDevice->GetPhy();
-			ueTxPower = uePhy->GetTxPower();
-		}
-		else if (mcUeDev != 0) // it may be a MC device
-		{
-			
-
-
-			if(isAddtionalMmWavPhy) //sjkang
-				uePhy = mcUeDev->GetMmWavePhy_2 ();
-			else
-				uePhy = mcUeDev->GetMmWavePhy ();
-
-			ueTxPower = uePhy->GetTxPower();
-
-		}
-		else
-		{
-			NS_FATAL_ERROR("Unrecognized device");
-		}
-		NS_LOG_LOGIC("UE Tx power = " << ueTxPower);
-	    double powerTxW = std::pow (10., (ueTxPower - 30) / 10);
-	    double txPowerDensity = 0;
-    	txPowerDensity = (powerTxW / (m_phyMacConfig->GetSystemBandwidth()));
-	    NS_LOG_LOGIC("Linear UE Tx power = " << powerTxW);
-	    NS_LOG_LOGIC("System bandwidth = " << m_phyMacConfig->GetSystemBandwidth());
-	    NS_LOG_LOGIC("txPowerDensity = " << txPowerDensity);
-		// create tx psd
-		Ptr<SpectrumValue> txPsd =						// it is the eNB that dictates the conf, m_listOfSubchannels contains all the subch
-			MmWaveSpectrumValueHelper::CreateTxPowerSpectralDensity (m_phyMacConfig, ueTxPower, m_listOfSubchannels);
-		NS_LOG_LOGIC("TxPsd " << *txPsd);
-
-		// get this node and remote node mobility
-		Ptr<MobilityModel> enbMob = m_netDevice->GetNode()->GetObject<MobilityModel>(); 
-		NS_LOG_LOGIC("eNB mobility " << enbMob->GetPosition());
-		Ptr<MobilityModel> ueMob = ue->second->GetNode()->GetObject<MobilityModel>();
-		NS_LOG_DEBUG("UE mobility " << ueMob->GetPosition());
-		
-		// compute rx psd
-
-		// adjuts beamforming of antenna model wrt user
-		Ptr<AntennaArrayModel> rxAntennaArray = DynamicCast<AntennaArrayModel> (GetDlSpectrumPhy ()->GetRxAntenna());
-		rxAntennaArray->ChangeBeamformingVector (ue->second);									// TODO check if this is the correct antenna
-		Ptr<AntennaArrayModel> txAntennaArray = DynamicCast<AntennaArrayModel> (uePhy->GetDlSpectrumPhy ()->GetRxAntenna());
-		txAntennaArray->ChangeBeamformingVector (m_netDevice);									// TODO check if this is the correct antenna
-
-		double pathLossDb = 0;
-		if (txAntennaArray != 0)
-		{
-		  Angles txAngles (enbMob->GetPosition (), ueMob->GetPosition ());
-		  double txAntennaGain = txAntennaArray->GetGainDb (txAngles);
-		  NS_LOG_LOGIC ("txAntennaGain = " << txAntennaGain << " dB");
-		  pathLossDb -= txAntennaGain;
-		}
-		if (rxAntennaArray != 0)
-		{
-		  Angles rxAngles (ueMob->GetPosition (), enbMob->GetPosition ());
-		  double rxAntennaGain = rxAntennaArray->GetGainDb (rxAngles);
-		  NS_LOG_LOGIC ("rxAntennaGain = " << rxAntennaGain << " dB");
-		  pathLossDb -= rxAntennaGain;
-		}
-		if (m_propagationLoss)
-		{
-			if (m_losTracker != 0) // if I am using the PL propagation model with Aditya's traces
-			{
-				m_losTracker->UpdateLosNlosState(ueMob,enbMob); // update the maps to keep trak of the real PL values, before computing the PL
-			}
-		  double propagationGainDb = m_propagationLoss->CalcRxPower (0, ueMob, enbMob);
-		  NS_LOG_LOGIC ("propagationGainDb = " << propagationGainDb << " dB");
-		  pathLossDb -= propagationGainDb;
-		}                    
-		//NS_LOG_DEBUG ("total pathLoss = " << pathLossDb << " dB");    
-
-		double pathGainLinear = std::pow (10.0, (-pathLossDb) / 10.0);
-		Ptr<SpectrumValue> rxPsd = txPsd->Copy();
-		*(rxPsd) *= pathGainLinear;              
-		//std::cout << this  << "\t" << txPsd << std::endl;
-		Ptr<MmWaveBeamforming> beamforming = DynamicCast<MmWaveBeamforming> (m_spectrumPropagationLossModel);
-		//beamforming->SetBeamformingVector(ue->second, m_netDevice);
-		Ptr<MmWaveChannelMatrix> channelMatrix = DynamicCast<MmWaveChannelMatrix> (m_spectrumPropagationLossModel);
-		Ptr<MmWaveChannelRaytracing> rayTracing = DynamicCast<MmWaveChannelRaytracing> (m_spectrumPropagationLossModel);
-		if (beamforming != 0)
-		{
-			//if (isAddtionalMmWavPhy) //sjkang
-			//	beamforming->isAdditionalMmWavePhy=true;
-			//else
-			//	beamforming->isAdditionalMmWavePhy=false;
-			rxPsd = beamforming->CalcRxPowerSpectralDensity(rxPsd, ueMob, enbMob);
-			NS_LOG_LOGIC("RxPsd " << *rxPsd);
-		}
-		else if (channelMatrix != 0)
-		{
-			rxPsd = channelMatrix->CalcRxPowerSpectralDensity(rxPsd, ueMob, enbMob);
-			NS_LOG_LOGIC("RxPsd " << *rxPsd);
-		}
-		else if (rayTracing != 0)
-		{
-			rxPsd = rayTracing->CalcRxPowerSpectralDensity(rxPsd, ueMob, enbMob);
-			NS_LOG_LOGIC("RxPsd " << *rxPsd);
-		}
-		m_rxPsdMap[ue->first] = rxPsd;
-		*totalReceivedPsd += *rxPsd;
-
-		// set back the bf vector to the main eNB
-		if(ueNetDevice != 0) 
-		{														// target not set yet
-			if((ueNetDevice->GetTargetEnb() != m_netDevice) && (ueNetDevice->GetTargetEnb() != 0))
-			{
-				txAntennaArray->ChangeBeamformingVector(ueNetDevice->GetTargetEnb());
-			}
-		}
-		else if (mcUeDev != 0) // it may be a MC device
-		{															// target not set yet
-			//if(isAddtionalMmWavPhy){
-			if((mcUeDev->GetMmWaveTargetEnb() != m_netDevice) && (mcUeDev->GetMmWaveTargetEnb() != 0) && !isAddtionalMmWavPhy)
-			{
-				//std::cout << this << "---->" << "0 target Enb is --->" <<isAddtionalMmWavPhy <<std::endl;
-				//if(isAddtionalMmWavPhy)
-
-				txAntennaArray->ChangeBeamformingVector(mcUeDev->GetMmWaveTargetEnb());
-				//std::cout << this << "---->" << "0 target Enb is --->" <<isAddtionalMmWavPhy <<std::endl;
-
-
-			}
-			//}//else {
-				if((mcUeDev->GetMmWaveTargetEnb_2() != m_netDevice) && (mcUeDev->GetMmWaveTargetEnb_2() != 0) && isAddtionalMmWavPhy) //sjkang1117
-			{
-				//std::cout << this << "---->" << "1 target Enb is----> " <<isAddtionalMmWavPhy<< std::endl;
-				//if(!isAddtionalMmWavPhy)
-				txAntennaArray->ChangeBeamformingVector(mcUeDev->GetMmWaveTargetEnb_2());
-				//std::cout << this << "---->" << "1 target Enb is----> " <<isAddtionalMmWavPhy<< std::endl;
-
-
-			}
-			//}
-		}
-		else
-		{
-			NS_FATAL_ERROR("Unrecognized device");
-		}
-
+		UeLinkBudget &link = m_linkBudgetMap[ue->first];
+		ComputeUeLinkBudget (ue->second, link);
+		m_rxPsdMap[ue->first] = link.m_rxPsd;
+		*totalReceivedPsd += *link.m_rxPsd;
 	}
 
 	for(std::map<uint64_t, Ptr<SpectrumValue> >::iterator ue = m_rxPsdMap.begin(); ue != m_rxPsdMap.end(); ++ue)
@@ -753,158 +628,246 @@ MmWaveEnbPhy::CallPathloss()
 	Simulator::Schedule(MicroSeconds(125), &MmWaveEnbPhy::CallPathloss, this); // since one slot every 125 microseconds
 }
 
+Ptr<MmWaveUePhy>
+MmWaveEnbPhy::GetUePhy (Ptr<NetDevice> ueDevice) const
+{
+	// distinguish between MC and MmWaveNetDevice
+	Ptr<MmWaveUeNetDevice> ueNetDevice = DynamicCast<MmWaveUeNetDevice> (ueDevice);
+	Ptr<McUeNetDevice> mcUeDev = DynamicCast<McUeNetDevice> (ueDevice);
+	if (ueNetDevice != 0)
+	{
+		return ueNetDevice->GetPhy ();
+	}
+	else if (mcUeDev != 0) // it may be a MC device
+	{
+		if (isAddtionalMmWavPhy) //sjkang
+			return mcUeDev->GetMmWavePhy_2 ();
+		else
+			return mcUeDev->GetMmWavePhy ();
+	}
+	NS_FATAL_ERROR("Unrecognized device");
+	return 0;
+}
+
+Ptr<NetDevice>
+MmWaveEnbPhy::GetUeTargetEnb (Ptr<NetDevice> ueDevice) const
+{
+	Ptr<MmWaveUeNetDevice> ueNetDevice = DynamicCast<MmWaveUeNetDevice> (ueDevice);
+	Ptr<McUeNetDevice> mcUeDev = DynamicCast<McUeNetDevice> (ueDevice);
+	if (ueNetDevice != 0)
+	{
+		return ueNetDevice->GetTargetEnb ();
+	}
+	else if (mcUeDev != 0)
+	{
+		if (isAddtionalMmWavPhy)
+			return mcUeDev->GetMmWaveTargetEnb_2 ();
+		else
+			return mcUeDev->GetMmWaveTargetEnb ();
+	}
+	NS_FATAL_ERROR("Unrecognized device");
+	return 0;
+}
+
+bool
+MmWaveEnbPhy::IsLinkBudgetCacheable () const
+{
+	// the LOS tracker switches the LOS/NLOS state of the links over time
+	if (m_losTracker != 0)
+	{
+		return false;
+	}
+	// the small scale fading of these models follows the simulation time,
+	// and MmWaveBeamforming also regenerates its channel matrices periodically
+	if (DynamicCast<MmWaveBeamforming> (m_spectrumPropagationLossModel) != 0
+		|| DynamicCast<MmWaveChannelRaytracing> (m_spectrumPropagationLossModel) != 0)
+	{
+		return false;
+	}
+	// a 3GPP channel with spatially consistent updates is regenerated every UpdatePeriod
+	Ptr<MmWave3gppChannel> mmWave3gpp = DynamicCast<MmWave3gppChannel> (m_spectrumPropagationLossModel);
+	if (mmWave3gpp != 0)
+	{
+		TimeValue updatePeriod;
+		mmWave3gpp->GetAttribute ("UpdatePeriod", updatePeriod);
+		if (updatePeriod.Get () > Seconds (0))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool
+MmWaveEnbPhy::IsUeLinkBudgetValid (Ptr<NetDevice> ueDevice, const UeLinkBudget &link) const
+{
+	if (link.m_rxPsd == 0)
+	{
+		return false;
+	}
+	if (m_linkBudgetMaxAge > Seconds (0) && Simulator::Now () - link.m_computedTime >= m_linkBudgetMaxAge)
+	{
+		return false;
+	}
+	// mobility, a moving node also gives a time-varying Doppler term
+	Ptr<MobilityModel> ueMob = ueDevice->GetNode ()->GetObject<MobilityModel> ();
+	Ptr<MobilityModel> enbMob = m_netDevice->GetNode ()->GetObject<MobilityModel> ();
+	if (CalculateDistance (link.m_uePosition, ueMob->GetPosition ()) > 0
+		|| CalculateDistance (link.m_enbPosition, enbMob->GetPosition ()) > 0
+		|| ueMob->GetVelocity ().GetLength () > 0 || enbMob->GetVelocity ().GetLength () > 0)
+	{
+		return false;
+	}
+	// attachment and power
+	if (link.m_targetEnb != GetUeTargetEnb (ueDevice) || link.m_ueTxPower != link.m_uePhy->GetTxPower ())
+	{
+		return false;
+	}
+	// beams
+	return link.m_ueAntennaArray->GetBeamVersion (m_netDevice) == link.m_ueBeamVersion
+		   && link.m_enbAntennaArray->GetBeamVersion (ueDevice) == link.m_enbBeamVersion;
+}
 
+void
+MmWaveEnbPhy::ComputeUeLinkBudget (Ptr<NetDevice> ueDevice, UeLinkBudget &link)
+{
+	NS_LOG_FUNCTION (this << ueDevice);
+	Ptr<MmWaveUePhy> uePhy = GetUePhy (ueDevice);
+	// get tx power
+	double ueTxPower = uePhy->GetTxPower();
+	NS_LOG_LOGIC("UE Tx power = " << ueTxPower);
+	// create tx psd
+	Ptr<SpectrumValue> txPsd =						// it is the eNB that dictates the conf, m_listOfSubchannels contains all the subch
+		MmWaveSpectrumValueHelper::CreateTxPowerSpectralDensity (m_phyMacConfig, ueTxPower, m_listOfSubchannels);
+	NS_LOG_LOGIC("TxPsd " << *txPsd);
+
+	// get this node and remote node mobility
+	Ptr<MobilityModel> enbMob = m_netDevice->GetNode()->GetObject<MobilityModel>();
+	NS_LOG_LOGIC("eNB mobility " << enbMob->GetPosition());
+	Ptr<MobilityModel> ueMob = ueDevice->GetNode()->GetObject<MobilityModel>();
+	NS_LOG_DEBUG("UE mobility " << ueMob->GetPosition());
+
+	// compute rx psd
+
+	// adjuts beamforming of antenna model wrt user
+	Ptr<AntennaArrayModel> rxAntennaArray = DynamicCast<AntennaArrayModel> (GetDlSpectrumPhy ()->GetRxAntenna());
+	rxAntennaArray->ChangeBeamformingVector (ueDevice);									// TODO check if this is the correct antenna
+	Ptr<AntennaArrayModel> txAntennaArray = DynamicCast<AntennaArrayModel> (uePhy->GetDlSpectrumPhy ()->GetRxAntenna());																				// Dl, since the Ul is not actually used (TDD device)
+	txAntennaArray->ChangeBeamformingVector (m_netDevice);									// TODO check if this is the correct antenna
+
+	double pathLossDb = 0;
+	if (txAntennaArray != 0)
+	{
+	  Angles txAngles (enbMob->GetPosition (), ueMob->GetPosition ());
+	  double txAntennaGain = txAntennaArray->GetGainDb (txAngles);
+	  NS_LOG_LOGIC ("txAntennaGain = " << txAntennaGain << " dB");
+	  pathLossDb -= txAntennaGain;
+	}
+	if (rxAntennaArray != 0)
+	{
+	  Angles rxAngles (ueMob->GetPosition (), enbMob->GetPosition ());
+	  double rxAntennaGain = rxAntennaArray->GetGainDb (rxAngles);
+	  NS_LOG_LOGIC ("rxAntennaGain = " << rxAntennaGain << " dB");
+	  pathLossDb -= rxAntennaGain;
+	}
+	if (m_propagationLoss)
+	{
+		if (m_losTracker != 0) // if I am using the PL propagation model with Aditya's traces
+		{
+			m_losTracker->UpdateLosNlosState(ueMob,enbMob); // update the maps to keep trak of the real PL values, before computing the PL
+		}
+	  double propagationGainDb = m_propagationLoss->CalcRxPower (0, ueMob, enbMob);
+	  NS_LOG_LOGIC ("propagationGainDb = " << propagationGainDb << " dB");
+	  pathLossDb -= propagationGainDb;
+	}
+	NS_LOG_DEBUG ("total pathLoss = " << pathLossDb << " dB");
+
+	double pathGainLinear = std::pow (10.0, (-pathLossDb) / 10.0);
+	Ptr<SpectrumValue> rxPsd = txPsd->Copy();
+	*(rxPsd) *= pathGainLinear;
+
+	Ptr<MmWaveBeamforming> beamforming = DynamicCast<MmWaveBeamforming> (m_spectrumPropagationLossModel);
+	//beamforming->SetBeamformingVector(ue->second, m_netDevice);
+	Ptr<MmWaveChannelMatrix> channelMatrix = DynamicCast<MmWaveChannelMatrix> (m_spectrumPropagationLossModel);
+	Ptr<MmWaveChannelRaytracing> rayTracing = DynamicCast<MmWaveChannelRaytracing> (m_spectrumPropagationLossModel);
+	Ptr<MmWave3gppChannel> mmWave3gpp = DynamicCast<MmWave3gppChannel> (m_spectrumPropagationLossModel);
+	if (beamforming != 0)
+	{
+		rxPsd = beamforming->CalcRxPowerSpectralDensity(rxPsd, ueMob, enbMob);
+		NS_LOG_LOGIC("RxPsd " << *rxPsd);
+	}
+	else if (channelMatrix != 0)
+	{
+		rxPsd = channelMatrix->CalcRxPowerSpectralDensity(rxPsd, ueMob, enbMob);
+		NS_LOG_LOGIC("RxPsd " << *rxPsd);
+	}
+	else if (rayTracing != 0)
+	{
+		rxPsd = rayTracing->CalcRxPowerSpectralDensity(rxPsd, ueMob, enbMob);
+		NS_LOG_LOGIC("RxPsd " << *rxPsd);
+	}
+	else if (mmWave3gpp != 0)
+	{
+		rxPsd = mmWave3gpp->CalcRxPowerSpectralDensity(rxPsd, ueMob, enbMob);
+		NS_LOG_LOGIC("RxPsd " << *rxPsd);
+	}
 
+	// set back the bf vector to the main eNB
+	Ptr<NetDevice> targetEnb = GetUeTargetEnb (ueDevice);
+	if ((targetEnb != m_netDevice) && (targetEnb != 0))	// target not set yet
+	{
+		txAntennaArray->ChangeBeamformingVector(targetEnb);
+	}
 
+	link.m_rxPsd = rxPsd;
+	link.m_uePhy = uePhy;
+	link.m_ueTxPower = ueTxPower;
+	link.m_uePosition = ueMob->GetPosition ();
+	link.m_enbPosition = enbMob->GetPosition ();
+	link.m_targetEnb = targetEnb;
+	link.m_ueAntennaArray = txAntennaArray;
+	link.m_enbAntennaArray = rxAntennaArray;
+	link.m_ueBeamVersion = txAntennaArray->GetBeamVersion (m_netDevice);
+	link.m_enbBeamVersion = rxAntennaArray->GetBeamVersion (ueDevice);
+	link.m_computedTime = Simulator::Now ();
+}
 
 void
 MmWaveEnbPhy::UpdateUeSinrEstimate()
 {
     NS_LOG_FUNCTION(this);
+	if (!IsLocal ())
+	{
+		return;
+	}
 	m_sinrMap.clear();
 	m_rxPsdMap.clear();
 	
 
 	Ptr<SpectrumValue> noisePsd = MmWaveSpectrumValueHelper::CreateNoisePowerSpectralDensity (m_phyMacConfig, m_noiseFigure);
 	Ptr<SpectrumValue> totalReceivedPsd = Create <SpectrumValue> (SpectrumValue(noisePsd->GetSpectrumModel()));
+	bool cacheable = IsLinkBudgetCacheable ();
 
 	for(std::map<uint64_t, Ptr<NetDevice> >::iterator ue = m_ueAttachedImsiMap.begin(); ue != m_ueAttachedImsiMap.end(); ++ue)
 	{
-		// distinguish between MC and MmWaveNetDevice
-		Ptr<MmWaveUeNetDevice> ueNetDevice = DynamicCast<MmWaveUeNetDevice> (ue->second);
-		Ptr<McUeNetDevice> mcUeDev = DynamicCast<McUeNetDevice> (ue->second);
-		Ptr<MmWaveUePhy> uePhy;
-		// get tx power
-		double ueTxPower = 0;
-		if(ueNetDevice != 0) 
+		if (ue->second->GetNode ()->GetSystemId () != m_netDevice->GetNode ()->GetSystemId ())
 		{
-			uePhy = ueNetDevice->GetPhy();
-			ueTxPower = uePhy->GetTxPower();
+			// the UE is simulated by another rank, its PHY is not up to date here
+			continue;
 		}
-		else if (mcUeDev != 0) // it may be a MC device
+		// with a static channel, the link budget is only recomputed after a mobility, beam or attachment change
+		UeLinkBudget &link = m_linkBudgetMap[ue->first];
+		if (!cacheable || !IsUeLinkBudgetValid (ue->second, link))
 		{
-			
-
-			if(isAddtionalMmWavPhy) //sjkang
-				uePhy = mcUeDev->GetMmWavePhy_2 ();
-
-			else
-				uePhy = mcUeDev->GetMmWavePhy ();
-			ueTxPower = uePhy->GetTxPower();	
+			ComputeUeLinkBudget (ue->second, link);
 		}
 		else
 		{
-			NS_FATAL_ERROR("Unrecognized device");
-		}
-		NS_LOG_LOGIC("UE Tx power = " << ueTxPower);
-	    double powerTxW = std::pow (10., (ueTxPower - 30) / 10);
-	    double txPowerDensity = 0;
-    	txPowerDensity = (powerTxW / (m_phyMacConfig->GetSystemBandwidth()));
-	    NS_LOG_LOGIC("Linear UE Tx power = " << powerTxW);
-	    NS_LOG_LOGIC("System bandwidth = " << m_phyMacConfig->GetSystemBandwidth());
-	    NS_LOG_LOGIC("txPowerDensity = " << txPowerDensity);
-		// create tx psd
-		Ptr<SpectrumValue> txPsd =						// it is the eNB that dictates the conf, m_listOfSubchannels contains all the subch
-			MmWaveSpectrumValueHelper::CreateTxPowerSpectralDensity (m_phyMacConfig, ueTxPower, m_listOfSubchannels);
-		NS_LOG_LOGIC("TxPsd " << *txPsd);
-
-		// get this node and remote node mobility
-		Ptr<MobilityModel> enbMob = m_netDevice->GetNode()->GetObject<MobilityModel>(); 
-		NS_LOG_LOGIC("eNB mobility " << enbMob->GetPosition());
-		Ptr<MobilityModel> ueMob = ue->second->GetNode()->GetObject<MobilityModel>();
-		NS_LOG_DEBUG("UE mobility " << ueMob->GetPosition());
-		
-		// compute rx psd
-
-		// adjuts beamforming of antenna model wrt user
-		Ptr<AntennaArrayModel> rxAntennaArray = DynamicCast<AntennaArrayModel> (GetDlSpectrumPhy ()->GetRxAntenna());
-		rxAntennaArray->ChangeBeamformingVector (ue->second);									// TODO check if this is the correct antenna
-		Ptr<AntennaArrayModel> txAntennaArray = DynamicCast<AntennaArrayModel> (uePhy->GetDlSpectrumPhy ()->GetRxAntenna());																				// Dl, since the Ul is not actually used (TDD device)
-		txAntennaArray->ChangeBeamformingVector (m_netDevice);									// TODO check if this is the correct antenna
-		
-		double pathLossDb = 0;
-		if (txAntennaArray != 0)
-		{
-		  Angles txAngles (enbMob->GetPosition (), ueMob->GetPosition ());
-		  double txAntennaGain = txAntennaArray->GetGainDb (txAngles);
-		  NS_LOG_LOGIC ("txAntennaGain = " << txAntennaGain << " dB");
-		  pathLossDb -= txAntennaGain;
-		}
-		if (rxAntennaArray != 0)
-		{
-		  Angles rxAngles (ueMob->GetPosition (), enbMob->GetPosition ());
-		  double rxAntennaGain = rxAntennaArray->GetGainDb (rxAngles);
-		  NS_LOG_LOGIC ("rxAntennaGain = " << rxAntennaGain << " dB");
-		  pathLossDb -= rxAntennaGain;
-		}
-		if (m_propagationLoss)
-		{
-			if (m_losTracker != 0) // if I am using the PL propagation model with Aditya's traces
-			{
-				m_losTracker->UpdateLosNlosState(ueMob,enbMob); // update the maps to keep trak of the real PL values, before computing the PL
-			}
-		  double propagationGainDb = m_propagationLoss->CalcRxPower (0, ueMob, enbMob);
-		  NS_LOG_LOGIC ("propagationGainDb = " << propagationGainDb << " dB");
-		  pathLossDb -= propagationGainDb;
-		}                    
-		NS_LOG_DEBUG ("total pathLoss = " << pathLossDb << " dB");
-
-		double pathGainLinear = std::pow (10.0, (-pathLossDb) / 10.0);
-		Ptr<SpectrumValue> rxPsd = txPsd->Copy();
-		*(rxPsd) *= pathGainLinear;              
-
-		Ptr<MmWaveBeamforming> beamforming = DynamicCast<MmWaveBeamforming> (m_spectrumPropagationLossModel);
-		//beamforming->SetBeamformingVector(ue->second, m_netDevice);
-		Ptr<MmWaveChannelMatrix> channelMatrix = DynamicCast<MmWaveChannelMatrix> (m_spectrumPropagationLossModel);
-		Ptr<MmWaveChannelRaytracing> rayTracing = DynamicCast<MmWaveChannelRaytracing> (m_spectrumPropagationLossModel);
-		Ptr<MmWave3gppChannel> mmWave3gpp = DynamicCast<MmWave3gppChannel> (m_spectrumPropagationLossModel);
-		if (beamforming != 0)
-		{
-			rxPsd = beamforming->CalcRxPowerSpectralDensity(rxPsd, ueMob, enbMob);
-			NS_LOG_LOGIC("RxPsd " << *rxPsd);
-		}
-		else if (channelMatrix != 0)
-		{
-			rxPsd = channelMatrix->CalcRxPowerSpectralDensity(rxPsd, ueMob, enbMob);
-			NS_LOG_LOGIC("RxPsd " << *rxPsd);
-		}
-		else if (rayTracing != 0)
-		{
-			rxPsd = rayTracing->CalcRxPowerSpectralDensity(rxPsd, ueMob, enbMob);
-			NS_LOG_LOGIC("RxPsd " << *rxPsd);
-		}
-		else if (mmWave3gpp != 0)
-		{
-			rxPsd = mmWave3gpp->CalcRxPowerSpectralDensity(rxPsd, ueMob, enbMob);
-			NS_LOG_LOGIC("RxPsd " << *rxPsd);
-		}	
-		m_rxPsdMap[ue->first] = rxPsd;
-
-		*totalReceivedPsd += *rxPsd;
-
-		// set back the bf vector to the main eNB
-		if(ueNetDevice != 0) 
-		{														// target not set yet
-			if((ueNetDevice->GetTargetEnb() != m_netDevice) && (ueNetDevice->GetTargetEnb() != 0))
-			{
-				txAntennaArray->ChangeBeamformingVector(ueNetDevice->GetTargetEnb());
-			}
-		}
-		else if (mcUeDev != 0) // it may be a MC device
-		{															// target not set yet
-			if((mcUeDev->GetMmWaveTargetEnb() != m_netDevice) && (mcUeDev->GetMmWaveTargetEnb() != 0) && !isAddtionalMmWavPhy)
-			{
-				txAntennaArray->ChangeBeamformingVector(mcUeDev->GetMmWaveTargetEnb());
-			}else if((mcUeDev->GetMmWaveTargetEnb_2() != m_netDevice) && (mcUeDev->GetMmWaveTargetEnb_2() != 0) && isAddtionalMmWavPhy ) //sjkang1117
-			{
-				txAntennaArray->ChangeBeamformingVector(mcUeDev->GetMmWaveTargetEnb_2());
-			}
-		}
-		else
-		{
-			NS_FATAL_ERROR("Unrecognized device");
+			NS_LOG_LOGIC ("Reuse the link budget of UE " << ue->first);
 		}
+		m_rxPsdMap[ue->first] = link.m_rxPsd;
 
+		*totalReceivedPsd += *link.m_rxPsd;
 	}
 
 	for(std::map<uint64_t, Ptr<SpectrumValue> >::iterator ue = m_rxPsdMap.begin(); ue != m_rxPsdMap.end(); ++ue)
@@ -1127,24 +1090,14 @@ MmWaveEnbPhy::UpdateUeSinrEstimate()
 		m_roundFromLastUeSinrUpdate = 0;
 		for(std::map<uint64_t, Ptr<NetDevice> >::iterator ue = m_ueAttachedImsiMap.begin(); ue != m_ueAttachedImsiMap.end(); ++ue)
 		{
-			// distinguish between MC and MmWaveNetDevice
-			Ptr<MmWaveUeNetDevice> ueNetDevice = DynamicCast<MmWaveUeNetDevice> (ue->second);
-			Ptr<McUeNetDevice> mcUeDev = DynamicCast<McUeNetDevice> (ue->second);
-			Ptr<MmWaveUePhy> uePhy;
-			if(ueNetDevice != 0) 
+			std::map<uint64_t, double>::iterator sinr = m_sinrMap.find(ue->first);
+			if (sinr == m_sinrMap.end ())
 			{
-				uePhy = ueNetDevice->GetPhy();
+				// no estimate for the UEs simulated by another rank
+				continue;
 			}
-			else if (mcUeDev != 0) // it may be a MC device
-			{
-
-				if (isAddtionalMmWavPhy)
-					uePhy = mcUeDev->GetMmWavePhy_2 ();
-				else
-					uePhy = mcUeDev->GetMmWavePhy ();
-
-			}
-			uePhy->UpdateSinrEstimate(m_cellId, m_sinrMap.find(ue->first)->second);
+			Ptr<MmWaveUePhy> uePhy = GetUePhy (ue->second);
+			uePhy->UpdateSinrEstimate(m_cellId, sinr->second);
 		}
 	}
 	else
@@ -1164,6 +1117,11 @@ void
 MmWaveEnbPhy::StartSubFrame (void)
 {
 	NS_LOG_FUNCTION (this);
+	if (!IsLocal ())
+	{
+		// replica of a cell of another rank
+		return;
+	}
 
 	m_lastSfStart = Simulator::Now();
 
@@ -53,6 +53,27 @@ class MmWaveNetDevice;
 class MmWaveUePhy;
 class MmWaveEnbMac;
 
+/**
+ * Uplink link budget of an attached UE, shared by UpdateUeSinrEstimate and CallPathloss.
+ * It stores the state it was computed from, so that it is only recomputed after a
+ * mobility, beam or attachment change. It is not reused with a LOS tracker or a
+ * time-varying channel model.
+ */
+struct UeLinkBudget
+{
+	Ptr<SpectrumValue> m_rxPsd; // rx PSD at this eNB, null if never computed
+	Ptr<MmWaveUePhy> m_uePhy;
+	double m_ueTxPower;
+	Vector m_uePosition;
+	Vector m_enbPosition;
+	Ptr<NetDevice> m_targetEnb;
+	Ptr<AntennaArrayModel> m_ueAntennaArray;
+	Ptr<AntennaArrayModel> m_enbAntennaArray;
+	uint32_t m_ueBeamVersion;
+	uint32_t m_enbBeamVersion;
+	Time m_computedTime;
+};
+
 class MmWaveEnbPhy : public MmWavePhy
 {
 	friend class MemberLteEnbCphySapProvider<MmWaveEnbPhy>;
@@ -152,6 +173,12 @@ private:
 	void DoSetBandwidth (uint8_t Bandwidth );
 	void DoSetEarfcn (uint16_t Earfcn );
 
+	Ptr<MmWaveUePhy> GetUePhy (Ptr<NetDevice> ueDevice) const;
+	Ptr<NetDevice> GetUeTargetEnb (Ptr<NetDevice> ueDevice) const;
+	bool IsLinkBudgetCacheable () const;
+	bool IsUeLinkBudgetValid (Ptr<NetDevice> ueDevice, const UeLinkBudget &link) const;
+	void ComputeUeLinkBudget (Ptr<NetDevice> ueDevice, UeLinkBudget &link);
+
 	void QueueUlTbAlloc (TbAllocInfo tbAllocInfo);
 	std::list<TbAllocInfo> DequeueUlTbAlloc ();
 
@@ -178,6 +205,9 @@ private:
 	std::map <uint64_t, Ptr<NetDevice> > m_ueAttachedImsiMap;
 	std::map <uint64_t, double > m_sinrMap;
 	std::map <uint64_t, Ptr<SpectrumValue> > m_rxPsdMap;
+	std::map <uint64_t, UeLinkBudget> m_linkBudgetMap; // cached link budget of the attached UEs
+	bool m_periodicLinkBudgetUpdate; // if true, CallPathloss recomputes all the link budgets every 125 us
+	Time m_linkBudgetMaxAge; // if positive, maximum age of a cached link budget
 	std::map <pairDevices_t , std::vector<double> > m_sinrVector; // array containing all SINR values for a specific pair (UE-eNB)
 	std::map <pairDevices_t , std::vector<double> > m_sinrVectorToFilter; // array containing the  SINR values that must be filtered
 	std::map <pairDevices_t , std::vector<double> > m_sinrVectorNoisy; // array containing the  noisy SINR values that must be filteredF
@@ -37,6 +37,7 @@
 #include "mmwave-mac-pdu-tag.h"
 #include "mmwave-spectrum-value-helper.h"
 #include <cmath>
+#include <algorithm>
 
 namespace ns3 {
 
@@ -165,6 +166,7 @@ MmWaveFlexTtiMacSchedSapProvider::SchedSetMcs (int mcs)
 const unsigned MmWaveFlexTtiMacScheduler::m_macHdrSize = 0;
 const unsigned MmWaveFlexTtiMacScheduler::m_subHdrSize = 4;
 const unsigned MmWaveFlexTtiMacScheduler::m_rlcHdrSize = 3;
+const uint32_t MmWaveFlexTtiMacScheduler::m_noUe = 0xFFFFFFFF;
 
 const double MmWaveFlexTtiMacScheduler::m_berDl = 0.001;
 
@@ -189,15 +191,14 @@ void
 MmWaveFlexTtiMacScheduler::DoDispose (void)
 {
 	NS_LOG_FUNCTION (this);
-	m_wbCqiRxed.clear();
-  m_dlHarqProcessesDciInfoMap.clear ();
-  m_dlHarqProcessesTimer.clear ();
-  m_dlHarqProcessesRlcPduMap.clear ();
+	m_ues.clear ();
+	m_ueIndex.clear ();
+	m_uesByRnti.clear ();
+	m_freeUes.clear ();
+	m_activeUes.clear ();
   m_dlHarqInfoList.clear ();
-  m_ulHarqCurrentProcessId.clear ();
-  m_ulHarqProcessesStatus.clear ();
-  m_ulHarqProcessesTimer.clear ();
-  m_ulHarqProcessesDciInfoMap.clear ();
+  m_ulHarqInfoList.clear ();
+  m_ulCqiSinr = 0;
   delete m_macCschedSapProvider;
   delete m_macSchedSapProvider;
 }
@@ -307,19 +308,89 @@ MmWaveFlexTtiMacScheduler::ConfigureCommonParameters (Ptr<MmWavePhyMacCommon> co
 	}
 }
 
+uint32_t
+MmWaveFlexTtiMacScheduler::FindUe (uint16_t rnti) const
+{
+	if (rnti < m_ueIndex.size ())
+	{
+		return m_ueIndex[rnti];
+	}
+	return m_noUe;
+}
+
+uint32_t
+MmWaveFlexTtiMacScheduler::AddUe (uint16_t rnti)
+{
+	uint32_t index = FindUe (rnti);
+	if (index != m_noUe)
+	{
+		return index;
+	}
+	if (rnti >= m_ueIndex.size ())
+	{
+		m_ueIndex.resize (rnti + 1, m_noUe);
+	}
+	if (m_freeUes.empty ())
+	{
+		index = m_ues.size ();
+		m_ues.push_back (UeState ());
+	}
+	else
+	{
+		index = m_freeUes.back ();
+		m_freeUes.pop_back ();
+	}
+	m_ues[index].Reset (rnti);
+	m_ueIndex[rnti] = index;
+	// keep the used entries sorted by RNTI, as the maps were
+	std::vector<uint32_t>::iterator it = m_uesByRnti.begin ();
+	while (it != m_uesByRnti.end () && m_ues[*it].m_rnti < rnti)
+	{
+		it++;
+	}
+	m_uesByRnti.insert (it, index);
+	return index;
+}
+
+void
+MmWaveFlexTtiMacScheduler::RemoveUeIfUnused (uint32_t index)
+{
+	UeState &ue = m_ues[index];
+	if (ue.m_hasDlCqi || ue.m_hasUlCqi || ue.m_hasBsr || ue.m_hasDlHarq || ue.m_hasUlHarq || !ue.m_rlcBuffers.empty ())
+	{
+		return;
+	}
+	NS_LOG_INFO (this << " Free the entry of RNTI " << ue.m_rnti);
+	m_ueIndex[ue.m_rnti] = m_noUe;
+	m_uesByRnti.erase (std::find (m_uesByRnti.begin (), m_uesByRnti.end (), index));
+	ue.m_rnti = 0;
+	m_freeUes.push_back (index);
+}
+
+void
+MmWaveFlexTtiMacScheduler::ActivateUe (uint32_t index)
+{
+	if (!m_ues[index].m_active)
+	{
+		m_ues[index].m_active = true;
+		m_activeUes.push_back (index);
+	}
+}
+
 void
 MmWaveFlexTtiMacScheduler::DoSchedDlRlcBufferReq (const struct MmWaveMacSchedSapProvider::SchedDlRlcBufferReqParameters& params)
 {
   NS_LOG_FUNCTION (this << params.m_rnti << (uint32_t) params.m_logicalChannelIdentity);
   // API generated by RLC for updating RLC parameters on a LC (tx and retx queues)
-  std::list<MmWaveMacSchedSapProvider::SchedDlRlcBufferReqParameters>::iterator it = m_rlcBufferReq.begin ();
+  UeState &ue = m_ues[AddUe (params.m_rnti)];
+  std::vector<MmWaveMacSchedSapProvider::SchedDlRlcBufferReqParameters>::iterator it = ue.m_rlcBuffers.begin ();
   bool newLc = true;
-  while (it != m_rlcBufferReq.end ())
+  while (it != ue.m_rlcBuffers.end ())
     {
       // remove old entries of this UE-LC
-      if (((*it).m_rnti == params.m_rnti)&&((*it).m_logicalChannelIdentity == params.m_logicalChannelIdentity))
+      if ((*it).m_logicalChannelIdentity == params.m_logicalChannelIdentity)
         {
-          it = m_rlcBufferReq.erase (it);
+          it = ue.m_rlcBuffers.erase (it);
           newLc = false;
         }
       else
@@ -328,14 +399,15 @@ MmWaveFlexTtiMacScheduler::DoSchedDlRlcBufferReq (const struct MmWaveMacSchedSap
         }
     }
   // add the new parameters
-  m_rlcBufferReq.insert (it, params);
+  ue.m_rlcBuffers.push_back (params);
   NS_LOG_INFO ("BSR for RNTI " << params.m_rnti << " LC " << (uint16_t)params.m_logicalChannelIdentity << " RLC tx size " << params.m_rlcTransmissionQueueSize << " RLC retx size " << params.m_rlcRetransmissionQueueSize << " RLC stat size " <<  params.m_rlcStatusPduSize);
   // initialize statistics of the flow in case of new flows
-  if (newLc == true)
+  if (newLc == true && !ue.m_hasDlCqi)
   {
-  	m_wbCqiRxed.insert ( std::pair<uint16_t, uint8_t > (params.m_rnti, 1)); // only codeword 0 at this stage (SISO)
+  	ue.m_hasDlCqi = true;
+  	ue.m_dlCqi = 1; // only codeword 0 at this stage (SISO)
   	// initialized to 1 (i.e., the lowest value for transmitting a signal)
-  	m_wbCqiTimers.insert ( std::pair<uint16_t, uint32_t > (params.m_rnti, m_cqiTimersThreshold));
+  	ue.m_dlCqiTimer = m_cqiTimersThreshold;
   }
 }
 
@@ -344,31 +416,18 @@ MmWaveFlexTtiMacScheduler::DoSchedDlCqiInfoReq (const struct MmWaveMacSchedSapPr
 {
   NS_LOG_FUNCTION (this);
 
-  std::map <uint16_t,uint8_t>::iterator it;
   for (unsigned int i = 0; i < params.m_cqiList.size (); i++)
     {
       if ( params.m_cqiList.at (i).m_cqiType == DlCqiInfo::WB )
         {
           // wideband CQI reporting
-          std::map <uint16_t,uint8_t>::iterator it;
           uint16_t rnti = params.m_cqiList.at (i).m_rnti;
-          it = m_wbCqiRxed.find (rnti);
-          if (it == m_wbCqiRxed.end ())
-            {
-              // create the new entry
-              m_wbCqiRxed.insert ( std::pair<uint16_t, uint8_t > (rnti, params.m_cqiList.at (i).m_wbCqi) ); // only codeword 0 at this stage (SISO)
-              // generate correspondent timer
-              m_wbCqiTimers.insert ( std::pair<uint16_t, uint32_t > (rnti, m_cqiTimersThreshold));
-            }
-          else
-            {
-              // update the CQI value
-              (*it).second = params.m_cqiList.at (i).m_wbCqi;
-              // update correspondent timer
-              std::map <uint16_t,uint32_t>::iterator itTimers;
-              itTimers = m_wbCqiTimers.find (rnti);
-              (*itTimers).second = m_cqiTimersThreshold;
-            }
+          UeState &ue = m_ues[AddUe (rnti)];
+          // create or update the CQI value, only codeword 0 at this stage (SISO)
+          ue.m_hasDlCqi = true;
+          ue.m_dlCqi = params.m_cqiList.at (i).m_wbCqi;
+          // generate or update correspondent timer
+          ue.m_dlCqiTimer = m_cqiTimersThreshold;
         }
       else if ( params.m_cqiList.at (i).m_cqiType == DlCqiInfo::SB )
         {
@@ -397,7 +456,6 @@ MmWaveFlexTtiMacScheduler::DoSchedUlCqiInfoReq (const struct MmWaveMacSchedSapPr
 		case UlCqiInfo::PUSCH:
 		{
 			std::map <uint32_t, struct AllocMapElem>::iterator itMap;
-			std::map <uint16_t, struct UlCqiMapElem>::iterator itCqi;
 			itMap = m_ulAllocationMap.find (params.m_sfnSf.Encode ());
 			if (itMap == m_ulAllocationMap.end ())
 			{
@@ -409,47 +467,23 @@ MmWaveFlexTtiMacScheduler::DoSchedUlCqiInfoReq (const struct MmWaveMacSchedSapPr
 			{
 				// convert from fixed point notation Sxxxxxxxxxxx.xxx to double
 				//double sinr = LteFfConverter::fpS11dot3toDouble (params.m_ulCqi.m_sinr.at (i));
-				itCqi = m_ueUlCqi.find (itMap->second.m_rntiPerChunk.at (i));
-				if (itCqi == m_ueUlCqi.end ())
-				{
-					// create a new entry
-					std::vector <double> newCqi;
-					for (unsigned j = 0; j < m_phyMacConfig->GetTotalNumChunk (); j++)
-					{
-						unsigned chunkInd = i;
-						if (chunkInd == j)
-						{
-							newCqi.push_back (params.m_ulCqi.m_sinr.at (i));
-							NS_LOG_INFO ("UL CQI report for RNTI " << itMap->second.m_rntiPerChunk.at (i) << " chunk " << i << " SINR " << params.m_ulCqi.m_sinr.at (i) << \
-							             " frame " << frameNum << " subframe " << subframeNum << " startSym " << startSymIdx);
-						}
-						else
-						{
-							// initialize with NO_SINR value.
-							newCqi.push_back (30.0);
-						}
-					}
-					m_ueUlCqi.insert (std::pair <uint16_t, struct UlCqiMapElem> (itMap->second.m_rntiPerChunk.at (i),
-					                                                             UlCqiMapElem (newCqi, itMap->second.m_numSym, itMap->second.m_tbSize)) );
-					// generate correspondent timer
-					m_ueCqiTimers.insert (std::pair <uint16_t, uint32_t > (itMap->second.m_rntiPerChunk.at (i), m_cqiTimersThreshold));
-				}
-				else
+				uint16_t rnti = itMap->second.m_rntiPerChunk.at (i);
+				UeState &ue = m_ues[AddUe (rnti)];
+				if (!ue.m_hasUlCqi)
 				{
-					// update the value
-					(*itCqi).second.m_ueUlCqi.at (i) = params.m_ulCqi.m_sinr.at (i);
-					(*itCqi).second.m_numSym = itMap->second.m_numSym;
-					(*itCqi).second.m_tbSize = itMap->second.m_tbSize;
-					// update correspondent timer
-					std::map <uint16_t, uint32_t>::iterator itTimers;
-					itTimers = m_ueCqiTimers.find (itMap->second.m_rntiPerChunk.at (i));
-					(*itTimers).second = m_cqiTimersThreshold;
-
-					NS_LOG_INFO ("UL CQI report for RNTI " << itMap->second.m_rntiPerChunk.at (i) << " chunk " << i << " SINR " << params.m_ulCqi.m_sinr.at (i) << \
-					             " frame " << frameNum << " subframe " << subframeNum << " startSym " << startSymIdx);
-
+					// create a new entry, initialized with NO_SINR value.
+					ue.m_hasUlCqi = true;
+					ue.m_ulCqi.assign (m_phyMacConfig->GetTotalNumChunk (), 30.0);
 				}
-
+				// update the value
+				ue.m_ulCqi.at (i) = params.m_ulCqi.m_sinr.at (i);
+				ue.m_ulCqiNumSym = itMap->second.m_numSym;
+				ue.m_ulCqiTbSize = itMap->second.m_tbSize;
+				// generate or update correspondent timer
+				ue.m_ulCqiTimer = m_cqiTimersThreshold;
+
+				NS_LOG_INFO ("UL CQI report for RNTI " << rnti << " chunk " << i << " SINR " << params.m_ulCqi.m_sinr.at (i) << \
+				             " frame " << frameNum << " subframe " << subframeNum << " startSym " << startSymIdx);
 			}
 			// remove obsolete info on allocation
 			m_ulAllocationMap.erase (itMap);
@@ -467,48 +501,40 @@ MmWaveFlexTtiMacScheduler::RefreshHarqProcesses ()
 {
 	NS_LOG_FUNCTION (this);
 
-	std::map <uint16_t, DlHarqProcessesTimer_t>::iterator itTimers;
-	for (itTimers = m_dlHarqProcessesTimer.begin (); itTimers != m_dlHarqProcessesTimer.end (); itTimers++)
+	for (unsigned j = 0; j < m_uesByRnti.size (); j++)
 	{
-		for (uint16_t i = 0; i < m_phyMacConfig->GetNumHarqProcess (); i++)
+		UeState &ue = m_ues[m_uesByRnti[j]];
+		if (ue.m_hasDlHarq)
 		{
-			if ((*itTimers).second.at (i) == m_phyMacConfig->GetHarqTimeout ())
-			{ // reset HARQ process
-				NS_LOG_INFO (this << " Reset HARQ proc " << i << " for RNTI " << (*itTimers).first);
-				std::map <uint16_t, DlHarqProcessesStatus_t>::iterator itStat = m_dlHarqProcessesStatus.find ((*itTimers).first);
-				if (itStat == m_dlHarqProcessesStatus.end ())
+			for (uint16_t i = 0; i < m_phyMacConfig->GetNumHarqProcess (); i++)
+			{
+				if (ue.m_dlHarqTimers.at (i) == m_phyMacConfig->GetHarqTimeout ())
+				{ // reset HARQ process
+					NS_LOG_INFO (this << " Reset HARQ proc " << i << " for RNTI " << ue.m_rnti);
+					ue.m_dlHarqStatus.at (i) = 0;
+					ue.m_dlHarqTimers.at (i) = 0;
+				}
+				else
 				{
-					NS_FATAL_ERROR ("No Process Id Status found for this RNTI " << (*itTimers).first);
+					ue.m_dlHarqTimers.at (i)++;
 				}
-				(*itStat).second.at (i) = 0;
-				(*itTimers).second.at (i) = 0;
-			}
-			else
-			{
-				(*itTimers).second.at (i)++;
 			}
 		}
-	}
 
-	std::map <uint16_t, UlHarqProcessesTimer_t>::iterator itTimers2;
-	for (itTimers2 = m_ulHarqProcessesTimer.begin (); itTimers2 != m_ulHarqProcessesTimer.end (); itTimers2++)
-	{
-		for (uint16_t i = 0; i < m_phyMacConfig->GetNumHarqProcess (); i++)
+		if (ue.m_hasUlHarq)
 		{
-			if ((*itTimers2).second.at (i) == m_phyMacConfig->GetHarqTimeout ())
-			{ // reset HARQ process
-				NS_LOG_INFO (this << " Reset HARQ proc " << i << " for RNTI " << (*itTimers2).first);
-				std::map <uint16_t, UlHarqProcessesStatus_t>::iterator itStat = m_ulHarqProcessesStatus.find ((*itTimers2).first);
-				if (itStat == m_ulHarqProcessesStatus.end ())
+			for (uint16_t i = 0; i < m_phyMacConfig->GetNumHarqProcess (); i++)
+			{
+				if (ue.m_ulHarqTimers.at (i) == m_phyMacConfig->GetHarqTimeout ())
+				{ // reset HARQ process
+					NS_LOG_INFO (this << " Reset HARQ proc " << i << " for RNTI " << ue.m_rnti);
+					ue.m_ulHarqStatus.at (i) = 0;
+					ue.m_ulHarqTimers.at (i) = 0;
+				}
+				else
 				{
-					NS_FATAL_ERROR ("No Process Id Status found for this RNTI " << (*itTimers2).first);
+					ue.m_ulHarqTimers.at (i)++;
 				}
-				(*itStat).second.at (i) = 0;
-				(*itTimers2).second.at (i) = 0;
-			}
-			else
-			{
-				(*itTimers2).second.at (i)++;
 			}
 		}
 	}
@@ -516,9 +542,9 @@ MmWaveFlexTtiMacScheduler::RefreshHarqProcesses ()
 }
 
 uint8_t
-MmWaveFlexTtiMacScheduler::UpdateDlHarqProcessId (uint16_t rnti)
+MmWaveFlexTtiMacScheduler::UpdateDlHarqProcessId (UeState &ue)
 {
-	NS_LOG_FUNCTION (this << rnti);
+	NS_LOG_FUNCTION (this << ue.m_rnti);
 
 
 	if (m_harqOn == false)
@@ -528,53 +554,29 @@ MmWaveFlexTtiMacScheduler::UpdateDlHarqProcessId (uint16_t rnti)
 		return tbUid;
 	}
 
-//	std::map <uint16_t, uint8_t>::iterator it = m_dlHarqCurrentProcessId.find (rnti);
-//	if (it == m_dlHarqCurrentProcessId.end ())
-//	{
-//		NS_FATAL_ERROR ("No Process Id found for this RNTI " << rnti);
-//	}
-	std::map <uint16_t, DlHarqProcessesStatus_t>::iterator itStat = m_dlHarqProcessesStatus.find (rnti);
-	if (itStat == m_dlHarqProcessesStatus.end ())
+	if (!ue.m_hasDlHarq)
 	{
-		NS_FATAL_ERROR ("No Process Id Statusfound for this RNTI " << rnti);
+		NS_FATAL_ERROR ("No Process Id Statusfound for this RNTI " << ue.m_rnti);
 	}
 
 	// search for available process ID, if none available return numHarqProcess
 	uint8_t harqId = m_phyMacConfig->GetNumHarqProcess ();
 	for (unsigned i = 0; i < m_phyMacConfig->GetNumHarqProcess (); i++)
 	{
-		if(itStat->second[i] == 0)
+		if(ue.m_dlHarqStatus[i] == 0)
 		{
-			itStat->second[i] = 1;
+			ue.m_dlHarqStatus[i] = 1;
 			harqId = i;
 			break;
 		}
 	}
 	return harqId;
-
-//	uint8_t i = (*it).second;
-//	do
-//	{
-//		i = (i + 1) % m_phyMacConfig->GetNumHarqProcess ();
-//	}
-//	while ( ((*itStat).second.at (i) != 0)&&(i != (*it).second));
-//	if ((*itStat).second.at (i) == 0)
-//	{
-//		(*it).second = i;
-//		(*itStat).second.at (i) = 1;
-//	}
-//	else
-//	{
-//		return (m_phyMacConfig->GetNumHarqProcess () + 1); // return a not valid harq proc id
-//	}
-//
-//	return ((*it).second);
 }
 
 uint8_t
-MmWaveFlexTtiMacScheduler::UpdateUlHarqProcessId (uint16_t rnti)
+MmWaveFlexTtiMacScheduler::UpdateUlHarqProcessId (UeState &ue)
 {
-	NS_LOG_FUNCTION (this << rnti);
+	NS_LOG_FUNCTION (this << ue.m_rnti);
 
 	if (m_harqOn == false)
 	{
@@ -583,24 +585,18 @@ MmWaveFlexTtiMacScheduler::UpdateUlHarqProcessId (uint16_t rnti)
 		return tbUid;
 	}
 
-//	std::map <uint16_t, uint8_t>::iterator it = m_ulHarqCurrentProcessId.find (rnti);
-//	if (it == m_ulHarqCurrentProcessId.end ())
-//	{
-//		NS_FATAL_ERROR ("No Process Id found for this RNTI " << rnti);
-//	}
-	std::map <uint16_t, UlHarqProcessesStatus_t>::iterator itStat = m_ulHarqProcessesStatus.find (rnti);
-	if (itStat == m_ulHarqProcessesStatus.end ())
+	if (!ue.m_hasUlHarq)
 	{
-		NS_FATAL_ERROR ("No Process Id Statusfound for this RNTI " << rnti);
+		NS_FATAL_ERROR ("No Process Id Statusfound for this RNTI " << ue.m_rnti);
 	}
 
 	// search for available process ID, if none available return numHarqProcess+1
 	uint8_t harqId = m_phyMacConfig->GetNumHarqProcess ();
 	for (unsigned i = 0; i < m_phyMacConfig->GetNumHarqProcess (); i++)
 	{
-		if(itStat->second[i] == 0)
+		if(ue.m_ulHarqStatus[i] == 0)
 		{
-			itStat->second[i] = 1;
+			ue.m_ulHarqStatus[i] = 1;
 			harqId = i;
 			break;
 		}
@@ -688,13 +684,16 @@ MmWaveFlexTtiMacScheduler::DoSchedTriggerReq (const struct MmWaveMacSchedSapProv
 	// Process DL HARQ feedback
 	RefreshHarqProcesses ();
 
-	//m_rlcBufferReq.sort (SortRlcBufferReq); 	// sort list by RNTI
 	// number of DL/UL flows for new transmissions (not HARQ RETX)
 	int nFlowsDl = 0;
 	int nFlowsUl = 0;
-	std::map <uint16_t, struct UeSchedInfo> ueInfo;
-	std::map <uint16_t, struct UeSchedInfo>::iterator itUeInfo;
-	std::list<MmWaveMacSchedSapProvider::SchedDlRlcBufferReqParameters>::iterator itRlcBuf;
+	// reset the UEs scheduled in the previous slot
+	for (unsigned j = 0; j < m_activeUes.size (); j++)
+	{
+		m_ues[m_activeUes[j]].m_active = false;
+		m_ues[m_activeUes[j]].m_sched.Reset ();
+	}
+	m_activeUes.clear ();
 
 	// retrieve past HARQ retx buffered
 	if (m_dlHarqInfoList.size () > 0 && params.m_dlHarqInfoList.size () > 0)
@@ -721,8 +720,8 @@ MmWaveFlexTtiMacScheduler::DoSchedTriggerReq (const struct MmWaveMacSchedSapProv
 	else
 	{
 		// Process DL HARQ feedback and assign slots for RETX if resources available
-		std::vector <struct DlHarqInfo> dlInfoListUntxed;  // TBs not able to be retransmitted in this sf
-		std::vector <struct UlHarqInfo> ulInfoListUntxed;
+		m_dlHarqInfoUntxed.clear ();  // TBs not able to be retransmitted in this sf
+		m_ulHarqInfoUntxed.clear ();
 
 		for (unsigned i = 0; i < m_dlHarqInfoList.size (); i++)
 		{
@@ -732,47 +731,31 @@ MmWaveFlexTtiMacScheduler::DoSchedTriggerReq (const struct MmWaveMacSchedSapProv
 			}
 			uint8_t harqId = m_dlHarqInfoList.at (i).m_harqProcessId;
 			uint16_t rnti = m_dlHarqInfoList.at (i).m_rnti;
-			itUeInfo = ueInfo.find (rnti);
-			std::map <uint16_t, UlHarqProcessesStatus_t>::iterator itStat = m_dlHarqProcessesStatus.find (rnti);
-			if (itStat == m_dlHarqProcessesStatus.end ())
+			uint32_t index = FindUe (rnti);
+			if (index == m_noUe || !m_ues[index].m_hasDlHarq)
 			{
 				NS_FATAL_ERROR ("No HARQ status info found for UE " << rnti);
 			}
-			std::map <uint16_t, DlHarqRlcPduList_t>::iterator itRlcPdu =  m_dlHarqProcessesRlcPduMap.find (rnti);
-			if (itRlcPdu == m_dlHarqProcessesRlcPduMap.end ())
-			{
-				NS_FATAL_ERROR ("Unable to find RlcPdcList in HARQ buffer for RNTI " << m_dlHarqInfoList.at (i).m_rnti);
-			}
-			if(m_dlHarqInfoList.at (i).m_harqStatus == DlHarqInfo::ACK || itStat->second.at (harqId) == 0)
+			UeState &ue = m_ues[index];
+			if(m_dlHarqInfoList.at (i).m_harqStatus == DlHarqInfo::ACK || ue.m_dlHarqStatus.at (harqId) == 0)
 			{ // acknowledgment or process timeout, reset process
 				//NS_LOG_DEBUG ("UE" << rnti << " DL harqId " << (unsigned)harqId << " HARQ-ACK received");
-				itStat->second.at (harqId) = 0;    // release process ID
-				for (uint16_t k = 0; k < itRlcPdu->second.size (); k++)		// clear RLC buffers
-				{
-					itRlcPdu->second.at (harqId).clear ();
-				}
+				ue.m_dlHarqStatus.at (harqId) = 0;    // release process ID
+				ue.m_dlHarqRlcPdus.at (harqId).clear ();		// clear RLC buffers
 				continue;
 			}
 			else if(m_dlHarqInfoList.at (i).m_harqStatus == DlHarqInfo::NACK)
 			{
-				std::map <uint16_t, DlHarqProcessesDciInfoList_t>::iterator itHarq = m_dlHarqProcessesDciInfoMap.find (rnti);
-				if (itHarq == m_dlHarqProcessesDciInfoMap.end ())
-				{
-					NS_FATAL_ERROR ("No DCI/HARQ buffer entry found for UE " << rnti);
-				}
-				DciInfoElementTdma dciInfoReTx = itHarq->second.at (harqId);
+				DciInfoElementTdma dciInfoReTx = ue.m_dlHarqDci.at (harqId);
 				//NS_LOG_DEBUG ("UE" << rnti << " DL harqId " << (unsigned)harqId << " HARQ-NACK received, rv " << (unsigned)dciInfoReTx.m_rv);
 				NS_ASSERT (harqId == dciInfoReTx.m_harqProcess);
-				//NS_ASSERT(itStat->second.at (harqId) > 0);
-				NS_ASSERT(itStat->second.at (harqId)-1 == dciInfoReTx.m_rv);
+				//NS_ASSERT(ue.m_dlHarqStatus.at (harqId) > 0);
+				NS_ASSERT(ue.m_dlHarqStatus.at (harqId)-1 == dciInfoReTx.m_rv);
 				if (dciInfoReTx.m_rv == 3) // maximum number of retx reached -> drop process
 				{
 					NS_LOG_INFO ("Max number of retransmissions reached -> drop process");
-					itStat->second.at (harqId) = 0;
-					for (uint16_t k = 0; k < (*itRlcPdu).second.size (); k++)
-					{
-						itRlcPdu->second.at (harqId).clear ();
-					}
+					ue.m_dlHarqStatus.at (harqId) = 0;
+					ue.m_dlHarqRlcPdus.at (harqId).clear ();
 					continue;
 				}
 
@@ -783,20 +766,16 @@ MmWaveFlexTtiMacScheduler::DoSchedTriggerReq (const struct MmWaveMacSchedSapProv
 				// 			If exceeds remaining symbols available in this subframe (but not total symbols in SF),
 				//			update DCI info and try scheduling in next SF.
 
-				/*std::map <uint16_t,uint8_t>::iterator itCqi = m_wbCqiRxed.find (itRlcBuf->m_rnti);
-				int cqi;
+				/*int cqi;
 				int mcsNew;
-				if (itCqi != m_wbCqiRxed.end ())
+				if (ue.m_hasDlCqi)
 				{
-					cqi = itCqi->second;
+					cqi = ue.m_dlCqi;
 					if (cqi == 0)
 					{
 						NS_LOG_INFO ("CQI for reTX is below threshhold. Drop process");
-						itStat->second.at (harqId) = 0;
-						for (uint16_t k = 0; k < (*itRlcPdu).second.size (); k++)
-						{
-							itRlcPdu->second.at (harqId).clear ();
-						}
+						ue.m_dlHarqStatus.at (harqId) = 0;
+						ue.m_dlHarqRlcPdus.at (harqId).clear ();
 						continue;
 					}
 					else
@@ -830,7 +809,7 @@ MmWaveFlexTtiMacScheduler::DoSchedTriggerReq (const struct MmWaveMacSchedSapProv
 				}
 				if (numSymReq <= (m_phyMacConfig->GetSymbolsPerSubframe () - resvCtrl))
 				{	// not enough symbols to encode TB at required MCS, attempt in later SF
-					dlInfoListUntxed.push_back (m_dlHarqInfoList.at (i));
+					m_dlHarqInfoUntxed.push_back (m_dlHarqInfoList.at (i));
 					continue;
 				}*/
 
@@ -843,40 +822,28 @@ MmWaveFlexTtiMacScheduler::DoSchedTriggerReq (const struct MmWaveMacSchedSapProv
 					NS_ASSERT (symIdx <= m_phyMacConfig->GetSymbolsPerSubframe () - m_phyMacConfig->GetUlCtrlSymbols ());
 					dciInfoReTx.m_rv++;
 					dciInfoReTx.m_ndi = 0;
-					itHarq->second.at (harqId) = dciInfoReTx;
-					itStat->second.at (harqId) = itStat->second.at (harqId) + 1;
-					SlotAllocInfo slotInfo (slotIdx++, SlotAllocInfo::DL, SlotAllocInfo::CTRL_DATA, SlotAllocInfo::DIGITAL, itUeInfo->first);
+					ue.m_dlHarqDci.at (harqId) = dciInfoReTx;
+					ue.m_dlHarqStatus.at (harqId) = ue.m_dlHarqStatus.at (harqId) + 1;
+					SlotAllocInfo slotInfo (slotIdx++, SlotAllocInfo::DL, SlotAllocInfo::CTRL_DATA, SlotAllocInfo::DIGITAL, rnti);
 					slotInfo.m_dci = dciInfoReTx;
 					NS_LOG_DEBUG ("UE" << dciInfoReTx.m_rnti << " gets DL slots " << (unsigned)dciInfoReTx.m_symStart << "-" << (unsigned)(dciInfoReTx.m_symStart+dciInfoReTx.m_numSym-1) <<
 							             " tbs " << dciInfoReTx.m_tbSize << " harqId " << (unsigned)dciInfoReTx.m_harqProcess << " harqId " << (unsigned)dciInfoReTx.m_harqProcess <<
 							             " rv " << (unsigned)dciInfoReTx.m_rv << " in frame " << ret.m_sfnSf.m_frameNum << " subframe " << (unsigned)ret.m_sfnSf.m_sfNum << " RETX");
-					std::map <uint16_t, DlHarqRlcPduList_t>::iterator itRlcList =  m_dlHarqProcessesRlcPduMap.find (rnti);
-					if (itRlcList == m_dlHarqProcessesRlcPduMap.end ())
-					{
-						NS_FATAL_ERROR ("Unable to find RlcPdcList in HARQ buffer for RNTI " << rnti);
-					}
-					for (uint16_t k = 0; k < (*itRlcList).second.at(dciInfoReTx.m_harqProcess).size (); k++)
-					{
-						slotInfo.m_rlcPduInfo.push_back ((*itRlcList).second.at (dciInfoReTx.m_harqProcess).at (k));
-					}
+					slotInfo.m_rlcPduInfo = ue.m_dlHarqRlcPdus.at (dciInfoReTx.m_harqProcess);
 					ret.m_sfAllocInfo.m_slotAllocInfo.push_back (slotInfo);
 					ret.m_sfAllocInfo.m_numSymAlloc += dciInfoReTx.m_numSym;
-					if (itUeInfo == ueInfo.end())
-					{
-						itUeInfo = ueInfo.insert (std::pair<uint16_t, struct UeSchedInfo> (rnti, UeSchedInfo () )).first;
-					}
-					itUeInfo->second.m_dlSymbolsRetx = dciInfoReTx.m_numSym;
+					ActivateUe (index);
+					ue.m_sched.m_dlSymbolsRetx = dciInfoReTx.m_numSym;
 				}
 				else
 				{
 					NS_LOG_INFO ("No resource for this retx -> buffer it");
-					dlInfoListUntxed.push_back (m_dlHarqInfoList.at (i));
+					m_dlHarqInfoUntxed.push_back (m_dlHarqInfoList.at (i));
 				}
 			}
 		}
 
-		m_dlHarqInfoList.clear ();
-		m_dlHarqInfoList = dlInfoListUntxed;
+		m_dlHarqInfoList.swap (m_dlHarqInfoUntxed);
 
 		// Process UL HARQ feedback
 		for (uint16_t i = 0; i < m_ulHarqInfoList.size (); i++)
@@ -885,40 +852,33 @@ MmWaveFlexTtiMacScheduler::DoSchedTriggerReq (const struct MmWaveMacSchedSapProv
 			{
 				break;	// no symbols left to allocate
 			}
-			UlHarqInfo harqInfo = m_ulHarqInfoList.at (i);
+			const UlHarqInfo &harqInfo = m_ulHarqInfoList.at (i);
 			uint8_t harqId = harqInfo.m_harqProcessId;
 			uint16_t rnti = harqInfo.m_rnti;
-			itUeInfo = ueInfo.find (rnti);
-			std::map <uint16_t, UlHarqProcessesStatus_t>::iterator itStat = m_ulHarqProcessesStatus.find (rnti);
-			if (itStat == m_ulHarqProcessesStatus.end ())
+			uint32_t index = FindUe (rnti);
+			if (index == m_noUe || !m_ues[index].m_hasUlHarq)
 			{
 				NS_LOG_ERROR ("No info found in HARQ buffer for UE (might have changed eNB) " << rnti);
+				continue;
 			}
-			if (harqInfo.m_receptionStatus == UlHarqInfo::Ok || itStat->second.at (harqId) == 0)
+			UeState &ue = m_ues[index];
+			if (harqInfo.m_receptionStatus == UlHarqInfo::Ok || ue.m_ulHarqStatus.at (harqId) == 0)
 			{
 				//NS_LOG_DEBUG ("UE" << rnti << " UL harqId " << (unsigned)harqInfo.m_harqProcessId << " HARQ-ACK received");
-				if (itStat != m_ulHarqProcessesStatus.end ())
-				{
-					itStat->second.at (harqId) = 0;  // release process ID
-				}
+				ue.m_ulHarqStatus.at (harqId) = 0;  // release process ID
 			}
 			else if (harqInfo.m_receptionStatus == UlHarqInfo::NotOk)
 			{
-				std::map <uint16_t, UlHarqProcessesDciInfoList_t>::iterator itHarq = m_ulHarqProcessesDciInfoMap.find (rnti);
-				if (itHarq == m_ulHarqProcessesDciInfoMap.end ())
-				{
-					NS_LOG_ERROR ("No info found in UL-HARQ buffer for UE (might have changed eNB) " << rnti);
-				}
 				// retx correspondent block: retrieve the UL-DCI
-				DciInfoElementTdma dciInfoReTx = itHarq->second.at (harqId);
+				DciInfoElementTdma dciInfoReTx = ue.m_ulHarqDci.at (harqId);
 				//NS_LOG_DEBUG ("UE" << rnti << " UL harqId " << (unsigned)harqInfo.m_harqProcessId << " HARQ-NACK received, rv " << (unsigned)dciInfoReTx.m_rv);
 				NS_ASSERT (harqId == dciInfoReTx.m_harqProcess);
-				NS_ASSERT(itStat->second.at (harqId) > 0);
-				NS_ASSERT(itStat->second.at (harqId)-1 == dciInfoReTx.m_rv);
+				NS_ASSERT(ue.m_ulHarqStatus.at (harqId) > 0);
+				NS_ASSERT(ue.m_ulHarqStatus.at (harqId)-1 == dciInfoReTx.m_rv);
 				if (dciInfoReTx.m_rv == 3)
 				{
 					NS_LOG_INFO ("Max number of retransmissions reached (UL)-> drop process");
-					itStat->second.at (harqId) = 0;
+					ue.m_ulHarqStatus.at (harqId) = 0;
 					continue;
 				}
 
@@ -930,8 +890,8 @@ MmWaveFlexTtiMacScheduler::DoSchedTriggerReq (const struct MmWaveMacSchedSapProv
 					NS_ASSERT (symIdx <= m_phyMacConfig->GetSymbolsPerSubframe () - m_phyMacConfig->GetUlCtrlSymbols ());
 					dciInfoReTx.m_rv++;
 					dciInfoReTx.m_ndi = 0;
-					itStat->second.at (harqId) = itStat->second.at (harqId) + 1;
-					itHarq->second.at (harqId) = dciInfoReTx;
+					ue.m_ulHarqStatus.at (harqId) = ue.m_ulHarqStatus.at (harqId) + 1;
+					ue.m_ulHarqDci.at (harqId) = dciInfoReTx;
 					SlotAllocInfo slotInfo (slotIdx++, SlotAllocInfo::UL, SlotAllocInfo::CTRL_DATA, SlotAllocInfo::DIGITAL, rnti);
 					slotInfo.m_dci = dciInfoReTx;
 					NS_LOG_DEBUG ("UE" << dciInfoReTx.m_rnti << " gets UL slots " << (unsigned)dciInfoReTx.m_symStart << "-" << (unsigned)(dciInfoReTx.m_symStart+dciInfoReTx.m_numSym-1) <<
@@ -939,21 +899,17 @@ MmWaveFlexTtiMacScheduler::DoSchedTriggerReq (const struct MmWaveMacSchedSapProv
 											 " RETX");
 					ret.m_sfAllocInfo.m_slotAllocInfo.push_back (slotInfo);
 					ret.m_sfAllocInfo.m_numSymAlloc += dciInfoReTx.m_numSym;
-					if (itUeInfo == ueInfo.end())
-					{
-						itUeInfo = ueInfo.insert (std::pair<uint16_t, struct UeSchedInfo> (rnti, UeSchedInfo () )).first;
-					}
-					itUeInfo->second.m_ulSymbolsRetx = dciInfoReTx.m_numSym;
+					ActivateUe (index);
+					ue.m_sched.m_ulSymbolsRetx = dciInfoReTx.m_numSym;
 				}
 				else
 				{
-					ulInfoListUntxed.push_back (m_ulHarqInfoList.at (i));
+					m_ulHarqInfoUntxed.push_back (m_ulHarqInfoList.at (i));
 				}
 			}
 		}
 
-		m_ulHarqInfoList.clear ();
-		m_ulHarqInfoList = ulInfoListUntxed;
+		m_ulHarqInfoList.swap (m_ulHarqInfoUntxed);
 	}
 
 	// ********************* END OF HARQ SECTION, START OF NEW DATA SCHEDULING ********************* //
@@ -961,86 +917,86 @@ MmWaveFlexTtiMacScheduler::DoSchedTriggerReq (const struct MmWaveMacSchedSapProv
 	// get info on active DL flows
 	if (symAvail > 0 && !m_ulOnly)  // remaining symbols in current subframe after HARQ retx sched
 	{
-		for (itRlcBuf = m_rlcBufferReq.begin (); itRlcBuf != m_rlcBufferReq.end (); itRlcBuf++)
+		for (unsigned j = 0; j < m_uesByRnti.size (); j++)
 		{
-			itUeInfo = ueInfo.find (itRlcBuf->m_rnti);
-			//		if (itUeInfo != ueInfo.end () && itUeInfo->second.m_dlSymbols > 0)
-			//		{
-			//			continue;
-			//		}
-
-			if ( (((*itRlcBuf).m_rlcTransmissionQueueSize > 0)
-					|| ((*itRlcBuf).m_rlcRetransmissionQueueSize > 0)
-					|| ((*itRlcBuf).m_rlcStatusPduSize > 0)) )
+			uint32_t index = m_uesByRnti[j];
+			UeState &ue = m_ues[index];
+			for (unsigned l = 0; l < ue.m_rlcBuffers.size (); l++)
 			{
-				NS_LOG_INFO (this << " User " << itRlcBuf->m_rnti << " LC " << (uint16_t)itRlcBuf->m_logicalChannelIdentity << " is active, status  " << (*itRlcBuf).m_rlcStatusPduSize << " retx " << (*itRlcBuf).m_rlcRetransmissionQueueSize << " tx " << (*itRlcBuf).m_rlcTransmissionQueueSize);
-				std::map <uint16_t,uint8_t>::iterator itCqi = m_wbCqiRxed.find (itRlcBuf->m_rnti);
-				uint8_t cqi = 0;
-				if (itCqi != m_wbCqiRxed.end ())
+				const MmWaveMacSchedSapProvider::SchedDlRlcBufferReqParameters &rlcBuf = ue.m_rlcBuffers[l];
+				if ( ((rlcBuf.m_rlcTransmissionQueueSize > 0)
+						|| (rlcBuf.m_rlcRetransmissionQueueSize > 0)
+						|| (rlcBuf.m_rlcStatusPduSize > 0)) )
 				{
-					cqi = itCqi->second;
-				}
-				else // no CQI available
-				{
-					NS_LOG_INFO (this << " UE " << itRlcBuf->m_rnti << " does not have DL-CQI");
-					cqi = 1; // lowest value for trying a transmission
-				}
-				if (cqi != 0 || m_fixedMcsDl) 	// CQI == 0 means "out of range" (see table 7.2.3-1 of 36.213)
-				{
-					if (itUeInfo == ueInfo.end ())
+					NS_LOG_INFO (this << " User " << rlcBuf.m_rnti << " LC " << (uint16_t)rlcBuf.m_logicalChannelIdentity << " is active, status  " << rlcBuf.m_rlcStatusPduSize << " retx " << rlcBuf.m_rlcRetransmissionQueueSize << " tx " << rlcBuf.m_rlcTransmissionQueueSize);
+					uint8_t cqi = 0;
+					if (ue.m_hasDlCqi)
 					{
-						nFlowsDl++;  // for simplicity, all RLC LCs are considered as a single flow
-						itUeInfo = ueInfo.insert (std::pair<uint16_t, struct UeSchedInfo> (itRlcBuf->m_rnti, UeSchedInfo () )).first;
+						cqi = ue.m_dlCqi;
 					}
-					else if (itUeInfo->second.m_maxDlBufSize == 0)
+					else // no CQI available
 					{
-						nFlowsDl++;
+						NS_LOG_INFO (this << " UE " << rlcBuf.m_rnti << " does not have DL-CQI");
+						cqi = 1; // lowest value for trying a transmission
 					}
-
-					if (m_fixedMcsDl)
-					{
-						itUeInfo->second.m_dlMcs = m_mcsDefaultDl;
-					}
-					else
+					if (cqi != 0 || m_fixedMcsDl) 	// CQI == 0 means "out of range" (see table 7.2.3-1 of 36.213)
 					{
-						itUeInfo->second.m_dlMcs = m_amc->GetMcsFromCqi (cqi);  // get MCS
-					}
+						UeSchedInfo &ueSchedInfo = ue.m_sched;
+						if (!ue.m_active)
+						{
+							nFlowsDl++;  // for simplicity, all RLC LCs are considered as a single flow
+							ActivateUe (index);
+						}
+						else if (ueSchedInfo.m_maxDlBufSize == 0)
+						{
+							nFlowsDl++;
+						}
 
-					// temporarily store the TX queue size
-					if(itRlcBuf->m_rlcStatusPduSize > 0)
-					{
-						RlcPduInfo newRlcStatusPdu;
-						newRlcStatusPdu.m_lcid = itRlcBuf->m_logicalChannelIdentity;
-						newRlcStatusPdu.m_size += itRlcBuf->m_rlcStatusPduSize + m_subHdrSize;
-						itUeInfo->second.m_rlcPduInfo.push_back (newRlcStatusPdu);
-						itUeInfo->second.m_maxDlBufSize += newRlcStatusPdu.m_size;  // add to total DL buffer size
-					}
+						if (m_fixedMcsDl)
+						{
+							ueSchedInfo.m_dlMcs = m_mcsDefaultDl;
+						}
+						else
+						{
+							ueSchedInfo.m_dlMcs = m_amc->GetMcsFromCqi (cqi);  // get MCS
+						}
 
-					RlcPduInfo newRlcEl;
-					newRlcEl.m_lcid = itRlcBuf->m_logicalChannelIdentity;
-					if (itRlcBuf->m_rlcRetransmissionQueueSize > 0)
-					{
-						newRlcEl.m_size = itRlcBuf->m_rlcRetransmissionQueueSize;
-					}
-					else if (itRlcBuf->m_rlcTransmissionQueueSize > 0)
-					{
-						newRlcEl.m_size = itRlcBuf->m_rlcTransmissionQueueSize;
-					}
+						// temporarily store the TX queue size
+						if(rlcBuf.m_rlcStatusPduSize > 0)
+						{
+							RlcPduInfo newRlcStatusPdu;
+							newRlcStatusPdu.m_lcid = rlcBuf.m_logicalChannelIdentity;
+							newRlcStatusPdu.m_size += rlcBuf.m_rlcStatusPduSize + m_subHdrSize;
+							ueSchedInfo.m_rlcPduInfo.push_back (newRlcStatusPdu);
+							ueSchedInfo.m_maxDlBufSize += newRlcStatusPdu.m_size;  // add to total DL buffer size
+						}
 
-					if (newRlcEl.m_size > 0)
-					{
-						if (newRlcEl.m_size < 8)
+						RlcPduInfo newRlcEl;
+						newRlcEl.m_lcid = rlcBuf.m_logicalChannelIdentity;
+						if (rlcBuf.m_rlcRetransmissionQueueSize > 0)
+						{
+							newRlcEl.m_size = rlcBuf.m_rlcRetransmissionQueueSize;
+						}
+						else if (rlcBuf.m_rlcTransmissionQueueSize > 0)
 						{
-							newRlcEl.m_size = 8;
+							newRlcEl.m_size = rlcBuf.m_rlcTransmissionQueueSize;
+						}
+
+						if (newRlcEl.m_size > 0)
+						{
+							if (newRlcEl.m_size < 8)
+							{
+								newRlcEl.m_size = 8;
+							}
+							newRlcEl.m_size += m_rlcHdrSize + m_subHdrSize + 10;
+							ueSchedInfo.m_rlcPduInfo.push_back (newRlcEl);
+							ueSchedInfo.m_maxDlBufSize += newRlcEl.m_size;  // add to total DL buffer size
 						}
-						newRlcEl.m_size += m_rlcHdrSize + m_subHdrSize + 10;
-						itUeInfo->second.m_rlcPduInfo.push_back (newRlcEl);
-						itUeInfo->second.m_maxDlBufSize += newRlcEl.m_size;  // add to total DL buffer size
 					}
-				}
-				else
-				{ // SINR out of range, don't schedule for DL
-					NS_LOG_INFO ("*** RNTI " << itRlcBuf->m_rnti << " DL-CQI out of range, skipping allocation");
+					else
+					{ // SINR out of range, don't schedule for DL
+						NS_LOG_INFO ("*** RNTI " << rlcBuf.m_rnti << " DL-CQI out of range, skipping allocation");
+					}
 				}
 			}
 		}
@@ -1049,91 +1005,67 @@ MmWaveFlexTtiMacScheduler::DoSchedTriggerReq (const struct MmWaveMacSchedSapProv
 	// get info on active UL flows
 	if (symAvail > 0 && !m_dlOnly)  // remaining symbols in future UL subframe after HARQ retx sched
 	{
-		std::map <uint16_t,uint32_t>::iterator ceBsrIt;
-		for (ceBsrIt = m_ceBsrRxed.begin (); ceBsrIt != m_ceBsrRxed.end (); ceBsrIt++)
+		for (unsigned j = 0; j < m_uesByRnti.size (); j++)
 		{
-			if (ceBsrIt->second > 0)  // UL buffer size > 0
+			uint32_t index = m_uesByRnti[j];
+			UeState &ue = m_ues[index];
+			if (ue.m_hasBsr && ue.m_bsr > 0)  // UL buffer size > 0
 			{
-				std::map <uint16_t, struct UlCqiMapElem>::iterator itCqi = m_ueUlCqi.find (ceBsrIt->first);
 				int cqi = 0;
 				int mcs = 0;
-				if (itCqi == m_ueUlCqi.end ()) // no cqi info for this UE
+				if (!ue.m_hasUlCqi) // no cqi info for this UE
 				{
-					NS_LOG_INFO (this << " UE " << ceBsrIt->first << " does not have UL-CQI");
+					NS_LOG_INFO (this << " UE " << ue.m_rnti << " does not have UL-CQI");
 					cqi = 1;
 					mcs = 0;
 				}
 				else
 				{
 					cqi = 0;
-					SpectrumValue specVals (MmWaveSpectrumValueHelper::GetSpectrumModel (m_phyMacConfig));
-					Values::iterator specIt = specVals.ValuesBegin();
+					if (m_ulCqiSinr == 0)
+					{
+						m_ulCqiSinr = Create<SpectrumValue> (MmWaveSpectrumValueHelper::GetSpectrumModel (m_phyMacConfig));
+					}
+					Values::iterator specIt = m_ulCqiSinr->ValuesBegin();
 					for (unsigned ichunk = 0; ichunk < m_phyMacConfig->GetTotalNumChunk (); ichunk++)
 					{
-						//double sinrLin = std::pow (10, itCqi->second.m_ueUlCqi.at (ichunk) / 10);
-//						double se1 = log2 ( 1 + (std::pow (10, sinrLin / 10 )  /
-//								( (-std::log (5.0 * m_berDl )) / 1.5) ));
-//						cqi += m_amc->GetCqiFromSpectralEfficiency (se1);
-						NS_ASSERT (specIt != specVals.ValuesEnd());
-						*specIt = itCqi->second.m_ueUlCqi.at (ichunk); //sinrLin;
+						NS_ASSERT (specIt != m_ulCqiSinr->ValuesEnd());
+						*specIt = ue.m_ulCqi.at (ichunk); //sinrLin;
 						specIt++;
 					}
 
-					cqi = m_amc->CreateCqiFeedbackWbTdma (specVals, itCqi->second.m_numSym, itCqi->second.m_tbSize, mcs);
-//					for (unsigned i = 0; i < chunkCqi.size(); i++)
-//					{
-//						cqi += chunkCqi[i];
-//					}
-//					cqi = cqi / m_phyMacConfig->GetTotalNumChunk ();
-
-					// take the lowest CQI value (worst chunk)
-					//				double minSinr = itCqi->second.at (0);
-					//				double sinrLinAvg = std::pow (10, itCqi->second.at (0) / 10);
-					//				for (unsigned ichunk = 1; ichunk < m_phyMacConfig->GetTotalNumChunk (); ichunk++)
-					//				{
-					//					if (itCqi->second.at (ichunk) < minSinr)
-					//					{
-					//						minSinr = itCqi->second.at (ichunk);
-					//					}
-					//					sinrLinAvg += std::pow (10, itCqi->second.at (ichunk) / 10);
-					//				}
-					//				// TODO: verify SE calculation
-					//				sinrLinAvg /= m_phyMacConfig->GetTotalNumChunk ();
-					////				double se = log2 ( 1 + sinrLinAvg );
-					//				double se = log2 ( 1 + (std::pow (10, minSinr / 10 )  /
-					//						( (-std::log (5.0 * 0.00005 )) / 1.5) ));
-					//				cqi = m_amc->GetCqiFromSpectralEfficiency (se);
+					cqi = m_amc->CreateCqiFeedbackWbTdma (*m_ulCqiSinr, ue.m_ulCqiNumSym, ue.m_ulCqiTbSize, mcs);
 					if (cqi == 0 && !m_fixedMcsUl) // out of range (SINR too low)
 					{
-						NS_LOG_INFO ("*** RNTI " << ceBsrIt->first << " UL-CQI out of range, skipping allocation in UL");
+						NS_LOG_INFO ("*** RNTI " << ue.m_rnti << " UL-CQI out of range, skipping allocation in UL");
 						break;  // do not allocate UE in uplink
 					}
 				}
-				itUeInfo = ueInfo.find (ceBsrIt->first);
-				if (itUeInfo == ueInfo.end ())
+				UeSchedInfo &ueSchedInfo = ue.m_sched;
+				if (!ue.m_active)
 				{
-					itUeInfo = ueInfo.insert (std::pair<uint16_t, struct UeSchedInfo> (ceBsrIt->first, UeSchedInfo () )).first;
+					ActivateUe (index);
 					nFlowsUl++;
 				}
-				else if (itUeInfo->second.m_maxUlBufSize == 0)
+				else if (ueSchedInfo.m_maxUlBufSize == 0)
 				{
 					nFlowsUl++;
 				}
 				if (m_fixedMcsUl)
 				{
-					itUeInfo->second.m_ulMcs = m_mcsDefaultUl;
+					ueSchedInfo.m_ulMcs = m_mcsDefaultUl;
 				}
 				else
 				{
-					itUeInfo->second.m_ulMcs = mcs;//m_amc->GetMcsFromCqi (cqi);  // get MCS
+					ueSchedInfo.m_ulMcs = mcs;//m_amc->GetMcsFromCqi (cqi);  // get MCS
 				}
-				itUeInfo->second.m_maxUlBufSize = ceBsrIt->second + m_rlcHdrSize + m_macHdrSize + 8;
+				ueSchedInfo.m_maxUlBufSize = ue.m_bsr + m_rlcHdrSize + m_macHdrSize + 8;
 			}
 		}
 	}
 
 	int nFlowsTot = nFlowsDl + nFlowsUl;
-	if (ueInfo.size () == 0)
+	if (m_activeUes.empty ())
 	{
 		// add slot for UL control
 		SlotAllocInfo ulCtrlSlot (0xFF, SlotAllocInfo::UL, SlotAllocInfo::CTRL, SlotAllocInfo::DIGITAL, 0);
@@ -1144,50 +1076,62 @@ MmWaveFlexTtiMacScheduler::DoSchedTriggerReq (const struct MmWaveMacSchedSapProv
 		return;
 	}
 
+	// sort the active UEs by RNTI, the order in which the symbols are shared
+	m_activeUes.clear ();
+	for (unsigned j = 0; j < m_uesByRnti.size (); j++)
+	{
+		if (m_ues[m_uesByRnti[j]].m_active)
+		{
+			m_activeUes.push_back (m_uesByRnti[j]);
+		}
+	}
+	unsigned nActiveUes = m_activeUes.size ();
+
 	// compute requested num slots and TB size based on MCS and DL buffer size
 	// final allocated slots may be less
 	int totDlSymReq = 0;
 	int totUlSymReq = 0;
-	for (itUeInfo = ueInfo.begin (); itUeInfo != ueInfo.end (); itUeInfo++)
+	for (unsigned j = 0; j < nActiveUes; j++)
 	{
+		UeSchedInfo &ueSchedInfo = m_ues[m_activeUes[j]].m_sched;
 		unsigned dlTbSize = 0;
 		unsigned ulTbSize = 0;
-		if (itUeInfo->second.m_maxDlBufSize > 0)
+		if (ueSchedInfo.m_maxDlBufSize > 0)
 		{
-			itUeInfo->second.m_maxDlSymbols = CalcMinTbSizeNumSym (itUeInfo->second.m_dlMcs, itUeInfo->second.m_maxDlBufSize, dlTbSize);
-			itUeInfo->second.m_maxDlBufSize = dlTbSize;
+			ueSchedInfo.m_maxDlSymbols = CalcMinTbSizeNumSym (ueSchedInfo.m_dlMcs, ueSchedInfo.m_maxDlBufSize, dlTbSize);
+			ueSchedInfo.m_maxDlBufSize = dlTbSize;
 			if (m_fixedTti)
 			{
-				itUeInfo->second.m_maxDlSymbols = ceil((double)itUeInfo->second.m_maxDlSymbols/(double)m_symPerSlot) * m_symPerSlot; // round up to nearest sym per TTI
+				ueSchedInfo.m_maxDlSymbols = ceil((double)ueSchedInfo.m_maxDlSymbols/(double)m_symPerSlot) * m_symPerSlot; // round up to nearest sym per TTI
 			}
-			totDlSymReq += itUeInfo->second.m_maxDlSymbols;
+			totDlSymReq += ueSchedInfo.m_maxDlSymbols;
 		}
-		if (itUeInfo->second.m_maxUlBufSize > 0)
+		if (ueSchedInfo.m_maxUlBufSize > 0)
 		{
-			itUeInfo->second.m_maxUlSymbols = CalcMinTbSizeNumSym (itUeInfo->second.m_ulMcs, itUeInfo->second.m_maxUlBufSize+10, ulTbSize);
-			itUeInfo->second.m_maxUlBufSize = ulTbSize;
+			ueSchedInfo.m_maxUlSymbols = CalcMinTbSizeNumSym (ueSchedInfo.m_ulMcs, ueSchedInfo.m_maxUlBufSize+10, ulTbSize);
+			ueSchedInfo.m_maxUlBufSize = ulTbSize;
 			if (m_fixedTti)
 			{
-				itUeInfo->second.m_maxUlSymbols = ceil((double)itUeInfo->second.m_maxUlSymbols/(double)m_symPerSlot) * m_symPerSlot; // round up to nearest sym per TTI
+				ueSchedInfo.m_maxUlSymbols = ceil((double)ueSchedInfo.m_maxUlSymbols/(double)m_symPerSlot) * m_symPerSlot; // round up to nearest sym per TTI
 			}
-			totUlSymReq += itUeInfo->second.m_maxUlSymbols;
+			totUlSymReq += ueSchedInfo.m_maxUlSymbols;
 		}
 	}
 
-	std::map <uint16_t, struct UeSchedInfo>::iterator itUeInfoStart;
+	unsigned activeStart = 0;
 	if (m_nextRnti != 0) 	// start with RNTI at which the scheduler left off
 	{
-		itUeInfoStart = ueInfo.find (m_nextRnti);
-		if (itUeInfoStart == ueInfo.end ())
+		while (activeStart < nActiveUes && m_ues[m_activeUes[activeStart]].m_rnti != m_nextRnti)
 		{
-			itUeInfoStart = ueInfo.begin ();
+			activeStart++;
+		}
+		if (activeStart == nActiveUes)
+		{
+			activeStart = 0;
 		}
 	}
-	else	// start with first active RNTI
-	{
-		itUeInfoStart = ueInfo.begin ();
-	}
-	itUeInfo = itUeInfoStart;
+	// else start with first active RNTI
+	unsigned activeIdx = activeStart;
 
 	// divide OFDM symbols evenly between active UEs, which are then evenly divided between DL and UL flows
 	if (nFlowsTot > 0)
@@ -1222,15 +1166,16 @@ MmWaveFlexTtiMacScheduler::DoSchedTriggerReq (const struct MmWaveMacSchedSapProv
 			}
 			while (remSym > 0)
 			{
+				UeSchedInfo &ueSchedInfo = m_ues[m_activeUes[activeIdx]].m_sched;
 				int addSym = 0;
 				// deficit = difference between requested and allocated symbols
-				int deficit = itUeInfo->second.m_maxDlSymbols - itUeInfo->second.m_dlSymbols;
+				int deficit = ueSchedInfo.m_maxDlSymbols - ueSchedInfo.m_dlSymbols;
 				NS_ASSERT (deficit >= 0);
 				if (m_fixedTti)
 				{
 					deficit = ceil((double)deficit/(double)m_symPerSlot) * m_symPerSlot; // round up to nearest sym per TTI
 				}
-				if (deficit > 0 && ((itUeInfo->second.m_dlSymbols+itUeInfo->second.m_dlSymbolsRetx) <= nSymPerFlow0))
+				if (deficit > 0 && ((ueSchedInfo.m_dlSymbols+ueSchedInfo.m_dlSymbolsRetx) <= nSymPerFlow0))
 				{
 					if (deficit < nRemSymPerFlow)
 					{
@@ -1261,13 +1206,13 @@ MmWaveFlexTtiMacScheduler::DoSchedTriggerReq (const struct MmWaveMacSchedSapProv
 					}
 					allocated = true;
 				}
-				itUeInfo->second.m_dlSymbols += addSym;
+				ueSchedInfo.m_dlSymbols += addSym;
 				remSym -= addSym;
 				NS_ASSERT (remSym >= 0);
 
 				addSym = 0;
 				// deficit = difference between requested and allocated symbols
-				deficit = itUeInfo->second.m_maxUlSymbols - itUeInfo->second.m_ulSymbols;
+				deficit = ueSchedInfo.m_maxUlSymbols - ueSchedInfo.m_ulSymbols;
 				NS_ASSERT (deficit >= 0);
 				if (m_fixedTti)
 				{
@@ -1277,7 +1222,7 @@ MmWaveFlexTtiMacScheduler::DoSchedTriggerReq (const struct MmWaveMacSchedSapProv
 				{
 					nRemSymPerFlow = ceil((double)nRemSymPerFlow/(double)m_symPerSlot) * m_symPerSlot; // round up to nearest sym per TTI
 				}
-				if (remSym > 0 && deficit > 0 && ((itUeInfo->second.m_ulSymbols+itUeInfo->second.m_ulSymbolsRetx) <= nSymPerFlow0))
+				if (remSym > 0 && deficit > 0 && ((ueSchedInfo.m_ulSymbols+ueSchedInfo.m_ulSymbolsRetx) <= nSymPerFlow0))
 				{
 					if (deficit < nRemSymPerFlow)
 					{
@@ -1309,16 +1254,12 @@ MmWaveFlexTtiMacScheduler::DoSchedTriggerReq (const struct MmWaveMacSchedSapProv
 						allocated = true;
 					}
 				}
-				itUeInfo->second.m_ulSymbols += addSym;
+				ueSchedInfo.m_ulSymbols += addSym;
 				remSym -= addSym;
 				NS_ASSERT (remSym >= 0);
 
-				itUeInfo++;
-				if (itUeInfo == ueInfo.end ())
-				{ // loop around to first RNTI in map
-					itUeInfo = ueInfo.begin ();
-				}
-				if (itUeInfo == itUeInfoStart)
+				activeIdx = (activeIdx + 1) % nActiveUes; // loop around to first RNTI
+				if (activeIdx == activeStart)
 				{ // break when looped back to initial RNTI or no symbols remain
 					break;
 				}
@@ -1326,22 +1267,23 @@ MmWaveFlexTtiMacScheduler::DoSchedTriggerReq (const struct MmWaveMacSchedSapProv
 		}
 	}
 
-	m_nextRnti = itUeInfo->first;
+	m_nextRnti = m_ues[m_activeUes[activeIdx]].m_rnti;
 
 	// create DCI elements and assign symbol indices
 	// such that all DL slots are contiguous (at beginning of subframe)
 	// and all UL slots are contiguous (at end of subframe)
-	itUeInfo = itUeInfoStart;
+	activeIdx = activeStart;
 
 	//ulSymIdx -= totUlSymActual; // symbols reserved for control at end of subframe before UL ctrl
 	NS_ASSERT (symIdx > 0);
 	do
 	{
-		UeSchedInfo &ueSchedInfo = itUeInfo->second;
+		UeState &ue = m_ues[m_activeUes[activeIdx]];
+		UeSchedInfo &ueSchedInfo = ue.m_sched;
 		if (ueSchedInfo.m_dlSymbols > 0)
 		{
 			DciInfoElementTdma dci;
-			dci.m_rnti = itUeInfo->first;
+			dci.m_rnti = ue.m_rnti;
 			dci.m_format = 0;
 			dci.m_symStart = symIdx;
 			dci.m_numSym = ueSchedInfo.m_dlSymbols;
@@ -1356,29 +1298,19 @@ MmWaveFlexTtiMacScheduler::DoSchedTriggerReq (const struct MmWaveMacSchedSapProv
 			}*/
 			NS_ASSERT (symIdx <= m_phyMacConfig->GetSymbolsPerSubframe () - m_phyMacConfig->GetUlCtrlSymbols ());
 			dci.m_rv = 0;
-			dci.m_harqProcess = UpdateDlHarqProcessId (itUeInfo->first);
+			dci.m_harqProcess = UpdateDlHarqProcessId (ue);
 			NS_ASSERT (dci.m_harqProcess < m_phyMacConfig->GetNumHarqProcess ());
-			NS_LOG_DEBUG ("UE" << itUeInfo->first << " DL harqId " << (unsigned)dci.m_harqProcess << " HARQ process assigned");
-			SlotAllocInfo slotInfo (slotIdx++, SlotAllocInfo::DL, SlotAllocInfo::CTRL_DATA, SlotAllocInfo::DIGITAL, itUeInfo->first);
+			NS_LOG_DEBUG ("UE" << ue.m_rnti << " DL harqId " << (unsigned)dci.m_harqProcess << " HARQ process assigned");
+			SlotAllocInfo slotInfo (slotIdx++, SlotAllocInfo::DL, SlotAllocInfo::CTRL_DATA, SlotAllocInfo::DIGITAL, ue.m_rnti);
 			slotInfo.m_dci = dci;
 			NS_LOG_DEBUG ("UE" << dci.m_rnti << " gets DL slots " << (unsigned)dci.m_symStart << "-" << (unsigned)(dci.m_symStart+dci.m_numSym-1) <<
 			             " tbs " << dci.m_tbSize << " mcs " << (unsigned)dci.m_mcs << " harqId " << (unsigned)dci.m_harqProcess << " rv " << (unsigned)dci.m_rv << " in frame " << ret.m_sfnSf.m_frameNum << " subframe " << (unsigned)ret.m_sfnSf.m_sfNum);
 
 			if (m_harqOn == true)
 			{	// store DCI for HARQ buffer
-				std::map <uint16_t, DlHarqProcessesDciInfoList_t>::iterator itDciInfo = m_dlHarqProcessesDciInfoMap.find (dci.m_rnti);
-				if (itDciInfo == m_dlHarqProcessesDciInfoMap.end ())
-				{
-					NS_FATAL_ERROR ("Unable to find RNTI entry in DCI HARQ buffer for RNTI " << dci.m_rnti);
-				}
-				(*itDciInfo).second.at (dci.m_harqProcess) = dci;
+				ue.m_dlHarqDci.at (dci.m_harqProcess) = dci;
 				// refresh timer
-				std::map <uint16_t, DlHarqProcessesTimer_t>::iterator itHarqTimer =  m_dlHarqProcessesTimer.find (dci.m_rnti);
-				if (itHarqTimer== m_dlHarqProcessesTimer.end ())
-				{
-					NS_FATAL_ERROR ("Unable to find HARQ timer for RNTI " << (uint16_t)dci.m_rnti);
-				}
-				(*itHarqTimer).second.at (dci.m_harqProcess) = 0;
+				ue.m_dlHarqTimers.at (dci.m_harqProcess) = 0;
 			}
 
 			// distribute bytes between active RLC queues
@@ -1409,29 +1341,21 @@ MmWaveFlexTtiMacScheduler::DoSchedTriggerReq (const struct MmWaveMacSchedSapProv
 				}
 				// else tbSize equals RLC queue size
 				NS_ASSERT(ueSchedInfo.m_rlcPduInfo[i].m_size > 0);
-				/*for (itRlcBuf = m_rlcBufferReq.begin (); itRlcBuf != m_rlcBufferReq.end (); itRlcBuf++)
+				/*for (unsigned l = 0; l < ue.m_rlcBuffers.size (); l++)
 				{
-					if(itRlcBuf->m_rnti == itUeInfo->first)
+					if(ue.m_rlcBuffers[l].m_rlcTransmissionQueueSize == 0)
 					{
-						if(itRlcBuf->m_rlcTransmissionQueueSize == 0)
-						{
-							NS_FATAL_ERROR ("LC is scheduled but RLC buffer == 0");
-						}
+						NS_FATAL_ERROR ("LC is scheduled but RLC buffer == 0");
 					}
 				}*/
 				// update RLC buffer info with expected queue size after scheduling
-				UpdateDlRlcBufferInfo (itUeInfo->first, ueSchedInfo.m_rlcPduInfo[i].m_lcid, ueSchedInfo.m_rlcPduInfo[i].m_size-m_subHdrSize);
+				UpdateDlRlcBufferInfo (ue.m_rnti, ueSchedInfo.m_rlcPduInfo[i].m_lcid, ueSchedInfo.m_rlcPduInfo[i].m_size-m_subHdrSize);
 				//schedInfo.m_rlcPduList[schedInfo.m_rlcPduList.size ()-1].push_back (itRlcInfo->second[i]);
 				slotInfo.m_rlcPduInfo.push_back (ueSchedInfo.m_rlcPduInfo[i]);
 				if (m_harqOn == true)
 				{
 					// store RLC PDU list for HARQ
-					std::map <uint16_t, DlHarqRlcPduList_t>::iterator itRlcPdu =  m_dlHarqProcessesRlcPduMap.find (dci.m_rnti);
-					if (itRlcPdu == m_dlHarqProcessesRlcPduMap.end ())
-					{
-						NS_FATAL_ERROR ("Unable to find RlcPdcList in HARQ buffer for RNTI " << dci.m_rnti);
-					}
-					(*itRlcPdu).second.at (dci.m_harqProcess).push_back (ueSchedInfo.m_rlcPduInfo[i]);
+					ue.m_dlHarqRlcPdus.at (dci.m_harqProcess).push_back (ueSchedInfo.m_rlcPduInfo[i]);
 				}
 			}
 			// reorder/reindex slots to maintain DL before UL slot order
@@ -1467,7 +1391,7 @@ MmWaveFlexTtiMacScheduler::DoSchedTriggerReq (const struct MmWaveMacSchedSapProv
 		if (ueSchedInfo.m_ulSymbols > 0)
 		{
 			DciInfoElementTdma dci;
-			dci.m_rnti = itUeInfo->first;
+			dci.m_rnti = ue.m_rnti;
 			dci.m_format = 1;
 			NS_ASSERT (symIdx <= m_phyMacConfig->GetSymbolsPerSubframe () - m_phyMacConfig->GetUlCtrlSymbols ());
 			dci.m_numSym = ueSchedInfo.m_ulSymbols;
@@ -1481,21 +1405,17 @@ MmWaveFlexTtiMacScheduler::DoSchedTriggerReq (const struct MmWaveMacSchedSapProv
 				dci.m_mcs--;
 				dci.m_tbSize = m_amc->GetTbSizeFromMcsSymbols (dci.m_mcs, dci.m_numSym) / 8;
 			}*/
-			dci.m_harqProcess = UpdateUlHarqProcessId (itUeInfo->first);
-			NS_LOG_DEBUG ("UE" << itUeInfo->first << " UL harqId " << (unsigned)dci.m_harqProcess << " HARQ process assigned");
+			dci.m_harqProcess = UpdateUlHarqProcessId (ue);
+			NS_LOG_DEBUG ("UE" << ue.m_rnti << " UL harqId " << (unsigned)dci.m_harqProcess << " HARQ process assigned");
 			NS_ASSERT (dci.m_harqProcess < m_phyMacConfig->GetNumHarqProcess ());
-			SlotAllocInfo slotInfo (slotIdx++, SlotAllocInfo::UL, SlotAllocInfo::CTRL_DATA, SlotAllocInfo::DIGITAL, itUeInfo->first);
+			SlotAllocInfo slotInfo (slotIdx++, SlotAllocInfo::UL, SlotAllocInfo::CTRL_DATA, SlotAllocInfo::DIGITAL, ue.m_rnti);
 			slotInfo.m_dci = dci;
 			NS_LOG_DEBUG ("UE" << dci.m_rnti << " gets UL slots " << (unsigned)dci.m_symStart << "-" << (unsigned)(dci.m_symStart+dci.m_numSym-1) <<
 						             " tbs " << dci.m_tbSize << " mcs " << (unsigned)dci.m_mcs << " harqId " << (unsigned)dci.m_harqProcess << " rv " << (unsigned)dci.m_rv << " in frame " << ulSfn.m_frameNum << " subframe " << (unsigned)ulSfn.m_sfNum);
-			UpdateUlRlcBufferInfo (itUeInfo->first, dci.m_tbSize - m_subHdrSize);
+			UpdateUlRlcBufferInfo (ue.m_rnti, dci.m_tbSize - m_subHdrSize);
 			ret.m_sfAllocInfo.m_slotAllocInfo.push_back (slotInfo);  // add to front
 			ret.m_sfAllocInfo.m_numSymAlloc += dci.m_numSym;
-			std::vector<uint16_t> ueChunkMap;
-			for (unsigned i = 0; i < m_phyMacConfig->GetTotalNumChunk (); i++)
-			{
-				ueChunkMap.push_back (dci.m_rnti);
-			}
+			std::vector<uint16_t> ueChunkMap (m_phyMacConfig->GetTotalNumChunk (), dci.m_rnti);
 			SfnSf slotSfn = ret.m_sfAllocInfo.m_sfnSf;
 			slotSfn.m_slotNum = dci.m_symStart;  // use the start symbol index of the slot because the absolute UL slot index depends on the future DL allocation
 			// insert into allocation map to recall previous allocations upon receiving UL-CQI
@@ -1504,31 +1424,16 @@ MmWaveFlexTtiMacScheduler::DoSchedTriggerReq (const struct MmWaveMacSchedSapProv
 			if (m_harqOn == true)
 			{
 				uint8_t harqId = dci.m_harqProcess;
-				std::map <uint16_t, UlHarqProcessesDciInfoList_t>::iterator itHarqTbInfo = m_ulHarqProcessesDciInfoMap.find (dci.m_rnti);
-				if (itHarqTbInfo == m_ulHarqProcessesDciInfoMap.end ())
-				{
-					NS_FATAL_ERROR ("Unable to find RNTI entry in UL DCI HARQ buffer for RNTI " << dci.m_rnti);
-				}
-				(*itHarqTbInfo).second.at (harqId) = dci;
+				ue.m_ulHarqDci.at (harqId) = dci;
 				// Update HARQ process status (RV 0)
-				std::map <uint16_t, UlHarqProcessesStatus_t>::iterator itStat = m_ulHarqProcessesStatus.find (dci.m_rnti);
-				NS_ASSERT (itStat->second[dci.m_harqProcess] > 0);
+				NS_ASSERT (ue.m_ulHarqStatus[dci.m_harqProcess] > 0);
 				// refresh timer
-				std::map <uint16_t, UlHarqProcessesTimer_t>::iterator itHarqTimer =  m_ulHarqProcessesTimer.find (dci.m_rnti);
-				if (itHarqTimer== m_ulHarqProcessesTimer.end ())
-				{
-					NS_FATAL_ERROR ("Unable to find HARQ timer for RNTI " << (uint16_t)dci.m_rnti);
-				}
-				(*itHarqTimer).second.at (dci.m_harqProcess) = 0;
+				ue.m_ulHarqTimers.at (dci.m_harqProcess) = 0;
 			}
 		}
-		itUeInfo++;
-		if (itUeInfo == ueInfo.end ())
-		{ // loop around to first RNTI in map
-			itUeInfo = ueInfo.begin ();
-		}
+		activeIdx = (activeIdx + 1) % nActiveUes; // loop around to first RNTI
 	}
-	while (itUeInfo != itUeInfoStart); // break when looped back to initial RNTI
+	while (activeIdx != activeStart); // break when looped back to initial RNTI
 
 	// add slot for UL control
 	SlotAllocInfo ulCtrlSlot (0xFF, SlotAllocInfo::UL, SlotAllocInfo::CTRL, SlotAllocInfo::DIGITAL, 0);
@@ -1545,8 +1450,6 @@ MmWaveFlexTtiMacScheduler::DoSchedUlMacCtrlInfoReq (const struct MmWaveMacSchedS
 {
 	NS_LOG_FUNCTION (this);
 
-	std::map <uint16_t,uint32_t>::iterator it;
-
 	for (unsigned int i = 0; i < params.m_macCeList.size (); i++)
 	{
 		if ( params.m_macCeList.at (i).m_macCeType == MacCeElement::BSR )
@@ -1566,17 +1469,18 @@ MmWaveFlexTtiMacScheduler::DoSchedUlMacCtrlInfoReq (const struct MmWaveMacSchedS
 			}
 
 			uint16_t rnti = params.m_macCeList.at (i).m_rnti;
-			it = m_ceBsrRxed.find (rnti);
-			if (it == m_ceBsrRxed.end ())
+			UeState &ue = m_ues[AddUe (rnti)];
+			if (!ue.m_hasBsr)
 			{
 				// create the new entry
-				m_ceBsrRxed.insert ( std::pair<uint16_t, uint32_t > (rnti, buffer));
+				ue.m_hasBsr = true;
+				ue.m_bsr = buffer;
 				NS_LOG_INFO (this << " Insert RNTI " << rnti << " queue " << buffer);
 			}
 			else
 			{
 				// update the buffer size value
-				(*it).second = buffer;
+				ue.m_bsr = buffer;
 				NS_LOG_INFO (this << " Update RNTI " << rnti << " queue " << buffer);
 			}
 		}
@@ -1605,27 +1509,26 @@ MmWaveFlexTtiMacScheduler::SortRlcBufferReq (MmWaveMacSchedSapProvider::SchedDlR
 void
 MmWaveFlexTtiMacScheduler::RefreshDlCqiMaps (void)
 {
-  NS_LOG_FUNCTION (this << m_wbCqiTimers.size ());
+  NS_LOG_FUNCTION (this << m_uesByRnti.size ());
   // refresh DL CQI P01 Map
-  std::map <uint16_t,uint32_t>::iterator itP10 = m_wbCqiTimers.begin ();
-  while (itP10 != m_wbCqiTimers.end ())
+  for (uint32_t index = 0; index < m_ues.size (); index++)
     {
-      NS_LOG_INFO (this << " P10-CQI for user " << (*itP10).first << " is " << (uint32_t)(*itP10).second << " thr " << (uint32_t)m_cqiTimersThreshold);
-      if ((*itP10).second == 0)
+      UeState &ue = m_ues[index];
+      if (ue.m_rnti == 0 || !ue.m_hasDlCqi)
+        {
+          continue;
+        }
+      NS_LOG_INFO (this << " P10-CQI for user " << ue.m_rnti << " is " << ue.m_dlCqiTimer << " thr " << (uint32_t)m_cqiTimersThreshold);
+      if (ue.m_dlCqiTimer == 0)
         {
           // delete correspondent entries
-          std::map <uint16_t,uint8_t>::iterator itMap = m_wbCqiRxed.find ((*itP10).first);
-          NS_ASSERT_MSG (itMap != m_wbCqiRxed.end (), " Does not find CQI report for user " << (*itP10).first);
-          NS_LOG_INFO (this << " P10-CQI exired for user " << (*itP10).first);
-          m_wbCqiRxed.erase (itMap);
-          std::map <uint16_t,uint32_t>::iterator temp = itP10;
-          itP10++;
-          m_wbCqiTimers.erase (temp);
+          NS_LOG_INFO (this << " P10-CQI exired for user " << ue.m_rnti);
+          ue.m_hasDlCqi = false;
+          RemoveUeIfUnused (index);
         }
       else
         {
-          (*itP10).second--;
-          itP10++;
+          ue.m_dlCqiTimer--;
         }
     }
 
@@ -1637,26 +1540,25 @@ void
 MmWaveFlexTtiMacScheduler::RefreshUlCqiMaps (void)
 {
   // refresh UL CQI  Map
-  std::map <uint16_t,uint32_t>::iterator itUl = m_ueCqiTimers.begin ();
-  while (itUl != m_ueCqiTimers.end ())
+  for (uint32_t index = 0; index < m_ues.size (); index++)
     {
-      NS_LOG_INFO (this << " UL-CQI for user " << (*itUl).first << " is " << (uint32_t)(*itUl).second << " thr " << (uint32_t)m_cqiTimersThreshold);
-      if ((*itUl).second == 0)
+      UeState &ue = m_ues[index];
+      if (ue.m_rnti == 0 || !ue.m_hasUlCqi)
+        {
+          continue;
+        }
+      NS_LOG_INFO (this << " UL-CQI for user " << ue.m_rnti << " is " << ue.m_ulCqiTimer << " thr " << (uint32_t)m_cqiTimersThreshold);
+      if (ue.m_ulCqiTimer == 0)
         {
           // delete correspondent entries
-          std::map <uint16_t, struct UlCqiMapElem>::iterator itMap = m_ueUlCqi.find ((*itUl).first);
-          NS_ASSERT_MSG (itMap != m_ueUlCqi.end (), " Does not find CQI report for user " << (*itUl).first);
-          NS_LOG_INFO (this << " UL-CQI expired for user " << (*itUl).first);
-          itMap->second.m_ueUlCqi.clear ();
-          m_ueUlCqi.erase (itMap);
-          std::map <uint16_t,uint32_t>::iterator temp = itUl;
-          itUl++;
-          m_ueCqiTimers.erase (temp);
+          NS_LOG_INFO (this << " UL-CQI expired for user " << ue.m_rnti);
+          ue.m_hasUlCqi = false;
+          ue.m_ulCqi.clear ();
+          RemoveUeIfUnused (index);
         }
       else
         {
-          (*itUl).second--;
-          itUl++;
+          ue.m_ulCqiTimer--;
         }
     }
 
@@ -1667,10 +1569,15 @@ void
 MmWaveFlexTtiMacScheduler::UpdateDlRlcBufferInfo (uint16_t rnti, uint8_t lcid, uint16_t size)
 {
   NS_LOG_FUNCTION (this);
-  std::list<MmWaveMacSchedSapProvider::SchedDlRlcBufferReqParameters>::iterator it;
-  for (it = m_rlcBufferReq.begin (); it != m_rlcBufferReq.end (); it++)
+  uint32_t index = FindUe (rnti);
+  if (index == m_noUe)
   {
-  	if (((*it).m_rnti == rnti) && ((*it).m_logicalChannelIdentity == lcid))
+  	return;
+  }
+  std::vector<MmWaveMacSchedSapProvider::SchedDlRlcBufferReqParameters>::iterator it;
+  for (it = m_ues[index].m_rlcBuffers.begin (); it != m_ues[index].m_rlcBuffers.end (); it++)
+  {
+  	if ((*it).m_logicalChannelIdentity == lcid)
   	{
   		NS_LOG_INFO (this << " UE " << rnti << " LC " << (uint16_t)lcid << " txqueue " << (*it).m_rlcTransmissionQueueSize << " retxqueue " << (*it).m_rlcRetransmissionQueueSize << " status " << (*it).m_rlcStatusPduSize << " decrease " << size);
   		// Update queues: RLC tx order Status, ReTx, Tx
@@ -1727,17 +1634,18 @@ MmWaveFlexTtiMacScheduler::UpdateUlRlcBufferInfo (uint16_t rnti, uint16_t size)
 {
 
   size = size - 2; // remove the minimum RLC overhead
-  std::map <uint16_t,uint32_t>::iterator it = m_ceBsrRxed.find (rnti);
-  if (it != m_ceBsrRxed.end ())
+  uint32_t index = FindUe (rnti);
+  if (index != m_noUe && m_ues[index].m_hasBsr)
     {
-      NS_LOG_INFO (this << " Update RLC BSR UE " << rnti << " size " << size << " BSR " << (*it).second);
-      if ((*it).second >= size)
+      UeState &ue = m_ues[index];
+      NS_LOG_INFO (this << " Update RLC BSR UE " << rnti << " size " << size << " BSR " << ue.m_bsr);
+      if (ue.m_bsr >= size)
         {
-          (*it).second -= size;
+          ue.m_bsr -= size;
         }
       else
         {
-          (*it).second = 0;
+          ue.m_bsr = 0;
         }
     }
   else
@@ -1766,35 +1674,22 @@ MmWaveFlexTtiMacScheduler::DoCschedUeConfigReq (const struct MmWaveMacCschedSapP
 {
   NS_LOG_FUNCTION (this << " RNTI " << params.m_rnti << " txMode " << (uint16_t)params.m_transmissionMode);
 
-  if (m_dlHarqProcessesStatus.find (params.m_rnti) == m_dlHarqProcessesStatus.end ())
+  UeState &ue = m_ues[AddUe (params.m_rnti)];
+  if (!ue.m_hasDlHarq)
   {
-  	//m_dlHarqCurrentProcessId.insert (std::pair <uint16_t,uint8_t > (params.m_rnti, 0));
-  	DlHarqProcessesStatus_t dlHarqPrcStatus;
-  	dlHarqPrcStatus.resize (m_phyMacConfig->GetNumHarqProcess (), 0);
-  	m_dlHarqProcessesStatus.insert (std::pair <uint16_t, DlHarqProcessesStatus_t> (params.m_rnti, dlHarqPrcStatus));
-  	DlHarqProcessesTimer_t dlHarqProcessesTimer;
-  	dlHarqProcessesTimer.resize (m_phyMacConfig->GetNumHarqProcess (),0);
-  	m_dlHarqProcessesTimer.insert (std::pair <uint16_t, DlHarqProcessesTimer_t> (params.m_rnti, dlHarqProcessesTimer));
-  	DlHarqProcessesDciInfoList_t dlHarqTbInfoList;
-  	dlHarqTbInfoList.resize (m_phyMacConfig->GetNumHarqProcess ());
-  	m_dlHarqProcessesDciInfoMap.insert (std::pair <uint16_t, DlHarqProcessesDciInfoList_t> (params.m_rnti, dlHarqTbInfoList));
-  	DlHarqRlcPduList_t dlHarqRlcPduList;
-  	dlHarqRlcPduList.resize (m_phyMacConfig->GetNumHarqProcess ());
-  	m_dlHarqProcessesRlcPduMap.insert (std::pair <uint16_t, DlHarqRlcPduList_t> (params.m_rnti, dlHarqRlcPduList));
+  	ue.m_hasDlHarq = true;
+  	ue.m_dlHarqStatus.assign (m_phyMacConfig->GetNumHarqProcess (), 0);
+  	ue.m_dlHarqTimers.assign (m_phyMacConfig->GetNumHarqProcess (), 0);
+  	ue.m_dlHarqDci.assign (m_phyMacConfig->GetNumHarqProcess (), DciInfoElementTdma ());
+  	ue.m_dlHarqRlcPdus.assign (m_phyMacConfig->GetNumHarqProcess (), std::vector<RlcPduInfo> ());
   }
 
-  if (m_ulHarqProcessesStatus.find (params.m_rnti) == m_ulHarqProcessesStatus.end ())
+  if (!ue.m_hasUlHarq)
   {
-  	//				m_ulHarqCurrentProcessId.insert (std::pair <uint16_t,uint8_t > (rnti, 0));
-  	UlHarqProcessesStatus_t ulHarqPrcStatus;
-  	ulHarqPrcStatus.resize (m_phyMacConfig->GetNumHarqProcess (), 0);
-  	m_ulHarqProcessesStatus.insert (std::pair <uint16_t, UlHarqProcessesStatus_t> (params.m_rnti, ulHarqPrcStatus));
-  	UlHarqProcessesTimer_t ulHarqProcessesTimer;
-  	ulHarqProcessesTimer.resize (m_phyMacConfig->GetNumHarqProcess (),0);
-  	m_ulHarqProcessesTimer.insert (std::pair <uint16_t, UlHarqProcessesTimer_t> (params.m_rnti, ulHarqProcessesTimer));
-  	UlHarqProcessesDciInfoList_t ulHarqTbInfoList;
-  	ulHarqTbInfoList.resize (m_phyMacConfig->GetNumHarqProcess ());
-  	m_ulHarqProcessesDciInfoMap.insert (std::pair <uint16_t, UlHarqProcessesDciInfoList_t> (params.m_rnti, ulHarqTbInfoList));
+  	ue.m_hasUlHarq = true;
+  	ue.m_ulHarqStatus.assign (m_phyMacConfig->GetNumHarqProcess (), 0);
+  	ue.m_ulHarqTimers.assign (m_phyMacConfig->GetNumHarqProcess (), 0);
+  	ue.m_ulHarqDci.assign (m_phyMacConfig->GetNumHarqProcess (), DciInfoElementTdma ());
   }
 }
 
@@ -1810,14 +1705,20 @@ void
 MmWaveFlexTtiMacScheduler::DoCschedLcReleaseReq (const struct MmWaveMacCschedSapProvider::CschedLcReleaseReqParameters& params)
 {
   NS_LOG_FUNCTION (this);
+  uint32_t index = FindUe (params.m_rnti);
+  if (index == m_noUe)
+    {
+      return;
+    }
+  std::vector<MmWaveMacSchedSapProvider::SchedDlRlcBufferReqParameters> &rlcBuffers = m_ues[index].m_rlcBuffers;
     for (uint16_t i = 0; i < params.m_logicalChannelIdentity.size (); i++)
     {
-     std::list<MmWaveMacSchedSapProvider::SchedDlRlcBufferReqParameters>::iterator it = m_rlcBufferReq.begin ();
-      while (it!=m_rlcBufferReq.end ())
+     std::vector<MmWaveMacSchedSapProvider::SchedDlRlcBufferReqParameters>::iterator it = rlcBuffers.begin ();
+      while (it!=rlcBuffers.end ())
         {
-          if (((*it).m_rnti == params.m_rnti)&&((*it).m_logicalChannelIdentity == params.m_logicalChannelIdentity.at (i)))
+          if ((*it).m_logicalChannelIdentity == params.m_logicalChannelIdentity.at (i))
             {
-              it = m_rlcBufferReq.erase (it);
+              it = rlcBuffers.erase (it);
             }
           else
             {
@@ -1825,6 +1726,7 @@ MmWaveFlexTtiMacScheduler::DoCschedLcReleaseReq (const struct MmWaveMacCschedSap
             }
         }
     }
+  RemoveUeIfUnused (index);
   return;
 }
 
@@ -1833,28 +1735,31 @@ MmWaveFlexTtiMacScheduler::DoCschedUeReleaseReq (const struct MmWaveMacCschedSap
 {
   NS_LOG_FUNCTION (this << " Release RNTI " << params.m_rnti);
 
-  //m_dlHarqCurrentProcessId.erase (params.m_rnti);
-  m_dlHarqProcessesStatus.erase  (params.m_rnti);
-  m_dlHarqProcessesTimer.erase (params.m_rnti);
-  m_dlHarqProcessesDciInfoMap.erase  (params.m_rnti);
-  m_dlHarqProcessesRlcPduMap.erase  (params.m_rnti);
-  //m_ulHarqCurrentProcessId.erase  (params.m_rnti);
-  m_ulHarqProcessesTimer.erase (params.m_rnti);
-  m_ulHarqProcessesStatus.erase  (params.m_rnti);
-  m_ulHarqProcessesDciInfoMap.erase  (params.m_rnti);
-  m_ceBsrRxed.erase (params.m_rnti);
-  std::list<MmWaveMacSchedSapProvider::SchedDlRlcBufferReqParameters>::iterator it = m_rlcBufferReq.begin ();
-  while (it != m_rlcBufferReq.end ())
+  uint32_t index = FindUe (params.m_rnti);
+  if (index != m_noUe)
     {
-      if ((*it).m_rnti == params.m_rnti)
+      // the CQIs are kept until their timers expire
+      UeState &ue = m_ues[index];
+      ue.m_hasDlHarq = false;
+      ue.m_dlHarqStatus.clear ();
+      ue.m_dlHarqTimers.clear ();
+      ue.m_dlHarqDci.clear ();
+      for (unsigned i = 0; i < ue.m_dlHarqRlcPdus.size (); i++)
         {
-          NS_LOG_INFO (this << " Erase RNTI " << (*it).m_rnti << " LC " << (uint16_t)(*it).m_logicalChannelIdentity);
-          it = m_rlcBufferReq.erase (it);
+          ue.m_dlHarqRlcPdus[i].clear ();
         }
-      else
+      ue.m_hasUlHarq = false;
+      ue.m_ulHarqStatus.clear ();
+      ue.m_ulHarqTimers.clear ();
+      ue.m_ulHarqDci.clear ();
+      ue.m_hasBsr = false;
+      ue.m_bsr = 0;
+      for (unsigned l = 0; l < ue.m_rlcBuffers.size (); l++)
         {
-          it++;
+          NS_LOG_INFO (this << " Erase RNTI " << params.m_rnti << " LC " << (uint16_t)ue.m_rlcBuffers[l].m_logicalChannelIdentity);
         }
+      ue.m_rlcBuffers.clear ();
+      RemoveUeIfUnused (index);
     }
   if (m_nextRntiUl == params.m_rnti)
     {
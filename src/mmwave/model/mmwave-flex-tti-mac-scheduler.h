@@ -35,6 +35,7 @@
 #include "mmwave-mac-csched-sap.h"
 #include "mmwave-mac-scheduler.h"
 #include "mmwave-amc.h"
+#include <ns3/spectrum-value.h>
 #include "string"
 #include <vector>
 #include <set>
@@ -93,6 +94,25 @@ private:
 		{
 		}
 
+		void Reset ()
+		{
+			m_dlMcs = 0;
+			m_ulMcs = 0;
+			m_maxDlBufSize = 0;
+			m_maxUlBufSize = 0;
+			m_maxDlSymbols = 0;
+			m_maxUlSymbols = 0;
+			m_dlSymbols = 0;
+			m_ulSymbols = 0;
+			m_dlSymbolsRetx = 0;
+			m_ulSymbolsRetx = 0;
+			m_dlTbSize = 0;
+			m_ulTbSize = 0;
+			m_rlcPduInfo.clear ();	// keep the capacity for the next slots
+			m_dlAllocDone = false;
+			m_ulAllocDone = false;
+		}
+
 		uint8_t		m_dlMcs;
 		uint8_t		m_ulMcs;
 		uint32_t	m_maxDlBufSize;
@@ -110,6 +130,110 @@ private:
 		bool			m_ulAllocDone;
 	};
 
+	/*
+	 * State of a UE, entry of the table m_ues
+	 */
+	struct UeState
+	{
+		UeState () :
+			m_rnti (0),
+			m_hasDlCqi (false), m_dlCqi (0), m_dlCqiTimer (0),
+			m_hasUlCqi (false), m_ulCqiNumSym (0), m_ulCqiTbSize (0), m_ulCqiTimer (0),
+			m_hasBsr (false), m_bsr (0),
+			m_hasDlHarq (false), m_hasUlHarq (false),
+			m_active (false)
+		{
+		}
+
+		void Reset (uint16_t rnti)
+		{
+			m_rnti = rnti;
+			// clear the vectors but keep their capacity for the next UE of the entry
+			m_hasDlCqi = false;
+			m_dlCqi = 0;
+			m_dlCqiTimer = 0;
+			m_hasUlCqi = false;
+			m_ulCqi.clear ();
+			m_ulCqiNumSym = 0;
+			m_ulCqiTbSize = 0;
+			m_ulCqiTimer = 0;
+			m_hasBsr = false;
+			m_bsr = 0;
+			m_rlcBuffers.clear ();
+			m_hasDlHarq = false;
+			m_dlHarqStatus.clear ();
+			m_dlHarqTimers.clear ();
+			m_dlHarqDci.clear ();
+			for (unsigned i = 0; i < m_dlHarqRlcPdus.size (); i++)
+			{
+				m_dlHarqRlcPdus[i].clear ();
+			}
+			m_hasUlHarq = false;
+			m_ulHarqStatus.clear ();
+			m_ulHarqTimers.clear ();
+			m_ulHarqDci.clear ();
+			m_active = false;
+			m_sched.Reset ();
+		}
+
+		uint16_t	m_rnti;		// 0 if the entry is free
+		// DL wideband CQI
+		bool			m_hasDlCqi;
+		uint8_t		m_dlCqi;
+		uint32_t	m_dlCqiTimer;
+		// UL CQI per chunk, and the allocation it was measured on
+		bool			m_hasUlCqi;
+		std::vector <double> m_ulCqi;
+		uint8_t		m_ulCqiNumSym;
+		uint32_t	m_ulCqiTbSize;
+		uint32_t	m_ulCqiTimer;
+		// buffer status report
+		bool			m_hasBsr;
+		uint32_t	m_bsr;
+		// RLC buffer status of the LCs, in the order of their last report
+		std::vector <MmWaveMacSchedSapProvider::SchedDlRlcBufferReqParameters> m_rlcBuffers;
+		// HARQ processes, set up by DoCschedUeConfigReq
+		//HARQ status
+		// 0: process Id available
+		// x>0: process Id equal to `x` trasmission count
+		bool			m_hasDlHarq;
+		DlHarqProcessesStatus_t m_dlHarqStatus;
+		DlHarqProcessesTimer_t m_dlHarqTimers;
+		DlHarqProcessesDciInfoList_t m_dlHarqDci;
+		DlHarqRlcPduList_t m_dlHarqRlcPdus;
+		bool			m_hasUlHarq;
+		UlHarqProcessesStatus_t m_ulHarqStatus;
+		UlHarqProcessesTimer_t m_ulHarqTimers;
+		UlHarqProcessesDciInfoList_t m_ulHarqDci;
+		// scheduling in the current slot
+		bool			m_active;
+		UeSchedInfo m_sched;
+	};
+
+	/**
+	 * \param rnti the RNTI of a UE
+	 * \return the index of the UE in m_ues, or m_noUe if it has no entry
+	 */
+	uint32_t FindUe (uint16_t rnti) const;
+
+	/**
+	 * \param rnti the RNTI of a UE
+	 * \return the index of the UE in m_ues, after adding an entry if it has none
+	 */
+	uint32_t AddUe (uint16_t rnti);
+
+	/**
+	 * Free the entry of a UE if it does not hold any state anymore
+	 * \param index the index of the UE in m_ues
+	 */
+	void RemoveUeIfUnused (uint32_t index);
+
+	/**
+	 * Add a UE to the ones scheduled in the current slot
+	 * \param index the index of the UE in m_ues
+	 */
+	void ActivateUe (uint32_t index);
+
 	unsigned CalcMinTbSizeNumSym (unsigned mcs, unsigned bufSize, unsigned &tbSize);
 
 	uint32_t
@@ -139,8 +263,8 @@ private:
 	  return (index);
 	}
 
-	uint8_t UpdateDlHarqProcessId (uint16_t rnti);
-	uint8_t UpdateUlHarqProcessId (uint16_t rnti);
+	uint8_t UpdateDlHarqProcessId (UeState &ue);
+	uint8_t UpdateUlHarqProcessId (UeState &ue);
 
 	//
 	// Implementation of the CSCHED API primitives
@@ -197,46 +321,18 @@ private:
 	Ptr<MmWaveAmc> m_amc;
 
 	/*
-	 * Vectors of UE's RLC info
+	 * Table of the UEs: the state of the UE of RNTI r is m_ues[m_ueIndex[r]].
+	 * The entries of released UEs are reused, so that the table does not
+	 * allocate memory as long as the set of UEs does not grow.
 	 */
-	std::list <MmWaveMacSchedSapProvider::SchedDlRlcBufferReqParameters> m_rlcBufferReq;
-
-	/*
-	 * Map of UE's DL CQI WB received
-	 */
-	std::map <uint16_t,uint8_t> m_wbCqiRxed;
-	/*
-	 * Map of UE's timers on DL CQI WB received
-	 */
-	std::map <uint16_t,uint32_t> m_wbCqiTimers;
+	std::vector <UeState> m_ues;
+	std::vector <uint32_t> m_ueIndex;		// index in m_ues by RNTI, m_noUe if none
+	std::vector <uint32_t> m_uesByRnti;	// indices of the used entries, by increasing RNTI
+	std::vector <uint32_t> m_freeUes;		// indices of the free entries
+	static const uint32_t m_noUe;
 
 	uint32_t m_cqiTimersThreshold; // # of TTIs for which a CQI can be considered valid
 
-	/*
-	 * Map of UEs' UL-CQI per RBG
-	 */
-	struct UlCqiMapElem
-	{
-		UlCqiMapElem (std::vector<double> ulCqi, uint8_t nSym, uint32_t tbs) :
-			m_ueUlCqi (ulCqi), m_numSym (nSym), m_tbSize (tbs)
-		{
-		}
-		std::vector <double> m_ueUlCqi;
-		uint8_t 	m_numSym;
-		uint32_t	m_tbSize;
-	};
-
-	std::map <uint16_t, struct UlCqiMapElem> m_ueUlCqi;
-	/*
-	 * Map of UEs' timers on UL-CQI per RBG
-	 */
-	std::map <uint16_t, uint32_t> m_ueCqiTimers;
-
-	/*
-	 * Map of UE's buffer status reports received
-	 */
-	std::map <uint16_t,uint32_t> m_ceBsrRxed;
-
 	uint16_t m_nextRnti;
 	uint64_t m_nextRntiDl;
 	uint64_t m_nextRntiUl;
@@ -279,24 +375,14 @@ private:
 	uint8_t m_numHarqProcess;
 	uint8_t m_harqTimeout;
 
-	std::map <uint16_t, uint8_t> m_dlHarqCurrentProcessId;
-	//HARQ status
-	// 0: process Id available
-	// x>0: process Id equal to `x` trasmission count
-	std::map <uint16_t, DlHarqProcessesStatus_t> m_dlHarqProcessesStatus;
-	std::map <uint16_t, DlHarqProcessesTimer_t> m_dlHarqProcessesTimer;
-	std::map <uint16_t, DlHarqProcessesDciInfoList_t> m_dlHarqProcessesDciInfoMap;
-	std::map <uint16_t, DlHarqRlcPduList_t> m_dlHarqProcessesRlcPduMap;
 	std::vector <DlHarqInfo> m_dlHarqInfoList; // HARQ retx buffered
 	std::vector <UlHarqInfo> m_ulHarqInfoList; // HARQ retx buffered
 
-	std::map <uint16_t, uint8_t> m_ulHarqCurrentProcessId;
-	//HARQ status
-	// 0: process Id available
-	// x>0: process Id equal to `x` trasmission count
-	std::map <uint16_t, UlHarqProcessesStatus_t> 	m_ulHarqProcessesStatus;
-	std::map <uint16_t, UlHarqProcessesTimer_t> 	m_ulHarqProcessesTimer;
-	std::map <uint16_t, UlHarqProcessesDciInfoList_t> m_ulHarqProcessesDciInfoMap;
+	// scratch buffers of DoSchedTriggerReq, kept from one slot to the next
+	std::vector <uint32_t> m_activeUes;	// indices of the UEs scheduled in the slot
+	std::vector <DlHarqInfo> m_dlHarqInfoUntxed;	// TBs not able to be retransmitted in this sf
+	std::vector <UlHarqInfo> m_ulHarqInfoUntxed;
+	Ptr<SpectrumValue> m_ulCqiSinr;	// UL SINR of a UE
 
 	// needed to keep track of uplink allocations in later slots
 	std::list <struct SfAllocInfo> m_ulSfAllocInfo;
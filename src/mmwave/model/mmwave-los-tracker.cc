@@ -32,6 +32,7 @@
 #include <ns3/antenna-array-model.h>
 #include <ns3/node.h>
 #include <algorithm>
+#include <cfloat>
 #include <ns3/double.h>
 #include <ns3/boolean.h>
 #include "ns3/mobility-model.h"
@@ -59,6 +60,13 @@ MmWaveLosTracker::GetTypeId (void)
 {
 	static TypeId tid = TypeId("ns3::MmWaveLosTracker")
 	.SetParent<Object>()
+	.AddAttribute ("LosCacheTolerance",
+				"Distance in meters either end of a link can move before its LOS/NLOS condition is "
+				"tested again against the buildings (0 tests it again after any move)",
+				DoubleValue (0.0),
+				MakeDoubleAccessor (&MmWaveLosTracker::SetLosCacheTolerance,
+									&MmWaveLosTracker::GetLosCacheTolerance),
+				MakeDoubleChecker<double> (0.0))
 	;
 
 	return tid;
@@ -81,53 +89,13 @@ MmWaveLosTracker::UpdateLosNlosState(Ptr<MobilityModel> a, Ptr<MobilityModel> b)
 
 
 	/*Determine LOS or NLOS*/
-	bool los = true;
-	for (BuildingList::Iterator bit = BuildingList::Begin (); bit != BuildingList::End (); ++bit)
+	bool blocked;
+	if (!m_losCache.Lookup (a, b, blocked))
 	{
-		Box boundaries = (*bit)->GetBoundaries ();
-		Vector locationA = a->GetPosition ();
-		Vector locationB = b->GetPosition ();
-		Angles pathAngles (locationB, locationA);
-		double angle = pathAngles.phi;
-		if (angle >= M_PI/2 || angle < -M_PI/2)
-		{
-			locationA = b->GetPosition ();
-			locationB = a->GetPosition ();
-			Angles pathAngles (locationB, locationA);
-			angle = pathAngles.phi;
-		}
-
-		if (angle >=0 && angle < M_PI/2 )
-		{
-			Vector loc1(boundaries.xMax,boundaries.yMin,boundaries.zMin);
-			Vector loc2(boundaries.xMin,boundaries.yMax,boundaries.zMin);
-			Angles angles1 (loc1,locationA);
-			Angles angles2 (loc2,locationA);
-			//if (angle > angles1.phi && angle < angles2.phi && locationB.x > boundaries.xMin && locationB.y > boundaries.yMin)
-			if (angle > angles1.phi && angle < angles2.phi && locationB.x > boundaries.xMin && locationB.y > boundaries.yMin
-									&& angles1.phi < M_PI/2 && angles2.phi <M_PI/2 && locationA.x<boundaries.xMax &&
-									locationA.y<boundaries.yMax ) //sjkang1206
-			{
-				los = false;
-				break;
-			}
-		}
-		else if (angle >= -M_PI/2 && angle < 0)
-		{
-			Vector loc1(boundaries.xMin,boundaries.yMin,boundaries.zMin);
-			Vector loc2(boundaries.xMax,boundaries.yMax,boundaries.zMin);
-			Angles angles1 (loc1,locationA);
-			Angles angles2 (loc2,locationA);
-			//if (angle > angles1.phi && angle < angles2.phi && locationB.x > boundaries.xMin && locationB.y < boundaries.yMax)
-			if (angle >angles1.phi && angle < angles2.phi && locationB.x>boundaries.xMin && locationB.y<boundaries.yMax
-								&& locationA.x < boundaries.xMin  ) //sjkang1206
-
-			{
-				los = false;
-				break;
-			}
-		}
+		blocked = IsBlocked (a->GetPosition (), b->GetPosition ());
+		m_losCache.Store (a, b, blocked);
 	}
+	bool los = !blocked;
 
 
 	/*
@@ -234,6 +202,70 @@ MmWaveLosTracker::UpdateLosNlosState(Ptr<MobilityModel> a, Ptr<MobilityModel> b)
 }
 
 
+bool
+MmWaveLosTracker::IsBlocked (Vector a, Vector b) const
+{
+	Vector locationA = a;
+	Vector locationB = b;
+	Angles pathAngles (locationB, locationA);
+	double angle = pathAngles.phi;
+	if (angle >= M_PI/2 || angle < -M_PI/2)
+	{
+		locationA = b;
+		locationB = a;
+		Angles pathAngles (locationB, locationA);
+		angle = pathAngles.phi;
+	}
+
+	// only the buildings overlapping the bounding box of the path can meet the conditions below
+	std::vector<Box> candidates;
+	m_buildingBvh.GetBuildings (Box (std::min (a.x, b.x), std::max (a.x, b.x),
+									 std::min (a.y, b.y), std::max (a.y, b.y),
+									 -DBL_MAX, DBL_MAX), candidates);
+	for (std::vector<Box>::const_iterator bit = candidates.begin (); bit != candidates.end (); ++bit)
+	{
+		const Box &boundaries = *bit;
+		if (angle >=0 && angle < M_PI/2 )
+		{
+			Vector loc1(boundaries.xMax,boundaries.yMin,boundaries.zMin);
+			Vector loc2(boundaries.xMin,boundaries.yMax,boundaries.zMin);
+			Angles angles1 (loc1,locationA);
+			Angles angles2 (loc2,locationA);
+			if (angle > angles1.phi && angle < angles2.phi && locationB.x > boundaries.xMin && locationB.y > boundaries.yMin
+									&& angles1.phi < M_PI/2 && angles2.phi <M_PI/2 && locationA.x<boundaries.xMax &&
+									locationA.y<boundaries.yMax ) //sjkang1206
+			{
+				return true;
+			}
+		}
+		else if (angle >= -M_PI/2 && angle < 0)
+		{
+			Vector loc1(boundaries.xMin,boundaries.yMin,boundaries.zMin);
+			Vector loc2(boundaries.xMax,boundaries.yMax,boundaries.zMin);
+			Angles angles1 (loc1,locationA);
+			Angles angles2 (loc2,locationA);
+			if (angle >angles1.phi && angle < angles2.phi && locationB.x>boundaries.xMin && locationB.y<boundaries.yMax
+								&& locationA.x < boundaries.xMin  ) //sjkang1206
+			{
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+void
+MmWaveLosTracker::SetLosCacheTolerance (double tolerance)
+{
+	m_losCache.SetTolerance (tolerance);
+}
+
+double
+MmWaveLosTracker::GetLosCacheTolerance (void) const
+{
+	return m_losCache.GetTolerance ();
+}
+
 int
 MmWaveLosTracker::GetNlosSamples (Ptr<MobilityModel> a, Ptr<MobilityModel> b) const
 {
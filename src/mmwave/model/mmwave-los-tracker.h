@@ -23,6 +23,8 @@
 #define MMWAVE_LOS_TRACKER_H
 
 #include <ns3/buildings-propagation-loss-model.h>
+#include <ns3/building-bvh.h>
+#include <ns3/building-los-cache.h>
 #include <ns3/simulator.h>
 
 namespace ns3 {
@@ -44,6 +46,15 @@ public:
 	int GetLosSamples(Ptr<MobilityModel> a, Ptr<MobilityModel> b) const;
 
 private:
+	/**
+	 * \return true if a building blocks the path between a and b
+	 */
+	bool IsBlocked (Vector a, Vector b) const;
+	void SetLosCacheTolerance (double tolerance);
+	double GetLosCacheTolerance (void) const;
+
+	BuildingBvh m_buildingBvh;
+	BuildingLosCache m_losCache;
 	std::map< keyMob_t, int > m_mapNlos; // map for counting number of slots in NLOS for 'drop phase'
 	std::map< keyMob_t, int > m_mapLos; // map for counting number of slots in LOS for 'raise phase'
 };
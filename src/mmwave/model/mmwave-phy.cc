@@ -35,6 +35,7 @@
 #include <ns3/node.h>
 #include <ns3/packet.h>
 #include <ns3/log.h>
+#include <ns3/mpi-interface.h>
 #include "mmwave-phy.h"
 #include "mmwave-phy-sap.h"
 #include "mmwave-mac-pdu-tag.h"
@@ -169,6 +170,16 @@ MmWavePhy::GetDevice ()
 	return m_netDevice;
 }
 
+bool
+MmWavePhy::IsLocal (void) const
+{
+	if (!MpiInterface::IsEnabled () || m_netDevice == 0 || m_netDevice->GetNode () == 0)
+	{
+		return true;
+	}
+	return m_netDevice->GetNode ()->GetSystemId () == MpiInterface::GetSystemId ();
+}
+
 void
 MmWavePhy::SetChannel (Ptr<SpectrumChannel> c)
 {
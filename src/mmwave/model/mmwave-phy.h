@@ -74,6 +74,12 @@ public:
 
 	Ptr<NetDevice> GetDevice ();
 
+	/**
+	 * \return false if the device belongs to another rank of a distributed
+	 * simulation, in which case the PHY is a replica and stays idle
+	 */
+	bool IsLocal (void) const;
+
 	void SetChannel (Ptr<SpectrumChannel> c);
 
 	/**
@@ -120,6 +120,10 @@ MmWaveSpectrumPhy::GetTypeId(void)
 						 "The no. of packets received and transmitted by the User Device",
 						 MakeTraceSourceAccessor (&MmWaveSpectrumPhy::m_rxPacketTraceUe),
 						 "ns3::UeTxRxPacketCount::TracedCallback")
+		.AddTraceSource ("TxDataStart",
+						 "The PSD and duration of each data transmission",
+						 MakeTraceSourceAccessor (&MmWaveSpectrumPhy::m_txDataStartTrace),
+						 "ns3::MmWaveSpectrumPhy::TxDataStartTracedCallback")
 		.AddAttribute ("DataErrorModelEnabled",
 										"Activate/Deactivate the error model of data (TBs of PDSCH and PUSCH) [by default is active].",
 						 BooleanValue (true),
@@ -893,6 +897,7 @@ MmWaveSpectrumPhy::StartTxDataFrames (Ptr<PacketBurst> pb, std::list<Ptr<MmWaveC
 		txParams->slotInd = slotInd;
 		txParams->txAntenna = m_antenna;
 		txParams->nrTxMode = m_nrTxMode; //180615-jskim14-add NR tx mode parameter
+		m_txDataStartTrace (m_txPsd, duration);
 		
 		//NS_LOG_DEBUG ("ctrlMsgList.size () == " << txParams->ctrlMsgList.size ());
 
@@ -1017,6 +1022,13 @@ MmWaveSpectrumPhy::SetHarqPhyModule (Ptr<MmWaveHarqPhy> harq)
   m_harqPhyModule = harq;
 }
 
+void
+MmWaveSpectrumPhy::AddRemoteInterference (Ptr<const SpectrumValue> psd, Time duration)
+{
+	NS_LOG_FUNCTION (this << duration);
+	m_interferenceData->AddSignal (psd, duration);
+}
+
 //180615-jskim14-NR tx mode setting
 void
 MmWaveSpectrumPhy::SetNrTxMode (uint8_t nrTxMode)
@@ -152,6 +152,21 @@ public:
 //	void AddExpectedTb (uint16_t rnti, uint16_t size, uint8_t m_mcs, std::vector<int> chunkMap, bool downlink);
 
 	void SetHarqPhyModule (Ptr<MmWaveHarqPhy> harq);
+
+	/**
+	 * \brief Add interference from transmitters that are not on the channel,
+	 * e.g., the cells of other ranks of a distributed simulation
+	 * \param psd the received PSD
+	 * \param duration the duration of the interference
+	 */
+	void AddRemoteInterference (Ptr<const SpectrumValue> psd, Time duration);
+
+	/**
+	 * TracedCallback signature for the start of a data transmission.
+	 * \param [in] psd the transmitted PSD
+	 * \param [in] duration the duration of the transmission
+	 */
+	typedef void (* TxDataStartTracedCallback)(Ptr<const SpectrumValue> psd, Time duration);
 	bool isAdditionalMmWave =false; //sjkang
 
     void SetNrTxMode (uint8_t nrTxMode); //180615-jskim14-NR tx mode setting
@@ -192,6 +207,7 @@ private:
 
 	TracedCallback<RxPacketTraceParams> m_rxPacketTraceEnb;
 	TracedCallback<RxPacketTraceParams> m_rxPacketTraceUe;
+	TracedCallback<Ptr<const SpectrumValue>, Time> m_txDataStartTrace;
 
 	SpectrumValue m_sinrPerceived;
 
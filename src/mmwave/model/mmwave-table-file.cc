@@ -0,0 +1,341 @@
+ /* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+ /*
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "mmwave-table-file.h"
+#include <ns3/log.h>
+#include <ns3/assert.h>
+#include <ns3/fatal-error.h>
+#include <ns3/global-value.h>
+#include <ns3/string.h>
+#include <ns3/system-path.h>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <map>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("MmWaveTableFile");
+
+static GlobalValue g_tableCacheDirectory = GlobalValue
+	("MmWaveTableCacheDirectory",
+	 "Directory of the binary copies of the mmWave channel tables, "
+	 "ns-3-mmwave-tables in the system temporary directory if empty",
+	 StringValue (""),
+	 MakeStringChecker ());
+
+namespace {
+
+const char g_tableMagic[8] = {'M', 'M', 'W', 'T', 'A', 'B', 'L', '1'};
+const uint32_t g_tableByteOrder = 0x01020304;
+
+struct TableHeader
+{
+	char m_magic[8];
+	uint32_t m_byteOrder; // g_tableByteOrder, written in native order
+	uint32_t m_type;
+	uint64_t m_numRows;
+	uint64_t m_numValues;
+};
+
+/*
+ * Parse one complex token of the text tables, e.g. "1", "0.27616", "-0.15288-0.1584i" or "0.5i"
+ */
+const char *
+ParseComplexToken (const char *p, double &re, double &im)
+{
+	char *end;
+	double first = strtod (p, &end);
+	if (*end == 'i')
+	{
+		re = 0;
+		im = first;
+		return end + 1;
+	}
+	re = first;
+	im = 0;
+	if (end != p && (*end == '+' || *end == '-'))
+	{
+		char *endIm;
+		double second = strtod (end, &endIm);
+		if (*endIm == 'i')
+		{
+			im = second;
+			return endIm + 1;
+		}
+	}
+	return end;
+}
+
+/*
+ * Modification time of a file, false if it does not exist
+ */
+bool
+GetModificationTime (std::string file, time_t &mtime)
+{
+	struct stat st;
+	if (stat (file.c_str (), &st) != 0)
+	{
+		return false;
+	}
+	mtime = st.st_mtime;
+	return true;
+}
+
+/*
+ * The cache directory of the binary tables
+ */
+std::string
+GetCacheDirectory ()
+{
+	StringValue value;
+	g_tableCacheDirectory.GetValue (value);
+	std::string directory = value.Get ();
+	if (directory.empty ())
+	{
+		const char *tmp = getenv ("TMPDIR");
+		directory = SystemPath::Append (tmp != 0 ? tmp : "/tmp", "ns-3-mmwave-tables");
+	}
+	return directory;
+}
+
+} // anonymous namespace
+
+MmWaveTableFile::MmWaveTableFile (ValueType type)
+	: m_type (type),
+	  m_numRows (0),
+	  m_offsets (0),
+	  m_values (0),
+	  m_map (0),
+	  m_mapSize (0)
+{
+}
+
+MmWaveTableFile::~MmWaveTableFile ()
+{
+	if (m_map != 0)
+	{
+		munmap (m_map, m_mapSize);
+	}
+}
+
+std::string
+MmWaveTableFile::GetBinaryFileName (std::string textFile)
+{
+	char *absolute = realpath (textFile.c_str (), 0);
+	std::string name = absolute != 0 ? absolute : textFile;
+	free (absolute);
+	std::replace (name.begin (), name.end (), '/', '_');
+	return SystemPath::Append (GetCacheDirectory (), name + ".bin");
+}
+
+Ptr<const MmWaveTableFile>
+MmWaveTableFile::Get (std::string textFile, ValueType type)
+{
+	// the tables are never modified, so one instance per file serves every channel model of the process
+	static std::map<std::string, Ptr<MmWaveTableFile> > tables;
+	std::map<std::string, Ptr<MmWaveTableFile> >::iterator it = tables.find (textFile);
+	if (it != tables.end ())
+	{
+		NS_ASSERT_MSG (it->second->m_type == type, "table " << textFile << " opened with two value types");
+		return it->second;
+	}
+
+	Ptr<MmWaveTableFile> table = Ptr<MmWaveTableFile> (new MmWaveTableFile (type), false);
+	std::string binaryFile = GetBinaryFileName (textFile);
+	time_t textTime, binaryTime;
+	bool hasText = GetModificationTime (textFile, textTime);
+	bool hasBinary = GetModificationTime (binaryFile, binaryTime);
+	if (hasText && (!hasBinary || binaryTime < textTime))
+	{
+		NS_LOG_INFO ("Converting " << textFile << " to " << binaryFile);
+		SystemPath::MakeDirectories (GetCacheDirectory ());
+		hasBinary = Convert (textFile, binaryFile, type);
+	}
+	if (!hasBinary || !table->Map (binaryFile))
+	{
+		NS_LOG_WARN ("Cannot map " << binaryFile << ", parsing " << textFile);
+		if (!Parse (textFile, type, table->m_ownOffsets, table->m_ownValues))
+		{
+			NS_FATAL_ERROR ("Table file " << textFile << " not found");
+		}
+		table->m_numRows = table->m_ownOffsets.size () - 1;
+		table->m_offsets = table->m_ownOffsets.data ();
+		table->m_values = table->m_ownValues.data ();
+	}
+	NS_LOG_INFO (textFile << " [rows:" << table->m_numRows << "][values:" << table->m_offsets[table->m_numRows] << "]");
+	tables[textFile] = table;
+	return table;
+}
+
+bool
+MmWaveTableFile::Parse (std::string textFile, ValueType type,
+		std::vector<uint64_t> &offsets, std::vector<double> &values)
+{
+	std::ifstream singlefile (textFile.c_str (), std::ifstream::in);
+	if (!singlefile.good ())
+	{
+		return false;
+	}
+	offsets.assign (1, 0);
+	values.clear ();
+	uint64_t numValues = 0;
+	std::string line;
+	while (std::getline (singlefile, line)) //Parse each line of the file
+	{
+		const char *p = line.c_str ();
+		const char *end = p + line.size ();
+		while (p < end && *p != '\r')
+		{
+			if (type == COMPLEX)
+			{
+				double re, im;
+				p = ParseComplexToken (p, re, im);
+				values.push_back (re);
+				values.push_back (im);
+			}
+			else
+			{
+				char *next;
+				values.push_back (strtod (p, &next));
+				p = next;
+			}
+			numValues++;
+			while (p < end && *p != ',') //Skip to the next comma separated token
+			{
+				p++;
+			}
+			if (p < end)
+			{
+				p++;
+			}
+		}
+		offsets.push_back (numValues);
+	}
+	return true;
+}
+
+bool
+MmWaveTableFile::Convert (std::string textFile, std::string binaryFile, ValueType type)
+{
+	std::vector<uint64_t> offsets;
+	std::vector<double> values;
+	if (!Parse (textFile, type, offsets, values))
+	{
+		return false;
+	}
+
+	TableHeader header;
+	memcpy (header.m_magic, g_tableMagic, sizeof (g_tableMagic));
+	header.m_byteOrder = g_tableByteOrder;
+	header.m_type = type;
+	header.m_numRows = offsets.size () - 1;
+	header.m_numValues = offsets.back ();
+
+	std::ostringstream tempFile;
+	tempFile << binaryFile << "." << getpid () << ".tmp";
+	FILE *f = fopen (tempFile.str ().c_str (), "wb");
+	if (f == 0)
+	{
+		return false;
+	}
+	bool ok = fwrite (&header, sizeof (header), 1, f) == 1
+		&& fwrite (offsets.data (), sizeof (uint64_t), offsets.size (), f) == offsets.size ()
+		&& fwrite (values.data (), sizeof (double), values.size (), f) == values.size ();
+	ok = (fclose (f) == 0) && ok;
+	if (!ok || rename (tempFile.str ().c_str (), binaryFile.c_str ()) != 0)
+	{
+		remove (tempFile.str ().c_str ());
+		return false;
+	}
+	return true;
+}
+
+bool
+MmWaveTableFile::Map (std::string binaryFile)
+{
+	int fd = open (binaryFile.c_str (), O_RDONLY);
+	if (fd < 0)
+	{
+		return false;
+	}
+	struct stat st;
+	if (fstat (fd, &st) != 0 || (size_t) st.st_size < sizeof (TableHeader))
+	{
+		close (fd);
+		return false;
+	}
+	void *map = mmap (0, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close (fd);
+	if (map == MAP_FAILED)
+	{
+		return false;
+	}
+
+	const TableHeader *header = static_cast<const TableHeader *> (map);
+	uint64_t valueSize = (m_type == COMPLEX ? 2 : 1) * sizeof (double);
+	uint64_t expectedSize = sizeof (TableHeader) + (header->m_numRows + 1) * sizeof (uint64_t)
+		+ header->m_numValues * valueSize;
+	if (memcmp (header->m_magic, g_tableMagic, sizeof (g_tableMagic)) != 0
+		|| header->m_byteOrder != g_tableByteOrder
+		|| header->m_type != (uint32_t) m_type
+		|| expectedSize != (uint64_t) st.st_size)
+	{
+		munmap (map, st.st_size);
+		return false;
+	}
+
+	m_map = map;
+	m_mapSize = st.st_size;
+	m_numRows = header->m_numRows;
+	m_offsets = reinterpret_cast<const uint64_t *> (header + 1);
+	m_values = reinterpret_cast<const double *> (m_offsets + m_numRows + 1);
+	return true;
+}
+
+uint32_t
+MmWaveTableFile::GetRowSize (uint32_t row) const
+{
+	NS_ASSERT_MSG (row < m_numRows, "row " << row << " out of " << m_numRows);
+	return m_offsets[row + 1] - m_offsets[row];
+}
+
+const double*
+MmWaveTableFile::GetRealRow (uint32_t row) const
+{
+	NS_ASSERT_MSG (m_type == REAL, "not a table of real values");
+	NS_ASSERT_MSG (row < m_numRows, "row " << row << " out of " << m_numRows);
+	return m_values + m_offsets[row];
+}
+
+const std::complex<double>*
+MmWaveTableFile::GetComplexRow (uint32_t row) const
+{
+	NS_ASSERT_MSG (m_type == COMPLEX, "not a table of complex values");
+	NS_ASSERT_MSG (row < m_numRows, "row " << row << " out of " << m_numRows);
+	// std::complex<double> is layout compatible with double[2]
+	return reinterpret_cast<const std::complex<double> *> (m_values) + m_offsets[row];
+}
+
+} // namespace ns3
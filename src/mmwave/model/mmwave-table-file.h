@@ -0,0 +1,141 @@
+ /* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+ /*
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef MMWAVE_TABLE_FILE_H_
+#define MMWAVE_TABLE_FILE_H_
+
+#include <ns3/simple-ref-count.h>
+#include <ns3/ptr.h>
+#include <complex>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace ns3 {
+
+/**
+ * \brief Read-only table of real or complex numbers, memory-mapped from a binary file.
+ *
+ * The input tables of the mmWave channel models (beamforming vectors, spatial
+ * signatures, small scale fading, ray-tracing traces) are comma-separated text
+ * files with one row per line. The first time a table is requested its text file
+ * is converted to a binary file in the cache directory, which is then mapped
+ * read-only. The conversion is done again if the text file is newer. The cache
+ * directory is set by the MmWaveTableCacheDirectory global value, and defaults
+ * to ns-3-mmwave-tables in the system temporary directory, so that the source
+ * tree is never written.
+ * Since the mapping is shared, the pages are loaded once for all the processes
+ * of a parameter sweep, and a table is opened once per process whatever the
+ * number of channel instances.
+ *
+ * Binary layout, in native byte order: a 32-byte header (magic, byte order mark,
+ * type, number of rows, number of values), the row offsets (numRows + 1 uint64_t,
+ * counted in values), then the values as doubles, a complex value being stored
+ * as (real, imaginary) like std::complex<double>.
+ *
+ * If the binary file cannot be written or mapped, the text file is parsed
+ * into memory and the table is used the same way.
+ */
+class MmWaveTableFile : public SimpleRefCount<MmWaveTableFile>
+{
+public:
+	enum ValueType
+	{
+		REAL = 0,
+		COMPLEX = 1
+	};
+
+	~MmWaveTableFile ();
+
+	/**
+	 * Get the table of a text file, shared by all the callers in the process
+	 * @param the path of the comma-separated text file
+	 * @param the type of the values
+	 * @returns the table, it aborts if the file can be neither mapped nor read
+	 */
+	static Ptr<const MmWaveTableFile> Get (std::string textFile, ValueType type);
+
+	/**
+	 * Convert a comma-separated text file to the binary format. The binary file
+	 * is written under a temporary name and then renamed, so that concurrent
+	 * processes never map a partial file
+	 * @param the path of the text file
+	 * @param the path of the binary file
+	 * @param the type of the values
+	 * @returns false if the text file cannot be read or the binary file cannot be written
+	 */
+	static bool Convert (std::string textFile, std::string binaryFile, ValueType type);
+
+	/**
+	 * @returns the name of the binary file converted from a text file, in the
+	 * cache directory. It is made of the absolute path of the text file, so
+	 * that two tables with the same name do not share their binary file
+	 */
+	static std::string GetBinaryFileName (std::string textFile);
+
+	ValueType GetValueType () const { return m_type; }
+	uint32_t GetNumRows () const { return m_numRows; }
+
+	/**
+	 * @returns the number of values of a row
+	 */
+	uint32_t GetRowSize (uint32_t row) const;
+
+	/**
+	 * @returns the first value of a row of a REAL table
+	 */
+	const double* GetRealRow (uint32_t row) const;
+
+	/**
+	 * @returns the first value of a row of a COMPLEX table
+	 */
+	const std::complex<double>* GetComplexRow (uint32_t row) const;
+
+	/**
+	 * @returns true if the table is mapped from its binary file
+	 */
+	bool IsMapped () const { return m_map != 0; }
+
+private:
+	MmWaveTableFile (ValueType type);
+
+	/**
+	 * Map a binary file
+	 * @returns false if the file is missing or does not hold a table of the expected type
+	 */
+	bool Map (std::string binaryFile);
+
+	/**
+	 * Parse a text file into m_ownOffsets and m_ownValues
+	 * @returns false if the file cannot be read
+	 */
+	static bool Parse (std::string textFile, ValueType type,
+			std::vector<uint64_t> &offsets, std::vector<double> &values);
+
+	ValueType m_type;
+	uint32_t m_numRows;
+	const uint64_t *m_offsets; // numRows + 1 offsets in values
+	const double *m_values;
+	void *m_map; // mapped binary file, 0 if the table was parsed
+	size_t m_mapSize;
+	std::vector<uint64_t> m_ownOffsets; // storage of a parsed table
+	std::vector<double> m_ownValues;
+};
+
+} // namespace ns3
+
+#endif /* MMWAVE_TABLE_FILE_H_ */
@@ -392,7 +392,10 @@ NS_LOG_FUNCTION(this);
 	Ptr<SpectrumValue> noisePsd =
 			MmWaveSpectrumValueHelper::CreateNoisePowerSpectralDensity (m_phyMacConfig, m_noiseFigure);
 	m_downlinkSpectrumPhy->SetNoisePowerSpectralDensity (noisePsd);	
-	m_downlinkSpectrumPhy->GetSpectrumChannel()->AddRx(m_downlinkSpectrumPhy);
+	if (IsLocal ())
+	{
+		m_downlinkSpectrumPhy->GetSpectrumChannel()->AddRx(m_downlinkSpectrumPhy);
+	}
 	m_downlinkSpectrumPhy->SetCellId(m_cellId);
 	NS_LOG_INFO("Registered to eNB with CellId " << m_cellId);
 
@@ -571,6 +574,11 @@ void
 MmWaveUePhy::SubframeIndication (uint16_t frameNum, uint8_t sfNum)
 {
 	NS_LOG_FUNCTION(this);
+	if (!IsLocal ())
+	{
+		// replica of a UE of another rank
+		return;
+	}
 	NS_LOG_DEBUG("frameNum " << frameNum << " subframe " << (uint16_t)sfNum << " current frame " << m_frameNum << " current frame " << (uint16_t)m_sfNum);
 //	std::cout << "heeeerreee"<< std::endl;
 	m_frameNum = frameNum;
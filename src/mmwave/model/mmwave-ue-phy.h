@@ -47,6 +47,9 @@
 #include <fstream>
 #include <stdlib.h>
 #include <ns3/random-variable-stream.h>
+
+class MmWaveRemoteUeSinrTestCase;
+
 namespace ns3{
 
 class PacketBurst;
@@ -56,6 +59,7 @@ class MmWaveUePhy : public MmWavePhy
 {
 	friend class UeMemberLteUePhySapProvider;
 	friend class MemberLteUeCphySapProvider<MmWaveUePhy>;
+	friend class ::MmWaveRemoteUeSinrTestCase;
 
 public:
 	MmWaveUePhy ();
@@ -0,0 +1,200 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <ns3/test.h>
+#include <ns3/log.h>
+#include <ns3/random-variable-stream.h>
+#include <ns3/mmwave-beam-sweep.h>
+
+NS_LOG_COMPONENT_DEFINE ("MmWaveBeamSweepTest");
+
+using namespace ns3;
+
+/**
+ * Check that MmWaveBeamSweep selects the same beam pair, with the same gain,
+ * as the per-pair search MmWave3gppChannel used before (long term component
+ * of each pair, then its beamforming gain averaged over the subbands), and
+ * that the hierarchical search falls back to it when every beam is a candidate.
+ */
+class MmWaveBeamSweepTestCase : public TestCase
+{
+public:
+  MmWaveBeamSweepTestCase ();
+  virtual ~MmWaveBeamSweepTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  std::complex<double> RandomComplex (void);
+  ComplexMatrix RandomCodebook (uint16_t antennas, uint16_t beams);
+  static MmWaveBeamSweep::Result PerPairSearch (const complex3DVector_t &channel, const doubleVector_t &delay,
+                                                const ComplexMatrix &txCodebook, const ComplexMatrix &rxCodebook,
+                                                const doubleVector_t &subbandFreq);
+
+  Ptr<UniformRandomVariable> m_random;
+};
+
+MmWaveBeamSweepTestCase::MmWaveBeamSweepTestCase ()
+  : TestCase ("Check the batched beam sweep against the per-pair search")
+{
+}
+
+MmWaveBeamSweepTestCase::~MmWaveBeamSweepTestCase ()
+{
+}
+
+std::complex<double>
+MmWaveBeamSweepTestCase::RandomComplex (void)
+{
+  return std::complex<double> (m_random->GetValue (-1, 1), m_random->GetValue (-1, 1));
+}
+
+ComplexMatrix
+MmWaveBeamSweepTestCase::RandomCodebook (uint16_t antennas, uint16_t beams)
+{
+  ComplexMatrix codebook (antennas, beams);
+  for (uint16_t i = 0; i < antennas; i++)
+    {
+      for (uint16_t j = 0; j < beams; j++)
+        {
+          codebook (i, j) = RandomComplex ();
+        }
+    }
+  return codebook;
+}
+
+MmWaveBeamSweep::Result
+MmWaveBeamSweepTestCase::PerPairSearch (const complex3DVector_t &channel, const doubleVector_t &delay,
+                                        const ComplexMatrix &txCodebook, const ComplexMatrix &rxCodebook,
+                                        const doubleVector_t &subbandFreq)
+{
+  MmWaveBeamSweep::Result result;
+  result.m_txBeam = 0;
+  result.m_rxBeam = 0;
+  result.m_gain = 0;
+  double max = 0;
+  for (uint16_t tx = 0; tx < txCodebook.GetNumCols (); tx++)
+    {
+      for (uint16_t rx = 0; rx < rxCodebook.GetNumCols (); rx++)
+        {
+          // long term component rx^H * H[n] * tx of every cluster
+          complexVector_t longTerm (delay.size ());
+          for (uint16_t n = 0; n < delay.size (); n++)
+            {
+              for (uint16_t u = 0; u < channel.size (); u++)
+                {
+                  for (uint16_t s = 0; s < channel[u].size (); s++)
+                    {
+                      longTerm[n] += std::conj (rxCodebook (u, rx)) * channel[u][s][n] * txCodebook (s, tx);
+                    }
+                }
+            }
+          double power = 0;
+          for (uint16_t sb = 0; sb < subbandFreq.size (); sb++)
+            {
+              std::complex<double> subbandGain (0, 0);
+              for (uint16_t n = 0; n < delay.size (); n++)
+                {
+                  subbandGain += longTerm[n] * std::exp (std::complex<double> (0, -2 * M_PI * subbandFreq[sb] * delay[n]));
+                }
+              power += std::norm (subbandGain);
+            }
+          power /= subbandFreq.size ();
+          if (max < power)
+            {
+              max = power;
+              result.m_txBeam = tx;
+              result.m_rxBeam = rx;
+              result.m_gain = power;
+            }
+        }
+    }
+  return result;
+}
+
+void
+MmWaveBeamSweepTestCase::DoRun (void)
+{
+  m_random = CreateObject<UniformRandomVariable> ();
+  m_random->SetStream (1);
+
+  MmWaveBeamSweep sweep;
+  // tx and rx antennas, clusters, tx and rx beams, subbands
+  const uint16_t configs[][6] = {{1, 1, 1, 1, 1, 1}, {4, 2, 3, 5, 3, 4}, {16, 4, 8, 16, 8, 12}, {64, 16, 19, 33, 17, 25}};
+  for (uint32_t c = 0; c < sizeof (configs) / sizeof (configs[0]); c++)
+    {
+      uint16_t txAntenna = configs[c][0];
+      uint16_t rxAntenna = configs[c][1];
+      uint16_t numCluster = configs[c][2];
+      for (uint32_t trial = 0; trial < 5; trial++)
+        {
+          complex3DVector_t channel (rxAntenna, complex2DVector_t (txAntenna, complexVector_t (numCluster)));
+          for (uint16_t u = 0; u < rxAntenna; u++)
+            {
+              for (uint16_t s = 0; s < txAntenna; s++)
+                {
+                  for (uint16_t n = 0; n < numCluster; n++)
+                    {
+                      channel[u][s][n] = RandomComplex ();
+                    }
+                }
+            }
+          doubleVector_t delay (numCluster);
+          for (uint16_t n = 0; n < numCluster; n++)
+            {
+              delay[n] = m_random->GetValue (0, 1e-6);
+            }
+          doubleVector_t subbandFreq (configs[c][5]);
+          for (uint16_t sb = 0; sb < subbandFreq.size (); sb++)
+            {
+              subbandFreq[sb] = 28e9 - 50e6 + 1e6 * sb;
+            }
+          ComplexMatrix txCodebook = RandomCodebook (txAntenna, configs[c][3]);
+          ComplexMatrix rxCodebook = RandomCodebook (rxAntenna, configs[c][4]);
+
+          MmWaveBeamSweep::Result ref = PerPairSearch (channel, delay, txCodebook, rxCodebook, subbandFreq);
+          for (uint32_t mode = 0; mode < 2; mode++)
+            {
+              // with as many candidates as beams, the coarse stages keep every beam
+              sweep.SetHierarchical (mode == 1, std::max (configs[c][3], configs[c][4]));
+              MmWaveBeamSweep::Result result = sweep.Sweep (channel, delay, txCodebook, rxCodebook, subbandFreq);
+              NS_TEST_ASSERT_MSG_EQ (result.m_txBeam, ref.m_txBeam, "wrong tx beam in configuration " << c);
+              NS_TEST_ASSERT_MSG_EQ (result.m_rxBeam, ref.m_rxBeam, "wrong rx beam in configuration " << c);
+              NS_TEST_ASSERT_MSG_EQ_TOL (result.m_gain, ref.m_gain, ref.m_gain * 1e-9, "wrong gain in configuration " << c);
+            }
+
+          // a reduced hierarchical search never reports more than the best pair
+          sweep.SetHierarchical (true, 2);
+          MmWaveBeamSweep::Result coarse = sweep.Sweep (channel, delay, txCodebook, rxCodebook, subbandFreq);
+          NS_TEST_ASSERT_MSG_EQ ((coarse.m_gain <= ref.m_gain * (1 + 1e-9)), true, "hierarchical gain above the optimum");
+        }
+    }
+}
+
+
+class MmWaveBeamSweepTestSuite : public TestSuite
+{
+public:
+  MmWaveBeamSweepTestSuite ();
+};
+
+MmWaveBeamSweepTestSuite::MmWaveBeamSweepTestSuite ()
+  : TestSuite ("mmwave-beam-sweep", UNIT)
+{
+  AddTestCase (new MmWaveBeamSweepTestCase, TestCase::QUICK);
+}
+
+static MmWaveBeamSweepTestSuite g_mmWaveBeamSweepTestSuite;
@@ -0,0 +1,263 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <ns3/test.h>
+#include <ns3/log.h>
+#include <ns3/random-variable-stream.h>
+#include <ns3/mmwave-complex-matrix.h>
+
+NS_LOG_COMPONENT_DEFINE ("MmWaveComplexMatrixTest");
+
+using namespace ns3;
+
+typedef std::vector< std::vector< std::complex<double> > > RefMatrix;
+
+/**
+ * Check ComplexMatrix (GEMM, whose rows use the AVX2/FMA kernel when the
+ * CPU supports it, and the LU based determinant and inverse) against the
+ * scalar vector-of-vector reference it replaced, on random matrices.
+ */
+class MmWaveComplexMatrixTestCase : public TestCase
+{
+public:
+  MmWaveComplexMatrixTestCase ();
+  virtual ~MmWaveComplexMatrixTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  ComplexMatrix Random (uint16_t rows, uint16_t cols);
+  static RefMatrix ToRef (const ComplexMatrix &m);
+  static RefMatrix RefMultiply (const RefMatrix &a, const RefMatrix &b);
+  static std::complex<double> RefDeterminant (const RefMatrix &a);
+  static RefMatrix RefInverse (const RefMatrix &a);
+  void CheckEqual (const ComplexMatrix &m, const RefMatrix &ref, double tol, std::string what);
+
+  Ptr<UniformRandomVariable> m_random;
+};
+
+MmWaveComplexMatrixTestCase::MmWaveComplexMatrixTestCase ()
+  : TestCase ("Check the ComplexMatrix kernels against the scalar reference")
+{
+}
+
+MmWaveComplexMatrixTestCase::~MmWaveComplexMatrixTestCase ()
+{
+}
+
+ComplexMatrix
+MmWaveComplexMatrixTestCase::Random (uint16_t rows, uint16_t cols)
+{
+  ComplexMatrix m (rows, cols);
+  for (uint16_t i = 0; i < rows; i++)
+    {
+      for (uint16_t j = 0; j < cols; j++)
+        {
+          m (i, j) = std::complex<double> (m_random->GetValue (-1, 1), m_random->GetValue (-1, 1));
+        }
+    }
+  return m;
+}
+
+RefMatrix
+MmWaveComplexMatrixTestCase::ToRef (const ComplexMatrix &m)
+{
+  RefMatrix ref (m.GetNumRows (), std::vector< std::complex<double> > (m.GetNumCols ()));
+  for (uint16_t i = 0; i < m.GetNumRows (); i++)
+    {
+      for (uint16_t j = 0; j < m.GetNumCols (); j++)
+        {
+          ref[i][j] = m (i, j);
+        }
+    }
+  return ref;
+}
+
+RefMatrix
+MmWaveComplexMatrixTestCase::RefMultiply (const RefMatrix &a, const RefMatrix &b)
+{
+  RefMatrix c (a.size (), std::vector< std::complex<double> > (b[0].size ()));
+  for (size_t i = 0; i < a.size (); i++)
+    {
+      for (size_t j = 0; j < b[0].size (); j++)
+        {
+          for (size_t k = 0; k < b.size (); k++)
+            {
+              c[i][j] += a[i][k] * b[k][j];
+            }
+        }
+    }
+  return c;
+}
+
+std::complex<double>
+MmWaveComplexMatrixTestCase::RefDeterminant (const RefMatrix &a)
+{
+  // cofactor expansion along the first row
+  size_t n = a.size ();
+  if (n == 1)
+    {
+      return a[0][0];
+    }
+  std::complex<double> det (0, 0);
+  for (size_t j = 0; j < n; j++)
+    {
+      RefMatrix minor (n - 1);
+      for (size_t i = 1; i < n; i++)
+        {
+          for (size_t k = 0; k < n; k++)
+            {
+              if (k != j)
+                {
+                  minor[i - 1].push_back (a[i][k]);
+                }
+            }
+        }
+      double sign = (j % 2 == 0) ? 1.0 : -1.0;
+      det += sign * a[0][j] * RefDeterminant (minor);
+    }
+  return det;
+}
+
+RefMatrix
+MmWaveComplexMatrixTestCase::RefInverse (const RefMatrix &a)
+{
+  // adjugate divided by the determinant
+  size_t n = a.size ();
+  std::complex<double> det = RefDeterminant (a);
+  RefMatrix inv (n, std::vector< std::complex<double> > (n));
+  for (size_t i = 0; i < n; i++)
+    {
+      for (size_t j = 0; j < n; j++)
+        {
+          RefMatrix minor (n - 1);
+          for (size_t r = 0, mr = 0; r < n; r++)
+            {
+              if (r == i)
+                {
+                  continue;
+                }
+              for (size_t c = 0; c < n; c++)
+                {
+                  if (c != j)
+                    {
+                      minor[mr].push_back (a[r][c]);
+                    }
+                }
+              mr++;
+            }
+          double sign = ((i + j) % 2 == 0) ? 1.0 : -1.0;
+          std::complex<double> cofactor = (n == 1) ? std::complex<double> (1, 0) : sign * RefDeterminant (minor);
+          inv[j][i] = cofactor / det;
+        }
+    }
+  return inv;
+}
+
+void
+MmWaveComplexMatrixTestCase::CheckEqual (const ComplexMatrix &m, const RefMatrix &ref, double tol, std::string what)
+{
+  NS_TEST_ASSERT_MSG_EQ (m.GetNumRows (), ref.size (), what << ": wrong number of rows");
+  for (uint16_t i = 0; i < m.GetNumRows (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (m.GetNumCols (), ref[i].size (), what << ": wrong number of columns");
+      for (uint16_t j = 0; j < m.GetNumCols (); j++)
+        {
+          NS_TEST_ASSERT_MSG_EQ_TOL (m (i, j).real (), ref[i][j].real (), tol, what << " (" << i << "," << j << ")");
+          NS_TEST_ASSERT_MSG_EQ_TOL (m (i, j).imag (), ref[i][j].imag (), tol, what << " (" << i << "," << j << ")");
+        }
+    }
+}
+
+void
+MmWaveComplexMatrixTestCase::DoRun (void)
+{
+  m_random = CreateObject<UniformRandomVariable> ();
+  m_random->SetStream (1);
+
+  // odd and even sizes, so that the tail of the two-column kernel is covered
+  const uint16_t sizes[] = {1, 2, 3, 4, 7, 8, 16, 17, 64};
+  const uint32_t nSizes = sizeof (sizes) / sizeof (sizes[0]);
+  ComplexMatrix c;
+  for (uint32_t s = 0; s < nSizes; s++)
+    {
+      for (uint32_t t = 0; t < nSizes; t++)
+        {
+          ComplexMatrix a = Random (sizes[s], sizes[t]);
+          ComplexMatrix b = Random (sizes[t], sizes[(s + t) % nSizes]);
+          RefMatrix ref = RefMultiply (ToRef (a), ToRef (b));
+          // the reused result keeps its storage when its size matches
+          ComplexMatrix::Multiply (a, b, c);
+          CheckEqual (c, ref, 1e-12, "GEMM");
+          ComplexMatrix::Multiply (a, b, c);
+          CheckEqual (c, ref, 1e-12, "GEMM into a matrix of the same size");
+          CheckEqual (ComplexMatrix::Multiply (a, b), ref, 1e-12, "GEMM by value");
+        }
+    }
+
+  ComplexMatrix h = Random (5, 3);
+  ComplexMatrix hT = h.Transpose ();
+  ComplexMatrix hH = h.Hermitian ();
+  for (uint16_t i = 0; i < 5; i++)
+    {
+      for (uint16_t j = 0; j < 3; j++)
+        {
+          NS_TEST_ASSERT_MSG_EQ ((hT (j, i) == h (i, j)), true, "wrong transpose");
+          NS_TEST_ASSERT_MSG_EQ ((hH (j, i) == std::conj (h (i, j))), true, "wrong Hermitian transpose");
+        }
+    }
+
+  // the cofactor reference is exponential, keep the LU checks small
+  for (uint16_t n = 1; n <= 7; n++)
+    {
+      for (uint32_t trial = 0; trial < 10; trial++)
+        {
+          ComplexMatrix a = Random (n, n);
+          RefMatrix ref = ToRef (a);
+          std::complex<double> det = a.Determinant ();
+          std::complex<double> refDet = RefDeterminant (ref);
+          NS_TEST_ASSERT_MSG_EQ_TOL (det.real (), refDet.real (), 1e-9, "wrong determinant of size " << n);
+          NS_TEST_ASSERT_MSG_EQ_TOL (det.imag (), refDet.imag (), 1e-9, "wrong determinant of size " << n);
+          if (std::abs (refDet) > 1e-3)
+            {
+              CheckEqual (a.Inverse (), RefInverse (ref), 1e-6, "inverse");
+            }
+        }
+    }
+
+  // a singular matrix has a null determinant
+  ComplexMatrix singular = Random (4, 4);
+  for (uint16_t j = 0; j < 4; j++)
+    {
+      singular (3, j) = singular (1, j) * 2.0;
+    }
+  NS_TEST_ASSERT_MSG_EQ_TOL (std::abs (singular.Determinant ()), 0.0, 1e-12, "singular matrix with a non null determinant");
+}
+
+
+class MmWaveComplexMatrixTestSuite : public TestSuite
+{
+public:
+  MmWaveComplexMatrixTestSuite ();
+};
+
+MmWaveComplexMatrixTestSuite::MmWaveComplexMatrixTestSuite ()
+  : TestSuite ("mmwave-complex-matrix", UNIT)
+{
+  AddTestCase (new MmWaveComplexMatrixTestCase, TestCase::QUICK);
+}
+
+static MmWaveComplexMatrixTestSuite g_mmWaveComplexMatrixTestSuite;
@@ -0,0 +1,385 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <ns3/test.h>
+#include <ns3/log.h>
+#include <ns3/boolean.h>
+#include <ns3/mmwave-phy-mac-common.h>
+#include <ns3/mmwave-mac-sched-sap.h>
+#include <ns3/mmwave-mac-csched-sap.h>
+#include <ns3/mmwave-flex-tti-mac-scheduler.h>
+
+NS_LOG_COMPONENT_DEFINE ("MmWaveFlexTtiSchedulerTest");
+
+using namespace ns3;
+
+/**
+ * Drive MmWaveFlexTtiMacScheduler through its SAPs with CQI, RLC buffer,
+ * BSR and HARQ feedback sequences, and check the slots it allocates: new
+ * DL and UL transmissions, DL and UL retransmissions, the HARQ feedback of
+ * a UE without HARQ state, and a UE taking over the entry of a released one.
+ */
+class MmWaveFlexTtiSchedulerTestCase : public TestCase
+{
+public:
+  MmWaveFlexTtiSchedulerTestCase ();
+  virtual ~MmWaveFlexTtiSchedulerTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /// Stores the last allocation of the scheduler.
+  class SchedSapUser : public MmWaveMacSchedSapUser
+  {
+  public:
+    virtual void SchedConfigInd (const struct SchedConfigIndParameters& params);
+
+    SchedConfigIndParameters m_params; ///< the last allocation
+  };
+
+  /// Ignores the confirmations of the scheduler.
+  class CschedSapUser : public MmWaveMacCschedSapUser
+  {
+  public:
+    virtual void CschedCellConfigCnf (const struct CschedCellConfigCnfParameters& params);
+    virtual void CschedUeConfigCnf (const struct CschedUeConfigCnfParameters& params);
+    virtual void CschedLcConfigCnf (const struct CschedLcConfigCnfParameters& params);
+    virtual void CschedLcReleaseCnf (const struct CschedLcReleaseCnfParameters& params);
+    virtual void CschedUeReleaseCnf (const struct CschedUeReleaseCnfParameters& params);
+    virtual void CschedUeConfigUpdateInd (const struct CschedUeConfigUpdateIndParameters& params);
+    virtual void CschedCellConfigUpdateInd (const struct CschedCellConfigUpdateIndParameters& params);
+  };
+
+  void ConfigureUe (uint16_t rnti);
+  void ReleaseUe (uint16_t rnti);
+  void DlCqi (uint16_t rnti, uint8_t cqi);
+  void DlRlcBuffer (uint16_t rnti, uint8_t lcid, uint32_t txQueueSize);
+  void Bsr (uint16_t rnti, uint8_t bsrId);
+  void UlCqi (SfnSf sfnSf, double sinr);
+
+  /**
+   * Schedule the next subframe.
+   *
+   * \param dlHarq the DL HARQ feedback of the subframe
+   * \param ulHarq the UL HARQ feedback of the subframe
+   * \return the number of slots allocated, control slots included
+   */
+  uint32_t Trigger (std::vector<DlHarqInfo> dlHarq = std::vector<DlHarqInfo> (),
+                    std::vector<UlHarqInfo> ulHarq = std::vector<UlHarqInfo> ());
+
+  /**
+   * Check a data slot of the last allocation.
+   *
+   * \param slot the index of the slot in the allocation
+   * \param tddMode SlotAllocInfo::DL or SlotAllocInfo::UL
+   * \param rnti the RNTI of the UE
+   * \param symStart the first symbol of the slot
+   * \param numSym the number of symbols of the slot
+   * \param mcs the MCS of the DCI
+   * \param harqProcess the HARQ process of the DCI
+   * \param rv the redundancy version of the DCI
+   */
+  void CheckSlot (uint32_t slot, SlotAllocInfo::TddMode tddMode, uint16_t rnti,
+                  uint8_t symStart, uint8_t numSym, uint8_t mcs,
+                  uint8_t harqProcess, uint8_t rv);
+
+  static DlHarqInfo MakeDlHarq (uint16_t rnti, uint8_t harqProcess, DlHarqInfo::HarqStatus status);
+  static UlHarqInfo MakeUlHarq (uint16_t rnti, uint8_t harqProcess, UlHarqInfo::ReceptionStatus status);
+
+  Ptr<MmWavePhyMacCommon> m_config;
+  Ptr<MmWaveFlexTtiMacScheduler> m_scheduler;
+  SchedSapUser m_schedSapUser;
+  CschedSapUser m_cschedSapUser;
+  SfnSf m_sfnSf; ///< the next subframe to schedule
+};
+
+void
+MmWaveFlexTtiSchedulerTestCase::SchedSapUser::SchedConfigInd (const struct SchedConfigIndParameters& params)
+{
+  m_params = params;
+}
+
+void
+MmWaveFlexTtiSchedulerTestCase::CschedSapUser::CschedCellConfigCnf (const struct CschedCellConfigCnfParameters& params)
+{
+}
+
+void
+MmWaveFlexTtiSchedulerTestCase::CschedSapUser::CschedUeConfigCnf (const struct CschedUeConfigCnfParameters& params)
+{
+}
+
+void
+MmWaveFlexTtiSchedulerTestCase::CschedSapUser::CschedLcConfigCnf (const struct CschedLcConfigCnfParameters& params)
+{
+}
+
+void
+MmWaveFlexTtiSchedulerTestCase::CschedSapUser::CschedLcReleaseCnf (const struct CschedLcReleaseCnfParameters& params)
+{
+}
+
+void
+MmWaveFlexTtiSchedulerTestCase::CschedSapUser::CschedUeReleaseCnf (const struct CschedUeReleaseCnfParameters& params)
+{
+}
+
+void
+MmWaveFlexTtiSchedulerTestCase::CschedSapUser::CschedUeConfigUpdateInd (const struct CschedUeConfigUpdateIndParameters& params)
+{
+}
+
+void
+MmWaveFlexTtiSchedulerTestCase::CschedSapUser::CschedCellConfigUpdateInd (const struct CschedCellConfigUpdateIndParameters& params)
+{
+}
+
+MmWaveFlexTtiSchedulerTestCase::MmWaveFlexTtiSchedulerTestCase ()
+  : TestCase ("Check the slots allocated by the flex TTI scheduler")
+{
+}
+
+MmWaveFlexTtiSchedulerTestCase::~MmWaveFlexTtiSchedulerTestCase ()
+{
+}
+
+void
+MmWaveFlexTtiSchedulerTestCase::ConfigureUe (uint16_t rnti)
+{
+  MmWaveMacCschedSapProvider::CschedUeConfigReqParameters params;
+  params.m_rnti = rnti;
+  params.m_transmissionMode = 0;
+  m_scheduler->GetMacCschedSapProvider ()->CschedUeConfigReq (params);
+}
+
+void
+MmWaveFlexTtiSchedulerTestCase::ReleaseUe (uint16_t rnti)
+{
+  MmWaveMacCschedSapProvider::CschedUeReleaseReqParameters params;
+  params.m_rnti = rnti;
+  m_scheduler->GetMacCschedSapProvider ()->CschedUeReleaseReq (params);
+}
+
+void
+MmWaveFlexTtiSchedulerTestCase::DlCqi (uint16_t rnti, uint8_t cqi)
+{
+  DlCqiInfo info;
+  info.m_rnti = rnti;
+  info.m_ri = 1;
+  info.m_cqiType = DlCqiInfo::WB;
+  info.m_wbCqi = cqi;
+  info.m_wbPmi = 0;
+  MmWaveMacSchedSapProvider::SchedDlCqiInfoReqParameters params;
+  params.m_sfnsf = m_sfnSf;
+  params.m_cqiList.push_back (info);
+  m_scheduler->GetMacSchedSapProvider ()->SchedDlCqiInfoReq (params);
+}
+
+void
+MmWaveFlexTtiSchedulerTestCase::DlRlcBuffer (uint16_t rnti, uint8_t lcid, uint32_t txQueueSize)
+{
+  MmWaveMacSchedSapProvider::SchedDlRlcBufferReqParameters params;
+  params.m_rnti = rnti;
+  params.m_logicalChannelIdentity = lcid;
+  params.m_rlcTransmissionQueueSize = txQueueSize;
+  params.m_rlcTransmissionQueueHolDelay = 0;
+  params.m_rlcRetransmissionQueueSize = 0;
+  params.m_rlcRetransmissionHolDelay = 0;
+  params.m_rlcStatusPduSize = 0;
+  params.m_arrivalRate = 0;
+  m_scheduler->GetMacSchedSapProvider ()->SchedDlRlcBufferReq (params);
+}
+
+void
+MmWaveFlexTtiSchedulerTestCase::Bsr (uint16_t rnti, uint8_t bsrId)
+{
+  MacCeElement bsr;
+  bsr.m_rnti = rnti;
+  bsr.m_macCeType = MacCeElement::BSR;
+  bsr.m_macCeValue.m_phr = 0;
+  bsr.m_macCeValue.m_crnti = 0;
+  bsr.m_macCeValue.m_bufferStatus.push_back (bsrId);
+  bsr.m_macCeValue.m_bufferStatus.resize (4, 0);
+  MmWaveMacSchedSapProvider::SchedUlMacCtrlInfoReqParameters params;
+  params.m_sfnSf = m_sfnSf;
+  params.m_macCeList.push_back (bsr);
+  m_scheduler->GetMacSchedSapProvider ()->SchedUlMacCtrlInfoReq (params);
+}
+
+void
+MmWaveFlexTtiSchedulerTestCase::UlCqi (SfnSf sfnSf, double sinr)
+{
+  MmWaveMacSchedSapProvider::SchedUlCqiInfoReqParameters params;
+  params.m_sfnSf = sfnSf;
+  params.m_ulCqi.m_type = UlCqiInfo::PUSCH;
+  params.m_ulCqi.m_sinr.assign (m_config->GetTotalNumChunk (), sinr);
+  m_scheduler->GetMacSchedSapProvider ()->SchedUlCqiInfoReq (params);
+}
+
+uint32_t
+MmWaveFlexTtiSchedulerTestCase::Trigger (std::vector<DlHarqInfo> dlHarq, std::vector<UlHarqInfo> ulHarq)
+{
+  MmWaveMacSchedSapProvider::SchedTriggerReqParameters params;
+  params.m_snfSf = m_sfnSf;
+  params.m_dlHarqInfoList = dlHarq;
+  params.m_ulHarqInfoList = ulHarq;
+  m_schedSapUser.m_params.m_sfAllocInfo.m_slotAllocInfo.clear ();
+  m_scheduler->GetMacSchedSapProvider ()->SchedTriggerReq (params);
+  m_sfnSf.m_sfNum++;
+  return m_schedSapUser.m_params.m_sfAllocInfo.m_slotAllocInfo.size ();
+}
+
+void
+MmWaveFlexTtiSchedulerTestCase::CheckSlot (uint32_t slot, SlotAllocInfo::TddMode tddMode, uint16_t rnti,
+                                           uint8_t symStart, uint8_t numSym, uint8_t mcs,
+                                           uint8_t harqProcess, uint8_t rv)
+{
+  const std::deque<SlotAllocInfo> &slots = m_schedSapUser.m_params.m_sfAllocInfo.m_slotAllocInfo;
+  NS_TEST_ASSERT_MSG_LT (slot, slots.size (), "missing slot " << slot);
+  const SlotAllocInfo &info = slots[slot];
+  NS_TEST_EXPECT_MSG_EQ (info.m_tddMode, tddMode, "wrong direction of slot " << slot);
+  NS_TEST_EXPECT_MSG_EQ (info.m_slotType, SlotAllocInfo::CTRL_DATA, "wrong type of slot " << slot);
+  NS_TEST_EXPECT_MSG_EQ (info.m_rnti, rnti, "wrong RNTI of slot " << slot);
+  NS_TEST_EXPECT_MSG_EQ (info.m_dci.m_rnti, rnti, "wrong DCI RNTI of slot " << slot);
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t) info.m_dci.m_symStart, (uint32_t) symStart, "wrong first symbol of slot " << slot);
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t) info.m_dci.m_numSym, (uint32_t) numSym, "wrong number of symbols of slot " << slot);
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t) info.m_dci.m_mcs, (uint32_t) mcs, "wrong MCS of slot " << slot);
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t) info.m_dci.m_harqProcess, (uint32_t) harqProcess, "wrong HARQ process of slot " << slot);
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t) info.m_dci.m_rv, (uint32_t) rv, "wrong redundancy version of slot " << slot);
+  uint32_t ndi = (rv == 0);
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t) info.m_dci.m_ndi, ndi, "wrong new data indicator of slot " << slot);
+}
+
+DlHarqInfo
+MmWaveFlexTtiSchedulerTestCase::MakeDlHarq (uint16_t rnti, uint8_t harqProcess, DlHarqInfo::HarqStatus status)
+{
+  DlHarqInfo info;
+  info.m_rnti = rnti;
+  info.m_harqProcessId = harqProcess;
+  info.m_harqStatus = status;
+  info.m_numRetx = 0;
+  return info;
+}
+
+UlHarqInfo
+MmWaveFlexTtiSchedulerTestCase::MakeUlHarq (uint16_t rnti, uint8_t harqProcess, UlHarqInfo::ReceptionStatus status)
+{
+  UlHarqInfo info;
+  info.m_rnti = rnti;
+  info.m_harqProcessId = harqProcess;
+  info.m_receptionStatus = status;
+  info.m_tpc = 0;
+  info.m_numRetx = 0;
+  return info;
+}
+
+void
+MmWaveFlexTtiSchedulerTestCase::DoRun (void)
+{
+  m_config = CreateObject<MmWavePhyMacCommon> ();
+  m_scheduler = CreateObject<MmWaveFlexTtiMacScheduler> ();
+  m_scheduler->SetAttribute ("HarqEnabled", BooleanValue (true));
+  m_scheduler->ConfigureCommonParameters (m_config);
+  m_scheduler->SetMacSchedSapUser (&m_schedSapUser);
+  m_scheduler->SetMacCschedSapUser (&m_cschedSapUser);
+  ConfigureUe (1);
+  ConfigureUe (2);
+
+  // nothing to send: the control slots only
+  uint32_t numSlots = Trigger ();
+  NS_TEST_ASSERT_MSG_EQ (numSlots, 2, "slots allocated without data");
+
+  // DL data of UE 1 at the MCS of its CQI
+  DlCqi (1, 15);
+  DlRlcBuffer (1, 3, 100);
+  numSlots = Trigger ();
+  NS_TEST_ASSERT_MSG_EQ (numSlots, 3, "wrong number of slots for the DL data");
+  CheckSlot (1, SlotAllocInfo::DL, 1, 1, 1, 28, 0, 0);
+  uint32_t dlTbSize = m_schedSapUser.m_params.m_sfAllocInfo.m_slotAllocInfo[1].m_dci.m_tbSize;
+
+  // UL data of UE 2, at MCS 0 without UL CQI
+  SfnSf ulSfnSf = m_sfnSf;
+  Bsr (2, 16);
+  numSlots = Trigger ();
+  NS_TEST_ASSERT_MSG_EQ (numSlots, 3, "wrong number of slots for the UL data");
+  CheckSlot (1, SlotAllocInfo::UL, 2, 1, 3, 0, 0, 0);
+  uint32_t ulTbSize = m_schedSapUser.m_params.m_sfAllocInfo.m_slotAllocInfo[1].m_dci.m_tbSize;
+
+  // NACKs: both TBs are retransmitted with the same DCI, the UL HARQ feedback
+  // of UE 3, which has no HARQ state, is dropped
+  std::vector<DlHarqInfo> dlHarq;
+  dlHarq.push_back (MakeDlHarq (1, 0, DlHarqInfo::NACK));
+  std::vector<UlHarqInfo> ulHarq;
+  ulHarq.push_back (MakeUlHarq (3, 0, UlHarqInfo::NotOk));
+  ulHarq.push_back (MakeUlHarq (2, 0, UlHarqInfo::NotOk));
+  numSlots = Trigger (dlHarq, ulHarq);
+  NS_TEST_ASSERT_MSG_EQ (numSlots, 4, "wrong number of slots for the retransmissions");
+  CheckSlot (1, SlotAllocInfo::DL, 1, 1, 1, 28, 0, 1);
+  CheckSlot (2, SlotAllocInfo::UL, 2, 2, 3, 0, 0, 1);
+  uint32_t tbSize = m_schedSapUser.m_params.m_sfAllocInfo.m_slotAllocInfo[1].m_dci.m_tbSize;
+  NS_TEST_EXPECT_MSG_EQ (tbSize, dlTbSize, "wrong TB size of the DL retransmission");
+  NS_TEST_EXPECT_MSG_EQ (m_schedSapUser.m_params.m_sfAllocInfo.m_slotAllocInfo[1].m_rlcPduInfo.size (), 1,
+                         "the DL retransmission lost its RLC PDUs");
+  tbSize = m_schedSapUser.m_params.m_sfAllocInfo.m_slotAllocInfo[2].m_dci.m_tbSize;
+  NS_TEST_EXPECT_MSG_EQ (tbSize, ulTbSize, "wrong TB size of the UL retransmission");
+
+  // the ACKs release the processes, which the next new data reuses; the UL
+  // CQI measured on the first UL slot raises the UL MCS of UE 2
+  dlHarq.clear ();
+  dlHarq.push_back (MakeDlHarq (1, 0, DlHarqInfo::ACK));
+  ulHarq.clear ();
+  ulHarq.push_back (MakeUlHarq (2, 0, UlHarqInfo::Ok));
+  ulSfnSf.m_slotNum = 1;
+  UlCqi (ulSfnSf, 1000.0);
+  DlRlcBuffer (1, 3, 100);
+  Bsr (2, 16);
+  numSlots = Trigger (dlHarq, ulHarq);
+  NS_TEST_ASSERT_MSG_EQ (numSlots, 4, "wrong number of slots after the ACKs");
+  CheckSlot (1, SlotAllocInfo::DL, 1, 1, 1, 28, 0, 0);
+  CheckSlot (2, SlotAllocInfo::UL, 2, 2, 1, 28, 0, 0);
+
+  // UE 4 takes over the entry of UE 3, released with a busy UL HARQ process
+  ConfigureUe (3);
+  Bsr (3, 16);
+  numSlots = Trigger ();
+  NS_TEST_ASSERT_MSG_EQ (numSlots, 3, "wrong number of slots for the UL data of UE 3");
+  CheckSlot (1, SlotAllocInfo::UL, 3, 1, 3, 0, 0, 0);
+  ReleaseUe (3);
+  ConfigureUe (4);
+  Bsr (4, 16);
+  ulHarq.clear ();
+  ulHarq.push_back (MakeUlHarq (3, 0, UlHarqInfo::NotOk));
+  numSlots = Trigger (std::vector<DlHarqInfo> (), ulHarq);
+  NS_TEST_ASSERT_MSG_EQ (numSlots, 3, "wrong number of slots for the UL data of UE 4");
+  CheckSlot (1, SlotAllocInfo::UL, 4, 1, 3, 0, 0, 0);
+
+  m_scheduler->Dispose ();
+}
+
+
+class MmWaveFlexTtiSchedulerTestSuite : public TestSuite
+{
+public:
+  MmWaveFlexTtiSchedulerTestSuite ();
+};
+
+MmWaveFlexTtiSchedulerTestSuite::MmWaveFlexTtiSchedulerTestSuite ()
+  : TestSuite ("mmwave-flex-tti-scheduler", UNIT)
+{
+  AddTestCase (new MmWaveFlexTtiSchedulerTestCase, TestCase::QUICK);
+}
+
+static MmWaveFlexTtiSchedulerTestSuite g_mmWaveFlexTtiSchedulerTestSuite;
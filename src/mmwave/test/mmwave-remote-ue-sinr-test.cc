@@ -0,0 +1,125 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <ns3/test.h>
+#include <ns3/log.h>
+#include <ns3/simulator.h>
+#include <ns3/pointer.h>
+#include <ns3/node.h>
+#include <ns3/simple-net-device.h>
+#include <ns3/lte-enb-cphy-sap.h>
+#include <ns3/mmwave-phy-mac-common.h>
+#include <ns3/mmwave-spectrum-phy.h>
+#include <ns3/mmwave-enb-phy.h>
+#include <ns3/mmwave-ue-phy.h>
+#include <ns3/mmwave-ue-net-device.h>
+
+NS_LOG_COMPONENT_DEFINE ("MmWaveRemoteUeSinrTest");
+
+using namespace ns3;
+
+/**
+ * Attach to an eNB PHY a UE whose node has another SystemId, as the replica
+ * of a UE simulated by another rank, and check that the periodic SINR
+ * estimate neither reports this UE to the RRC nor updates its PHY.
+ */
+class MmWaveRemoteUeSinrTestCase : public TestCase
+{
+public:
+  MmWaveRemoteUeSinrTestCase ();
+  virtual ~MmWaveRemoteUeSinrTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /// Stores the SINR estimates reported by the eNB PHY.
+  class SinrSapUser : public LteEnbCphySapUser
+  {
+  public:
+    virtual void UpdateUeSinrEstimate (LteEnbCphySapUser::UeAssociatedSinrInfo info);
+
+    uint32_t m_reports;                   ///< number of reports
+    std::map<uint64_t, double> m_sinrMap; ///< SINR of the last report, by IMSI
+  };
+};
+
+void
+MmWaveRemoteUeSinrTestCase::SinrSapUser::UpdateUeSinrEstimate (LteEnbCphySapUser::UeAssociatedSinrInfo info)
+{
+  m_reports++;
+  m_sinrMap = info.ueImsiSinrMap;
+}
+
+MmWaveRemoteUeSinrTestCase::MmWaveRemoteUeSinrTestCase ()
+  : TestCase ("Check that the eNB SINR estimate skips the UEs of another rank")
+{
+}
+
+MmWaveRemoteUeSinrTestCase::~MmWaveRemoteUeSinrTestCase ()
+{
+}
+
+void
+MmWaveRemoteUeSinrTestCase::DoRun (void)
+{
+  Ptr<MmWavePhyMacCommon> config = CreateObject<MmWavePhyMacCommon> ();
+
+  Ptr<Node> enbNode = CreateObject<Node> (0);
+  Ptr<SimpleNetDevice> enbDevice = CreateObject<SimpleNetDevice> ();
+  enbNode->AddDevice (enbDevice);
+  Ptr<MmWaveEnbPhy> enbPhy = CreateObject<MmWaveEnbPhy> (CreateObject<MmWaveSpectrumPhy> (),
+                                                         CreateObject<MmWaveSpectrumPhy> ());
+  enbPhy->SetConfigurationParameters (config);
+  enbPhy->SetDevice (enbDevice);
+  SinrSapUser sapUser;
+  sapUser.m_reports = 0;
+  enbPhy->SetMmWaveEnbCphySapUser (&sapUser);
+
+  // the replica of a UE of rank 1
+  Ptr<Node> ueNode = CreateObject<Node> (1);
+  Ptr<MmWaveUePhy> uePhy = CreateObject<MmWaveUePhy> (CreateObject<MmWaveSpectrumPhy> (),
+                                                      CreateObject<MmWaveSpectrumPhy> ());
+  Ptr<MmWaveUeNetDevice> ueDevice = CreateObject<MmWaveUeNetDevice> ();
+  ueDevice->SetAttribute ("MmWaveUePhy", PointerValue (uePhy));
+  ueNode->AddDevice (ueDevice);
+  uePhy->SetDevice (ueDevice);
+  enbPhy->AddUePhy (1, ueDevice);
+
+  // the UE PHYs are updated every other estimate with the default periods
+  enbPhy->UpdateUeSinrEstimate ();
+  enbPhy->UpdateUeSinrEstimate ();
+
+  NS_TEST_ASSERT_MSG_EQ (sapUser.m_reports, 2, "wrong number of SINR reports");
+  NS_TEST_ASSERT_MSG_EQ (sapUser.m_sinrMap.size (), 0, "the UE of another rank is reported to the RRC");
+  NS_TEST_ASSERT_MSG_EQ (uePhy->m_cellSinrMap.size (), 0, "the PHY of the UE of another rank is updated");
+
+  Simulator::Destroy ();
+}
+
+
+class MmWaveRemoteUeSinrTestSuite : public TestSuite
+{
+public:
+  MmWaveRemoteUeSinrTestSuite ();
+};
+
+MmWaveRemoteUeSinrTestSuite::MmWaveRemoteUeSinrTestSuite ()
+  : TestSuite ("mmwave-remote-ue-sinr", UNIT)
+{
+  AddTestCase (new MmWaveRemoteUeSinrTestCase, TestCase::QUICK);
+}
+
+static MmWaveRemoteUeSinrTestSuite g_mmWaveRemoteUeSinrTestSuite;
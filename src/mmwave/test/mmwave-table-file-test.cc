@@ -0,0 +1,154 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <ns3/test.h>
+#include <ns3/log.h>
+#include <ns3/config.h>
+#include <ns3/string.h>
+#include <ns3/system-path.h>
+#include <ns3/mmwave-table-file.h>
+#include <fstream>
+#include <cstdio>
+
+NS_LOG_COMPONENT_DEFINE ("MmWaveTableFileTest");
+
+using namespace ns3;
+
+/**
+ * Convert a real and a complex text table to their binary files in the
+ * cache directory, map them and check the values read back, including the
+ * empty rows, the Windows line endings and the forms of the complex tokens.
+ */
+class MmWaveTableFileTestCase : public TestCase
+{
+public:
+  MmWaveTableFileTestCase ();
+  virtual ~MmWaveTableFileTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Write a text table
+   * \param file the path of the file
+   * \param content the content of the file
+   */
+  static void WriteFile (std::string file, std::string content);
+
+  /**
+   * Check that a table is mapped from a binary file of the cache directory
+   * \param table the table
+   * \param textFile the path of its text file
+   * \param cacheDirectory the cache directory
+   */
+  void CheckMapped (Ptr<const MmWaveTableFile> table, std::string textFile, std::string cacheDirectory);
+};
+
+MmWaveTableFileTestCase::MmWaveTableFileTestCase ()
+  : TestCase ("Check the text to binary round trip of the mmWave tables")
+{
+}
+
+MmWaveTableFileTestCase::~MmWaveTableFileTestCase ()
+{
+}
+
+void
+MmWaveTableFileTestCase::WriteFile (std::string file, std::string content)
+{
+  std::ofstream out (file.c_str ());
+  out << content;
+}
+
+void
+MmWaveTableFileTestCase::CheckMapped (Ptr<const MmWaveTableFile> table, std::string textFile, std::string cacheDirectory)
+{
+  std::string binaryFile = MmWaveTableFile::GetBinaryFileName (textFile);
+  NS_TEST_ASSERT_MSG_EQ (binaryFile.compare (0, cacheDirectory.size (), cacheDirectory), 0,
+                         binaryFile << " is not in the cache directory");
+  NS_TEST_ASSERT_MSG_EQ (std::ifstream (binaryFile.c_str ()).good (), true, binaryFile << " was not written");
+  NS_TEST_ASSERT_MSG_EQ (std::ifstream ((textFile + ".bin").c_str ()).good (), false, "a binary file was written next to " << textFile);
+  NS_TEST_ASSERT_MSG_EQ (table->IsMapped (), true, textFile << " is not mapped");
+  std::remove (binaryFile.c_str ());
+}
+
+void
+MmWaveTableFileTestCase::DoRun (void)
+{
+  std::string directory = SystemPath::MakeTemporaryDirectoryName ();
+  std::string textDirectory = SystemPath::Append (directory, "tables");
+  std::string cacheDirectory = SystemPath::Append (directory, "cache");
+  SystemPath::MakeDirectories (textDirectory);
+  Config::SetGlobal ("MmWaveTableCacheDirectory", StringValue (cacheDirectory));
+
+  std::string realFile = SystemPath::Append (textDirectory, "real.txt");
+  WriteFile (realFile, "1,2.5,-3e-2\n4\r\n\n-7.25,8\n");
+  Ptr<const MmWaveTableFile> real = MmWaveTableFile::Get (realFile, MmWaveTableFile::REAL);
+  CheckMapped (real, realFile, cacheDirectory);
+  NS_TEST_ASSERT_MSG_EQ (real->GetValueType (), MmWaveTableFile::REAL, "wrong value type");
+  NS_TEST_ASSERT_MSG_EQ (real->GetNumRows (), 4, "wrong number of rows");
+  const double realValues[] = {1, 2.5, -3e-2, 4, -7.25, 8};
+  const uint32_t realSizes[] = {3, 1, 0, 2};
+  for (uint32_t row = 0, index = 0; row < 4; row++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (real->GetRowSize (row), realSizes[row], "wrong size of row " << row);
+      for (uint32_t i = 0; i < realSizes[row]; i++, index++)
+        {
+          NS_TEST_ASSERT_MSG_EQ (real->GetRealRow (row)[i], realValues[index], "wrong value " << i << " of row " << row);
+        }
+    }
+  // the instance is shared
+  NS_TEST_ASSERT_MSG_EQ ((MmWaveTableFile::Get (realFile, MmWaveTableFile::REAL) == real), true, "the table was opened twice");
+
+  std::string complexFile = SystemPath::Append (textDirectory, "complex.txt");
+  WriteFile (complexFile, "1,0.27616,-0.15288-0.1584i,0.5i\r\n-1-1i,2+0i\n");
+  Ptr<const MmWaveTableFile> complex = MmWaveTableFile::Get (complexFile, MmWaveTableFile::COMPLEX);
+  CheckMapped (complex, complexFile, cacheDirectory);
+  NS_TEST_ASSERT_MSG_EQ (complex->GetValueType (), MmWaveTableFile::COMPLEX, "wrong value type");
+  NS_TEST_ASSERT_MSG_EQ (complex->GetNumRows (), 2, "wrong number of rows");
+  const std::complex<double> complexValues[] = {std::complex<double> (1, 0), std::complex<double> (0.27616, 0),
+                                                std::complex<double> (-0.15288, -0.1584), std::complex<double> (0, 0.5),
+                                                std::complex<double> (-1, -1), std::complex<double> (2, 0)};
+  const uint32_t complexSizes[] = {4, 2};
+  for (uint32_t row = 0, index = 0; row < 2; row++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (complex->GetRowSize (row), complexSizes[row], "wrong size of row " << row);
+      for (uint32_t i = 0; i < complexSizes[row]; i++, index++)
+        {
+          NS_TEST_ASSERT_MSG_EQ ((complex->GetComplexRow (row)[i] == complexValues[index]), true,
+                                 "wrong value " << i << " of row " << row << ": " << complex->GetComplexRow (row)[i]);
+        }
+    }
+
+  std::remove (realFile.c_str ());
+  std::remove (complexFile.c_str ());
+  Config::SetGlobal ("MmWaveTableCacheDirectory", StringValue (""));
+}
+
+
+class MmWaveTableFileTestSuite : public TestSuite
+{
+public:
+  MmWaveTableFileTestSuite ();
+};
+
+MmWaveTableFileTestSuite::MmWaveTableFileTestSuite ()
+  : TestSuite ("mmwave-table-file", UNIT)
+{
+  AddTestCase (new MmWaveTableFileTestCase, TestCase::QUICK);
+}
+
+static MmWaveTableFileTestSuite g_mmWaveTableFileTestSuite;
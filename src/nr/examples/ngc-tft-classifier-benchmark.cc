@@ -0,0 +1,205 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program benchmarks the classification of packets by NgcTftClassifier
+// against a linear scan of the TFTs with NgcTft::Matches, for a UE with
+// 'tfts' TFTs of 'filters' packet filters each, and checks that both give
+// the same result.
+// Sample usage:  ./waf --run 'ngc-tft-classifier-benchmark --n=1000000'
+
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/abort.h"
+#include "ns3/ngc-tft.h"
+#include "ns3/ngc-tft-classifier.h"
+#include "ns3/udp-l4-protocol.h"
+#include "ns3/tcp-l4-protocol.h"
+#include <iostream>
+#include <vector>
+#include <map>
+#include <stdlib.h> // for exit ()
+
+using namespace ns3;
+
+static uint32_t g_seed = 1;
+
+/// Linear congruential generator, so that both runs see the same packets
+static uint32_t
+NextRandom (void)
+{
+  g_seed = g_seed * 1103515245 + 12345;
+  return g_seed >> 8;
+}
+
+static Ipv4Address
+RandomRemoteAddress (void)
+{
+  return Ipv4Address (0x01000000 + (NextRandom () % 64));
+}
+
+/// A packet filter with a random combination of the fields that are matched
+static NgcTft::PacketFilter
+RandomPacketFilter (Ipv4Address ueAddress)
+{
+  NgcTft::PacketFilter f;
+  uint32_t r = NextRandom ();
+  if (r & 1)
+    {
+      f.direction = (r & 2) ? NgcTft::DOWNLINK : NgcTft::UPLINK;
+    }
+  if (r & 4)
+    {
+      f.remoteAddress = RandomRemoteAddress ();
+      f.remoteMask = (r & 8) ? Ipv4Mask ("255.255.255.255") : Ipv4Mask ("255.255.255.240");
+    }
+  if (r & 16)
+    {
+      f.localAddress = ueAddress;
+      f.localMask = Ipv4Mask ("255.255.255.255");
+    }
+  if (r & 32)
+    {
+      f.remotePortStart = 1000 + NextRandom () % 64;
+      f.remotePortEnd = (r & 64) ? f.remotePortStart : f.remotePortStart + 16;
+    }
+  if (r & 128)
+    {
+      f.localPortStart = 2000 + NextRandom () % 64;
+      f.localPortEnd = (r & 256) ? f.localPortStart : f.localPortStart + 16;
+    }
+  if (r & 512)
+    {
+      f.typeOfService = NextRandom () & 0xfc;
+      f.typeOfServiceMask = 0xfc;
+    }
+  return f;
+}
+
+static NgcTftClassifier::PacketFields
+RandomPacket (Ipv4Address ueAddress)
+{
+  NgcTftClassifier::PacketFields fields;
+  uint32_t r = NextRandom ();
+  fields.source = RandomRemoteAddress ();
+  fields.destination = ueAddress;
+  fields.sourcePort = 1000 + NextRandom () % 96;
+  fields.destinationPort = 2000 + NextRandom () % 96;
+  fields.protocol = (r & 1) ? UdpL4Protocol::PROT_NUMBER : TcpL4Protocol::PROT_NUMBER;
+  fields.tos = NextRandom () & 0xff;
+  return fields;
+}
+
+/// The classification before the TFTs were compiled: the first matching TFT, by decreasing id
+static uint32_t
+ClassifyLinear (const std::map<uint32_t, Ptr<NgcTft> > &tfts, const NgcTftClassifier::PacketFields &fields)
+{
+  for (std::map<uint32_t, Ptr<NgcTft> >::const_reverse_iterator it = tfts.rbegin (); it != tfts.rend (); ++it)
+    {
+      if (it->second->Matches (NgcTft::DOWNLINK, fields.source, fields.destination,
+                               fields.sourcePort, fields.destinationPort, fields.tos))
+        {
+          return it->first;
+        }
+    }
+  return 0;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t n = 1000000;
+  uint32_t nTfts = 16;
+  uint32_t nFilters = 15;
+  uint32_t nPackets = 1024;
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark NgcTftClassifier");
+  cmd.AddValue ("n", "number of packets to classify", n);
+  cmd.AddValue ("tfts", "number of TFTs of the UE, including the default one (at most 16)", nTfts);
+  cmd.AddValue ("filters", "number of packet filters per dedicated TFT (at most 15)", nFilters);
+  cmd.AddValue ("packets", "number of distinct packets", nPackets);
+  cmd.Parse (argc, argv);
+
+  if (nTfts < 1 || nTfts > 16 || nFilters < 1 || nFilters > 15 || nPackets < 1)
+    {
+      std::cerr << "Invalid arguments" << std::endl;
+      exit (1);
+    }
+
+  Ipv4Address ueAddress ("7.0.0.2");
+  std::map<uint32_t, Ptr<NgcTft> > tfts;
+  Ptr<NgcTftClassifier> classifier = Create<NgcTftClassifier> ();
+  tfts[1] = NgcTft::Default ();
+  classifier->Add (tfts[1], 1);
+  for (uint32_t id = 2; id <= nTfts; id++)
+    {
+      Ptr<NgcTft> tft = Create<NgcTft> ();
+      for (uint32_t i = 0; i < nFilters; i++)
+        {
+          tft->Add (RandomPacketFilter (ueAddress));
+        }
+      tfts[id] = tft;
+      classifier->Add (tft, id);
+    }
+
+  std::vector<NgcTftClassifier::PacketFields> packets;
+  for (uint32_t i = 0; i < nPackets; i++)
+    {
+      packets.push_back (RandomPacket (ueAddress));
+    }
+
+  std::vector<uint32_t> hits (nTfts + 1, 0);
+  for (uint32_t i = 0; i < nPackets; i++)
+    {
+      uint32_t linear = ClassifyLinear (tfts, packets[i]);
+      uint32_t compiled = classifier->Classify (packets[i], NgcTft::DOWNLINK);
+      if (linear != compiled)
+        {
+          std::cerr << "Mismatch on packet " << i << ": linear " << linear
+                    << " compiled " << compiled << std::endl;
+          exit (1);
+        }
+      hits[compiled]++;
+    }
+  std::cout << "TFT hits:";
+  for (uint32_t id = 1; id <= nTfts; id++)
+    {
+      std::cout << " " << hits[id];
+    }
+  std::cout << std::endl;
+
+  uint64_t sum = 0;
+  SystemWallClockMs time;
+  time.Start ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      sum += ClassifyLinear (tfts, packets[i % nPackets]);
+    }
+  uint64_t linearMs = time.End ();
+
+  time.Start ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      sum -= classifier->Classify (packets[i % nPackets], NgcTft::DOWNLINK);
+    }
+  uint64_t compiledMs = time.End ();
+  NS_ABORT_IF (sum != 0);
+
+  std::cout << "linear scan: " << linearMs << " ms, "
+            << (linearMs > 0 ? n / linearMs : 0) << " packets/ms" << std::endl;
+  std::cout << "compiled index: " << compiledMs << " ms, "
+            << (compiledMs > 0 ? n / compiledMs : 0) << " packets/ms" << std::endl;
+  return 0;
+}
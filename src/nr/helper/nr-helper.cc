@@ -61,6 +61,10 @@
 #include <ns3/buildings-propagation-loss-model.h>
 #include <ns3/nr-spectrum-value-helper.h>
 #include <ns3/ngc-x2.h>
+#include <ns3/double.h>
+#include <ns3/uinteger.h>
+#include <algorithm>
+#include <set>
 
 namespace ns3 {
 
@@ -200,6 +204,25 @@ TypeId NrHelper::GetTypeId (void)
                    BooleanValue (true),
                    MakeBooleanAccessor (&NrHelper::m_usePdschForCqiGeneration),
                    MakeBooleanChecker ())
+    .AddAttribute ("X2NeighbourDistance",
+                   "Maximum distance in meters between two eNBs connected by "
+                   "AddX2Interface (NodeContainer). If 0, there is no limit.",
+                   DoubleValue (0),
+                   MakeDoubleAccessor (&NrHelper::m_x2NeighbourDistance),
+                   MakeDoubleChecker<double> (0))
+    .AddAttribute ("X2MaxNeighbours",
+                   "Maximum number of nearest eNBs that an eNB is connected to by "
+                   "AddX2Interface (NodeContainer). If 0, there is no limit.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&NrHelper::m_x2MaxNeighbours),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("X2OnDemand",
+                   "If true, AddX2Interface (NodeContainer) only announces the eNBs as X2 "
+                   "neighbours, and each X2 interface is created when the first X2 message "
+                   "is sent over it. If false, the X2 interfaces are created immediately.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&NrHelper::m_x2OnDemand),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
@@ -210,6 +233,16 @@ NrHelper::DoDispose ()
   NS_LOG_FUNCTION (this);
   m_downlinkChannel = 0;
   m_uplinkChannel = 0;
+  m_pendingX2Interfaces.clear ();
+  for (std::map<uint16_t, Ptr<Node> >::iterator it = m_x2EnbNodes.begin (); it != m_x2EnbNodes.end (); ++it)
+    {
+      Ptr<NgcX2> x2 = it->second->GetObject<NgcX2> ();
+      if (x2 != 0)
+        {
+          x2->SetX2InterfaceRequestCallback (MakeNullCallback<void, Ptr<Node>, uint16_t> ());
+        }
+    }
+  m_x2EnbNodes.clear ();
   Object::DoDispose ();
 }
 
@@ -979,11 +1012,70 @@ NrHelper::AddX2Interface (NodeContainer enbNodes)
 
   NS_ASSERT_MSG (m_ngcHelper != 0, "X2 interfaces cannot be set up when the NGC is not used");
 
-  for (NodeContainer::Iterator i = enbNodes.Begin (); i != enbNodes.End (); ++i)
+  bool useDistance = m_x2NeighbourDistance > 0 || m_x2MaxNeighbours > 0;
+  std::vector<Vector> positions;
+  if (useDistance)
+    {
+      for (NodeContainer::Iterator i = enbNodes.Begin (); i != enbNodes.End (); ++i)
+        {
+          Ptr<MobilityModel> mobility = (*i)->GetObject<MobilityModel> ();
+          NS_ABORT_MSG_IF (mobility == 0, "X2 neighbours by distance require a MobilityModel on every eNB");
+          positions.push_back (mobility->GetPosition ());
+        }
+    }
+
+  // an eNB is connected to the eNBs it selects and to the eNBs that select it
+  std::set<std::pair<uint32_t, uint32_t> > links;
+  for (uint32_t i = 0; i < enbNodes.GetN (); i++)
+    {
+      std::vector<std::pair<double, uint32_t> > neighbours;
+      for (uint32_t j = 0; j < enbNodes.GetN (); j++)
+        {
+          if (j == i)
+            {
+              continue;
+            }
+          double distance = useDistance ? CalculateDistance (positions[i], positions[j]) : 0;
+          if (m_x2NeighbourDistance <= 0 || distance <= m_x2NeighbourDistance)
+            {
+              neighbours.push_back (std::make_pair (distance, j));
+            }
+        }
+      if (m_x2MaxNeighbours > 0 && neighbours.size () > m_x2MaxNeighbours)
+        {
+          std::partial_sort (neighbours.begin (), neighbours.begin () + m_x2MaxNeighbours, neighbours.end ());
+          neighbours.resize (m_x2MaxNeighbours);
+        }
+      for (std::vector<std::pair<double, uint32_t> >::iterator it = neighbours.begin (); it != neighbours.end (); ++it)
+        {
+          links.insert (std::make_pair (std::min (i, it->second), std::max (i, it->second)));
+        }
+    }
+  NS_LOG_INFO (links.size () << " X2 interfaces between " << enbNodes.GetN () << " eNBs");
+
+  for (std::set<std::pair<uint32_t, uint32_t> >::iterator it = links.begin (); it != links.end (); ++it)
+    {
+      if (m_x2OnDemand)
+        {
+          AddX2InterfaceOnDemand (enbNodes.Get (it->first), enbNodes.Get (it->second));
+        }
+      else
+        {
+          AddX2Interface (enbNodes.Get (it->first), enbNodes.Get (it->second));
+        }
+    }
+
+  if (useDistance || m_x2OnDemand)
     {
-      for (NodeContainer::Iterator j = i + 1; j != enbNodes.End (); ++j)
+      // the eNBs which are not neighbours are connected when they first
+      // exchange an X2 message, e.g. for a handover requested by the user;
+      // the callbacks keep the helper alive until the NgcX2 are disposed
+      NgcX2::X2InterfaceRequestCallback cb = MakeCallback (&NrHelper::DoAddX2Interface, Ptr<NrHelper> (this));
+      for (NodeContainer::Iterator i = enbNodes.Begin (); i != enbNodes.End (); ++i)
         {
-          AddX2Interface (*i, *j);
+          uint16_t cellId = (*i)->GetDevice (0)->GetObject<NrEnbNetDevice> ()->GetCellId ();
+          m_x2EnbNodes[cellId] = *i;
+          (*i)->GetObject<NgcX2> ()->SetX2InterfaceRequestCallback (cb);
         }
     }
 }
@@ -997,6 +1089,58 @@ NrHelper::AddX2Interface (Ptr<Node> enbNode1, Ptr<Node> enbNode2)
   m_ngcHelper->AddX2Interface (enbNode1, enbNode2);
 }
 
+void
+NrHelper::AddX2InterfaceOnDemand (Ptr<Node> enbNode1, Ptr<Node> enbNode2)
+{
+  NS_LOG_FUNCTION (this);
+
+  Ptr<NrEnbNetDevice> enb1NrDev = enbNode1->GetDevice (0)->GetObject<NrEnbNetDevice> ();
+  Ptr<NrEnbNetDevice> enb2NrDev = enbNode2->GetDevice (0)->GetObject<NrEnbNetDevice> ();
+  uint16_t cellId1 = enb1NrDev->GetCellId ();
+  uint16_t cellId2 = enb2NrDev->GetCellId ();
+  NS_LOG_INFO ("deferring the X2 interface between cells " << cellId1 << " and " << cellId2);
+
+  if (cellId1 < cellId2)
+    {
+      m_pendingX2Interfaces[std::make_pair (cellId1, cellId2)] = std::make_pair (enbNode1, enbNode2);
+    }
+  else
+    {
+      m_pendingX2Interfaces[std::make_pair (cellId2, cellId1)] = std::make_pair (enbNode2, enbNode1);
+    }
+
+  // the handover algorithms only consider the cells known by the ANR as X2 neighbours
+  enb1NrDev->GetRrc ()->AddX2Neighbour (cellId2);
+  enb2NrDev->GetRrc ()->AddX2Neighbour (cellId1);
+}
+
+void
+NrHelper::DoAddX2Interface (Ptr<Node> enbNode, uint16_t remoteCellId)
+{
+  NS_LOG_FUNCTION (this << enbNode << remoteCellId);
+
+  uint16_t localCellId = enbNode->GetDevice (0)->GetObject<NrEnbNetDevice> ()->GetCellId ();
+  std::pair<uint16_t, uint16_t> cellIds = std::make_pair (std::min (localCellId, remoteCellId),
+                                                          std::max (localCellId, remoteCellId));
+  std::map<std::pair<uint16_t, uint16_t>, std::pair<Ptr<Node>, Ptr<Node> > >::iterator it
+    = m_pendingX2Interfaces.find (cellIds);
+  if (it != m_pendingX2Interfaces.end ())
+    {
+      std::pair<Ptr<Node>, Ptr<Node> > enbNodes = it->second;
+      m_pendingX2Interfaces.erase (it);
+      AddX2Interface (enbNodes.first, enbNodes.second);
+      return;
+    }
+  std::map<uint16_t, Ptr<Node> >::iterator remote = m_x2EnbNodes.find (remoteCellId);
+  if (remote == m_x2EnbNodes.end ())
+    {
+      NS_LOG_LOGIC ("cell " << remoteCellId << " was not given to AddX2Interface");
+      return;
+    }
+  NS_LOG_INFO ("cells " << localCellId << " and " << remoteCellId << " are not X2 neighbours, connecting them");
+  AddX2Interface (enbNode, remote->second);
+}
+
 void
 NrHelper::HandoverRequest (Time hoTime, Ptr<NetDevice> ueDev, Ptr<NetDevice> sourceEnbDev, Ptr<NetDevice> targetEnbDev)
 {
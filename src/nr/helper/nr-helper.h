@@ -38,6 +38,8 @@
 #include <ns3/ngc-tft.h>
 #include <ns3/mobility-model.h>
 
+#include <map>
+
 namespace ns3 {
 
 
@@ -424,7 +426,19 @@ public:
 
   void DeActivateDedicatedEpsBearer (Ptr<NetDevice> ueDevice, Ptr<NetDevice> enbDevice, uint8_t bearerId);
   /**
-   * Create an X2 interface between all the eNBs in a given set.
+   * Create an X2 interface between the eNBs in a given set.
+   *
+   * By default every pair of eNBs is connected. With the
+   * `X2NeighbourDistance` and `X2MaxNeighbours` attributes, an eNB is only
+   * connected to the eNBs within the given distance and, among them, to
+   * its nearest ones; the eNBs must have a MobilityModel. With the
+   * `X2OnDemand` attribute, the selected eNBs are announced as X2
+   * neighbours to each other, but the X2 interface is only created when
+   * the first X2 message is sent between them. When either is used, an X2
+   * message between two eNBs of the set which are not neighbours, e.g. for
+   * a handover requested with HandoverRequest, also creates their X2
+   * interface, and the helper must not be destroyed before the end of the
+   * simulation.
    *
    * \param enbNodes the set of eNB nodes
    */
@@ -637,6 +651,24 @@ private:
    */
   void DoDeActivateDedicatedEpsBearer (Ptr<NetDevice> ueDevice, Ptr<NetDevice> enbDevice, uint8_t bearerId);
 
+  /**
+   * Announce two eNBs as X2 neighbours to each other, and defer the creation
+   * of their X2 interface to the first X2 message between them.
+   * \param enbNode1 one eNB of the X2 interface
+   * \param enbNode2 the other eNB of the X2 interface
+   */
+  void AddX2InterfaceOnDemand (Ptr<Node> enbNode1, Ptr<Node> enbNode2);
+
+  /**
+   * The actual function to create a deferred X2 interface, or the X2
+   * interface between two eNBs which are not neighbours, called by the
+   * NgcX2 entity of an eNB when it sends a message to a cell without an X2
+   * interface.
+   * \param enbNode the eNB sending the message
+   * \param remoteCellId the cell ID of the peer
+   */
+  void DoAddX2Interface (Ptr<Node> enbNode, uint16_t remoteCellId);
+
 
   /// The downlink NR channel used in the simulation.
   Ptr<SpectrumChannel> m_downlinkChannel;
@@ -732,6 +764,32 @@ private:
    */
   bool m_usePdschForCqiGeneration;
 
+  /**
+   * The `X2NeighbourDistance` attribute. Maximum distance between two eNBs
+   * connected by AddX2Interface (NodeContainer), 0 for no limit.
+   */
+  double m_x2NeighbourDistance;
+  /**
+   * The `X2MaxNeighbours` attribute. Number of nearest eNBs that an eNB is
+   * connected to by AddX2Interface (NodeContainer), 0 for no limit.
+   */
+  uint32_t m_x2MaxNeighbours;
+  /**
+   * The `X2OnDemand` attribute. If true, AddX2Interface (NodeContainer)
+   * creates the X2 interfaces when they are first used.
+   */
+  bool m_x2OnDemand;
+  /**
+   * The pairs of eNBs whose X2 interface is not created yet, indexed by
+   * their cell IDs, the lowest first.
+   */
+  std::map<std::pair<uint16_t, uint16_t>, std::pair<Ptr<Node>, Ptr<Node> > > m_pendingX2Interfaces;
+  /**
+   * The eNBs given to AddX2Interface (NodeContainer) when the X2 interfaces
+   * may be created on demand, indexed by their cell IDs.
+   */
+  std::map<uint16_t, Ptr<Node> > m_x2EnbNodes;
+
 }; // end of `class NrHelper`
 
 
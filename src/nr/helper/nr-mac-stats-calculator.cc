@@ -30,8 +30,8 @@ NS_LOG_COMPONENT_DEFINE ("NrMacStatsCalculator");
 NS_OBJECT_ENSURE_REGISTERED (NrMacStatsCalculator);
 
 NrMacStatsCalculator::NrMacStatsCalculator ()
-  : m_dlFirstWrite (true),
-    m_ulFirstWrite (true)
+  : m_dlOutFile (0),
+    m_ulOutFile (0)
 {
   NS_LOG_FUNCTION (this);
 
@@ -94,28 +94,42 @@ NrMacStatsCalculator::DlScheduling (uint16_t cellId, uint64_t imsi, uint32_t fra
   NS_LOG_FUNCTION (this << cellId << imsi << frameNo << subframeNo << rnti << (uint32_t) mcsTb1 << sizeTb1 << (uint32_t) mcsTb2 << sizeTb2);
   NS_LOG_INFO ("Write DL Mac Stats in " << GetDlOutputFilename ().c_str ());
 
-  std::ofstream outFile;
-  if ( m_dlFirstWrite == true )
+  if (GetBinaryOutput ())
     {
-      outFile.open (GetDlOutputFilename ().c_str ());
-      if (!outFile.is_open ())
+      if (m_dlColumns == 0)
         {
-          NS_LOG_ERROR ("Can't open file " << GetDlOutputFilename ().c_str ());
-          return;
+          m_dlColumns = Create<ColumnarTraceFile> (GetDlOutputFilename ());
+          m_dlColumns->AddColumn ("time", ColumnarTraceFile::DOUBLE);
+          m_dlColumns->AddColumn ("cellId", ColumnarTraceFile::UINT16);
+          m_dlColumns->AddColumn ("IMSI", ColumnarTraceFile::UINT64);
+          m_dlColumns->AddColumn ("frame", ColumnarTraceFile::UINT32);
+          m_dlColumns->AddColumn ("sframe", ColumnarTraceFile::UINT32);
+          m_dlColumns->AddColumn ("RNTI", ColumnarTraceFile::UINT16);
+          m_dlColumns->AddColumn ("mcsTb1", ColumnarTraceFile::UINT8);
+          m_dlColumns->AddColumn ("sizeTb1", ColumnarTraceFile::UINT16);
+          m_dlColumns->AddColumn ("mcsTb2", ColumnarTraceFile::UINT8);
+          m_dlColumns->AddColumn ("sizeTb2", ColumnarTraceFile::UINT16);
         }
-      m_dlFirstWrite = false;
-      outFile << "% time\tcellId\tIMSI\tframe\tsframe\tRNTI\tmcsTb1\tsizeTb1\tmcsTb2\tsizeTb2";
-      outFile << std::endl;
+      m_dlColumns->Put (Simulator::Now ().GetNanoSeconds () / (double) 1e9)
+        .Put (cellId)
+        .Put (imsi)
+        .Put (frameNo)
+        .Put (subframeNo)
+        .Put (rnti)
+        .Put (mcsTb1)
+        .Put (sizeTb1)
+        .Put (mcsTb2)
+        .Put (sizeTb2);
+      return;
     }
-  else
+
+  if (m_dlOutFile == 0)
     {
-      outFile.open (GetDlOutputFilename ().c_str (),  std::ios_base::app);
-      if (!outFile.is_open ())
-        {
-          NS_LOG_ERROR ("Can't open file " << GetDlOutputFilename ().c_str ());
-          return;
-        }
+      m_dlOutFile = AsyncTraceFile::Open (GetDlOutputFilename ());
+      m_dlOutFile->GetStream () << "% time\tcellId\tIMSI\tframe\tsframe\tRNTI\tmcsTb1\tsizeTb1\tmcsTb2\tsizeTb2";
+      m_dlOutFile->GetStream () << "\n";
     }
+  std::ostream &outFile = m_dlOutFile->GetStream ();
 
   outFile << Simulator::Now ().GetNanoSeconds () / (double) 1e9 << "\t";
   outFile << (uint32_t) cellId << "\t";
@@ -126,8 +140,7 @@ NrMacStatsCalculator::DlScheduling (uint16_t cellId, uint64_t imsi, uint32_t fra
   outFile << (uint32_t) mcsTb1 << "\t";
   outFile << sizeTb1 << "\t";
   outFile << (uint32_t) mcsTb2 << "\t";
-  outFile << sizeTb2 << std::endl;
-  outFile.close ();
+  outFile << sizeTb2 << "\n";
 }
 
 void
@@ -137,28 +150,38 @@ NrMacStatsCalculator::UlScheduling (uint16_t cellId, uint64_t imsi, uint32_t fra
   NS_LOG_FUNCTION (this << cellId << imsi << frameNo << subframeNo << rnti << (uint32_t) mcsTb << size);
   NS_LOG_INFO ("Write UL Mac Stats in " << GetUlOutputFilename ().c_str ());
 
-  std::ofstream outFile;
-  if ( m_ulFirstWrite == true )
+  if (GetBinaryOutput ())
     {
-      outFile.open (GetUlOutputFilename ().c_str ());
-      if (!outFile.is_open ())
+      if (m_ulColumns == 0)
         {
-          NS_LOG_ERROR ("Can't open file " << GetUlOutputFilename ().c_str ());
-          return;
+          m_ulColumns = Create<ColumnarTraceFile> (GetUlOutputFilename ());
+          m_ulColumns->AddColumn ("time", ColumnarTraceFile::DOUBLE);
+          m_ulColumns->AddColumn ("cellId", ColumnarTraceFile::UINT16);
+          m_ulColumns->AddColumn ("IMSI", ColumnarTraceFile::UINT64);
+          m_ulColumns->AddColumn ("frame", ColumnarTraceFile::UINT32);
+          m_ulColumns->AddColumn ("sframe", ColumnarTraceFile::UINT32);
+          m_ulColumns->AddColumn ("RNTI", ColumnarTraceFile::UINT16);
+          m_ulColumns->AddColumn ("mcs", ColumnarTraceFile::UINT8);
+          m_ulColumns->AddColumn ("size", ColumnarTraceFile::UINT16);
         }
-      m_ulFirstWrite = false;
-      outFile << "% time\tcellId\tIMSI\tframe\tsframe\tRNTI\tmcs\tsize";
-      outFile << std::endl;
+      m_ulColumns->Put (Simulator::Now ().GetNanoSeconds () / (double) 1e9)
+        .Put (cellId)
+        .Put (imsi)
+        .Put (frameNo)
+        .Put (subframeNo)
+        .Put (rnti)
+        .Put (mcsTb)
+        .Put (size);
+      return;
     }
-  else
+
+  if (m_ulOutFile == 0)
     {
-      outFile.open (GetUlOutputFilename ().c_str (),  std::ios_base::app);
-      if (!outFile.is_open ())
-        {
-          NS_LOG_ERROR ("Can't open file " << GetUlOutputFilename ().c_str ());
-          return;
-        }
+      m_ulOutFile = AsyncTraceFile::Open (GetUlOutputFilename ());
+      m_ulOutFile->GetStream () << "% time\tcellId\tIMSI\tframe\tsframe\tRNTI\tmcs\tsize";
+      m_ulOutFile->GetStream () << "\n";
     }
+  std::ostream &outFile = m_ulOutFile->GetStream ();
 
   outFile << Simulator::Now ().GetNanoSeconds () / (double) 1e9 << "\t";
   outFile << (uint32_t) cellId << "\t";
@@ -167,8 +190,7 @@ NrMacStatsCalculator::UlScheduling (uint16_t cellId, uint64_t imsi, uint32_t fra
   outFile << subframeNo << "\t";
   outFile << rnti << "\t";
   outFile << (uint32_t) mcsTb << "\t";
-  outFile << size << std::endl;
-  outFile.close ();
+  outFile << size << "\n";
 }
 
 void
@@ -24,8 +24,9 @@
 #include "ns3/nr-stats-calculator.h"
 #include "ns3/nstime.h"
 #include "ns3/uinteger.h"
+#include "ns3/async-trace-file.h"
+#include "ns3/columnar-trace-file.h"
 #include <string>
-#include <fstream>
 
 namespace ns3 {
 
@@ -155,18 +156,28 @@ private:
   /**
    * When writing DL MAC statistics first time to file,
    * columns description is added. Then next lines are
-   * appended to file. This value is true if output
-   * files have not been opened yet
+   * appended to file. This file is 0 if it has
+   * not been opened yet
    */
-  bool m_dlFirstWrite;
+  Ptr<AsyncTraceFile> m_dlOutFile;
+
+  /**
+   * Columnar trace for DL statistics, 0 if it has not been created yet
+   */
+  Ptr<ColumnarTraceFile> m_dlColumns;
 
   /**
    * When writing UL MAC statistics first time to file,
    * columns description is added. Then next lines are
-   * appended to file. This value is true if output
-   * files have not been opened yet
+   * appended to file. This file is 0 if it has
+   * not been opened yet
+   */
+  Ptr<AsyncTraceFile> m_ulOutFile;
+
+  /**
+   * Columnar trace for UL statistics, 0 if it has not been created yet
    */
-  bool m_ulFirstWrite;
+  Ptr<ColumnarTraceFile> m_ulColumns;
 
 };
 
@@ -23,6 +23,7 @@
 
 #include "nr-mac-tx-stats-calculator.h"
 #include "ns3/string.h"
+#include "ns3/boolean.h"
 #include "ns3/nstime.h"
 #include <ns3/log.h>
 #include <vector>
@@ -35,6 +36,7 @@ NS_LOG_COMPONENT_DEFINE ("NrMacTxStatsCalculator");
 NS_OBJECT_ENSURE_REGISTERED ( NrMacTxStatsCalculator);
 
 NrMacTxStatsCalculator::NrMacTxStatsCalculator ()
+  : m_binaryOutput (false)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -62,6 +64,11 @@ NrMacTxStatsCalculator::GetTypeId (void)
                    StringValue ("UlMacTx.txt"),
                    MakeStringAccessor (&NrMacTxStatsCalculator::m_retxUlFilename),
                    MakeStringChecker ())
+    .AddAttribute ("BinaryOutput",
+                   "Write the results as columnar binary traces (see ColumnarTraceFile) rather than text.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&NrMacTxStatsCalculator::m_binaryOutput),
+                   MakeBooleanChecker ())
     ;
   return tid;
 }
@@ -75,24 +82,62 @@ NrMacTxStatsCalculator::DoDispose ()
 void
 NrMacTxStatsCalculator::RegisterMacTxDl(uint16_t rnti, uint16_t cellId, uint32_t packetSize, uint8_t numRetx)
 {
-	if(!m_retxDlFile.is_open())
+  if (m_binaryOutput)
+    {
+      if (m_retxDlColumns == 0)
+        {
+          m_retxDlColumns = Create<ColumnarTraceFile> (m_retxDlFilename);
+          m_retxDlColumns->AddColumn ("time", ColumnarTraceFile::DOUBLE);
+          m_retxDlColumns->AddColumn ("cellId", ColumnarTraceFile::UINT16);
+          m_retxDlColumns->AddColumn ("RNTI", ColumnarTraceFile::UINT16);
+          m_retxDlColumns->AddColumn ("size", ColumnarTraceFile::UINT32);
+          m_retxDlColumns->AddColumn ("numRetx", ColumnarTraceFile::UINT8);
+        }
+      m_retxDlColumns->Put (Simulator::Now ().GetSeconds ())
+        .Put (cellId)
+        .Put (rnti)
+        .Put (packetSize)
+        .Put (numRetx);
+      return;
+    }
+
+	if (m_retxDlFile == 0)
 	{
-	    m_retxDlFile.open(m_retxDlFilename.c_str());
+	    m_retxDlFile = AsyncTraceFile::Open (m_retxDlFilename);
 	    NS_LOG_LOGIC("File opened");
 	}
   NS_LOG_LOGIC(rnti << cellId << packetSize << numRetx);
-	m_retxDlFile << Simulator::Now().GetSeconds() << " " << cellId << " " << rnti << " "  << packetSize << " " << (uint32_t)numRetx << std::endl;
+	m_retxDlFile->GetStream () << Simulator::Now().GetSeconds() << " " << cellId << " " << rnti << " "  << packetSize << " " << (uint32_t)numRetx << "\n";
 }
 
 void
 NrMacTxStatsCalculator::RegisterMacTxUl(uint16_t rnti, uint16_t cellId, uint32_t packetSize, uint8_t numRetx)
 {
-	if(!m_retxUlFile.is_open())
+  if (m_binaryOutput)
+    {
+      if (m_retxUlColumns == 0)
+        {
+          m_retxUlColumns = Create<ColumnarTraceFile> (m_retxUlFilename);
+          m_retxUlColumns->AddColumn ("time", ColumnarTraceFile::DOUBLE);
+          m_retxUlColumns->AddColumn ("cellId", ColumnarTraceFile::UINT16);
+          m_retxUlColumns->AddColumn ("RNTI", ColumnarTraceFile::UINT16);
+          m_retxUlColumns->AddColumn ("size", ColumnarTraceFile::UINT32);
+          m_retxUlColumns->AddColumn ("numRetx", ColumnarTraceFile::UINT8);
+        }
+      m_retxUlColumns->Put (Simulator::Now ().GetSeconds ())
+        .Put (cellId)
+        .Put (rnti)
+        .Put (packetSize)
+        .Put (numRetx);
+      return;
+    }
+
+	if (m_retxUlFile == 0)
 	{
-	    m_retxUlFile.open(m_retxUlFilename.c_str());
+	    m_retxUlFile = AsyncTraceFile::Open (m_retxUlFilename);
 	    NS_LOG_LOGIC("File opened");
 	}
-  m_retxUlFile << Simulator::Now().GetSeconds() << " " << cellId << " " << rnti << " "  << packetSize << " " << (uint32_t)numRetx << std::endl;
+  m_retxUlFile->GetStream () << Simulator::Now().GetSeconds() << " " << cellId << " " << rnti << " "  << packetSize << " " << (uint32_t)numRetx << "\n";
 }
 
 }
\ No newline at end of file
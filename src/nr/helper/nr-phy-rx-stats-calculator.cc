@@ -32,8 +32,8 @@ NS_LOG_COMPONENT_DEFINE ("NrPhyRxStatsCalculator");
 NS_OBJECT_ENSURE_REGISTERED (NrPhyRxStatsCalculator);
 
 NrPhyRxStatsCalculator::NrPhyRxStatsCalculator ()
-  : m_dlRxFirstWrite (true),
-    m_ulRxFirstWrite (true)
+  : m_dlRxOutFile (0),
+    m_ulRxOutFile (0)
 {
   NS_LOG_FUNCTION (this);
 
@@ -95,28 +95,44 @@ NrPhyRxStatsCalculator::DlPhyReception (NrPhyReceptionStatParameters params)
   NS_LOG_FUNCTION (this << params.m_cellId << params.m_imsi << params.m_timestamp << params.m_rnti << params.m_layer << params.m_mcs << params.m_size << params.m_rv << params.m_ndi << params.m_correctness);
   NS_LOG_INFO ("Write DL Rx Phy Stats in " << GetDlRxOutputFilename ().c_str ());
 
-  std::ofstream outFile;
-  if ( m_dlRxFirstWrite == true )
+  if (GetBinaryOutput ())
     {
-      outFile.open (GetDlRxOutputFilename ().c_str ());
-      if (!outFile.is_open ())
+      if (m_dlRxColumns == 0)
         {
-          NS_LOG_ERROR ("Can't open file " << GetDlRxOutputFilename ().c_str ());
-          return;
+          m_dlRxColumns = Create<ColumnarTraceFile> (GetDlRxOutputFilename ());
+          m_dlRxColumns->AddColumn ("time", ColumnarTraceFile::DOUBLE);
+          m_dlRxColumns->AddColumn ("cellId", ColumnarTraceFile::UINT16);
+          m_dlRxColumns->AddColumn ("IMSI", ColumnarTraceFile::UINT64);
+          m_dlRxColumns->AddColumn ("RNTI", ColumnarTraceFile::UINT16);
+          m_dlRxColumns->AddColumn ("txMode", ColumnarTraceFile::UINT8);
+          m_dlRxColumns->AddColumn ("layer", ColumnarTraceFile::UINT8);
+          m_dlRxColumns->AddColumn ("mcs", ColumnarTraceFile::UINT8);
+          m_dlRxColumns->AddColumn ("size", ColumnarTraceFile::UINT16);
+          m_dlRxColumns->AddColumn ("rv", ColumnarTraceFile::UINT8);
+          m_dlRxColumns->AddColumn ("ndi", ColumnarTraceFile::UINT8);
+          m_dlRxColumns->AddColumn ("correct", ColumnarTraceFile::UINT8);
         }
-      m_dlRxFirstWrite = false;
-      outFile << "% time\tcellId\tIMSI\tRNTI\ttxMode\tlayer\tmcs\tsize\trv\tndi\tcorrect";
-      outFile << std::endl;
+      m_dlRxColumns->Put (params.m_timestamp)
+        .Put (params.m_cellId)
+        .Put (params.m_imsi)
+        .Put (params.m_rnti)
+        .Put (params.m_txMode)
+        .Put (params.m_layer)
+        .Put (params.m_mcs)
+        .Put (params.m_size)
+        .Put (params.m_rv)
+        .Put (params.m_ndi)
+        .Put (params.m_correctness);
+      return;
     }
-  else
+
+  if (m_dlRxOutFile == 0)
     {
-      outFile.open (GetDlRxOutputFilename ().c_str (),  std::ios_base::app);
-      if (!outFile.is_open ())
-        {
-          NS_LOG_ERROR ("Can't open file " << GetDlRxOutputFilename ().c_str ());
-          return;
-        }
+      m_dlRxOutFile = AsyncTraceFile::Open (GetDlRxOutputFilename ());
+      m_dlRxOutFile->GetStream () << "% time\tcellId\tIMSI\tRNTI\ttxMode\tlayer\tmcs\tsize\trv\tndi\tcorrect";
+      m_dlRxOutFile->GetStream () << "\n";
     }
+  std::ostream &outFile = m_dlRxOutFile->GetStream ();
 
 //   outFile << Simulator::Now ().GetNanoSeconds () / (double) 1e9 << "\t";
   outFile << params.m_timestamp << "\t";
@@ -129,8 +145,7 @@ NrPhyRxStatsCalculator::DlPhyReception (NrPhyReceptionStatParameters params)
   outFile << params.m_size << "\t";
   outFile << (uint32_t) params.m_rv << "\t";
   outFile << (uint32_t) params.m_ndi << "\t";
-  outFile << (uint32_t) params.m_correctness << std::endl;
-  outFile.close ();
+  outFile << (uint32_t) params.m_correctness << "\n";
 }
 
 void
@@ -139,28 +154,42 @@ NrPhyRxStatsCalculator::UlPhyReception (NrPhyReceptionStatParameters params)
   NS_LOG_FUNCTION (this << params.m_cellId << params.m_imsi << params.m_timestamp << params.m_rnti << params.m_layer << params.m_mcs << params.m_size << params.m_rv << params.m_ndi << params.m_correctness);
   NS_LOG_INFO ("Write UL Rx Phy Stats in " << GetUlRxOutputFilename ().c_str ());
 
-  std::ofstream outFile;
-  if ( m_ulRxFirstWrite == true )
+  if (GetBinaryOutput ())
     {
-      outFile.open (GetUlRxOutputFilename ().c_str ());
-      if (!outFile.is_open ())
+      if (m_ulRxColumns == 0)
         {
-          NS_LOG_ERROR ("Can't open file " << GetUlRxOutputFilename ().c_str ());
-          return;
+          m_ulRxColumns = Create<ColumnarTraceFile> (GetUlRxOutputFilename ());
+          m_ulRxColumns->AddColumn ("time", ColumnarTraceFile::DOUBLE);
+          m_ulRxColumns->AddColumn ("cellId", ColumnarTraceFile::UINT16);
+          m_ulRxColumns->AddColumn ("IMSI", ColumnarTraceFile::UINT64);
+          m_ulRxColumns->AddColumn ("RNTI", ColumnarTraceFile::UINT16);
+          m_ulRxColumns->AddColumn ("layer", ColumnarTraceFile::UINT8);
+          m_ulRxColumns->AddColumn ("mcs", ColumnarTraceFile::UINT8);
+          m_ulRxColumns->AddColumn ("size", ColumnarTraceFile::UINT16);
+          m_ulRxColumns->AddColumn ("rv", ColumnarTraceFile::UINT8);
+          m_ulRxColumns->AddColumn ("ndi", ColumnarTraceFile::UINT8);
+          m_ulRxColumns->AddColumn ("correct", ColumnarTraceFile::UINT8);
         }
-      m_ulRxFirstWrite = false;
-      outFile << "% time\tcellId\tIMSI\tRNTI\tlayer\tmcs\tsize\trv\tndi\tcorrect";
-      outFile << std::endl;
+      m_ulRxColumns->Put (params.m_timestamp)
+        .Put (params.m_cellId)
+        .Put (params.m_imsi)
+        .Put (params.m_rnti)
+        .Put (params.m_layer)
+        .Put (params.m_mcs)
+        .Put (params.m_size)
+        .Put (params.m_rv)
+        .Put (params.m_ndi)
+        .Put (params.m_correctness);
+      return;
     }
-  else
+
+  if (m_ulRxOutFile == 0)
     {
-      outFile.open (GetUlRxOutputFilename ().c_str (),  std::ios_base::app);
-      if (!outFile.is_open ())
-        {
-          NS_LOG_ERROR ("Can't open file " << GetUlRxOutputFilename ().c_str ());
-          return;
-        }
+      m_ulRxOutFile = AsyncTraceFile::Open (GetUlRxOutputFilename ());
+      m_ulRxOutFile->GetStream () << "% time\tcellId\tIMSI\tRNTI\tlayer\tmcs\tsize\trv\tndi\tcorrect";
+      m_ulRxOutFile->GetStream () << "\n";
     }
+  std::ostream &outFile = m_ulRxOutFile->GetStream ();
 
 //   outFile << Simulator::Now ().GetNanoSeconds () / (double) 1e9 << "\t";
   outFile << params.m_timestamp << "\t";
@@ -172,8 +201,7 @@ NrPhyRxStatsCalculator::UlPhyReception (NrPhyReceptionStatParameters params)
   outFile << params.m_size << "\t";
   outFile << (uint32_t) params.m_rv << "\t";
   outFile << (uint32_t) params.m_ndi << "\t";
-  outFile << (uint32_t) params.m_correctness << std::endl;
-  outFile.close ();
+  outFile << (uint32_t) params.m_correctness << "\n";
 }
 
 void
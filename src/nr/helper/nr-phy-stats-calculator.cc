@@ -30,9 +30,9 @@ NS_LOG_COMPONENT_DEFINE ("NrPhyStatsCalculator");
 NS_OBJECT_ENSURE_REGISTERED (NrPhyStatsCalculator);
 
 NrPhyStatsCalculator::NrPhyStatsCalculator ()
-  :  m_RsrpSinrFirstWrite (true),
-    m_UeSinrFirstWrite (true),
-    m_InterferenceFirstWrite (true)
+  :  m_RsrpSinrOutFile (0),
+    m_UeSinrOutFile (0),
+    m_InterferenceOutFile (0)
 {
   NS_LOG_FUNCTION (this);
 
@@ -114,36 +114,20 @@ NrPhyStatsCalculator::ReportCurrentCellRsrpSinr (uint16_t cellId, uint64_t imsi,
   NS_LOG_FUNCTION (this << cellId <<  imsi << rnti  << rsrp << sinr);
   NS_LOG_INFO ("Write RSRP/SINR Phy Stats in " << GetCurrentCellRsrpSinrFilename ().c_str ());
 
-  std::ofstream outFile;
-  if ( m_RsrpSinrFirstWrite == true )
+  if (m_RsrpSinrOutFile == 0)
     {
-      outFile.open (GetCurrentCellRsrpSinrFilename ().c_str ());
-      if (!outFile.is_open ())
-        {
-          NS_LOG_ERROR ("Can't open file " << GetCurrentCellRsrpSinrFilename ().c_str ());
-          return;
-        }
-      m_RsrpSinrFirstWrite = false;
-      outFile << "% time\tcellId\tIMSI\tRNTI\trsrp\tsinr";
-      outFile << std::endl;
-    }
-  else
-    {
-      outFile.open (GetCurrentCellRsrpSinrFilename ().c_str (),  std::ios_base::app);
-      if (!outFile.is_open ())
-        {
-          NS_LOG_ERROR ("Can't open file " << GetCurrentCellRsrpSinrFilename ().c_str ());
-          return;
-        }
+      m_RsrpSinrOutFile = AsyncTraceFile::Open (GetCurrentCellRsrpSinrFilename ());
+      m_RsrpSinrOutFile->GetStream () << "% time\tcellId\tIMSI\tRNTI\trsrp\tsinr";
+      m_RsrpSinrOutFile->GetStream () << "\n";
     }
+  std::ostream &outFile = m_RsrpSinrOutFile->GetStream ();
 
   outFile << Simulator::Now ().GetNanoSeconds () / (double) 1e9 << "\t";
   outFile << cellId << "\t";
   outFile << imsi << "\t";
   outFile << rnti << "\t";
   outFile << rsrp << "\t";
-  outFile << sinr << std::endl;
-  outFile.close ();
+  outFile << sinr << "\n";
 }
 
 void
@@ -152,35 +136,19 @@ NrPhyStatsCalculator::ReportUeSinr (uint16_t cellId, uint64_t imsi, uint16_t rnt
   NS_LOG_FUNCTION (this << cellId <<  imsi << rnti  << sinrLinear);
   NS_LOG_INFO ("Write SINR Linear Phy Stats in " << GetUeSinrFilename ().c_str ());
 
-  std::ofstream outFile;
-  if ( m_UeSinrFirstWrite == true )
+  if (m_UeSinrOutFile == 0)
     {
-      outFile.open (GetUeSinrFilename ().c_str ());
-      if (!outFile.is_open ())
-        {
-          NS_LOG_ERROR ("Can't open file " << GetUeSinrFilename ().c_str ());
-          return;
-        }
-      m_UeSinrFirstWrite = false;
-      outFile << "% time\tcellId\tIMSI\tRNTI\tsinrLinear";
-      outFile << std::endl;
-    }
-  else
-    {
-      outFile.open (GetUeSinrFilename ().c_str (),  std::ios_base::app);
-      if (!outFile.is_open ())
-        {
-          NS_LOG_ERROR ("Can't open file " << GetUeSinrFilename ().c_str ());
-          return;
-        }
+      m_UeSinrOutFile = AsyncTraceFile::Open (GetUeSinrFilename ());
+      m_UeSinrOutFile->GetStream () << "% time\tcellId\tIMSI\tRNTI\tsinrLinear";
+      m_UeSinrOutFile->GetStream () << "\n";
     }
+  std::ostream &outFile = m_UeSinrOutFile->GetStream ();
 
   outFile << Simulator::Now ().GetNanoSeconds () / (double) 1e9 << "\t";
   outFile << cellId << "\t";
   outFile << imsi << "\t";
   outFile << rnti << "\t";
-  outFile << sinrLinear << std::endl;
-  outFile.close ();
+  outFile << sinrLinear << "\n";
 }
 
 void
@@ -189,33 +157,17 @@ NrPhyStatsCalculator::ReportInterference (uint16_t cellId, Ptr<SpectrumValue> in
   NS_LOG_FUNCTION (this << cellId <<  interference);
   NS_LOG_INFO ("Write Interference Phy Stats in " << GetInterferenceFilename ().c_str ());
 
-  std::ofstream outFile;
-  if ( m_InterferenceFirstWrite == true )
-    {
-      outFile.open (GetInterferenceFilename ().c_str ());
-      if (!outFile.is_open ())
-        {
-          NS_LOG_ERROR ("Can't open file " << GetInterferenceFilename ().c_str ());
-          return;
-        }
-      m_InterferenceFirstWrite = false;
-      outFile << "% time\tcellId\tInterference";
-      outFile << std::endl;
-    }
-  else
+  if (m_InterferenceOutFile == 0)
     {
-      outFile.open (GetInterferenceFilename ().c_str (),  std::ios_base::app);
-      if (!outFile.is_open ())
-        {
-          NS_LOG_ERROR ("Can't open file " << GetInterferenceFilename ().c_str ());
-          return;
-        }
+      m_InterferenceOutFile = AsyncTraceFile::Open (GetInterferenceFilename ());
+      m_InterferenceOutFile->GetStream () << "% time\tcellId\tInterference";
+      m_InterferenceOutFile->GetStream () << "\n";
     }
+  std::ostream &outFile = m_InterferenceOutFile->GetStream ();
 
   outFile << Simulator::Now ().GetNanoSeconds () / (double) 1e9 << "\t";
   outFile << cellId << "\t";
   outFile << *interference;
-  outFile.close ();
 }
 
 
@@ -25,8 +25,8 @@
 #include "ns3/nstime.h"
 #include "ns3/uinteger.h"
 #include "ns3/spectrum-value.h"
+#include "ns3/async-trace-file.h"
 #include <string>
-#include <fstream>
 
 namespace ns3 {
 
@@ -179,26 +179,26 @@ private:
   /**
    * When writing RSRP SINR statistics first time to file,
    * columns description is added. Then next lines are
-   * appended to file. This value is true if output
-   * files have not been opened yet
+   * appended to file. This file is 0 if it has
+   * not been opened yet
    */
-  bool m_RsrpSinrFirstWrite;
+  Ptr<AsyncTraceFile> m_RsrpSinrOutFile;
 
   /**
    * When writing UE SINR statistics first time to file,
    * columns description is added. Then next lines are
-   * appended to file. This value is true if output
-   * files have not been opened yet
+   * appended to file. This file is 0 if it has
+   * not been opened yet
    */
-  bool m_UeSinrFirstWrite;
+  Ptr<AsyncTraceFile> m_UeSinrOutFile;
 
   /**
    * When writing interference statistics first time to file,
    * columns description is added. Then next lines are
-   * appended to file. This value is true if output
-   * files have not been opened yet
+   * appended to file. This file is 0 if it has
+   * not been opened yet
    */
-  bool m_InterferenceFirstWrite;
+  Ptr<AsyncTraceFile> m_InterferenceOutFile;
 
   /**
    * Name of the file where the RSRP/SINR statistics will be saved
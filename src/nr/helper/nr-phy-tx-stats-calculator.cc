@@ -32,8 +32,8 @@ NS_LOG_COMPONENT_DEFINE ("NrPhyTxStatsCalculator");
 NS_OBJECT_ENSURE_REGISTERED (NrPhyTxStatsCalculator);
 
 NrPhyTxStatsCalculator::NrPhyTxStatsCalculator ()
-  : m_dlTxFirstWrite (true),
-    m_ulTxFirstWrite (true)
+  : m_dlTxOutFile (0),
+    m_ulTxOutFile (0)
 {
   NS_LOG_FUNCTION (this);
 
@@ -95,29 +95,41 @@ NrPhyTxStatsCalculator::DlPhyTransmission (NrPhyTransmissionStatParameters param
   NS_LOG_FUNCTION (this << params.m_cellId << params.m_imsi << params.m_timestamp << params.m_rnti << params.m_layer << params.m_mcs << params.m_size << params.m_rv << params.m_ndi);
   NS_LOG_INFO ("Write DL Tx Phy Stats in " << GetDlTxOutputFilename ().c_str ());
 
-  std::ofstream outFile;
-  if ( m_dlTxFirstWrite == true )
+  if (GetBinaryOutput ())
     {
-      outFile.open (GetDlOutputFilename ().c_str ());
-      if (!outFile.is_open ())
+      if (m_dlTxColumns == 0)
         {
-          NS_LOG_ERROR ("Can't open file " << GetDlTxOutputFilename ().c_str ());
-          return;
+          m_dlTxColumns = Create<ColumnarTraceFile> (GetDlTxOutputFilename ());
+          m_dlTxColumns->AddColumn ("time", ColumnarTraceFile::DOUBLE);
+          m_dlTxColumns->AddColumn ("cellId", ColumnarTraceFile::UINT16);
+          m_dlTxColumns->AddColumn ("IMSI", ColumnarTraceFile::UINT64);
+          m_dlTxColumns->AddColumn ("RNTI", ColumnarTraceFile::UINT16);
+          m_dlTxColumns->AddColumn ("layer", ColumnarTraceFile::UINT8);
+          m_dlTxColumns->AddColumn ("mcs", ColumnarTraceFile::UINT8);
+          m_dlTxColumns->AddColumn ("size", ColumnarTraceFile::UINT16);
+          m_dlTxColumns->AddColumn ("rv", ColumnarTraceFile::UINT8);
+          m_dlTxColumns->AddColumn ("ndi", ColumnarTraceFile::UINT8);
         }
-      m_dlTxFirstWrite = false;
-      //outFile << "% time\tcellId\tIMSI\tRNTI\tlayer\tmcs\tsize\trv\tndi"; // txMode is not available at dl tx side
-      outFile << "% time\tcellId\tIMSI\tRNTI\tlayer\tmcs\tsize\trv\tndi";
-      outFile << std::endl;
+      m_dlTxColumns->Put (params.m_timestamp)
+        .Put (params.m_cellId)
+        .Put (params.m_imsi)
+        .Put (params.m_rnti)
+        .Put (params.m_layer)
+        .Put (params.m_mcs)
+        .Put (params.m_size)
+        .Put (params.m_rv)
+        .Put (params.m_ndi);
+      return;
     }
-  else
+
+  if (m_dlTxOutFile == 0)
     {
-      outFile.open (GetDlTxOutputFilename ().c_str (),  std::ios_base::app);
-      if (!outFile.is_open ())
-        {
-          NS_LOG_ERROR ("Can't open file " << GetDlTxOutputFilename ().c_str ());
-          return;
-        }
+      m_dlTxOutFile = AsyncTraceFile::Open (GetDlTxOutputFilename ());
+      //m_dlTxOutFile->GetStream () << "% time\tcellId\tIMSI\tRNTI\tlayer\tmcs\tsize\trv\tndi"; // txMode is not available at dl tx side
+      m_dlTxOutFile->GetStream () << "% time\tcellId\tIMSI\tRNTI\tlayer\tmcs\tsize\trv\tndi";
+      m_dlTxOutFile->GetStream () << "\n";
     }
+  std::ostream &outFile = m_dlTxOutFile->GetStream ();
 
 //   outFile << Simulator::Now ().GetNanoSeconds () / (double) 1e9 << "\t";
   outFile << params.m_timestamp << "\t";
@@ -129,8 +141,7 @@ NrPhyTxStatsCalculator::DlPhyTransmission (NrPhyTransmissionStatParameters param
   outFile << (uint32_t) params.m_mcs << "\t";
   outFile << params.m_size << "\t";
   outFile << (uint32_t) params.m_rv << "\t";
-  outFile << (uint32_t) params.m_ndi << std::endl;
-  outFile.close ();
+  outFile << (uint32_t) params.m_ndi << "\n";
 }
 
 void
@@ -139,29 +150,41 @@ NrPhyTxStatsCalculator::UlPhyTransmission (NrPhyTransmissionStatParameters param
   NS_LOG_FUNCTION (this << params.m_cellId << params.m_imsi << params.m_timestamp << params.m_rnti << params.m_layer << params.m_mcs << params.m_size << params.m_rv << params.m_ndi);
   NS_LOG_INFO ("Write UL Tx Phy Stats in " << GetUlTxOutputFilename ().c_str ());
 
-  std::ofstream outFile;
-  if ( m_ulTxFirstWrite == true )
+  if (GetBinaryOutput ())
     {
-      outFile.open (GetUlTxOutputFilename ().c_str ());
-      if (!outFile.is_open ())
+      if (m_ulTxColumns == 0)
         {
-          NS_LOG_ERROR ("Can't open file " << GetUlTxOutputFilename ().c_str ());
-          return;
+          m_ulTxColumns = Create<ColumnarTraceFile> (GetUlTxOutputFilename ());
+          m_ulTxColumns->AddColumn ("time", ColumnarTraceFile::DOUBLE);
+          m_ulTxColumns->AddColumn ("cellId", ColumnarTraceFile::UINT16);
+          m_ulTxColumns->AddColumn ("IMSI", ColumnarTraceFile::UINT64);
+          m_ulTxColumns->AddColumn ("RNTI", ColumnarTraceFile::UINT16);
+          m_ulTxColumns->AddColumn ("layer", ColumnarTraceFile::UINT8);
+          m_ulTxColumns->AddColumn ("mcs", ColumnarTraceFile::UINT8);
+          m_ulTxColumns->AddColumn ("size", ColumnarTraceFile::UINT16);
+          m_ulTxColumns->AddColumn ("rv", ColumnarTraceFile::UINT8);
+          m_ulTxColumns->AddColumn ("ndi", ColumnarTraceFile::UINT8);
         }
-      m_ulTxFirstWrite = false;
-//       outFile << "% time\tcellId\tIMSI\tRNTI\ttxMode\tlayer\tmcs\tsize\trv\tndi";
-      outFile << "% time\tcellId\tIMSI\tRNTI\tlayer\tmcs\tsize\trv\tndi";
-      outFile << std::endl;
+      m_ulTxColumns->Put (params.m_timestamp)
+        .Put (params.m_cellId)
+        .Put (params.m_imsi)
+        .Put (params.m_rnti)
+        .Put (params.m_layer)
+        .Put (params.m_mcs)
+        .Put (params.m_size)
+        .Put (params.m_rv)
+        .Put (params.m_ndi);
+      return;
     }
-  else
+
+  if (m_ulTxOutFile == 0)
     {
-      outFile.open (GetUlTxOutputFilename ().c_str (),  std::ios_base::app);
-      if (!outFile.is_open ())
-        {
-          NS_LOG_ERROR ("Can't open file " << GetUlTxOutputFilename ().c_str ());
-          return;
-        }
+      m_ulTxOutFile = AsyncTraceFile::Open (GetUlTxOutputFilename ());
+//       m_ulTxOutFile->GetStream () << "% time\tcellId\tIMSI\tRNTI\ttxMode\tlayer\tmcs\tsize\trv\tndi";
+      m_ulTxOutFile->GetStream () << "% time\tcellId\tIMSI\tRNTI\tlayer\tmcs\tsize\trv\tndi";
+      m_ulTxOutFile->GetStream () << "\n";
     }
+  std::ostream &outFile = m_ulTxOutFile->GetStream ();
 
 //   outFile << Simulator::Now ().GetNanoSeconds () / (double) 1e9 << "\t";
   outFile << params.m_timestamp << "\t";
@@ -173,8 +196,7 @@ NrPhyTxStatsCalculator::UlPhyTransmission (NrPhyTransmissionStatParameters param
   outFile << (uint32_t) params.m_mcs << "\t";
   outFile << params.m_size << "\t";
   outFile << (uint32_t) params.m_rv << "\t";
-  outFile << (uint32_t) params.m_ndi << std::endl;
-  outFile.close ();
+  outFile << (uint32_t) params.m_ndi << "\n";
 }
 
 void
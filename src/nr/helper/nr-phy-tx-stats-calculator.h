@@ -26,8 +26,9 @@
 #include "ns3/nr-stats-calculator.h"
 #include "ns3/nstime.h"
 #include "ns3/uinteger.h"
+#include "ns3/async-trace-file.h"
+#include "ns3/columnar-trace-file.h"
 #include <string>
-#include <fstream>
 #include <ns3/nr-common.h>
 
 namespace ns3 {
@@ -130,18 +131,28 @@ private:
   /**
    * When writing DL TX PHY statistics first time to file,
    * columns description is added. Then next lines are
-   * appended to file. This value is true if output
-   * files have not been opened yet
+   * appended to file. This file is 0 if it has
+   * not been opened yet
    */
-  bool m_dlTxFirstWrite;
+  Ptr<AsyncTraceFile> m_dlTxOutFile;
+
+  /**
+   * Columnar trace for DL statistics, 0 if it has not been created yet
+   */
+  Ptr<ColumnarTraceFile> m_dlTxColumns;
 
   /**
    * When writing UL TX PHY statistics first time to file,
    * columns description is added. Then next lines are
-   * appended to file. This value is true if output
-   * files have not been opened yet
+   * appended to file. This file is 0 if it has
+   * not been opened yet
+   */
+  Ptr<AsyncTraceFile> m_ulTxOutFile;
+
+  /**
+   * Columnar trace for UL statistics, 0 if it has not been created yet
    */
-  bool m_ulTxFirstWrite;
+  Ptr<ColumnarTraceFile> m_ulTxColumns;
 
 };
 
@@ -216,59 +216,30 @@ NrRadioBearerStatsCalculator::ShowResults (void)
   NS_LOG_FUNCTION (this << GetUlOutputFilename ().c_str () << GetDlOutputFilename ().c_str ());
   NS_LOG_INFO ("Write Rlc Stats in " << GetUlOutputFilename ().c_str () << " and in " << GetDlOutputFilename ().c_str ());
 
-  std::ofstream ulOutFile;
-  std::ofstream dlOutFile;
+  Ptr<AsyncTraceFile> ulOutFile = AsyncTraceFile::Open (GetUlOutputFilename (), AsyncTraceFile::TEXT, !m_firstWrite);
+  Ptr<AsyncTraceFile> dlOutFile = AsyncTraceFile::Open (GetDlOutputFilename (), AsyncTraceFile::TEXT, !m_firstWrite);
 
   if (m_firstWrite == true)
     {
-      ulOutFile.open (GetUlOutputFilename ().c_str ());
-      if (!ulOutFile.is_open ())
-        {
-          NS_LOG_ERROR ("Can't open file " << GetUlOutputFilename ().c_str ());
-          return;
-        }
-
-      dlOutFile.open (GetDlOutputFilename ().c_str ());
-      if (!dlOutFile.is_open ())
-        {
-          NS_LOG_ERROR ("Can't open file " << GetDlOutputFilename ().c_str ());
-          return;
-        }
       m_firstWrite = false;
-      ulOutFile << "% start\tend\tCellId\tIMSI\tRNTI\tLCID\tnTxPDUs\tTxBytes\tnRxPDUs\tRxBytes\t";
-      ulOutFile << "delay\tstdDev\tmin\tmax\t";
-      ulOutFile << "PduSize\tstdDev\tmin\tmax";
-      ulOutFile << std::endl;
-      dlOutFile << "% start\tend\tCellId\tIMSI\tRNTI\tLCID\tnTxPDUs\tTxBytes\tnRxPDUs\tRxBytes\t";
-      dlOutFile << "delay\tstdDev\tmin\tmax\t";
-      dlOutFile << "PduSize\tstdDev\tmin\tmax";
-      dlOutFile << std::endl;
+      ulOutFile->GetStream () << "% start\tend\tCellId\tIMSI\tRNTI\tLCID\tnTxPDUs\tTxBytes\tnRxPDUs\tRxBytes\t";
+      ulOutFile->GetStream () << "delay\tstdDev\tmin\tmax\t";
+      ulOutFile->GetStream () << "PduSize\tstdDev\tmin\tmax";
+      ulOutFile->GetStream () << "\n";
+      dlOutFile->GetStream () << "% start\tend\tCellId\tIMSI\tRNTI\tLCID\tnTxPDUs\tTxBytes\tnRxPDUs\tRxBytes\t";
+      dlOutFile->GetStream () << "delay\tstdDev\tmin\tmax\t";
+      dlOutFile->GetStream () << "PduSize\tstdDev\tmin\tmax";
+      dlOutFile->GetStream () << "\n";
     }
-  else
-    {
-      ulOutFile.open (GetUlOutputFilename ().c_str (), std::ios_base::app);
-      if (!ulOutFile.is_open ())
-        {
-          NS_LOG_ERROR ("Can't open file " << GetUlOutputFilename ().c_str ());
-          return;
-        }
 
-      dlOutFile.open (GetDlOutputFilename ().c_str (), std::ios_base::app);
-      if (!dlOutFile.is_open ())
-        {
-          NS_LOG_ERROR ("Can't open file " << GetDlOutputFilename ().c_str ());
-          return;
-        }
-    }
-
-  WriteUlResults (ulOutFile);
-  WriteDlResults (dlOutFile);
+  WriteUlResults (ulOutFile->GetStream ());
+  WriteDlResults (dlOutFile->GetStream ());
   m_pendingOutput = false;
 
 }
 
 void
-NrRadioBearerStatsCalculator::WriteUlResults (std::ofstream& outFile)
+NrRadioBearerStatsCalculator::WriteUlResults (std::ostream& outFile)
 {
   NS_LOG_FUNCTION (this);
 
@@ -307,14 +278,12 @@ NrRadioBearerStatsCalculator::WriteUlResults (std::ofstream& outFile)
         {
           outFile << (*it) << "\t";
         }
-      outFile << std::endl;
+      outFile << "\n";
     }
-
-  outFile.close ();
 }
 
 void
-NrRadioBearerStatsCalculator::WriteDlResults (std::ofstream& outFile)
+NrRadioBearerStatsCalculator::WriteDlResults (std::ostream& outFile)
 {
   NS_LOG_FUNCTION (this);
 
@@ -352,10 +321,8 @@ NrRadioBearerStatsCalculator::WriteDlResults (std::ofstream& outFile)
         {
           outFile << (*it) << "\t";
         }
-      outFile << std::endl;
+      outFile << "\n";
     }
-
-  outFile.close ();
 }
 
 void
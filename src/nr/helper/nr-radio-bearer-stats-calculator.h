@@ -30,7 +30,7 @@
 #include "ns3/nr-common.h"
 #include <string>
 #include <map>
-#include <fstream>
+#include "ns3/async-trace-file.h"
 
 namespace ns3
 {
@@ -360,18 +360,18 @@ private:
   /**
    * Writes collected statistics to UL output file and
    * closes UL output file.
-   * @param outFile ofstream for UL statistics
+   * @param outFile stream for UL statistics
    */
   void
-  WriteUlResults (std::ofstream& outFile);
+  WriteUlResults (std::ostream& outFile);
 
   /**
    * Writes collected statistics to DL output file and
    * closes DL output file.
-   * @param outFile ofstream for DL statistics
+   * @param outFile stream for DL statistics
    */
   void
-  WriteDlResults (std::ofstream& outFile);
+  WriteDlResults (std::ostream& outFile);
 
   /**
    * Erases collected statistics
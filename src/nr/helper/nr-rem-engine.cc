@@ -0,0 +1,476 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "nr-rem-engine.h"
+
+#include <ns3/abort.h>
+#include <ns3/log.h>
+#include <ns3/double.h>
+#include <ns3/integer.h>
+#include <ns3/uinteger.h>
+#include <ns3/string.h>
+#include <ns3/boolean.h>
+#include <ns3/angles.h>
+#include <ns3/mobility-building-info.h>
+#include <ns3/constant-position-mobility-model.h>
+#include <ns3/buildings-helper.h>
+#include <ns3/nr-enb-net-device.h>
+#include <ns3/nr-enb-phy.h>
+#include <ns3/nr-spectrum-phy.h>
+#include <ns3/nr-spectrum-value-helper.h>
+
+#include <fstream>
+#include <limits>
+#include <cmath>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("NrRemEngine");
+
+NS_OBJECT_ENSURE_REGISTERED (NrRemEngine);
+
+NrRemEngine::NrRemEngine ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+NrRemEngine::~NrRemEngine ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+NrRemEngine::DoDispose ()
+{
+  NS_LOG_FUNCTION (this);
+  m_transmitters.clear ();
+  m_propagationLoss = 0;
+  m_spectrumPropagationLoss = 0;
+  m_probeCreator = MakeNullCallback<Ptr<Node> > ();
+  Object::DoDispose ();
+}
+
+TypeId
+NrRemEngine::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::NrRemEngine")
+    .SetParent<Object> ()
+    .SetGroupName ("Nr")
+    .AddConstructor<NrRemEngine> ()
+    .AddAttribute ("OutputFile", "the filename to which the Radio Environment Map is saved",
+                   StringValue ("rem.out"),
+                   MakeStringAccessor (&NrRemEngine::m_outputFile),
+                   MakeStringChecker ())
+    .AddAttribute ("BinaryOutput",
+                   "If true, the map is written as a binary grid: the x and y resolutions "
+                   "(uint32), XMin, XMax, YMin, YMax and Z (double), then the SINR of each "
+                   "point (float), x-major. Otherwise, one line per point as "
+                   "NrRadioEnvironmentMapHelper does",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&NrRemEngine::m_binaryOutput),
+                   MakeBooleanChecker ())
+    .AddAttribute ("XMin", "The min x coordinate of the map.",
+                   DoubleValue (0.0),
+                   MakeDoubleAccessor (&NrRemEngine::m_xMin),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("YMin", "The min y coordinate of the map.",
+                   DoubleValue (0.0),
+                   MakeDoubleAccessor (&NrRemEngine::m_yMin),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("XMax", "The max x coordinate of the map.",
+                   DoubleValue (1.0),
+                   MakeDoubleAccessor (&NrRemEngine::m_xMax),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("YMax", "The max y coordinate of the map.",
+                   DoubleValue (1.0),
+                   MakeDoubleAccessor (&NrRemEngine::m_yMax),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("XRes", "The resolution (number of points) of the map along the x axis.",
+                   UintegerValue (100),
+                   MakeUintegerAccessor (&NrRemEngine::m_xRes),
+                   MakeUintegerChecker<uint16_t> (2, std::numeric_limits<uint16_t>::max ()))
+    .AddAttribute ("YRes", "The resolution (number of points) of the map along the y axis.",
+                   UintegerValue (100),
+                   MakeUintegerAccessor (&NrRemEngine::m_yRes),
+                   MakeUintegerChecker<uint16_t> (2, std::numeric_limits<uint16_t>::max ()))
+    .AddAttribute ("Z", "The value of the z coordinate for which the map is to be generated",
+                   DoubleValue (0.0),
+                   MakeDoubleAccessor (&NrRemEngine::m_z),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("NoisePower",
+                   "the power of the measuring instrument noise, in Watts. Default to a kT of -174 dBm with a noise figure of 9 dB and a bandwidth of 25 NR Resource Blocks",
+                   DoubleValue (1.4230e-13),
+                   MakeDoubleAccessor (&NrRemEngine::m_noisePower),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("RbId",
+                   "Band of the PSDs for which the REM is generated, "
+                   "default value is -1, what means the power of all the bands is used",
+                   IntegerValue (-1),
+                   MakeIntegerAccessor (&NrRemEngine::m_rbId),
+                   MakeIntegerChecker<int32_t> ())
+    .AddAttribute ("MaxPointsPerIteration",
+                   "Maximum number of REM points evaluated together. Each point of a block keeps "
+                   "its mobility model and, with a spectrum propagation loss model, a PSD per transmitter.",
+                   UintegerValue (20000),
+                   MakeUintegerAccessor (&NrRemEngine::m_maxPointsPerIteration),
+                   MakeUintegerChecker<uint32_t> (1, std::numeric_limits<uint32_t>::max ()))
+    .AddAttribute ("Threads",
+                   "Number of threads evaluating the points, including the calling one; "
+                   "0 for one per core",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&NrRemEngine::m_threads),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("ParallelPropagationLoss",
+                   "If true, the antenna gains and the propagation losses are evaluated on all the "
+                   "threads, which needs models that are deterministic, keep no caches, only look at "
+                   "the positions and the buildings and have their logging disabled",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&NrRemEngine::m_parallelPropagationLoss),
+                   MakeBooleanChecker ())
+  ;
+  return tid;
+}
+
+void
+NrRemEngine::AddEnbDevices (NetDeviceContainer enbDevices)
+{
+  NS_LOG_FUNCTION (this);
+  for (NetDeviceContainer::Iterator it = enbDevices.Begin (); it != enbDevices.End (); ++it)
+    {
+      Ptr<NrEnbNetDevice> enb = DynamicCast<NrEnbNetDevice> (*it);
+      NS_ABORT_MSG_IF (enb == 0, "not an NR eNB device");
+      Ptr<NrEnbPhy> phy = enb->GetPhy ();
+      // the PSD of the control frames, the one of the phy depends on the last scheduled RBs
+      std::vector<int> dlRb;
+      for (uint8_t rb = 0; rb < enb->GetDlBandwidth (); rb++)
+        {
+          dlRb.push_back (rb);
+        }
+      AddTransmitter (enb->GetNode ()->GetObject<MobilityModel> (),
+                      NrSpectrumValueHelper::CreateTxPowerSpectralDensity (enb->GetDlEarfcn (), enb->GetDlBandwidth (),
+                                                                           phy->GetTxPower (), dlRb),
+                      phy->GetDlSpectrumPhy ()->GetRxAntenna ());
+    }
+}
+
+void
+NrRemEngine::AddTransmitter (Ptr<MobilityModel> mobility, Ptr<const SpectrumValue> txPsd, Ptr<AntennaModel> antenna)
+{
+  NS_LOG_FUNCTION (this << mobility << txPsd << antenna);
+  NS_ABORT_MSG_IF (mobility == 0, "the transmitter has no mobility model");
+  Transmitter tx;
+  tx.mobility = mobility;
+  tx.txPsd = txPsd;
+  tx.antenna = antenna;
+  for (Bands::const_iterator band = txPsd->ConstBandsBegin (); band != txPsd->ConstBandsEnd (); ++band)
+    {
+      tx.bandWidths.push_back (band->fh - band->fl);
+    }
+  tx.txPower = 0;
+  m_transmitters.push_back (tx);
+}
+
+void
+NrRemEngine::SetPropagationLossModel (Ptr<PropagationLossModel> model)
+{
+  m_propagationLoss = model;
+}
+
+void
+NrRemEngine::SetSpectrumPropagationLossModel (Ptr<SpectrumPropagationLossModel> model)
+{
+  m_spectrumPropagationLoss = model;
+}
+
+void
+NrRemEngine::SetProbeCreator (Callback<Ptr<Node> > creator)
+{
+  m_probeCreator = creator;
+}
+
+double
+NrRemEngine::GetPower (Values::const_iterator values, const std::vector<double> &bandWidths) const
+{
+  if (m_rbId >= 0)
+    {
+      return values[m_rbId] * bandWidths[m_rbId];
+    }
+  double power = 0;
+  for (std::vector<double>::const_iterator width = bandWidths.begin (); width != bandWidths.end (); ++width, ++values)
+    {
+      power += *values * *width;
+    }
+  return power;
+}
+
+void
+NrRemEngine::Run (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ABORT_MSG_IF (m_transmitters.empty (), "no transmitters");
+  TypeId mmWave3gppChannel;
+  if (m_spectrumPropagationLoss != 0
+      && TypeId::LookupByNameFailSafe ("ns3::MmWave3gppChannel", &mmWave3gppChannel))
+    {
+      TypeId tid = m_spectrumPropagationLoss->GetInstanceTypeId ();
+      NS_ABORT_MSG_IF (tid == mmWave3gppChannel || tid.IsChildOf (mmWave3gppChannel),
+                       tid.GetName () << " is not supported: its beamforming vectors are those of the "
+                       "connected devices of a running simulation, use a NrRadioEnvironmentMapHelper instead");
+    }
+  for (std::vector<Transmitter>::iterator tx = m_transmitters.begin (); tx != m_transmitters.end (); ++tx)
+    {
+      NS_ABORT_MSG_IF (m_rbId >= (int32_t) tx->bandWidths.size (), "RbId " << m_rbId << " is not a band of the PSD");
+      tx->txPower = GetPower (tx->txPsd->ConstValuesBegin (), tx->bandWidths);
+    }
+
+  uint32_t numPoints = (uint32_t) m_xRes * m_yRes;
+  m_sinr.assign (numPoints, 0);
+
+  uint32_t numThreads = m_threads;
+  if (numThreads == 0)
+    {
+      numThreads = SpectrumWorkerPool::GetNumCores ();
+    }
+  SpectrumWorkerPool pool (numThreads);
+
+  Block block;
+  block.engine = this;
+  CreateProbes (block, std::min (m_maxPointsPerIteration, numPoints), pool.GetNumThreads ());
+  for (block.first = 0; block.first < numPoints; block.first += m_maxPointsPerIteration)
+    {
+      block.numPoints = std::min (m_maxPointsPerIteration, numPoints - block.first);
+      NS_LOG_LOGIC ("points " << block.first << " to " << block.first + block.numPoints);
+      PrepareBlock (block, pool);
+      pool.Run (block.numPoints, &NrRemEngine::EvaluatePoint, &block);
+      // in the order in which the tasks were prepared
+      for (std::vector<Link>::iterator link = block.links.begin (); link != block.links.end (); ++link)
+        {
+          if (link->task != 0)
+            {
+              link->task->Finish (block.psds[link->psd]);
+            }
+        }
+      block.links.clear ();
+      block.psds.clear ();
+    }
+
+  Write ();
+}
+
+void
+NrRemEngine::CreateProbes (Block &block, uint32_t numSlots, uint32_t numThreads)
+{
+  NS_LOG_FUNCTION (this << numSlots << numThreads);
+  block.probes.clear ();
+  for (uint32_t i = 0; i < numSlots; i++)
+    {
+      Ptr<ConstantPositionMobilityModel> rxMobility = CreateObject<ConstantPositionMobilityModel> ();
+      rxMobility->AggregateObject (CreateObject<MobilityBuildingInfo> ()); // operation usually done by BuildingsHelper::Install
+      if (!m_probeCreator.IsNull ())
+        {
+          m_probeCreator ()->AggregateObject (rxMobility);
+        }
+      block.probes.push_back (rxMobility);
+    }
+
+  block.txMobility.clear ();
+  if (!m_parallelPropagationLoss)
+    {
+      return;
+    }
+  // the reference counts are not atomic: each thread gets its own transmitters
+  for (uint32_t thread = 0; thread < numThreads; thread++)
+    {
+      for (std::vector<Transmitter>::const_iterator tx = m_transmitters.begin (); tx != m_transmitters.end (); ++tx)
+        {
+          Ptr<ConstantPositionMobilityModel> txMobility = CreateObject<ConstantPositionMobilityModel> ();
+          txMobility->SetPosition (tx->mobility->GetPosition ());
+          if (tx->mobility->GetObject<MobilityBuildingInfo> () != 0)
+            {
+              txMobility->AggregateObject (CreateObject<MobilityBuildingInfo> ());
+              BuildingsHelper::MakeConsistent (txMobility);
+            }
+          block.txMobility.push_back (txMobility);
+        }
+    }
+}
+
+double
+NrRemEngine::GetGainDb (const Transmitter &tx, const Ptr<MobilityModel> &txMobility,
+                        const Ptr<MobilityModel> &rxMobility) const
+{
+  double gainDb = 0;
+  if (tx.antenna != 0)
+    {
+      gainDb += tx.antenna->GetGainDb (Angles (rxMobility->GetPosition (), txMobility->GetPosition ()));
+    }
+  if (m_propagationLoss != 0)
+    {
+      gainDb += m_propagationLoss->CalcRxPower (0, txMobility, rxMobility);
+    }
+  return gainDb;
+}
+
+void
+NrRemEngine::PrepareBlock (Block &block, SpectrumWorkerPool &pool)
+{
+  NS_LOG_FUNCTION (this << block.first << block.numPoints);
+  double xStep = (m_xMax - m_xMin) / (m_xRes - 1);
+  double yStep = (m_yMax - m_yMin) / (m_yRes - 1);
+  uint32_t numTx = m_transmitters.size ();
+  block.links.resize (block.numPoints * numTx);
+
+  for (uint32_t i = 0; i < block.numPoints; i++)
+    {
+      uint32_t point = block.first + i;
+      Ptr<MobilityModel> rxMobility = block.probes[i];
+      rxMobility->SetPosition (Vector (m_xMin + (point / m_yRes) * xStep, m_yMin + (point % m_yRes) * yStep, m_z));
+      BuildingsHelper::MakeConsistent (rxMobility);
+    }
+
+  if (m_parallelPropagationLoss)
+    {
+      pool.Run (pool.GetNumThreads (), &NrRemEngine::EvaluateGains, &block);
+    }
+  else
+    {
+      for (uint32_t i = 0; i < block.numPoints; i++)
+        {
+          for (uint32_t t = 0; t < numTx; t++)
+            {
+              const Transmitter &tx = m_transmitters[t];
+              block.links[i * numTx + t].gain = std::pow (10.0, GetGainDb (tx, tx.mobility, block.probes[i]) / 10.0);
+            }
+        }
+    }
+
+  for (uint32_t i = 0; i < block.numPoints; i++)
+    {
+      for (uint32_t t = 0; t < numTx; t++)
+        {
+          const Transmitter &tx = m_transmitters[t];
+          Link &link = block.links[i * numTx + t];
+          link.task = 0;
+          if (m_spectrumPropagationLoss == 0)
+            {
+              link.power = link.gain * tx.txPower;
+              continue;
+            }
+          Ptr<SpectrumValue> rxPsd = Copy<SpectrumValue> (tx.txPsd);
+          *rxPsd *= link.gain;
+          link.task = m_spectrumPropagationLoss->PrepareRxPowerSpectralDensity (rxPsd, tx.mobility, block.probes[i]);
+          if (link.task != 0)
+            {
+              // completed by EvaluatePoint
+              link.psd = block.psds.size ();
+              block.psds.push_back (*rxPsd);
+            }
+          else
+            {
+              rxPsd = m_spectrumPropagationLoss->CalcRxPowerSpectralDensity (rxPsd, tx.mobility, block.probes[i]);
+              link.power = GetPower (rxPsd->ConstValuesBegin (), tx.bandWidths);
+            }
+        }
+    }
+}
+
+void
+NrRemEngine::EvaluateGains (void *context, uint32_t index)
+{
+  // runs on a worker thread: only the Ptr of this thread are copied, by the models
+  Block &block = *static_cast<Block *> (context);
+  const NrRemEngine &engine = *block.engine;
+  uint32_t numTx = engine.m_transmitters.size ();
+  uint32_t numThreads = block.txMobility.size () / numTx;
+  for (uint32_t i = index; i < block.numPoints; i += numThreads)
+    {
+      for (uint32_t t = 0; t < numTx; t++)
+        {
+          double gainDb = engine.GetGainDb (engine.m_transmitters[t], block.txMobility[index * numTx + t], block.probes[i]);
+          block.links[i * numTx + t].gain = std::pow (10.0, gainDb / 10.0);
+        }
+    }
+}
+
+void
+NrRemEngine::EvaluatePoint (void *context, uint32_t index)
+{
+  // runs on a worker thread: no logging and no Ptr copies here
+  Block &block = *static_cast<Block *> (context);
+  const NrRemEngine &engine = *block.engine;
+  uint32_t numTx = engine.m_transmitters.size ();
+  double sumPower = 0;
+  double maxPower = 0;
+  for (uint32_t t = 0; t < numTx; t++)
+    {
+      Link &link = block.links[index * numTx + t];
+      if (link.task != 0)
+        {
+          SpectrumValue &psd = block.psds[link.psd];
+          link.task->Apply (psd);
+          link.power = engine.GetPower (psd.ConstValuesBegin (), engine.m_transmitters[t].bandWidths);
+        }
+      sumPower += link.power;
+      maxPower = std::max (maxPower, link.power);
+    }
+  block.engine->m_sinr[block.first + index] = maxPower / (sumPower - maxPower + engine.m_noisePower);
+}
+
+double
+NrRemEngine::GetSinr (uint32_t xIndex, uint32_t yIndex) const
+{
+  NS_ASSERT (xIndex < m_xRes && yIndex < m_yRes);
+  NS_ASSERT_MSG (!m_sinr.empty (), "Run has not been called");
+  return m_sinr[xIndex * m_yRes + yIndex];
+}
+
+void
+NrRemEngine::Write (void) const
+{
+  NS_LOG_FUNCTION (this);
+  std::ofstream outFile (m_outputFile.c_str (), m_binaryOutput ? std::ios::binary : std::ios::out);
+  if (!outFile.is_open ())
+    {
+      NS_FATAL_ERROR ("Can't open file " << m_outputFile);
+    }
+
+  if (m_binaryOutput)
+    {
+      uint32_t resolution[2] = { m_xRes, m_yRes };
+      double bounds[5] = { m_xMin, m_xMax, m_yMin, m_yMax, m_z };
+      outFile.write (reinterpret_cast<const char *> (resolution), sizeof (resolution));
+      outFile.write (reinterpret_cast<const char *> (bounds), sizeof (bounds));
+      std::vector<float> sinr (m_sinr.begin (), m_sinr.end ());
+      outFile.write (reinterpret_cast<const char *> (&sinr[0]), sinr.size () * sizeof (float));
+      return;
+    }
+
+  double xStep = (m_xMax - m_xMin) / (m_xRes - 1);
+  double yStep = (m_yMax - m_yMin) / (m_yRes - 1);
+  for (uint32_t i = 0; i < m_xRes; i++)
+    {
+      for (uint32_t j = 0; j < m_yRes; j++)
+        {
+          outFile << m_xMin + i * xStep << "\t"
+                  << m_yMin + j * yStep << "\t"
+                  << m_z << "\t"
+                  << m_sinr[i * m_yRes + j]
+                  << "\n";
+        }
+    }
+}
+
+} // namespace ns3
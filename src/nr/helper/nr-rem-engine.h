@@ -0,0 +1,253 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef NR_REM_ENGINE_H
+#define NR_REM_ENGINE_H
+
+#include <ns3/object.h>
+#include <ns3/callback.h>
+#include <ns3/node.h>
+#include <ns3/net-device-container.h>
+#include <ns3/spectrum-value.h>
+#include <ns3/spectrum-propagation-loss-model.h>
+#include <ns3/propagation-loss-model.h>
+#include <ns3/antenna-model.h>
+#include <ns3/mobility-model.h>
+#include <ns3/spectrum-worker-pool.h>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup nr
+ *
+ * Computes a 2D map of the downlink SINR from the strongest transmitter
+ * without running the simulator, as an offline counterpart of
+ * NrRadioEnvironmentMapHelper.
+ *
+ * The transmitters are described by their mobility, tx PSD and antenna,
+ * either taken from installed NR eNB devices (AddEnbDevices) or given
+ * directly (AddTransmitter), e.g., for mmWave eNBs:
+ * \code
+ *   Ptr<MmWaveEnbPhy> phy = enbDevice->GetPhy ();
+ *   rem->AddTransmitter (enbDevice->GetNode ()->GetObject<MobilityModel> (),
+ *                        MmWaveSpectrumValueHelper::CreateTxPowerSpectralDensity (config, txPower, subChannels),
+ *                        phy->GetDlSpectrumPhy ()->GetRxAntenna ());
+ * \endcode
+ * The losses are those of the propagation and spectrum propagation loss
+ * models given to the engine, usually the ones of the channel, so that
+ * buildings, LOS conditions and shadowing are those of the simulation.
+ *
+ * Run evaluates the grid by blocks of at most MaxPointsPerIteration points.
+ * As NrRadioEnvironmentMapHelper does, each slot of a block has a receiver
+ * mobility model, created once and moved from one block to the next. A
+ * block is evaluated in three steps:
+ * - the antenna gains and the propagation losses, on the calling thread or,
+ *   with ParallelPropagationLoss, on all the threads;
+ * - SpectrumPropagationLossModel::PrepareRxPowerSpectralDensity, or
+ *   CalcRxPowerSpectralDensity for the models without tasks, on the calling
+ *   thread, since these models keep caches and random streams;
+ * - the tasks and the reduction of the received powers to SINR, on all the
+ *   threads.
+ *
+ * With ParallelPropagationLoss, each thread works on its own copies of the
+ * transmitter mobility models, which have the position and the buildings
+ * information of the original ones but no node. The propagation loss model
+ * and the antennas must then only depend on the positions and on the
+ * buildings information of the two ends, must not draw random numbers nor
+ * cache anything, and their logging must be disabled: it is the case of the
+ * Friis, log distance and the deterministic buildings models, not of
+ * shadowing models.
+ *
+ * Models that look at the devices of the two ends, like the mmWave 3GPP
+ * propagation loss models, need the receivers to be nodes with a UE device:
+ * SetProbeCreator gives a callback making such a node, called once per slot,
+ * to which the engine aggregates the mobility model of the slot.
+ * MmWave3gppChannel is rejected: its beamforming vectors are those set for
+ * the connected devices of a running simulation, so a probe would get none.
+ */
+class NrRemEngine : public Object
+{
+public:
+  NrRemEngine ();
+  virtual ~NrRemEngine ();
+
+  // inherited from Object
+  virtual void DoDispose (void);
+  /**
+   *  Register this type.
+   *  \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /**
+   * Add the transmitters of installed NR eNB devices, with their DL tx PSD
+   * over the whole bandwidth.
+   *
+   * \param enbDevices the NR eNB devices
+   */
+  void AddEnbDevices (NetDeviceContainer enbDevices);
+
+  /**
+   * Add a transmitter.
+   *
+   * \param mobility the position of the transmitter
+   * \param txPsd the transmitted PSD
+   * \param antenna the antenna of the transmitter, or 0 for an isotropic one
+   */
+  void AddTransmitter (Ptr<MobilityModel> mobility, Ptr<const SpectrumValue> txPsd, Ptr<AntennaModel> antenna);
+
+  /**
+   * \param model the propagation loss model, or 0 for none
+   */
+  void SetPropagationLossModel (Ptr<PropagationLossModel> model);
+
+  /**
+   * \param model the spectrum propagation loss model, or 0 for none
+   */
+  void SetSpectrumPropagationLossModel (Ptr<SpectrumPropagationLossModel> model);
+
+  /**
+   * \param creator makes the node of a point of the map, with no mobility model
+   */
+  void SetProbeCreator (Callback<Ptr<Node> > creator);
+
+  /**
+   * Compute the map and write it to the output file.
+   */
+  void Run (void);
+
+  /**
+   * \param xIndex index of the point along the x axis
+   * \param yIndex index of the point along the y axis
+   * \return the SINR (linear) at the point, after Run
+   */
+  double GetSinr (uint32_t xIndex, uint32_t yIndex) const;
+
+private:
+  /// A transmitter of the map.
+  struct Transmitter
+  {
+    Ptr<MobilityModel> mobility;      ///< Position of the transmitter.
+    Ptr<const SpectrumValue> txPsd;   ///< Transmitted PSD.
+    Ptr<AntennaModel> antenna;        ///< Antenna, 0 if isotropic.
+    std::vector<double> bandWidths;   ///< Width of each band of the PSD, in Hz.
+    double txPower;                   ///< Power counted in the SINR, in W.
+  };
+
+  /// Received signal of one transmitter at one point.
+  struct Link
+  {
+    double gain;                     ///< Antenna gain and propagation loss, linear.
+    double power;                    ///< Received power, in W.
+    Ptr<SpectrumRxPsdTask> task;     ///< Task of the spectrum propagation loss model, or 0.
+    uint32_t psd;                    ///< Index of the PSD the task works on.
+  };
+
+  /// A block of points evaluated by the worker threads.
+  struct Block
+  {
+    NrRemEngine *engine;              ///< The engine.
+    uint32_t first;                   ///< Index of the first point.
+    uint32_t numPoints;               ///< Number of points.
+    std::vector<Ptr<MobilityModel> > probes;      ///< Receiver of each slot.
+    std::vector<Ptr<MobilityModel> > txMobility;  ///< Copies of the transmitter mobility models, by thread.
+    std::vector<Link> links;          ///< Links of each point, by transmitter.
+    std::vector<SpectrumValue> psds;  ///< PSDs the tasks work on.
+  };
+
+  /**
+   * Sum the power of a PSD over the bands counted in the SINR.
+   *
+   * \param values the first value of the PSD
+   * \param bandWidths the width of each band
+   * \return the power, in W
+   */
+  double GetPower (Values::const_iterator values, const std::vector<double> &bandWidths) const;
+
+  /**
+   * Create the receivers of the slots of the blocks and, with
+   * ParallelPropagationLoss, the copies of the transmitters of each thread.
+   *
+   * \param block the block
+   * \param numSlots the number of points of the largest block
+   * \param numThreads the number of threads
+   */
+  void CreateProbes (Block &block, uint32_t numSlots, uint32_t numThreads);
+
+  /**
+   * \param tx the transmitter
+   * \param txMobility the mobility model of the transmitter or a copy of it
+   * \param rxMobility the mobility model of the receiver
+   * \return the antenna gain and the propagation loss, in dB
+   */
+  double GetGainDb (const Transmitter &tx, const Ptr<MobilityModel> &txMobility,
+                    const Ptr<MobilityModel> &rxMobility) const;
+
+  /**
+   * Prepare the links of a block of points.
+   *
+   * \param block the block, whose first point and number of points are set
+   * \param pool the threads
+   */
+  void PrepareBlock (Block &block, SpectrumWorkerPool &pool);
+
+  /**
+   * Compute the gains of the points of a block given to a thread, on a
+   * worker thread.
+   *
+   * \param context the Block
+   * \param index the index of the thread
+   */
+  static void EvaluateGains (void *context, uint32_t index);
+
+  /**
+   * Finish the links of a point and compute its SINR, on a worker thread.
+   *
+   * \param context the Block
+   * \param index the index of the point in the block
+   */
+  static void EvaluatePoint (void *context, uint32_t index);
+
+  /// Write the map to the output file.
+  void Write (void) const;
+
+  std::vector<Transmitter> m_transmitters;  ///< The transmitters.
+  Ptr<PropagationLossModel> m_propagationLoss;  ///< The propagation loss model.
+  Ptr<SpectrumPropagationLossModel> m_spectrumPropagationLoss;  ///< The spectrum propagation loss model.
+  Callback<Ptr<Node> > m_probeCreator;  ///< Makes the nodes of the points, if set.
+
+  std::vector<double> m_sinr;  ///< SINR of each point, x-major.
+
+  double m_xMin;   ///< The `XMin` attribute.
+  double m_xMax;   ///< The `XMax` attribute.
+  uint16_t m_xRes; ///< The `XRes` attribute.
+  double m_yMin;   ///< The `YMin` attribute.
+  double m_yMax;   ///< The `YMax` attribute.
+  uint16_t m_yRes; ///< The `YRes` attribute.
+  double m_z;      ///< The `Z` attribute.
+  double m_noisePower;  ///< The `NoisePower` attribute.
+  int32_t m_rbId;       ///< The `RbId` attribute.
+  uint32_t m_maxPointsPerIteration;  ///< The `MaxPointsPerIteration` attribute.
+  uint32_t m_threads;   ///< The `Threads` attribute.
+  bool m_parallelPropagationLoss;  ///< The `ParallelPropagationLoss` attribute.
+  std::string m_outputFile;  ///< The `OutputFile` attribute.
+  bool m_binaryOutput;  ///< The `BinaryOutput` attribute.
+};
+
+} // namespace ns3
+
+#endif /* NR_REM_ENGINE_H */
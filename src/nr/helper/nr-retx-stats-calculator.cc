@@ -23,6 +23,7 @@
 
 #include "nr-retx-stats-calculator.h"
 #include "ns3/string.h"
+#include "ns3/boolean.h"
 #include "ns3/nstime.h"
 #include <ns3/log.h>
 #include <vector>
@@ -35,6 +36,7 @@ NS_LOG_COMPONENT_DEFINE ("NrRetxStatsCalculator");
 NS_OBJECT_ENSURE_REGISTERED ( NrRetxStatsCalculator);
 
 NrRetxStatsCalculator::NrRetxStatsCalculator ()
+  : m_binaryOutput (false)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -62,6 +64,11 @@ NrRetxStatsCalculator::GetTypeId (void)
                    StringValue ("UlRlcRetx.txt"),
                    MakeStringAccessor (&NrRetxStatsCalculator::m_retxUlFilename),
                    MakeStringChecker ())
+    .AddAttribute ("BinaryOutput",
+                   "Write the results as columnar binary traces (see ColumnarTraceFile) rather than text.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&NrRetxStatsCalculator::m_binaryOutput),
+                   MakeBooleanChecker ())
     ;
   return tid;
 }
@@ -76,26 +83,72 @@ void
 NrRetxStatsCalculator::RegisterRetxDl(uint64_t imsi, uint16_t cellId, 
 	uint16_t rnti, uint8_t lcid, uint32_t packetSize, uint32_t numRetx)
 {
-	if(!m_retxDlFile.is_open())
+  if (m_binaryOutput)
+    {
+      if (m_retxDlColumns == 0)
+        {
+          m_retxDlColumns = Create<ColumnarTraceFile> (m_retxDlFilename);
+          m_retxDlColumns->AddColumn ("time", ColumnarTraceFile::DOUBLE);
+          m_retxDlColumns->AddColumn ("cellId", ColumnarTraceFile::UINT16);
+          m_retxDlColumns->AddColumn ("IMSI", ColumnarTraceFile::UINT64);
+          m_retxDlColumns->AddColumn ("RNTI", ColumnarTraceFile::UINT16);
+          m_retxDlColumns->AddColumn ("LCID", ColumnarTraceFile::UINT8);
+          m_retxDlColumns->AddColumn ("size", ColumnarTraceFile::UINT32);
+          m_retxDlColumns->AddColumn ("numRetx", ColumnarTraceFile::UINT32);
+        }
+      m_retxDlColumns->Put (Simulator::Now ().GetSeconds ())
+        .Put (cellId)
+        .Put (imsi)
+        .Put (rnti)
+        .Put (lcid)
+        .Put (packetSize)
+        .Put (numRetx);
+      return;
+    }
+
+	if (m_retxDlFile == 0)
 	{
-	    m_retxDlFile.open(m_retxDlFilename.c_str());
+	    m_retxDlFile = AsyncTraceFile::Open (m_retxDlFilename);
 	    NS_LOG_LOGIC("File opened");
   	}
-	m_retxDlFile << Simulator::Now().GetSeconds() << " " << cellId << " " << imsi << " "
-		<< rnti << " " << (uint16_t) lcid << " " << packetSize << " " << numRetx << std::endl;
+	m_retxDlFile->GetStream () << Simulator::Now().GetSeconds() << " " << cellId << " " << imsi << " "
+		<< rnti << " " << (uint16_t) lcid << " " << packetSize << " " << numRetx << "\n";
 }
 
 void
 NrRetxStatsCalculator::RegisterRetxUl(uint64_t imsi, uint16_t cellId, 
 	uint16_t rnti, uint8_t lcid, uint32_t packetSize, uint32_t numRetx)
 {
-	if(!m_retxUlFile.is_open())
+  if (m_binaryOutput)
+    {
+      if (m_retxUlColumns == 0)
+        {
+          m_retxUlColumns = Create<ColumnarTraceFile> (m_retxUlFilename);
+          m_retxUlColumns->AddColumn ("time", ColumnarTraceFile::DOUBLE);
+          m_retxUlColumns->AddColumn ("cellId", ColumnarTraceFile::UINT16);
+          m_retxUlColumns->AddColumn ("IMSI", ColumnarTraceFile::UINT64);
+          m_retxUlColumns->AddColumn ("RNTI", ColumnarTraceFile::UINT16);
+          m_retxUlColumns->AddColumn ("LCID", ColumnarTraceFile::UINT8);
+          m_retxUlColumns->AddColumn ("size", ColumnarTraceFile::UINT32);
+          m_retxUlColumns->AddColumn ("numRetx", ColumnarTraceFile::UINT32);
+        }
+      m_retxUlColumns->Put (Simulator::Now ().GetSeconds ())
+        .Put (cellId)
+        .Put (imsi)
+        .Put (rnti)
+        .Put (lcid)
+        .Put (packetSize)
+        .Put (numRetx);
+      return;
+    }
+
+	if (m_retxUlFile == 0)
 	{
-	    m_retxUlFile.open(m_retxUlFilename.c_str());
+	    m_retxUlFile = AsyncTraceFile::Open (m_retxUlFilename);
 	    NS_LOG_LOGIC("File opened");
   	}
-	m_retxUlFile << Simulator::Now().GetSeconds() << " " << cellId << " " << imsi << " "
-		<< rnti << " " << (uint16_t) lcid << " " << packetSize << " " << numRetx << std::endl;
+	m_retxUlFile->GetStream () << Simulator::Now().GetSeconds() << " " << cellId << " " << imsi << " "
+		<< rnti << " " << (uint16_t) lcid << " " << packetSize << " " << numRetx << "\n";
 }
 
 }
\ No newline at end of file
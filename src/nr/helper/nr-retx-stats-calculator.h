@@ -31,7 +31,8 @@
 #include "ns3/nr-common.h"
 #include <string>
 #include <map>
-#include <fstream>
+#include "ns3/async-trace-file.h"
+#include "ns3/columnar-trace-file.h"
 
 namespace ns3
 {
@@ -61,11 +62,15 @@ public:
   void RegisterRetxDl(uint64_t imsi, uint16_t cellId, uint16_t rnti, uint8_t lcid, uint32_t packetSize, uint32_t numRetx);
   void RegisterRetxUl(uint64_t imsi, uint16_t cellId, uint16_t rnti, uint8_t lcid, uint32_t packetSize, uint32_t numRetx);
 
-  std::ofstream m_retxDlFile;
+  Ptr<AsyncTraceFile> m_retxDlFile;
+  Ptr<ColumnarTraceFile> m_retxDlColumns;
   std::string m_retxDlFilename;
 
-  std::ofstream m_retxUlFile;
+  Ptr<AsyncTraceFile> m_retxUlFile;
+  Ptr<ColumnarTraceFile> m_retxUlColumns;
   std::string m_retxUlFilename;
+
+  bool m_binaryOutput;
 };
 
 }
@@ -22,6 +22,7 @@
 
 #include <ns3/log.h>
 #include <ns3/config.h>
+#include <ns3/boolean.h>
 #include <ns3/nr-enb-rrc.h>
 #include <ns3/nr-ue-rrc.h>
 #include <ns3/nr-enb-net-device.h>
@@ -35,7 +36,8 @@ NS_OBJECT_ENSURE_REGISTERED (NrStatsCalculator);
 
 NrStatsCalculator::NrStatsCalculator ()
   : m_dlOutputFilename (""),
-    m_ulOutputFilename ("")
+    m_ulOutputFilename (""),
+    m_binaryOutput (false)
 {
   // Nothing to do here
 
@@ -54,6 +56,12 @@ NrStatsCalculator::GetTypeId (void)
     .SetParent<Object> ()
     .SetGroupName("Nr")
     .AddConstructor<NrStatsCalculator> ()
+    .AddAttribute ("BinaryOutput",
+                   "Write the results as columnar binary traces (see ColumnarTraceFile) rather than text.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&NrStatsCalculator::SetBinaryOutput,
+                                        &NrStatsCalculator::GetBinaryOutput),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
@@ -83,6 +91,18 @@ NrStatsCalculator::GetDlOutputFilename (void)
   return m_dlOutputFilename;
 }
 
+void
+NrStatsCalculator::SetBinaryOutput (bool binaryOutput)
+{
+  m_binaryOutput = binaryOutput;
+}
+
+bool
+NrStatsCalculator::GetBinaryOutput (void) const
+{
+  return m_binaryOutput;
+}
+
 
 bool
 NrStatsCalculator::ExistsImsiPath (std::string path)
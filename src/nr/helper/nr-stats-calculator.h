@@ -80,6 +80,18 @@ public:
    */
   std::string GetDlOutputFilename (void);
 
+  /**
+   * Set whether the statistics are written as columnar binary traces.
+   * @param binaryOutput true for ColumnarTraceFile output, false for text
+   */
+  void SetBinaryOutput (bool binaryOutput);
+
+  /**
+   * Get whether the statistics are written as columnar binary traces.
+   * @return true for ColumnarTraceFile output, false for text
+   */
+  bool GetBinaryOutput (void) const;
+
   /**
    * Checks if there is an already stored IMSI for the given path
    * @param path Path in the attribute system to check
@@ -204,6 +216,11 @@ private:
    * Name of the file where the uplink results will be saved
    */
   std::string m_ulOutputFilename;
+
+  /**
+   * True if the results are written as columnar binary traces
+   */
+  bool m_binaryOutput;
 };
 
 } // namespace ns3
@@ -588,6 +588,7 @@ NgcN2apAmf::DoDispose (void)
   m_n2apInterfaceSockets.clear ();
   m_n2apInterfaceCellIds.clear ();
   delete m_n2apSapProvider;
+  m_processingDelay = MakeNullCallback<Time, uint32_t> ();
 }
 
 TypeId
@@ -633,6 +634,33 @@ NgcN2apAmf::RecvFromN2apSocket (Ptr<Socket> socket)
   Ptr<Packet> packet = socket->Recv ();
   NS_LOG_LOGIC ("packetLen = " << packet->GetSize ());
 
+  Time delay = m_processingDelay.IsNull () ? Seconds (0) : m_processingDelay (packet->GetSize ());
+  if (delay.IsStrictlyNegative ())
+    {
+      NS_LOG_WARN ("N2AP message dropped by the AMF");
+    }
+  else if (delay.IsStrictlyPositive ())
+    {
+      Simulator::Schedule (delay, &NgcN2apAmf::ProcessN2apPacket, this, packet);
+    }
+  else
+    {
+      ProcessN2apPacket (packet);
+    }
+}
+
+void
+NgcN2apAmf::SetProcessingDelayCallback (Callback<Time, uint32_t> cb)
+{
+  NS_LOG_FUNCTION (this);
+  m_processingDelay = cb;
+}
+
+void
+NgcN2apAmf::ProcessN2apPacket (Ptr<Packet> packet)
+{
+  NS_LOG_FUNCTION (this << packet);
+
   NgcN2APHeader n2apHeader;
   packet->RemoveHeader (n2apHeader);
 
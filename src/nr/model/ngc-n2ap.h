@@ -26,6 +26,7 @@
 #include "ns3/callback.h"
 #include "ns3/ptr.h"
 #include "ns3/object.h"
+#include "ns3/nstime.h"
 
 #include "ns3/ngc-n2ap-sap.h"
 
@@ -219,6 +220,16 @@ public:
    */
   void RecvFromN2apSocket (Ptr<Socket> socket);
 
+  /**
+   * Set the callback giving the queueing and processing delay of the AMF
+   * for each N2ap message received. The message is handled once the
+   * delay has elapsed, and dropped if the delay is negative; without a
+   * callback it is handled at once.
+   *
+   * \param cb the callback, taking the size of the message in bytes
+   */
+  void SetProcessingDelayCallback (Callback<Time, uint32_t> cb);
+
 
 protected:
   // Interface provided by NgcN2apSapAmfProvider
@@ -273,6 +284,15 @@ private:
 
   Ptr<Socket> m_localN2APSocket; // local socket to receive from the eNBs N2AP endpoints
 
+  Callback<Time, uint32_t> m_processingDelay; // queueing and processing delay of a N2AP message
+
+  /**
+   * Handle a N2ap message received from an eNB
+   *
+   * \param packet the message
+   */
+  void ProcessN2apPacket (Ptr<Packet> packet);
+
 };
 
 } //namespace ns3
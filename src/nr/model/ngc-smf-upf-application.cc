@@ -31,11 +31,14 @@
 #include "ns3/inet-socket-address.h"
 #include "ns3/ngc-gtpu-header.h"
 #include "ns3/abort.h"
+#include "ns3/simulator.h"
 
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("NgcSmfUpfApplication");
 
+static const uint32_t MAX_CACHED_FLOWS = 4096;
+
 /////////////////////////
 // UeInfo
 /////////////////////////
@@ -51,6 +54,7 @@ NgcSmfUpfApplication::UeInfo::AddBearer (Ptr<NgcTft> tft, uint8_t bearerId, uint
 {
   NS_LOG_FUNCTION (this << tft << teid);
   m_teidByBearerIdMap[bearerId] = teid;
+  m_teidByFlow.clear ();
   return m_tftClassifier.Add (tft, teid);
 }
 
@@ -58,17 +62,40 @@ void
 NgcSmfUpfApplication::UeInfo::RemoveBearer (uint8_t bearerId)
 {
   NS_LOG_FUNCTION (this << bearerId);
-  m_teidByBearerIdMap.erase (bearerId);
+  std::map<uint8_t, uint32_t>::iterator it = m_teidByBearerIdMap.find (bearerId);
+  if (it != m_teidByBearerIdMap.end ())
+    {
+      // the TFT used to stay, and to match packets to a TEID without tunnel
+      m_tftClassifier.Delete (it->second);
+      m_teidByBearerIdMap.erase (it);
+    }
+  m_teidByFlow.clear ();
 }
 
 uint32_t
-NgcSmfUpfApplication::UeInfo::Classify (Ptr<Packet> p)
+NgcSmfUpfApplication::UeInfo::Classify (const NgcTftClassifier::PacketFields &fields)
 {
-  NS_LOG_FUNCTION (this << p);
+  NS_LOG_FUNCTION (this);
+  FlowKey key;
+  key.remoteAddrAndPorts = ((uint64_t) fields.source.Get () << 32)
+    | ((uint32_t) fields.sourcePort << 16) | fields.destinationPort;
+  key.protocolAndTos = (fields.protocol << 8) | fields.tos;
+  std::unordered_map<FlowKey, uint32_t, FlowKeyHash>::const_iterator it = m_teidByFlow.find (key);
+  if (it != m_teidByFlow.end ())
+    {
+      return it->second;
+    }
   // we hardcode DOWNLINK direction since the UPF is espected to
   // classify only downlink packets (uplink packets will go to the
   // internet without any classification). 
-  return m_tftClassifier.Classify (p, NgcTft::DOWNLINK);
+  uint32_t teid = m_tftClassifier.Classify (fields, NgcTft::DOWNLINK);
+  // the flows of a long run are not bounded, start over instead of evicting one by one
+  if (m_teidByFlow.size () >= MAX_CACHED_FLOWS)
+    {
+      m_teidByFlow.clear ();
+    }
+  m_teidByFlow[key] = teid;
+  return teid;
 }
 
 Ipv4Address 
@@ -115,6 +142,7 @@ NgcSmfUpfApplication::DoDispose ()
   NS_LOG_FUNCTION (this);
   m_n2uSocket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
   m_n2uSocket = 0;
+  m_processingDelay = MakeNullCallback<Time, uint32_t> ();
   delete (m_n11SapSmf);
 }
 
@@ -144,15 +172,18 @@ NgcSmfUpfApplication::RecvFromTunDevice (Ptr<Packet> packet, const Address& sour
 {
   NS_LOG_FUNCTION (this << source << dest << packet << packet->GetSize ());
 
-  // get IP address of UE
-  Ptr<Packet> pCopy = packet->Copy ();
-  Ipv4Header ipv4Header;
-  pCopy->RemoveHeader (ipv4Header);
-  Ipv4Address ueAddr =  ipv4Header.GetDestination ();
+  // get IP address of UE, the headers are read once for the lookup and the classification
+  NgcTftClassifier::PacketFields fields;
+  if (!NgcTftClassifier::PeekPacketFields (packet, fields))
+    {
+      NS_LOG_WARN ("packet too short for an IPv4 header");
+      return true;
+    }
+  Ipv4Address ueAddr = fields.destination;
   NS_LOG_LOGIC ("packet addressed to UE " << ueAddr);
 
   // find corresponding UeInfo address
-  std::map<Ipv4Address, Ptr<UeInfo> >::iterator it = m_ueInfoByAddrMap.find (ueAddr);
+  std::unordered_map<Ipv4Address, Ptr<UeInfo>, Ipv4AddressHash>::iterator it = m_ueInfoByAddrMap.find (ueAddr);
   if (it == m_ueInfoByAddrMap.end ())
     {        
       NS_LOG_WARN ("unknown UE address " << ueAddr);
@@ -160,14 +191,26 @@ NgcSmfUpfApplication::RecvFromTunDevice (Ptr<Packet> packet, const Address& sour
   else
     {
       Ipv4Address enbAddr = it->second->GetEnbAddr ();      
-      uint32_t teid = it->second->Classify (packet);   
+      uint32_t teid = it->second->Classify (fields);
       if (teid == 0)
         {
           NS_LOG_WARN ("no matching bearer for this packet");                   
         }
       else
         {
-          SendToN2uSocket (packet, enbAddr, teid);
+          Time delay = GetProcessingDelay (packet->GetSize ());
+          if (delay.IsStrictlyNegative ())
+            {
+              NS_LOG_WARN ("downlink packet dropped by the SMF/UPF");
+            }
+          else if (delay.IsStrictlyPositive ())
+            {
+              Simulator::Schedule (delay, &NgcSmfUpfApplication::SendToN2uSocket, this, packet, enbAddr, teid);
+            }
+          else
+            {
+              SendToN2uSocket (packet, enbAddr, teid);
+            }
         }
     }
   // there is no reason why we should notify the TUN
@@ -192,7 +235,19 @@ NgcSmfUpfApplication::RecvFromN2uSocket (Ptr<Socket> socket)
   //SocketAddressTag tag;
   //packet->RemovePacketTag (tag);
 
-  SendToTunDevice (packet, teid);
+  Time delay = GetProcessingDelay (packet->GetSize ());
+  if (delay.IsStrictlyNegative ())
+    {
+      NS_LOG_WARN ("uplink packet dropped by the SMF/UPF");
+    }
+  else if (delay.IsStrictlyPositive ())
+    {
+      Simulator::Schedule (delay, &NgcSmfUpfApplication::SendToTunDevice, this, packet, teid);
+    }
+  else
+    {
+      SendToTunDevice (packet, teid);
+    }
 }
 
 void 
@@ -219,6 +274,42 @@ NgcSmfUpfApplication::SendToN2uSocket (Ptr<Packet> packet, Ipv4Address enbAddr,
 }
 
 
+void
+NgcSmfUpfApplication::SetProcessingDelayCallback (Callback<Time, uint32_t> cb)
+{
+  NS_LOG_FUNCTION (this);
+  m_processingDelay = cb;
+}
+
+Time
+NgcSmfUpfApplication::GetProcessingDelay (uint32_t size)
+{
+  if (m_processingDelay.IsNull ())
+    {
+      return Seconds (0);
+    }
+  return m_processingDelay (size);
+}
+
+template <typename T>
+void
+NgcSmfUpfApplication::SendToAmf (void (NgcN11SapAmf::*send) (T), T msg)
+{
+  Time delay = GetProcessingDelay (0);
+  if (delay.IsStrictlyNegative ())
+    {
+      NS_LOG_WARN ("N11 message dropped by the SMF/UPF");
+    }
+  else if (delay.IsStrictlyPositive ())
+    {
+      Simulator::Schedule (delay, send, m_n11SapAmf, msg);
+    }
+  else
+    {
+      (m_n11SapAmf->*send) (msg);
+    }
+}
+
 void 
 NgcSmfUpfApplication::SetN11SapAmf (NgcN11SapAmf * s)
 {
@@ -293,7 +384,7 @@ NgcSmfUpfApplication::DoCreateSessionRequest (NgcN11SapSmf::CreateSessionRequest
       bearerContext.tft = bit->tft;
       res.bearerContextsCreated.push_back (bearerContext);
     }
-  m_n11SapAmf->CreateSessionResponse (res);
+  SendToAmf (&NgcN11SapAmf::CreateSessionResponse, res);
   
 }
 
@@ -339,7 +430,7 @@ NgcSmfUpfApplication::DoUpdateSMContextRequest (NgcN11SapSmf::UpdateSMContextReq
       bearerContext.tft = bit->tft;*/
       res.n2SMInformationCreated.push_back (n2SMInformation);
     }
-  m_n11SapAmf->UpdateSMContextResponse (res);
+  SendToAmf (&NgcN11SapAmf::UpdateSMContextResponse, res);
   
 }
 void 
@@ -358,7 +449,7 @@ NgcSmfUpfApplication::DoModifyBearerRequest (NgcN11SapSmf::ModifyBearerRequestMe
   NgcN11SapAmf::ModifyBearerResponseMessage res;
   res.teid = imsi; // trick to avoid the need for allocating TEIDs on the N11 interface
   res.cause = NgcN11SapAmf::ModifyBearerResponseMessage::REQUEST_ACCEPTED;
-  m_n11SapAmf->ModifyBearerResponse (res);
+  SendToAmf (&NgcN11SapAmf::ModifyBearerResponse, res);
 }
  
 void
@@ -381,7 +472,7 @@ NgcSmfUpfApplication::DoDeleteBearerCommand (NgcN11SapSmf::DeleteBearerCommandMe
       res.bearerContextsRemoved.push_back (bearerContext);
     }
   //schedules Delete Bearer Request towards AMF
-  m_n11SapAmf->DeleteBearerRequest (res);
+  SendToAmf (&NgcN11SapAmf::DeleteBearerRequest, res);
 }
 
 void
@@ -29,6 +29,7 @@
 #include <ns3/callback.h>
 #include <ns3/ptr.h>
 #include <ns3/object.h>
+#include <ns3/nstime.h>
 #include <ns3/eps-bearer.h>
 #include <ns3/ngc-tft.h>
 #include <ns3/ngc-tft-classifier.h>
@@ -37,6 +38,9 @@
 #include <ns3/ngc-n2ap-sap.h>
 #include <ns3/ngc-n11-sap.h>
 #include <map>
+#include <unordered_map>
+
+class NgcUpfFlowCacheTestCase;
 
 namespace ns3 {
 
@@ -48,6 +52,8 @@ namespace ns3 {
 class NgcSmfUpfApplication : public Application
 {
   friend class MemberNgcN11SapSmf<NgcSmfUpfApplication>;
+  /// allow the test to check the flow cache of UeInfo
+  friend class ::NgcUpfFlowCacheTestCase;
 
 public:
 
@@ -150,8 +156,35 @@ public:
    */
   void SetUeAddress (uint64_t imsi, Ipv4Address ueAddr);
 
+  /**
+   * Set the callback giving the queueing and processing delay of the
+   * SMF/UPF for each GTP-U packet and N11 request received. A packet is
+   * forwarded, and the answer to a request sent, once the delay has
+   * elapsed, and they are dropped if the delay is negative; without a
+   * callback they are at once.
+   *
+   * \param cb the callback, taking the size of the packet in bytes (0 for
+   * a N11 request)
+   */
+  void SetProcessingDelayCallback (Callback<Time, uint32_t> cb);
+
 private:
 
+  /**
+   * \param size the size of the packet, 0 for a N11 request
+   * \return the queueing and processing delay of the packet
+   */
+  Time GetProcessingDelay (uint32_t size);
+
+  /**
+   * Send a N11 message to the AMF after the processing delay
+   *
+   * \param send the method of the N11 SAP sending the message
+   * \param msg the message
+   */
+  template <typename T>
+  void SendToAmf (void (NgcN11SapAmf::*send) (T), T msg);
+
   // N11 SAP SMF methods
   void DoCreateSessionRequest (NgcN11SapSmf::CreateSessionRequestMessage msg);
   void DoUpdateSMContextRequest (NgcN11SapSmf::UpdateSMContextRequestMessage msg);
@@ -166,6 +199,8 @@ private:
    */
   class UeInfo : public SimpleRefCount<UeInfo>
   {
+    friend class ::NgcUpfFlowCacheTestCase;
+
 public:
     UeInfo ();  
 
@@ -179,20 +214,26 @@ public:
 
     /** 
      * \brief Function, deletes contexts of bearer on SMF and UPF side
+     *
+     * The TFT of the bearer is removed from the classifier too, so that
+     * its downlink packets are no longer sent to the TEID of the removed
+     * bearer but classified against the remaining TFTs.
+     *
      * \param bearerId, the Bearer Id whose contexts to be removed
      */
     void RemoveBearer (uint8_t bearerId);
 
     /**
+     * The result is cached per flow, so that the TFTs are evaluated
+     * only for the first packet of each flow.
      * 
-     * 
-     * \param p the IP packet from the internet to be classified
+     * \param fields the fields of the IP packet from the internet to be classified
      * 
      * \return the corresponding bearer ID > 0 identifying the bearer
      * among all the bearers of this UE;  returns 0 if no bearers
      * matches with the previously declared TFTs
      */
-    uint32_t Classify (Ptr<Packet> p);
+    uint32_t Classify (const NgcTftClassifier::PacketFields &fields);
 
     /** 
      * \return the address of the eNB to which the UE is connected
@@ -220,10 +261,31 @@ public:
 
 
   private:
+    /**
+     * Downlink flow, the local address being the UE address
+     */
+    struct FlowKey
+    {
+      uint64_t remoteAddrAndPorts; ///< remote address, remote port and local port
+      uint16_t protocolAndTos;
+      bool operator== (const FlowKey &other) const
+      {
+        return remoteAddrAndPorts == other.remoteAddrAndPorts && protocolAndTos == other.protocolAndTos;
+      }
+    };
+    struct FlowKeyHash
+    {
+      size_t operator() (const FlowKey &key) const
+      {
+        return std::hash<uint64_t> () (key.remoteAddrAndPorts ^ ((uint64_t) key.protocolAndTos << 48));
+      }
+    };
+
     NgcTftClassifier m_tftClassifier;
     Ipv4Address m_enbAddr;
     Ipv4Address m_ueAddr;
     std::map<uint8_t, uint32_t> m_teidByBearerIdMap;
+    std::unordered_map<FlowKey, uint32_t, FlowKeyHash> m_teidByFlow; ///< cache of the TFT classification
   };
 
 
@@ -241,7 +303,7 @@ public:
   /**
    * Map telling for each UE address the corresponding UE info 
    */
-  std::map<Ipv4Address, Ptr<UeInfo> > m_ueInfoByAddrMap;
+  std::unordered_map<Ipv4Address, Ptr<UeInfo>, Ipv4AddressHash> m_ueInfoByAddrMap;
 
   /**
    * Map telling for each IMSI the corresponding UE info 
@@ -274,6 +336,11 @@ public:
   };
 
   std::map<uint16_t, EnbInfo> m_enbInfoByCellId;
+
+  /**
+   * Queueing and processing delay of a packet or N11 request
+   */
+  Callback<Time, uint32_t> m_processingDelay;
 };
 
 } //namespace ns3
@@ -31,11 +31,11 @@
 #include "ns3/log.h"
 #include "ns3/packet.h"
 #include "ns3/ipv4-header.h"
-#include "ns3/udp-header.h"
-#include "ns3/tcp-header.h"
 #include "ns3/udp-l4-protocol.h"
 #include "ns3/tcp-l4-protocol.h"
 
+#include <algorithm>
+
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("NgcTftClassifier");
@@ -54,6 +54,8 @@ NgcTftClassifier::Add (Ptr<NgcTft> tft, uint32_t id)
   
   // simple sanity check: there shouldn't be more than 16 bearers (hence TFTs) per UE
   NS_ASSERT (m_tftMap.size () <= 16);
+
+  Compile ();
 }
 
 void
@@ -61,76 +63,201 @@ NgcTftClassifier::Delete (uint32_t id)
 {
   NS_LOG_FUNCTION (this << id);
   m_tftMap.erase (id);
+  Compile ();
+}
+
+bool
+NgcTftClassifier::FilterKey::operator == (const FilterKey &other) const
+{
+  return remoteAddress == other.remoteAddress
+    && localAddress == other.localAddress
+    && remotePort == other.remotePort
+    && localPort == other.localPort
+    && tos == other.tos;
+}
+
+size_t
+NgcTftClassifier::FilterKeyHash::operator () (const FilterKey &key) const
+{
+  uint64_t h = ((uint64_t) key.remoteAddress << 32) | key.localAddress;
+  h ^= ((uint64_t) key.remotePort << 24 | (uint64_t) key.localPort << 8 | key.tos) * 0x9e3779b97f4a7c15ULL;
+  h ^= h >> 29;
+  return h;
+}
+
+namespace {
+
+/**
+ * Order the filter groups by decreasing highest TFT id
+ */
+struct HigherMaxId
+{
+  template <class G>
+  bool operator () (const G &a, const G &b) const
+  {
+    return a.maxId > b.maxId;
+  }
+};
+
+} // anonymous namespace
+
+void
+NgcTftClassifier::AddFilter (std::vector<FilterGroup> &groups, const NgcTft::PacketFilter &f, uint32_t id)
+{
+  if (f.remotePortStart > f.remotePortEnd || f.localPortStart > f.localPortEnd)
+    {
+      return; // matches no packet
+    }
+  uint32_t remoteMask = f.remoteMask.Get ();
+  uint32_t localMask = f.localMask.Get ();
+  bool exactRemotePort = f.remotePortStart == f.remotePortEnd;
+  bool exactLocalPort = f.localPortStart == f.localPortEnd;
+  uint8_t tosMask = f.typeOfServiceMask;
+
+  std::vector<FilterGroup>::iterator group;
+  for (group = groups.begin (); group != groups.end (); ++group)
+    {
+      if (group->remoteMask == remoteMask && group->localMask == localMask
+          && group->exactRemotePort == exactRemotePort && group->exactLocalPort == exactLocalPort
+          && group->tosMask == tosMask)
+        {
+          break;
+        }
+    }
+  if (group == groups.end ())
+    {
+      FilterGroup newGroup;
+      newGroup.remoteMask = remoteMask;
+      newGroup.localMask = localMask;
+      newGroup.exactRemotePort = exactRemotePort;
+      newGroup.exactLocalPort = exactLocalPort;
+      newGroup.tosMask = tosMask;
+      newGroup.maxId = 0;
+      group = groups.insert (groups.end (), newGroup);
+    }
+
+  FilterKey key;
+  key.remoteAddress = f.remoteAddress.Get () & remoteMask;
+  key.localAddress = f.localAddress.Get () & localMask;
+  key.remotePort = exactRemotePort ? f.remotePortStart : 0;
+  key.localPort = exactLocalPort ? f.localPortStart : 0;
+  key.tos = f.typeOfService & tosMask;
+
+  CompiledFilter compiled;
+  compiled.id = id;
+  compiled.remotePortStart = f.remotePortStart;
+  compiled.remotePortEnd = f.remotePortEnd;
+  compiled.localPortStart = f.localPortStart;
+  compiled.localPortEnd = f.localPortEnd;
+  group->filters[key].push_back (compiled);
+  group->maxId = std::max (group->maxId, id);
+}
+
+void
+NgcTftClassifier::Compile ()
+{
+  NS_LOG_FUNCTION (this);
+  m_groups[0].clear ();
+  m_groups[1].clear ();
+  for (std::map <uint32_t, Ptr<NgcTft> >::const_iterator it = m_tftMap.begin ();
+       it != m_tftMap.end ();
+       ++it)
+    {
+      const std::list<NgcTft::PacketFilter> &filters = it->second->GetPacketFilters ();
+      for (std::list<NgcTft::PacketFilter>::const_iterator f = filters.begin ();
+           f != filters.end ();
+           ++f)
+        {
+          if (f->direction & NgcTft::DOWNLINK)
+            {
+              AddFilter (m_groups[0], *f, it->first);
+            }
+          if (f->direction & NgcTft::UPLINK)
+            {
+              AddFilter (m_groups[1], *f, it->first);
+            }
+        }
+    }
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      std::stable_sort (m_groups[i].begin (), m_groups[i].end (), HigherMaxId ());
+      NS_LOG_LOGIC ("direction " << i << ": " << m_groups[i].size () << " filter groups");
+    }
 }
 
  
+bool
+NgcTftClassifier::PeekPacketFields (Ptr<const Packet> p, PacketFields &fields)
+{
+  // IPv4 header with the longest options, followed by the ports of the UDP or TCP header
+  uint8_t buffer[64];
+  uint32_t size = p->CopyData (buffer, sizeof (buffer));
+  if (size < 20)
+    {
+      return false;
+    }
+  uint32_t ihl = (buffer[0] & 0x0f) * 4;
+  fields.tos = buffer[1];
+  fields.protocol = buffer[9];
+  fields.source = Ipv4Address::Deserialize (buffer + 12);
+  fields.destination = Ipv4Address::Deserialize (buffer + 16);
+  fields.sourcePort = 0;
+  fields.destinationPort = 0;
+  if ((fields.protocol == UdpL4Protocol::PROT_NUMBER || fields.protocol == TcpL4Protocol::PROT_NUMBER)
+      && ihl >= 20 && size >= ihl + 4)
+    {
+      // the ports are the first two fields of both headers
+      fields.sourcePort = (buffer[ihl] << 8) | buffer[ihl + 1];
+      fields.destinationPort = (buffer[ihl + 2] << 8) | buffer[ihl + 3];
+    }
+  return true;
+}
+
 uint32_t 
 NgcTftClassifier::Classify (Ptr<Packet> p, NgcTft::Direction direction)
 {
   NS_LOG_FUNCTION (this << p << direction);
 
-  Ptr<Packet> pCopy = p->Copy ();
+  PacketFields fields;
+  if (!PeekPacketFields (p, fields))
+    {
+      NS_LOG_INFO ("Packet too short for an IPv4 header");
+      return 0;  // no match
+    }
+  return Classify (fields, direction);
+}
 
-  Ipv4Header ipv4Header;
-  pCopy->RemoveHeader (ipv4Header);
+uint32_t 
+NgcTftClassifier::Classify (const PacketFields &fields, NgcTft::Direction direction) const
+{
+  NS_LOG_FUNCTION (this << direction);
 
   Ipv4Address localAddress;
   Ipv4Address remoteAddress;
-
+  uint16_t localPort;
+  uint16_t remotePort;
   
   if (direction ==  NgcTft::UPLINK)
     {
-      localAddress = ipv4Header.GetSource ();
-      remoteAddress = ipv4Header.GetDestination ();
+      localAddress = fields.source;
+      remoteAddress = fields.destination;
+      localPort = fields.sourcePort;
+      remotePort = fields.destinationPort;
     }
   else
     { 
       NS_ASSERT (direction ==  NgcTft::DOWNLINK);
-      remoteAddress = ipv4Header.GetSource ();
-      localAddress = ipv4Header.GetDestination ();      
+      remoteAddress = fields.source;
+      localAddress = fields.destination;
+      remotePort = fields.sourcePort;
+      localPort = fields.destinationPort;
     }
-  
-  uint8_t protocol = ipv4Header.GetProtocol ();
-
-  uint8_t tos = ipv4Header.GetTos ();
 
-  uint16_t localPort = 0;
-  uint16_t remotePort = 0;
+  uint8_t tos = fields.tos;
 
-  if (protocol == UdpL4Protocol::PROT_NUMBER)
-    {
-      UdpHeader udpHeader;
-      pCopy->RemoveHeader (udpHeader);
-
-      if (direction ==  NgcTft::UPLINK)
-	{
-	  localPort = udpHeader.GetSourcePort ();
-	  remotePort = udpHeader.GetDestinationPort ();
-	}
-      else
-	{
-	  remotePort = udpHeader.GetSourcePort ();
-	  localPort = udpHeader.GetDestinationPort ();
-	}
-    }
-  else if (protocol == TcpL4Protocol::PROT_NUMBER)
+  if (fields.protocol != UdpL4Protocol::PROT_NUMBER && fields.protocol != TcpL4Protocol::PROT_NUMBER)
     {
-      TcpHeader tcpHeader;
-      pCopy->RemoveHeader (tcpHeader);
-      if (direction ==  NgcTft::UPLINK)
-	{
-	  localPort = tcpHeader.GetSourcePort ();
-	  remotePort = tcpHeader.GetDestinationPort ();
-	}
-      else
-	{
-	  remotePort = tcpHeader.GetSourcePort ();
-	  localPort = tcpHeader.GetDestinationPort ();
-	}
-    }
-  else
-    {
-      NS_LOG_INFO ("Unknown protocol: " << protocol);
+      NS_LOG_INFO ("Unknown protocol: " << (uint16_t) fields.protocol);
       return 0;  // no match
     }
 
@@ -142,21 +269,43 @@ NgcTftClassifier::Classify (Ptr<Packet> p, NgcTft::Direction direction)
 	       << " tos=0x" << (uint16_t) tos );
 
   // now it is possible to classify the packet!
-  // we use a reverse iterator since filter priority is not implemented properly.
-  // This way, since the default bearer is expected to be added first, it will be evaluated last.
-  std::map <uint32_t, Ptr<NgcTft> >::const_reverse_iterator it;
-  NS_LOG_LOGIC ("TFT MAP size: " << m_tftMap.size ());
-
-  for (it = m_tftMap.rbegin (); it != m_tftMap.rend (); ++it)
+  // Filter priority is not implemented properly: the TFT with the highest id
+  // among the matching ones is selected. This way, since the default bearer
+  // is expected to be added first, it will be selected last.
+  const std::vector<FilterGroup> &groups = m_groups[direction == NgcTft::UPLINK ? 1 : 0];
+  uint32_t match = 0;
+  for (std::vector<FilterGroup>::const_iterator group = groups.begin ();
+       group != groups.end () && group->maxId > match;
+       ++group)
     {
-      NS_LOG_LOGIC ("TFT id: " << it->first );
-      NS_LOG_LOGIC (" Ptr<NgcTft>: " << it->second);
-      Ptr<NgcTft> tft = it->second;         
-      if (tft->Matches (direction, remoteAddress, localAddress, remotePort, localPort, tos))
+      FilterKey key;
+      key.remoteAddress = remoteAddress.Get () & group->remoteMask;
+      key.localAddress = localAddress.Get () & group->localMask;
+      key.remotePort = group->exactRemotePort ? remotePort : 0;
+      key.localPort = group->exactLocalPort ? localPort : 0;
+      key.tos = tos & group->tosMask;
+      std::unordered_map<FilterKey, std::vector<CompiledFilter>, FilterKeyHash>::const_iterator candidates
+        = group->filters.find (key);
+      if (candidates == group->filters.end ())
         {
-	  NS_LOG_LOGIC ("matches with TFT ID = " << it->first);
-	  return it->first; // the id of the matching TFT
+          continue;
         }
+      for (std::vector<CompiledFilter>::const_iterator f = candidates->second.begin ();
+           f != candidates->second.end ();
+           ++f)
+        {
+          if (f->id > match
+              && remotePort >= f->remotePortStart && remotePort <= f->remotePortEnd
+              && localPort >= f->localPortStart && localPort <= f->localPortEnd)
+            {
+              match = f->id;
+            }
+        }
+    }
+  if (match != 0)
+    {
+      NS_LOG_LOGIC ("matches with TFT ID = " << match);
+      return match; // the id of the matching TFT
     }
   NS_LOG_LOGIC ("no match");
   return 0;  // no match
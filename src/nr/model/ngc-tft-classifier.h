@@ -25,9 +25,12 @@
 
 #include "ns3/ptr.h"
 #include "ns3/simple-ref-count.h"
+#include "ns3/ipv4-address.h"
 #include "ns3/ngc-tft.h"
 
 #include <map>
+#include <vector>
+#include <unordered_map>
 
 
 namespace ns3 {
@@ -38,11 +41,36 @@ class Packet;
 /**
  * \brief classifies IP packets accoding to Traffic Flow Templates (TFTs)
  * 
+ * The packet filters of all the TFTs are compiled into an index when a TFT
+ * is added or deleted. The filters are grouped by the combination of
+ * masks they use (remote and local address masks, exact or ranged ports,
+ * type of service mask), and each group is a hash table keyed by the
+ * masked fields. A packet is thus classified with one lookup per group
+ * instead of a scan of every filter of every TFT, and the groups that
+ * cannot contain a TFT with a higher id than the best match so far are
+ * skipped.
+ *
+ * \note the packet filters added to a TFT after the TFT is added to the
+ * classifier are not taken into account.
+ *
  * \note this implementation works with IPv4 only.
  */
 class NgcTftClassifier : public SimpleRefCount<NgcTftClassifier>
 {
 public:
+
+  /**
+   * The fields of an IPv4 packet that the TFTs are matched against
+   */
+  struct PacketFields
+  {
+    Ipv4Address source;
+    Ipv4Address destination;
+    uint16_t sourcePort;      ///< 0 if the packet is neither UDP nor TCP
+    uint16_t destinationPort; ///< 0 if the packet is neither UDP nor TCP
+    uint8_t protocol;
+    uint8_t tos;
+  };
   
   NgcTftClassifier ();
   
@@ -70,10 +98,100 @@ public:
    * \return the identifier (>0) of the first TFT that matches with the IP packet; 0 if no TFT matched.
    */
   uint32_t Classify (Ptr<Packet> p, NgcTft::Direction direction);
+
+  /** 
+   * classify an IP packet whose fields were already read
+   * 
+   * \param fields the fields of the IP packet
+   * \param direction the direction of the packet
+   * 
+   * \return the identifier (>0) of the first TFT that matches with the IP packet; 0 if no TFT matched.
+   */
+  uint32_t Classify (const PacketFields &fields, NgcTft::Direction direction) const;
+
+  /** 
+   * read the fields used for the classification from the serialized
+   * headers of an IP packet, without copying it or removing the headers
+   * 
+   * \param p the IP packet. It is assumed that the outmost header is an IPv4 header.
+   * \param fields the fields of the IP packet
+   * 
+   * \return false if the packet is too short to hold an IPv4 header
+   */
+  static bool PeekPacketFields (Ptr<const Packet> p, PacketFields &fields);
   
 protected:
   
   std::map <uint32_t, Ptr<NgcTft> > m_tftMap;
+
+private:
+
+  /**
+   * The fields of a packet, masked as required by a group of filters
+   */
+  struct FilterKey
+  {
+    uint32_t remoteAddress;
+    uint32_t localAddress;
+    uint16_t remotePort;  ///< 0 if the filters of the group have a port range
+    uint16_t localPort;   ///< 0 if the filters of the group have a port range
+    uint8_t tos;
+
+    bool operator == (const FilterKey &other) const;
+  };
+
+  /**
+   * Hash of a FilterKey
+   */
+  struct FilterKeyHash
+  {
+    size_t operator () (const FilterKey &key) const;
+  };
+
+  /**
+   * A packet filter of a TFT, once the masked fields are in its key
+   */
+  struct CompiledFilter
+  {
+    uint32_t id;              ///< the TFT id
+    uint16_t remotePortStart;
+    uint16_t remotePortEnd;
+    uint16_t localPortStart;
+    uint16_t localPortEnd;
+  };
+
+  /**
+   * The packet filters that use the same masks
+   */
+  struct FilterGroup
+  {
+    uint32_t remoteMask;
+    uint32_t localMask;
+    bool exactRemotePort;     ///< true if the filters match a single remote port
+    bool exactLocalPort;      ///< true if the filters match a single local port
+    uint8_t tosMask;
+    uint32_t maxId;           ///< highest TFT id in the group
+    std::unordered_map<FilterKey, std::vector<CompiledFilter>, FilterKeyHash> filters;
+  };
+
+  /**
+   * Rebuild the index from the TFTs in m_tftMap
+   */
+  void Compile ();
+
+  /**
+   * Add a packet filter to the index of one direction
+   * \param groups the groups of the direction
+   * \param f the packet filter
+   * \param id the id of its TFT
+   */
+  static void AddFilter (std::vector<FilterGroup> &groups, const NgcTft::PacketFilter &f, uint32_t id);
+
+  /**
+   * The filter groups of the downlink (index 0) and of the uplink (index
+   * 1), sorted by decreasing maxId
+   */
+  std::vector<FilterGroup> m_groups[2];
   
 };
 
@@ -169,6 +169,12 @@ NgcTft::Add (PacketFilter f)
   ++m_numFilters;
   return (m_numFilters - 1);
 }
+
+const std::list<NgcTft::PacketFilter>&
+NgcTft::GetPacketFilters () const
+{
+  return m_filters;
+}
     
 bool 
 NgcTft::Matches (Direction direction,
@@ -150,6 +150,10 @@ public:
 		  uint16_t localPort,
 		  uint8_t typeOfService);
 
+  /**
+   * \return the packet filters of the TFT, in increasing precedence order
+   */
+  const std::list<PacketFilter>& GetPacketFilters () const;
 
 private:
 
@@ -111,6 +111,7 @@ NgcX2::DoDispose (void)
 
   m_x2InterfaceSockets.clear ();
   m_x2InterfaceCellIds.clear ();
+  m_x2InterfaceRequest = MakeNullCallback<void, Ptr<Node>, uint16_t> ();
   m_x2RlcUserMap.clear ();
   m_x2PdcpUserMap.clear ();
   m_x2RlcUserMap_2.clear (); //sjkang1016
@@ -241,6 +242,23 @@ NgcX2::AddX2Interface (uint16_t localCellId, Ipv4Address localX2Address, uint16_
   m_x2InterfaceCellIds [localX2uSocket] = Create<NrX2CellInfo> (localCellId, remoteCellId);
 }
 
+void
+NgcX2::SetX2InterfaceRequestCallback (X2InterfaceRequestCallback cb)
+{
+  m_x2InterfaceRequest = cb;
+}
+
+void
+NgcX2::RequestX2Interface (uint16_t remoteCellId)
+{
+  if (!m_x2InterfaceRequest.IsNull ()
+      && m_x2InterfaceSockets.find (remoteCellId) == m_x2InterfaceSockets.end ())
+    {
+      NS_LOG_INFO ("Request the X2 interface towards cell " << remoteCellId);
+      m_x2InterfaceRequest (GetObject<Node> (), remoteCellId);
+    }
+}
+
 void
 NgcX2::DoAddTeidToBeForwarded(uint32_t gtpTeid, uint16_t targetCellId)
 {
@@ -768,6 +786,7 @@ NgcX2::DoSendHandoverRequest (NgcX2SapProvider::HandoverRequestParams params)
   NS_LOG_LOGIC ("targetCellId = " << params.targetCellId);
   NS_LOG_LOGIC ("amfUeN2apId  = " << params.amfUeN2apId);
 
+  RequestX2Interface (params.targetCellId);
   NS_ASSERT_MSG (m_x2InterfaceSockets.find (params.targetCellId) != m_x2InterfaceSockets.end (),
                  "Missing infos for targetCellId = " << params.targetCellId <<"\t "<< this);
   Ptr<NrX2IfaceInfo> socketInfo = m_x2InterfaceSockets [params.targetCellId];
@@ -826,6 +845,7 @@ NgcX2::DoSendRlcSetupRequest (NgcX2SapProvider::RlcSetupRequest params)
   NS_LOG_LOGIC ("teid  = " << params.gtpTeid);
   NS_LOG_LOGIC ("rnti = " << params.mmWaveRnti);
 //std::cout<<params.targetCellId << std::endl;
+  RequestX2Interface (params.targetCellId);
   NS_ASSERT_MSG (m_x2InterfaceSockets.find (params.targetCellId) != m_x2InterfaceSockets.end (),
                  "Missing infos for targetCellId = " << params.targetCellId);
   Ptr<NrX2IfaceInfo> socketInfo = m_x2InterfaceSockets [params.targetCellId];
@@ -882,6 +902,7 @@ NgcX2::DoSendRlcSetupCompleted (NgcX2Sap::UeDataParams params)
   NS_LOG_LOGIC ("targetCellId = " << params.targetCellId);
   NS_LOG_LOGIC ("teid  = " << params.gtpTeid);
 
+  RequestX2Interface (params.targetCellId);
   NS_ASSERT_MSG (m_x2InterfaceSockets.find (params.targetCellId) != m_x2InterfaceSockets.end (),
                  "Missing infos for targetCellId = " << params.targetCellId);
   Ptr<NrX2IfaceInfo> socketInfo = m_x2InterfaceSockets [params.targetCellId];
@@ -933,6 +954,7 @@ NgcX2::DoSendHandoverRequestAck (NgcX2SapProvider::HandoverRequestAckParams para
   NS_LOG_LOGIC ("sourceCellId = " << params.sourceCellId);
   NS_LOG_LOGIC ("targetCellId = " << params.targetCellId);
 
+  RequestX2Interface (params.sourceCellId);
   NS_ASSERT_MSG (m_x2InterfaceSockets.find (params.sourceCellId) != m_x2InterfaceSockets.end (),
                  "Socket infos not defined for sourceCellId = " << params.sourceCellId);
 
@@ -984,6 +1006,7 @@ NgcX2::DoSendHandoverRequestAckToNr (NgcX2SapProvider::HandoverRequestAckParams
   NS_LOG_LOGIC ("sourceCellId = " << params.sourceCellId);
   NS_LOG_LOGIC ("targetCellId = " << params.targetCellId);
 
+  RequestX2Interface (params.sourceCellId);
   NS_ASSERT_MSG (m_x2InterfaceSockets.find (params.sourceCellId) != m_x2InterfaceSockets.end (),
                  "Socket infos not defined for sourceCellId = " << params.sourceCellId);
 
@@ -1037,6 +1060,7 @@ NgcX2::DoSendHandoverPreparationFailure (NgcX2SapProvider::HandoverPreparationFa
   NS_LOG_LOGIC ("cause = " << params.cause);
   NS_LOG_LOGIC ("criticalityDiagnostics = " << params.criticalityDiagnostics);
 
+  RequestX2Interface (params.sourceCellId);
   NS_ASSERT_MSG (m_x2InterfaceSockets.find (params.sourceCellId) != m_x2InterfaceSockets.end (),
                  "Socket infos not defined for sourceCellId = " << params.sourceCellId);
 
@@ -1087,6 +1111,7 @@ NgcX2::DoNotifyCoordinatorHandoverFailed(NgcX2SapProvider::HandoverFailedParams
   NS_LOG_LOGIC ("targetCellId = " << params.targetCellId);
   NS_LOG_LOGIC ("imsi = " << params.imsi);
 
+  RequestX2Interface (params.coordinatorId);
   NS_ASSERT_MSG (m_x2InterfaceSockets.find (params.coordinatorId) != m_x2InterfaceSockets.end (),
                  "Socket infos not defined for coordinatorId = " << params.coordinatorId);
 
@@ -1139,6 +1164,7 @@ NgcX2::DoSendSnStatusTransfer (NgcX2SapProvider::SnStatusTransferParams params)
   NS_LOG_LOGIC ("targetCellId = " << params.targetCellId);
   NS_LOG_LOGIC ("erabsList size = " << params.erabsSubjectToStatusTransferList.size ());
 
+  RequestX2Interface (params.targetCellId);
   NS_ASSERT_MSG (m_x2InterfaceSockets.find (params.targetCellId) != m_x2InterfaceSockets.end (),
                  "Socket infos not defined for targetCellId = " << params.targetCellId);
 
@@ -1189,6 +1215,7 @@ NgcX2::DoSendUeContextRelease (NgcX2SapProvider::UeContextReleaseParams params)
   NS_LOG_LOGIC ("newEnbUeX2apId = " << params.newEnbUeX2apId);
   NS_LOG_LOGIC ("sourceCellId = " << params.sourceCellId);
 
+  RequestX2Interface (params.sourceCellId);
   NS_ASSERT_MSG (m_x2InterfaceSockets.find (params.sourceCellId) != m_x2InterfaceSockets.end (),
                  "Socket infos not defined for sourceCellId = " << params.sourceCellId);
 
@@ -1237,6 +1264,7 @@ NgcX2::DoSendLoadInformation (NgcX2SapProvider::LoadInformationParams params)
   NS_LOG_LOGIC ("targetCellId = " << params.targetCellId);
   NS_LOG_LOGIC ("cellInformationList size = " << params.cellInformationList.size ());
 
+  RequestX2Interface (params.targetCellId);
   NS_ASSERT_MSG (m_x2InterfaceSockets.find (params.targetCellId) != m_x2InterfaceSockets.end (),
                  "Missing infos for targetCellId = " << params.targetCellId);
   Ptr<NrX2IfaceInfo> socketInfo = m_x2InterfaceSockets [params.targetCellId];
@@ -1287,6 +1315,7 @@ NgcX2::DoSendResourceStatusUpdate (NgcX2SapProvider::ResourceStatusUpdateParams
   NS_LOG_LOGIC ("enb2MeasurementId = " << params.enb2MeasurementId);
   NS_LOG_LOGIC ("cellMeasurementResultList size = " << params.cellMeasurementResultList.size ());
 
+  RequestX2Interface (params.targetCellId);
   NS_ASSERT_MSG (m_x2InterfaceSockets.find (params.targetCellId) != m_x2InterfaceSockets.end (),
                  "Missing infos for targetCellId = " << params.targetCellId);
   Ptr<NrX2IfaceInfo> socketInfo = m_x2InterfaceSockets [params.targetCellId];
@@ -1338,6 +1367,7 @@ NgcX2::DoSendUeData (NgcX2SapProvider::UeDataParams params)
   NS_LOG_LOGIC ("targetCellId = " << params.targetCellId);
   NS_LOG_LOGIC ("gtpTeid = " << params.gtpTeid);
 
+  RequestX2Interface (params.targetCellId);
   NS_ASSERT_MSG (m_x2InterfaceSockets.find (params.targetCellId) != m_x2InterfaceSockets.end (),
                  "Missing infos for targetCellId = " << params.targetCellId << "\t"<< this);
   Ptr<NrX2IfaceInfo> socketInfo = m_x2InterfaceSockets [params.targetCellId];
@@ -1371,6 +1401,7 @@ NgcX2::DoSendMcPdcpPdu(NgcX2Sap::UeDataParams params)
   NS_LOG_LOGIC ("targetCellId = " << params.targetCellId);
   NS_LOG_LOGIC ("gtpTeid = " << params.gtpTeid);
 
+  RequestX2Interface (params.targetCellId);
   NS_ASSERT_MSG (m_x2InterfaceSockets.find (params.targetCellId) != m_x2InterfaceSockets.end (),
                  "Missing infos for targetCellId = " << params.targetCellId);
   Ptr<NrX2IfaceInfo> socketInfo = m_x2InterfaceSockets [params.targetCellId];
@@ -1408,6 +1439,7 @@ NgcX2::DoReceiveMcPdcpSdu(NgcX2Sap::UeDataParams params)
 
   //NS_LOG_UNCOND( m_x2InterfaceSockets.find(params.targetCellId)== m_x2InterfaceSockets.end() );
   //NS_LOG_UNCOND("forward data to other Enb");
+  RequestX2Interface (params.targetCellId);
   NS_ASSERT_MSG (m_x2InterfaceSockets.find (params.targetCellId) != m_x2InterfaceSockets.end (),
                  "Missing infos for targetCellId = " << params.targetCellId<<this);
   Ptr<NrX2IfaceInfo> socketInfo = m_x2InterfaceSockets [params.targetCellId];
@@ -1444,6 +1476,7 @@ NS_LOG_FUNCTION (this);
 
 // NS_LOG_UNCOND( m_x2InterfaceSockets.find(params.targetCellId)== m_x2InterfaceSockets.end() );
 
+ RequestX2Interface (params.targetCellId);
  NS_ASSERT_MSG (m_x2InterfaceSockets.find (params.targetCellId) != m_x2InterfaceSockets.end (),
                 "Missing infos for targetCellId = " << params.targetCellId);
  Ptr<NrX2IfaceInfo> socketInfo = m_x2InterfaceSockets [params.targetCellId];
@@ -1484,6 +1517,7 @@ NgcX2::DoSendUeSinrUpdate(NgcX2Sap::UeImsiSinrParams params)
   NS_LOG_LOGIC ("sourceCellId = " << params.sourceCellId);
   NS_LOG_LOGIC ("targetCellId = " << params.targetCellId);
 
+  RequestX2Interface (params.targetCellId);
   NS_ASSERT_MSG (m_x2InterfaceSockets.find (params.targetCellId) != m_x2InterfaceSockets.end (),
                  "Missing infos for targetCellId = " << params.targetCellId);
   Ptr<NrX2IfaceInfo> socketInfo = m_x2InterfaceSockets [params.targetCellId];
@@ -1530,6 +1564,7 @@ NgcX2::DoSendMcHandoverRequest (NgcX2SapProvider::SecondaryHandoverParams params
   NS_LOG_LOGIC ("oldCellId = " << params.oldCellId);
   NS_LOG_LOGIC ("imsi = " << params.imsi);
 
+  RequestX2Interface (params.oldCellId);
   NS_ASSERT_MSG (m_x2InterfaceSockets.find (params.oldCellId) != m_x2InterfaceSockets.end (),
                  "Missing infos for oldCellId = " << params.oldCellId);
   Ptr<NrX2IfaceInfo> socketInfo = m_x2InterfaceSockets [params.oldCellId];
@@ -1578,6 +1613,7 @@ NgcX2::DoNotifyNrMmWaveHandoverCompleted (NgcX2SapProvider::SecondaryHandoverPar
   NS_LOG_LOGIC ("imsi = " << params.imsi);
   NS_LOG_LOGIC ("MmWave cellId = " << params.targetCellId);
 
+  RequestX2Interface (params.oldCellId);
   NS_ASSERT_MSG (m_x2InterfaceSockets.find (params.oldCellId) != m_x2InterfaceSockets.end (),
                  "Missing infos for oldCellId = " << params.oldCellId);
   Ptr<NrX2IfaceInfo> socketInfo = m_x2InterfaceSockets [params.oldCellId];
@@ -1626,6 +1662,7 @@ NgcX2::DoSendSwitchConnectionToMmWave(NgcX2SapProvider::SwitchConnectionParams p
   NS_LOG_LOGIC ("MmWaveRnti = " << params.mmWaveRnti);
   NS_LOG_LOGIC ("UseMmWaveConnection " << params.useMmWaveConnection);
 
+  RequestX2Interface (params.mmWaveCellId);
   NS_ASSERT_MSG (m_x2InterfaceSockets.find (params.mmWaveCellId) != m_x2InterfaceSockets.end (),
                  "Missing infos for mmWaveCellId = " << params.mmWaveCellId);
   Ptr<NrX2IfaceInfo> socketInfo = m_x2InterfaceSockets [params.mmWaveCellId];
@@ -1675,6 +1712,7 @@ NgcX2::DoSendSecondaryCellHandoverCompleted(NgcX2SapProvider::SecondaryHandoverC
   NS_LOG_LOGIC ("oldEnbUeX2apId = " << params.oldEnbUeX2apId);
   NS_LOG_LOGIC ("Dst cellId = " << params.cellId);
 
+  RequestX2Interface (params.cellId);
   NS_ASSERT_MSG (m_x2InterfaceSockets.find (params.cellId) != m_x2InterfaceSockets.end (),
                  "Missing infos for cellId = " << params.cellId);
   Ptr<NrX2IfaceInfo> socketInfo = m_x2InterfaceSockets [params.cellId];
@@ -1716,6 +1754,7 @@ NgcX2::DoSendSecondaryCellHandoverCompleted(NgcX2SapProvider::SecondaryHandoverC
 }
 void
 NgcX2::DoDuplicateRlcBuffer(NgcX2SapProvider::SendBufferDuplicationMessage params){
+	 RequestX2Interface (params.targetCellId);
 	 Ptr<NrX2IfaceInfo> socketInfo = m_x2InterfaceSockets [params.targetCellId];
 	  Ptr<Socket> sourceSocket = socketInfo->m_localCtrlPlaneSocket;
 	  Ipv4Address targetIpAddr = socketInfo->m_remoteIpAddr;
@@ -140,6 +140,18 @@ public:
   void AddX2Interface (uint16_t enb1CellId, Ipv4Address enb1X2Address,
                        uint16_t enb2CellId, Ipv4Address enb2X2Address);
 
+  /**
+   * Callback invoked when a message is sent to a cell without an X2
+   * interface, with the node of this entity and the cell ID of the peer.
+   * It may create the missing interface before the message is sent.
+   */
+  typedef Callback<void, Ptr<Node>, uint16_t> X2InterfaceRequestCallback;
+
+  /**
+   * \param cb the callback creating the X2 interfaces on demand
+   */
+  void SetX2InterfaceRequestCallback (X2InterfaceRequestCallback cb);
+
 
   /** 
    * Method to be assigned to the recv callback of the X2-C (X2 Control Plane) socket.
@@ -221,6 +233,14 @@ virtual  void DoReceiveAssistantInformation(NgcX2Sap::AssistantInformationForSpl
 
 private:
 
+  /**
+   * Request the X2 interface towards a cell, if it does not exist yet
+   * \param remoteCellId the cell ID of the peer
+   */
+  void RequestX2Interface (uint16_t remoteCellId);
+
+  X2InterfaceRequestCallback m_x2InterfaceRequest;
+
   /**
    * Map the targetCellId to the corresponding (sourceSocket, remoteIpAddr) to be used
    * to send the X2 message
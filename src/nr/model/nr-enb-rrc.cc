@@ -51,6 +51,7 @@
 #include "ns3/nr-pdcp-tag.h"
 #include <ns3/nr-rlc-sap.h>
 #include <ns3/ngc-x2.h>
+#include <fstream>
 
 
 namespace ns3 {
@@ -449,7 +450,7 @@ UeManager::SetupDataRadioBearer2 (EpsBearer bearer, uint8_t bearerId, uint32_t g
       					//fileName<<"UE-"<<m_rnti<<"-Bearer-"<< (uint16_t)(drbid) <<"NrCell-"<<"-RlcUmLowLat-QueueStatistics.txt";
       					 fileName<<"rlcUmTx_queue_menb_ue"<<m_rnti<<"_bearer"<< (uint16_t)(drbid) << ".txt";
 
-                     std::ofstream* stream = new std::ofstream(fileName.str().c_str());
+                     Ptr<AsyncTraceFile> stream = AsyncTraceFile::Open (fileName.str ());
                      rlc->SetStreamForQueueStatistics(stream);//sjkang1116
   // we need PDCP only for real RLC, i.e., RLC/UM or RLC/AM
   // if we are using RLC/SM we don't care of anything above RLC
@@ -754,69 +755,6 @@ UeManager::PrepareHandover (uint16_t cellId) //source eNB
 
 }
 
-/*
- * Merge 2 buffers of RlcAmPdus into 1 vector with increment order of Pdus
- */
-std::vector < NrRlcAm::RetxPdu >
-UeManager::MergeBuffers(std::vector < NrRlcAm::RetxPdu > first, std::vector < NrRlcAm::RetxPdu > second)
-{
-  NrRlcAmHeader rlcamHeader_1, rlcamHeader_2;
-  std::vector < NrRlcAm::RetxPdu> result;
-  std::vector < NrRlcAm::RetxPdu>::iterator it_1 = first.begin();
-  std::vector < NrRlcAm::RetxPdu>::iterator it_2 = second.begin();
-  bool end_1_reached = false;
-  bool end_2_reached = false;
-  while (it_1 != first.end() && it_2 != second.end()){
-    while ((*it_1).m_pdu == 0){
-      ++it_1;
-      if(it_1 == first.end())
-      {
-        end_1_reached = true;
-        break;
-      }
-    }
-    while ((*it_2).m_pdu == 0){
-      ++it_2;
-      if(it_2 == second.end())
-      {
-        end_2_reached = true;
-        break;
-      }
-    }
-    if(!end_1_reached && !end_2_reached)
-    {
-      (*it_1).m_pdu->PeekHeader(rlcamHeader_1);
-      (*it_2).m_pdu->PeekHeader(rlcamHeader_2);
-      if (rlcamHeader_1.GetSequenceNumber() > rlcamHeader_2.GetSequenceNumber()){
-        result.push_back((*it_2));  
-        ++it_2;       
-      }
-      else if (rlcamHeader_2.GetSequenceNumber() > rlcamHeader_1.GetSequenceNumber()){
-        result.push_back((*it_1));
-        ++it_1;         
-      }
-      else {
-        result.push_back((*it_1));
-        ++it_1;
-        ++it_2;
-      }
-      NS_LOG_DEBUG ("first,second = " << rlcamHeader_1.GetSequenceNumber() << "," << rlcamHeader_2.GetSequenceNumber());
-    }
-    else
-    {
-      break;
-    }
-  }
-  while (it_1 != first.end()){
-    result.push_back((*it_1));
-    it_1++;
-  }
-  while (it_2 != second.end()){
-    result.push_back((*it_2));
-    it_2++;
-  }
-  return result;
-}
 void
 UeManager::SendRrcConnectionReconfigurationTimout(NrRrcSap::RrcConnectionReconfiguration handoverCommand ){ //sjkang0403 newly added function
 	if (!isReceivedRrcConnectionReconfiguration){
@@ -956,115 +894,11 @@ UeManager::ForwardRlcBuffers(Ptr<NrRlc> rlc, Ptr<NrPdcp> pdcp, uint32_t gtpTeid,
  	// RlcBuffers forwarding only for RlcAm bearers.
   if (0 != rlc->GetObject<NrRlcAm> ())
   {
-    //Copy nr-rlc-am.m_txOnBuffer to X2 forwarding buffer.
+    //Move the SDUs of nr-rlc-am to the X2 forwarding buffer.
+    //Forwarding buffer = SDUs of the txed and retx buffers + txonBuffer.
     Ptr<NrRlcAm> rlcAm = rlc->GetObject<NrRlcAm>();
-    uint32_t txonBufferSize = rlcAm->GetTxBufferSize();
-    std::vector < Ptr<Packet> > txonBuffer = rlcAm->GetTxBuffer();
-    //m_x2forwardingBufferSize =  drbIt->second->m_rlc->GetObject<NrRlcAm>()->GetTxBufferSize();
-    //m_x2forwardingBuffer = drbIt->second->m_rlc->GetObject<NrRlcAm>()->GetTxBuffer();
-    uint32_t txedBufferSize = rlcAm->GetTxedBufferSize();
-    std::vector < NrRlcAm::RetxPdu > txedBuffer = rlcAm->GetTxedBuffer();
-    uint32_t retxBufferSize = rlcAm->GetRetxBufferSize();
-    std::vector < NrRlcAm::RetxPdu > retxBuffer = rlcAm->GetRetxBuffer();
-    
-    //Translate Pdus in Rlc txed/retx buffer into RLC Sdus
-    //and put these Sdus into rlcAm->m_transmittingRlcSdus.
-    NS_LOG_INFO("retxBuffer size = " << retxBufferSize);
-    NS_LOG_INFO("txedBuffer size = " << txedBufferSize);
-    //Merge txed and retx buffers into a single buffer before doing RlcPdusToRlc.
-    if ( retxBufferSize + txedBufferSize > 0 ){
-      std::vector< NrRlcAm::RetxPdu > sortedTxedRetxBuffer;
-      if (retxBufferSize == 0){
-        sortedTxedRetxBuffer = txedBuffer;
-      }
-      else if (txedBufferSize == 0){
-        sortedTxedRetxBuffer = retxBuffer;
-      }
-      else {
-        sortedTxedRetxBuffer = MergeBuffers(txedBuffer, retxBuffer);
-      }
-      rlcAm->RlcPdusToRlcSdus(sortedTxedRetxBuffer);  
-    }
-
-    //Construct the forwarding buffer
-    //Forwarding buffer = retxBuffer + txedBuffer + txonBuffer.
-    //if ( txonBufferSize > 0 )
-    //{
-      NrPdcpHeader pdcpHeader;
-      uint32_t pos = 0;
-      for (std::vector< Ptr<Packet> >::iterator it = txonBuffer.begin(); it != txonBuffer.end(); ++it)
-      {
-        pos++;
-        if((*it)->GetSize() > 3) 
-        {
-          (*it)->PeekHeader(pdcpHeader);
-          NS_LOG_DEBUG("txonBuffer SEQ = " << pdcpHeader.GetSequenceNumber() << " Size = " << (*it)->GetSize());
-        }
-        else
-        {
-          NS_LOG_UNCOND("Fragment too small in txonBuffer, pos " << pos);
-        }
-          
-      }
-
-      // this cycle adds the SDUs given by the merge of txed and retxed buffers
-      if ( rlcAm->GetTransmittingRlcSduBufferSize() > 0 )
-      { //something inside the RLC AM's transmitting buffer 
-        NS_LOG_DEBUG ("ADDING TRANSMITTING SDUS OF RLC AM TO X2FORWARDINGBUFFER... Size = " << rlcAm->GetTransmittingRlcSduBufferSize() );
-        //copy the RlcSdu buffer (map) to forwardingBuffer.
-        std::map < uint32_t, Ptr<Packet> > rlcAmTransmittingBuffer = rlcAm->GetTransmittingRlcSduBuffer();
-        NS_LOG_DEBUG (" *** SIZE = " << rlcAmTransmittingBuffer.size());
-        for (std::map< uint32_t, Ptr<Packet> >::iterator it = rlcAmTransmittingBuffer.begin(); it != rlcAmTransmittingBuffer.end(); ++it)
-        {
-          if (it->second != 0)
-          {
-            NS_LOG_DEBUG ( this << " add to forwarding buffer SEQ = " << it->first << " Ptr<Packet> = " << it->second );
-            m_x2forwardingBuffer.push_back(it->second);
-          }
-        } 
-        NS_LOG_DEBUG(this << " ADDING TXONBUFFER OF RLC AM " << m_rnti << " Size = " << txonBufferSize) ;
-
-      
-        Ptr<Packet> segmentedRlcsdu = rlcAm->GetSegmentedRlcsdu();
-        if (segmentedRlcsdu != NULL){
-          segmentedRlcsdu->PeekHeader(pdcpHeader);
-          NS_LOG_DEBUG(this << "SegmentedRlcSdu = " << segmentedRlcsdu->GetSize() << " SEQ = " << pdcpHeader.GetSequenceNumber());
-          //insert the complete version of the fragmented SDU to the front of txonBuffer.
-          txonBuffer.insert(txonBuffer.begin(),segmentedRlcsdu);
-        }
-        m_x2forwardingBuffer.insert(m_x2forwardingBuffer.end(), txonBuffer.begin(), txonBuffer.end());
-        m_x2forwardingBufferSize += rlcAm->GetTransmittingRlcSduBufferSize() + txonBufferSize;
-
-        //Get the rlcAm
-        std::vector < Ptr <Packet> > rlcAmTxedSduBuffer = rlcAm->GetTxedRlcSduBuffer();
-        NrPdcpHeader pdcpHeader_1;
-        m_x2forwardingBuffer.at(0)->PeekHeader(pdcpHeader_1);
-        uint16_t i = 0;
-        for (std::vector< Ptr<Packet> >::iterator it = rlcAmTxedSduBuffer.begin(); it != rlcAmTxedSduBuffer.end(); ++it)
-        {
-          if ((*it) != NULL)
-          {
-            (*it)->PeekHeader(pdcpHeader);
-            NS_LOG_DEBUG("rlcAmTxedSduBuffer SEQ = " << pdcpHeader.GetSequenceNumber() << " Size = " << (*it)->GetSize());
-          
-            //add the previous SDU of the forwarding buffer to the forwarding buffer.
-            if (pdcpHeader.GetSequenceNumber() >= (pdcpHeader_1.GetSequenceNumber() - 2) && pdcpHeader.GetSequenceNumber() <= (pdcpHeader_1.GetSequenceNumber()) )
-            {
-              NS_LOG_DEBUG("Added previous SDU to forwarding buffer SEQ = " << pdcpHeader.GetSequenceNumber() << " Size = " << (*it)->GetSize());
-              m_x2forwardingBuffer.insert(m_x2forwardingBuffer.begin()+i, (*it)->Copy());
-              ++i;
-            }
-          }
-        }
-        
-      }
-      else 
-      { //TransmittingBuffer is empty. Only copy TxonBuffer.
-        NS_LOG_DEBUG(this << " ADDING TXONBUFFER OF RLC AM " << m_rnti << " Size = " << txonBufferSize) ;
-        m_x2forwardingBuffer = txonBuffer;
-        m_x2forwardingBufferSize += txonBufferSize;
-      }
-    //}
+    NS_LOG_DEBUG(this << " TAKING THE SDUS OF RLC AM " << m_rnti);
+    m_x2forwardingBufferSize += rlcAm->TakeHandoverSdus(m_x2forwardingBuffer);
   }
   //For RlcUM, no forwarding available as the simulator itself (seamless HO).
   //However, as the NR-UMTS book, PDCP txbuffer should be forwarded for seamless 
@@ -1103,7 +937,10 @@ UeManager::ForwardRlcBuffers(Ptr<NrRlc> rlc, Ptr<NrPdcp> pdcp, uint32_t gtpTeid,
     NS_ASSERT_MSG(bid > 0, "Bid can't be 0");
     NS_ASSERT_MSG(mcPdcp->GetUseMmWaveConnection(), "The NrMcEnbPdcp is not forwarding data to the mmWave eNB, check if the switch happened!");
   }
-   while (!m_x2forwardingBuffer.empty())
+  // the SDUs are forwarded in one pass, without erasing them one by one from the front
+  std::vector < Ptr<Packet> > forwardingBuffer;
+  forwardingBuffer.swap (m_x2forwardingBuffer);
+  for (std::vector < Ptr<Packet> >::iterator sduIt = forwardingBuffer.begin (); sduIt != forwardingBuffer.end (); ++sduIt)
   {
     NS_LOG_DEBUG(this << " Forwarding m_x2forwardingBuffer to target eNB, gtpTeid = " << gtpTeid );
     NgcX2Sap::UeDataParams params;
@@ -1119,7 +956,7 @@ UeManager::ForwardRlcBuffers(Ptr<NrRlc> rlc, Ptr<NrPdcp> pdcp, uint32_t gtpTeid,
     //params_2.gtpTeid = gtpTeid;
 
     //Remove tags to get PDCP SDU from PDCP PDU.
-    Ptr<Packet> rlcSdu =  (*(m_x2forwardingBuffer.begin()))->Copy();
+    Ptr<Packet> rlcSdu =  (*sduIt)->Copy();
 
     //m_x2forwardingBufferSize -= (*(m_x2forwardingBuffer.begin()))->GetSize(); //sjkang
     //m_x2forwardingBuffer.erase (m_x2forwardingBuffer.begin()); //sjkang
@@ -1212,10 +1049,7 @@ UeManager::ForwardRlcBuffers(Ptr<NrRlc> rlc, Ptr<NrPdcp> pdcp, uint32_t gtpTeid,
     {
       NS_LOG_UNCOND("Too small, not forwarded");
     }
-    if (m_x2forwardingBuffer.size() != 0){
-    m_x2forwardingBufferSize -= (*(m_x2forwardingBuffer.begin()))->GetSize();
-    m_x2forwardingBuffer.erase (m_x2forwardingBuffer.begin());
-    }
+    m_x2forwardingBufferSize -= (*sduIt)->GetSize();
     //NS_LOG_UNCOND(this << " After forwarding: buffer size = " << m_x2forwardingBufferSize );
   }
 }
@@ -1597,7 +1431,7 @@ UeManager::RecvRlcSetupRequest (NgcX2SapUser::RlcSetupRequest params) // TODO on
     				else if (rlcTypeId == NrRlcUmLowLat::GetTypeId())
     				//	fileName<<"UE-"<<m_rnti<<"-Bearer-"<< (uint16_t)(params.drbid) <<"-CellId-"<< m_rrc->GetCellId()<<"-RlcUmLowLat-QueueStatistics.txt";
     					 fileName<<"rlcUmTx_queue_senb"<<m_rrc->GetCellId() <<"_ue"<<m_rnti<<"_bearer"<< (uint16_t)(params.drbid) << ".txt";
-                   std::ofstream* stream = new std::ofstream(fileName.str().c_str());
+                   Ptr<AsyncTraceFile> stream = AsyncTraceFile::Open (fileName.str ());
                    rlc->SetStreamForQueueStatistics(stream);//sjkang1116
 
     if (m_isMc)
@@ -5747,6 +5581,10 @@ NrEnbRrc::AddX2Neighbour (uint16_t cellId)
 {
   NS_LOG_FUNCTION (this << cellId);
 
+  if (!m_x2NeighbourCellIds.insert (cellId).second)
+    {
+      return;
+    }
   if (m_anrSapProvider != 0)
     {
       m_anrSapProvider->AddNeighbourRelation (cellId);
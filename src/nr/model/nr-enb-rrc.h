@@ -418,8 +418,6 @@ public:
 
 
 private:
-  //Lossless HO: merge 2 buffers into 1 with increment order.
-  std::vector < NrRlcAm::RetxPdu > MergeBuffers(std::vector < NrRlcAm::RetxPdu > first, std::vector < NrRlcAm::RetxPdu > second);
   /**
    * Forward the content of RLC buffers. For RLC UM and UM LowLat, forward txBuffer.
    * For RLC AM, forward the merge of retx and txed buffers, and txBuffer
@@ -1218,7 +1216,9 @@ public:
   uint16_t m_secondMmWave_m_rnti; //sjkang1016
    uint16_t m_firstCellId; //sjkang1016
   /** 
-   * Add a neighbour with an X2 interface
+   * Add a neighbour with an X2 interface. Adding the same neighbour again
+   * has no effect, so that the neighbour can be announced before its X2
+   * interface is created on demand.
    *
    * \param cellId neighbouring cell id
    */
@@ -1448,6 +1448,8 @@ private:
   std::set<uint8_t> m_anrMeasIds;
   /// List of measurement identities which are intended for FFR purpose.
   std::set<uint8_t> m_ffrMeasIds;
+  /// Cell IDs of the neighbours with an X2 interface.
+  std::set<uint16_t> m_x2NeighbourCellIds;
 
   struct X2uTeidInfo
   {
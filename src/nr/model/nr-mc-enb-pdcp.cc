@@ -130,7 +130,7 @@ NrMcEnbPdcp::NrMcEnbPdcp ()
   isTargetCellId_2 = false;
   eta = 0.5;
   t_1 = 0; t_2= 0;
-  print_Eta.open("Pvalue.txt");
+  print_Eta = AsyncTraceFile::Open ("Pvalue.txt");
   m_isNrMmWaveDC = false;
   RequestAssistantInfoNR = false;
   m_isEnableDuplicate = false;
@@ -609,7 +609,7 @@ case 3: // p-split
 			if (eta >= 1) eta = 1.0;
 		}
 	}
- print_Eta << Simulator::Now().GetSeconds() << "\t"<<eta << std::endl;
+ print_Eta->GetStream () << Simulator::Now().GetSeconds() << "\t"<<eta << "\n";
 	if (randomValue < eta){
 		return targetCellId_1;
 	}else
@@ -643,7 +643,7 @@ case 4: //SDF
 					}
 					count ++;
 			}
-			print_Eta << Simulator::Now().GetSeconds() <<"\t"<<(double) t_1/(t_1+t_2)<<std::endl;
+			print_Eta->GetStream () << Simulator::Now().GetSeconds() <<"\t"<<(double) t_1/(t_1+t_2)<< "\n";
 		return targetCellID;
 	break;
 case 5: //SQF
@@ -669,7 +669,7 @@ case 5: //SQF
 			count ++;
 
 	}
-	print_Eta << Simulator::Now().GetSeconds() <<"\t"<< (double)t_1/(t_1+t_2)<<std::endl;
+	print_Eta->GetStream () << Simulator::Now().GetSeconds() <<"\t"<< (double)t_1/(t_1+t_2)<< "\n";
 	return targetCellID;
 	break;
 case 6:{
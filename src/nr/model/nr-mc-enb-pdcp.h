@@ -33,7 +33,7 @@
 #include <ns3/nr-pdcp-sap.h>
 #include <ns3/nr-rlc-sap.h>
 #include <ns3/nr-pdcp.h>
-#include <fstream>
+#include "ns3/async-trace-file.h"
 namespace ns3 {
 
 /**
@@ -231,7 +231,7 @@ protected:
   NgcX2PdcpUser* m_ngcX2PdcpUser;
   void UpdateEta();
  // uint16_t splitingAlgorithm();
-  std::ofstream print_Eta;
+  Ptr<AsyncTraceFile> print_Eta;
 private:
   /**
    * State variables. See section 7.1 in TS 36.323
@@ -31,7 +31,9 @@
 #include <ns3/nr-pdcp-sap.h>
 #include <ns3/nr-rlc-sap.h>
 #include <ns3/nr-pdcp.h>
+#include <ns3/nr-pdcp-rx-window.h>
 #include "ns3/network-module.h"
+#include "ns3/async-trace-file.h"
 namespace ns3 {
 
 /**
@@ -64,11 +66,8 @@ public:
    */
   void SetRnti (uint16_t rnti);
   void BufferingAndReordering(Ptr<Packet>p); // this is reordering function
-  void BufferingAndReordering_New(Ptr<Packet>p); // this is reordering function
 
-  void printData(std::string filename, uint16_t SN);
-  void t_ReordringTimer_Expired();
-  void t_ReorderingTimer_Expired_New();
+  void printData(std::string filename, uint16_t SN, uint64_t hfn = 0);
 
   /**
    * Set the ldid
@@ -124,11 +123,6 @@ public:
     uint16_t txSn; ///< TX sequence number
     uint16_t rxSn; ///< RX sequence number
   };
-  struct BufferedPackets{
- 	  uint16_t sequenceNumber;
- 	  NrPdcpSapUser::ReceivePdcpSduParameters params;
- 	  uint16_t RX_HFN;
-   };
 
   /** 
    * 
@@ -172,9 +166,9 @@ public:
    */
   void SwitchConnection(bool useMmWaveConnection);
 
-  void CalculatePdcpThroughput(std::ofstream *stream ); //sjkang
+  void CalculatePdcpThroughput(Ptr<AsyncTraceFile> stream ); //sjkang
 
-  void SetStreams ( std::ofstream * stream); //sjkang
+  void SetStreams ( Ptr<AsyncTraceFile> stream); //sjkang
   void MeasureSN_Difference(); //sjkang1116
 
 protected:
@@ -208,8 +202,20 @@ protected:
    * The parameters are RNTI, LCID, bytes delivered and delivery delay in nanoseconds. 
    */
   TracedCallback<uint16_t, uint8_t, uint32_t, uint64_t> m_rxPdu;
-  EventId t_ReorderingTimer;
 private:
+  /**
+   * Deliver a PDU passed by the reception window to the upper layer
+   *
+   * \param count the COUNT of the PDU
+   * \param params the PDU
+   */
+  void DeliverPdcpSdu (uint64_t count, NrPdcpSapUser::ReceivePdcpSduParameters params);
+
+  /**
+   * Apply the EnableReordering and ExpiredTime attributes to the reception window
+   */
+  void ConfigureRxWindow ();
+
   /**
    * State variables. See section 7.1 in TS 36.323
    */
@@ -223,30 +229,17 @@ private:
 
   bool m_useMmWaveConnection;
   bool m_alwaysNrUplink;
-  int  Last_Submitted_PDCP_RX_SN;
   /////sjkang for enabling reordering
-  int *temp ;
  Time  expiredTime;
- int receivedPDCP_SN;
-    int  Reordering_PDCP_RX_COUNT;
-    int Next_PDCP_RX_SN;
-    std::map <int,NrPdcpSapUser::ReceivePdcpSduParameters> PdcpBuffer;
 
     uint64_t discardedPacketSize=0;
     uint32_t numberOfDiscaredPackets=0;
-    static const int reorderingWindow =16384;//8192;//2048;
-    std::map<uint16_t, uint16_t>RX_HFNbySN;
-    int present_RX_HFN;
     uint32_t 	SumOfPacketSize=0;
     uint32_t	 orderdedSumOfPacket=0;
     uint16_t	numberOfReorderingTimeout=0;
-    bool check;
-    bool check_2;
 
 ///////// for measuring SN difference
 
-    int tempBuffer[100]; //sjkang0810
-    uint64_t *temp_n;
      Time tempTime; //sjkang0810
      Time previousTime;
      uint16_t counter=0;
@@ -255,29 +248,15 @@ private:
      uint64_t  TotalPacketSize_ordered;
      double TotalTime;
 
-   std::ofstream * m_SN_DifferenceStream; //sjkang1116
-    //uint16_t temp_SN; //sjkang1116
+   Ptr<AsyncTraceFile> m_SN_DifferenceStream; //sjkang1116
     uint64_t cellIdToSN_1, cellIdToSN_2; //sjkang1116
     uint16_t cellId_1, cellId_2; //sjkang1116
     bool m_isEnableReordering;
     bool firstPacket ;
 
-
-    std::map <uint64_t,NrPdcpSapUser::ReceivePdcpSduParameters> NewPdcpBuffer;
-    std::map<uint64_t,uint16_t> HFN;
-    std::map<uint64_t,uint32_t> SN;
-    uint32_t RCVD_SN;
-    uint16_t RCVD_HFN;
-    uint64_t RCVD_COUNT;
-    uint64_t RX_NEXT;
-    uint64_t RX_RECORD;
-    uint64_t RX_DELIV;
-    uint64_t LAST_SUBMITED;
-    bool outOfDelivery = false;
-
-    // for processing packet duplication
-  //  std::map <uint16_t, uint16_t> checkPacketDuplication; //sjkang
-    std::vector<uint32_t> CheckSN;
+    // duplicate detection and reordering of the received PDUs, see section 5.2.2 in TS 38.323
+    NrPdcpRxWindow m_rxWindow;
+    bool m_rxWindowConfigured;
 
 };
 
@@ -0,0 +1,217 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/nr-pdcp-rx-window.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("NrPdcpRxWindow");
+
+NrPdcpRxWindow::NrPdcpRxWindow (uint32_t snModulus)
+  : m_snModulus (snModulus),
+    m_windowSize (snModulus / 2),
+    m_outOfOrder (false),
+    m_reorderingTime (MilliSeconds (100)),
+    m_numBuffered (0),
+    m_rxNext (0),
+    m_rxDeliv (0),
+    m_rxReord (0)
+{
+  NS_LOG_FUNCTION (this << snModulus);
+  Slot empty;
+  empty.m_received = false;
+  empty.m_count = 0;
+  m_slots.assign (m_windowSize, empty);
+}
+
+NrPdcpRxWindow::~NrPdcpRxWindow ()
+{
+  m_reorderingTimer.Cancel ();
+}
+
+void
+NrPdcpRxWindow::SetDeliverCallback (DeliverCallback cb)
+{
+  m_deliver = cb;
+}
+
+void
+NrPdcpRxWindow::SetOutOfOrderDelivery (bool outOfOrder)
+{
+  m_outOfOrder = outOfOrder;
+}
+
+void
+NrPdcpRxWindow::SetReorderingTime (Time t)
+{
+  m_reorderingTime = t;
+}
+
+void
+NrPdcpRxWindow::Dispose ()
+{
+  NS_LOG_FUNCTION (this);
+  m_reorderingTimer.Cancel ();
+  for (std::vector<Slot>::iterator it = m_slots.begin (); it != m_slots.end (); ++it)
+    {
+      it->m_received = false;
+      it->m_params.pdcpSdu = 0;
+    }
+  m_numBuffered = 0;
+}
+
+uint64_t
+NrPdcpRxWindow::GetRxDeliv () const
+{
+  return m_rxDeliv;
+}
+
+uint32_t
+NrPdcpRxWindow::GetNumBuffered () const
+{
+  return m_numBuffered;
+}
+
+bool
+NrPdcpRxWindow::GetCount (uint32_t sn, uint64_t &count) const
+{
+  uint64_t delivSn = m_rxDeliv % m_snModulus;
+  uint64_t delivHfn = m_rxDeliv / m_snModulus;
+  uint64_t hfn = delivHfn;
+  if (sn + (uint64_t) m_windowSize < delivSn)
+    {
+      hfn = delivHfn + 1;
+    }
+  else if (sn >= delivSn + m_windowSize)
+    {
+      if (delivHfn == 0)
+        {
+          return false;
+        }
+      hfn = delivHfn - 1;
+    }
+  count = hfn * m_snModulus + sn;
+  return true;
+}
+
+NrPdcpRxWindow::Slot&
+NrPdcpRxWindow::GetSlot (uint64_t count)
+{
+  return m_slots[count % m_windowSize];
+}
+
+bool
+NrPdcpRxWindow::IsReceived (uint64_t count) const
+{
+  const Slot &slot = m_slots[count % m_windowSize];
+  return slot.m_received && slot.m_count == count;
+}
+
+bool
+NrPdcpRxWindow::Receive (uint32_t sn, const NrPdcpSapUser::ReceivePdcpSduParameters &params, uint64_t &count)
+{
+  NS_LOG_FUNCTION (this << sn);
+  NS_ASSERT_MSG (sn < m_snModulus, "SN " << sn << " out of " << m_snModulus);
+  if (!GetCount (sn, count) || count < m_rxDeliv || IsReceived (count))
+    {
+      NS_LOG_LOGIC ("discard SN " << sn << " RX_DELIV " << m_rxDeliv);
+      return false;
+    }
+
+  Slot &slot = GetSlot (count);
+  slot.m_received = true;
+  slot.m_count = count;
+  if (count >= m_rxNext)
+    {
+      m_rxNext = count + 1;
+    }
+  if (m_outOfOrder)
+    {
+      m_deliver (count, params);
+    }
+  else
+    {
+      slot.m_params = params;
+      m_numBuffered++;
+    }
+
+  if (count == m_rxDeliv)
+    {
+      DeliverConsecutive ();
+    }
+  UpdateReorderingTimer ();
+  return true;
+}
+
+void
+NrPdcpRxWindow::Pass (uint64_t count)
+{
+  Slot &slot = GetSlot (count);
+  slot.m_received = false;
+  if (!m_outOfOrder && slot.m_params.pdcpSdu)
+    {
+      NrPdcpSapUser::ReceivePdcpSduParameters params = slot.m_params;
+      slot.m_params.pdcpSdu = 0;
+      m_numBuffered--;
+      m_deliver (count, params);
+    }
+}
+
+void
+NrPdcpRxWindow::DeliverConsecutive ()
+{
+  while (IsReceived (m_rxDeliv))
+    {
+      Pass (m_rxDeliv);
+      m_rxDeliv++;
+    }
+}
+
+void
+NrPdcpRxWindow::UpdateReorderingTimer ()
+{
+  if (m_reorderingTimer.IsRunning () && m_rxDeliv >= m_rxReord)
+    {
+      m_reorderingTimer.Cancel ();
+    }
+  if (!m_reorderingTimer.IsRunning () && m_rxDeliv < m_rxNext)
+    {
+      m_rxReord = m_rxNext;
+      m_reorderingTimer = Simulator::Schedule (m_reorderingTime, &NrPdcpRxWindow::ReorderingTimerExpired, this);
+    }
+}
+
+void
+NrPdcpRxWindow::ReorderingTimerExpired ()
+{
+  NS_LOG_FUNCTION (this);
+  NS_LOG_INFO ("t-Reordering expired, RX_DELIV " << m_rxDeliv << " RX_REORD " << m_rxReord
+               << " buffered " << m_numBuffered);
+  // every COUNT in [RX_DELIV, RX_REORD) is visited once, since RX_DELIV only moves forward
+  for (; m_rxDeliv < m_rxReord; m_rxDeliv++)
+    {
+      if (IsReceived (m_rxDeliv))
+        {
+          Pass (m_rxDeliv);
+        }
+    }
+  DeliverConsecutive ();
+  UpdateReorderingTimer ();
+}
+
+} // namespace ns3
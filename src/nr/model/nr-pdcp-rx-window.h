@@ -0,0 +1,165 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef NR_PDCP_RX_WINDOW_H
+#define NR_PDCP_RX_WINDOW_H
+
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include "ns3/callback.h"
+#include "ns3/nr-pdcp-sap.h"
+
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * Reception window of a PDCP entity, see section 5.2.2 in TS 38.323.
+ *
+ * The PDUs between RX_DELIV and RX_DELIV + window size are stored in a
+ * ring indexed by COUNT modulo the window size, so that the duplicate
+ * check, the storage and the in-order delivery are O(1) per PDU and do
+ * not allocate. The window runs the t-Reordering timer itself.
+ *
+ * With out-of-order delivery, a PDU is delivered as soon as it is received
+ * and the window only remembers which COUNTs were received, to discard
+ * the duplicates.
+ */
+class NrPdcpRxWindow
+{
+public:
+  /**
+   * Called for every PDU delivered to the upper layer, with its COUNT
+   */
+  typedef Callback<void, uint64_t, NrPdcpSapUser::ReceivePdcpSduParameters> DeliverCallback;
+
+  /**
+   * \param snModulus the number of sequence numbers, the window holds half of them
+   */
+  NrPdcpRxWindow (uint32_t snModulus);
+  ~NrPdcpRxWindow ();
+
+  /**
+   * \param cb the callback delivering the PDUs to the upper layer
+   */
+  void SetDeliverCallback (DeliverCallback cb);
+
+  /**
+   * \param outOfOrder true to deliver the PDUs as soon as they are received
+   */
+  void SetOutOfOrderDelivery (bool outOfOrder);
+
+  /**
+   * \param t the duration of the t-Reordering timer
+   */
+  void SetReorderingTime (Time t);
+
+  /**
+   * Process a received PDU. It is either discarded, stored or delivered
+   * together with the PDUs it makes consecutive.
+   *
+   * \param sn the sequence number of the PDU
+   * \param params the PDU
+   * \param count the COUNT of the PDU
+   * \return false if the PDU is discarded, as a duplicate or because it is
+   * older than RX_DELIV
+   */
+  bool Receive (uint32_t sn, const NrPdcpSapUser::ReceivePdcpSduParameters &params, uint64_t &count);
+
+  /**
+   * Stop the timer and drop the stored PDUs
+   */
+  void Dispose ();
+
+  /**
+   * \return the COUNT of the first PDU not delivered yet
+   */
+  uint64_t GetRxDeliv () const;
+
+  /**
+   * \return the number of PDUs waiting for the missing ones
+   */
+  uint32_t GetNumBuffered () const;
+
+private:
+  /**
+   * A position of the ring
+   */
+  struct Slot
+  {
+    bool m_received; ///< true if the PDU of m_count was received and not passed yet
+    uint64_t m_count; ///< COUNT of the PDU in this slot
+    NrPdcpSapUser::ReceivePdcpSduParameters m_params; ///< the PDU, when it is not delivered yet
+  };
+
+  /**
+   * Compute the COUNT of a received SN, section 5.2.2.1 in TS 38.323
+   * \param sn the sequence number
+   * \param count the COUNT
+   * \return false if the COUNT would be negative, i.e., the PDU is older than the first one
+   */
+  bool GetCount (uint32_t sn, uint64_t &count) const;
+
+  /**
+   * \return the slot of a COUNT
+   */
+  Slot& GetSlot (uint64_t count);
+
+  /**
+   * \return true if the PDU of a COUNT was received and not passed yet
+   */
+  bool IsReceived (uint64_t count) const;
+
+  /**
+   * Deliver the stored PDU of a COUNT, if any, and release its slot
+   */
+  void Pass (uint64_t count);
+
+  /**
+   * Deliver the consecutive PDUs from RX_DELIV and update RX_DELIV
+   */
+  void DeliverConsecutive ();
+
+  /**
+   * Start or stop the t-Reordering timer after a change of RX_DELIV or RX_NEXT
+   */
+  void UpdateReorderingTimer ();
+
+  /**
+   * Actions when t-Reordering expires, section 5.2.2.2 in TS 38.323
+   */
+  void ReorderingTimerExpired ();
+
+  std::vector<Slot> m_slots;
+  uint32_t m_snModulus;
+  uint32_t m_windowSize;
+  bool m_outOfOrder;
+  DeliverCallback m_deliver;
+  Time m_reorderingTime;
+  EventId m_reorderingTimer;
+  uint32_t m_numBuffered;
+
+  /**
+   * State variables, section 7.1 in TS 38.323
+   */
+  uint64_t m_rxNext;
+  uint64_t m_rxDeliv;
+  uint64_t m_rxReord;
+};
+
+} // namespace ns3
+
+#endif // NR_PDCP_RX_WINDOW_H
@@ -30,6 +30,7 @@
 #include <ns3/nstime.h>
 #include <ns3/nr-amc.h>
 #include <ns3/nr-ffr-sap.h>
+#include <ns3/ff-mac-rbg-allocator.h>
 
 // value for SINR outside the range defined by FF-API, used to indicate that there
 // is no CQI for this element
@@ -182,6 +183,11 @@ private:
 
   Ptr<NrAmc> m_amc;
 
+  /// Achievable rate metric of the DL RBG assignment.
+  typedef FfMacRateMetric<NrSbMeasResult_s, NrAmc, NrFfrSapProvider> DlRateMetric;
+  FfMacRbgAllocator<DlRateMetric> m_dlRbgAllocator; ///< DL RBG assignment, kept across TTIs.
+  DlRateMetric m_dlRbgMetric; ///< Metric of the DL RBG assignment.
+
   /*
    * Vectors of UE's LC info
   */
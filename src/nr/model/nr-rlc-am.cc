@@ -34,6 +34,7 @@
 #include "ns3/ipv4-queue-disc-item.h"
 #include "ns3/ipv4-packet-filter.h"
 #include <fstream>
+#include <algorithm>
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("NrRlcAm");
@@ -116,12 +117,12 @@ NrRlcAm::BufferSizeTrace()
 {
   NS_LOG_LOGIC("BufferSizeTrace " << Simulator::Now().GetSeconds() << " " << m_rnti << " " << m_lcid << " " << m_txonBufferSize);
   // write to file
-  if(!m_bufferSizeFile.is_open())
+  if (m_bufferSizeFile == 0)
   {
-    m_bufferSizeFile.open(GetBufferSizeFilename().c_str(), std::ofstream::app);
+    m_bufferSizeFile = AsyncTraceFile::Open (GetBufferSizeFilename (), AsyncTraceFile::TEXT, true);
     NS_LOG_LOGIC("File opened");
   }
-  m_bufferSizeFile << Simulator::Now().GetSeconds() << " " << m_rnti << " " << (uint16_t) m_lcid << " " << m_txonBufferSize << std::endl;
+  m_bufferSizeFile->GetStream () << Simulator::Now().GetSeconds() << " " << m_rnti << " " << (uint16_t) m_lcid << " " << m_txonBufferSize << "\n";
 
   m_traceBufferSizeEvent = Simulator::Schedule(MilliSeconds(10), &NrRlcAm::BufferSizeTrace, this);
 }
@@ -206,7 +207,7 @@ NrRlcAm::DoDispose ()
   m_statusProhibitTimer.Cancel ();
   m_rbsTimer.Cancel ();
 
-  m_txonBuffer.clear ();
+  m_txonBuffer.Clear ();
   m_txonBufferSize = 0;
   m_txedBuffer.clear ();
   m_txedBufferSize = 0;
@@ -223,13 +224,13 @@ NrRlcAm::DoDispose ()
   m_reassembleExpectedSeqNumber = 0;
   m_expectedSeqNumber = 0;
   m_transmittingRlcSduBufferSize = 0;
-  m_transmittingRlcSduBuffer.clear();
+  m_transmittingRlcSdus.clear ();
   is_fragmented = 0;
   m_txedRlcSduBuffer.clear ();
   m_txedRlcSduBufferSize = 0;
 
   m_traceBufferSizeEvent.Cancel();
-  m_bufferSizeFile.close();
+  m_bufferSizeFile = 0;
 
   NrRlc::DoDispose ();
 }
@@ -269,9 +270,9 @@ NrRlcAm::DoTransmitPdcpPdu (Ptr<Packet> p)
       p->AddPacketTag (tag);
 
       NS_LOG_INFO ("Txon Buffer: New packet added");
-      m_txonBuffer.push_back (p);
+      m_txonBuffer.PushBack (p);
       m_txonBufferSize += p->GetSize ();
-      NS_LOG_LOGIC ("NumOfBuffers = " << m_txonBuffer.size() );
+      NS_LOG_LOGIC ("NumOfBuffers = " << m_txonBuffer.GetNPackets () );
       NS_LOG_LOGIC ("txonBufferSize = " << m_txonBufferSize);
     }
     else
@@ -472,10 +473,10 @@ NrRlcAm::DoNotifyTxOpportunity (uint32_t bytes, uint8_t layer, uint8_t harqId)
                   // Calculate the Polling Bit (5.2.2.1)
                   rlcAmHeader.SetPollingBit (NrRlcAmHeader::STATUS_REPORT_NOT_REQUESTED);
 
-                  NS_LOG_LOGIC ("polling conditions: m_txonBuffer.empty=" << m_txonBuffer.empty () 
+                  NS_LOG_LOGIC ("polling conditions: m_txonBuffer.empty=" << m_txonBuffer.IsEmpty () 
                                 << " retxBufferSize="  << m_retxBufferSize
                                 << " packet->GetSize ()=" << packet->GetSize ());
-                  if (((m_txonBuffer.empty ()) && (m_txonQueue->GetNPackets ()==0) && (m_retxBufferSize == packet->GetSize () + rlcAmHeader.GetSerializedSize ()))
+                  if (((m_txonBuffer.IsEmpty ()) && (m_txonQueue->GetNPackets ()==0) && (m_retxBufferSize == packet->GetSize () + rlcAmHeader.GetSerializedSize ()))
                       || (m_vtS >= m_vtMs)
                       || m_pollRetransmitTimerJustExpired)
                     {
@@ -526,7 +527,7 @@ NrRlcAm::DoNotifyTxOpportunity (uint32_t bytes, uint8_t layer, uint8_t harqId)
                     }
 
                   NS_LOG_INFO ("Move SN = " << seqNumberValue << " back to txedBuffer");
-                  m_txedBuffer.at (seqNumberValue).m_pdu = m_retxBuffer.at (seqNumberValue).m_pdu->Copy ();
+                  m_txedBuffer.at (seqNumberValue).m_pdu = m_retxBuffer.at (seqNumberValue).m_pdu;
                   m_txedBuffer.at (seqNumberValue).m_retxCount = m_retxBuffer.at (seqNumberValue).m_retxCount;
                   NS_ASSERT_MSG(m_txedBuffer.at (seqNumberValue).m_pdu != 0, "Just inserted an invalid pointer");
                   m_txedBufferSize += m_txedBuffer.at (seqNumberValue).m_pdu->GetSize ();
@@ -563,10 +564,10 @@ NrRlcAm::DoNotifyTxOpportunity (uint32_t bytes, uint8_t layer, uint8_t harqId)
                   // Calculate the Polling Bit (5.2.2.1)
                   firstSegHdr.SetPollingBit (NrRlcAmHeader::STATUS_REPORT_NOT_REQUESTED);
 
-                  NS_LOG_LOGIC ("polling conditions: m_txonBuffer.empty=" << m_txonBuffer.empty ()
+                  NS_LOG_LOGIC ("polling conditions: m_txonBuffer.empty=" << m_txonBuffer.IsEmpty ()
                                 << " retxBufferSize="  << m_retxBufferSize
                                 << " packet->GetSize ()=" << packet->GetSize ());
-                  if (((m_txonBuffer.empty ()) && (m_txonQueue->GetNPackets () == 0) && (m_retxBufferSize == packet->GetSize () + firstSegHdr.GetSerializedSize ()))
+                  if (((m_txonBuffer.IsEmpty ()) && (m_txonQueue->GetNPackets () == 0) && (m_retxBufferSize == packet->GetSize () + firstSegHdr.GetSerializedSize ()))
                       || (m_vtS >= m_vtMs)
                       || m_pollRetransmitTimerJustExpired)
                   {
@@ -732,26 +733,26 @@ NrRlcAm::DoNotifyTxOpportunity (uint32_t bytes, uint8_t layer, uint8_t harqId)
 
   // Remove the first packet from the transmission buffer.
   // If only a segment of the packet is taken, then the remaining is given back later
-  if ( m_txonBuffer.size () + m_txonQueue->GetNBytes() == 0 )
+  if ( m_txonBuffer.GetNPackets () + m_txonQueue->GetNBytes() == 0 )
     {
       NS_LOG_LOGIC ("No data pending");
       return;
     }
 
-  NS_LOG_LOGIC ("SDUs in TxonBuffer  = " << m_txonBuffer.size ());
-  NS_LOG_LOGIC ("First SDU buffer  = " << *(m_txonBuffer.begin()));
-  NS_LOG_LOGIC ("First SDU size    = " << (*(m_txonBuffer.begin()))->GetSize ());
+  NS_LOG_LOGIC ("SDUs in TxonBuffer  = " << m_txonBuffer.GetNPackets ());
+  NS_LOG_LOGIC ("First SDU buffer  = " << m_txonBuffer.Front ());
+  NS_LOG_LOGIC ("First SDU size    = " << m_txonBuffer.Front ()->GetSize ());
   NS_LOG_LOGIC ("Next segment size = " << nextSegmentSize);
   NS_LOG_LOGIC ("Remove SDU from TxBuffer");
 
-  if (m_txonBuffer.empty())
+  if (m_txonBuffer.IsEmpty ())
   {
     Ptr<Packet> tempP = m_txonQueue->Dequeue()->GetPacket();
-    m_txonBuffer.push_back (tempP);
+    m_txonBuffer.PushBack (tempP);
     m_txonBufferSize += tempP->GetSize ();
   }
 
-  Ptr<Packet> firstSegment = (*(m_txonBuffer.begin ()))->Copy ();
+  Ptr<Packet> firstSegment = m_txonBuffer.Front ()->Copy ();
   
   // LL HO
   // tricky: store the incomplete Rlc SDU for forwarding to 
@@ -761,12 +762,12 @@ NrRlcAm::DoNotifyTxOpportunity (uint32_t bytes, uint8_t layer, uint8_t harqId)
   // store complete the last complete SDU of the txonBuffer.
   if (!is_fragmented){
     NS_LOG_DEBUG ("Last complete SDU in txonBuffer size = " << firstSegment->GetSize() << " SEQ = " << m_vtS );
-    entireSdu = (*(m_txonBuffer.begin ()))->Copy ();
+    entireSdu = m_txonBuffer.Front ()->Copy ();
   }
 
-  m_txonBufferSize -= (*(m_txonBuffer.begin()))->GetSize ();
+  m_txonBufferSize -= m_txonBuffer.Front ()->GetSize ();
   NS_LOG_LOGIC ("txBufferSize      = " << m_txonBufferSize );
-  m_txonBuffer.erase (m_txonBuffer.begin ());
+  m_txonBuffer.PopFront ();
 
   while ( firstSegment && (firstSegment->GetSize () > 0) && (nextSegmentSize > 0) )
     {
@@ -820,22 +821,22 @@ NrRlcAm::DoNotifyTxOpportunity (uint32_t bytes, uint8_t layer, uint8_t harqId)
               //LL HO Mark the first SDU is txonBuffer is fragmented. This maybe not needed.
               is_fragmented = 1;
 
-              // m_txonBuffer.insert (m_txonBuffer.begin (), firstSegment);
+              // m_txonBuffer.PushFront (firstSegment);
               
-              if(m_txonBuffer.empty())
+              if(m_txonBuffer.IsEmpty ())
               {
-                m_txonBuffer.push_back(firstSegment);
+                m_txonBuffer.PushBack (firstSegment);
               }
               else
               {
-                m_txonBuffer.insert (m_txonBuffer.begin (), firstSegment);
+                m_txonBuffer.PushFront (firstSegment);
               }
 
-              m_txonBufferSize += (*(m_txonBuffer.begin()))->GetSize ();
+              m_txonBufferSize += m_txonBuffer.Front ()->GetSize ();
 
               NS_LOG_LOGIC ("    Txon buffer: Give back the remaining segment");
-              NS_LOG_LOGIC ("    Txon buffers = " << m_txonBuffer.size ());
-              NS_LOG_LOGIC ("    Front buffer size = " << (*(m_txonBuffer.begin()))->GetSize ());
+              NS_LOG_LOGIC ("    Txon buffers = " << m_txonBuffer.GetNPackets ());
+              NS_LOG_LOGIC ("    Front buffer size = " << m_txonBuffer.Front ()->GetSize ());
               NS_LOG_LOGIC ("    txonBufferSize = " << m_txonBufferSize );
             }
           else
@@ -877,7 +878,7 @@ NrRlcAm::DoNotifyTxOpportunity (uint32_t bytes, uint8_t layer, uint8_t harqId)
           // break;
         }
       else if ( (nextSegmentSize - firstSegment->GetSize () <= 2) 
-        || (m_txonBuffer.size () + m_txonQueue->GetNPackets() == 0) )
+        || (m_txonBuffer.GetNPackets () + m_txonQueue->GetNPackets() == 0) )
         {
           NS_LOG_LOGIC ("    IF nextSegmentSize - firstSegment->GetSize () <= 2 || txonBuffer.size == 0");
 
@@ -895,11 +896,11 @@ NrRlcAm::DoNotifyTxOpportunity (uint32_t bytes, uint8_t layer, uint8_t harqId)
           nextSegmentSize -= dataFieldAddedSize;
           nextSegmentId++;
 
-          NS_LOG_LOGIC ("        SDUs in TxBuffer  = " << m_txonBuffer.size ());
-          if (m_txonBuffer.size () + m_txonQueue->GetNPackets() > 0)
+          NS_LOG_LOGIC ("        SDUs in TxBuffer  = " << m_txonBuffer.GetNPackets ());
+          if (m_txonBuffer.GetNPackets () + m_txonQueue->GetNPackets() > 0)
             {
-              NS_LOG_LOGIC ("        First SDU buffer  = " << *(m_txonBuffer.begin()));
-              NS_LOG_LOGIC ("        First SDU size    = " << (*(m_txonBuffer.begin()))->GetSize ());
+              NS_LOG_LOGIC ("        First SDU buffer  = " << m_txonBuffer.Front ());
+              NS_LOG_LOGIC ("        First SDU size    = " << m_txonBuffer.Front ()->GetSize ());
             }
           NS_LOG_LOGIC ("        Next segment size = " << nextSegmentSize);
 
@@ -925,31 +926,31 @@ NrRlcAm::DoNotifyTxOpportunity (uint32_t bytes, uint8_t layer, uint8_t harqId)
           nextSegmentSize -= ((nextSegmentId % 2) ? (2) : (1)) + dataFieldAddedSize;
           nextSegmentId++;
 
-          NS_LOG_LOGIC ("        SDUs in TxBuffer  = " << m_txonBuffer.size ());
-          if (m_txonBuffer.size () + m_txonQueue->GetNPackets() > 0)
+          NS_LOG_LOGIC ("        SDUs in TxBuffer  = " << m_txonBuffer.GetNPackets ());
+          if (m_txonBuffer.GetNPackets () + m_txonQueue->GetNPackets() > 0)
             {
-              NS_LOG_LOGIC ("        First SDU buffer  = " << *(m_txonBuffer.begin()));
-              NS_LOG_LOGIC ("        First SDU size    = " << (*(m_txonBuffer.begin()))->GetSize ());
+              NS_LOG_LOGIC ("        First SDU buffer  = " << m_txonBuffer.Front ());
+              NS_LOG_LOGIC ("        First SDU size    = " << m_txonBuffer.Front ()->GetSize ());
             }
           NS_LOG_LOGIC ("        Next segment size = " << nextSegmentSize);
           NS_LOG_LOGIC ("        Remove SDU from TxBuffer");
 
           // (more segments)
 
-          if(m_txonBuffer.empty())
+          if(m_txonBuffer.IsEmpty ())
           {
             Ptr<Packet> tempP = m_txonQueue->Dequeue()->GetPacket();
-            m_txonBuffer.push_back (tempP);
+            m_txonBuffer.PushBack (tempP);
             m_txonBufferSize += tempP->GetSize ();
           }
 
-          firstSegment = (*(m_txonBuffer.begin ()))->Copy ();
+          firstSegment = m_txonBuffer.Front ()->Copy ();
           
           // LL HO
           // New complete SDU is taken from txonBuffer so reset the 
           // status is_fragmented.
           is_fragmented = 0;
-          m_txedRlcSduBuffer.push_back((*(m_txonBuffer.begin()))->Copy());
+          m_txedRlcSduBuffer.push_back(m_txonBuffer.Front ()->Copy());
           NS_LOG_DEBUG ("m_txedRlcSduBuffer.size() = " << m_txedRlcSduBuffer.size());
           if (m_txedRlcSduBuffer.size() > 1024){
             NS_LOG_DEBUG ("m_txedRlcSduBuffer.size() = " << m_txedRlcSduBuffer.size() << " clear and resize");
@@ -958,10 +959,10 @@ NrRlcAm::DoNotifyTxOpportunity (uint32_t bytes, uint8_t layer, uint8_t harqId)
             NS_LOG_DEBUG ("m_txedRlcSduBuffer.size() = " << m_txedRlcSduBuffer.size() << " after clear and resize");
           }
           // Store the last complete SDU before segmentation in txonBuffer.
-          entireSdu = (*(m_txonBuffer.begin ()))->Copy ();
+          entireSdu = m_txonBuffer.Front ()->Copy ();
 
-          m_txonBufferSize -= (*(m_txonBuffer.begin()))->GetSize ();
-          m_txonBuffer.erase (m_txonBuffer.begin ());
+          m_txonBufferSize -= m_txonBuffer.Front ()->GetSize ();
+          m_txonBuffer.PopFront ();
           NS_LOG_LOGIC ("        txBufferSize = " << m_txonBufferSize );
         }
     }
@@ -1044,12 +1045,12 @@ NrRlcAm::DoNotifyTxOpportunity (uint32_t bytes, uint8_t layer, uint8_t harqId)
   NS_LOG_LOGIC ("BYTE_WITHOUT_POLL = " << m_byteWithoutPoll);
 
   // if ( (m_pduWithoutPoll >= m_pollPdu) || (m_byteWithoutPoll >= m_pollByte) ||
-  //      ( (m_txonBuffer.empty ()) && (m_retxBufferSize == 0) ) ||
+  //      ( (m_txonBuffer.IsEmpty ()) && (m_retxBufferSize == 0) ) ||
   //      (m_vtS >= m_vtMs)
   //      || m_pollRetransmitTimerJustExpired
   //    )
   if ( (m_pduWithoutPoll >= m_pollPdu) || (m_byteWithoutPoll >= m_pollByte) ||
-       ( (m_txonBuffer.empty ()) && (m_txonQueue->GetNPackets () == 0) && (m_retxBufferSize == 0) ) ||
+       ( (m_txonBuffer.IsEmpty ()) && (m_txonQueue->GetNPackets () == 0) && (m_retxBufferSize == 0) ) ||
        (m_vtS >= m_vtMs)
        || m_pollRetransmitTimerJustExpired
      )  
@@ -1113,8 +1114,11 @@ NrRlcAm::GetTxBuffer()
   std::vector < Ptr<Packet> > toBeReturned;
   if(!m_enableAqm)
   {
-    toBeReturned.insert(toBeReturned.begin(), m_txonBuffer.begin(), m_txonBuffer.end());
-    m_txonBuffer.clear();
+    toBeReturned.reserve (m_txonBuffer.GetNPackets ());
+    while (!m_txonBuffer.IsEmpty ())
+    {
+      toBeReturned.push_back (m_txonBuffer.PopFront ());
+    }
     m_txonBufferSize = 0;
   }
   else
@@ -1131,39 +1135,18 @@ uint32_t NrRlcAm::GetTxBufferSize()
   return m_txonBufferSize + m_txonQueue->GetNBytes();
 }
 
-std::vector < NrRlcAm::RetxPdu > 
-NrRlcAm::GetTxedBuffer()
-{
-  //std::vector < NrRlcAm::RetxPdu > toBeReturned;
-  //toBeReturned.insert(toBeReturned.begin(), m_txedBuffer.begin(), m_txedBuffer.end());
-  return m_txedBuffer;
-}
 uint32_t 
 NrRlcAm::GetTxedBufferSize()
 {
   return m_txedBufferSize;
 }
 
-std::vector < NrRlcAm::RetxPdu > 
-NrRlcAm::GetRetxBuffer()
-{
-  std::vector < NrRlcAm::RetxPdu > toBeReturned;
-  toBeReturned.insert(toBeReturned.begin(), m_retxBuffer.begin(), m_retxBuffer.end());
-  return toBeReturned;
-}
-
 uint32_t 
 NrRlcAm::GetRetxBufferSize()
 {
   return m_retxBufferSize;
 }
 
-std::map < uint32_t, Ptr<Packet> > 
-NrRlcAm::GetTransmittingRlcSduBuffer()
-{
-  return m_transmittingRlcSduBuffer;
-  // TODO check if it must be emptied
-}
 uint32_t 
 NrRlcAm::GetTransmittingRlcSduBufferSize()
 {
@@ -1176,6 +1159,107 @@ NrRlcAm::GetSegmentedRlcsdu()
   return m_segmented_rlcsdu;
 }
 
+namespace {
+
+/**
+ * Order the reassembled SDUs by PDCP SN
+ */
+struct LowerPdcpSn
+{
+  bool operator () (const std::pair<uint16_t, Ptr<Packet> > &a, const std::pair<uint16_t, Ptr<Packet> > &b) const
+  {
+    return a.first < b.first;
+  }
+};
+
+} // anonymous namespace
+
+uint32_t
+NrRlcAm::TakeHandoverSdus (std::vector < Ptr<Packet> > &sdus)
+{
+  NS_LOG_FUNCTION (this);
+
+  uint32_t txonBufferSize = GetTxBufferSize ();
+  std::vector < Ptr<Packet> > txonBuffer = GetTxBuffer ();
+
+  NS_LOG_INFO ("retxBuffer size = " << m_retxBufferSize);
+  NS_LOG_INFO ("txedBuffer size = " << m_txedBufferSize);
+  if (m_retxBufferSize + m_txedBufferSize > 0)
+    {
+      ReassembleUnacknowledgedPdus ();
+    }
+  m_txedBufferSize = 0;
+  m_retxBufferSize = 0;
+  // the unacknowledged PDUs are forwarded, neither a late STATUS PDU nor
+  // the poll retransmission should look for them
+  m_vtA = m_vtS;
+  m_vtMs = m_vtA + m_windowSize;
+  m_pollRetransmitTimer.Cancel ();
+
+  std::vector < Ptr<Packet> > txedSdus;
+  txedSdus.swap (m_txedRlcSduBuffer);
+  m_txedRlcSduBufferSize = 0;
+  Ptr<Packet> segmentedSdu = m_segmented_rlcsdu;
+  m_segmented_rlcsdu = 0;
+
+  if (m_transmittingRlcSduBufferSize == 0)
+    {
+      NS_LOG_DEBUG (this << " taking txonBuffer only, size = " << txonBufferSize);
+      sdus.insert (sdus.end (), txonBuffer.begin (), txonBuffer.end ());
+      return txonBufferSize;
+    }
+
+  // the reassembled SDUs by PDCP SN, only the last one of each SN is kept.
+  // The RLC does not keep the PDCP SN of its SDUs, so it is read from their
+  // header here: this only happens once per handover, while keeping the SN
+  // would parse the header of every SDU transmitted.
+  NrPdcpHeader pdcpHeader;
+  std::vector < std::pair<uint16_t, Ptr<Packet> > > transmitting;
+  transmitting.reserve (m_transmittingRlcSdus.size ());
+  for (std::vector < Ptr<Packet> >::iterator it = m_transmittingRlcSdus.begin (); it != m_transmittingRlcSdus.end (); ++it)
+    {
+      (*it)->PeekHeader (pdcpHeader);
+      transmitting.push_back (std::make_pair (pdcpHeader.GetSequenceNumber (), *it));
+    }
+  std::stable_sort (transmitting.begin (), transmitting.end (), LowerPdcpSn ());
+  uint32_t transmittingSize = m_transmittingRlcSduBufferSize;
+  m_transmittingRlcSdus.clear ();
+  m_transmittingRlcSduBufferSize = 0;
+
+  // the transmitted SDUs up to two SNs before the first reassembled one
+  int firstSn = transmitting.front ().first;
+  for (std::vector < Ptr<Packet> >::iterator it = txedSdus.begin (); it != txedSdus.end (); ++it)
+    {
+      if ((*it) != 0)
+        {
+          (*it)->PeekHeader (pdcpHeader);
+          if (pdcpHeader.GetSequenceNumber () >= firstSn - 2 && pdcpHeader.GetSequenceNumber () <= firstSn)
+            {
+              NS_LOG_DEBUG ("previous SDU SEQ = " << pdcpHeader.GetSequenceNumber () << " Size = " << (*it)->GetSize ());
+              sdus.push_back (*it);
+            }
+        }
+    }
+
+  for (uint32_t i = 0; i < transmitting.size (); i++)
+    {
+      if (i + 1 < transmitting.size () && transmitting[i + 1].first == transmitting[i].first)
+        {
+          continue;
+        }
+      NS_LOG_DEBUG ("reassembled SDU SEQ = " << transmitting[i].first);
+      sdus.push_back (transmitting[i].second);
+    }
+
+  // the complete version of the SDU being segmented
+  if (segmentedSdu != 0)
+    {
+      sdus.push_back (segmentedSdu);
+    }
+  sdus.insert (sdus.end (), txonBuffer.begin (), txonBuffer.end ());
+  return transmittingSize + txonBufferSize;
+}
+
 /* LL HO
  * Check if the current m_vtS (sending SEQ) is 
  * inside the transmitting window.
@@ -1209,7 +1293,7 @@ NrRlcAm::DoNotifyDlHarqDeliveryFailure (uint8_t harqId)
   if (m_txedBuffer.at (seqNumberValue).m_pdu != 0)
   {
     NS_LOG_INFO ("Move SN = " << seqNumberValue << " to retxBuffer");
-    m_retxBuffer.at (seqNumberValue).m_pdu = m_txedBuffer.at (seqNumberValue).m_pdu->Copy ();
+    m_retxBuffer.at (seqNumberValue).m_pdu = m_txedBuffer.at (seqNumberValue).m_pdu;
     m_retxBuffer.at (seqNumberValue).m_retxCount = m_txedBuffer.at (seqNumberValue).m_retxCount;
     m_retxBufferSize += m_retxBuffer.at (seqNumberValue).m_pdu->GetSize ();
 
@@ -1713,29 +1797,23 @@ NrRlcAm::Reassemble (Ptr<Packet> packet)
 
 // LL HO
 void 
-NrRlcAm::CreateRlcSduBuffer(){
-  NS_LOG_DEBUG (this);
-  NrPdcpHeader pdcpHeader;
-  for (std::vector < Ptr<Packet> >::iterator it = m_transmittingRlcSdus.begin(); it != m_transmittingRlcSdus.end(); ++it){
-    (*it)->PeekHeader(pdcpHeader);
-    NS_LOG_DEBUG ("RLCSDU_SEQ = " << pdcpHeader.GetSequenceNumber());
-    m_transmittingRlcSduBuffer[pdcpHeader.GetSequenceNumber()] = (*it)->Copy();
-  }
-}
-
-// LL HO
-void 
-NrRlcAm::RlcPdusToRlcSdus (std::vector < NrRlcAm::RetxPdu > RlcPdus){
+NrRlcAm::ReassembleUnacknowledgedPdus (){
 
-  NS_LOG_DEBUG (this << "in RlcPdusTo..." );
+  NS_LOG_DEBUG (this << "in ReassembleUnacknowledgedPdus" );
   uint16_t isGotExpectedSeqNumber = 0;
-  for ( std::vector <NrRlcAm::RetxPdu>::iterator it = RlcPdus.begin(); it != RlcPdus.end (); it++)
+  // both buffers are indexed by SN, and a PDU is either in one or in the other.
+  // The PDUs are taken out of the buffers, so they are reassembled without a copy.
+  for ( uint32_t sn = 0; sn < m_txedBuffer.size () && sn < m_retxBuffer.size (); sn++)
         {
-          if (it->m_pdu == 0){
+          Ptr<Packet> p = m_txedBuffer[sn].m_pdu != 0 ? m_txedBuffer[sn].m_pdu : m_retxBuffer[sn].m_pdu;
+          m_txedBuffer[sn].m_pdu = 0;
+          m_txedBuffer[sn].m_retxCount = 0;
+          m_retxBuffer[sn].m_pdu = 0;
+          m_retxBuffer[sn].m_retxCount = 0;
+          if (p == 0){
             continue;
           }
-          NS_LOG_DEBUG (this << "Pdu = " << it->m_pdu );
-          Ptr<Packet> p = it->m_pdu->Copy();
+          NS_LOG_DEBUG (this << "Pdu = " << p );
 
           // Get RLC header parameters
           NrRlcAmHeader rlcAmHeader;
@@ -1776,7 +1854,6 @@ NrRlcAm::RlcPdusToRlcSdus (std::vector < NrRlcAm::RetxPdu > RlcPdus){
               return;
             }
     }
-    CreateRlcSduBuffer();
 }
 
 void
@@ -2143,7 +2220,7 @@ sumPacketSize +=p->GetSize();
               if (m_txedBuffer.at (seqNumberValue).m_pdu != 0)
                 {
                   NS_LOG_INFO ("Move SN = " << seqNumberValue << " to retxBuffer");
-                  m_retxBuffer.at (seqNumberValue).m_pdu = m_txedBuffer.at (seqNumberValue).m_pdu->Copy ();
+                  m_retxBuffer.at (seqNumberValue).m_pdu = m_txedBuffer.at (seqNumberValue).m_pdu;
                   m_retxBuffer.at (seqNumberValue).m_retxCount = m_txedBuffer.at (seqNumberValue).m_retxCount;
                   m_retxBufferSize += m_retxBuffer.at (seqNumberValue).m_pdu->GetSize ();
 
@@ -2693,7 +2770,7 @@ NrRlcAm::DoReportBufferStatus (void)
   if ( m_txonBufferSize > 0 )
     {
       RlcTag txonQueueHolTimeTag;
-      m_txonBuffer.front ()->PeekPacketTag (txonQueueHolTimeTag);
+      m_txonBuffer.Front ()->PeekPacketTag (txonQueueHolTimeTag);
       txonQueueHolDelay = now - txonQueueHolTimeTag.GetSenderTimestamp ();
     }
 
@@ -2730,15 +2807,15 @@ NrRlcAm::DoReportBufferStatus (void)
    ReTx_QueingDelay = r.retxQueueHolDelay; //sjkang0104
 
   // from UM low lat TODO check
-  for (unsigned i = 0; i < m_txonBuffer.size(); i++)
+  for (unsigned i = 0; i < m_txonBuffer.GetNPackets (); i++)
   {
     if (i == 20)  // only include up to the first 20 packets
     {
       break;
     }
-    r.txPacketSizes.push_back (m_txonBuffer[i]->GetSize ());
+    r.txPacketSizes.push_back (m_txonBuffer.Get (i)->GetSize ());
     RlcTag holTimeTag;
-    m_txonBuffer[i]->PeekPacketTag (holTimeTag);
+    m_txonBuffer.Get (i)->PeekPacketTag (holTimeTag);
     Time holDelay = Simulator::Now () - holTimeTag.GetSenderTimestamp ();
     r.txPacketDelays.push_back (holDelay.GetMicroSeconds ());
   }
@@ -2848,7 +2925,7 @@ NrRlcAm::ExpirePollRetransmitTimer (void)
          if ( pduAvailable )
          {
            NS_LOG_INFO ("Move PDU " << sn << " from txedBuffer to retxBuffer");
-           m_retxBuffer.at (sn).m_pdu = m_txedBuffer.at (sn).m_pdu->Copy ();
+           m_retxBuffer.at (sn).m_pdu = m_txedBuffer.at (sn).m_pdu;
            m_retxBuffer.at (sn).m_retxCount = m_txedBuffer.at (sn).m_retxCount;
            m_retxBufferSize += m_retxBuffer.at (sn).m_pdu->GetSize ();
 
@@ -2867,7 +2944,7 @@ NrRlcAm::ExpirePollRetransmitTimer (void)
          if ( pduAvailable )
          {
            NS_LOG_INFO ("Move PDU " << sn << " from txedBuffer to retxBuffer");
-           m_retxBuffer.at (sn).m_pdu = m_txedBuffer.at (sn).m_pdu->Copy ();
+           m_retxBuffer.at (sn).m_pdu = m_txedBuffer.at (sn).m_pdu;
            m_retxBuffer.at (sn).m_retxCount = m_txedBuffer.at (sn).m_retxCount;
            m_retxBufferSize += m_retxBuffer.at (sn).m_pdu->GetSize ();
 
@@ -2884,7 +2961,7 @@ NrRlcAm::ExpirePollRetransmitTimer (void)
          if ( pduAvailable )
          {
            NS_LOG_INFO ("Move PDU " << sn << " from txedBuffer to retxBuffer");
-           m_retxBuffer.at (sn).m_pdu = m_txedBuffer.at (sn).m_pdu->Copy ();
+           m_retxBuffer.at (sn).m_pdu = m_txedBuffer.at (sn).m_pdu;
            m_retxBuffer.at (sn).m_retxCount = m_txedBuffer.at (sn).m_retxCount;
            m_retxBufferSize += m_retxBuffer.at (sn).m_pdu->GetSize ();
 
@@ -2956,7 +3033,7 @@ NrRlcAm::SendNrAssistantInformation(NgcX2Sap::AssistantInformationForSplitting i
 }
 
 void
-NrRlcAm::CalculatePathThroughput (std::ofstream *stream) // woody
+NrRlcAm::CalculatePathThroughput (Ptr<AsyncTraceFile> stream) // woody
 {
   Time now = Simulator::Now ();                                         /* Return the simulator's virtual time. */
   double cur = (sumPacketSize - lastSumPacketSize) * (double) 8 / 1e5;     /* Convert Application RX Packets to MBits. */
@@ -2976,15 +3053,15 @@ else if (now.GetSeconds() >=m_simulationTime.GetSeconds()+1.0 && countAtRlc ==1
     set_1.close();
 } */
 //std::cout << sumPacketSize << std::endl;
-  *stream << now.GetSeconds () << "\t" << cur << "\t"<<(double)((TotalPackets*8)/TotalTime)/1e6 <<std::endl;
+  stream->GetStream () << now.GetSeconds () << "\t" << cur << "\t"<<(double)((TotalPackets*8)/TotalTime)/1e6 << "\n";
   lastSumPacketSize = sumPacketSize;
   Simulator::Schedule (MilliSeconds (100), &NrRlcAm::CalculatePathThroughput, this, stream);
 }
 void
 NrRlcAm::RecordingQueueStatistics(){//sjkang1116
 
-	*measuringQusizeQueueDelayStream <<Simulator::Now().GetSeconds()<<"\t"<<m_txonBufferSize+m_txedBufferSize<< "\t"
-			<< m_retxBufferSize<<"\t" << TxOn_QueingDelay/10e3<<"\t"<<ReTx_QueingDelay/10e3<< std::endl;
+	measuringQusizeQueueDelayStream->GetStream () <<Simulator::Now().GetSeconds()<<"\t"<<m_txonBufferSize+m_txedBufferSize<< "\t"
+			<< m_retxBufferSize<<"\t" << TxOn_QueingDelay/10e3<<"\t"<<ReTx_QueingDelay/10e3<< "\n";
 Simulator::Schedule(MilliSeconds(1.0),&NrRlcAm::RecordingQueueStatistics,this);
 }
 void
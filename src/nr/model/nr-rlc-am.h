@@ -27,12 +27,12 @@
 #include <ns3/event-id.h>
 #include <ns3/nr-rlc-sequence-number.h>
 #include <ns3/nr-rlc.h>
+#include <ns3/nr-rlc-tx-queue.h>
 #include <ns3/ngc-x2-sap.h>
 #include <ns3/nr-pdcp-header.h>
 
 #include <vector>
 #include <map>
-#include <fstream>
 #include <string>
 
 #include "ns3/codel-queue-disc.h" 
@@ -65,29 +65,37 @@ public:
    * RLC NGC X2 SAP
    */
   virtual void DoSendMcPdcpSdu(NgcX2Sap::UeDataParams params);
-  virtual void CalculatePathThroughput(std::ofstream *stream); //sjkang
+  virtual void CalculatePathThroughput(Ptr<AsyncTraceFile> stream); //sjkang
 
   // LL HO
   std::vector < Ptr<Packet> > GetTxBuffer();
   uint32_t GetTxBufferSize();
   
-  std::vector < RetxPdu > GetTxedBuffer();
   uint32_t GetTxedBufferSize();
 
-  std::vector < RetxPdu > GetRetxBuffer();
   uint32_t GetRetxBufferSize();
 
-  std::map < uint32_t, Ptr<Packet> > GetTransmittingRlcSduBuffer();
   uint32_t GetTransmittingRlcSduBufferSize();
 
   Ptr<Packet> GetSegmentedRlcsdu();
-  ///< translate a vector of Rlc PDUs to Rlc SDUs 
-  ///< and put the Rlc SDUs into m_transmittingRlcSdus.
-  void  RlcPdusToRlcSdus (std::vector < RetxPdu >  Pdus);
-  
-  std::vector < Ptr<Packet> > GetTxedRlcSduBuffer (){
-    return m_txedRlcSduBuffer;
-  }
+
+  /**
+   * Hand over the SDUs not delivered yet, to forward them to the target
+   * eNB. The PDUs of the transmitted and retransmission buffers are taken
+   * out of them, in SN order, and reassembled into SDUs; these SDUs, the
+   * transmitted SDUs, the SDU being segmented and the transmission buffer
+   * are moved out of the entity without copying them, leaving all these
+   * buffers empty, and the transmitting window is moved past the
+   * unacknowledged PDUs. The PDCP SN of the SDUs is read from their header.
+   *
+   * The SDUs are appended in this order: the last transmitted SDUs
+   * preceding the first reassembled one, the reassembled SDUs in PDCP SN
+   * order, the SDU being segmented and the SDUs of the transmission buffer.
+   *
+   * \param sdus the vector to append the SDUs to
+   * \return the size in bytes of the reassembled and transmission buffers
+   */
+  uint32_t TakeHandoverSdus (std::vector < Ptr<Packet> > &sdus);
 
 private:
   //whether the last SDU in the txonBuffer is a complete SDU.
@@ -127,9 +135,9 @@ private:
 
   // LL HO
   bool IsInsideTransmittingWindow ();
-  //Create RlcSduBuffer <seqNumber, RlcSDU> based on m_transmittingRlcSdus.
-  //The buffer is ascending ordered on sequence number.
-  void CreateRlcSduBuffer ();
+  //Reassemble the PDUs of the txed and retx buffers, in SN order,
+  //into m_transmittingRlcSdus, and empty both buffers.
+  void ReassembleUnacknowledgedPdus ();
 
 // 
 //   void ReassembleOutsideWindow (void);
@@ -149,7 +157,7 @@ private:
   void SendNrAssistantInformation(NgcX2Sap::AssistantInformationForSplitting info); //sjkang1114
   void DoRequestAssistantInfo();
 private:
-    std::vector < Ptr<Packet> > m_txonBuffer;       // Transmission buffer
+    NrRlcTxQueue m_txonBuffer;       // Transmission buffer
 
     struct RetxSegPdu
     {
@@ -176,7 +184,6 @@ private:
   ///< and forwarded to target eNB during lossless handover.
   std::vector < Ptr<Packet> > m_transmittingRlcSdus;
   uint32_t m_transmittingRlcSduBufferSize;
-  std::map <uint32_t, Ptr <Packet> > m_transmittingRlcSduBuffer;
 
     uint32_t m_txonBufferSize;
     uint32_t m_retxBufferSize;
@@ -277,7 +284,7 @@ private:
   uint32_t m_maxTxBufferSize;
 
   std::string m_bufferSizeFilename;
-  std::ofstream m_bufferSizeFile;
+  Ptr<AsyncTraceFile> m_bufferSizeFile;
   EventId m_traceBufferSizeEvent;
 
   bool m_enableAqm;
@@ -253,7 +253,7 @@ NrRlcTm::ExpireRbsTimer (void)
     }
 }
 void
-NrRlcTm::CalculatePathThroughput (std::ofstream *streamPathThroughput){
+NrRlcTm::CalculatePathThroughput (Ptr<AsyncTraceFile> streamPathThroughput){
   NS_FATAL_ERROR ("Not implemented yet");
 }
 void
@@ -57,7 +57,7 @@ public:
   virtual void DoReceivePdu (Ptr<Packet> p);
 
   virtual void DoSendMcPdcpSdu(NgcX2Sap::UeDataParams params);
-  virtual void CalculatePathThroughput(std::ofstream *stream); //sjkang
+  virtual void CalculatePathThroughput(Ptr<AsyncTraceFile> stream); //sjkang
   virtual void DoRequestAssistantInfo();
 private:
   void ExpireRbsTimer (void);
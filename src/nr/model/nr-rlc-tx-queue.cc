@@ -0,0 +1,121 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/nr-rlc-tx-queue.h"
+#include "ns3/log.h"
+#include "ns3/assert.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("NrRlcTxQueue");
+
+static const uint32_t INITIAL_CAPACITY = 64;
+
+NrRlcTxQueue::NrRlcTxQueue ()
+  : m_ring (INITIAL_CAPACITY),
+    m_mask (INITIAL_CAPACITY - 1),
+    m_head (0),
+    m_nPackets (0)
+{
+}
+
+void
+NrRlcTxQueue::Grow ()
+{
+  uint32_t capacity = m_ring.size ();
+  NS_LOG_FUNCTION (this << capacity);
+  std::vector<Ptr<Packet> > ring (2 * capacity);
+  for (uint32_t i = 0; i < m_nPackets; i++)
+    {
+      ring[i] = m_ring[(m_head + i) & m_mask];
+    }
+  m_ring.swap (ring);
+  m_mask = 2 * capacity - 1;
+  m_head = 0;
+}
+
+void
+NrRlcTxQueue::PushBack (Ptr<Packet> p)
+{
+  if (m_nPackets == m_ring.size ())
+    {
+      Grow ();
+    }
+  m_ring[(m_head + m_nPackets) & m_mask] = p;
+  m_nPackets++;
+}
+
+void
+NrRlcTxQueue::PushFront (Ptr<Packet> p)
+{
+  if (m_nPackets == m_ring.size ())
+    {
+      Grow ();
+    }
+  m_head = (m_head + m_mask) & m_mask;
+  m_ring[m_head] = p;
+  m_nPackets++;
+}
+
+Ptr<Packet>
+NrRlcTxQueue::PopFront ()
+{
+  NS_ASSERT_MSG (m_nPackets > 0, "PopFront on an empty RLC tx queue");
+  Ptr<Packet> p = m_ring[m_head];
+  m_ring[m_head] = 0;
+  m_head = (m_head + 1) & m_mask;
+  m_nPackets--;
+  return p;
+}
+
+Ptr<Packet>
+NrRlcTxQueue::Front () const
+{
+  NS_ASSERT_MSG (m_nPackets > 0, "Front on an empty RLC tx queue");
+  return m_ring[m_head];
+}
+
+Ptr<Packet>
+NrRlcTxQueue::Get (uint32_t i) const
+{
+  NS_ASSERT_MSG (i < m_nPackets, "SDU " << i << " out of " << m_nPackets);
+  return m_ring[(m_head + i) & m_mask];
+}
+
+uint32_t
+NrRlcTxQueue::GetNPackets () const
+{
+  return m_nPackets;
+}
+
+bool
+NrRlcTxQueue::IsEmpty () const
+{
+  return m_nPackets == 0;
+}
+
+void
+NrRlcTxQueue::Clear ()
+{
+  for (uint32_t i = 0; i < m_nPackets; i++)
+    {
+      m_ring[(m_head + i) & m_mask] = 0;
+    }
+  m_head = 0;
+  m_nPackets = 0;
+}
+
+} // namespace ns3
@@ -0,0 +1,97 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef NR_RLC_TX_QUEUE_H
+#define NR_RLC_TX_QUEUE_H
+
+#include "ns3/ptr.h"
+#include "ns3/packet.h"
+
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \brief FIFO of the RLC SDUs waiting for a transmission opportunity
+ *
+ * The SDUs are kept in a ring whose capacity is a power of two, so that
+ * enqueuing an SDU, dequeuing the head SDU and putting back the remaining
+ * segment of a fragmented SDU are O(1). The ring only grows, by doubling,
+ * when it is full: the number of SDUs is bounded by the byte limit of the
+ * RLC entity, so after the first bursts no allocation happens.
+ */
+class NrRlcTxQueue
+{
+public:
+  NrRlcTxQueue ();
+
+  /**
+   * \param p the SDU to add at the tail
+   */
+  void PushBack (Ptr<Packet> p);
+
+  /**
+   * \param p the SDU to add at the head, i.e., the remaining segment of the head SDU
+   */
+  void PushFront (Ptr<Packet> p);
+
+  /**
+   * Remove the head SDU
+   * \return the removed SDU
+   */
+  Ptr<Packet> PopFront ();
+
+  /**
+   * \return the head SDU
+   */
+  Ptr<Packet> Front () const;
+
+  /**
+   * \param i the position from the head
+   * \return the SDU at position i
+   */
+  Ptr<Packet> Get (uint32_t i) const;
+
+  /**
+   * \return the number of SDUs in the queue
+   */
+  uint32_t GetNPackets () const;
+
+  /**
+   * \return true if the queue holds no SDU
+   */
+  bool IsEmpty () const;
+
+  /**
+   * Remove all the SDUs
+   */
+  void Clear ();
+
+private:
+  /**
+   * Double the capacity of the ring, keeping the order of the SDUs
+   */
+  void Grow ();
+
+  std::vector<Ptr<Packet> > m_ring; ///< storage, its size is a power of two
+  uint32_t m_mask;                  ///< size of m_ring minus one
+  uint32_t m_head;                  ///< position of the head SDU in m_ring
+  uint32_t m_nPackets;              ///< number of SDUs in the queue
+};
+
+} // namespace ns3
+
+#endif // NR_RLC_TX_QUEUE_H
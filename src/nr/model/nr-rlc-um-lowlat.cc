@@ -107,7 +107,7 @@ NrRlcUmLowLat::DoDispose ()
   m_rbsTimer.Cancel ();
   m_sendAssistatInfo.Cancel();
   m_reorderingQueueStatistic.Cancel();
-  measuringQusizeQueueDelayStream->close();
+  measuringQusizeQueueDelayStream = 0;
   //delete ( m_ngcX2RlcProvider);
   //delete (m_ngcX2RlcUser);
   TxOn_QueingDelay =0;
@@ -1329,13 +1329,13 @@ NrRlcUmLowLat::DoSendAssistantInformation(NgcX2Sap::AssistantInformationForSplit
 
 }
 void
-NrRlcUmLowLat::CalculatePathThroughput (std::ofstream *streamPathThroughput){
+NrRlcUmLowLat::CalculatePathThroughput (Ptr<AsyncTraceFile> streamPathThroughput){
   NS_FATAL_ERROR ("Not implemented yet");
 }
 void
 NrRlcUmLowLat::RecordingQueueStatistics(){//sjkang1116
-	*measuringQusizeQueueDelayStream << Simulator::Now().GetSeconds()<<"\t"<<m_txBufferSize << "\t"
-			<<TxOn_QueingDelay<< std::endl;
+	measuringQusizeQueueDelayStream->GetStream () << Simulator::Now().GetSeconds()<<"\t"<<m_txBufferSize << "\t"
+			<<TxOn_QueingDelay<< "\n";
 m_reorderingTimer.Cancel();
 	if(!m_reorderingQueueStatistic.IsRunning())
 		m_reorderingQueueStatistic = Simulator::Schedule(MilliSeconds(1.0),&NrRlcUmLowLat::RecordingQueueStatistics,this);
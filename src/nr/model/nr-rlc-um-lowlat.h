@@ -67,7 +67,7 @@ public:
   virtual void DoNotifyTxOpportunity (uint32_t bytes, uint8_t layer, uint8_t harqId);
   virtual void DoNotifyHarqDeliveryFailure ();
   virtual void DoReceivePdu (Ptr<Packet> p);
-  virtual void CalculatePathThroughput(std::ofstream *stream);
+  virtual void CalculatePathThroughput(Ptr<AsyncTraceFile> stream);
   std::vector < Ptr<Packet> > GetTxBuffer();
   void ClearTxBuffer();
   uint32_t GetTxBufferSize()
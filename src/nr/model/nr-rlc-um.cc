@@ -118,9 +118,9 @@ NrRlcUm::DoTransmitPdcpPdu (Ptr<Packet> p)
       p->AddPacketTag (tag);
 
       NS_LOG_LOGIC ("Tx Buffer: New packet added");
-      m_txBuffer.push_back (p);
+      m_txBuffer.PushBack (p);
       m_txBufferSize += p->GetSize ();
-      NS_LOG_LOGIC ("NumOfBuffers = " << m_txBuffer.size() );
+      NS_LOG_LOGIC ("NumOfBuffers = " << m_txBuffer.GetNPackets () );
       NS_LOG_LOGIC ("txBufferSize = " << m_txBufferSize);
     }
   else
@@ -172,21 +172,21 @@ NrRlcUm::DoNotifyTxOpportunity (uint32_t bytes, uint8_t layer, uint8_t harqId)
 
   // Remove the first packet from the transmission buffer.
   // If only a segment of the packet is taken, then the remaining is given back later
-  if ( m_txBuffer.size () == 0 )
+  if ( m_txBuffer.GetNPackets () == 0 )
     {
       NS_LOG_LOGIC ("No data pending");
       return;
     }
 
-  NS_LOG_LOGIC ("SDUs in TxBuffer  = " << m_txBuffer.size ());
-  NS_LOG_LOGIC ("First SDU buffer  = " << *(m_txBuffer.begin()));
-  NS_LOG_LOGIC ("First SDU size    = " << (*(m_txBuffer.begin()))->GetSize ());
+  NS_LOG_LOGIC ("SDUs in TxBuffer  = " << m_txBuffer.GetNPackets ());
+  NS_LOG_LOGIC ("First SDU buffer  = " << m_txBuffer.Front ());
+  NS_LOG_LOGIC ("First SDU size    = " << m_txBuffer.Front ()->GetSize ());
   NS_LOG_LOGIC ("Next segment size = " << nextSegmentSize);
   NS_LOG_LOGIC ("Remove SDU from TxBuffer");
-  Ptr<Packet> firstSegment = (*(m_txBuffer.begin ()))->Copy ();
-  m_txBufferSize -= (*(m_txBuffer.begin()))->GetSize ();
+  Ptr<Packet> firstSegment = m_txBuffer.Front ()->Copy ();
+  m_txBufferSize -= m_txBuffer.Front ()->GetSize ();
   NS_LOG_LOGIC ("txBufferSize      = " << m_txBufferSize );
-  m_txBuffer.erase (m_txBuffer.begin ());
+  m_txBuffer.PopFront ();
 
   while ( firstSegment && (firstSegment->GetSize () > 0) && (nextSegmentSize > 0) )
     {
@@ -234,12 +234,12 @@ NrRlcUm::DoNotifyTxOpportunity (uint32_t bytes, uint8_t layer, uint8_t harqId)
             {
               firstSegment->AddPacketTag (oldTag);
 
-              m_txBuffer.insert (m_txBuffer.begin (), firstSegment);
-              m_txBufferSize += (*(m_txBuffer.begin()))->GetSize ();
+              m_txBuffer.PushFront (firstSegment);
+              m_txBufferSize += m_txBuffer.Front ()->GetSize ();
 
               NS_LOG_LOGIC ("    TX buffer: Give back the remaining segment");
-              NS_LOG_LOGIC ("    TX buffers = " << m_txBuffer.size ());
-              NS_LOG_LOGIC ("    Front buffer size = " << (*(m_txBuffer.begin()))->GetSize ());
+              NS_LOG_LOGIC ("    TX buffers = " << m_txBuffer.GetNPackets ());
+              NS_LOG_LOGIC ("    Front buffer size = " << m_txBuffer.Front ()->GetSize ());
               NS_LOG_LOGIC ("    txBufferSize = " << m_txBufferSize );
             }
           else
@@ -280,7 +280,7 @@ NrRlcUm::DoNotifyTxOpportunity (uint32_t bytes, uint8_t layer, uint8_t harqId)
           // (NO more segments) → exit
           // break;
         }
-      else if ( (nextSegmentSize - firstSegment->GetSize () <= 2) || (m_txBuffer.size () == 0) )
+      else if ( (nextSegmentSize - firstSegment->GetSize () <= 2) || (m_txBuffer.GetNPackets () == 0) )
         {
           NS_LOG_LOGIC ("    IF nextSegmentSize - firstSegment->GetSize () <= 2 || txBuffer.size == 0");
           // Add txBuffer.FirstBuffer to DataField
@@ -297,11 +297,11 @@ NrRlcUm::DoNotifyTxOpportunity (uint32_t bytes, uint8_t layer, uint8_t harqId)
           nextSegmentSize -= dataFieldAddedSize;
           nextSegmentId++;
 
-          NS_LOG_LOGIC ("        SDUs in TxBuffer  = " << m_txBuffer.size ());
-          if (m_txBuffer.size () > 0)
+          NS_LOG_LOGIC ("        SDUs in TxBuffer  = " << m_txBuffer.GetNPackets ());
+          if (m_txBuffer.GetNPackets () > 0)
             {
-              NS_LOG_LOGIC ("        First SDU buffer  = " << *(m_txBuffer.begin()));
-              NS_LOG_LOGIC ("        First SDU size    = " << (*(m_txBuffer.begin()))->GetSize ());
+              NS_LOG_LOGIC ("        First SDU buffer  = " << m_txBuffer.Front ());
+              NS_LOG_LOGIC ("        First SDU size    = " << m_txBuffer.Front ()->GetSize ());
             }
           NS_LOG_LOGIC ("        Next segment size = " << nextSegmentSize);
 
@@ -310,7 +310,7 @@ NrRlcUm::DoNotifyTxOpportunity (uint32_t bytes, uint8_t layer, uint8_t harqId)
           // (NO more segments) → exit
           // break;
         }
-      else // (firstSegment->GetSize () < m_nextSegmentSize) && (m_txBuffer.size () > 0)
+      else // (firstSegment->GetSize () < m_nextSegmentSize) && (m_txBuffer.GetNPackets () > 0)
         {
           NS_LOG_LOGIC ("    IF firstSegment < NextSegmentSize && txBuffer.size > 0");
           // Add txBuffer.FirstBuffer to DataField
@@ -327,19 +327,19 @@ NrRlcUm::DoNotifyTxOpportunity (uint32_t bytes, uint8_t layer, uint8_t harqId)
           nextSegmentSize -= ((nextSegmentId % 2) ? (2) : (1)) + dataFieldAddedSize;
           nextSegmentId++;
 
-          NS_LOG_LOGIC ("        SDUs in TxBuffer  = " << m_txBuffer.size ());
-          if (m_txBuffer.size () > 0)
+          NS_LOG_LOGIC ("        SDUs in TxBuffer  = " << m_txBuffer.GetNPackets ());
+          if (m_txBuffer.GetNPackets () > 0)
             {
-              NS_LOG_LOGIC ("        First SDU buffer  = " << *(m_txBuffer.begin()));
-              NS_LOG_LOGIC ("        First SDU size    = " << (*(m_txBuffer.begin()))->GetSize ());
+              NS_LOG_LOGIC ("        First SDU buffer  = " << m_txBuffer.Front ());
+              NS_LOG_LOGIC ("        First SDU size    = " << m_txBuffer.Front ()->GetSize ());
             }
           NS_LOG_LOGIC ("        Next segment size = " << nextSegmentSize);
           NS_LOG_LOGIC ("        Remove SDU from TxBuffer");
 
           // (more segments)
-          firstSegment = (*(m_txBuffer.begin ()))->Copy ();
-          m_txBufferSize -= (*(m_txBuffer.begin()))->GetSize ();
-          m_txBuffer.erase (m_txBuffer.begin ());
+          firstSegment = m_txBuffer.Front ()->Copy ();
+          m_txBufferSize -= m_txBuffer.Front ()->GetSize ();
+          m_txBuffer.PopFront ();
           NS_LOG_LOGIC ("        txBufferSize = " << m_txBufferSize );
         }
 
@@ -410,7 +410,7 @@ NrRlcUm::DoNotifyTxOpportunity (uint32_t bytes, uint8_t layer, uint8_t harqId)
 
   m_macSapProvider->TransmitPdu (params);
 
-  if (! m_txBuffer.empty ())
+  if (! m_txBuffer.IsEmpty ())
     {
       m_rbsTimer.Cancel ();
       m_rbsTimer = Simulator::Schedule (MilliSeconds (10), &NrRlcUm::ExpireRbsTimer, this);
@@ -426,7 +426,13 @@ NrRlcUm::DoNotifyHarqDeliveryFailure ()
 std::vector < Ptr<Packet> > 
 NrRlcUm::GetTxBuffer()
 {
-  return m_txBuffer;
+  std::vector < Ptr<Packet> > toBeReturned;
+  toBeReturned.reserve (m_txBuffer.GetNPackets ());
+  for (uint32_t i = 0; i < m_txBuffer.GetNPackets (); i++)
+  {
+    toBeReturned.push_back (m_txBuffer.Get (i));
+  }
+  return toBeReturned;
 }
 
 void
@@ -1190,13 +1196,13 @@ NrRlcUm::DoReportBufferStatus (void)
   Time holDelay (0);
   uint32_t queueSize = 0;
 
-  if (! m_txBuffer.empty ())
+  if (! m_txBuffer.IsEmpty ())
     {
       RlcTag holTimeTag;
-      m_txBuffer.front ()->PeekPacketTag (holTimeTag);
+      m_txBuffer.Front ()->PeekPacketTag (holTimeTag);
       holDelay = Simulator::Now () - holTimeTag.GetSenderTimestamp ();
 
-      queueSize = m_txBufferSize + 2 * m_txBuffer.size (); // Data in tx queue + estimated headers size
+      queueSize = m_txBufferSize + 2 * m_txBuffer.GetNPackets (); // Data in tx queue + estimated headers size
     }
 
   NrMacSapProvider::ReportBufferStatusParameters r;
@@ -1258,7 +1264,7 @@ NrRlcUm::ExpireRbsTimer (void)
 {
   NS_LOG_LOGIC ("RBS Timer expires");
 
-  if (! m_txBuffer.empty ())
+  if (! m_txBuffer.IsEmpty ())
     {
       DoReportBufferStatus ();
       m_rbsTimer = Simulator::Schedule (MilliSeconds (10), &NrRlcUm::ExpireRbsTimer, this);
@@ -1266,7 +1272,7 @@ NrRlcUm::ExpireRbsTimer (void)
 }
 //int ccc=10;
 void
-NrRlcUm::CalculatePathThroughput (std::ofstream *stream) // woody
+NrRlcUm::CalculatePathThroughput (Ptr<AsyncTraceFile> stream) // woody
 {
 	this->stream = stream;
 Time now = Simulator::Now ();                                         /* Return the simulator's virtual time. */
@@ -1287,7 +1293,7 @@ else if (now.GetSeconds() >=m_simulationTime.GetSeconds()+1.0 && countAtRlc ==1
 	set_1<<"\t" << cur << "\t" << throughputAtSenb << std::endl;
     set_1.close();
 } */
-  *stream << now.GetSeconds () << "\t" << cur << "\t"<< (double)((TotalPackets*8)/TotalTime)/1e6 <<std::endl;
+  stream->GetStream () << now.GetSeconds () << "\t" << cur << "\t"<< (double)((TotalPackets*8)/TotalTime)/1e6 << "\n";
   lastSumPacketSize = sumPacketSize;
   //if(isEnbaleMeasuring)
  // std::cout << this<<"\t"<<sumPacketSize<< std::endl;
@@ -1316,7 +1322,7 @@ NrRlcUm::CalculateThroughput(){
 		set_1<<"\t" << cur << "\t" << throughputAtSenb << std::endl;
 	    set_1.close();
 	} */
-	  *stream << now.GetSeconds () << "\t" << cur << "\t"<<(double)((TotalPackets*8)/TotalTime)/1e6 <<std::endl;
+	  stream->GetStream () << now.GetSeconds () << "\t" << cur << "\t"<<(double)((TotalPackets*8)/TotalTime)/1e6 << "\n";
 	  lastSumPacketSize = sumPacketSize;
 	  //if(isEnbaleMeasuring)
 	  Simulator::Schedule (MilliSeconds (100), &NrRlcUm::CalculatePathThroughput,this , stream);
@@ -1324,8 +1330,8 @@ NrRlcUm::CalculateThroughput(){
 void
 NrRlcUm::RecordingQueueStatistics(){//sjkang1116
 
-	*measuringQusizeQueueDelayStream <<Simulator::Now().GetSeconds()<<"\t"<<TxQueueSize<<"\t"
-			<<TxQueuingDelay<<std::endl;
+	measuringQusizeQueueDelayStream->GetStream () <<Simulator::Now().GetSeconds()<<"\t"<<TxQueueSize<<"\t"
+			<<TxQueuingDelay<< "\n";
 Simulator::Schedule(MilliSeconds(1.0),&NrRlcUm::RecordingQueueStatistics,this);
 }
 void
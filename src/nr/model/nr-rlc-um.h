@@ -27,6 +27,7 @@
 
 #include "ns3/nr-rlc-sequence-number.h"
 #include "ns3/nr-rlc.h"
+#include "ns3/nr-rlc-tx-queue.h"
 #include <ns3/ngc-x2-sap.h>
 
 #include <ns3/event-id.h>
@@ -63,7 +64,7 @@ public:
   virtual void DoNotifyTxOpportunity (uint32_t bytes, uint8_t layer, uint8_t harqId);
   virtual void DoNotifyHarqDeliveryFailure ();
   virtual void DoReceivePdu (Ptr<Packet> p);
-  virtual void CalculatePathThroughput(std::ofstream *stream); //sjkang
+  virtual void CalculatePathThroughput(Ptr<AsyncTraceFile> stream); //sjkang
    void CalculateThroughput();
   virtual void DoRequestAssistantInfo(); //sjkang
   std::vector < Ptr<Packet> > GetTxBuffer();
@@ -89,7 +90,7 @@ private:
 private:
   uint32_t m_maxTxBufferSize;
   uint32_t m_txBufferSize;
-  std::vector < Ptr<Packet> > m_txBuffer;       // Transmission buffer
+  NrRlcTxQueue m_txBuffer;       // Transmission buffer
   std::map <uint16_t, Ptr<Packet> > m_rxBuffer; // Reception buffer
   std::vector < Ptr<Packet> > m_reasBuffer;     // Reassembling buffer
 
@@ -133,7 +134,7 @@ private:
   uint64_t lastSumPacketSize;
   uint64_t sumPacketSize;
   double TotalTime=0.0;
-  std::ofstream *stream;
+  Ptr<AsyncTraceFile> stream;
   uint32_t TxQueueSize;
   uint16_t TxQueuingDelay;
 };
@@ -141,7 +141,7 @@ NrRlc::SetDrbId(uint8_t drbid){ //sjkang1115
 
 }
 void
-NrRlc::SetStreamForQueueStatistics(std::ofstream *stream){
+NrRlc::SetStreamForQueueStatistics(Ptr<AsyncTraceFile> stream){
 	measuringQusizeQueueDelayStream = stream; //sjkang1116
 }
 void
@@ -328,7 +328,7 @@ NrRlcSm::DoSendMcPdcpSdu(NgcX2Sap::UeDataParams params)
 
 
 void
-NrRlcSm::CalculatePathThroughput (std::ofstream *streamPathThroughput) // woody
+NrRlcSm::CalculatePathThroughput (Ptr<AsyncTraceFile> streamPathThroughput) // woody
 {
   NS_FATAL_ERROR ("Not implemented yet");
 }
@@ -37,7 +37,7 @@
 
 #include "ns3/nr-rlc-sap.h"
 #include "ns3/nr-mac-sap.h"
-#include <fstream>//sjkang
+#include "ns3/async-trace-file.h"
 
 namespace ns3 {
 
@@ -91,7 +91,7 @@ public:
    */
   void SetRnti (uint16_t rnti);
   void SetDrbId(uint8_t drbId); //sjkang1115
-  void SetStreamForQueueStatistics(std::ofstream * stream); //sjkang1116
+  void SetStreamForQueueStatistics(Ptr<AsyncTraceFile> stream); //sjkang1116
 
   /**
    *
@@ -183,7 +183,7 @@ public:
 
   /// \todo MRE What is the sense to duplicate all the interfaces here???
   // NB to avoid the use of multiple inheritance
-  virtual void CalculatePathThroughput(std::ofstream *stream)=0; //sjkang
+  virtual void CalculatePathThroughput(Ptr<AsyncTraceFile> stream)=0; //sjkang
 
 protected:
   // Interface forwarded by NrRlcSapProvider
@@ -209,7 +209,7 @@ protected:
   uint16_t m_rnti;
   uint8_t m_lcid;
   uint8_t m_drbId;//sjkang1115
-  std::ofstream *measuringQusizeQueueDelayStream; //sjkang1116
+  Ptr<AsyncTraceFile> measuringQusizeQueueDelayStream; //sjkang1116
  // uint16_t m_rnti; //sjkang1115
   /**
    * Used to inform of a PDU delivery to the MAC SAP provider
@@ -255,7 +255,7 @@ public:
   virtual void DoNotifyHarqDeliveryFailure ();
   virtual void DoReceivePdu (Ptr<Packet> p);
   virtual void DoSendMcPdcpSdu (NgcX2Sap::UeDataParams params);
-  virtual void CalculatePathThroughput(std::ofstream *stream); //sjkang
+  virtual void CalculatePathThroughput(Ptr<AsyncTraceFile> stream); //sjkang
   virtual void DoRequestAssistantInfo();//sjkang
 
 
@@ -1693,69 +1693,6 @@ NrUeRrc::DoRecvRrcConnectionSwitch (NrRrcSap::RrcConnectionSwitch msg)
 }
 
 
-/*
- * Merge 2 buffers of RlcAmPdus into 1 vector with increment order of Pdus
- */
-std::vector < NrRlcAm::RetxPdu >
-NrUeRrc::MergeBuffers(std::vector < NrRlcAm::RetxPdu > first, std::vector < NrRlcAm::RetxPdu > second)
-{
-  NrRlcAmHeader rlcamHeader_1, rlcamHeader_2;
-  std::vector < NrRlcAm::RetxPdu> result;
-  std::vector < NrRlcAm::RetxPdu>::iterator it_1 = first.begin();
-  std::vector < NrRlcAm::RetxPdu>::iterator it_2 = second.begin();
-  bool end_1_reached = false;
-  bool end_2_reached = false;
-  while (it_1 != first.end() && it_2 != second.end()){
-    while ((*it_1).m_pdu == 0){
-      ++it_1;
-      if(it_1 == first.end())
-      {
-        end_1_reached = true;
-        break;
-      }
-    }
-    while ((*it_2).m_pdu == 0){
-      ++it_2;
-      if(it_2 == second.end())
-      {
-        end_2_reached = true;
-        break;
-      }
-    }
-    if(!end_1_reached && !end_2_reached)
-    {
-      (*it_1).m_pdu->PeekHeader(rlcamHeader_1);
-      (*it_2).m_pdu->PeekHeader(rlcamHeader_2);
-      if (rlcamHeader_1.GetSequenceNumber() > rlcamHeader_2.GetSequenceNumber()){
-        result.push_back((*it_2));  
-        ++it_2;       
-      }
-      else if (rlcamHeader_2.GetSequenceNumber() > rlcamHeader_1.GetSequenceNumber()){
-        result.push_back((*it_1));
-        ++it_1;         
-      }
-      else {
-        result.push_back((*it_1));
-        ++it_1;
-        ++it_2;
-      }
-      NS_LOG_DEBUG ("first,second = " << rlcamHeader_1.GetSequenceNumber() << "," << rlcamHeader_2.GetSequenceNumber());
-    }
-    else
-    {
-      break;
-    }
-  }
-  while (it_1 != first.end()){
-    result.push_back((*it_1));
-    it_1++;
-  }
-  while (it_2 != second.end()){
-    result.push_back((*it_2));
-    it_2++;
-  }
-  return result;
-}
 
 // This code from the LL HO implementation is refactored in a function
 // in order to be used also when switching from NR to MmWave and back
@@ -1765,115 +1702,11 @@ NrUeRrc::CopyRlcBuffers(Ptr<NrRlc> rlc, Ptr<NrPdcp> pdcp, uint16_t lcid)
   // RlcBuffers forwarding only for RlcAm bearers.
   if (0 != rlc->GetObject<NrRlcAm> ())
   {
-    //Copy nr-rlc-am.m_txOnBuffer to X2 forwarding buffer.
+    //Move the SDUs of nr-rlc-am to the X2 forwarding buffer.
+    //Forwarding buffer = SDUs of the txed and retx buffers + txonBuffer.
     Ptr<NrRlcAm> rlcAm = rlc->GetObject<NrRlcAm>();
-    uint32_t txonBufferSize = rlcAm->GetTxBufferSize();
-    std::vector < Ptr<Packet> > txonBuffer = rlcAm->GetTxBuffer();
-    //m_rlcBufferToBeForwardedSize =  drbIt->second->m_rlc->GetObject<NrRlcAm>()->GetTxBufferSize();
-    //m_rlcBufferToBeForwarded = drbIt->second->m_rlc->GetObject<NrRlcAm>()->GetTxBuffer();
-    uint32_t txedBufferSize = rlcAm->GetTxedBufferSize();
-    std::vector < NrRlcAm::RetxPdu > txedBuffer = rlcAm->GetTxedBuffer();
-    uint32_t retxBufferSize = rlcAm->GetRetxBufferSize();
-    std::vector < NrRlcAm::RetxPdu > retxBuffer = rlcAm->GetRetxBuffer();
-    
-    //Translate Pdus in Rlc txed/retx buffer into RLC Sdus
-    //and put these Sdus into rlcAm->m_transmittingRlcSdus.
-    NS_LOG_INFO("UE RRC: retxBuffer size = " << retxBufferSize);
-    NS_LOG_INFO("UE RRC: txedBuffer size = " << txedBufferSize);
-    //Merge txed and retx buffers into a single buffer before doing RlcPdusToRlc.
-    if ( retxBufferSize + txedBufferSize > 0 ){
-      std::vector< NrRlcAm::RetxPdu > sortedTxedRetxBuffer;
-      if (retxBufferSize == 0){
-        sortedTxedRetxBuffer = txedBuffer;
-      }
-      else if (txedBufferSize == 0){
-        sortedTxedRetxBuffer = retxBuffer;
-      }
-      else {
-        sortedTxedRetxBuffer = MergeBuffers(txedBuffer, retxBuffer);
-      }
-      rlcAm->RlcPdusToRlcSdus(sortedTxedRetxBuffer);  
-    }
-
-    //Construct the forwarding buffer
-    //Forwarding buffer = retxBuffer + txedBuffer + txonBuffer.
-    //if ( txonBufferSize > 0 )
-    //{
-      NrPdcpHeader pdcpHeader;
-      uint32_t pos = 0;
-      for (std::vector< Ptr<Packet> >::iterator it = txonBuffer.begin(); it != txonBuffer.end(); ++it)
-      {
-        pos++;
-        if((*it)->GetSize() > 3) 
-        {
-          (*it)->PeekHeader(pdcpHeader);
-          NS_LOG_DEBUG("UE RRC: txonBuffer SEQ = " << pdcpHeader.GetSequenceNumber() << " Size = " << (*it)->GetSize());
-        }
-        else
-        {
-          NS_LOG_UNCOND("UE RRC: Fragment too small in txonBuffer, pos " << pos);
-        }
-          
-      }
-
-      // this cycle adds the SDUs given by the merge of txed and retxed buffers
-      if ( rlcAm->GetTransmittingRlcSduBufferSize() > 0 )
-      { //something inside the RLC AM's transmitting buffer 
-        NS_LOG_DEBUG ("UE RRC: ADDING TRANSMITTING SDUS OF RLC AM TO X2FORWARDINGBUFFER... Size = " << rlcAm->GetTransmittingRlcSduBufferSize() );
-        //copy the RlcSdu buffer (map) to forwardingBuffer.
-        std::map < uint32_t, Ptr<Packet> > rlcAmTransmittingBuffer = rlcAm->GetTransmittingRlcSduBuffer();
-        NS_LOG_DEBUG ("UE RRC:  *** SIZE = " << rlcAmTransmittingBuffer.size());
-        for (std::map< uint32_t, Ptr<Packet> >::iterator it = rlcAmTransmittingBuffer.begin(); it != rlcAmTransmittingBuffer.end(); ++it)
-        {
-          if (it->second != 0)
-          {
-            NS_LOG_DEBUG ( this << " add to forwarding buffer SEQ = " << it->first << " Ptr<Packet> = " << it->second );
-            m_rlcBufferToBeForwarded.push_back(it->second);
-          }
-        } 
-        NS_LOG_DEBUG(this << "UE RRC:  ADDING TXONBUFFER OF RLC AM " << m_rnti << " Size = " << txonBufferSize) ;
-
-      
-        Ptr<Packet> segmentedRlcsdu = rlcAm->GetSegmentedRlcsdu();
-        if (segmentedRlcsdu != NULL){
-          segmentedRlcsdu->PeekHeader(pdcpHeader);
-          NS_LOG_DEBUG(this << "UE RRC: SegmentedRlcSdu = " << segmentedRlcsdu->GetSize() << " SEQ = " << pdcpHeader.GetSequenceNumber());
-          //insert the complete version of the fragmented SDU to the front of txonBuffer.
-          txonBuffer.insert(txonBuffer.begin(),segmentedRlcsdu);
-        }
-        m_rlcBufferToBeForwarded.insert(m_rlcBufferToBeForwarded.end(), txonBuffer.begin(), txonBuffer.end());
-        m_rlcBufferToBeForwardedSize += rlcAm->GetTransmittingRlcSduBufferSize() + txonBufferSize;
-
-        //Get the rlcAm
-        std::vector < Ptr <Packet> > rlcAmTxedSduBuffer = rlcAm->GetTxedRlcSduBuffer();
-        NrPdcpHeader pdcpHeader_1;
-        m_rlcBufferToBeForwarded.at(0)->PeekHeader(pdcpHeader_1);
-        uint16_t i = 0;
-        for (std::vector< Ptr<Packet> >::iterator it = rlcAmTxedSduBuffer.begin(); it != rlcAmTxedSduBuffer.end(); ++it)
-        {
-          if ((*it) != NULL)
-          {
-            (*it)->PeekHeader(pdcpHeader);
-            NS_LOG_DEBUG("UE RRC: rlcAmTxedSduBuffer SEQ = " << pdcpHeader.GetSequenceNumber() << " Size = " << (*it)->GetSize());
-          
-            //add the previous SDU of the forwarding buffer to the forwarding buffer.
-            if (pdcpHeader.GetSequenceNumber() >= (pdcpHeader_1.GetSequenceNumber() - 2) && pdcpHeader.GetSequenceNumber() <= (pdcpHeader_1.GetSequenceNumber()) )
-            {
-              NS_LOG_DEBUG("UE RRC: Added previous SDU to forwarding buffer SEQ = " << pdcpHeader.GetSequenceNumber() << " Size = " << (*it)->GetSize());
-              m_rlcBufferToBeForwarded.insert(m_rlcBufferToBeForwarded.begin()+i, (*it)->Copy());
-              ++i;
-            }
-          }
-        }
-        
-      }
-      else 
-      { //TransmittingBuffer is empty. Only copy TxonBuffer.
-        NS_LOG_DEBUG(this << " UE RRC: ADDING TXONBUFFER OF RLC AM " << m_rnti << " Size = " << txonBufferSize) ;
-        m_rlcBufferToBeForwarded = txonBuffer;
-        m_rlcBufferToBeForwardedSize += txonBufferSize;
-      }
-    //}
+    NS_LOG_DEBUG(this << " UE RRC: TAKING THE SDUS OF RLC AM " << m_rnti);
+    m_rlcBufferToBeForwardedSize += rlcAm->TakeHandoverSdus(m_rlcBufferToBeForwarded);
   }
   //For RlcUM, no forwarding available as the simulator itself (seamless HO).
   //However, as the NR-UMTS book, PDCP txbuffer should be forwarded for seamless 
@@ -1897,12 +1730,15 @@ NrUeRrc::CopyRlcBuffers(Ptr<NrRlc> rlc, Ptr<NrPdcp> pdcp, uint16_t lcid)
   NS_LOG_DEBUG(this << " UE RRC: m_x2forw buffer size = " << m_rlcBufferToBeForwardedSize);
     //Forwarding the packet inside m_rlcBufferToBeForwarded to target eNB. 
 
-  while (!m_rlcBufferToBeForwarded.empty())
+  // the SDUs are forwarded in one pass, without erasing them one by one from the front
+  std::vector < Ptr<Packet> > forwardingBuffer;
+  forwardingBuffer.swap (m_rlcBufferToBeForwarded);
+  for (std::vector < Ptr<Packet> >::iterator sduIt = forwardingBuffer.begin (); sduIt != forwardingBuffer.end (); ++sduIt)
   {
     NS_LOG_DEBUG(this << " UE RRC: Forwarding m_rlcBufferToBeForwarded to target eNB, lcid = " << lcid );
     //Remove tags to get PDCP SDU from PDCP PDU.
     //Ptr<Packet> rlcSdu =  (*(m_rlcBufferToBeForwarded.begin()))->Copy();
-    Ptr<Packet> rlcSdu =  m_rlcBufferToBeForwarded.at(0);
+    Ptr<Packet> rlcSdu =  *sduIt;
     //Tags to be removed from rlcSdu (from outer to inner)
     //NrRlcSduStatusTag rlcSduStatusTag;
     //RlcTag  rlcTag; //rlc layer timestamp
@@ -1947,8 +1783,7 @@ NrUeRrc::CopyRlcBuffers(Ptr<NrRlc> rlc, Ptr<NrPdcp> pdcp, uint16_t lcid)
     {
       NS_LOG_UNCOND("UE RRC: Too small, not forwarded");
     }
-    m_rlcBufferToBeForwardedSize -= (*(m_rlcBufferToBeForwarded.begin()))->GetSize();
-    m_rlcBufferToBeForwarded.erase (m_rlcBufferToBeForwarded.begin());
+    m_rlcBufferToBeForwardedSize -= (*sduIt)->GetSize();
     NS_LOG_LOGIC(this << " UE RRC: After forwarding: buffer size = " << m_rlcBufferToBeForwardedSize );
   }
 }
@@ -2156,7 +1991,7 @@ NrUeRrc::DoNotifySecondaryCellHandover (uint16_t oldRnti, uint16_t newRnti, uint
          // else
         	//  fileName << "rlc_Tput_senb1_ue"<<m_imsi<<"_bearer_"<< (uint16_t)(dtamIt->drbIdentity) << ".txt";
 
-          	  std::ofstream* streamPathThroughput = new std::ofstream(fileName.str().c_str(), std::ofstream::app);
+          	  Ptr<AsyncTraceFile> streamPathThroughput = AsyncTraceFile::Open (fileName.str (), AsyncTraceFile::TEXT, true);
               rlc->CalculatePathThroughput(streamPathThroughput);
 
           //  Ptr<NrRlc> rlc_2 = rlcObjectFactory.Create ()->GetObject<NrRlc> ();
@@ -2439,7 +2274,7 @@ NrUeRrc::ApplyRadioResourceConfigDedicated (NrRrcSap::RadioResourceConfigDedicat
           std::ostringstream fileName_0;
                     //  fileName_0<<"UE-"<<m_imsi<<"-NR-" << "Bearer-"<< (uint16_t)(dtamIt->drbIdentity) << "-RLC-Throughput.txt";
           fileName_0<<"rlc_Tput_menb_ue"<<m_imsi<<"_bearer_"<< (uint16_t)(dtamIt->drbIdentity) << ".txt";
-                      std::ofstream* streamPathThroughput_0 = new std::ofstream(fileName_0.str().c_str());
+                      Ptr<AsyncTraceFile> streamPathThroughput_0 = AsyncTraceFile::Open (fileName_0.str ());
                      // *streamPathThroughput_0<<"time " <<"\t " <<"Instant Tput " << "\t " <<"Avg Tput "<< std::endl;
                       rlc->CalculatePathThroughput(streamPathThroughput_0);
 
@@ -2489,7 +2324,7 @@ NrUeRrc::ApplyRadioResourceConfigDedicated (NrRrcSap::RadioResourceConfigDedicat
             //  fileName<<"UE-"<<m_imsi<<"-Path-0_" << "Bearer-"<< (uint16_t)(dtamIt->drbIdentity) << "-RLC-Throughput.txt";
             fileName << "rlc_Tput_senb2_ue"<<m_imsi<<"_bearer_"<< (uint16_t)(dtamIt->drbIdentity) << ".txt";
 
-              std::ofstream* streamPathThroughput_1 = new std::ofstream(fileName.str().c_str());
+              Ptr<AsyncTraceFile> streamPathThroughput_1 = AsyncTraceFile::Open (fileName.str ());
             //  *streamPathThroughput_1<<"time " <<"\t " <<"Instant Tput " << "\t " <<"Avg Tput "<< std::endl;
 
               Ptr<NrRlc> rlc = rlcObjectFactory.Create ()->GetObject<NrRlc> ();
@@ -2504,7 +2339,7 @@ NrUeRrc::ApplyRadioResourceConfigDedicated (NrRrcSap::RadioResourceConfigDedicat
              // fileName_2<<"UE-"<<m_imsi<<"-Path-1_"<<"Bearer-"<< (uint16_t)(dtamIt->drbIdentity) << "-RLC-Throughput.txt";
             fileName_2 <<"rlc_Tput_senb1_ue"<<m_imsi<<"_bearer_"<< (uint16_t)(dtamIt->drbIdentity) << ".txt";
 
-              std::ofstream* streamPathThroughput_2 = new std::ofstream(fileName_2.str().c_str());
+              Ptr<AsyncTraceFile> streamPathThroughput_2 = AsyncTraceFile::Open (fileName_2.str ());
              // *streamPathThroughput_2<<"time " <<"\t " <<"Instant Tput " << "\t " <<"Avg Tput"<<std::endl;
 
               ////sjkang1110
@@ -2517,12 +2352,12 @@ NrUeRrc::ApplyRadioResourceConfigDedicated (NrRrcSap::RadioResourceConfigDedicat
 
                 std::ostringstream fileName_3;
                 fileName_3<<"UE-"<<m_imsi<<"-Bearer-"<< (uint16_t)(dtamIt->drbIdentity) << "-PDCP-Throughput.txt";
-                std::ofstream* streamPathThroughput_3 = new std::ofstream(fileName_3.str().c_str());
+                Ptr<AsyncTraceFile> streamPathThroughput_3 = AsyncTraceFile::Open (fileName_3.str ());
                  pdcp->CalculatePdcpThroughput(streamPathThroughput_3); //sjkang1113
 
                 std::ostringstream SN_diff_fileName; //sjkang1116
                 SN_diff_fileName << "UE-"<<m_imsi << "-Bearer-"<< (uint16_t)(dtamIt)->drbIdentity << "-SN_Difference.txt"; //sjkang1116
-                std::ofstream* SN_differenceStream = new std::ofstream(SN_diff_fileName.str().c_str()); //sjkang1116
+                Ptr<AsyncTraceFile> SN_differenceStream = AsyncTraceFile::Open (SN_diff_fileName.str ()); //sjkang1116
                 pdcp->SetStreams(SN_differenceStream);//sjkang1116
 
               struct NrUeCmacSapProvider::LogicalChannelConfig lcConfig;
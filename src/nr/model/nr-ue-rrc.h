@@ -566,8 +566,6 @@ private:
    * @params lcid
    */
   void CopyRlcBuffers(Ptr<NrRlc> rlc, Ptr<NrPdcp> pdcp, uint16_t lcid);
-  //Lossless HO: merge 2 buffers into 1 with increment order.
-  std::vector < NrRlcAm::RetxPdu > MergeBuffers(std::vector < NrRlcAm::RetxPdu > first, std::vector < NrRlcAm::RetxPdu > second);
 
 
   std::map<uint8_t, uint8_t> m_bid2DrbidMap;
@@ -0,0 +1,135 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <ns3/test.h>
+#include <ns3/log.h>
+#include <ns3/udp-l4-protocol.h>
+#include <ns3/ngc-tft.h>
+#include <ns3/ngc-tft-classifier.h>
+#include <ns3/ngc-smf-upf-application.h>
+
+NS_LOG_COMPONENT_DEFINE ("NgcUpfFlowCacheTest");
+
+using namespace ns3;
+
+/**
+ * Check the per-flow TEID cache of the downlink classification in the UPF:
+ * a flow is classified against the TFTs once, and the cache is dropped
+ * whenever a bearer is added or removed.
+ */
+class NgcUpfFlowCacheTestCase : public TestCase
+{
+public:
+  NgcUpfFlowCacheTestCase ();
+  virtual ~NgcUpfFlowCacheTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  static Ptr<NgcTft> CreateTft (uint16_t remotePort);
+  static NgcTftClassifier::PacketFields CreateFields (uint16_t remotePort, uint16_t localPort);
+};
+
+NgcUpfFlowCacheTestCase::NgcUpfFlowCacheTestCase ()
+  : TestCase ("Check the downlink TEID cache of the UPF")
+{
+}
+
+NgcUpfFlowCacheTestCase::~NgcUpfFlowCacheTestCase ()
+{
+}
+
+Ptr<NgcTft>
+NgcUpfFlowCacheTestCase::CreateTft (uint16_t remotePort)
+{
+  Ptr<NgcTft> tft = Create<NgcTft> ();
+  NgcTft::PacketFilter pf;
+  pf.direction = NgcTft::DOWNLINK;
+  pf.remotePortStart = remotePort;
+  pf.remotePortEnd = remotePort;
+  tft->Add (pf);
+  return tft;
+}
+
+NgcTftClassifier::PacketFields
+NgcUpfFlowCacheTestCase::CreateFields (uint16_t remotePort, uint16_t localPort)
+{
+  NgcTftClassifier::PacketFields fields;
+  fields.source = Ipv4Address ("1.0.0.2");
+  fields.destination = Ipv4Address ("7.0.0.2");
+  fields.sourcePort = remotePort;
+  fields.destinationPort = localPort;
+  fields.protocol = UdpL4Protocol::PROT_NUMBER;
+  fields.tos = 0;
+  return fields;
+}
+
+void
+NgcUpfFlowCacheTestCase::DoRun (void)
+{
+  Ptr<NgcSmfUpfApplication::UeInfo> ueInfo = Create<NgcSmfUpfApplication::UeInfo> ();
+  NgcTftClassifier::PacketFields flow = CreateFields (1234, 5000);
+
+  ueInfo->AddBearer (CreateTft (1234), 1, 10);
+  NS_TEST_ASSERT_MSG_EQ (ueInfo->Classify (flow), 10U, "wrong TEID");
+  NS_TEST_ASSERT_MSG_EQ (ueInfo->m_teidByFlow.size (), 1U, "the flow was not cached");
+  NS_TEST_ASSERT_MSG_EQ (ueInfo->Classify (flow), 10U, "wrong TEID of a cached flow");
+  NS_TEST_ASSERT_MSG_EQ (ueInfo->m_teidByFlow.size (), 1U, "the same flow was cached twice");
+  NS_TEST_ASSERT_MSG_EQ (ueInfo->Classify (CreateFields (4321, 5000)), 0U, "a flow out of the TFTs was matched");
+  NS_TEST_ASSERT_MSG_EQ (ueInfo->m_teidByFlow.size (), 2U, "the unmatched flow was not cached");
+
+  // a TFT that takes precedence, added behind the back of the cache: the
+  // flow already seen keeps its TEID, since it is not classified again,
+  // while a new flow is classified against the new TFT
+  ueInfo->m_tftClassifier.Add (CreateTft (1234), 20);
+  NS_TEST_ASSERT_MSG_EQ (ueInfo->Classify (flow), 10U, "a cached flow was classified again");
+  NS_TEST_ASSERT_MSG_EQ (ueInfo->Classify (CreateFields (1234, 5001)), 20U, "wrong TEID of a new flow");
+
+  // adding a bearer drops the cache
+  ueInfo->AddBearer (CreateTft (1234), 3, 30);
+  NS_TEST_ASSERT_MSG_EQ (ueInfo->m_teidByFlow.size (), 0U, "the cache was kept on a new bearer");
+  NS_TEST_ASSERT_MSG_EQ (ueInfo->Classify (flow), 30U, "the new bearer was ignored");
+
+  // so does removing one, whose TFT no longer matches
+  ueInfo->RemoveBearer (3);
+  NS_TEST_ASSERT_MSG_EQ (ueInfo->m_teidByFlow.size (), 0U, "the cache was kept on a removed bearer");
+  NS_TEST_ASSERT_MSG_EQ (ueInfo->Classify (flow), 20U, "the removed bearer is still matched");
+  ueInfo->RemoveBearer (1);
+  NS_TEST_ASSERT_MSG_EQ (ueInfo->Classify (CreateFields (1234, 5002)), 20U, "wrong TEID after removing a bearer");
+
+  // the cache is bounded
+  for (uint16_t port = 1; port <= 5000; port++)
+    {
+      ueInfo->Classify (CreateFields (1234, port));
+    }
+  NS_TEST_ASSERT_MSG_LT_OR_EQ (ueInfo->m_teidByFlow.size (), 4096U, "the cache is not bounded");
+  NS_TEST_ASSERT_MSG_EQ (ueInfo->Classify (flow), 20U, "wrong TEID after the cache was reset");
+}
+
+
+class NgcUpfFlowCacheTestSuite : public TestSuite
+{
+public:
+  NgcUpfFlowCacheTestSuite ();
+};
+
+NgcUpfFlowCacheTestSuite::NgcUpfFlowCacheTestSuite ()
+  : TestSuite ("ngc-upf-flow-cache", UNIT)
+{
+  AddTestCase (new NgcUpfFlowCacheTestCase, TestCase::QUICK);
+}
+
+static NgcUpfFlowCacheTestSuite g_ngcUpfFlowCacheTestSuite;
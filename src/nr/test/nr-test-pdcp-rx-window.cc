@@ -0,0 +1,223 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/packet.h"
+#include "ns3/nr-pdcp-rx-window.h"
+
+NS_LOG_COMPONENT_DEFINE ("NrPdcpRxWindowTest");
+
+using namespace ns3;
+
+/**
+ * Check the PDCP reception window: in-order delivery, reordering, duplicate
+ * discard, HFN wrap around, t-Reordering expiry, out-of-order delivery and
+ * the COUNT of SNs longer than 16 bits.
+ */
+class NrPdcpRxWindowTestCase : public TestCase
+{
+public:
+  NrPdcpRxWindowTestCase ();
+  virtual ~NrPdcpRxWindowTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Deliver callback of the window, records the COUNT
+   */
+  void Deliver (uint64_t count, NrPdcpSapUser::ReceivePdcpSduParameters params);
+
+  /**
+   * Receive a PDU and check the result
+   * \param window the window
+   * \param sn the SN of the PDU
+   * \param accepted true if the PDU must be accepted
+   * \param expectedCount the COUNT the PDU must get when accepted
+   */
+  void Receive (NrPdcpRxWindow *window, uint32_t sn, bool accepted, uint64_t expectedCount);
+
+  /**
+   * Check the COUNTs delivered since the last check
+   * \param expected the expected COUNTs, in order
+   * \param what the step of the test
+   */
+  void CheckDelivered (std::vector<uint64_t> expected, std::string what);
+
+  /**
+   * \return the COUNTs from first to last, both included
+   */
+  static std::vector<uint64_t> Range (uint64_t first, uint64_t last);
+
+  std::vector<uint64_t> m_delivered;
+};
+
+NrPdcpRxWindowTestCase::NrPdcpRxWindowTestCase ()
+  : TestCase ("Check the delivery of the PDCP reception window")
+{
+}
+
+NrPdcpRxWindowTestCase::~NrPdcpRxWindowTestCase ()
+{
+}
+
+void
+NrPdcpRxWindowTestCase::Deliver (uint64_t count, NrPdcpSapUser::ReceivePdcpSduParameters params)
+{
+  NS_TEST_ASSERT_MSG_NE (params.pdcpSdu, 0, "delivered a PDU without its SDU");
+  m_delivered.push_back (count);
+}
+
+void
+NrPdcpRxWindowTestCase::Receive (NrPdcpRxWindow *window, uint32_t sn, bool accepted, uint64_t expectedCount)
+{
+  NrPdcpSapUser::ReceivePdcpSduParameters params;
+  params.pdcpSdu = Create<Packet> (10);
+  params.rnti = 1;
+  params.lcid = 3;
+  uint64_t count = 0;
+  bool result = window->Receive (sn, params, count);
+  NS_TEST_ASSERT_MSG_EQ (result, accepted, "wrong acceptance of SN " << sn);
+  if (accepted)
+    {
+      NS_TEST_ASSERT_MSG_EQ (count, expectedCount, "wrong COUNT of SN " << sn);
+    }
+}
+
+void
+NrPdcpRxWindowTestCase::CheckDelivered (std::vector<uint64_t> expected, std::string what)
+{
+  NS_TEST_ASSERT_MSG_EQ (m_delivered.size (), expected.size (), what << ": wrong number of delivered PDUs");
+  for (uint32_t i = 0; i < m_delivered.size () && i < expected.size (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_delivered[i], expected[i], what << ": wrong COUNT of delivered PDU " << i);
+    }
+  m_delivered.clear ();
+}
+
+std::vector<uint64_t>
+NrPdcpRxWindowTestCase::Range (uint64_t first, uint64_t last)
+{
+  std::vector<uint64_t> counts;
+  for (uint64_t count = first; count <= last; count++)
+    {
+      counts.push_back (count);
+    }
+  return counts;
+}
+
+void
+NrPdcpRxWindowTestCase::DoRun (void)
+{
+  // 16 SNs, i.e., a window of 8 PDUs, so that the HFN wraps quickly
+  NrPdcpRxWindow window (16);
+  window.SetDeliverCallback (MakeCallback (&NrPdcpRxWindowTestCase::Deliver, this));
+  window.SetReorderingTime (MilliSeconds (50));
+
+  // in order, across two HFN wraps
+  for (uint64_t count = 0; count < 40; count++)
+    {
+      Receive (&window, count % 16, true, count);
+    }
+  CheckDelivered (Range (0, 39), "in order");
+  NS_TEST_ASSERT_MSG_EQ (window.GetRxDeliv (), 40, "wrong RX_DELIV");
+
+  // reordering across the HFN wrap: COUNTs 40 to 47 are SNs 8 to 15, 48 is SN 0
+  Receive (&window, 9, true, 41);
+  Receive (&window, 15, true, 47);
+  CheckDelivered (std::vector<uint64_t> (), "gap");
+  NS_TEST_ASSERT_MSG_EQ (window.GetNumBuffered (), 2, "wrong number of buffered PDUs");
+  // duplicates of a buffered and of a delivered PDU
+  Receive (&window, 9, false, 0);
+  Receive (&window, 7, false, 0);
+  Receive (&window, 8, true, 40);
+  CheckDelivered (Range (40, 41), "first hole filled");
+  // RX_DELIV is now SN 10, so SN 0 belongs to the next HFN
+  Receive (&window, 0, true, 48);
+  for (uint32_t sn = 10; sn < 15; sn++)
+    {
+      Receive (&window, sn, true, 32 + sn);
+    }
+  CheckDelivered (Range (42, 48), "second hole filled");
+  NS_TEST_ASSERT_MSG_EQ (window.GetNumBuffered (), 0, "wrong number of buffered PDUs");
+  NS_TEST_ASSERT_MSG_EQ (window.GetRxDeliv (), 49, "wrong RX_DELIV");
+
+  // t-Reordering: COUNT 49 (SN 1) is lost, the next ones are delivered when the timer expires
+  Receive (&window, 2, true, 50);
+  Receive (&window, 3, true, 51);
+  Simulator::Schedule (MilliSeconds (20), &NrPdcpRxWindowTestCase::Receive, this, &window, 5, true, 53);
+  Simulator::Stop (MilliSeconds (49));
+  Simulator::Run ();
+  CheckDelivered (std::vector<uint64_t> (), "before t-Reordering expires");
+  // the timer started with RX_NEXT 51, so 53 waits for a second expiry
+  Simulator::Stop (MilliSeconds (2));
+  Simulator::Run ();
+  CheckDelivered (Range (50, 51), "first t-Reordering expiry");
+  NS_TEST_ASSERT_MSG_EQ (window.GetRxDeliv (), 52, "wrong RX_DELIV after t-Reordering");
+  Simulator::Run ();
+  CheckDelivered (Range (53, 53), "second t-Reordering expiry");
+  NS_TEST_ASSERT_MSG_EQ (window.GetRxDeliv (), 54, "wrong RX_DELIV after t-Reordering");
+  // the late PDU is discarded
+  Receive (&window, 1, false, 0);
+  Receive (&window, 4, false, 0);
+  Receive (&window, 6, true, 54);
+  CheckDelivered (Range (54, 54), "after t-Reordering");
+  window.Dispose ();
+  Simulator::Destroy ();
+
+  // out-of-order delivery only discards the duplicates
+  NrPdcpRxWindow outOfOrder (16);
+  outOfOrder.SetDeliverCallback (MakeCallback (&NrPdcpRxWindowTestCase::Deliver, this));
+  outOfOrder.SetOutOfOrderDelivery (true);
+  Receive (&outOfOrder, 2, true, 2);
+  Receive (&outOfOrder, 0, true, 0);
+  Receive (&outOfOrder, 2, false, 0);
+  Receive (&outOfOrder, 1, true, 1);
+  std::vector<uint64_t> expected;
+  expected.push_back (2);
+  expected.push_back (0);
+  expected.push_back (1);
+  CheckDelivered (expected, "out of order");
+  NS_TEST_ASSERT_MSG_EQ (outOfOrder.GetNumBuffered (), 0, "out-of-order delivery buffered PDUs");
+  outOfOrder.Dispose ();
+  Simulator::Destroy ();
+
+  // 18-bit SNs
+  NrPdcpRxWindow longSn (1 << 18);
+  longSn.SetDeliverCallback (MakeCallback (&NrPdcpRxWindowTestCase::Deliver, this));
+  Receive (&longSn, 0, true, 0);
+  Receive (&longSn, 100000, true, 100000);
+  CheckDelivered (Range (0, 0), "18-bit SN");
+  longSn.Dispose ();
+  Simulator::Destroy ();
+}
+
+
+class NrPdcpRxWindowTestSuite : public TestSuite
+{
+public:
+  NrPdcpRxWindowTestSuite ();
+};
+
+NrPdcpRxWindowTestSuite::NrPdcpRxWindowTestSuite ()
+  : TestSuite ("nr-pdcp-rx-window", UNIT)
+{
+  AddTestCase (new NrPdcpRxWindowTestCase, TestCase::QUICK);
+}
+
+static NrPdcpRxWindowTestSuite g_nrPdcpRxWindowTestSuite;
@@ -0,0 +1,170 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <ns3/test.h>
+#include <ns3/log.h>
+#include <ns3/simulator.h>
+#include <ns3/boolean.h>
+#include <ns3/double.h>
+#include <ns3/uinteger.h>
+#include <ns3/string.h>
+#include <ns3/node-container.h>
+#include <ns3/net-device-container.h>
+#include <ns3/mobility-helper.h>
+#include <ns3/position-allocator.h>
+#include <ns3/propagation-loss-model.h>
+#include <ns3/nr-helper.h>
+#include <ns3/nr-enb-net-device.h>
+#include <ns3/nr-enb-phy.h>
+#include <ns3/nr-spectrum-phy.h>
+#include <ns3/nr-radio-environment-map-helper.h>
+#include <ns3/nr-rem-engine.h>
+
+#include <fstream>
+#include <sstream>
+
+NS_LOG_COMPONENT_DEFINE ("NrRemEngineTest");
+
+using namespace ns3;
+
+/**
+ * Check the map of NrRemEngine against the one of NrRadioEnvironmentMapHelper
+ * on a small grid covered by two eNBs, with a deterministic path loss, and
+ * check that the blocks and the parallel evaluation of the path loss give
+ * the same map.
+ */
+class NrRemEngineTestCase : public TestCase
+{
+public:
+  NrRemEngineTestCase ();
+  virtual ~NrRemEngineTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Set the grid of a map, on the helper or on the engine.
+   *
+   * \param map the NrRadioEnvironmentMapHelper or the NrRemEngine
+   */
+  static void SetGrid (Ptr<Object> map);
+};
+
+NrRemEngineTestCase::NrRemEngineTestCase ()
+  : TestCase ("Check NrRemEngine against NrRadioEnvironmentMapHelper")
+{
+}
+
+NrRemEngineTestCase::~NrRemEngineTestCase ()
+{
+}
+
+void
+NrRemEngineTestCase::SetGrid (Ptr<Object> map)
+{
+  map->SetAttribute ("XMin", DoubleValue (-20.0));
+  map->SetAttribute ("XMax", DoubleValue (180.0));
+  map->SetAttribute ("XRes", UintegerValue (5));
+  map->SetAttribute ("YMin", DoubleValue (-30.0));
+  map->SetAttribute ("YMax", DoubleValue (30.0));
+  map->SetAttribute ("YRes", UintegerValue (3));
+  map->SetAttribute ("Z", DoubleValue (1.5));
+}
+
+void
+NrRemEngineTestCase::DoRun (void)
+{
+  Ptr<NrHelper> nrHelper = CreateObject<NrHelper> ();
+  nrHelper->SetPathlossModelType ("ns3::LogDistancePropagationLossModel");
+
+  NodeContainer enbNodes;
+  enbNodes.Create (2);
+  Ptr<ListPositionAllocator> positionAlloc = CreateObject<ListPositionAllocator> ();
+  positionAlloc->Add (Vector (0, 0, 10));
+  positionAlloc->Add (Vector (150, 10, 10));
+  MobilityHelper mobility;
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.SetPositionAllocator (positionAlloc);
+  mobility.Install (enbNodes);
+  NetDeviceContainer enbDevs = nrHelper->InstallEnbDevice (enbNodes);
+
+  std::ostringstream channelPath;
+  channelPath << "/ChannelList/"
+              << DynamicCast<NrEnbNetDevice> (enbDevs.Get (0))->GetPhy ()->GetDlSpectrumPhy ()->GetChannel ()->GetId ();
+  std::string helperFile = CreateTempDirFilename ("nr-rem-helper.out");
+  Ptr<NrRadioEnvironmentMapHelper> remHelper = CreateObject<NrRadioEnvironmentMapHelper> ();
+  remHelper->SetAttribute ("ChannelPath", StringValue (channelPath.str ()));
+  remHelper->SetAttribute ("OutputFile", StringValue (helperFile));
+  SetGrid (remHelper);
+  remHelper->Install ();
+  Simulator::Run ();
+
+  // serial, in a single block
+  Ptr<NrRemEngine> serial = CreateObject<NrRemEngine> ();
+  SetGrid (serial);
+  serial->SetAttribute ("OutputFile", StringValue (CreateTempDirFilename ("nr-rem-engine.out")));
+  serial->SetAttribute ("Threads", UintegerValue (1));
+  serial->AddEnbDevices (enbDevs);
+  serial->SetPropagationLossModel (CreateObject<LogDistancePropagationLossModel> ());
+  serial->Run ();
+
+  // parallel, with probes moved from one block to the next
+  Ptr<NrRemEngine> parallel = CreateObject<NrRemEngine> ();
+  SetGrid (parallel);
+  parallel->SetAttribute ("OutputFile", StringValue (CreateTempDirFilename ("nr-rem-engine-parallel.out")));
+  parallel->SetAttribute ("Threads", UintegerValue (3));
+  parallel->SetAttribute ("MaxPointsPerIteration", UintegerValue (4));
+  parallel->SetAttribute ("ParallelPropagationLoss", BooleanValue (true));
+  parallel->AddEnbDevices (enbDevs);
+  parallel->SetPropagationLossModel (CreateObject<LogDistancePropagationLossModel> ());
+  parallel->Run ();
+
+  std::ifstream helperMap (helperFile.c_str ());
+  NS_TEST_ASSERT_MSG_EQ (helperMap.is_open (), true, "can't open " << helperFile);
+  for (uint32_t i = 0; i < 5; i++)
+    {
+      for (uint32_t j = 0; j < 3; j++)
+        {
+          double x, y, z, sinr;
+          helperMap >> x >> y >> z >> sinr;
+          NS_TEST_ASSERT_MSG_EQ (helperMap.good (), true, "the helper map is too short");
+          NS_TEST_ASSERT_MSG_EQ_TOL (x, -20.0 + i * 50.0, 1e-3, "wrong x of the point " << i << "," << j);
+          NS_TEST_ASSERT_MSG_EQ_TOL (y, -30.0 + j * 30.0, 1e-3, "wrong y of the point " << i << "," << j);
+          // the helper writes 6 significant digits
+          NS_TEST_ASSERT_MSG_EQ_TOL (serial->GetSinr (i, j), sinr, sinr * 1e-5,
+                                     "SINR different from the helper at " << x << "," << y);
+          NS_TEST_ASSERT_MSG_EQ_TOL (parallel->GetSinr (i, j), serial->GetSinr (i, j), serial->GetSinr (i, j) * 1e-12,
+                                     "parallel SINR different from the serial one at " << x << "," << y);
+        }
+    }
+
+  Simulator::Destroy ();
+}
+
+
+class NrRemEngineTestSuite : public TestSuite
+{
+public:
+  NrRemEngineTestSuite ();
+};
+
+NrRemEngineTestSuite::NrRemEngineTestSuite ()
+  : TestSuite ("nr-rem-engine", SYSTEM)
+{
+  AddTestCase (new NrRemEngineTestCase, TestCase::QUICK);
+}
+
+static NrRemEngineTestSuite g_nrRemEngineTestSuite;
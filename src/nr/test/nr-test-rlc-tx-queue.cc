@@ -0,0 +1,198 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <ns3/test.h>
+#include <ns3/log.h>
+#include <ns3/packet.h>
+#include <ns3/nr-rlc-tx-queue.h>
+
+#include <deque>
+
+NS_LOG_COMPONENT_DEFINE ("NrRlcTxQueueTest");
+
+using namespace ns3;
+
+/**
+ * Check NrRlcTxQueue against a std::deque: the ring wraps around in both
+ * directions and grows while wrapped, and a slot no longer holds its SDU
+ * once the SDU is popped, moved by Grow or cleared.
+ */
+class NrRlcTxQueueTestCase : public TestCase
+{
+public:
+  NrRlcTxQueueTestCase ();
+  virtual ~NrRlcTxQueueTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Check the queue against the reference, and that each SDU is only
+   * referenced by m_packets, the reference and, once, the queue.
+   *
+   * \param what the step being checked
+   */
+  void Check (std::string what);
+
+  /**
+   * \param front whether to push at the head
+   */
+  void Push (bool front);
+
+  /// Pop the head SDU of the queue and of the reference.
+  void Pop ();
+
+  NrRlcTxQueue m_queue;                 ///< the queue under test
+  std::deque<Ptr<Packet> > m_reference; ///< the expected content of the queue
+  std::vector<Ptr<Packet> > m_packets;  ///< every SDU created by the test
+};
+
+NrRlcTxQueueTestCase::NrRlcTxQueueTestCase ()
+  : TestCase ("Check the ring of the RLC tx queue")
+{
+}
+
+NrRlcTxQueueTestCase::~NrRlcTxQueueTestCase ()
+{
+}
+
+void
+NrRlcTxQueueTestCase::Push (bool front)
+{
+  Ptr<Packet> p = Create<Packet> (m_packets.size () + 1);
+  m_packets.push_back (p);
+  if (front)
+    {
+      m_queue.PushFront (p);
+      m_reference.push_front (p);
+    }
+  else
+    {
+      m_queue.PushBack (p);
+      m_reference.push_back (p);
+    }
+}
+
+void
+NrRlcTxQueueTestCase::Pop ()
+{
+  Ptr<Packet> p = m_queue.PopFront ();
+  NS_TEST_ASSERT_MSG_EQ (p, m_reference.front (), "wrong SDU popped");
+  m_reference.pop_front ();
+}
+
+void
+NrRlcTxQueueTestCase::Check (std::string what)
+{
+  NS_TEST_ASSERT_MSG_EQ (m_queue.GetNPackets (), m_reference.size (), what << ": wrong number of SDUs");
+  NS_TEST_ASSERT_MSG_EQ (m_queue.IsEmpty (), m_reference.empty (), what << ": wrong emptiness");
+  if (!m_reference.empty ())
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_queue.Front (), m_reference.front (), what << ": wrong head SDU");
+    }
+  for (uint32_t i = 0; i < m_reference.size (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_queue.Get (i), m_reference[i], what << ": wrong SDU at " << i);
+    }
+  // an SDU in the queue is referenced by m_packets, m_reference and one slot
+  std::vector<uint32_t> expected (m_packets.size () + 1, 1);
+  for (uint32_t i = 0; i < m_reference.size (); i++)
+    {
+      expected[m_reference[i]->GetSize ()] = 3;
+    }
+  for (uint32_t i = 0; i < m_packets.size (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_packets[i]->GetReferenceCount (), expected[i + 1],
+                             what << ": SDU " << i + 1 << " is still held by a slot or held twice");
+    }
+}
+
+void
+NrRlcTxQueueTestCase::DoRun (void)
+{
+  Check ("empty queue");
+
+  // move the head away from the start of the ring
+  for (uint32_t i = 0; i < 40; i++)
+    {
+      Push (false);
+    }
+  for (uint32_t i = 0; i < 30; i++)
+    {
+      Pop ();
+    }
+  Check ("after PopFront");
+
+  // the head wraps below the start of the ring
+  for (uint32_t i = 0; i < 40; i++)
+    {
+      Push (true);
+    }
+  Check ("after PushFront across the start of the ring");
+
+  // fill the initial ring, then grow it while it is wrapped, from both ends
+  while (m_reference.size () < 64)
+    {
+      Push (false);
+    }
+  Check ("full ring");
+  Push (true);
+  Check ("after Grow by PushFront");
+  for (uint32_t i = 0; i < 150; i++)
+    {
+      Push (i % 3 == 0);
+    }
+  Check ("after Grow by PushBack");
+
+  // drain it, putting back a segment from time to time as the RLC does
+  for (uint32_t i = 0; !m_reference.empty (); i++)
+    {
+      Pop ();
+      if (i % 5 == 0)
+        {
+          Push (true);
+          Pop ();
+        }
+    }
+  Check ("drained queue");
+
+  for (uint32_t i = 0; i < 10; i++)
+    {
+      Push (i % 2 == 0);
+    }
+  m_queue.Clear ();
+  m_reference.clear ();
+  Check ("after Clear");
+  Push (false);
+  Check ("after PushBack on a cleared queue");
+  Pop ();
+  Check ("end");
+}
+
+
+class NrRlcTxQueueTestSuite : public TestSuite
+{
+public:
+  NrRlcTxQueueTestSuite ();
+};
+
+NrRlcTxQueueTestSuite::NrRlcTxQueueTestSuite ()
+  : TestSuite ("nr-rlc-tx-queue", UNIT)
+{
+  AddTestCase (new NrRlcTxQueueTestCase, TestCase::QUICK);
+}
+
+static NrRlcTxQueueTestSuite g_nrRlcTxQueueTestSuite;
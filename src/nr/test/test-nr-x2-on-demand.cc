@@ -0,0 +1,306 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <ns3/test.h>
+#include <ns3/log.h>
+#include <ns3/simulator.h>
+#include <ns3/config.h>
+#include <ns3/boolean.h>
+#include <ns3/double.h>
+#include <ns3/uinteger.h>
+#include <ns3/node-container.h>
+#include <ns3/net-device-container.h>
+#include <ns3/internet-stack-helper.h>
+#include <ns3/mobility-helper.h>
+#include <ns3/position-allocator.h>
+#include <ns3/nr-helper.h>
+#include <ns3/point-to-point-ngc-helper.h>
+#include <ns3/nr-enb-net-device.h>
+#include <ns3/nr-ue-net-device.h>
+#include <ns3/nr-ue-rrc.h>
+
+NS_LOG_COMPONENT_DEFINE ("NrX2OnDemandTest");
+
+using namespace ns3;
+
+/**
+ * Create the eNBs and the UEs of a test on the x axis, with their NR
+ * devices and the NGC, and return the number of devices of each eNB
+ * before any X2 interface is added.
+ */
+static std::vector<uint32_t>
+InstallX2TestTopology (Ptr<NrHelper> nrHelper, Ptr<PointToPointNgcHelper> ngcHelper,
+                       const std::vector<double> &enbX, const std::vector<double> &ueX,
+                       NodeContainer &enbNodes, NetDeviceContainer &enbDevs,
+                       NodeContainer &ueNodes, NetDeviceContainer &ueDevs)
+{
+  nrHelper->SetNgcHelper (ngcHelper);
+  enbNodes.Create (enbX.size ());
+  ueNodes.Create (ueX.size ());
+
+  Ptr<ListPositionAllocator> positionAlloc = CreateObject<ListPositionAllocator> ();
+  for (uint32_t i = 0; i < enbX.size (); i++)
+    {
+      positionAlloc->Add (Vector (enbX[i], 0, 0));
+    }
+  for (uint32_t i = 0; i < ueX.size (); i++)
+    {
+      positionAlloc->Add (Vector (ueX[i], 0, 0));
+    }
+  MobilityHelper mobility;
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.SetPositionAllocator (positionAlloc);
+  mobility.Install (enbNodes);
+  mobility.Install (ueNodes);
+
+  enbDevs = nrHelper->InstallEnbDevice (enbNodes);
+  ueDevs = nrHelper->InstallUeDevice (ueNodes);
+  InternetStackHelper internet;
+  internet.Install (ueNodes);
+  ngcHelper->AssignUeIpv4Address (ueDevs);
+
+  std::vector<uint32_t> nDevices;
+  for (uint32_t i = 0; i < enbNodes.GetN (); i++)
+    {
+      nDevices.push_back (enbNodes.Get (i)->GetNDevices ());
+    }
+  return nDevices;
+}
+
+
+/**
+ * Check which eNBs AddX2Interface (NodeContainer) connects: each X2
+ * interface adds a point-to-point device to both of its eNBs.
+ */
+class NrX2NeighboursTestCase : public TestCase
+{
+public:
+  /**
+   * \param name the name of the test case
+   * \param distance the X2NeighbourDistance attribute
+   * \param maxNeighbours the X2MaxNeighbours attribute
+   * \param onDemand the X2OnDemand attribute
+   * \param expectedLinks the expected number of X2 interfaces of each eNB
+   */
+  NrX2NeighboursTestCase (std::string name, double distance, uint32_t maxNeighbours,
+                          bool onDemand, std::vector<uint32_t> expectedLinks);
+  virtual ~NrX2NeighboursTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  double m_distance;
+  uint32_t m_maxNeighbours;
+  bool m_onDemand;
+  std::vector<uint32_t> m_expectedLinks;
+};
+
+NrX2NeighboursTestCase::NrX2NeighboursTestCase (std::string name, double distance, uint32_t maxNeighbours,
+                                                bool onDemand, std::vector<uint32_t> expectedLinks)
+  : TestCase ("Check the X2 neighbours: " + name),
+    m_distance (distance),
+    m_maxNeighbours (maxNeighbours),
+    m_onDemand (onDemand),
+    m_expectedLinks (expectedLinks)
+{
+}
+
+NrX2NeighboursTestCase::~NrX2NeighboursTestCase ()
+{
+}
+
+void
+NrX2NeighboursTestCase::DoRun (void)
+{
+  Ptr<NrHelper> nrHelper = CreateObject<NrHelper> ();
+  nrHelper->SetAttribute ("X2NeighbourDistance", DoubleValue (m_distance));
+  nrHelper->SetAttribute ("X2MaxNeighbours", UintegerValue (m_maxNeighbours));
+  nrHelper->SetAttribute ("X2OnDemand", BooleanValue (m_onDemand));
+  Ptr<PointToPointNgcHelper> ngcHelper = CreateObject<PointToPointNgcHelper> ();
+
+  //    eNB 0      eNB 1      eNB 2                          eNB 3
+  //      x -------- x -------- x ------------------------------ x
+  //         100 m      100 m                800 m
+  std::vector<double> enbX;
+  enbX.push_back (0);
+  enbX.push_back (100);
+  enbX.push_back (200);
+  enbX.push_back (1000);
+  NodeContainer enbNodes;
+  NetDeviceContainer enbDevs;
+  NodeContainer ueNodes;
+  NetDeviceContainer ueDevs;
+  std::vector<uint32_t> nDevices = InstallX2TestTopology (nrHelper, ngcHelper, enbX, std::vector<double> (),
+                                                          enbNodes, enbDevs, ueNodes, ueDevs);
+
+  nrHelper->AddX2Interface (enbNodes);
+
+  for (uint32_t i = 0; i < enbNodes.GetN (); i++)
+    {
+      uint32_t nLinks = enbNodes.Get (i)->GetNDevices () - nDevices[i];
+      NS_TEST_ASSERT_MSG_EQ (nLinks, m_expectedLinks[i], "wrong number of X2 interfaces of eNB " << i);
+    }
+
+  Simulator::Destroy ();
+}
+
+
+/**
+ * Check that a handover between two eNBs without an X2 interface creates
+ * the interface when the handover request is sent, and completes.
+ */
+class NrX2OnDemandHandoverTestCase : public TestCase
+{
+public:
+  /**
+   * \param name the name of the test case
+   * \param onDemand the X2OnDemand attribute
+   * \param targetEnb the index of the target eNB of the handover
+   */
+  NrX2OnDemandHandoverTestCase (std::string name, bool onDemand, uint32_t targetEnb);
+  virtual ~NrX2OnDemandHandoverTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Check the X2 interfaces before the handover
+   */
+  void CheckBeforeHandover ();
+  /**
+   * Handover end OK trace of the UE RRC
+   * \param context the context
+   * \param imsi the IMSI
+   * \param cellId the cell ID
+   * \param rnti the RNTI
+   */
+  void UeHandoverEndOk (std::string context, uint64_t imsi, uint16_t cellId, uint16_t rnti);
+
+  bool m_onDemand;
+  uint32_t m_targetEnb;
+  NodeContainer m_enbNodes;
+  std::vector<uint32_t> m_nDevices;
+  bool m_handoverEndOk;
+};
+
+NrX2OnDemandHandoverTestCase::NrX2OnDemandHandoverTestCase (std::string name, bool onDemand, uint32_t targetEnb)
+  : TestCase ("Check the X2 interface created by a handover: " + name),
+    m_onDemand (onDemand),
+    m_targetEnb (targetEnb),
+    m_handoverEndOk (false)
+{
+}
+
+NrX2OnDemandHandoverTestCase::~NrX2OnDemandHandoverTestCase ()
+{
+}
+
+void
+NrX2OnDemandHandoverTestCase::CheckBeforeHandover ()
+{
+  // only the neighbours are connected, and only if they are not on demand
+  uint32_t nLinks = m_enbNodes.Get (0)->GetNDevices () - m_nDevices[0];
+  NS_TEST_ASSERT_MSG_EQ (nLinks, (m_onDemand ? 0U : 1U), "wrong number of X2 interfaces of the source eNB");
+  nLinks = m_enbNodes.Get (m_targetEnb)->GetNDevices () - m_nDevices[m_targetEnb];
+  NS_TEST_ASSERT_MSG_EQ (nLinks, ((!m_onDemand && m_targetEnb == 1) ? 1U : 0U),
+                         "wrong number of X2 interfaces of the target eNB");
+}
+
+void
+NrX2OnDemandHandoverTestCase::UeHandoverEndOk (std::string context, uint64_t imsi, uint16_t cellId, uint16_t rnti)
+{
+  NS_LOG_FUNCTION (this << context << imsi << cellId << rnti);
+  m_handoverEndOk = true;
+}
+
+void
+NrX2OnDemandHandoverTestCase::DoRun (void)
+{
+  Ptr<NrHelper> nrHelper = CreateObject<NrHelper> ();
+  nrHelper->SetAttribute ("UseIdealRrc", BooleanValue (true));
+  nrHelper->SetAttribute ("X2NeighbourDistance", DoubleValue (150));
+  nrHelper->SetAttribute ("X2OnDemand", BooleanValue (m_onDemand));
+  Ptr<PointToPointNgcHelper> ngcHelper = CreateObject<PointToPointNgcHelper> ();
+
+  //    eNB 2       UE       eNB 0      eNB 1
+  //      x -------- o -------- x -------- x
+  //         100 m      100 m      100 m
+  std::vector<double> enbX;
+  enbX.push_back (0);
+  enbX.push_back (100);
+  enbX.push_back (-200);
+  std::vector<double> ueX;
+  ueX.push_back (-100);
+  NetDeviceContainer enbDevs;
+  NodeContainer ueNodes;
+  NetDeviceContainer ueDevs;
+  m_nDevices = InstallX2TestTopology (nrHelper, ngcHelper, enbX, ueX,
+                                      m_enbNodes, enbDevs, ueNodes, ueDevs);
+
+  nrHelper->AddX2Interface (m_enbNodes);
+  nrHelper->Attach (ueDevs.Get (0), enbDevs.Get (0));
+  Config::Connect ("/NodeList/*/DeviceList/*/NrUeRrc/HandoverEndOk",
+                   MakeCallback (&NrX2OnDemandHandoverTestCase::UeHandoverEndOk, this));
+
+  Simulator::Schedule (Seconds (0.099), &NrX2OnDemandHandoverTestCase::CheckBeforeHandover, this);
+  nrHelper->HandoverRequest (Seconds (0.1), ueDevs.Get (0), enbDevs.Get (0), enbDevs.Get (m_targetEnb));
+  Simulator::Stop (Seconds (0.3));
+  Simulator::Run ();
+
+  // the interface between the source and the target eNBs was added
+  uint32_t nLinks = m_enbNodes.Get (0)->GetNDevices () - m_nDevices[0];
+  NS_TEST_ASSERT_MSG_EQ (nLinks, (m_onDemand ? 1U : 2U), "wrong number of X2 interfaces of the source eNB after the handover");
+  nLinks = m_enbNodes.Get (m_targetEnb)->GetNDevices () - m_nDevices[m_targetEnb];
+  NS_TEST_ASSERT_MSG_EQ (nLinks, 1U, "wrong number of X2 interfaces of the target eNB after the handover");
+  NS_TEST_ASSERT_MSG_EQ (m_handoverEndOk, true, "the handover did not complete");
+  uint16_t targetCellId = enbDevs.Get (m_targetEnb)->GetObject<NrEnbNetDevice> ()->GetCellId ();
+  NS_TEST_ASSERT_MSG_EQ (ueDevs.Get (0)->GetObject<NrUeNetDevice> ()->GetRrc ()->GetCellId (), targetCellId,
+                         "the UE is not served by the target eNB");
+
+  Simulator::Destroy ();
+}
+
+
+class NrX2OnDemandTestSuite : public TestSuite
+{
+public:
+  NrX2OnDemandTestSuite ();
+};
+
+NrX2OnDemandTestSuite::NrX2OnDemandTestSuite ()
+  : TestSuite ("nr-x2-on-demand", SYSTEM)
+{
+  std::vector<uint32_t> expectedLinks (4);
+
+  // full mesh
+  expectedLinks[0] = 3; expectedLinks[1] = 3; expectedLinks[2] = 3; expectedLinks[3] = 3;
+  AddTestCase (new NrX2NeighboursTestCase ("all eNBs", 0, 0, false, expectedLinks), TestCase::QUICK);
+  // 0-1 and 1-2
+  expectedLinks[0] = 1; expectedLinks[1] = 2; expectedLinks[2] = 1; expectedLinks[3] = 0;
+  AddTestCase (new NrX2NeighboursTestCase ("within 150 m", 150, 0, false, expectedLinks), TestCase::QUICK);
+  // eNB 1 selects eNB 0, eNB 3 selects eNB 2: 0-1, 1-2 and 2-3
+  expectedLinks[0] = 1; expectedLinks[1] = 2; expectedLinks[2] = 2; expectedLinks[3] = 1;
+  AddTestCase (new NrX2NeighboursTestCase ("nearest eNB", 0, 1, false, expectedLinks), TestCase::QUICK);
+  // no interface until the first X2 message
+  expectedLinks[0] = 0; expectedLinks[1] = 0; expectedLinks[2] = 0; expectedLinks[3] = 0;
+  AddTestCase (new NrX2NeighboursTestCase ("on demand", 150, 0, true, expectedLinks), TestCase::QUICK);
+
+  AddTestCase (new NrX2OnDemandHandoverTestCase ("to a neighbour on demand", true, 1), TestCase::QUICK);
+  AddTestCase (new NrX2OnDemandHandoverTestCase ("to a non-neighbour", false, 2), TestCase::QUICK);
+  AddTestCase (new NrX2OnDemandHandoverTestCase ("to a non-neighbour on demand", true, 2), TestCase::QUICK);
+}
+
+static NrX2OnDemandTestSuite g_nrX2OnDemandTestSuite;
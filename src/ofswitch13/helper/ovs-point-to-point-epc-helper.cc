@@ -165,6 +165,11 @@ OvsPointToPointEpcHelper::GetTypeId (void)
                    UintegerValue (3000),
                    MakeUintegerAccessor (&OvsPointToPointEpcHelper::m_x2LinkMtu),
                    MakeUintegerChecker<uint16_t> ())
+    .AddAttribute ("SwitchFlowCacheSize",
+                   "The flow cache size of the OpenFlow switches between the eNBs and the SGW/PGW (0 disables the cache).",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&OvsPointToPointEpcHelper::m_switchFlowCacheSize),
+                   MakeUintegerChecker<uint32_t> ())
   ;
   return tid;
 }
@@ -262,11 +267,13 @@ OvsPointToPointEpcHelper::AddEnb (Ptr<Node> enb, Ptr<NetDevice> lteEnbNetDevice,
     CreateObject<OFSwitch13InternalHelper> ();
   Ptr<QosController> qosCtrl = CreateObject<QosController> ();
   ofQosHelper->InstallController (controllerNodes.Get (0), qosCtrl);
+  ofQosHelper->SetDeviceAttribute ("FlowCacheSize", UintegerValue (m_switchFlowCacheSize));
 
   // Configure OpenFlow learning controller for client switch (#2) into controller node 1
   Ptr<OFSwitch13InternalHelper> ofLearningHelper = CreateObject<OFSwitch13InternalHelper> ();
   Ptr<OFSwitch13LearningController> learnCtrl = CreateObject<OFSwitch13LearningController> ();
   ofLearningHelper->InstallController (controllerNodes.Get (1), learnCtrl);
+  ofLearningHelper->SetDeviceAttribute ("FlowCacheSize", UintegerValue (m_switchFlowCacheSize));
 
   // Install OpenFlow switches 0 and 1 with border controller
   OFSwitch13DeviceContainer ofSwitchDevices;
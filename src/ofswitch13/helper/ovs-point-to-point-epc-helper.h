@@ -174,6 +174,12 @@ private:
    */
   uint16_t m_x2LinkMtu;
 
+  /**
+   * The flow cache size of the OpenFlow switches between the eNBs and
+   * the SGW/PGW (0 disables the cache).
+   */
+  uint32_t m_switchFlowCacheSize;
+
 };
 
 
@@ -56,6 +56,9 @@
 
 #ifdef NS3_OFSWITCH13
 #include "meter_entry.h"
+
+struct flow_table;
+struct flow_entry;
 #endif
 
 struct rconn;
@@ -135,6 +138,11 @@ struct datapath {
 
     // Callback to notify the simulator of a new meter entry created at meter table.
     void (*meter_created_cb) (struct meter_entry *entry);
+
+    // Callback to notify the simulator of a flow table lookup in pipeline
+    // (entry is NULL on a table miss).
+    void (*flow_lookup_cb) (struct packet *pkt, struct flow_table *table,
+                            struct flow_entry *entry);
 #endif
 };
 
@@ -155,6 +155,11 @@ pipeline_process_packet(struct pipeline *pl, struct packet *pkt) {
             free(m);
         }
         entry = flow_table_lookup(table, pkt);
+#ifdef NS3_OFSWITCH13
+        if (pl->dp->flow_lookup_cb != 0) {
+            pl->dp->flow_lookup_cb (pkt, table, entry);
+        }
+#endif
         if (entry != NULL) {
 	        if (VLOG_IS_DBG_ENABLED(LOG_MODULE)) {
                 char *m = ofl_structs_flow_stats_to_string(entry->stats, pkt->dp->exp);
@@ -48,6 +48,12 @@ OFSwitch13Device::GetTypeId (void)
                    UintegerValue (0),
                    MakeUintegerAccessor (&OFSwitch13Device::m_dpId),
                    MakeUintegerChecker<uint64_t> ())
+    .AddAttribute ("FlowCacheSize",
+                   "The maximum number of flows in the exact-match cache in "
+                   "front of the pipeline (0 disables the cache).",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&OFSwitch13Device::m_flowCacheSize),
+                   MakeUintegerChecker<uint32_t> ())
     .AddAttribute ("FlowTableSize",
                    "The maximum number of entries allowed on each flow table.",
                    UintegerValue (FLOW_TABLE_MAX_ENTRIES),
@@ -169,7 +175,10 @@ OFSwitch13Device::OFSwitch13Device ()
     m_cGroupMod (0),
     m_cMeterMod (0),
     m_cPacketIn (0),
-    m_cPacketOut (0)
+    m_cPacketOut (0),
+    m_flowCacheRec (false),
+    m_cFlowCacheHit (0),
+    m_cFlowCacheMiss (0)
 {
   NS_LOG_FUNCTION (this);
 
@@ -196,6 +205,18 @@ OFSwitch13Device::GetDatapathId (void) const
   return m_dpId;
 }
 
+uint64_t
+OFSwitch13Device::GetFlowCacheHits (void) const
+{
+  return m_cFlowCacheHit;
+}
+
+uint64_t
+OFSwitch13Device::GetFlowCacheMisses (void) const
+{
+  return m_cFlowCacheMiss;
+}
+
 uint32_t
 OFSwitch13Device::GetFlowEntries (void) const
 {
@@ -318,6 +339,9 @@ OFSwitch13Device::AddSwitchPort (Ptr<NetDevice> portDevice)
   m_ports.push_back (ofPort);
   NS_ASSERT (m_ports.size () == ofPort->GetPortNo ());
 
+  // Flood and all outputs include the new port.
+  FlowCacheInvalidate ();
+
   return ofPort;
 }
 
@@ -475,6 +499,15 @@ OFSwitch13Device::MeterCreatedCallback (struct meter_entry *entry)
   dev->NotifyMeterEntryCreated (entry);
 }
 
+void
+OFSwitch13Device::FlowLookupCallback (struct packet *pkt,
+                                      struct flow_table *table,
+                                      struct flow_entry *entry)
+{
+  Ptr<OFSwitch13Device> dev = OFSwitch13Device::GetDevice (pkt->dp->id);
+  dev->NotifyFlowLookup (table, entry);
+}
+
 void
 OFSwitch13Device::MeterDropCallback (struct packet *pkt,
                                      struct meter_entry *entry)
@@ -546,6 +579,7 @@ OFSwitch13Device::DoDispose ()
   m_ports.clear ();
   m_bufferPkts.clear ();
   m_controllers.clear ();
+  m_flowCache.clear ();
 
   pipeline_destroy (m_datapath->pipeline);
   group_table_destroy (m_datapath->groups);
@@ -624,6 +658,7 @@ OFSwitch13Device::DatapathNew ()
   dp->buff_retrieve_cb = &OFSwitch13Device::BufferRetrieveCallback;
   dp->meter_drop_cb = &OFSwitch13Device::MeterDropCallback;
   dp->meter_created_cb = &OFSwitch13Device::MeterCreatedCallback;
+  dp->flow_lookup_cb = &OFSwitch13Device::FlowLookupCallback;
 
   return dp;
 }
@@ -676,6 +711,11 @@ void
 OFSwitch13Device::DatapathTimeout (struct datapath *dp)
 {
   meter_table_add_tokens (dp->meters);
+  uint32_t oldFlowEntries = 0;
+  for (size_t i = 0; i < PIPELINE_TABLES; i++)
+    {
+      oldFlowEntries += GetFlowEntries (i);
+    }
   pipeline_timeout (dp->pipeline);
 
   // Check for changes in links (port) status.
@@ -697,6 +737,13 @@ OFSwitch13Device::DatapathTimeout (struct datapath *dp)
     }
   m_flowEntries = flowEntries;
 
+  // The cached flows keep pointers to the flow entries, so any entry removed
+  // on timeout invalidates the cache (entries are only added by flow mods).
+  if (flowEntries < oldFlowEntries)
+    {
+      FlowCacheInvalidate ();
+    }
+
   // The pipeline delay is estimated as k * log (n), where 'k' is the
   // m_tcamDelay set to the time for a single TCAM operation, and 'n' is the
   // current number of entries on all flow tables.
@@ -739,6 +786,9 @@ OFSwitch13Device::SendPacketInMessage (struct packet *pkt, uint8_t tableId,
 {
   NS_LOG_FUNCTION (this << pkt->ns3_uid << tableId << reason);
 
+  // The controller may handle each packet of the flow differently.
+  FlowCacheRecordAbort ();
+
   // Create the packet_in message.
   struct ofl_msg_packet_in msg;
   msg.header.type = OFPT_PACKET_IN;
@@ -781,6 +831,11 @@ OFSwitch13Device::SendToSwitchPort (struct packet *pkt, uint32_t portNo,
       return false;
     }
 
+  if (m_flowCacheRec)
+    {
+      FlowCacheRecordOutput (pkt, portNo, queueNo);
+    }
+
   // When a packet is sent to OpenFlow pipeline, we keep track of its original
   // ns3::Packet using the PipelinePacket structure. When the packet is
   // processed by the pipeline with no internal changes, we forward the
@@ -829,6 +884,22 @@ OFSwitch13Device::SendToPipeline (Ptr<Packet> packet, uint32_t portNo,
 
   NS_ASSERT_MSG (!m_pipePkt.IsValid (), "Another packet in pipeline.");
 
+  // Packets of a cached flow skip the pipeline.
+  FlowKey key;
+  bool cacheable = m_flowCacheSize
+    && ParseFlowKey (packet, portNo, tunnelId, key);
+  if (cacheable)
+    {
+      FlowCache_t::const_iterator it = m_flowCache.find (key);
+      if (it != m_flowCache.end ())
+        {
+          m_cFlowCacheHit++;
+          SendFromFlowCache (packet, it->second);
+          return;
+        }
+      m_cFlowCacheMiss++;
+    }
+
   // Creating the internal OpenFlow packet structure from ns-3 packet
   // Allocate buffer with some extra space for OpenFlow packet modifications.
   uint32_t headRoom = 128 + 2;
@@ -842,8 +913,231 @@ OFSwitch13Device::SendToPipeline (Ptr<Packet> packet, uint32_t portNo,
   pkt->ns3_uid = OFSwitch13Device::GetNewPacketId ();
   m_pipePkt.SetPacket (pkt->ns3_uid, packet);
 
+  // Record the pipeline result for the flow cache. The packet content is
+  // saved to find the changes done by set-field actions.
+  if (cacheable)
+    {
+      m_flowCacheRec = true;
+      m_flowCacheNew.lookups.clear ();
+      m_flowCacheNew.outputs.clear ();
+      m_flowCacheOrig.assign ((uint8_t*)buffer->data,
+                              (uint8_t*)buffer->data + buffer->size);
+    }
+
   // Send the packet to pipeline.
   pipeline_process_packet (m_datapath->pipeline, pkt);
+
+  if (m_flowCacheRec)
+    {
+      m_flowCacheRec = false;
+      if (m_flowCache.size () >= m_flowCacheSize)
+        {
+          NS_LOG_DEBUG ("Flow cache full. Flushing it.");
+          m_flowCache.clear ();
+        }
+      m_flowCache [key] = m_flowCacheNew;
+    }
+}
+
+bool
+OFSwitch13Device::ParseFlowKey (Ptr<const Packet> packet, uint32_t portNo,
+                                uint64_t tunnelId, FlowKey &key) const
+{
+  // Ethernet, IPv4 and the first 4 bytes of the L4 header.
+  uint8_t buf [38];
+  if (packet->CopyData (buf, sizeof (buf)) < sizeof (buf))
+    {
+      return false;
+    }
+
+  // Only untagged IPv4 frames.
+  if (buf [12] != 0x08 || buf [13] != 0x00)
+    {
+      return false;
+    }
+
+  // No IPv4 options, no fragments, and a TTL the pipeline accepts.
+  const uint8_t *ip = buf + 14;
+  if (ip [0] != 0x45 || (ip [6] & 0x3f) || ip [7] || ip [8] <= 1)
+    {
+      return false;
+    }
+
+  switch (ip [9])
+    {
+    case IPPROTO_TCP:
+    case IPPROTO_UDP:
+    case IPPROTO_SCTP:
+      {
+        key.l4Src = (ip [20] << 8) | ip [21];
+        key.l4Dst = (ip [22] << 8) | ip [23];
+        break;
+      }
+    case IPPROTO_ICMP:
+      {
+        key.l4Src = ip [20];
+        key.l4Dst = ip [21];
+        break;
+      }
+    default:
+      {
+        return false;
+      }
+    }
+
+  key.tunnelId = tunnelId;
+  key.inPort = portNo;
+  memcpy (&key.ipSrc, ip + 12, 4);
+  memcpy (&key.ipDst, ip + 16, 4);
+  memcpy (key.ethDst, buf, 6);
+  memcpy (key.ethSrc, buf + 6, 6);
+  key.ipTos = ip [1];
+  key.ipProto = ip [9];
+  return true;
+}
+
+void
+OFSwitch13Device::SendFromFlowCache (Ptr<Packet> packet,
+                                     const FlowCacheEntry &entry)
+{
+  NS_LOG_FUNCTION (this << packet);
+
+  // Same statistics as in ofsoftswitch13 flow_table_lookup ().
+  uint64_t now = time_msec ();
+  std::vector<std::pair<struct flow_table*, struct flow_entry*> >::
+    const_iterator lt;
+  for (lt = entry.lookups.begin (); lt != entry.lookups.end (); lt++)
+    {
+      struct flow_table *table = lt->first;
+      struct flow_entry *flow = lt->second;
+      table->stats->lookup_count++;
+      if (flow)
+        {
+          if (!flow->no_byt_count)
+            {
+              flow->stats->byte_count += packet->GetSize ();
+            }
+          if (!flow->no_pkt_count)
+            {
+              flow->stats->packet_count++;
+            }
+          flow->last_used = now;
+          table->stats->matched_count++;
+        }
+    }
+
+  std::vector<FlowCacheOutput>::const_iterator ot;
+  for (ot = entry.outputs.begin (); ot != entry.outputs.end (); ot++)
+    {
+      Ptr<Packet> outPacket = packet;
+      if (ot->rewrite)
+        {
+          Mac48Address dst, src;
+          dst.CopyFrom (ot->ethDst);
+          src.CopyFrom (ot->ethSrc);
+          outPacket = packet->Copy ();
+          EthernetHeader header;
+          outPacket->RemoveHeader (header);
+          header.SetDestination (dst);
+          header.SetSource (src);
+          outPacket->AddHeader (header);
+        }
+      GetOFSwitch13Port (ot->portNo)->Send (outPacket, ot->queueNo,
+                                            ot->tunnelId);
+    }
+}
+
+void
+OFSwitch13Device::FlowCacheRecordOutput (struct packet *pkt, uint32_t portNo,
+                                         uint32_t queueNo)
+{
+  NS_LOG_FUNCTION (this << pkt->ns3_uid << portNo << queueNo);
+
+  FlowCacheOutput output;
+  output.portNo = portNo;
+  output.queueNo = queueNo;
+  output.tunnelId = pkt->tunnel_id;
+  output.rewrite = false;
+  if (pkt->changes)
+    {
+      // Only changes to the Ethernet addresses (the first 12 bytes) are
+      // replayed. Other fields would require updating checksums.
+      const uint8_t *data = (const uint8_t*)pkt->buffer->data;
+      const uint8_t *orig = &m_flowCacheOrig [0];
+      if (pkt->buffer->size != m_flowCacheOrig.size ()
+          || memcmp (data + 12, orig + 12, pkt->buffer->size - 12))
+        {
+          FlowCacheRecordAbort ();
+          return;
+        }
+      if (memcmp (data, orig, 12))
+        {
+          output.rewrite = true;
+          memcpy (output.ethDst, data, 6);
+          memcpy (output.ethSrc, data + 6, 6);
+        }
+    }
+  m_flowCacheNew.outputs.push_back (output);
+}
+
+void
+OFSwitch13Device::FlowCacheRecordAbort (void)
+{
+  if (m_flowCacheRec)
+    {
+      NS_LOG_DEBUG ("Flow not cacheable.");
+      m_flowCacheRec = false;
+    }
+}
+
+void
+OFSwitch13Device::FlowCacheInvalidate (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  m_flowCache.clear ();
+}
+
+void
+OFSwitch13Device::NotifyFlowLookup (struct flow_table *table,
+                                    struct flow_entry *entry)
+{
+  if (!m_flowCacheRec)
+    {
+      return;
+    }
+  m_flowCacheNew.lookups.push_back (std::make_pair (table, entry));
+
+  // Meters and groups (select buckets, fast failover) keep state that
+  // changes the result for the next packets of the flow.
+  if (entry)
+    {
+      struct ofl_flow_stats *stats = entry->stats;
+      for (size_t i = 0; i < stats->instructions_num; i++)
+        {
+          struct ofl_instruction_header *inst = stats->instructions [i];
+          if (inst->type == OFPIT_METER || inst->type == OFPIT_EXPERIMENTER)
+            {
+              FlowCacheRecordAbort ();
+              return;
+            }
+          if (inst->type == OFPIT_APPLY_ACTIONS
+              || inst->type == OFPIT_WRITE_ACTIONS)
+            {
+              struct ofl_instruction_actions *ia =
+                (struct ofl_instruction_actions*)inst;
+              for (size_t j = 0; j < ia->actions_num; j++)
+                {
+                  if (ia->actions [j]->type == OFPAT_GROUP
+                      || ia->actions [j]->type == OFPAT_EXPERIMENTER)
+                    {
+                      FlowCacheRecordAbort ();
+                      return;
+                    }
+                }
+            }
+        }
+    }
 }
 
 int
@@ -941,16 +1235,25 @@ OFSwitch13Device::ReceiveFromController (Ptr<Packet> packet, Address from)
     case (OFPT_FLOW_MOD):
       {
         m_cFlowMod++;
+        FlowCacheInvalidate ();
         break;
       }
     case (OFPT_METER_MOD):
       {
         m_cMeterMod++;
+        FlowCacheInvalidate ();
         break;
       }
     case (OFPT_GROUP_MOD):
       {
         m_cGroupMod++;
+        FlowCacheInvalidate ();
+        break;
+      }
+    case (OFPT_PORT_MOD):
+    case (OFPT_TABLE_MOD):
+      {
+        FlowCacheInvalidate ();
         break;
       }
     default:
@@ -1384,4 +1687,69 @@ OFSwitch13Device::PipelinePacket::HasId (uint64_t id)
   return false;
 }
 
+OFSwitch13Device::FlowKey::FlowKey ()
+  : tunnelId (0),
+    inPort (0),
+    ipSrc (0),
+    ipDst (0),
+    l4Src (0),
+    l4Dst (0),
+    ipTos (0),
+    ipProto (0)
+{
+  memset (ethDst, 0, sizeof (ethDst));
+  memset (ethSrc, 0, sizeof (ethSrc));
+}
+
+bool
+OFSwitch13Device::FlowKey::operator== (const FlowKey &other) const
+{
+  return tunnelId == other.tunnelId
+    && inPort == other.inPort
+    && ipSrc == other.ipSrc
+    && ipDst == other.ipDst
+    && l4Src == other.l4Src
+    && l4Dst == other.l4Dst
+    && memcmp (ethDst, other.ethDst, sizeof (ethDst)) == 0
+    && memcmp (ethSrc, other.ethSrc, sizeof (ethSrc)) == 0
+    && ipTos == other.ipTos
+    && ipProto == other.ipProto;
+}
+
+/**
+ * Add bytes to a FNV-1a hash.
+ * \param hash The hash so far.
+ * \param data The bytes.
+ * \param size The number of bytes.
+ * \return The new hash.
+ */
+static uint64_t
+FnvHash (uint64_t hash, const void *data, size_t size)
+{
+  const uint8_t *bytes = (const uint8_t*)data;
+  for (size_t i = 0; i < size; i++)
+    {
+      hash = (hash ^ bytes [i]) * 1099511628211ULL;
+    }
+  return hash;
+}
+
+size_t
+OFSwitch13Device::FlowKeyHash::operator() (const FlowKey &key) const
+{
+  // Field by field, so that the padding of the struct is not hashed.
+  uint64_t hash = 14695981039346656037ULL;
+  hash = FnvHash (hash, &key.tunnelId, sizeof (key.tunnelId));
+  hash = FnvHash (hash, &key.inPort, sizeof (key.inPort));
+  hash = FnvHash (hash, &key.ipSrc, sizeof (key.ipSrc));
+  hash = FnvHash (hash, &key.ipDst, sizeof (key.ipDst));
+  hash = FnvHash (hash, &key.l4Src, sizeof (key.l4Src));
+  hash = FnvHash (hash, &key.l4Dst, sizeof (key.l4Dst));
+  hash = FnvHash (hash, key.ethDst, sizeof (key.ethDst));
+  hash = FnvHash (hash, key.ethSrc, sizeof (key.ethSrc));
+  hash = FnvHash (hash, &key.ipTos, sizeof (key.ipTos));
+  hash = FnvHash (hash, &key.ipProto, sizeof (key.ipProto));
+  return hash;
+}
+
 } // namespace ns3
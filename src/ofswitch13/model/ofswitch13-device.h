@@ -22,11 +22,13 @@
 #define OFSWITCH13_DEVICE_H
 
 #include <ns3/socket.h>
+#include <ns3/ethernet-header.h>
 #include <ns3/uinteger.h>
 #include <ns3/inet-socket-address.h>
 #include <ns3/string.h>
 #include <ns3/tcp-header.h>
 #include <ns3/traced-value.h>
+#include <unordered_map>
 #include "ofswitch13-interface.h"
 #include "ofswitch13-port.h"
 #include "ofswitch13-socket-handler.h"
@@ -133,6 +135,75 @@ private:
     std::vector<uint64_t> m_ids;    //!< Internal list of IDs for this packet.
   }; // Struct PipelinePacket
 
+  /**
+   * \ingroup ofswitch13
+   * Exact-match key for the flow cache. It holds every field the flow tables
+   * can match on for the packets accepted by ParseFlowKey (untagged Ethernet,
+   * IPv4 without options or fragments, and TCP, UDP, SCTP or ICMP). For ICMP,
+   * the L4 source and destination hold the ICMP type and code.
+   */
+  struct FlowKey
+  {
+public:
+    /** Default constructor, zeroing every field. */
+    FlowKey ();
+
+    /**
+     * Compare two keys.
+     * \param other The other key.
+     * \return true if all fields are equal.
+     */
+    bool operator== (const FlowKey &other) const;
+
+    uint64_t tunnelId;  //!< Metadata from the logical input port.
+    uint32_t inPort;    //!< Switch input port number.
+    uint32_t ipSrc;     //!< IPv4 source address.
+    uint32_t ipDst;     //!< IPv4 destination address.
+    uint16_t l4Src;     //!< L4 source port (or ICMP type).
+    uint16_t l4Dst;     //!< L4 destination port (or ICMP code).
+    uint8_t  ethDst[6]; //!< Ethernet destination address.
+    uint8_t  ethSrc[6]; //!< Ethernet source address.
+    uint8_t  ipTos;     //!< IPv4 DSCP and ECN.
+    uint8_t  ipProto;   //!< IPv4 protocol.
+  }; // Struct FlowKey
+
+  /** Hash function for the flow cache keys. */
+  struct FlowKeyHash
+  {
+    /**
+     * \param key The flow key.
+     * \return The FNV-1a hash of the key fields.
+     */
+    size_t operator() (const FlowKey &key) const;
+  };
+
+  /**
+   * \ingroup ofswitch13
+   * An output resolved by the pipeline for a cached flow.
+   */
+  struct FlowCacheOutput
+  {
+    uint32_t portNo;    //!< Output port number.
+    uint32_t queueNo;   //!< Output queue number.
+    uint64_t tunnelId;  //!< Metadata for the logical output port.
+    bool     rewrite;   //!< The set-field actions changed the MAC addresses.
+    uint8_t  ethDst[6]; //!< New Ethernet destination address.
+    uint8_t  ethSrc[6]; //!< New Ethernet source address.
+  };
+
+  /**
+   * \ingroup ofswitch13
+   * The pipeline result for a cached flow: the flow table lookups (to keep
+   * the flow and table statistics up to date on cache hits) and the
+   * resolved outputs. A flow with no outputs is dropped.
+   */
+  struct FlowCacheEntry
+  {
+    /** Flow tables looked up, with the matched entry (0 on table miss). */
+    std::vector<std::pair<struct flow_table*, struct flow_entry*> > lookups;
+    std::vector<FlowCacheOutput> outputs; //!< Resolved outputs.
+  };
+
 public:
   /**
    * Register this type.
@@ -158,6 +229,8 @@ public:
   //\{
   double   GetBufferUsage       (void) const;
   uint64_t GetDatapathId        (void) const;
+  uint64_t GetFlowCacheHits     (void) const;
+  uint64_t GetFlowCacheMisses   (void) const;
   uint32_t GetFlowEntries       (void) const;
   uint32_t GetFlowEntries       (size_t tableId) const;
   uint64_t GetFlowModCounter    (void) const;
@@ -262,6 +335,16 @@ public:
   static void
   MeterCreatedCallback (struct meter_entry *entry);
 
+  /**
+   * Callback fired when a flow table is looked up in pipeline.
+   * \param pkt The internal packet.
+   * \param table The flow table.
+   * \param entry The matched flow entry (0 on table miss).
+   */
+  static void
+  FlowLookupCallback (struct packet *pkt, struct flow_table *table,
+                      struct flow_entry *entry);
+
   /**
    * Callback fired when a packet is dropped by meter band.
    * \param pkt The original internal packet.
@@ -396,6 +479,49 @@ private:
   void SendToPipeline (Ptr<Packet> packet, uint32_t portNo,
                        uint64_t tunnelId = 0);
 
+  /**
+   * Parse the headers of a packet into a flow cache key.
+   * \param packet The packet.
+   * \param portNo The switch input port number.
+   * \param tunnelId The metadata associated with a logical port.
+   * \param key The key to fill.
+   * \return false if the packet can't use the flow cache.
+   */
+  bool ParseFlowKey (Ptr<const Packet> packet, uint32_t portNo,
+                     uint64_t tunnelId, FlowKey &key) const;
+
+  /**
+   * Forward a packet as the pipeline did for the first packet of its flow,
+   * and update the flow and table statistics as the pipeline would.
+   * \param packet The packet.
+   * \param entry The cached pipeline result.
+   */
+  void SendFromFlowCache (Ptr<Packet> packet, const FlowCacheEntry &entry);
+
+  /**
+   * Save an output of the packet whose pipeline result is being recorded for
+   * the flow cache. The flow is not cached when the packet content was
+   * changed other than by the Ethernet addresses.
+   * \param pkt The internal packet to send.
+   * \param portNo The port number.
+   * \param queueNo The queue number.
+   */
+  void FlowCacheRecordOutput (struct packet *pkt, uint32_t portNo,
+                              uint32_t queueNo);
+
+  /** Discard the pipeline result being recorded for the flow cache. */
+  void FlowCacheRecordAbort (void);
+
+  /** Remove all entries from the flow cache. */
+  void FlowCacheInvalidate (void);
+
+  /**
+   * Notify this device of a flow table lookup by the OpenFlow pipeline.
+   * \param table The flow table.
+   * \param entry The matched flow entry (0 on table miss).
+   */
+  void NotifyFlowLookup (struct flow_table *table, struct flow_entry *entry);
+
   /**
    * Send a packet to the controller node.
    * \see SendOpenflowBufferToRemote ().
@@ -560,6 +686,9 @@ private:
   /** Structure to save packets, indexed by its id. */
   typedef std::map<uint64_t, Ptr<Packet> > IdPacketMap_t;
 
+  /** Structure to save the pipeline results, indexed by flow. */
+  typedef std::unordered_map<FlowKey, FlowCacheEntry, FlowKeyHash> FlowCache_t;
+
   /** Trace source fired when a packet in buffer expires. */
   TracedCallback<Ptr<const Packet> > m_bufferExpireTrace;
 
@@ -621,6 +750,13 @@ private:
   uint64_t          m_cMeterMod;    //!< Pipeline meter mod counter.
   uint64_t          m_cPacketIn;    //!< Pipeline packet in counter.
   uint64_t          m_cPacketOut;   //!< Pipeline packet out counter.
+  FlowCache_t       m_flowCache;    //!< Pipeline results by flow.
+  uint32_t          m_flowCacheSize;//!< Flow cache maximum entries.
+  bool              m_flowCacheRec; //!< Recording a pipeline result.
+  FlowCacheEntry    m_flowCacheNew; //!< Pipeline result being recorded.
+  std::vector<uint8_t> m_flowCacheOrig; //!< Packet being recorded.
+  uint64_t          m_cFlowCacheHit;  //!< Flow cache hit counter.
+  uint64_t          m_cFlowCacheMiss; //!< Flow cache miss counter.
 
   static uint64_t   m_globalDpId;   //!< Global counter for datapath IDs.
   static uint64_t   m_globalPktId;  //!< Global counter for packets IDs.
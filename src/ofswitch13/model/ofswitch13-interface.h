@@ -52,6 +52,7 @@ extern "C"
 #include "udatapath/packet.h"
 #include "udatapath/pipeline.h"
 #include "udatapath/flow_table.h"
+#include "udatapath/flow_entry.h"
 #include "udatapath/group_table.h"
 #include "udatapath/meter_table.h"
 #include "udatapath/dp_ports.h"
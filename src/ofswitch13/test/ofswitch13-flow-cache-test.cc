@@ -0,0 +1,260 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <ns3/test.h>
+#include <ns3/log.h>
+#include <ns3/simulator.h>
+#include <ns3/global-value.h>
+#include <ns3/boolean.h>
+#include <ns3/uinteger.h>
+#include <ns3/data-rate.h>
+#include <ns3/node-container.h>
+#include <ns3/net-device-container.h>
+#include <ns3/csma-helper.h>
+#include <ns3/ipv4-header.h>
+#include <ns3/ipv4-l3-protocol.h>
+#include <ns3/udp-header.h>
+#include <ns3/udp-l4-protocol.h>
+#include <ns3/ofswitch13-device.h>
+#include <ns3/ofswitch13-controller.h>
+#include <ns3/ofswitch13-learning-controller.h>
+#include <ns3/ofswitch13-internal-helper.h>
+
+#include <sstream>
+
+NS_LOG_COMPONENT_DEFINE ("OFSwitch13FlowCacheTest");
+
+using namespace ns3;
+
+/**
+ * Send UDP flows through a switch with the flow cache enabled and check the
+ * hits and misses: a flow whose entry rewrites the Ethernet destination is
+ * cached and the rewrite is replayed on hits, the flows going through a meter
+ * or a group are never cached, and flow, group and meter mods flush the cache.
+ */
+class OFSwitch13FlowCacheTestCase : public TestCase
+{
+public:
+  OFSwitch13FlowCacheTestCase ();
+  virtual ~OFSwitch13FlowCacheTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Send a UDP packet from host 0 to an address unknown to the hosts.
+   *
+   * \param dstPort the UDP destination port, which selects the flow entry
+   */
+  void Send (uint16_t dstPort);
+
+  /**
+   * Send a command to the switch.
+   *
+   * \param cmd the dpctl command
+   */
+  void Dpctl (std::string cmd);
+
+  /**
+   * Check the flow cache counters of the switch.
+   *
+   * \param hits the expected number of hits
+   * \param misses the expected number of misses
+   * \param what the step being checked
+   */
+  void Check (uint64_t hits, uint64_t misses, std::string what);
+
+  /// Trace of the packets received by host 1, see Node::ProtocolHandler.
+  void Receive (Ptr<NetDevice> device, Ptr<const Packet> packet,
+                uint16_t protocol, const Address &from, const Address &to,
+                NetDevice::PacketType packetType);
+
+  NetDeviceContainer m_hostDevices;       ///< the host devices
+  Ptr<OFSwitch13Device> m_switch;         ///< the switch under test
+  Ptr<OFSwitch13Controller> m_controller; ///< the switch controller
+  uint32_t m_received;                    ///< packets received by host 1
+  uint32_t m_rewritten;                   ///< those addressed to host 1
+};
+
+OFSwitch13FlowCacheTestCase::OFSwitch13FlowCacheTestCase ()
+  : TestCase ("Check the flow cache of the OpenFlow switch"),
+    m_received (0),
+    m_rewritten (0)
+{
+}
+
+OFSwitch13FlowCacheTestCase::~OFSwitch13FlowCacheTestCase ()
+{
+}
+
+void
+OFSwitch13FlowCacheTestCase::Send (uint16_t dstPort)
+{
+  Ptr<Packet> packet = Create<Packet> (100);
+  UdpHeader udp;
+  udp.SetSourcePort (5000);
+  udp.SetDestinationPort (dstPort);
+  packet->AddHeader (udp);
+  Ipv4Header ip;
+  ip.SetSource (Ipv4Address ("10.1.1.1"));
+  ip.SetDestination (Ipv4Address ("10.1.1.2"));
+  ip.SetProtocol (UdpL4Protocol::PROT_NUMBER);
+  ip.SetPayloadSize (packet->GetSize ());
+  ip.SetTtl (64);
+  ip.EnableChecksum ();
+  packet->AddHeader (ip);
+  m_hostDevices.Get (0)->Send (packet, Mac48Address ("02:00:00:00:00:99"),
+                               Ipv4L3Protocol::PROT_NUMBER);
+}
+
+void
+OFSwitch13FlowCacheTestCase::Dpctl (std::string cmd)
+{
+  m_controller->DpctlExecute (m_switch->GetDatapathId (), cmd);
+}
+
+void
+OFSwitch13FlowCacheTestCase::Check (uint64_t hits, uint64_t misses,
+                                    std::string what)
+{
+  uint64_t cacheHits = m_switch->GetFlowCacheHits ();
+  uint64_t cacheMisses = m_switch->GetFlowCacheMisses ();
+  NS_TEST_EXPECT_MSG_EQ (cacheHits, hits, what << ": wrong number of hits");
+  NS_TEST_EXPECT_MSG_EQ (cacheMisses, misses, what << ": wrong number of misses");
+}
+
+void
+OFSwitch13FlowCacheTestCase::Receive (Ptr<NetDevice> device,
+                                      Ptr<const Packet> packet,
+                                      uint16_t protocol, const Address &from,
+                                      const Address &to,
+                                      NetDevice::PacketType packetType)
+{
+  m_received++;
+  if (to == device->GetAddress ())
+    {
+      m_rewritten++;
+    }
+}
+
+void
+OFSwitch13FlowCacheTestCase::DoRun (void)
+{
+  // The switch drops packets with wrong checksums.
+  GlobalValue::Bind ("ChecksumEnabled", BooleanValue (true));
+
+  NodeContainer hosts;
+  hosts.Create (2);
+  Ptr<Node> switchNode = CreateObject<Node> ();
+  Ptr<Node> controllerNode = CreateObject<Node> ();
+
+  CsmaHelper csmaHelper;
+  csmaHelper.SetChannelAttribute ("DataRate", DataRateValue (DataRate ("100Mbps")));
+  NetDeviceContainer switchPorts;
+  for (uint32_t i = 0; i < hosts.GetN (); i++)
+    {
+      NetDeviceContainer link = csmaHelper.Install (NodeContainer (hosts.Get (i), switchNode));
+      m_hostDevices.Add (link.Get (0));
+      switchPorts.Add (link.Get (1));
+    }
+  hosts.Get (1)->RegisterProtocolHandler (
+    MakeCallback (&OFSwitch13FlowCacheTestCase::Receive, this),
+    Ipv4L3Protocol::PROT_NUMBER, m_hostDevices.Get (1), true);
+
+  Ptr<OFSwitch13InternalHelper> of13Helper = CreateObject<OFSwitch13InternalHelper> ();
+  m_controller = of13Helper->InstallController (controllerNode, CreateObject<OFSwitch13Controller> ());
+  of13Helper->SetDeviceAttribute ("FlowCacheSize", UintegerValue (16));
+  m_switch = of13Helper->InstallSwitch (switchNode, switchPorts).Get (0);
+  of13Helper->CreateOpenFlowChannels ();
+
+  // All the flows go to host 1, addressed to it by the switch.
+  std::ostringstream toHost1;
+  toHost1 << "set_field=eth_dst:" << Mac48Address::ConvertFrom (m_hostDevices.Get (1)->GetAddress ())
+          << ",output=2";
+  uint64_t dpId = m_switch->GetDatapathId ();
+  m_controller->DpctlSchedule (dpId, "meter-mod cmd=add,flags=1,meter=1 drop:rate=10000");
+  m_controller->DpctlSchedule (dpId, "group-mod cmd=add,type=ind,group=1 "
+                               "weight=0,port=any,group=any " + toHost1.str ());
+  m_controller->DpctlSchedule (dpId, "flow-mod cmd=add,table=0,prio=10 "
+                               "eth_type=0x800,ip_proto=17,udp_dst=1000 apply:" + toHost1.str ());
+  m_controller->DpctlSchedule (dpId, "flow-mod cmd=add,table=0,prio=10 "
+                               "eth_type=0x800,ip_proto=17,udp_dst=2000 meter:1 apply:" + toHost1.str ());
+  m_controller->DpctlSchedule (dpId, "flow-mod cmd=add,table=0,prio=10 "
+                               "eth_type=0x800,ip_proto=17,udp_dst=3000 apply:group=1");
+
+  // The first packet of the flow is a miss, the next ones are hits.
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      Simulator::Schedule (Seconds (1.0 + 0.01 * i), &OFSwitch13FlowCacheTestCase::Send, this, 1000);
+    }
+  Simulator::Schedule (Seconds (1.1), &OFSwitch13FlowCacheTestCase::Check, this, 2, 1,
+                       "cached flow");
+
+  // A meter or a group in the entry keeps the flow out of the cache.
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      Simulator::Schedule (Seconds (1.1 + 0.01 * i), &OFSwitch13FlowCacheTestCase::Send, this, 2000);
+      Simulator::Schedule (Seconds (1.2 + 0.01 * i), &OFSwitch13FlowCacheTestCase::Send, this, 3000);
+    }
+  Simulator::Schedule (Seconds (1.3), &OFSwitch13FlowCacheTestCase::Check, this, 2, 7,
+                       "flows with a meter or a group");
+  Simulator::Schedule (Seconds (1.3), &OFSwitch13FlowCacheTestCase::Send, this, 1000);
+  Simulator::Schedule (Seconds (1.4), &OFSwitch13FlowCacheTestCase::Check, this, 3, 7,
+                       "cached flow after the flows with a meter or a group");
+
+  // Each mod flushes the cache.
+  Simulator::Schedule (Seconds (1.5), &OFSwitch13FlowCacheTestCase::Dpctl, this,
+                       "flow-mod cmd=add,table=0,prio=10 eth_type=0x800,ip_proto=17,udp_dst=4000");
+  Simulator::Schedule (Seconds (1.6), &OFSwitch13FlowCacheTestCase::Dpctl, this,
+                       "group-mod cmd=mod,type=ind,group=1 weight=0,port=any,group=any " + toHost1.str ());
+  Simulator::Schedule (Seconds (1.7), &OFSwitch13FlowCacheTestCase::Dpctl, this,
+                       "meter-mod cmd=mod,flags=1,meter=1 drop:rate=20000");
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      Simulator::Schedule (Seconds (1.55 + 0.1 * i), &OFSwitch13FlowCacheTestCase::Send, this, 1000);
+      Simulator::Schedule (Seconds (1.56 + 0.1 * i), &OFSwitch13FlowCacheTestCase::Send, this, 1000);
+    }
+  Simulator::Schedule (Seconds (1.59), &OFSwitch13FlowCacheTestCase::Check, this, 4, 8,
+                       "after a flow mod");
+  Simulator::Schedule (Seconds (1.69), &OFSwitch13FlowCacheTestCase::Check, this, 5, 9,
+                       "after a group mod");
+  Simulator::Schedule (Seconds (1.79), &OFSwitch13FlowCacheTestCase::Check, this, 6, 10,
+                       "after a meter mod");
+
+  Simulator::Stop (Seconds (2));
+  Simulator::Run ();
+
+  // The set-field is replayed on the hits.
+  NS_TEST_ASSERT_MSG_EQ (m_received, 16, "host 1 did not receive all the packets");
+  NS_TEST_ASSERT_MSG_EQ (m_rewritten, 16, "the switch did not rewrite the Ethernet destination of all the packets");
+
+  Simulator::Destroy ();
+}
+
+
+class OFSwitch13FlowCacheTestSuite : public TestSuite
+{
+public:
+  OFSwitch13FlowCacheTestSuite ();
+};
+
+OFSwitch13FlowCacheTestSuite::OFSwitch13FlowCacheTestSuite ()
+  : TestSuite ("ofswitch13-flow-cache", UNIT)
+{
+  AddTestCase (new OFSwitch13FlowCacheTestCase, TestCase::QUICK);
+}
+
+static OFSwitch13FlowCacheTestSuite g_ofswitch13FlowCacheTestSuite;
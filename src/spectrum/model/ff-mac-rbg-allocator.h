@@ -0,0 +1,304 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef FF_MAC_RBG_ALLOCATOR_H
+#define FF_MAC_RBG_ALLOCATOR_H
+
+#include <ns3/ptr.h>
+#include <stdint.h>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup spectrum
+ *
+ * \return the index of the first of the n values that is the largest and
+ * greater than threshold, or n if there is none
+ *
+ * \param values the values
+ * \param n the number of values
+ * \param threshold the value to exceed
+ */
+inline uint32_t
+FfMacArgMax (const double *values, uint32_t n, double threshold)
+{
+  uint32_t best = n;
+  double max = threshold;
+  for (uint32_t j = 0; j < n; j++)
+    {
+      if (values[j] > max)
+        {
+          max = values[j];
+          best = j;
+        }
+    }
+  return best;
+}
+
+/**
+ * \ingroup spectrum
+ *
+ * \brief Frequency domain RBG assignment of the FF MAC schedulers.
+ *
+ * The LTE and NR frequency domain schedulers give each free RBG to the UE
+ * with the largest positive metric on it. Per TTI, the scheduler adds the
+ * UEs that can be scheduled, in increasing RNTI order, then Assign fills the
+ * RBG x UE matrix of the metrics, row by row in a single array, and takes
+ * the argmax of each row. Ties go to the first UE, i.e., the lowest RNTI, as
+ * when the schedulers walked their per-RNTI maps.
+ *
+ * The Metric is a policy with
+ * \code
+ *   double operator() (uint32_t ue, uint16_t rnti, uint32_t rbg) const;
+ * \endcode
+ * giving the metric of a UE, by its index in the order of AddUe, on a RBG.
+ * The allocator keeps its arrays from one TTI to the next, so a scheduler
+ * holding it as a member does not allocate memory in steady state.
+ */
+template <class Metric>
+class FfMacRbgAllocator
+{
+public:
+  /**
+   * Remove the UEs, at the start of a TTI.
+   */
+  void Clear ()
+  {
+    for (uint32_t j = 0; j < m_rntis.size (); j++)
+      {
+        m_rbgs[j].clear ();
+      }
+    m_rntis.clear ();
+  }
+
+  /**
+   * \param rnti the RNTI of a UE that can be scheduled
+   * \return the index of the UE
+   */
+  uint32_t AddUe (uint16_t rnti)
+  {
+    uint32_t ue = m_rntis.size ();
+    m_rntis.push_back (rnti);
+    if (m_rbgs.size () < m_rntis.size ())
+      {
+        m_rbgs.resize (m_rntis.size ());
+      }
+    return ue;
+  }
+
+  /**
+   * \return the number of UEs
+   */
+  uint32_t GetNUes () const
+  {
+    return m_rntis.size ();
+  }
+
+  /**
+   * \param ue the index of a UE
+   * \return the RNTI of the UE
+   */
+  uint16_t GetRnti (uint32_t ue) const
+  {
+    return m_rntis[ue];
+  }
+
+  /**
+   * \param ue the index of a UE
+   * \return the RBGs assigned to the UE by Assign, in increasing order
+   */
+  const std::vector<uint16_t> & GetRbgs (uint32_t ue) const
+  {
+    return m_rbgs[ue];
+  }
+
+  /**
+   * Assign each free RBG to the UE with the largest positive metric.
+   *
+   * \param metric the metric of the UEs
+   * \param rbgMap the RBGs already used, updated with the assigned ones
+   * \return the number of RBGs assigned
+   */
+  uint32_t Assign (const Metric &metric, std::vector<bool> &rbgMap)
+  {
+    uint32_t nUes = m_rntis.size ();
+    uint32_t nRbgs = rbgMap.size ();
+    if (nUes == 0)
+      {
+        return 0;
+      }
+    m_metrics.resize (nRbgs * nUes);
+    for (uint32_t i = 0; i < nRbgs; i++)
+      {
+        if (rbgMap[i])
+          {
+            continue;
+          }
+        double *row = &m_metrics[i * nUes];
+        for (uint32_t j = 0; j < nUes; j++)
+          {
+            row[j] = metric (j, m_rntis[j], i);
+          }
+      }
+    uint32_t assigned = 0;
+    for (uint32_t i = 0; i < nRbgs; i++)
+      {
+        if (rbgMap[i])
+          {
+            continue;
+          }
+        uint32_t best = FfMacArgMax (&m_metrics[i * nUes], nUes, 0.0);
+        if (best < nUes)
+          {
+            rbgMap[i] = true;
+            m_rbgs[best].push_back (i);
+            assigned++;
+          }
+      }
+    return assigned;
+  }
+
+private:
+  std::vector<uint16_t> m_rntis;               ///< RNTI of each UE.
+  std::vector<std::vector<uint16_t> > m_rbgs;  ///< RBGs assigned to each UE.
+  std::vector<double> m_metrics;               ///< Metrics, RBG-major.
+};
+
+/**
+ * \ingroup spectrum
+ *
+ * \brief Achievable rate metric of the FF MAC schedulers.
+ *
+ * The metric of a UE on a RBG is the sum over its layers of the rate of a
+ * TB of one RBG at the MCS of the subband CQI, divided by a weight of the
+ * UE: its past throughput for the proportional fair schedulers, 1 for the
+ * maximum throughput ones. The rates are computed once per CQI when the RBG
+ * size changes, instead of once per UE and RBG.
+ *
+ * It is templated on the types of the module using it, so that LTE and NR
+ * share it: the SbMeasResult is the subband CQI report (with
+ * m_higherLayerSelected[rbg].m_sbCqi), the Amc gives GetMcsFromCqi and
+ * GetTbSizeFromMcs, and the FfrSapProvider gives IsDlRbgAvailableForUe.
+ */
+template <class SbMeasResult, class Amc, class FfrSapProvider>
+class FfMacRateMetric
+{
+public:
+  FfMacRateMetric ()
+    : m_rbgSize (0),
+      m_ffrSapProvider (0)
+  {
+  }
+
+  /**
+   * Prepare the metric for a TTI and remove the UEs.
+   *
+   * \param amc the AMC module of the scheduler
+   * \param rbgSize the size of a RBG, in RBs
+   * \param ffrSapProvider the FFR algorithm limiting the RBGs of each UE,
+   *        or 0 for none
+   */
+  void Clear (Ptr<Amc> amc, int rbgSize, FfrSapProvider *ffrSapProvider)
+  {
+    if (rbgSize != m_rbgSize)
+      {
+        m_rbgSize = rbgSize;
+        for (int cqi = 0; cqi < 16; cqi++)
+          {
+            m_rates[cqi] = ((amc->GetTbSizeFromMcs (amc->GetMcsFromCqi (cqi), rbgSize) / 8) / 0.001);   // = TB size / TTI
+          }
+        m_mcs0Rate = ((amc->GetTbSizeFromMcs (0, rbgSize) / 8) / 0.001);
+      }
+    m_ffrSapProvider = ffrSapProvider;
+    m_cqis.clear ();
+    m_nLayers.clear ();
+    m_weights.clear ();
+  }
+
+  /**
+   * Add a UE, in the order of FfMacRbgAllocator::AddUe.
+   *
+   * \param nLayers the number of layers of the UE
+   * \param cqi the last subband CQI report of the UE, or 0 if there is none,
+   *        which counts as CQI 1 on every subband
+   * \param weight the divisor of the rate
+   */
+  void AddUe (uint8_t nLayers, const SbMeasResult *cqi, double weight)
+  {
+    m_cqis.push_back (cqi);
+    m_nLayers.push_back (nLayers);
+    m_weights.push_back (weight);
+  }
+
+  /**
+   * \param ue the index of the UE
+   * \param rnti the RNTI of the UE
+   * \param rbg the RBG
+   * \return the metric of the UE on the RBG, 0 if it cannot use it
+   */
+  double operator() (uint32_t ue, uint16_t rnti, uint32_t rbg) const
+  {
+    if (m_ffrSapProvider != 0 && !m_ffrSapProvider->IsDlRbgAvailableForUe (rbg, rnti))
+      {
+        return 0.0;
+      }
+    uint8_t nLayers = m_nLayers[ue];
+    double achievableRate = 0.0;
+    if (m_cqis[ue] == 0)
+      {
+        for (uint8_t k = 0; k < nLayers; k++)
+          {
+            achievableRate += m_rates[1];  // lowest value
+          }
+      }
+    else
+      {
+        const std::vector<uint8_t> &sbCqi = m_cqis[ue]->m_higherLayerSelected.at (rbg).m_sbCqi;
+        // CQI == 0 means "out of range" (see table 7.2.3-1 of 36.213)
+        if (sbCqi.at (0) == 0 && sbCqi.size () > 1 && sbCqi[1] == 0)
+          {
+            return 0.0;
+          }
+        for (uint8_t k = 0; k < nLayers; k++)
+          {
+            if (sbCqi.size () > k)
+              {
+                achievableRate += m_rates[sbCqi[k]];
+              }
+            else
+              {
+                // no info on this subband -> worst MCS
+                achievableRate += m_mcs0Rate;
+              }
+          }
+      }
+    return achievableRate / m_weights[ue];
+  }
+
+private:
+  int m_rbgSize;                              ///< RBG size of the rates.
+  double m_rates[16];                         ///< Rate of one RBG and layer, by CQI.
+  double m_mcs0Rate;                          ///< Rate of one RBG and layer at MCS 0.
+  FfrSapProvider *m_ffrSapProvider;           ///< FFR algorithm, or 0.
+  std::vector<const SbMeasResult *> m_cqis;   ///< Subband CQI report of each UE, or 0.
+  std::vector<uint8_t> m_nLayers;             ///< Number of layers of each UE.
+  std::vector<double> m_weights;              ///< Weight of each UE.
+};
+
+} // namespace ns3
+
+#endif /* FF_MAC_RBG_ALLOCATOR_H */
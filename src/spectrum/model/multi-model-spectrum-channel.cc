@@ -26,6 +26,8 @@
 #include <ns3/net-device.h>
 #include <ns3/node.h>
 #include <ns3/double.h>
+#include <ns3/boolean.h>
+#include <ns3/uinteger.h>
 #include <ns3/mobility-model.h>
 #include <ns3/spectrum-phy.h>
 #include <ns3/spectrum-converter.h>
@@ -34,9 +36,11 @@
 #include <ns3/propagation-delay-model.h>
 #include <ns3/antenna-model.h>
 #include <ns3/angles.h>
-#include <ns3/mmwave-spectrum-signal-parameters.h> //180615-jskim14-for NR tx mode setting
 #include <iostream>
 #include <utility>
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include "multi-model-spectrum-channel.h"
 
 
@@ -71,11 +75,102 @@ std::ostream& operator<< (std::ostream& lhs, TxSpectrumModelInfoMap_t& rhs)
 }
 
 TxSpectrumModelInfo::TxSpectrumModelInfo (Ptr<const SpectrumModel> txSpectrumModel)
-  : m_txSpectrumModel (txSpectrumModel)
+  : m_txSpectrumModel (txSpectrumModel),
+    m_maxRange (std::numeric_limits<double>::infinity ())
 {
 }
 
 
+RxPhySpatialIndex::RxPhySpatialIndex ()
+  : m_cellSize (100.0)
+{
+}
+
+void
+RxPhySpatialIndex::SetCellSize (double cellSize)
+{
+  NS_ASSERT_MSG (cellSize > 0, "the cell size of the spatial index must be positive");
+  NS_ASSERT_MSG (m_cellOf.empty (), "the cell size must be set before receivers are indexed");
+  m_cellSize = cellSize;
+}
+
+RxPhySpatialIndex::Cell
+RxPhySpatialIndex::GetCell (const Vector &position) const
+{
+  return Cell (static_cast<int64_t> (std::floor (position.x / m_cellSize)),
+               static_cast<int64_t> (std::floor (position.y / m_cellSize)));
+}
+
+void
+RxPhySpatialIndex::Update (Ptr<SpectrumPhy> phy)
+{
+  Remove (phy);
+  Ptr<MobilityModel> mobility = phy->GetMobility ();
+  if (mobility == 0 || mobility->GetVelocity ().GetLength () > 0)
+    {
+      // its position changes without course change notifications
+      m_unbinned.insert (phy);
+      return;
+    }
+  Cell cell = GetCell (mobility->GetPosition ());
+  m_cells[cell].insert (phy);
+  m_cellOf[phy] = cell;
+}
+
+void
+RxPhySpatialIndex::Remove (Ptr<SpectrumPhy> phy)
+{
+  std::map<Ptr<SpectrumPhy>, Cell>::iterator it = m_cellOf.find (phy);
+  if (it != m_cellOf.end ())
+    {
+      std::map<Cell, std::set<Ptr<SpectrumPhy> > >::iterator cellIt = m_cells.find (it->second);
+      cellIt->second.erase (phy);
+      if (cellIt->second.empty ())
+        {
+          m_cells.erase (cellIt);
+        }
+      m_cellOf.erase (it);
+    }
+  m_unbinned.erase (phy);
+}
+
+void
+RxPhySpatialIndex::GetCandidates (const Vector &center, double radius, std::vector<Ptr<SpectrumPhy> > &candidates) const
+{
+  candidates.assign (m_unbinned.begin (), m_unbinned.end ());
+  Cell low = GetCell (Vector (center.x - radius, center.y - radius, 0));
+  Cell high = GetCell (Vector (center.x + radius, center.y + radius, 0));
+  double numCells = (static_cast<double> (high.first - low.first) + 1) * (static_cast<double> (high.second - low.second) + 1);
+  if (numCells > m_cells.size ())
+    {
+      // cheaper to scan the occupied cells than the square around the center
+      for (std::map<Cell, std::set<Ptr<SpectrumPhy> > >::const_iterator it = m_cells.begin (); it != m_cells.end (); ++it)
+        {
+          if (it->first.first >= low.first && it->first.first <= high.first
+              && it->first.second >= low.second && it->first.second <= high.second)
+            {
+              candidates.insert (candidates.end (), it->second.begin (), it->second.end ());
+            }
+        }
+    }
+  else
+    {
+      for (int64_t x = low.first; x <= high.first; ++x)
+        {
+          for (int64_t y = low.second; y <= high.second; ++y)
+            {
+              std::map<Cell, std::set<Ptr<SpectrumPhy> > >::const_iterator it = m_cells.find (Cell (x, y));
+              if (it != m_cells.end ())
+                {
+                  candidates.insert (candidates.end (), it->second.begin (), it->second.end ());
+                }
+            }
+        }
+    }
+  std::sort (candidates.begin (), candidates.end ());
+}
+
+
 RxSpectrumModelInfo::RxSpectrumModelInfo (Ptr<const SpectrumModel> rxSpectrumModel)
   : m_rxSpectrumModel (rxSpectrumModel)
 {
@@ -83,6 +178,10 @@ RxSpectrumModelInfo::RxSpectrumModelInfo (Ptr<const SpectrumModel> rxSpectrumMod
 
 
 MultiModelSpectrumChannel::MultiModelSpectrumChannel ()
+  : m_numDevices (0),
+    m_propagationThreads (1),
+    m_numPropagationThreads (0),
+    m_workerPool (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -96,6 +195,9 @@ MultiModelSpectrumChannel::DoDispose ()
   m_spectrumPropagationLoss = 0;
   m_txSpectrumModelInfoMap.clear ();
   m_rxSpectrumModelInfoMap.clear ();
+  m_rxPhyByMobility.clear ();
+  delete m_workerPool;
+  m_workerPool = 0;
   SpectrumChannel::DoDispose ();
 }
 
@@ -120,6 +222,41 @@ MultiModelSpectrumChannel::GetTypeId (void)
                    DoubleValue (1.0e9),
                    MakeDoubleAccessor (&MultiModelSpectrumChannel::m_maxLossDb),
                    MakeDoubleChecker<double> ())
+    .AddAttribute ("SpatialIndex",
+                   "If true, the receivers are kept in a grid over their positions, "
+                   "and a transmission only evaluates the receivers that may be "
+                   "closer than the distance at which the free space loss, minus "
+                   "MaxAntennaGainDb, exceeds MaxLossDb. This assumes that the "
+                   "PropagationLossModel never returns less loss than free space "
+                   "at the lowest frequency of the transmitted signal. The PathLoss "
+                   "trace is not fired for the receivers that are skipped. "
+                   "It must be set before the devices are added to the channel.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&MultiModelSpectrumChannel::m_spatialIndex),
+                   MakeBooleanChecker ())
+    .AddAttribute ("SpatialIndexCellSize",
+                   "Side of the cells of the spatial index, in meters, at least 1 mm.",
+                   DoubleValue (100.0),
+                   MakeDoubleAccessor (&MultiModelSpectrumChannel::m_spatialIndexCellSize),
+                   MakeDoubleChecker<double> (0.001))
+    .AddAttribute ("MaxAntennaGainDb",
+                   "Upper bound of the sum of the tx and rx antenna gains, in dB, "
+                   "used to compute the range of a transmission for the spatial index.",
+                   DoubleValue (0.0),
+                   MakeDoubleAccessor (&MultiModelSpectrumChannel::m_maxAntennaGainDb),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("PropagationThreads",
+                   "Number of threads computing the frequency-dependent loss of "
+                   "the receivers of a transmission, 0 to use every core. The "
+                   "SpectrumPropagationLossModel must support "
+                   "PrepareRxPowerSpectralDensity, otherwise the receivers are "
+                   "evaluated serially. Everything else, including the random "
+                   "variables and the order in which the receptions are "
+                   "scheduled, stays on the simulator thread, so the results "
+                   "do not depend on this value. It is read at the first transmission.",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&MultiModelSpectrumChannel::m_propagationThreads),
+                   MakeUintegerChecker<uint32_t> ())
     .AddTraceSource ("PathLoss",
                      "This trace is fired whenever a new path loss value "
                      "is calculated. The first and second parameters "
@@ -164,6 +301,7 @@ MultiModelSpectrumChannel::AddRx (Ptr<SpectrumPhy> phy)
       if (phyIt !=  rxInfoIterator->second.m_rxPhySet.end ())
         {
           rxInfoIterator->second.m_rxPhySet.erase (phyIt);
+          rxInfoIterator->second.m_spatialIndex.Remove (phy);
           --m_numDevices;
           break; // there should be at most one entry
         }       
@@ -179,6 +317,8 @@ MultiModelSpectrumChannel::AddRx (Ptr<SpectrumPhy> phy)
       std::pair<RxSpectrumModelInfoMap_t::iterator, bool> ret;
       ret = m_rxSpectrumModelInfoMap.insert (std::make_pair (rxSpectrumModelUid, RxSpectrumModelInfo (rxSpectrumModel)));
       NS_ASSERT (ret.second);
+      ret.first->second.m_spatialIndex.SetCellSize (m_spatialIndexCellSize);
+      rxInfoIterator = ret.first;
       // also add the phy to the newly created set of SpectrumPhy for this RxSpectrumModel
       std::pair<std::set<Ptr<SpectrumPhy> >::iterator, bool> ret2 = ret.first->second.m_rxPhySet.insert (phy);
       NS_ASSERT (ret2.second);
@@ -208,6 +348,21 @@ MultiModelSpectrumChannel::AddRx (Ptr<SpectrumPhy> phy)
       NS_ASSERT (ret2.second);
     }
 
+  if (m_spatialIndex)
+    {
+      rxInfoIterator->second.m_spatialIndex.Update (phy);
+      Ptr<MobilityModel> mobility = phy->GetMobility ();
+      if (mobility != 0)
+        {
+          std::set<Ptr<SpectrumPhy> > &phys = m_rxPhyByMobility[mobility];
+          if (phys.empty ())
+            {
+              mobility->TraceConnectWithoutContext ("CourseChange", MakeCallback (&MultiModelSpectrumChannel::RxCourseChange, this));
+            }
+          phys.insert (phy);
+        }
+    }
+
 }
 
 
@@ -226,6 +381,8 @@ MultiModelSpectrumChannel::FindAndEventuallyAddTxSpectrumModel (Ptr<const Spectr
       ret = m_txSpectrumModelInfoMap.insert (std::make_pair (txSpectrumModelUid, TxSpectrumModelInfo (txSpectrumModel)));
       NS_ASSERT (ret.second);
       txInfoIterator = ret.first;
+      txInfoIterator->second.m_maxRange = GetMaxRange (txSpectrumModel);
+      NS_LOG_LOGIC ("Max range of SpectrumModelUid " << txSpectrumModelUid << ": " << txInfoIterator->second.m_maxRange << " m");
 
       // and we create the converters for all the RX SpectrumModels that we know of
       for (RxSpectrumModelInfoMap_t::const_iterator rxInfoIterator = m_rxSpectrumModelInfoMap.begin ();
@@ -263,21 +420,6 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
   NS_ASSERT (txParams->txPhy);
   NS_ASSERT (txParams->psd);
 
-  //180615-jskim14-Check NR tx mode for data transmission
-  Ptr<MmwaveSpectrumSignalParametersDataFrame> txParamsMmData = DynamicCast<MmwaveSpectrumSignalParametersDataFrame> (txParams);
-  bool hybridBeam = false;
-  if(txParamsMmData != 0)
-  {
-    uint8_t nrTxMode = txParamsMmData->nrTxMode; 
-    if(nrTxMode==1)
-    {
-      hybridBeam = true;
-    }
-    //NS_LOG_UNCOND(this << " MultiModelSpectrumChannel: NR tx mode is " << (unsigned)nrTxMode);
-    //NS_LOG_UNCOND(this << " MultiModelSpectrumChannel: Hyrid beamforming " << hybridBeam);
-  }
-  //jskim14-end
-
   Ptr<MobilityModel> txMobility = txParams->txPhy->GetMobility ();
   SpectrumModelUid_t txSpectrumModelUid = txParams->psd->GetSpectrumModelUid ();
   NS_LOG_LOGIC (" txSpectrumModelUid " << txSpectrumModelUid);
@@ -290,6 +432,17 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
   NS_LOG_LOGIC ("converter map size: " << txInfoIteratorerator->second.m_spectrumConverterMap.size ());
   NS_LOG_LOGIC ("converter map first element: " << txInfoIteratorerator->second.m_spectrumConverterMap.begin ()->first);
 
+  if (m_numPropagationThreads == 0)
+    {
+      m_numPropagationThreads = m_propagationThreads;
+      if (m_numPropagationThreads == 0)
+        {
+          m_numPropagationThreads = SpectrumWorkerPool::GetNumCores ();
+        }
+    }
+  std::vector<PendingRx> pending;
+  std::vector<PendingRx> *pendingRx = (m_numPropagationThreads > 1 && m_spectrumPropagationLoss) ? &pending : 0;
+
   for (RxSpectrumModelInfoMap_t::const_iterator rxInfoIterator = m_rxSpectrumModelInfoMap.begin ();
        rxInfoIterator != m_rxSpectrumModelInfoMap.end ();
        ++rxInfoIterator)
@@ -316,6 +469,28 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
         }
 
 
+      double maxRange = txInfoIteratorerator->second.m_maxRange;
+      if (m_spatialIndex && txMobility && maxRange < std::numeric_limits<double>::infinity ())
+        {
+          // only the receivers that may be in range
+          Vector txPosition = txMobility->GetPosition ();
+          std::vector<Ptr<SpectrumPhy> > candidates;
+          rxInfoIterator->second.m_spatialIndex.GetCandidates (txPosition, maxRange, candidates);
+          NS_LOG_LOGIC ("spatial index: " << candidates.size () << " candidates out of " << rxInfoIterator->second.m_rxPhySet.size () << " receivers");
+          for (std::vector<Ptr<SpectrumPhy> >::const_iterator rxPhyIterator = candidates.begin ();
+               rxPhyIterator != candidates.end ();
+               ++rxPhyIterator)
+            {
+              Ptr<MobilityModel> receiverMobility = (*rxPhyIterator)->GetMobility ();
+              if ((*rxPhyIterator) != txParams->txPhy
+                  && (receiverMobility == 0 || CalculateDistance (txPosition, receiverMobility->GetPosition ()) <= maxRange))
+                {
+                  StartTxToRx (txParams, txMobility, convertedTxPowerSpectrum, *rxPhyIterator, pendingRx);
+                }
+            }
+          continue;
+        }
+
       for (std::set<Ptr<SpectrumPhy> >::const_iterator rxPhyIterator = rxInfoIterator->second.m_rxPhySet.begin ();
            rxPhyIterator != rxInfoIterator->second.m_rxPhySet.end ();
            ++rxPhyIterator)
@@ -325,87 +500,191 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
 
           if ((*rxPhyIterator) != txParams->txPhy)
             {
-              NS_LOG_LOGIC (" copying signal parameters " << txParams);
-              Ptr<SpectrumSignalParameters> rxParams = txParams->Copy ();
-              rxParams->psd = Copy<SpectrumValue> (convertedTxPowerSpectrum);
-              Time delay = MicroSeconds (0);
+              StartTxToRx (txParams, txMobility, convertedTxPowerSpectrum, *rxPhyIterator, pendingRx);
+            }
+        }
 
-              Ptr<MobilityModel> receiverMobility = (*rxPhyIterator)->GetMobility ();
+    }
 
-              if (txMobility && receiverMobility)
-                {
-                  double pathLossDb = 0;
-                  if (rxParams->txAntenna != 0)
-                    {
-                      Angles txAngles (receiverMobility->GetPosition (), txMobility->GetPosition ());
-                      double txAntennaGain = rxParams->txAntenna->GetGainDb (txAngles);
-                      NS_LOG_LOGIC ("txAntennaGain = " << txAntennaGain << " dB");
-                      pathLossDb -= txAntennaGain;
-                    }
-                  Ptr<AntennaModel> rxAntenna = (*rxPhyIterator)->GetRxAntenna ();
-                  if (rxAntenna != 0)
-                    {
-                      Angles rxAngles (txMobility->GetPosition (), receiverMobility->GetPosition ());
-                      double rxAntennaGain = rxAntenna->GetGainDb (rxAngles);
-                      NS_LOG_LOGIC ("rxAntennaGain = " << rxAntennaGain << " dB");
-                      pathLossDb -= rxAntennaGain;
-                    }
-                  if (m_propagationLoss)
-                    {
-                      double propagationGainDb = m_propagationLoss->CalcRxPower (0, txMobility, receiverMobility);
-                      NS_LOG_LOGIC ("propagationGainDb = " << propagationGainDb << " dB");
-                      pathLossDb -= propagationGainDb;
-                    }                    
-                  NS_LOG_LOGIC ("total pathLoss = " << pathLossDb << " dB");    
-                  m_pathLossTrace (txParams->txPhy, *rxPhyIterator, pathLossDb);
-                  if ( pathLossDb > m_maxLossDb)
-                    {
-                      // beyond range
-                      continue;
-                    }
-                  double pathGainLinear = std::pow (10.0, (-pathLossDb) / 10.0);
-                  *(rxParams->psd) *= pathGainLinear;              
-
-                  if (m_spectrumPropagationLoss)
-                    {
-                      //180617-jskim14-add NR tx mode
-                      if(hybridBeam)
-                      {
-                        //NS_LOG_UNCOND("Tx mode is hybrid beamforming");
-                        rxParams->psd = m_spectrumPropagationLoss->CalcRxPowerSpectralDensity (rxParams->psd, txMobility, receiverMobility);
-                      }
-                      else
-                      {
-                        rxParams->psd = m_spectrumPropagationLoss->CalcRxPowerSpectralDensity (rxParams->psd, txMobility, receiverMobility);
-                      }
-                      //jskim14-end
-                    }
-
-                  if (m_propagationDelay)
-                    {
-                      delay = m_propagationDelay->GetDelay (txMobility, receiverMobility);
-                    }
-                }
+  if (!pending.empty ())
+    {
+      StartPendingRx (pending);
+    }
+}
 
-              Ptr<NetDevice> netDev = (*rxPhyIterator)->GetDevice ();
-                if (netDev)
-                {
-                  // the receiver has a NetDevice, so we expect that it is attached to a Node
-                  uint32_t dstNode =  netDev->GetNode ()->GetId ();
-                  Simulator::ScheduleWithContext (dstNode, delay, &MultiModelSpectrumChannel::StartRx, this,
-                                                  rxParams, *rxPhyIterator);
-                }
-              else
-                {
-                  // the receiver is not attached to a NetDevice, so we cannot assume that it is attached to a node
-                  Simulator::Schedule (delay, &MultiModelSpectrumChannel::StartRx, this,
-                                       rxParams, *rxPhyIterator);
-                }
+void
+MultiModelSpectrumChannel::StartTxToRx (Ptr<SpectrumSignalParameters> txParams, Ptr<MobilityModel> txMobility,
+                                        Ptr<SpectrumValue> convertedTxPowerSpectrum, Ptr<SpectrumPhy> rxPhy,
+                                        std::vector<PendingRx> *pending)
+{
+  NS_LOG_LOGIC (" copying signal parameters " << txParams);
+  Ptr<SpectrumSignalParameters> rxParams = txParams->Copy ();
+  rxParams->psd = Copy<SpectrumValue> (convertedTxPowerSpectrum);
+  Time delay = MicroSeconds (0);
+  Ptr<SpectrumRxPsdTask> task;
+
+  Ptr<MobilityModel> receiverMobility = rxPhy->GetMobility ();
+
+  if (txMobility && receiverMobility)
+    {
+      double pathLossDb = 0;
+      if (rxParams->txAntenna != 0)
+        {
+          Angles txAngles (receiverMobility->GetPosition (), txMobility->GetPosition ());
+          double txAntennaGain = rxParams->txAntenna->GetGainDb (txAngles);
+          NS_LOG_LOGIC ("txAntennaGain = " << txAntennaGain << " dB");
+          pathLossDb -= txAntennaGain;
+        }
+      Ptr<AntennaModel> rxAntenna = rxPhy->GetRxAntenna ();
+      if (rxAntenna != 0)
+        {
+          Angles rxAngles (txMobility->GetPosition (), receiverMobility->GetPosition ());
+          double rxAntennaGain = rxAntenna->GetGainDb (rxAngles);
+          NS_LOG_LOGIC ("rxAntennaGain = " << rxAntennaGain << " dB");
+          pathLossDb -= rxAntennaGain;
+        }
+      if (m_propagationLoss)
+        {
+          double propagationGainDb = m_propagationLoss->CalcRxPower (0, txMobility, receiverMobility);
+          NS_LOG_LOGIC ("propagationGainDb = " << propagationGainDb << " dB");
+          pathLossDb -= propagationGainDb;
+        }
+      NS_LOG_LOGIC ("total pathLoss = " << pathLossDb << " dB");
+      m_pathLossTrace (txParams->txPhy, rxPhy, pathLossDb);
+      if ( pathLossDb > m_maxLossDb)
+        {
+          // beyond range
+          return;
+        }
+      double pathGainLinear = std::pow (10.0, (-pathLossDb) / 10.0);
+      *(rxParams->psd) *= pathGainLinear;
+
+      if (m_spectrumPropagationLoss)
+        {
+          if (pending)
+            {
+              task = m_spectrumPropagationLoss->PrepareRxPowerSpectralDensity (rxParams->psd, txMobility, receiverMobility);
             }
+          if (task == 0)
+            {
+              rxParams->psd = m_spectrumPropagationLoss->CalcRxPowerSpectralDensity (rxParams->psd, txMobility, receiverMobility);
+            }
+        }
+
+      if (m_propagationDelay)
+        {
+          delay = m_propagationDelay->GetDelay (txMobility, receiverMobility);
         }
+    }
 
+  if (pending)
+    {
+      // scheduled by StartPendingRx, so that the receptions keep their order
+      PendingRx rx;
+      rx.m_rxParams = rxParams;
+      rx.m_rxPhy = rxPhy;
+      rx.m_delay = delay;
+      rx.m_task = task;
+      pending->push_back (rx);
+      return;
     }
+  ScheduleRx (rxParams, rxPhy, delay);
+}
 
+void
+MultiModelSpectrumChannel::StartPendingRx (std::vector<PendingRx> &pending)
+{
+  NS_LOG_FUNCTION (this << pending.size ());
+  bool tasks = false;
+  for (std::vector<PendingRx>::const_iterator it = pending.begin (); it != pending.end () && !tasks; ++it)
+    {
+      tasks = (it->m_task != 0);
+    }
+  if (tasks)
+    {
+      if (m_workerPool == 0)
+        {
+          // created at the first task, a model without tasks never starts the threads
+          m_workerPool = new SpectrumWorkerPool (m_numPropagationThreads);
+        }
+      m_workerPool->Run (pending.size (), &MultiModelSpectrumChannel::ApplyPendingRx, &pending);
+    }
+  for (std::vector<PendingRx>::iterator it = pending.begin (); it != pending.end (); ++it)
+    {
+      if (it->m_task)
+        {
+          it->m_task->Finish (*it->m_rxParams->psd);
+        }
+      ScheduleRx (it->m_rxParams, it->m_rxPhy, it->m_delay);
+    }
+}
+
+void
+MultiModelSpectrumChannel::ApplyPendingRx (void *context, uint32_t index)
+{
+  // runs on a worker thread: no logging and no Ptr copies here
+  PendingRx &rx = (*static_cast<std::vector<PendingRx> *> (context))[index];
+  if (rx.m_task)
+    {
+      rx.m_task->Apply (*rx.m_rxParams->psd);
+    }
+}
+
+void
+MultiModelSpectrumChannel::ScheduleRx (Ptr<SpectrumSignalParameters> rxParams, Ptr<SpectrumPhy> rxPhy, Time delay)
+{
+  Ptr<NetDevice> netDev = rxPhy->GetDevice ();
+  if (netDev)
+    {
+      // the receiver has a NetDevice, so we expect that it is attached to a Node
+      uint32_t dstNode =  netDev->GetNode ()->GetId ();
+      Simulator::ScheduleWithContext (dstNode, delay, &MultiModelSpectrumChannel::StartRx, this,
+                                      rxParams, rxPhy);
+    }
+  else
+    {
+      // the receiver is not attached to a NetDevice, so we cannot assume that it is attached to a node
+      Simulator::Schedule (delay, &MultiModelSpectrumChannel::StartRx, this,
+                           rxParams, rxPhy);
+    }
+}
+
+double
+MultiModelSpectrumChannel::GetMaxRange (Ptr<const SpectrumModel> txSpectrumModel) const
+{
+  // free space loss at the lowest frequency of the model, which is the smallest one
+  double fMin = txSpectrumModel->Begin ()->fl;
+  double maxLossDb = m_maxLossDb + m_maxAntennaGainDb;
+  if (fMin <= 0 || maxLossDb > 600)
+    {
+      return std::numeric_limits<double>::infinity ();
+    }
+  static const double C = 299792458.0; // speed of light in vacuum
+  return C / (4 * M_PI * fMin) * std::pow (10.0, maxLossDb / 20.0);
+}
+
+void
+MultiModelSpectrumChannel::RxCourseChange (Ptr<const MobilityModel> mobility)
+{
+  NS_LOG_FUNCTION (this << mobility);
+  std::map<Ptr<const MobilityModel>, std::set<Ptr<SpectrumPhy> > >::iterator it = m_rxPhyByMobility.find (mobility);
+  if (it == m_rxPhyByMobility.end ())
+    {
+      return;
+    }
+  for (std::set<Ptr<SpectrumPhy> >::iterator phyIt = it->second.begin (); phyIt != it->second.end (); ++phyIt)
+    {
+      for (RxSpectrumModelInfoMap_t::iterator rxInfoIterator = m_rxSpectrumModelInfoMap.begin ();
+           rxInfoIterator != m_rxSpectrumModelInfoMap.end ();
+           ++rxInfoIterator)
+        {
+          if (rxInfoIterator->second.m_rxPhySet.find (*phyIt) != rxInfoIterator->second.m_rxPhySet.end ())
+            {
+              rxInfoIterator->second.m_spatialIndex.Update (*phyIt);
+              break;
+            }
+        }
+    }
 }
 
 void
@@ -27,8 +27,13 @@
 #include <ns3/spectrum-channel.h>
 #include <ns3/spectrum-propagation-loss-model.h>
 #include <ns3/propagation-delay-model.h>
+#include <ns3/mobility-model.h>
+#include <ns3/spectrum-worker-pool.h>
 #include <map>
 #include <set>
+#include <vector>
+
+class ParallelPropagationTestCase;
 
 namespace ns3 {
 
@@ -55,6 +60,7 @@ public:
 
   Ptr<const SpectrumModel> m_txSpectrumModel;     //!< Tx Spectrum model.
   SpectrumConverterMap_t m_spectrumConverterMap;  //!< Spectrum converter.
+  double m_maxRange;                              //!< Distance [m] beyond which the loss certainly exceeds MaxLossDb.
 };
 
 
@@ -65,6 +71,67 @@ public:
 typedef std::map<SpectrumModelUid_t, TxSpectrumModelInfo> TxSpectrumModelInfoMap_t;
 
 
+/**
+ * \ingroup spectrum
+ * Uniform grid over the positions of the receivers of one Rx spectrum model,
+ * used to find the receivers that may be within a given distance of a
+ * transmitter without visiting all of them.
+ *
+ * Only the receivers that are not moving are binned. A receiver whose mobility
+ * model reports a non-zero velocity, or that has no mobility model, is always
+ * returned as a candidate. The owner is expected to call Update whenever the
+ * mobility model of a receiver fires its CourseChange trace.
+ */
+class RxPhySpatialIndex
+{
+public:
+  RxPhySpatialIndex ();
+
+  /**
+   * \param cellSize the side of a grid cell [m]
+   */
+  void SetCellSize (double cellSize);
+
+  /**
+   * Add a receiver, or move it to the right cell if it is already indexed.
+   * \param phy the receiver
+   */
+  void Update (Ptr<SpectrumPhy> phy);
+
+  /**
+   * \param phy the receiver to remove
+   */
+  void Remove (Ptr<SpectrumPhy> phy);
+
+  /**
+   * Get the receivers that may be within radius of center. The candidates are
+   * sorted in the same order as a std::set<Ptr<SpectrumPhy> >, so that a
+   * caller scheduling one event per candidate keeps the same event order as
+   * when iterating over the whole set.
+   *
+   * \param center the transmitter position
+   * \param radius the search radius [m]
+   * \param candidates the output, a superset of the receivers within radius
+   */
+  void GetCandidates (const Vector &center, double radius, std::vector<Ptr<SpectrumPhy> > &candidates) const;
+
+private:
+  /// Grid cell coordinates (x, y); the z coordinate is not binned
+  typedef std::pair<int64_t, int64_t> Cell;
+
+  /**
+   * \param position a position
+   * \return the cell containing the position
+   */
+  Cell GetCell (const Vector &position) const;
+
+  double m_cellSize;                                       //!< side of a cell [m]
+  std::map<Cell, std::set<Ptr<SpectrumPhy> > > m_cells;    //!< static receivers per cell
+  std::map<Ptr<SpectrumPhy>, Cell> m_cellOf;               //!< cell of every binned receiver
+  std::set<Ptr<SpectrumPhy> > m_unbinned;                  //!< receivers that are always candidates
+};
+
+
 /**
  * \ingroup spectrum
  * The Rx spectrum model information. This class is used to convert
@@ -81,6 +148,7 @@ public:
 
   Ptr<const SpectrumModel> m_rxSpectrumModel;  //!< Rx Spectrum model.
   std::set<Ptr<SpectrumPhy> > m_rxPhySet;      //!< Container of the Rx Spectrum phy objects.
+  RxPhySpatialIndex m_spatialIndex;            //!< Positions of m_rxPhySet, used only if SpatialIndex is enabled.
 };
 
 /**
@@ -105,6 +173,8 @@ typedef std::map<SpectrumModelUid_t, RxSpectrumModelInfo> RxSpectrumModelInfoMap
  */
 class MultiModelSpectrumChannel : public SpectrumChannel
 {
+  /// allow ParallelPropagationTestCase to check when the worker pool is started
+  friend class ::ParallelPropagationTestCase;
 
 public:
   MultiModelSpectrumChannel ();
@@ -150,6 +220,75 @@ private:
    */
   TxSpectrumModelInfoMap_t::const_iterator FindAndEventuallyAddTxSpectrumModel (Ptr<const SpectrumModel> txSpectrumModel);
 
+  /**
+   * A reception computed by StartTx whose frequency-dependent loss may still
+   * have to be applied by the worker pool.
+   */
+  struct PendingRx
+  {
+    Ptr<SpectrumSignalParameters> m_rxParams;  //!< The received signal parameters.
+    Ptr<SpectrumPhy> m_rxPhy;                  //!< The receiver.
+    Time m_delay;                              //!< The propagation delay.
+    Ptr<SpectrumRxPsdTask> m_task;             //!< The remaining part of the PSD computation, if any.
+  };
+
+  /**
+   * Compute the signal seen by one receiver and schedule its reception.
+   *
+   * @param txParams The transmitted signal parameters.
+   * @param txMobility The mobility model of the transmitter.
+   * @param convertedTxPowerSpectrum The transmitted PSD, in the Rx spectrum model.
+   * @param rxPhy The receiver.
+   * @param pending If not null, the reception is appended to it instead of
+   * being scheduled, and the frequency-dependent loss is only prepared when
+   * the model supports it.
+   */
+  void StartTxToRx (Ptr<SpectrumSignalParameters> txParams, Ptr<MobilityModel> txMobility,
+                    Ptr<SpectrumValue> convertedTxPowerSpectrum, Ptr<SpectrumPhy> rxPhy,
+                    std::vector<PendingRx> *pending);
+
+  /**
+   * Apply the prepared frequency-dependent losses of the pending receptions
+   * with the worker pool, if any of them has a task, then schedule the
+   * receptions in order.
+   *
+   * @param pending The receptions computed by StartTxToRx.
+   */
+  void StartPendingRx (std::vector<PendingRx> &pending);
+
+  /**
+   * Schedule the reception of a signal.
+   *
+   * @param rxParams The received signal parameters.
+   * @param rxPhy The receiver.
+   * @param delay The propagation delay.
+   */
+  void ScheduleRx (Ptr<SpectrumSignalParameters> rxParams, Ptr<SpectrumPhy> rxPhy, Time delay);
+
+  /**
+   * Body of the worker pool loop of StartPendingRx.
+   *
+   * @param context The vector of pending receptions.
+   * @param index The reception to compute.
+   */
+  static void ApplyPendingRx (void *context, uint32_t index);
+
+  /**
+   * @param txSpectrumModel A Tx spectrum model.
+   *
+   * @return The distance beyond which the loss of a signal using this model
+   * certainly exceeds m_maxLossDb, or infinity if it cannot be bounded.
+   */
+  double GetMaxRange (Ptr<const SpectrumModel> txSpectrumModel) const;
+
+  /**
+   * Callback of the CourseChange trace of the receivers' mobility models,
+   * used to keep the spatial indexes up to date.
+   *
+   * @param mobility The mobility model that changed course.
+   */
+  void RxCourseChange (Ptr<const MobilityModel> mobility);
+
   /**
    * Used internally to reschedule transmission after the propagation delay.
    *
@@ -201,6 +340,46 @@ private:
    */
   double m_maxLossDb;
 
+  /**
+   * If true, only the receivers that may be within the range allowed by
+   * m_maxLossDb are evaluated.
+   */
+  bool m_spatialIndex;
+
+  /**
+   * Side [m] of the cells of the spatial index.
+   */
+  double m_spatialIndexCellSize;
+
+  /**
+   * Upper bound [dB] on the sum of the tx and rx antenna gains, used to
+   * compute the range of a transmission.
+   */
+  double m_maxAntennaGainDb;
+
+  /**
+   * Receivers attached to each mobility model whose CourseChange trace is connected.
+   */
+  std::map<Ptr<const MobilityModel>, std::set<Ptr<SpectrumPhy> > > m_rxPhyByMobility;
+
+  /**
+   * Number of threads evaluating the frequency-dependent loss of the
+   * receivers of a transmission, 1 for the serial evaluation.
+   */
+  uint32_t m_propagationThreads;
+
+  /**
+   * The number of threads resolved from m_propagationThreads at the first
+   * transmission, 0 before it.
+   */
+  uint32_t m_numPropagationThreads;
+
+  /**
+   * The threads used when m_numPropagationThreads > 1, created at the first
+   * transmission whose frequency-dependent loss is prepared as a task.
+   */
+  SpectrumWorkerPool *m_workerPool;
+
   /**
    * \deprecated The non-const \c Ptr<SpectrumPhy> argument
    * is deprecated and will be changed to \c Ptr<const SpectrumPhy>
@@ -28,6 +28,15 @@ NS_LOG_COMPONENT_DEFINE ("SpectrumPropagationLossModel");
 
 NS_OBJECT_ENSURE_REGISTERED (SpectrumPropagationLossModel);
 
+SpectrumRxPsdTask::~SpectrumRxPsdTask ()
+{
+}
+
+void
+SpectrumRxPsdTask::Finish (const SpectrumValue &psd)
+{
+}
+
 SpectrumPropagationLossModel::SpectrumPropagationLossModel ()
   : m_next (0)
 {
@@ -73,4 +82,24 @@ SpectrumPropagationLossModel::CalcRxPowerSpectralDensity (Ptr<const SpectrumValu
   return rxPsd;
 }
 
+Ptr<SpectrumRxPsdTask>
+SpectrumPropagationLossModel::PrepareRxPowerSpectralDensity (Ptr<const SpectrumValue> psd,
+                                                             Ptr<const MobilityModel> a,
+                                                             Ptr<const MobilityModel> b) const
+{
+  if (m_next != 0)
+    {
+      return 0;
+    }
+  return DoPrepareRxPowerSpectralDensity (psd, a, b);
+}
+
+Ptr<SpectrumRxPsdTask>
+SpectrumPropagationLossModel::DoPrepareRxPowerSpectralDensity (Ptr<const SpectrumValue> psd,
+                                                               Ptr<const MobilityModel> a,
+                                                               Ptr<const MobilityModel> b) const
+{
+  return 0;
+}
+
 } // namespace ns3
@@ -29,6 +29,39 @@
 namespace ns3 {
 
 
+/**
+ * \ingroup spectrum
+ *
+ * \brief The part of a SpectrumPropagationLossModel evaluation that can run
+ * outside of the simulator thread.
+ *
+ * A task is returned by SpectrumPropagationLossModel::PrepareRxPowerSpectralDensity.
+ * Apply may be called from a worker thread, concurrently with the Apply of
+ * other tasks: it must only modify the PSD it is given and the task itself,
+ * and it must not create, copy or release any Ptr, since the reference counts
+ * are not atomic. Finish is then called on the simulator thread, in the order
+ * in which the tasks were prepared.
+ */
+class SpectrumRxPsdTask : public SimpleRefCount<SpectrumRxPsdTask>
+{
+public:
+  virtual ~SpectrumRxPsdTask ();
+
+  /**
+   * Apply the frequency-dependent loss.
+   *
+   * \param psd the PSD prepared for the receiver, modified in place
+   */
+  virtual void Apply (SpectrumValue &psd) = 0;
+
+  /**
+   * Complete the evaluation on the simulator thread, e.g., for logging.
+   * The default implementation does nothing.
+   *
+   * \param psd the PSD after Apply
+   */
+  virtual void Finish (const SpectrumValue &psd);
+};
 
 
 /**
@@ -78,6 +111,27 @@ public:
                                                  Ptr<const MobilityModel> a,
                                                  Ptr<const MobilityModel> b) const;
 
+  /**
+   * Split form of CalcRxPowerSpectralDensity, used by the channels that
+   * evaluate the receivers of a transmission in parallel.
+   *
+   * This method is called on the simulator thread and does everything
+   * that draws random numbers, schedules events or updates the state of
+   * the model. The returned task then computes the received PSD in place,
+   * possibly on another thread (see SpectrumRxPsdTask).
+   *
+   * \param psd the PSD to be received, which the task will modify
+   * \param a sender mobility
+   * \param b receiver mobility
+   *
+   * \return the task completing the evaluation, or 0 if the model does not
+   * support the split, in which case CalcRxPowerSpectralDensity must be used.
+   * Chained models are not supported.
+   */
+  Ptr<SpectrumRxPsdTask> PrepareRxPowerSpectralDensity (Ptr<const SpectrumValue> psd,
+                                                        Ptr<const MobilityModel> a,
+                                                        Ptr<const MobilityModel> b) const;
+
 protected:
   virtual void DoDispose ();
 
@@ -97,6 +151,18 @@ private:
                                                            Ptr<const MobilityModel> a,
                                                            Ptr<const MobilityModel> b) const = 0;
 
+  /**
+   * \param psd the PSD to be received
+   * \param a sender mobility
+   * \param b receiver mobility
+   *
+   * \return the task completing the evaluation, or 0 (the default) if the
+   * model does not support PrepareRxPowerSpectralDensity
+   */
+  virtual Ptr<SpectrumRxPsdTask> DoPrepareRxPowerSpectralDensity (Ptr<const SpectrumValue> psd,
+                                                                  Ptr<const MobilityModel> a,
+                                                                  Ptr<const MobilityModel> b) const;
+
   Ptr<SpectrumPropagationLossModel> m_next; //!< SpectrumPropagationLossModel chained to this one.
 };
 
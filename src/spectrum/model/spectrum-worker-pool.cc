@@ -0,0 +1,203 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "spectrum-worker-pool.h"
+#include <ns3/log.h>
+#include <ns3/assert.h>
+#include <algorithm>
+#ifdef HAVE_PTHREAD_H
+#include <thread>
+#endif
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("SpectrumWorkerPool");
+
+SpectrumWorkerPool::SpectrumWorkerPool (uint32_t numThreads)
+  :
+#ifdef HAVE_PTHREAD_H
+    m_generation (0),
+    m_busy (0),
+    m_stop (false),
+#endif
+    m_function (0),
+    m_context (0),
+    m_numItems (0),
+    m_next (0)
+{
+  NS_LOG_FUNCTION (this << numThreads);
+  NS_ASSERT_MSG (numThreads > 0, "a worker pool needs at least one thread");
+#ifdef HAVE_PTHREAD_H
+  for (uint32_t i = 1; i < numThreads; ++i)
+    {
+      Worker *worker = new Worker;
+      worker->m_pool = this;
+      worker->m_thread = Create<SystemThread> (MakeCallback (&Worker::Run, worker));
+      worker->m_thread->Start ();
+      m_workers.push_back (worker);
+    }
+#else
+  if (numThreads > 1)
+    {
+      NS_LOG_WARN ("No thread support, the loops run in the calling thread");
+    }
+#endif
+}
+
+SpectrumWorkerPool::~SpectrumWorkerPool ()
+{
+  NS_LOG_FUNCTION (this);
+#ifdef HAVE_PTHREAD_H
+  m_mutex.Lock ();
+  m_stop = true;
+  m_mutex.Unlock ();
+  for (std::vector<Worker *>::iterator it = m_workers.begin (); it != m_workers.end (); ++it)
+    {
+      (*it)->m_start.SetCondition (true);
+      (*it)->m_start.Signal ();
+    }
+  for (std::vector<Worker *>::iterator it = m_workers.begin (); it != m_workers.end (); ++it)
+    {
+      (*it)->m_thread->Join ();
+      delete *it;
+    }
+#endif
+}
+
+uint32_t
+SpectrumWorkerPool::GetNumThreads () const
+{
+#ifdef HAVE_PTHREAD_H
+  return m_workers.size () + 1;
+#else
+  return 1;
+#endif
+}
+
+uint32_t
+SpectrumWorkerPool::GetNumCores ()
+{
+#ifdef HAVE_PTHREAD_H
+  return std::max (std::thread::hardware_concurrency (), 1u);
+#else
+  return 1;
+#endif
+}
+
+void
+SpectrumWorkerPool::Run (uint32_t numItems, Function function, void *context)
+{
+  if (numItems == 0)
+    {
+      return;
+    }
+  if (numItems == 1 || GetNumThreads () == 1)
+    {
+      // not worth waking up the workers
+      for (uint32_t i = 0; i < numItems; ++i)
+        {
+          function (context, i);
+        }
+      return;
+    }
+
+#ifdef HAVE_PTHREAD_H
+  m_mutex.Lock ();
+  m_function = function;
+  m_context = context;
+  m_numItems = numItems;
+  m_next = 0;
+  m_busy = m_workers.size ();
+  ++m_generation;
+  m_mutex.Unlock ();
+  // each worker has its own condition, so that no worker resets the wake up of another one
+  for (std::vector<Worker *>::iterator it = m_workers.begin (); it != m_workers.end (); ++it)
+    {
+      (*it)->m_start.SetCondition (true);
+      (*it)->m_start.Signal ();
+    }
+  RunItems ();
+
+  while (true)
+    {
+      // the condition is reset before the check, so a worker finishing
+      // after the check sets it again and the wait does not block
+      m_done.SetCondition (false);
+      m_mutex.Lock ();
+      bool busy = m_busy > 0;
+      m_mutex.Unlock ();
+      if (!busy)
+        {
+          return;
+        }
+      m_done.TimedWait (WAIT_NS);
+    }
+#endif
+}
+
+#ifdef HAVE_PTHREAD_H
+
+void
+SpectrumWorkerPool::Worker::Run ()
+{
+  m_pool->Work (this);
+}
+
+void
+SpectrumWorkerPool::Work (Worker *worker)
+{
+  uint64_t generation = 0;
+  while (true)
+    {
+      worker->m_start.SetCondition (false);
+      m_mutex.Lock ();
+      bool stop = m_stop;
+      bool started = m_generation != generation;
+      generation = m_generation;
+      m_mutex.Unlock ();
+      if (stop)
+        {
+          return;
+        }
+      if (!started)
+        {
+          worker->m_start.TimedWait (WAIT_NS);
+          continue;
+        }
+      RunItems ();
+      m_mutex.Lock ();
+      bool last = (--m_busy == 0);
+      m_mutex.Unlock ();
+      if (last)
+        {
+          m_done.SetCondition (true);
+          m_done.Signal ();
+        }
+    }
+}
+
+#endif /* HAVE_PTHREAD_H */
+
+void
+SpectrumWorkerPool::RunItems ()
+{
+  for (uint32_t i = m_next++; i < m_numItems; i = m_next++)
+    {
+      m_function (m_context, i);
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,124 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef SPECTRUM_WORKER_POOL_H
+#define SPECTRUM_WORKER_POOL_H
+
+#include <ns3/core-config.h>
+#include <stdint.h>
+#include <vector>
+#include <atomic>
+#ifdef HAVE_PTHREAD_H
+#include <ns3/system-thread.h>
+#include <ns3/system-mutex.h>
+#include <ns3/system-condition.h>
+#endif
+
+namespace ns3 {
+
+/**
+ * \ingroup spectrum
+ *
+ * \brief A fixed set of threads running the iterations of a loop.
+ *
+ * Run (n, function, context) calls function (context, i) for every i in
+ * [0, n) and returns once all the calls are done. The calling thread takes
+ * part in the loop, so a pool of N threads starts N-1 worker threads, which
+ * sleep between two loops. The order of the calls is not specified:
+ * the function must only touch the data of iteration i, and must not use
+ * the simulator, the logging or any Ptr shared between iterations.
+ * Without thread support, every loop runs in the calling thread.
+ */
+class SpectrumWorkerPool
+{
+public:
+  /**
+   * The body of a loop.
+   */
+  typedef void (*Function) (void *context, uint32_t index);
+
+  /**
+   * \param numThreads the number of threads running a loop, including the caller
+   */
+  SpectrumWorkerPool (uint32_t numThreads);
+  ~SpectrumWorkerPool ();
+
+  /**
+   * \return the number of threads running a loop, including the caller
+   */
+  uint32_t GetNumThreads () const;
+
+  /**
+   * \return the number of cores of the machine, or 1 without thread support
+   */
+  static uint32_t GetNumCores ();
+
+  /**
+   * Run a loop, it must be called by a single thread at a time.
+   *
+   * \param numItems the number of iterations
+   * \param function the body of the loop
+   * \param context the argument passed to function
+   */
+  void Run (uint32_t numItems, Function function, void *context);
+
+private:
+  /**
+   * Run iterations of the current loop until there are none left.
+   */
+  void RunItems ();
+
+#ifdef HAVE_PTHREAD_H
+  /**
+   * A worker thread and the condition waking it up.
+   */
+  struct Worker
+  {
+    /**
+     * Body of the thread.
+     */
+    void Run ();
+
+    SpectrumWorkerPool *m_pool;        //!< The pool.
+    SystemCondition m_start;           //!< Set when a loop starts or the pool stops.
+    Ptr<SystemThread> m_thread;        //!< The thread.
+  };
+
+  /**
+   * Body of the worker threads.
+   * \param worker the worker
+   */
+  void Work (Worker *worker);
+
+  /// Wall-clock time in ns after which a wait checks its condition again
+  static const uint64_t WAIT_NS = 10000000;
+
+  std::vector<Worker *> m_workers;     //!< The worker threads.
+  SystemMutex m_mutex;                 //!< Protects the fields below.
+  SystemCondition m_done;              //!< Set when the last worker is done.
+  uint64_t m_generation;               //!< Number of loops started.
+  uint32_t m_busy;                     //!< Number of workers still running the current loop.
+  bool m_stop;                         //!< True when the pool is being destroyed.
+#endif
+  Function m_function;                 //!< Body of the current loop.
+  void *m_context;                     //!< Argument of the current loop.
+  uint32_t m_numItems;                 //!< Number of iterations of the current loop.
+  std::atomic<uint32_t> m_next;        //!< Next iteration to run.
+};
+
+} // namespace ns3
+
+#endif /* SPECTRUM_WORKER_POOL_H */
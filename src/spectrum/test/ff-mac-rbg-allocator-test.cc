@@ -0,0 +1,253 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include <ns3/core-module.h>
+#include <ns3/test.h>
+#include <ns3/ff-mac-rbg-allocator.h>
+#include <map>
+
+
+NS_LOG_COMPONENT_DEFINE ("FfMacRbgAllocatorTest");
+
+using namespace ns3;
+
+
+/// AMC with made up MCS and TB size tables.
+class TestAmc : public SimpleRefCount<TestAmc>
+{
+public:
+  int GetMcsFromCqi (int cqi)
+  {
+    return (cqi * 28) / 15;
+  }
+  int GetTbSizeFromMcs (int mcs, int nprb)
+  {
+    return (mcs * 37 + 16) * nprb;
+  }
+};
+
+/// CQI of a subband, as in the FF MAC SAP.
+struct TestHigherLayerSelected
+{
+  std::vector<uint8_t> m_sbCqi;
+};
+
+/// Subband CQI report, as in the FF MAC SAP.
+struct TestSbMeasResult
+{
+  std::vector<TestHigherLayerSelected> m_higherLayerSelected;
+};
+
+/// FFR algorithm forbidding some RBGs to each UE.
+class TestFfrSapProvider
+{
+public:
+  bool IsDlRbgAvailableForUe (int rbg, uint16_t rnti)
+  {
+    return (rbg + rnti) % 5 != 0;
+  }
+};
+
+/// A UE that can be scheduled.
+struct TestUe
+{
+  uint8_t nLayers;
+  bool hasCqi;
+  TestSbMeasResult cqi;
+  double throughput;
+};
+
+
+/**
+ * Check FfMacRbgAllocator with FfMacRateMetric against the per-RBG loop of
+ * the FF MAC schedulers, on random CQI reports.
+ */
+class FfMacRbgAllocatorTestCase : public TestCase
+{
+public:
+  FfMacRbgAllocatorTestCase (bool ffr);
+  virtual ~FfMacRbgAllocatorTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * The assignment of the schedulers, one RBG at a time.
+   * \param ues the UEs, by RNTI
+   * \param rbgMap the used RBGs, updated
+   * \param rbgSize the RBG size
+   * \return the RBGs of each UE
+   */
+  std::map<uint16_t, std::vector<uint16_t> > Reference (const std::map<uint16_t, TestUe> &ues,
+                                                       std::vector<bool> &rbgMap, int rbgSize);
+
+  bool m_ffr;
+  Ptr<TestAmc> m_amc;
+  TestFfrSapProvider m_ffrSapProvider;
+};
+
+FfMacRbgAllocatorTestCase::FfMacRbgAllocatorTestCase (bool ffr)
+  : TestCase (ffr ? "Check the FF MAC RBG assignment with FFR" : "Check the FF MAC RBG assignment"),
+    m_ffr (ffr),
+    m_amc (Create<TestAmc> ())
+{
+}
+
+FfMacRbgAllocatorTestCase::~FfMacRbgAllocatorTestCase ()
+{
+}
+
+std::map<uint16_t, std::vector<uint16_t> >
+FfMacRbgAllocatorTestCase::Reference (const std::map<uint16_t, TestUe> &ues,
+                                      std::vector<bool> &rbgMap, int rbgSize)
+{
+  std::map<uint16_t, std::vector<uint16_t> > allocationMap;
+  for (uint16_t i = 0; i < rbgMap.size (); i++)
+    {
+      if (rbgMap[i])
+        {
+          continue;
+        }
+      std::map<uint16_t, TestUe>::const_iterator itMax = ues.end ();
+      double rcqiMax = 0.0;
+      for (std::map<uint16_t, TestUe>::const_iterator it = ues.begin (); it != ues.end (); it++)
+        {
+          if (m_ffr && !m_ffrSapProvider.IsDlRbgAvailableForUe (i, it->first))
+            {
+              continue;
+            }
+          std::vector<uint8_t> sbCqi;
+          if (!it->second.hasCqi)
+            {
+              sbCqi.assign (it->second.nLayers, 1);
+            }
+          else
+            {
+              sbCqi = it->second.cqi.m_higherLayerSelected.at (i).m_sbCqi;
+            }
+          uint8_t cqi1 = sbCqi.at (0);
+          uint8_t cqi2 = sbCqi.size () > 1 ? sbCqi.at (1) : 1;
+          if (cqi1 == 0 && cqi2 == 0)
+            {
+              continue;
+            }
+          double achievableRate = 0.0;
+          for (uint8_t k = 0; k < it->second.nLayers; k++)
+            {
+              int mcs = sbCqi.size () > k ? m_amc->GetMcsFromCqi (sbCqi.at (k)) : 0;
+              achievableRate += ((m_amc->GetTbSizeFromMcs (mcs, rbgSize) / 8) / 0.001);
+            }
+          double rcqi = achievableRate / it->second.throughput;
+          if (rcqi > rcqiMax)
+            {
+              rcqiMax = rcqi;
+              itMax = it;
+            }
+        }
+      if (itMax != ues.end ())
+        {
+          rbgMap[i] = true;
+          allocationMap[itMax->first].push_back (i);
+        }
+    }
+  return allocationMap;
+}
+
+void
+FfMacRbgAllocatorTestCase::DoRun (void)
+{
+  typedef FfMacRateMetric<TestSbMeasResult, TestAmc, TestFfrSapProvider> Metric;
+  FfMacRbgAllocator<Metric> allocator;
+  Metric metric;
+
+  Ptr<UniformRandomVariable> random = CreateObject<UniformRandomVariable> ();
+  random->SetStream (1);
+  const uint32_t nRbgs = 25;
+  // the allocator is reused from one TTI to the next, like in the schedulers
+  for (uint32_t tti = 0; tti < 200; tti++)
+    {
+      int rbgSize = 1 + tti % 4;
+      std::map<uint16_t, TestUe> ues;
+      uint32_t nUes = random->GetInteger (0, 12);
+      for (uint32_t u = 0; u < nUes; u++)
+        {
+          uint16_t rnti = random->GetInteger (1, 60);
+          TestUe &ue = ues[rnti];
+          ue.nLayers = random->GetInteger (1, 2);
+          ue.hasCqi = random->GetValue () < 0.8;
+          // ties between UEs of the same throughput and CQIs are frequent
+          ue.throughput = random->GetInteger (1, 3) * 1000.0;
+          ue.cqi.m_higherLayerSelected.resize (nRbgs);
+          for (uint32_t i = 0; i < nRbgs; i++)
+            {
+              uint32_t nCqis = random->GetInteger (1, 2);
+              for (uint32_t k = 0; k < nCqis; k++)
+                {
+                  ue.cqi.m_higherLayerSelected[i].m_sbCqi.push_back (random->GetInteger (0, 3) * 5);
+                }
+            }
+        }
+      std::vector<bool> rbgMap (nRbgs, false);
+      for (uint32_t i = 0; i < nRbgs; i++)
+        {
+          rbgMap[i] = random->GetValue () < 0.2;
+        }
+      std::vector<bool> referenceRbgMap = rbgMap;
+      std::map<uint16_t, std::vector<uint16_t> > reference = Reference (ues, referenceRbgMap, rbgSize);
+
+      allocator.Clear ();
+      metric.Clear (m_amc, rbgSize, m_ffr ? &m_ffrSapProvider : 0);
+      for (std::map<uint16_t, TestUe>::const_iterator it = ues.begin (); it != ues.end (); it++)
+        {
+          allocator.AddUe (it->first);
+          metric.AddUe (it->second.nLayers, it->second.hasCqi ? &it->second.cqi : 0, it->second.throughput);
+        }
+      allocator.Assign (metric, rbgMap);
+
+      NS_TEST_ASSERT_MSG_EQ ((rbgMap == referenceRbgMap), true, "different RBGs used in TTI " << tti);
+      uint32_t nAllocated = 0;
+      for (uint32_t j = 0; j < allocator.GetNUes (); j++)
+        {
+          const std::vector<uint16_t> &rbgs = allocator.GetRbgs (j);
+          if (rbgs.empty ())
+            {
+              continue;
+            }
+          nAllocated++;
+          std::map<uint16_t, std::vector<uint16_t> >::const_iterator it = reference.find (allocator.GetRnti (j));
+          NS_TEST_ASSERT_MSG_EQ ((it != reference.end () && it->second == rbgs), true,
+                                 "different RBGs for RNTI " << allocator.GetRnti (j) << " in TTI " << tti);
+        }
+      NS_TEST_ASSERT_MSG_EQ (nAllocated, reference.size (), "different UEs allocated in TTI " << tti);
+    }
+}
+
+
+class FfMacRbgAllocatorTestSuite : public TestSuite
+{
+public:
+  FfMacRbgAllocatorTestSuite ();
+};
+
+FfMacRbgAllocatorTestSuite::FfMacRbgAllocatorTestSuite ()
+  : TestSuite ("ff-mac-rbg-allocator", UNIT)
+{
+  NS_LOG_INFO ("creating FfMacRbgAllocatorTestSuite");
+
+  AddTestCase (new FfMacRbgAllocatorTestCase (false), TestCase::QUICK);
+  AddTestCase (new FfMacRbgAllocatorTestCase (true), TestCase::QUICK);
+}
+
+static FfMacRbgAllocatorTestSuite g_ffMacRbgAllocatorTestSuite;
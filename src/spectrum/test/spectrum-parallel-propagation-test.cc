@@ -0,0 +1,359 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include <ns3/core-module.h>
+#include <ns3/test.h>
+#include <ns3/spectrum-module.h>
+#include <ns3/mobility-module.h>
+#include <ns3/spectrum-worker-pool.h>
+
+
+NS_LOG_COMPONENT_DEFINE ("SpectrumParallelPropagationTest");
+
+using namespace ns3;
+
+
+/**
+ * Check that every iteration of a SpectrumWorkerPool loop runs exactly once.
+ */
+class SpectrumWorkerPoolTestCase : public TestCase
+{
+public:
+  SpectrumWorkerPoolTestCase ();
+  virtual ~SpectrumWorkerPoolTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Body of the loop, counts the runs of each iteration
+   * \param context the vector of counters
+   * \param index the iteration
+   */
+  static void Count (void *context, uint32_t index);
+};
+
+SpectrumWorkerPoolTestCase::SpectrumWorkerPoolTestCase ()
+  : TestCase ("Check the iterations run by the worker pool")
+{
+}
+
+SpectrumWorkerPoolTestCase::~SpectrumWorkerPoolTestCase ()
+{
+}
+
+void
+SpectrumWorkerPoolTestCase::Count (void *context, uint32_t index)
+{
+  (*static_cast<std::vector<uint32_t> *> (context))[index]++;
+}
+
+void
+SpectrumWorkerPoolTestCase::DoRun (void)
+{
+  SpectrumWorkerPool pool (4);
+  NS_TEST_ASSERT_MSG_EQ (pool.GetNumThreads (), 4, "wrong number of threads");
+
+  uint32_t sizes[] = {0, 1, 3, 1000};
+  for (uint32_t run = 0; run < 20; ++run)
+    {
+      uint32_t size = sizes[run % 4];
+      std::vector<uint32_t> counts (size, 0);
+      pool.Run (size, &SpectrumWorkerPoolTestCase::Count, &counts);
+      for (uint32_t i = 0; i < size; ++i)
+        {
+          NS_TEST_ASSERT_MSG_EQ (counts[i], 1, "iteration " << i << " of a loop of " << size << " did not run once");
+        }
+    }
+}
+
+
+/**
+ * A frequency-dependent loss that depends on the distance only, and
+ * supports PrepareRxPowerSpectralDensity.
+ */
+class SplitTestSpectrumPropagationLossModel : public SpectrumPropagationLossModel
+{
+public:
+  /**
+   * The task applying the loss of one receiver
+   */
+  class Task : public SpectrumRxPsdTask
+  {
+public:
+    /**
+     * \param distance the distance between the transmitter and the receiver
+     */
+    Task (double distance)
+      : m_distance (distance)
+    {
+    }
+    virtual void Apply (SpectrumValue &psd)
+    {
+      SplitTestSpectrumPropagationLossModel::ApplyLoss (psd, m_distance);
+    }
+private:
+    double m_distance; //!< distance between the transmitter and the receiver
+  };
+
+  /**
+   * Scale band i of the PSD by 1 / (1 + distance * (i + 1))
+   * \param psd the PSD
+   * \param distance the distance between the transmitter and the receiver
+   */
+  static void ApplyLoss (SpectrumValue &psd, double distance)
+  {
+    uint32_t i = 0;
+    for (Values::iterator it = psd.ValuesBegin (); it != psd.ValuesEnd (); ++it, ++i)
+      {
+        *it /= 1 + distance * (i + 1);
+      }
+  }
+
+private:
+  virtual Ptr<SpectrumValue> DoCalcRxPowerSpectralDensity (Ptr<const SpectrumValue> txPsd,
+                                                           Ptr<const MobilityModel> a,
+                                                           Ptr<const MobilityModel> b) const
+  {
+    Ptr<SpectrumValue> rxPsd = Copy<SpectrumValue> (txPsd);
+    ApplyLoss (*rxPsd, a->GetDistanceFrom (b));
+    return rxPsd;
+  }
+
+  virtual Ptr<SpectrumRxPsdTask> DoPrepareRxPowerSpectralDensity (Ptr<const SpectrumValue> psd,
+                                                                  Ptr<const MobilityModel> a,
+                                                                  Ptr<const MobilityModel> b) const
+  {
+    return Create<Task> (a->GetDistanceFrom (b));
+  }
+};
+
+
+/**
+ * The same loss, without PrepareRxPowerSpectralDensity.
+ */
+class SerialTestSpectrumPropagationLossModel : public SplitTestSpectrumPropagationLossModel
+{
+private:
+  virtual Ptr<SpectrumRxPsdTask> DoPrepareRxPowerSpectralDensity (Ptr<const SpectrumValue> psd,
+                                                                  Ptr<const MobilityModel> a,
+                                                                  Ptr<const MobilityModel> b) const
+  {
+    return 0;
+  }
+};
+
+
+/**
+ * A SpectrumPhy that records the signals it receives.
+ */
+class RecordingSpectrumPhy : public SpectrumPhy
+{
+public:
+  /**
+   * \param id the identifier of the receiver in the records
+   * \param model the spectrum model of the receiver
+   */
+  RecordingSpectrumPhy (uint32_t id, Ptr<const SpectrumModel> model)
+    : m_id (id),
+      m_model (model),
+      m_records (0)
+  {
+  }
+  /**
+   * \param records where the received signals are recorded
+   */
+  void SetRecords (std::vector<std::pair<uint32_t, SpectrumValue> > *records)
+  {
+    m_records = records;
+  }
+  virtual void SetDevice (Ptr<NetDevice> d)
+  {
+  }
+  virtual Ptr<NetDevice> GetDevice () const
+  {
+    return 0;
+  }
+  virtual void SetMobility (Ptr<MobilityModel> m)
+  {
+    m_mobility = m;
+  }
+  virtual Ptr<MobilityModel> GetMobility ()
+  {
+    return m_mobility;
+  }
+  virtual void SetChannel (Ptr<SpectrumChannel> c)
+  {
+  }
+  virtual Ptr<const SpectrumModel> GetRxSpectrumModel () const
+  {
+    return m_model;
+  }
+  virtual Ptr<AntennaModel> GetRxAntenna ()
+  {
+    return 0;
+  }
+  virtual void StartRx (Ptr<SpectrumSignalParameters> params)
+  {
+    m_records->push_back (std::make_pair (m_id, *params->psd));
+  }
+
+private:
+  uint32_t m_id;                                                   //!< identifier in the records
+  Ptr<const SpectrumModel> m_model;                                //!< spectrum model
+  Ptr<MobilityModel> m_mobility;                                   //!< mobility model
+  std::vector<std::pair<uint32_t, SpectrumValue> > *m_records;     //!< received signals
+};
+
+
+/**
+ * Check that the PropagationThreads attribute of MultiModelSpectrumChannel
+ * does not change the received signals nor the order of the receptions.
+ */
+class ParallelPropagationTestCase : public TestCase
+{
+public:
+  ParallelPropagationTestCase ();
+  virtual ~ParallelPropagationTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Send a few signals to a set of receivers. The channel visits its
+   * receivers in the order of their addresses, so both runs use the same ones.
+   * \param threads the value of the PropagationThreads attribute
+   * \param tasks whether the spectrum propagation loss model prepares tasks
+   * \param phys the receivers, the first ones are also the transmitters
+   * \param records where the received signals are recorded
+   * \return true if the channel started its worker pool
+   */
+  bool Propagate (uint32_t threads, bool tasks, std::vector<Ptr<RecordingSpectrumPhy> > &phys,
+                  std::vector<std::pair<uint32_t, SpectrumValue> > &records);
+};
+
+ParallelPropagationTestCase::ParallelPropagationTestCase ()
+  : TestCase ("Check that the parallel propagation gives the serial results")
+{
+}
+
+ParallelPropagationTestCase::~ParallelPropagationTestCase ()
+{
+}
+
+bool
+ParallelPropagationTestCase::Propagate (uint32_t threads, bool tasks, std::vector<Ptr<RecordingSpectrumPhy> > &phys,
+                                        std::vector<std::pair<uint32_t, SpectrumValue> > &records)
+{
+  Ptr<MultiModelSpectrumChannel> channel = CreateObject<MultiModelSpectrumChannel> ();
+  channel->SetAttribute ("PropagationThreads", UintegerValue (threads));
+  channel->AddPropagationLossModel (CreateObject<FriisPropagationLossModel> ());
+  if (tasks)
+    {
+      channel->AddSpectrumPropagationLossModel (CreateObject<SplitTestSpectrumPropagationLossModel> ());
+    }
+  else
+    {
+      channel->AddSpectrumPropagationLossModel (CreateObject<SerialTestSpectrumPropagationLossModel> ());
+    }
+  for (std::vector<Ptr<RecordingSpectrumPhy> >::iterator it = phys.begin (); it != phys.end (); ++it)
+    {
+      (*it)->SetRecords (&records);
+      channel->AddRx (*it);
+    }
+
+  Ptr<const SpectrumModel> model = phys[0]->GetRxSpectrumModel ();
+  for (uint32_t i = 0; i < 5; ++i)
+    {
+      Ptr<SpectrumSignalParameters> txParams = Create<SpectrumSignalParameters> ();
+      txParams->psd = Create<SpectrumValue> (model);
+      (*txParams->psd) = 1e-3 * (i + 1);
+      txParams->txPhy = phys[i * 7];
+      txParams->duration = MilliSeconds (1);
+      channel->StartTx (txParams);
+    }
+  Simulator::Run ();
+  // Simulator::Destroy disposes the channel, and its pool
+  bool pool = (channel->m_workerPool != 0);
+  Simulator::Destroy ();
+  channel->Dispose ();
+  return pool;
+}
+
+void
+ParallelPropagationTestCase::DoRun (void)
+{
+  std::vector<double> frequencies;
+  for (uint32_t i = 0; i < 16; ++i)
+    {
+      frequencies.push_back (2.4e9 + i * 1e6);
+    }
+  Ptr<SpectrumModel> model = Create<SpectrumModel> (frequencies);
+
+  Ptr<UniformRandomVariable> position = CreateObject<UniformRandomVariable> ();
+  position->SetAttribute ("Min", DoubleValue (-100));
+  position->SetAttribute ("Max", DoubleValue (100));
+  std::vector<Ptr<RecordingSpectrumPhy> > phys;
+  for (uint32_t i = 0; i < 50; ++i)
+    {
+      Ptr<RecordingSpectrumPhy> phy = Create<RecordingSpectrumPhy> (i, model);
+      Ptr<MobilityModel> mobility = CreateObject<ConstantPositionMobilityModel> ();
+      mobility->SetPosition (Vector (position->GetValue (), position->GetValue (), 1.5));
+      phy->SetMobility (mobility);
+      phys.push_back (phy);
+    }
+
+  std::vector<std::pair<uint32_t, SpectrumValue> > serial;
+  bool pool = Propagate (1, true, phys, serial);
+  NS_TEST_ASSERT_MSG_EQ (pool, false, "a serial channel started a worker pool");
+  NS_TEST_ASSERT_MSG_EQ (serial.size (), 5 * 49, "wrong number of receptions");
+
+  // with tasks, then with a model that does not prepare any, which never starts the pool
+  for (uint32_t run = 0; run < 2; ++run)
+    {
+      bool tasks = (run == 0);
+      std::vector<std::pair<uint32_t, SpectrumValue> > parallel;
+      pool = Propagate (4, tasks, phys, parallel);
+      NS_TEST_ASSERT_MSG_EQ (pool, tasks, "wrong worker pool with tasks " << tasks);
+      NS_TEST_ASSERT_MSG_EQ (parallel.size (), serial.size (), "wrong number of receptions");
+      for (uint32_t i = 0; i < serial.size (); ++i)
+        {
+          NS_TEST_ASSERT_MSG_EQ (parallel[i].first, serial[i].first, "reception " << i << " has a different receiver");
+          Values::const_iterator p = parallel[i].second.ConstValuesBegin ();
+          for (Values::const_iterator s = serial[i].second.ConstValuesBegin (); s != serial[i].second.ConstValuesEnd (); ++s, ++p)
+            {
+              NS_TEST_ASSERT_MSG_EQ (*p, *s, "reception " << i << " has a different PSD");
+            }
+        }
+    }
+}
+
+
+class SpectrumParallelPropagationTestSuite : public TestSuite
+{
+public:
+  SpectrumParallelPropagationTestSuite ();
+};
+
+SpectrumParallelPropagationTestSuite::SpectrumParallelPropagationTestSuite ()
+  : TestSuite ("spectrum-parallel-propagation", UNIT)
+{
+  NS_LOG_INFO ("creating SpectrumParallelPropagationTestSuite");
+
+  AddTestCase (new SpectrumWorkerPoolTestCase (), TestCase::QUICK);
+  AddTestCase (new ParallelPropagationTestCase (), TestCase::QUICK);
+}
+
+static SpectrumParallelPropagationTestSuite g_spectrumParallelPropagationTestSuite;
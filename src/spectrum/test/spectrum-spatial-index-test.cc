@@ -0,0 +1,340 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include <ns3/core-module.h>
+#include <ns3/test.h>
+#include <ns3/spectrum-module.h>
+#include <ns3/mobility-module.h>
+#include <algorithm>
+#include <map>
+
+
+NS_LOG_COMPONENT_DEFINE ("SpectrumSpatialIndexTest");
+
+using namespace ns3;
+
+
+/**
+ * Check that RxPhySpatialIndex returns every receiver within the search
+ * radius, sorted, and that it follows the receivers when they move.
+ */
+class SpatialIndexTestCase : public TestCase
+{
+public:
+  SpatialIndexTestCase (double cellSize, double radius);
+  virtual ~SpatialIndexTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Check the candidates of a query against a brute force search
+   * \param center the query center
+   */
+  void CheckQuery (Vector center);
+
+  double m_cellSize;
+  double m_radius;
+  RxPhySpatialIndex m_index;
+  std::vector<Ptr<SpectrumPhy> > m_phys;
+};
+
+SpatialIndexTestCase::SpatialIndexTestCase (double cellSize, double radius)
+  : TestCase ("Check the candidates of the receiver spatial index"),
+    m_cellSize (cellSize),
+    m_radius (radius)
+{
+}
+
+SpatialIndexTestCase::~SpatialIndexTestCase ()
+{
+}
+
+void
+SpatialIndexTestCase::CheckQuery (Vector center)
+{
+  std::vector<Ptr<SpectrumPhy> > candidates;
+  m_index.GetCandidates (center, m_radius, candidates);
+  NS_TEST_ASSERT_MSG_EQ (std::is_sorted (candidates.begin (), candidates.end ()), true, "candidates are not sorted");
+
+  for (std::vector<Ptr<SpectrumPhy> >::iterator it = m_phys.begin (); it != m_phys.end (); ++it)
+    {
+      Ptr<MobilityModel> mobility = (*it)->GetMobility ();
+      bool inRange = CalculateDistance (center, mobility->GetPosition ()) <= m_radius;
+      bool moving = mobility->GetVelocity ().GetLength () > 0;
+      bool found = std::binary_search (candidates.begin (), candidates.end (), *it);
+      if (inRange || moving)
+        {
+          NS_TEST_ASSERT_MSG_EQ (found, true, "receiver at " << mobility->GetPosition () << " is missing");
+        }
+    }
+}
+
+void
+SpatialIndexTestCase::DoRun (void)
+{
+  m_index.SetCellSize (m_cellSize);
+
+  Ptr<UniformRandomVariable> position = CreateObject<UniformRandomVariable> ();
+  position->SetAttribute ("Min", DoubleValue (-500));
+  position->SetAttribute ("Max", DoubleValue (500));
+  for (uint32_t i = 0; i < 200; ++i)
+    {
+      Ptr<HalfDuplexIdealPhy> phy = CreateObject<HalfDuplexIdealPhy> ();
+      Ptr<ConstantVelocityMobilityModel> mobility = CreateObject<ConstantVelocityMobilityModel> ();
+      mobility->SetPosition (Vector (position->GetValue (), position->GetValue (), 1.5));
+      if (i % 10 == 0)
+        {
+          mobility->SetVelocity (Vector (3, 0, 0));
+        }
+      phy->SetMobility (mobility);
+      m_phys.push_back (phy);
+      m_index.Update (phy);
+    }
+
+  CheckQuery (Vector (0, 0, 10));
+  CheckQuery (Vector (480, -480, 10));
+  CheckQuery (Vector (2000, 0, 10));
+
+  // move some receivers, as a CourseChange callback would do
+  for (uint32_t i = 1; i < m_phys.size (); i += 7)
+    {
+      Ptr<MobilityModel> mobility = m_phys[i]->GetMobility ();
+      mobility->SetPosition (Vector (position->GetValue () / 10, position->GetValue () / 10, 1.5));
+      m_index.Update (m_phys[i]);
+    }
+  CheckQuery (Vector (0, 0, 10));
+
+  // removed receivers are not returned any more
+  m_index.Remove (m_phys[1]);
+  std::vector<Ptr<SpectrumPhy> > candidates;
+  m_index.GetCandidates (m_phys[1]->GetMobility ()->GetPosition (), m_radius, candidates);
+  NS_TEST_ASSERT_MSG_EQ (std::binary_search (candidates.begin (), candidates.end (), m_phys[1]), false,
+                         "a removed receiver is still a candidate");
+
+  m_phys.clear ();
+}
+
+
+/**
+ * Received signals, indexed by the identifiers of the transmitter and of the receiver
+ */
+typedef std::map<std::pair<uint32_t, uint32_t>, SpectrumValue> SpatialIndexRecords;
+
+/**
+ * A SpectrumPhy that records the signals it receives.
+ */
+class SpatialIndexRecordingPhy : public SpectrumPhy
+{
+public:
+  /**
+   * \param id the identifier of the receiver in the records
+   * \param model the spectrum model of the receiver
+   * \param records where the received signals are recorded
+   */
+  SpatialIndexRecordingPhy (uint32_t id, Ptr<const SpectrumModel> model, SpatialIndexRecords *records)
+    : m_id (id),
+      m_model (model),
+      m_records (records)
+  {
+  }
+  virtual void SetDevice (Ptr<NetDevice> d)
+  {
+  }
+  virtual Ptr<NetDevice> GetDevice () const
+  {
+    return 0;
+  }
+  virtual void SetMobility (Ptr<MobilityModel> m)
+  {
+    m_mobility = m;
+  }
+  virtual Ptr<MobilityModel> GetMobility ()
+  {
+    return m_mobility;
+  }
+  virtual void SetChannel (Ptr<SpectrumChannel> c)
+  {
+  }
+  virtual Ptr<const SpectrumModel> GetRxSpectrumModel () const
+  {
+    return m_model;
+  }
+  virtual Ptr<AntennaModel> GetRxAntenna ()
+  {
+    return 0;
+  }
+  /**
+   * \returns the identifier of the receiver in the records
+   */
+  uint32_t GetId () const
+  {
+    return m_id;
+  }
+  virtual void StartRx (Ptr<SpectrumSignalParameters> params)
+  {
+    uint32_t txId = DynamicCast<SpatialIndexRecordingPhy> (params->txPhy)->GetId ();
+    m_records->insert (std::make_pair (std::make_pair (txId, m_id), *params->psd));
+  }
+
+private:
+  uint32_t m_id;                       //!< identifier in the records
+  Ptr<const SpectrumModel> m_model;    //!< spectrum model
+  Ptr<MobilityModel> m_mobility;       //!< mobility model
+  SpatialIndexRecords *m_records;      //!< received signals
+};
+
+
+/**
+ * Check that MultiModelSpectrumChannel::StartTx delivers the signals to the
+ * same receivers and with the same power, with and
+ * without the SpatialIndex attribute, when MaxLossDb drops the far receivers.
+ */
+class SpatialIndexStartTxTestCase : public TestCase
+{
+public:
+  SpatialIndexStartTxTestCase ();
+  virtual ~SpatialIndexStartTxTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Send a few signals, moving some receivers between them
+   * \param spatialIndex the value of the SpatialIndex attribute
+   * \param records where the received signals are recorded
+   */
+  void Propagate (bool spatialIndex, SpatialIndexRecords &records);
+};
+
+SpatialIndexStartTxTestCase::SpatialIndexStartTxTestCase ()
+  : TestCase ("Check that the spatial index does not change the receptions")
+{
+}
+
+SpatialIndexStartTxTestCase::~SpatialIndexStartTxTestCase ()
+{
+}
+
+void
+SpatialIndexStartTxTestCase::Propagate (bool spatialIndex, SpatialIndexRecords &records)
+{
+  std::vector<double> frequencies;
+  for (uint32_t i = 0; i < 8; ++i)
+    {
+      frequencies.push_back (2.4e9 + i * 1e6);
+    }
+  Ptr<SpectrumModel> model = Create<SpectrumModel> (frequencies);
+
+  Ptr<MultiModelSpectrumChannel> channel = CreateObject<MultiModelSpectrumChannel> ();
+  channel->SetAttribute ("SpatialIndex", BooleanValue (spatialIndex));
+  channel->SetAttribute ("SpatialIndexCellSize", DoubleValue (100));
+  // about 1 km of free space at 2.4 GHz, the range of the spatial index is tight
+  channel->SetAttribute ("MaxLossDb", DoubleValue (100));
+  Ptr<FriisPropagationLossModel> friis = CreateObject<FriisPropagationLossModel> ();
+  friis->SetFrequency (2.4e9);
+  channel->AddPropagationLossModel (friis);
+
+  // the same positions in both runs
+  Ptr<UniformRandomVariable> position = CreateObject<UniformRandomVariable> ();
+  position->SetStream (1);
+  position->SetAttribute ("Min", DoubleValue (-3000));
+  position->SetAttribute ("Max", DoubleValue (3000));
+  std::vector<Ptr<SpatialIndexRecordingPhy> > phys;
+  for (uint32_t i = 0; i < 200; ++i)
+    {
+      Ptr<SpatialIndexRecordingPhy> phy = Create<SpatialIndexRecordingPhy> (i, model, &records);
+      Ptr<ConstantVelocityMobilityModel> mobility = CreateObject<ConstantVelocityMobilityModel> ();
+      mobility->SetPosition (Vector (position->GetValue (), position->GetValue (), 1.5));
+      if (i % 20 == 0)
+        {
+          mobility->SetVelocity (Vector (20, 0, 0));
+        }
+      phy->SetMobility (mobility);
+      phys.push_back (phy);
+      channel->AddRx (phy);
+    }
+
+  for (uint32_t i = 0; i < 10; ++i)
+    {
+      Ptr<SpectrumSignalParameters> txParams = Create<SpectrumSignalParameters> ();
+      txParams->psd = Create<SpectrumValue> (model);
+      (*txParams->psd) = 1e-3 * (i + 1);
+      txParams->txPhy = phys[i * 13];
+      txParams->duration = MilliSeconds (1);
+      channel->StartTx (txParams);
+
+      // the index follows the receivers through their CourseChange trace
+      for (uint32_t j = i + 1; j < phys.size (); j += 11)
+        {
+          phys[j]->GetMobility ()->SetPosition (Vector (position->GetValue () / 3, position->GetValue () / 3, 1.5));
+        }
+    }
+  Simulator::Run ();
+  Simulator::Destroy ();
+  channel->Dispose ();
+}
+
+void
+SpatialIndexStartTxTestCase::DoRun (void)
+{
+  SpatialIndexRecords full;
+  Propagate (false, full);
+  SpatialIndexRecords indexed;
+  Propagate (true, indexed);
+
+  NS_TEST_ASSERT_MSG_GT (full.size (), 0, "no reception");
+  NS_TEST_ASSERT_MSG_LT (full.size (), 10 * 199, "MaxLossDb dropped no receiver, the test is meaningless");
+  NS_TEST_ASSERT_MSG_EQ (indexed.size (), full.size (), "wrong number of receptions");
+  for (SpatialIndexRecords::const_iterator it = full.begin (); it != full.end (); ++it)
+    {
+      SpatialIndexRecords::const_iterator found = indexed.find (it->first);
+      NS_TEST_ASSERT_MSG_EQ ((found != indexed.end ()), true, "receiver " << it->first.second << " missed the signal of "
+                             << it->first.first << " with the spatial index");
+      if (found != indexed.end ())
+        {
+          Values::const_iterator p = found->second.ConstValuesBegin ();
+          for (Values::const_iterator s = it->second.ConstValuesBegin (); s != it->second.ConstValuesEnd (); ++s, ++p)
+            {
+              NS_TEST_ASSERT_MSG_EQ (*p, *s, "receiver " << it->first.second << " got a different PSD from " << it->first.first);
+            }
+        }
+    }
+
+  Ptr<MultiModelSpectrumChannel> channel = CreateObject<MultiModelSpectrumChannel> ();
+  NS_TEST_ASSERT_MSG_EQ (channel->SetAttributeFailSafe ("SpatialIndexCellSize", DoubleValue (0)), false,
+                         "a null cell size was accepted");
+}
+
+
+class SpectrumSpatialIndexTestSuite : public TestSuite
+{
+public:
+  SpectrumSpatialIndexTestSuite ();
+};
+
+SpectrumSpatialIndexTestSuite::SpectrumSpatialIndexTestSuite ()
+  : TestSuite ("spectrum-spatial-index", UNIT)
+{
+  NS_LOG_INFO ("creating SpectrumSpatialIndexTestSuite");
+
+  // query square smaller than the occupied cells
+  AddTestCase (new SpatialIndexTestCase (50.0, 120.0), TestCase::QUICK);
+  // query square larger than the occupied cells
+  AddTestCase (new SpatialIndexTestCase (10.0, 800.0), TestCase::QUICK);
+  AddTestCase (new SpatialIndexStartTxTestCase (), TestCase::QUICK);
+}
+
+static SpectrumSpatialIndexTestSuite g_spectrumSpatialIndexTestSuite;
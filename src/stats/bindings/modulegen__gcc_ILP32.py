@@ -26,6 +26,8 @@ def register_types(module):
     module.add_class('Item', import_from_module='ns.core', outer_class=root_module['ns3::AttributeConstructionList'])
     ## callback.h (module 'core'): ns3::CallbackBase [class]
     module.add_class('CallbackBase', import_from_module='ns.core')
+    ## columnar-trace-reader.h (module 'stats'): ns3::ColumnarTraceReader [class]
+    module.add_class('ColumnarTraceReader')
     ## data-output-interface.h (module 'stats'): ns3::DataOutputCallback [class]
     module.add_class('DataOutputCallback', allow_subclassing=True)
     ## event-id.h (module 'core'): ns3::EventId [class]
@@ -313,6 +315,7 @@ def register_methods(root_module):
     register_Ns3AttributeConstructionList_methods(root_module, root_module['ns3::AttributeConstructionList'])
     register_Ns3AttributeConstructionListItem_methods(root_module, root_module['ns3::AttributeConstructionList::Item'])
     register_Ns3CallbackBase_methods(root_module, root_module['ns3::CallbackBase'])
+    register_Ns3ColumnarTraceReader_methods(root_module, root_module['ns3::ColumnarTraceReader'])
     register_Ns3DataOutputCallback_methods(root_module, root_module['ns3::DataOutputCallback'])
     register_Ns3EventId_methods(root_module, root_module['ns3::EventId'])
     register_Ns3FileHelper_methods(root_module, root_module['ns3::FileHelper'])
@@ -454,6 +457,65 @@ def register_Ns3CallbackBase_methods(root_module, cls):
                         visibility='protected')
     return
 
+def register_Ns3ColumnarTraceReader_methods(root_module, cls):
+    ## columnar-trace-reader.h (module 'stats'): ns3::ColumnarTraceReader::ColumnarTraceReader() [constructor]
+    cls.add_constructor([])
+    ## columnar-trace-reader.h (module 'stats'): bool ns3::ColumnarTraceReader::AddFilter(std::string name, double min, double max) [member function]
+    cls.add_method('AddFilter', 
+                   'bool', 
+                   [param('std::string', 'name'), param('double', 'min'), param('double', 'max')])
+    ## columnar-trace-reader.h (module 'stats'): void ns3::ColumnarTraceReader::ClearFilters() [member function]
+    cls.add_method('ClearFilters', 
+                   'void', 
+                   [])
+    ## columnar-trace-reader.h (module 'stats'): void ns3::ColumnarTraceReader::Close() [member function]
+    cls.add_method('Close', 
+                   'void', 
+                   [])
+    ## columnar-trace-reader.h (module 'stats'): int32_t ns3::ColumnarTraceReader::GetColumnIndex(std::string name) const [member function]
+    cls.add_method('GetColumnIndex', 
+                   'int32_t', 
+                   [param('std::string', 'name')], 
+                   is_const=True)
+    ## columnar-trace-reader.h (module 'stats'): std::string ns3::ColumnarTraceReader::GetColumnName(uint32_t column) const [member function]
+    cls.add_method('GetColumnName', 
+                   'std::string', 
+                   [param('uint32_t', 'column')], 
+                   is_const=True)
+    ## columnar-trace-reader.h (module 'stats'): uint32_t ns3::ColumnarTraceReader::GetNChunksRead() const [member function]
+    cls.add_method('GetNChunksRead', 
+                   'uint32_t', 
+                   [], 
+                   is_const=True)
+    ## columnar-trace-reader.h (module 'stats'): uint32_t ns3::ColumnarTraceReader::GetNChunksSkipped() const [member function]
+    cls.add_method('GetNChunksSkipped', 
+                   'uint32_t', 
+                   [], 
+                   is_const=True)
+    ## columnar-trace-reader.h (module 'stats'): uint32_t ns3::ColumnarTraceReader::GetNColumns() const [member function]
+    cls.add_method('GetNColumns', 
+                   'uint32_t', 
+                   [], 
+                   is_const=True)
+    ## columnar-trace-reader.h (module 'stats'): double ns3::ColumnarTraceReader::GetValue(uint32_t column) const [member function]
+    cls.add_method('GetValue', 
+                   'double', 
+                   [param('uint32_t', 'column')], 
+                   is_const=True)
+    ## columnar-trace-reader.h (module 'stats'): bool ns3::ColumnarTraceReader::Next() [member function]
+    cls.add_method('Next', 
+                   'bool', 
+                   [])
+    ## columnar-trace-reader.h (module 'stats'): bool ns3::ColumnarTraceReader::Open(std::string filename) [member function]
+    cls.add_method('Open', 
+                   'bool', 
+                   [param('std::string', 'filename')])
+    ## columnar-trace-reader.h (module 'stats'): void ns3::ColumnarTraceReader::Rewind() [member function]
+    cls.add_method('Rewind', 
+                   'void', 
+                   [])
+    return
+
 def register_Ns3DataOutputCallback_methods(root_module, cls):
     ## data-output-interface.h (module 'stats'): ns3::DataOutputCallback::DataOutputCallback() [constructor]
     cls.add_constructor([])
@@ -0,0 +1,512 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "async-trace-file.h"
+#include "ns3/core-config.h"
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "ns3/fatal-error.h"
+#include "ns3/abort.h"
+#include "ns3/simulator.h"
+
+#ifdef HAVE_PTHREAD_H
+#include "ns3/system-thread.h"
+#include "ns3/system-mutex.h"
+#include "ns3/system-condition.h"
+#include <deque>
+#endif
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("AsyncTraceFile");
+
+/**
+ * \ingroup stats
+ *
+ * The registry of the open trace files and the thread writing their blocks
+ */
+class AsyncTraceWriter
+{
+public:
+  AsyncTraceWriter ();
+  ~AsyncTraceWriter ();
+
+  /**
+   * \param filename the name of a file
+   * \return the file, or 0 if it is not registered
+   */
+  Ptr<AsyncTraceFile> Find (std::string filename) const;
+
+  /**
+   * Register a file, so that it is closed by CloseAll.
+   * \param file the file
+   */
+  void Register (Ptr<AsyncTraceFile> file);
+
+  /**
+   * Close all the files at the next Simulator::Destroy.
+   */
+  void ScheduleCloseAll (void);
+
+  /**
+   * Close and forget all the registered files and stop the thread.
+   */
+  void CloseAll (void);
+
+  /**
+   * Queue a block for writing.
+   * \param file the file
+   * \param index the index of the block in the ring of the file
+   */
+  void Submit (AsyncTraceFile *file, uint32_t index);
+
+  /**
+   * Wait until a block is written.
+   * \param file the file
+   * \param index the index of the block in the ring of the file
+   */
+  void WaitIdle (AsyncTraceFile *file, uint32_t index);
+
+private:
+  /**
+   * Write a block to its file.
+   * \param file the file
+   * \param block the block
+   */
+  static void WriteBlock (AsyncTraceFile *file, const AsyncTraceFile::Block &block);
+
+  std::map<std::string, Ptr<AsyncTraceFile> > m_files; ///< the registered files, by name
+  bool m_closeScheduled; ///< true if CloseAll is scheduled at Simulator::Destroy
+
+#ifdef HAVE_PTHREAD_H
+  /**
+   * The body of the writer thread
+   */
+  void Run (void);
+
+  /**
+   * Write the queued blocks and stop the thread.
+   */
+  void Stop (void);
+
+  /// Wall-clock time in ns after which a wait checks its condition again
+  static const uint64_t WAIT_NS = 10000000;
+
+  typedef std::pair<AsyncTraceFile *, uint32_t> QueuedBlock; ///< a file and the index of a block
+  std::deque<QueuedBlock> m_queue; ///< the blocks to write, in order
+  bool m_stop;                     ///< true when the thread must exit once the queue is empty
+  Ptr<SystemThread> m_thread;      ///< the writer thread, 0 when not running
+  SystemMutex m_mutex;             ///< protects m_queue, m_stop and the busy flags of the blocks
+  SystemCondition m_submitted;     ///< set when a block is queued
+  SystemCondition m_written;       ///< set when a block is written
+#endif
+};
+
+static AsyncTraceWriter g_asyncTraceWriter; ///< the writer of all the files
+
+AsyncTraceWriter::AsyncTraceWriter ()
+  : m_closeScheduled (false)
+#ifdef HAVE_PTHREAD_H
+  , m_stop (false)
+#endif
+{
+}
+
+AsyncTraceWriter::~AsyncTraceWriter ()
+{
+  CloseAll ();
+}
+
+Ptr<AsyncTraceFile>
+AsyncTraceWriter::Find (std::string filename) const
+{
+  std::map<std::string, Ptr<AsyncTraceFile> >::const_iterator it = m_files.find (filename);
+  if (it == m_files.end ())
+    {
+      return 0;
+    }
+  return it->second;
+}
+
+void
+AsyncTraceWriter::Register (Ptr<AsyncTraceFile> file)
+{
+  m_files[file->GetFilename ()] = file;
+}
+
+void
+AsyncTraceWriter::ScheduleCloseAll (void)
+{
+  if (!m_closeScheduled)
+    {
+      Simulator::ScheduleDestroy (&AsyncTraceFile::CloseAll);
+      m_closeScheduled = true;
+    }
+}
+
+void
+AsyncTraceWriter::CloseAll (void)
+{
+  // closing a file may release the last reference to it
+  std::map<std::string, Ptr<AsyncTraceFile> > files;
+  files.swap (m_files);
+  for (std::map<std::string, Ptr<AsyncTraceFile> >::iterator it = files.begin (); it != files.end (); ++it)
+    {
+      it->second->Close ();
+    }
+  m_closeScheduled = false;
+#ifdef HAVE_PTHREAD_H
+  Stop ();
+#endif
+}
+
+void
+AsyncTraceWriter::WriteBlock (AsyncTraceFile *file, const AsyncTraceFile::Block &block)
+{
+  if (std::fwrite (&block.m_data[0], 1, block.m_size, file->m_file) != block.m_size)
+    {
+      NS_FATAL_ERROR ("Error writing to trace file " << file->m_filename);
+    }
+}
+
+#ifdef HAVE_PTHREAD_H
+
+void
+AsyncTraceWriter::Submit (AsyncTraceFile *file, uint32_t index)
+{
+  m_mutex.Lock ();
+  file->m_blocks[index].m_busy = true;
+  m_queue.push_back (QueuedBlock (file, index));
+  m_mutex.Unlock ();
+  if (m_thread == 0)
+    {
+      m_thread = Create<SystemThread> (MakeCallback (&AsyncTraceWriter::Run, this));
+      m_thread->Start ();
+    }
+  m_submitted.SetCondition (true);
+  m_submitted.Signal ();
+}
+
+void
+AsyncTraceWriter::WaitIdle (AsyncTraceFile *file, uint32_t index)
+{
+  const AsyncTraceFile::Block &block = file->m_blocks[index];
+  while (true)
+    {
+      // the condition is reset before the check, so a block written
+      // after the check sets it again and the wait does not block
+      m_written.SetCondition (false);
+      m_mutex.Lock ();
+      bool busy = block.m_busy;
+      m_mutex.Unlock ();
+      if (!busy)
+        {
+          return;
+        }
+      m_written.TimedWait (WAIT_NS);
+    }
+}
+
+void
+AsyncTraceWriter::Run (void)
+{
+  while (true)
+    {
+      m_submitted.SetCondition (false);
+      m_mutex.Lock ();
+      if (m_queue.empty ())
+        {
+          bool stop = m_stop;
+          m_mutex.Unlock ();
+          if (stop)
+            {
+              return;
+            }
+          m_submitted.TimedWait (WAIT_NS);
+          continue;
+        }
+      QueuedBlock queued = m_queue.front ();
+      m_queue.pop_front ();
+      m_mutex.Unlock ();
+
+      AsyncTraceFile::Block &block = queued.first->m_blocks[queued.second];
+      WriteBlock (queued.first, block);
+
+      m_mutex.Lock ();
+      block.m_busy = false;
+      m_mutex.Unlock ();
+      m_written.SetCondition (true);
+      m_written.Signal ();
+    }
+}
+
+void
+AsyncTraceWriter::Stop (void)
+{
+  if (m_thread == 0)
+    {
+      return;
+    }
+  m_mutex.Lock ();
+  m_stop = true;
+  m_mutex.Unlock ();
+  m_submitted.SetCondition (true);
+  m_submitted.Signal ();
+  m_thread->Join ();
+  m_thread = 0;
+  m_stop = false;
+}
+
+#else /* HAVE_PTHREAD_H */
+
+void
+AsyncTraceWriter::Submit (AsyncTraceFile *file, uint32_t index)
+{
+  WriteBlock (file, file->m_blocks[index]);
+}
+
+void
+AsyncTraceWriter::WaitIdle (AsyncTraceFile *file, uint32_t index)
+{
+}
+
+#endif /* HAVE_PTHREAD_H */
+
+
+AsyncTraceFile::BlockBuffer::BlockBuffer (AsyncTraceFile *file)
+  : m_file (file)
+{
+}
+
+void
+AsyncTraceFile::BlockBuffer::SetBlock (char *block)
+{
+  setp (block, block + BLOCK_SIZE);
+}
+
+uint32_t
+AsyncTraceFile::BlockBuffer::GetUsed (void) const
+{
+  return pptr () - pbase ();
+}
+
+AsyncTraceFile::BlockBuffer::int_type
+AsyncTraceFile::BlockBuffer::overflow (int_type c)
+{
+  m_file->SubmitBlock ();
+  if (!traits_type::eq_int_type (c, traits_type::eof ()))
+    {
+      *pptr () = traits_type::to_char_type (c);
+      pbump (1);
+    }
+  return traits_type::not_eof (c);
+}
+
+std::streamsize
+AsyncTraceFile::BlockBuffer::xsputn (const char *s, std::streamsize n)
+{
+  std::streamsize done = 0;
+  while (done < n)
+    {
+      std::streamsize room = epptr () - pptr ();
+      if (room == 0)
+        {
+          m_file->SubmitBlock ();
+          continue;
+        }
+      std::streamsize chunk = std::min (room, n - done);
+      std::memcpy (pptr (), s + done, chunk);
+      pbump (chunk);
+      done += chunk;
+    }
+  return n;
+}
+
+int
+AsyncTraceFile::BlockBuffer::sync (void)
+{
+  // the blocks are written when they are full, not at every std::endl
+  return 0;
+}
+
+
+Ptr<AsyncTraceFile>
+AsyncTraceFile::Open (std::string filename, Encoding encoding, bool append)
+{
+  NS_LOG_FUNCTION (filename << encoding << append);
+  Ptr<AsyncTraceFile> file = g_asyncTraceWriter.Find (filename);
+  if (file == 0)
+    {
+      file = Ptr<AsyncTraceFile> (new AsyncTraceFile (filename, encoding), false);
+    }
+  NS_ABORT_MSG_IF (file->m_encoding != encoding, "Trace file " << filename << " is already open with another encoding");
+  file->DoOpen (append);
+  g_asyncTraceWriter.ScheduleCloseAll ();
+  return file;
+}
+
+void
+AsyncTraceFile::CloseAll (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  g_asyncTraceWriter.CloseAll ();
+}
+
+AsyncTraceFile::AsyncTraceFile (std::string filename, Encoding encoding)
+  : m_filename (filename),
+    m_encoding (encoding),
+    m_file (0),
+    m_blocks (BLOCKS_PER_FILE),
+    m_current (0),
+    m_submitted (0),
+    m_buffer (this),
+    m_stream (&m_buffer)
+{
+  NS_LOG_FUNCTION (this << filename << encoding);
+  for (std::vector<Block>::iterator it = m_blocks.begin (); it != m_blocks.end (); ++it)
+    {
+      it->m_data.resize (BLOCK_SIZE);
+      it->m_size = 0;
+      it->m_busy = false;
+    }
+  m_buffer.SetBlock (&m_blocks[m_current].m_data[0]);
+}
+
+AsyncTraceFile::~AsyncTraceFile ()
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+}
+
+std::string
+AsyncTraceFile::GetFilename (void) const
+{
+  return m_filename;
+}
+
+AsyncTraceFile::Encoding
+AsyncTraceFile::GetEncoding (void) const
+{
+  return m_encoding;
+}
+
+void
+AsyncTraceFile::DoOpen (bool append)
+{
+  if (m_file != 0)
+    {
+      return;
+    }
+  NS_LOG_FUNCTION (this << m_filename << append);
+  const char *mode;
+  if (m_encoding == TEXT)
+    {
+      mode = append ? "a" : "w";
+    }
+  else
+    {
+      mode = append ? "ab" : "wb";
+    }
+  m_file = std::fopen (m_filename.c_str (), mode);
+  if (m_file == 0)
+    {
+      NS_FATAL_ERROR ("Could not open trace file " << m_filename);
+    }
+  // the blocks are already large, the stdio buffer would only add a copy
+  std::setvbuf (m_file, 0, _IONBF, 0);
+  g_asyncTraceWriter.Register (this);
+}
+
+std::ostream&
+AsyncTraceFile::GetStream (void)
+{
+  NS_ASSERT_MSG (m_encoding == TEXT, "Trace file " << m_filename << " is not a text file");
+  DoOpen (true);
+  return m_stream;
+}
+
+void
+AsyncTraceFile::Write (const void *data, uint32_t size)
+{
+  DoOpen (true);
+  m_buffer.sputn (static_cast<const char *> (data), size);
+}
+
+uint64_t
+AsyncTraceFile::GetSize (void) const
+{
+  return m_submitted + m_buffer.GetUsed ();
+}
+
+void
+AsyncTraceFile::SubmitBlock (void)
+{
+  uint32_t used = m_buffer.GetUsed ();
+  if (used == 0)
+    {
+      return;
+    }
+  DoOpen (true);
+  m_blocks[m_current].m_size = used;
+  m_submitted += used;
+  g_asyncTraceWriter.Submit (this, m_current);
+  m_current = (m_current + 1) % BLOCKS_PER_FILE;
+  g_asyncTraceWriter.WaitIdle (this, m_current);
+  m_buffer.SetBlock (&m_blocks[m_current].m_data[0]);
+}
+
+void
+AsyncTraceFile::Flush (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_file != 0)
+    {
+      SubmitBlock ();
+    }
+}
+
+void
+AsyncTraceFile::Close (void)
+{
+  if (m_file == 0)
+    {
+      return;
+    }
+  NS_LOG_FUNCTION (this << m_filename);
+  if (!m_closeCallback.IsNull ())
+    {
+      m_closeCallback ();
+    }
+  SubmitBlock ();
+  for (uint32_t i = 0; i < BLOCKS_PER_FILE; i++)
+    {
+      g_asyncTraceWriter.WaitIdle (this, i);
+    }
+  std::fclose (m_file);
+  m_file = 0;
+}
+
+void
+AsyncTraceFile::SetCloseCallback (Callback<void> cb)
+{
+  m_closeCallback = cb;
+}
+
+} // namespace ns3
@@ -0,0 +1,213 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ASYNC_TRACE_FILE_H
+#define ASYNC_TRACE_FILE_H
+
+#include "ns3/simple-ref-count.h"
+#include "ns3/ptr.h"
+#include "ns3/callback.h"
+
+#include <cstdio>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup stats
+ *
+ * \brief A trace output file written in large blocks by a background thread
+ *
+ * The records are formatted on the simulator thread into the blocks of a
+ * ring owned by the file. When a block is full it is handed to a writer
+ * thread, shared by all the files, that writes it with a single fwrite and
+ * gives it back to the ring; the simulator thread only waits when the
+ * whole ring is waiting to be written. Without thread support the full
+ * blocks are written on the simulator thread, still in large writes.
+ *
+ * A TEXT file is written through an std::ostream, with the same formatting
+ * as an std::ofstream; std::endl does not flush it. A BINARY file is
+ * written with Write and WriteValue, which copy the raw bytes.
+ *
+ * The files are shared by name: opening a file that is already open
+ * returns the same object, so that all the writers of a file share its
+ * buffers and their records are not interleaved. All the files are
+ * flushed and closed when the simulator is destroyed and at exit; a file
+ * written after it was closed is reopened in append mode.
+ */
+class AsyncTraceFile : public SimpleRefCount<AsyncTraceFile>
+{
+public:
+  /// The encoding of the records of a file.
+  enum Encoding
+  {
+    TEXT,
+    BINARY
+  };
+
+  /// The size in bytes of a block.
+  static const uint32_t BLOCK_SIZE = 1 << 16;
+  /// The number of blocks of the ring of a file.
+  static const uint32_t BLOCKS_PER_FILE = 4;
+
+  /**
+   * \param filename the name of the file
+   * \param encoding the encoding of the records
+   * \param append true to append to an existing file rather than truncate it
+   * \return the file, which is shared with the other writers if it is already open
+   */
+  static Ptr<AsyncTraceFile> Open (std::string filename, Encoding encoding = TEXT, bool append = false);
+
+  /**
+   * Write the buffered records of all the files and close them.
+   */
+  static void CloseAll (void);
+
+  ~AsyncTraceFile ();
+
+  /**
+   * \return the name of the file
+   */
+  std::string GetFilename (void) const;
+
+  /**
+   * \return the encoding of the records
+   */
+  Encoding GetEncoding (void) const;
+
+  /**
+   * \return the stream formatting the records of a TEXT file
+   */
+  std::ostream& GetStream (void);
+
+  /**
+   * Append raw bytes to the file.
+   * \param data the bytes
+   * \param size the number of bytes
+   */
+  void Write (const void *data, uint32_t size);
+
+  /**
+   * Append the raw representation of a value to the file.
+   * \param value the value, of a trivially copyable type
+   */
+  template <typename T>
+  void WriteValue (T value);
+
+  /**
+   * \return the number of bytes appended since the file was opened,
+   * including the ones not written yet
+   */
+  uint64_t GetSize (void) const;
+
+  /**
+   * Hand the records buffered so far to the writer thread.
+   */
+  void Flush (void);
+
+  /**
+   * Write the buffered records and close the file.
+   */
+  void Close (void);
+
+  /**
+   * Set the callback invoked when the file is about to be closed, which
+   * lets a writer that keeps records of its own append them first.
+   * \param cb the callback, or a null callback to remove it
+   */
+  void SetCloseCallback (Callback<void> cb);
+
+private:
+  friend class AsyncTraceWriter;
+
+  /**
+   * The stream buffer putting the records into the current block
+   */
+  class BlockBuffer : public std::streambuf
+  {
+  public:
+    /**
+     * \param file the file owning the blocks
+     */
+    BlockBuffer (AsyncTraceFile *file);
+    /**
+     * Point the put area to a block.
+     * \param block the start of the block
+     */
+    void SetBlock (char *block);
+    /**
+     * \return the number of bytes put into the current block
+     */
+    uint32_t GetUsed (void) const;
+  protected:
+    virtual int_type overflow (int_type c);
+    virtual std::streamsize xsputn (const char *s, std::streamsize n);
+    virtual int sync (void);
+  private:
+    AsyncTraceFile *m_file; ///< the file owning the blocks
+  };
+
+  /**
+   * A block of the ring
+   */
+  struct Block
+  {
+    std::vector<char> m_data; ///< the storage, of BLOCK_SIZE bytes
+    uint32_t m_size;          ///< number of bytes to write
+    bool m_busy;              ///< true while the block waits for the writer thread
+  };
+
+  /**
+   * \param filename the name of the file
+   * \param encoding the encoding of the records
+   */
+  AsyncTraceFile (std::string filename, Encoding encoding);
+
+  /**
+   * Open the underlying file, if it is closed.
+   * \param append true to append to an existing file
+   */
+  void DoOpen (bool append);
+
+  /**
+   * Hand the current block to the writer and move to the next one of the ring.
+   */
+  void SubmitBlock (void);
+
+  std::string m_filename;        ///< the name of the file
+  Encoding m_encoding;           ///< the encoding of the records
+  std::FILE *m_file;             ///< the underlying file, 0 when closed
+  std::vector<Block> m_blocks;   ///< the ring of blocks
+  uint32_t m_current;            ///< index of the block being filled
+  uint64_t m_submitted;          ///< bytes of the blocks handed to the writer
+  BlockBuffer m_buffer;          ///< the stream buffer over the current block
+  std::ostream m_stream;         ///< the stream formatting the TEXT records
+  Callback<void> m_closeCallback; ///< invoked before closing the file
+};
+
+template <typename T>
+void
+AsyncTraceFile::WriteValue (T value)
+{
+  Write (&value, sizeof (T));
+}
+
+} // namespace ns3
+
+#endif /* ASYNC_TRACE_FILE_H */
@@ -0,0 +1,286 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "columnar-trace-file.h"
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "ns3/fatal-error.h"
+
+#include <cstring>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("ColumnarTraceFile");
+
+uint32_t
+ColumnarTraceFile::GetTypeSize (ColumnType type)
+{
+  switch (type)
+    {
+    case UINT8:
+      return 1;
+    case UINT16:
+      return 2;
+    case UINT32:
+    case INT32:
+      return 4;
+    case UINT64:
+    case DOUBLE:
+      return 8;
+    }
+  NS_FATAL_ERROR ("Unknown column type " << type);
+  return 0;
+}
+
+double
+ColumnarTraceFile::DecodeValue (ColumnType type, const void *data)
+{
+  switch (type)
+    {
+    case UINT8:
+      {
+        uint8_t v;
+        std::memcpy (&v, data, sizeof (v));
+        return v;
+      }
+    case UINT16:
+      {
+        uint16_t v;
+        std::memcpy (&v, data, sizeof (v));
+        return v;
+      }
+    case UINT32:
+      {
+        uint32_t v;
+        std::memcpy (&v, data, sizeof (v));
+        return v;
+      }
+    case UINT64:
+      {
+        uint64_t v;
+        std::memcpy (&v, data, sizeof (v));
+        return static_cast<double> (v);
+      }
+    case INT32:
+      {
+        int32_t v;
+        std::memcpy (&v, data, sizeof (v));
+        return v;
+      }
+    case DOUBLE:
+      {
+        double v;
+        std::memcpy (&v, data, sizeof (v));
+        return v;
+      }
+    }
+  NS_FATAL_ERROR ("Unknown column type " << type);
+  return 0;
+}
+
+ColumnarTraceFile::ColumnarTraceFile (std::string filename)
+  : m_column (0),
+    m_nChunkRows (0),
+    m_nRows (0),
+    m_headerWritten (false)
+{
+  NS_LOG_FUNCTION (this << filename);
+  m_file = AsyncTraceFile::Open (filename, AsyncTraceFile::BINARY);
+  m_file->SetCloseCallback (MakeCallback (&ColumnarTraceFile::WriteChunk, this));
+}
+
+ColumnarTraceFile::~ColumnarTraceFile ()
+{
+  NS_LOG_FUNCTION (this);
+  WriteChunk ();
+  m_file->SetCloseCallback (MakeNullCallback<void> ());
+}
+
+void
+ColumnarTraceFile::AddColumn (std::string name, ColumnType type)
+{
+  NS_LOG_FUNCTION (this << name << type);
+  NS_ASSERT_MSG (!m_headerWritten, "Column " << name << " declared after the first record");
+  NS_ASSERT_MSG (name.size () <= 255, "Column name " << name << " is too long");
+  Column column;
+  column.m_name = name;
+  column.m_type = type;
+  column.m_size = GetTypeSize (type);
+  column.m_data.resize (ROWS_PER_CHUNK * column.m_size);
+  column.m_min = 0;
+  column.m_max = 0;
+  m_columns.push_back (column);
+}
+
+uint32_t
+ColumnarTraceFile::GetNColumns (void) const
+{
+  return m_columns.size ();
+}
+
+uint64_t
+ColumnarTraceFile::GetNRows (void) const
+{
+  return m_nRows;
+}
+
+void
+ColumnarTraceFile::WriteHeader (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_file->Write ("NS3COLTR", 8);
+  m_file->WriteValue<uint32_t> (VERSION);
+  m_file->WriteValue<uint32_t> (m_columns.size ());
+  for (std::vector<Column>::const_iterator it = m_columns.begin (); it != m_columns.end (); ++it)
+    {
+      m_file->WriteValue<uint8_t> (it->m_type);
+      m_file->WriteValue<uint8_t> (it->m_name.size ());
+      m_file->Write (it->m_name.data (), it->m_name.size ());
+    }
+  m_headerWritten = true;
+}
+
+void
+ColumnarTraceFile::Store (Column &column, const void *data, double value)
+{
+  std::memcpy (&column.m_data[m_nChunkRows * column.m_size], data, column.m_size);
+  if (m_nChunkRows == 0 || value < column.m_min)
+    {
+      column.m_min = value;
+    }
+  if (m_nChunkRows == 0 || value > column.m_max)
+    {
+      column.m_max = value;
+    }
+  if (++m_column == m_columns.size ())
+    {
+      m_column = 0;
+      m_nRows++;
+      if (++m_nChunkRows == ROWS_PER_CHUNK)
+        {
+          WriteChunk ();
+        }
+    }
+}
+
+ColumnarTraceFile&
+ColumnarTraceFile::PutInteger (int64_t value)
+{
+  NS_ASSERT_MSG (!m_columns.empty (), "No column declared");
+  if (!m_headerWritten)
+    {
+      WriteHeader ();
+    }
+  Column &column = m_columns[m_column];
+  switch (column.m_type)
+    {
+    case UINT8:
+      {
+        uint8_t v = value;
+        Store (column, &v, v);
+        break;
+      }
+    case UINT16:
+      {
+        uint16_t v = value;
+        Store (column, &v, v);
+        break;
+      }
+    case UINT32:
+      {
+        uint32_t v = value;
+        Store (column, &v, v);
+        break;
+      }
+    case UINT64:
+      {
+        uint64_t v = value;
+        Store (column, &v, static_cast<double> (v));
+        break;
+      }
+    case INT32:
+      {
+        int32_t v = value;
+        Store (column, &v, v);
+        break;
+      }
+    case DOUBLE:
+      {
+        double v = static_cast<double> (value);
+        Store (column, &v, v);
+        break;
+      }
+    }
+  return *this;
+}
+
+ColumnarTraceFile&
+ColumnarTraceFile::PutDouble (double value)
+{
+  NS_ASSERT_MSG (!m_columns.empty (), "No column declared");
+  if (m_columns[m_column].m_type != DOUBLE)
+    {
+      return PutInteger (static_cast<int64_t> (value));
+    }
+  if (!m_headerWritten)
+    {
+      WriteHeader ();
+    }
+  Store (m_columns[m_column], &value, value);
+  return *this;
+}
+
+void
+ColumnarTraceFile::WriteChunk (void)
+{
+  if (!m_headerWritten)
+    {
+      // an empty file still tells its columns
+      WriteHeader ();
+    }
+  if (m_nChunkRows == 0)
+    {
+      return;
+    }
+  NS_LOG_FUNCTION (this << m_nChunkRows);
+  uint32_t size = m_columns.size () * 2 * sizeof (double);
+  for (std::vector<Column>::const_iterator it = m_columns.begin (); it != m_columns.end (); ++it)
+    {
+      size += m_nChunkRows * it->m_size;
+    }
+  m_file->WriteValue<uint32_t> (m_nChunkRows);
+  m_file->WriteValue<uint32_t> (size);
+  for (std::vector<Column>::const_iterator it = m_columns.begin (); it != m_columns.end (); ++it)
+    {
+      m_file->WriteValue<double> (it->m_min);
+      m_file->WriteValue<double> (it->m_max);
+    }
+  for (std::vector<Column>::const_iterator it = m_columns.begin (); it != m_columns.end (); ++it)
+    {
+      m_file->Write (&it->m_data[0], m_nChunkRows * it->m_size);
+    }
+
+  // the values of an incomplete record start the next chunk
+  for (uint32_t i = 0; i < m_column; i++)
+    {
+      Column &column = m_columns[i];
+      std::memmove (&column.m_data[0], &column.m_data[m_nChunkRows * column.m_size], column.m_size);
+      column.m_min = column.m_max = DecodeValue (column.m_type, &column.m_data[0]);
+    }
+  m_nChunkRows = 0;
+}
+
+} // namespace ns3
@@ -0,0 +1,191 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef COLUMNAR_TRACE_FILE_H
+#define COLUMNAR_TRACE_FILE_H
+
+#include "ns3/async-trace-file.h"
+#include "ns3/simple-ref-count.h"
+#include "ns3/ptr.h"
+
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup stats
+ *
+ * \brief A trace file storing typed records column by column
+ *
+ * The file starts with a header listing the name and type of each column.
+ * The records follow in chunks of at most ROWS_PER_CHUNK rows; a chunk
+ * stores the minimum and maximum value of each of its columns, then the
+ * values of each column one after the other. A reader filtering on a
+ * range of values of some columns, e.g. a time interval or a cell, can
+ * therefore skip the chunks that cannot match without reading them.
+ *
+ * All the fields are in the byte order of the host; a reader on a host of
+ * the other byte order rejects the file.
+ *
+ * Header:
+ * - char[8]  "NS3COLTR"
+ * - uint32_t VERSION
+ * - uint32_t number of columns
+ * - per column: uint8_t type, uint8_t length of the name, the name
+ *
+ * Chunk:
+ * - uint32_t number of rows
+ * - uint32_t number of bytes following this field in the chunk
+ * - per column: double minimum, double maximum
+ * - per column: the values of the rows
+ *
+ * The columns are declared with AddColumn before the first record. A
+ * record is appended with one Put per column, in the order of the
+ * columns. The file is written through an AsyncTraceFile, and the last
+ * chunk is written when the file is closed.
+ */
+class ColumnarTraceFile : public SimpleRefCount<ColumnarTraceFile>
+{
+public:
+  /// The type of the values of a column.
+  enum ColumnType
+  {
+    UINT8 = 0,
+    UINT16 = 1,
+    UINT32 = 2,
+    UINT64 = 3,
+    INT32 = 4,
+    DOUBLE = 5
+  };
+
+  /// The version of the format written in the header.
+  static const uint32_t VERSION = 1;
+  /// The maximum number of rows of a chunk.
+  static const uint32_t ROWS_PER_CHUNK = 4096;
+
+  /**
+   * \param type the type of a column
+   * \return the size in bytes of a value of that type
+   */
+  static uint32_t GetTypeSize (ColumnType type);
+
+  /**
+   * \param type the type of a value
+   * \param data the value, in the byte order of the host
+   * \return the value converted to double
+   */
+  static double DecodeValue (ColumnType type, const void *data);
+
+  /**
+   * \param filename the name of the file, which is truncated
+   */
+  ColumnarTraceFile (std::string filename);
+  ~ColumnarTraceFile ();
+
+  /**
+   * Declare the next column.
+   * \param name the name of the column
+   * \param type the type of its values
+   */
+  void AddColumn (std::string name, ColumnType type);
+
+  /**
+   * \return the number of columns
+   */
+  uint32_t GetNColumns (void) const;
+
+  /**
+   * Set the value of the next column of the current record. The value is
+   * converted to the type of the column; the record is complete when all
+   * its columns are set.
+   * \param value the value
+   * \return this file, to chain the values of a record
+   */
+  template <typename T>
+  ColumnarTraceFile& Put (T value);
+
+  /**
+   * \return the number of complete records appended
+   */
+  uint64_t GetNRows (void) const;
+
+  /**
+   * Write the chunk of the complete records not written yet.
+   */
+  void WriteChunk (void);
+
+private:
+  /**
+   * The declaration and the values of a column
+   */
+  struct Column
+  {
+    std::string m_name;        ///< the name of the column
+    ColumnType m_type;         ///< the type of the values
+    uint32_t m_size;           ///< the size of a value
+    std::vector<char> m_data;  ///< the values of the current chunk
+    double m_min;              ///< the minimum value of the current chunk
+    double m_max;              ///< the maximum value of the current chunk
+  };
+
+  /**
+   * Set the next column to an integer value.
+   * \param value the value
+   * \return this file
+   */
+  ColumnarTraceFile& PutInteger (int64_t value);
+  /**
+   * Set the next column to a floating point value.
+   * \param value the value
+   * \return this file
+   */
+  ColumnarTraceFile& PutDouble (double value);
+  /**
+   * Store the value of the next column.
+   * \param column the column
+   * \param data the value, in the type of the column
+   * \param value the value, to update the range of the chunk
+   */
+  void Store (Column &column, const void *data, double value);
+  /**
+   * Write the header of the file.
+   */
+  void WriteHeader (void);
+
+  Ptr<AsyncTraceFile> m_file;     ///< the underlying file
+  std::vector<Column> m_columns;  ///< the columns
+  uint32_t m_column;              ///< the index of the next column to set
+  uint32_t m_nChunkRows;          ///< the number of rows of the current chunk
+  uint64_t m_nRows;               ///< the number of complete records
+  bool m_headerWritten;           ///< true once the header is written
+};
+
+template <typename T>
+ColumnarTraceFile&
+ColumnarTraceFile::Put (T value)
+{
+  if (std::numeric_limits<T>::is_integer)
+    {
+      return PutInteger (static_cast<int64_t> (value));
+    }
+  return PutDouble (static_cast<double> (value));
+}
+
+} // namespace ns3
+
+#endif /* COLUMNAR_TRACE_FILE_H */
@@ -0,0 +1,295 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "columnar-trace-reader.h"
+#include "ns3/log.h"
+#include "ns3/assert.h"
+
+#include <cstring>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("ColumnarTraceReader");
+
+/**
+ * Read a value in the byte order of the host.
+ * \param in the stream
+ * \param value the value read
+ * \return true on success
+ */
+template <typename T>
+static bool
+ReadValue (std::istream &in, T &value)
+{
+  return in.read (reinterpret_cast<char *> (&value), sizeof (T)).good ();
+}
+
+ColumnarTraceReader::ColumnarTraceReader ()
+  : m_nChunkRows (0),
+    m_row (0),
+    m_nChunksRead (0),
+    m_nChunksSkipped (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+ColumnarTraceReader::~ColumnarTraceReader ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+bool
+ColumnarTraceReader::Open (std::string filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  Close ();
+  m_file.open (filename.c_str (), std::ios_base::in | std::ios_base::binary);
+  char magic[8];
+  uint32_t version;
+  uint32_t nColumns;
+  if (!m_file.read (magic, sizeof (magic)).good ()
+      || std::memcmp (magic, "NS3COLTR", sizeof (magic)) != 0
+      || !ReadValue (m_file, version) || version != ColumnarTraceFile::VERSION
+      || !ReadValue (m_file, nColumns))
+    {
+      NS_LOG_WARN ("Not a columnar trace file: " << filename);
+      Close ();
+      return false;
+    }
+  for (uint32_t i = 0; i < nColumns; i++)
+    {
+      uint8_t type;
+      uint8_t length;
+      char name[256];
+      if (!ReadValue (m_file, type) || type > ColumnarTraceFile::DOUBLE
+          || !ReadValue (m_file, length) || !m_file.read (name, length).good ())
+        {
+          NS_LOG_WARN ("Truncated header in " << filename);
+          Close ();
+          return false;
+        }
+      Column column;
+      column.m_name = std::string (name, length);
+      column.m_type = static_cast<ColumnarTraceFile::ColumnType> (type);
+      column.m_size = ColumnarTraceFile::GetTypeSize (column.m_type);
+      m_columns.push_back (column);
+    }
+  m_firstChunk = m_file.tellg ();
+  return true;
+}
+
+void
+ColumnarTraceReader::Close (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_file.is_open ())
+    {
+      m_file.close ();
+    }
+  m_file.clear ();
+  m_columns.clear ();
+  m_filters.clear ();
+  m_nChunkRows = 0;
+  m_row = 0;
+  m_nChunksRead = 0;
+  m_nChunksSkipped = 0;
+}
+
+uint32_t
+ColumnarTraceReader::GetNColumns (void) const
+{
+  return m_columns.size ();
+}
+
+std::string
+ColumnarTraceReader::GetColumnName (uint32_t column) const
+{
+  NS_ASSERT (column < m_columns.size ());
+  return m_columns[column].m_name;
+}
+
+ColumnarTraceFile::ColumnType
+ColumnarTraceReader::GetColumnType (uint32_t column) const
+{
+  NS_ASSERT (column < m_columns.size ());
+  return m_columns[column].m_type;
+}
+
+int32_t
+ColumnarTraceReader::GetColumnIndex (std::string name) const
+{
+  for (uint32_t i = 0; i < m_columns.size (); i++)
+    {
+      if (m_columns[i].m_name == name)
+        {
+          return i;
+        }
+    }
+  return -1;
+}
+
+bool
+ColumnarTraceReader::AddFilter (std::string name, double min, double max)
+{
+  NS_LOG_FUNCTION (this << name << min << max);
+  int32_t column = GetColumnIndex (name);
+  if (column < 0)
+    {
+      return false;
+    }
+  Filter filter;
+  filter.m_column = column;
+  filter.m_min = min;
+  filter.m_max = max;
+  m_filters.push_back (filter);
+  return true;
+}
+
+void
+ColumnarTraceReader::ClearFilters (void)
+{
+  m_filters.clear ();
+}
+
+void
+ColumnarTraceReader::Rewind (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_file.clear ();
+  m_file.seekg (m_firstChunk);
+  m_nChunkRows = 0;
+  m_row = 0;
+  m_nChunksRead = 0;
+  m_nChunksSkipped = 0;
+}
+
+bool
+ColumnarTraceReader::ReadChunk (void)
+{
+  while (m_file.is_open ())
+    {
+      uint32_t nRows;
+      uint32_t size;
+      if (!ReadValue (m_file, nRows) || !ReadValue (m_file, size))
+        {
+          return false;
+        }
+      bool skip = false;
+      for (uint32_t i = 0; i < m_columns.size (); i++)
+        {
+          double min;
+          double max;
+          if (!ReadValue (m_file, min) || !ReadValue (m_file, max))
+            {
+              return false;
+            }
+          for (std::vector<Filter>::const_iterator it = m_filters.begin (); it != m_filters.end (); ++it)
+            {
+              if (it->m_column == i && (max < it->m_min || min > it->m_max))
+                {
+                  skip = true;
+                }
+            }
+        }
+      uint32_t dataSize = size - m_columns.size () * 2 * sizeof (double);
+      if (skip)
+        {
+          m_nChunksSkipped++;
+          m_file.seekg (dataSize, std::ios_base::cur);
+          continue;
+        }
+      for (std::vector<Column>::iterator it = m_columns.begin (); it != m_columns.end (); ++it)
+        {
+          it->m_data.resize (nRows * it->m_size);
+          if (nRows > 0 && !m_file.read (&it->m_data[0], it->m_data.size ()).good ())
+            {
+              NS_LOG_WARN ("Truncated chunk");
+              return false;
+            }
+        }
+      m_nChunksRead++;
+      m_nChunkRows = nRows;
+      m_row = 0;
+      return true;
+    }
+  return false;
+}
+
+bool
+ColumnarTraceReader::MatchesFilters (void) const
+{
+  for (std::vector<Filter>::const_iterator it = m_filters.begin (); it != m_filters.end (); ++it)
+    {
+      double value = GetValue (it->m_column);
+      if (value < it->m_min || value > it->m_max)
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+bool
+ColumnarTraceReader::Next (void)
+{
+  while (true)
+    {
+      if (m_row + 1 < m_nChunkRows)
+        {
+          m_row++;
+        }
+      else
+        {
+          do
+            {
+              if (!ReadChunk ())
+                {
+                  m_nChunkRows = 0;
+                  m_row = 0;
+                  return false;
+                }
+            }
+          while (m_nChunkRows == 0);
+        }
+      if (MatchesFilters ())
+        {
+          return true;
+        }
+    }
+}
+
+double
+ColumnarTraceReader::GetValue (uint32_t column) const
+{
+  NS_ASSERT_MSG (m_row < m_nChunkRows, "No current record");
+  NS_ASSERT (column < m_columns.size ());
+  const Column &c = m_columns[column];
+  return ColumnarTraceFile::DecodeValue (c.m_type, &c.m_data[m_row * c.m_size]);
+}
+
+uint32_t
+ColumnarTraceReader::GetNChunksRead (void) const
+{
+  return m_nChunksRead;
+}
+
+uint32_t
+ColumnarTraceReader::GetNChunksSkipped (void) const
+{
+  return m_nChunksSkipped;
+}
+
+} // namespace ns3
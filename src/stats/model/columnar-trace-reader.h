@@ -0,0 +1,183 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef COLUMNAR_TRACE_READER_H
+#define COLUMNAR_TRACE_READER_H
+
+#include "ns3/columnar-trace-file.h"
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup stats
+ *
+ * \brief Read the records of a ColumnarTraceFile
+ *
+ * The records are read one at a time with Next, and their values are
+ * returned as double by GetValue. Filters restrict the records to a
+ * range of values of some columns, e.g. a time interval, a cell or an
+ * IMSI: the chunks whose range of values cannot match a filter are
+ * skipped without reading their records.
+ *
+ * \code
+ *   ColumnarTraceReader reader;
+ *   if (reader.Open ("DlMacStats.txt"))
+ *     {
+ *       reader.AddFilter ("cellId", 2, 2);
+ *       reader.AddFilter ("time", 1.0, 2.0);
+ *       uint32_t size = reader.GetColumnIndex ("sizeTb1");
+ *       while (reader.Next ())
+ *         {
+ *           total += reader.GetValue (size);
+ *         }
+ *     }
+ * \endcode
+ */
+class ColumnarTraceReader
+{
+public:
+  ColumnarTraceReader ();
+  ~ColumnarTraceReader ();
+
+  /**
+   * Open a file and read its columns.
+   * \param filename the name of the file
+   * \return false if the file cannot be read or is not a columnar trace
+   * of this host
+   */
+  bool Open (std::string filename);
+
+  /**
+   * Close the file.
+   */
+  void Close (void);
+
+  /**
+   * \return the number of columns
+   */
+  uint32_t GetNColumns (void) const;
+
+  /**
+   * \param column the index of a column
+   * \return the name of the column
+   */
+  std::string GetColumnName (uint32_t column) const;
+
+  /**
+   * \param column the index of a column
+   * \return the type of the column
+   */
+  ColumnarTraceFile::ColumnType GetColumnType (uint32_t column) const;
+
+  /**
+   * \param name the name of a column
+   * \return the index of the column, or -1 if there is no such column
+   */
+  int32_t GetColumnIndex (std::string name) const;
+
+  /**
+   * Keep only the records whose value of a column is in a range. The
+   * filters on several columns must all match.
+   * \param name the name of the column
+   * \param min the minimum value
+   * \param max the maximum value
+   * \return false if there is no such column
+   */
+  bool AddFilter (std::string name, double min, double max);
+
+  /**
+   * Remove all the filters.
+   */
+  void ClearFilters (void);
+
+  /**
+   * Restart from the first record, and reset the chunk counters.
+   */
+  void Rewind (void);
+
+  /**
+   * Move to the next record matching the filters.
+   * \return false at the end of the file
+   */
+  bool Next (void);
+
+  /**
+   * \param column the index of a column
+   * \return the value of the column in the current record
+   */
+  double GetValue (uint32_t column) const;
+
+  /**
+   * \return the number of chunks read since the file was opened or rewound
+   */
+  uint32_t GetNChunksRead (void) const;
+
+  /**
+   * \return the number of chunks skipped thanks to the filters since the
+   * file was opened or rewound
+   */
+  uint32_t GetNChunksSkipped (void) const;
+
+private:
+  /**
+   * A column of the file and the values of the current chunk
+   */
+  struct Column
+  {
+    std::string m_name;                   ///< the name of the column
+    ColumnarTraceFile::ColumnType m_type; ///< the type of the values
+    uint32_t m_size;                      ///< the size of a value
+    std::vector<char> m_data;             ///< the values of the current chunk
+  };
+
+  /**
+   * A range of values of a column
+   */
+  struct Filter
+  {
+    uint32_t m_column; ///< the index of the column
+    double m_min;      ///< the minimum value
+    double m_max;      ///< the maximum value
+  };
+
+  /**
+   * Read the next chunk that may match the filters.
+   * \return false at the end of the file
+   */
+  bool ReadChunk (void);
+
+  /**
+   * \return true if the current record matches the filters
+   */
+  bool MatchesFilters (void) const;
+
+  std::ifstream m_file;            ///< the file
+  std::streampos m_firstChunk;     ///< the position of the first chunk
+  std::vector<Column> m_columns;   ///< the columns
+  std::vector<Filter> m_filters;   ///< the filters
+  uint32_t m_nChunkRows;           ///< the number of records of the current chunk
+  uint32_t m_row;                  ///< the index of the current record in the chunk
+  uint32_t m_nChunksRead;          ///< the number of chunks read
+  uint32_t m_nChunksSkipped;       ///< the number of chunks skipped
+};
+
+} // namespace ns3
+
+#endif /* COLUMNAR_TRACE_READER_H */
@@ -0,0 +1,158 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <fstream>
+#include <sstream>
+#include <cstring>
+
+#include "ns3/test.h"
+#include "ns3/async-trace-file.h"
+
+using namespace ns3;
+
+/**
+ * \return the content of a file
+ */
+static std::string
+ReadFile (std::string filename)
+{
+  std::ifstream in (filename.c_str (), std::ios_base::binary);
+  std::ostringstream content;
+  content << in.rdbuf ();
+  return content.str ();
+}
+
+// ===========================================================================
+// Test case for text records spanning several rings of blocks.
+// ===========================================================================
+
+class AsyncTraceFileTextTestCase : public TestCase
+{
+public:
+  AsyncTraceFileTextTestCase ();
+  virtual ~AsyncTraceFileTextTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+AsyncTraceFileTextTestCase::AsyncTraceFileTextTestCase ()
+  : TestCase ("AsyncTraceFile text records are written in order, as formatted by an ostream")
+{
+}
+
+AsyncTraceFileTextTestCase::~AsyncTraceFileTextTestCase ()
+{
+}
+
+void
+AsyncTraceFileTextTestCase::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("async-trace-file-text.txt");
+  Ptr<AsyncTraceFile> file = AsyncTraceFile::Open (filename);
+  NS_TEST_ASSERT_MSG_EQ (AsyncTraceFile::Open (filename), file, "The same file should be shared");
+
+  std::ostringstream expected;
+  uint32_t nRecords = 3 * AsyncTraceFile::BLOCKS_PER_FILE * AsyncTraceFile::BLOCK_SIZE / 20;
+  for (uint32_t i = 0; i < nRecords; i++)
+    {
+      file->GetStream () << i / 1.0e3 << "\t" << i << "\t" << (i % 7 == 0) << std::endl;
+      expected << i / 1.0e3 << "\t" << i << "\t" << (i % 7 == 0) << std::endl;
+    }
+  NS_TEST_ASSERT_MSG_EQ (file->GetSize (), expected.str ().size (), "Wrong number of bytes appended");
+  file->Close ();
+  NS_TEST_ASSERT_MSG_EQ ((ReadFile (filename) == expected.str ()), true, "Wrong file content");
+
+  // a closed file is reopened in append mode
+  file->GetStream () << "last" << std::endl;
+  expected << "last" << std::endl;
+  AsyncTraceFile::CloseAll ();
+  NS_TEST_ASSERT_MSG_EQ ((ReadFile (filename) == expected.str ()), true, "Wrong file content after reopening");
+}
+
+// ===========================================================================
+// Test case for binary records.
+// ===========================================================================
+
+class AsyncTraceFileBinaryTestCase : public TestCase
+{
+public:
+  AsyncTraceFileBinaryTestCase ();
+  virtual ~AsyncTraceFileBinaryTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+AsyncTraceFileBinaryTestCase::AsyncTraceFileBinaryTestCase ()
+  : TestCase ("AsyncTraceFile binary records keep the raw values")
+{
+}
+
+AsyncTraceFileBinaryTestCase::~AsyncTraceFileBinaryTestCase ()
+{
+}
+
+void
+AsyncTraceFileBinaryTestCase::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("async-trace-file-binary.bin");
+  Ptr<AsyncTraceFile> file = AsyncTraceFile::Open (filename, AsyncTraceFile::BINARY);
+  uint32_t nRecords = 2 * AsyncTraceFile::BLOCKS_PER_FILE * AsyncTraceFile::BLOCK_SIZE / 14;
+  for (uint32_t i = 0; i < nRecords; i++)
+    {
+      file->WriteValue<double> (i * 0.5);
+      file->WriteValue<uint32_t> (i);
+      file->WriteValue<uint16_t> (i & 0xffff);
+    }
+  AsyncTraceFile::CloseAll ();
+
+  std::string content = ReadFile (filename);
+  NS_TEST_ASSERT_MSG_EQ (content.size (), nRecords * 14, "Wrong file size");
+  const char *p = content.data ();
+  for (uint32_t i = 0; i < nRecords && p + 14 <= content.data () + content.size (); i++)
+    {
+      double time;
+      uint32_t value;
+      uint16_t low;
+      std::memcpy (&time, p, sizeof (time));
+      std::memcpy (&value, p + 8, sizeof (value));
+      std::memcpy (&low, p + 12, sizeof (low));
+      p += 14;
+      NS_TEST_ASSERT_MSG_EQ (time, i * 0.5, "Wrong double in record " << i);
+      NS_TEST_ASSERT_MSG_EQ (value, i, "Wrong uint32_t in record " << i);
+      NS_TEST_ASSERT_MSG_EQ (low, (i & 0xffff), "Wrong uint16_t in record " << i);
+    }
+}
+
+// ===========================================================================
+// Test suite
+// ===========================================================================
+
+class AsyncTraceFileTestSuite : public TestSuite
+{
+public:
+  AsyncTraceFileTestSuite ();
+};
+
+AsyncTraceFileTestSuite::AsyncTraceFileTestSuite ()
+  : TestSuite ("async-trace-file", UNIT)
+{
+  AddTestCase (new AsyncTraceFileTextTestCase, TestCase::QUICK);
+  AddTestCase (new AsyncTraceFileBinaryTestCase, TestCase::QUICK);
+}
+
+static AsyncTraceFileTestSuite asyncTraceFileTestSuite;
@@ -0,0 +1,172 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/columnar-trace-file.h"
+#include "ns3/columnar-trace-reader.h"
+
+using namespace ns3;
+
+// ===========================================================================
+// Test case for writing records and reading them back, with and without
+// filters.
+// ===========================================================================
+
+class ColumnarTraceFileTestCase : public TestCase
+{
+public:
+  ColumnarTraceFileTestCase ();
+  virtual ~ColumnarTraceFileTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+ColumnarTraceFileTestCase::ColumnarTraceFileTestCase ()
+  : TestCase ("ColumnarTraceFile records are read back, and filtered by range")
+{
+}
+
+ColumnarTraceFileTestCase::~ColumnarTraceFileTestCase ()
+{
+}
+
+void
+ColumnarTraceFileTestCase::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("columnar-trace-file.bin");
+  // a few full chunks and an incomplete one
+  uint32_t nRecords = 5 * ColumnarTraceFile::ROWS_PER_CHUNK / 2;
+  {
+    Ptr<ColumnarTraceFile> file = Create<ColumnarTraceFile> (filename);
+    file->AddColumn ("time", ColumnarTraceFile::DOUBLE);
+    file->AddColumn ("cellId", ColumnarTraceFile::UINT16);
+    file->AddColumn ("imsi", ColumnarTraceFile::UINT64);
+    file->AddColumn ("sinr", ColumnarTraceFile::INT32);
+    file->AddColumn ("mcs", ColumnarTraceFile::UINT8);
+    for (uint32_t i = 0; i < nRecords; i++)
+      {
+        uint16_t cellId = 1 + i % 3;
+        file->Put (i * 1.0e-3).Put (cellId).Put ((uint64_t) 1 << 40 | i).Put (-(int32_t) i).Put (i % 29);
+      }
+    NS_TEST_ASSERT_MSG_EQ (file->GetNRows (), nRecords, "Wrong number of records");
+  }
+  AsyncTraceFile::CloseAll ();
+
+  ColumnarTraceReader reader;
+  NS_TEST_ASSERT_MSG_EQ (reader.Open (filename), true, "Could not open the file");
+  NS_TEST_ASSERT_MSG_EQ (reader.GetNColumns (), 5, "Wrong number of columns");
+  NS_TEST_ASSERT_MSG_EQ (reader.GetColumnName (2), "imsi", "Wrong column name");
+  NS_TEST_ASSERT_MSG_EQ (reader.GetColumnType (1), ColumnarTraceFile::UINT16, "Wrong column type");
+  NS_TEST_ASSERT_MSG_EQ (reader.GetColumnIndex ("mcs"), 4, "Wrong column index");
+  NS_TEST_ASSERT_MSG_EQ (reader.GetColumnIndex ("rnti"), -1, "Unknown column found");
+
+  uint32_t n = 0;
+  while (reader.Next ())
+    {
+      NS_TEST_ASSERT_MSG_EQ_TOL (reader.GetValue (0), n * 1.0e-3, 1e-12, "Wrong time in record " << n);
+      NS_TEST_ASSERT_MSG_EQ (reader.GetValue (1), 1 + n % 3, "Wrong cellId in record " << n);
+      NS_TEST_ASSERT_MSG_EQ (reader.GetValue (2), (double) ((uint64_t) 1 << 40 | n), "Wrong imsi in record " << n);
+      NS_TEST_ASSERT_MSG_EQ (reader.GetValue (3), -(double) n, "Wrong sinr in record " << n);
+      NS_TEST_ASSERT_MSG_EQ (reader.GetValue (4), n % 29, "Wrong mcs in record " << n);
+      n++;
+    }
+  NS_TEST_ASSERT_MSG_EQ (n, nRecords, "Wrong number of records read");
+  NS_TEST_ASSERT_MSG_EQ (reader.GetNChunksRead (), 3, "Wrong number of chunks");
+
+  // the chunks out of the time range are skipped
+  reader.Rewind ();
+  NS_TEST_ASSERT_MSG_EQ (reader.AddFilter ("time", 0.5e-3, 1.5e-3), true, "Could not add the filter");
+  NS_TEST_ASSERT_MSG_EQ (reader.AddFilter ("cellId", 3, 3), true, "Could not add the filter");
+  NS_TEST_ASSERT_MSG_EQ (reader.AddFilter ("rnti", 0, 0), false, "Filter on an unknown column");
+  n = 0;
+  while (reader.Next ())
+    {
+      n++;
+    }
+  NS_TEST_ASSERT_MSG_EQ (n, 0, "No record is in both ranges");
+
+  reader.ClearFilters ();
+  reader.Rewind ();
+  double start = 4.9995;
+  double stop = 5.9995;
+  reader.AddFilter ("time", start, stop);
+  reader.AddFilter ("cellId", 2, 2);
+  n = 0;
+  while (reader.Next ())
+    {
+      NS_TEST_ASSERT_MSG_EQ ((reader.GetValue (0) >= start && reader.GetValue (0) <= stop), true, "Record out of the time range");
+      NS_TEST_ASSERT_MSG_EQ (reader.GetValue (1), 2, "Record out of the cellId range");
+      n++;
+    }
+  NS_TEST_ASSERT_MSG_EQ (n, 333, "Wrong number of records in the ranges");
+  NS_TEST_ASSERT_MSG_EQ (reader.GetNChunksSkipped (), 2, "The chunks out of the time range were read");
+}
+
+// ===========================================================================
+// Test case for files that are not columnar traces.
+// ===========================================================================
+
+class ColumnarTraceReaderInvalidTestCase : public TestCase
+{
+public:
+  ColumnarTraceReaderInvalidTestCase ();
+  virtual ~ColumnarTraceReaderInvalidTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+ColumnarTraceReaderInvalidTestCase::ColumnarTraceReaderInvalidTestCase ()
+  : TestCase ("ColumnarTraceReader rejects the files that are not columnar traces")
+{
+}
+
+ColumnarTraceReaderInvalidTestCase::~ColumnarTraceReaderInvalidTestCase ()
+{
+}
+
+void
+ColumnarTraceReaderInvalidTestCase::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("columnar-trace-file.txt");
+  AsyncTraceFile::Open (filename)->GetStream () << "% time\tcellId\n";
+  AsyncTraceFile::CloseAll ();
+
+  ColumnarTraceReader reader;
+  NS_TEST_ASSERT_MSG_EQ (reader.Open (filename), false, "A text file was accepted");
+  NS_TEST_ASSERT_MSG_EQ (reader.Open (CreateTempDirFilename ("missing.bin")), false, "A missing file was accepted");
+  NS_TEST_ASSERT_MSG_EQ (reader.Next (), false, "A record was read from no file");
+}
+
+// ===========================================================================
+// Test suite
+// ===========================================================================
+
+class ColumnarTraceFileTestSuite : public TestSuite
+{
+public:
+  ColumnarTraceFileTestSuite ();
+};
+
+ColumnarTraceFileTestSuite::ColumnarTraceFileTestSuite ()
+  : TestSuite ("columnar-trace-file", UNIT)
+{
+  AddTestCase (new ColumnarTraceFileTestCase, TestCase::QUICK);
+  AddTestCase (new ColumnarTraceReaderInvalidTestCase, TestCase::QUICK);
+}
+
+static ColumnarTraceFileTestSuite columnarTraceFileTestSuite;
@@ -111,6 +111,7 @@ main (int argc, char *argv[])
   double simTime = 30.0;
   double distance = 30.0;
   double interPacketInterval = 50;
+  bool trafficLoad = false;
   //std::string rttFile;
 
   // Command line arguments
@@ -119,6 +120,7 @@ main (int argc, char *argv[])
   cmd.AddValue("simTime", "Total duration of the simulation [s])", simTime);
   cmd.AddValue("distance", "Distance between eNBs [m]", distance);
   cmd.AddValue("interPacketInterval", "Inter packet interval [ms])", interPacketInterval);
+  cmd.AddValue("trafficLoad", "Drive the load of the VMs by the core network traffic", trafficLoad);
   
   //cmd.AddValue("rtt_tr_name", "Name of output trace file", rttFile);
   cmd.Parse(argc, argv);
@@ -136,8 +138,16 @@ main (int argc, char *argv[])
 
   virt5gcHelper->Read();
 
-  // set standard dev
-  virt5gcHelper->DynamicLoadInit(10.0);
+  if (trafficLoad)
+    {
+      // load driven by the N2, N11 and GTP-U messages
+      virt5gcHelper->TrafficLoadInit();
+    }
+  else
+    {
+      // set standard dev
+      virt5gcHelper->DynamicLoadInit(10.0);
+    }
   // set scaling delay
   virt5gcHelper->SetAllocationDelay(0.2);
   /* SetMigrationRate (scale in, scale out)
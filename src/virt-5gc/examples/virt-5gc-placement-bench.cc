@@ -0,0 +1,182 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program benchmarks the lookups of Virt5gcVmRegistry against a scan
+// of a std::list of VMs, which is how Virt5gc kept its VMs before, and the
+// scale out / scale in of VMs with each placement policy, for a data
+// center of 'vms' VMs on PMs of 'vmsPerPm' VMs and ToRs of 'pmsPerTor' PMs.
+// Sample usage:  ./waf --run 'virt-5gc-placement-bench --vms=100000'
+
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/abort.h"
+#include "ns3/virt-5gc-vm-registry.h"
+#include "ns3/virt-5gc-placement.h"
+#include <iostream>
+#include <list>
+#include <vector>
+#include <stdlib.h> // for exit ()
+
+using namespace ns3;
+
+static uint32_t g_seed = 1;
+
+/// Linear congruential generator, so that every run sees the same VMs
+static uint32_t
+NextRandom (void)
+{
+  g_seed = g_seed * 1103515245 + 12345;
+  return g_seed >> 8;
+}
+
+static Virt5gcVm
+MakeVm (int vmId, int torId, int pmId)
+{
+  Virt5gcVm vm (vmId, torId, pmId);
+  vm.SetNodeId (NextRandom () % 2);
+  vm.SetCpuInfo (500, NextRandom () % 500);
+  vm.SetMemInfo (1024, NextRandom () % 1024);
+  vm.SetDiskInfo (10000, NextRandom () % 10000);
+  vm.SetBwInfo (1000, 0);
+  return vm;
+}
+
+/// Scale out and back in 'n' times, adding the VMs where 'placement' says
+static uint64_t
+ScaleOutIn (Ptr<Virt5gcVmRegistry> registry, Ptr<Virt5gcPlacement> placement, uint32_t n, uint32_t nVms, uint32_t &failed)
+{
+  SystemWallClockMs time;
+  time.Start ();
+  std::vector<int> added;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Ptr<Virt5gcVm> source = registry->Get (1 + NextRandom () % nVms);
+      Virt5gcVm vm (registry->GetLastVmId () + 1, source->GetToRId (), source->GetPmId ());
+      vm.SetNodeId (source->GetNodeId ());
+      vm.SetCpuInfo (source->GetCpuInfo ().first, 0);
+      vm.SetMemInfo (source->GetMemInfo ().first, 0);
+      vm.SetDiskInfo (source->GetDiskInfo ().first, 0);
+      vm.SetBwInfo (source->GetBwInfo ().first, 0);
+      int pmId = placement->SelectPm (registry, vm.GetCpuInfo ().first, vm.GetMemInfo ().first,
+                                      vm.GetDiskInfo ().first, vm.GetPmId ());
+      if (pmId < 0)
+        {
+          failed++;
+        }
+      else
+        {
+          vm.ChangePm (pmId);
+          vm.ChangeToR (registry->GetPm (pmId)->torId);
+        }
+      added.push_back (registry->Add (vm)->GetVmId ());
+      registry->SetLoad (vm.GetVmId (), 100, 256, 1000);
+    }
+  for (std::vector<int>::iterator it = added.begin (); it != added.end (); ++it)
+    {
+      registry->Remove (*it);
+    }
+  return time.End ();
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t nVms = 10000;
+  uint32_t vmsPerPm = 8;
+  uint32_t pmsPerTor = 16;
+  uint32_t n = 100000;
+  uint32_t nScale = 2000;
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark Virt5gcVmRegistry and the Virt5gc placement policies");
+  cmd.AddValue ("vms", "number of VMs", nVms);
+  cmd.AddValue ("vmsPerPm", "number of VMs per PM", vmsPerPm);
+  cmd.AddValue ("pmsPerTor", "number of PMs per ToR", pmsPerTor);
+  cmd.AddValue ("n", "number of VM lookups", n);
+  cmd.AddValue ("scale", "number of scale outs per placement policy", nScale);
+  cmd.Parse (argc, argv);
+
+  if (nVms < 1 || vmsPerPm < 1 || pmsPerTor < 1)
+    {
+      std::cerr << "Invalid arguments" << std::endl;
+      exit (1);
+    }
+
+  // leave room for half as many VMs again on every PM
+  Ptr<Virt5gcVmRegistry> registry = CreateObject<Virt5gcVmRegistry> ();
+  std::list<Virt5gcVm> vmList;
+  uint32_t nPms = (nVms + vmsPerPm - 1) / vmsPerPm;
+  for (uint32_t pm = 1; pm <= nPms; pm++)
+    {
+      registry->SetPmCapacity (pm, 1 + (pm - 1) / pmsPerTor, 500 * vmsPerPm * 3 / 2,
+                               1024 * vmsPerPm * 3 / 2, 10000 * vmsPerPm * 3 / 2);
+    }
+  for (uint32_t id = 1; id <= nVms; id++)
+    {
+      uint32_t pm = 1 + (id - 1) / vmsPerPm;
+      Virt5gcVm vm = MakeVm (id, 1 + (pm - 1) / pmsPerTor, pm);
+      registry->Add (vm);
+      vmList.push_back (vm);
+    }
+
+  std::vector<int> lookups;
+  for (uint32_t i = 0; i < 1024; i++)
+    {
+      lookups.push_back (1 + NextRandom () % nVms);
+    }
+
+  int64_t sum = 0;
+  SystemWallClockMs time;
+  time.Start ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      int vmId = lookups[i % lookups.size ()];
+      for (std::list<Virt5gcVm>::iterator it = vmList.begin (); it != vmList.end (); ++it)
+        {
+          if (it->GetVmId () == vmId)
+            {
+              sum += it->GetMemInfo ().second;
+              break;
+            }
+        }
+    }
+  uint64_t listMs = time.End ();
+
+  time.Start ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      sum -= registry->Get (lookups[i % lookups.size ()])->GetMemInfo ().second;
+    }
+  uint64_t registryMs = time.End ();
+  NS_ABORT_IF (sum != 0);
+
+  std::cout << "VM lookups: list scan " << listMs << " ms, registry "
+            << registryMs << " ms" << std::endl;
+
+  const char *names[] = { "first fit", "best fit", "load balanced" };
+  Ptr<Virt5gcPlacement> placements[] = { CreateObject<Virt5gcFirstFitPlacement> (),
+                                         CreateObject<Virt5gcBestFitPlacement> (),
+                                         CreateObject<Virt5gcLoadBalancedPlacement> () };
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      uint32_t failed = 0;
+      uint64_t ms = ScaleOutIn (registry, placements[i], nScale, nVms, failed);
+      NS_ABORT_IF (registry->GetN () != nVms);
+      std::cout << names[i] << ": " << nScale << " scale outs and ins in " << ms << " ms, "
+                << failed << " without room" << std::endl;
+    }
+
+  return 0;
+}
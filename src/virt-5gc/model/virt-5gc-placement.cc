@@ -0,0 +1,103 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "ns3/log.h"
+
+#include "virt-5gc-placement.h"
+
+#include <limits>
+
+namespace ns3 {
+
+	NS_LOG_COMPONENT_DEFINE("Virt5gcPlacement");
+
+	NS_OBJECT_ENSURE_REGISTERED (Virt5gcPlacement);
+	NS_OBJECT_ENSURE_REGISTERED (Virt5gcFirstFitPlacement);
+	NS_OBJECT_ENSURE_REGISTERED (Virt5gcBestFitPlacement);
+	NS_OBJECT_ENSURE_REGISTERED (Virt5gcLoadBalancedPlacement);
+
+	TypeId Virt5gcPlacement::GetTypeId(void)
+	{
+		static TypeId tid = TypeId("ns3::Virt5gcPlacement")
+			.SetParent<Object> ()
+			.SetGroupName("Virt5gc");
+		return tid;
+	}
+
+	TypeId Virt5gcFirstFitPlacement::GetTypeId(void)
+	{
+		static TypeId tid = TypeId("ns3::Virt5gcFirstFitPlacement")
+			.SetParent<Virt5gcPlacement> ()
+			.SetGroupName("Virt5gc")
+			.AddConstructor<Virt5gcFirstFitPlacement> ();
+		return tid;
+	}
+
+	int
+	Virt5gcFirstFitPlacement::SelectPm (Ptr<const Virt5gcVmRegistry> registry, int cpu, int mem, int disk, int sourcePm) const
+	{
+		const Virt5gcVmRegistry::PmInfo *source = registry->GetPm(sourcePm);
+		if (source != 0) {
+			if (source->Fits(cpu, mem, disk))
+				return sourcePm;
+
+			// the ToRs only list their PMs in creation order
+			int best = -1;
+			const std::vector<int> &torPms = registry->GetTorPms(source->torId);
+			for (std::vector<int>::const_iterator it = torPms.begin(); it != torPms.end(); it++) {
+				if ((best < 0 || *it < best) && registry->GetPm(*it)->Fits(cpu, mem, disk))
+					best = *it;
+			}
+			if (best >= 0)
+				return best;
+		}
+
+		const std::map<int, Virt5gcVmRegistry::PmInfo> &pms = registry->GetPms();
+		for (std::map<int, Virt5gcVmRegistry::PmInfo>::const_iterator it = pms.begin(); it != pms.end(); it++) {
+			if (it->second.Fits(cpu, mem, disk))
+				return it->first;
+		}
+		return -1;
+	}
+
+	TypeId Virt5gcBestFitPlacement::GetTypeId(void)
+	{
+		static TypeId tid = TypeId("ns3::Virt5gcBestFitPlacement")
+			.SetParent<Virt5gcPlacement> ()
+			.SetGroupName("Virt5gc")
+			.AddConstructor<Virt5gcBestFitPlacement> ();
+		return tid;
+	}
+
+	int
+	Virt5gcBestFitPlacement::SelectPm (Ptr<const Virt5gcVmRegistry> registry, int cpu, int mem, int disk, int sourcePm) const
+	{
+		const std::set<std::pair<int, int> > &pms = registry->GetPmsByFreeMem();
+		std::set<std::pair<int, int> >::const_iterator it = pms.lower_bound(std::make_pair(mem, std::numeric_limits<int>::min()));
+		for (; it != pms.end(); it++) {
+			if (registry->GetPm(it->second)->Fits(cpu, mem, disk))
+				return it->second;
+		}
+		return -1;
+	}
+
+	TypeId Virt5gcLoadBalancedPlacement::GetTypeId(void)
+	{
+		static TypeId tid = TypeId("ns3::Virt5gcLoadBalancedPlacement")
+			.SetParent<Virt5gcPlacement> ()
+			.SetGroupName("Virt5gc")
+			.AddConstructor<Virt5gcLoadBalancedPlacement> ();
+		return tid;
+	}
+
+	int
+	Virt5gcLoadBalancedPlacement::SelectPm (Ptr<const Virt5gcVmRegistry> registry, int cpu, int mem, int disk, int sourcePm) const
+	{
+		const std::set<std::pair<int, int> > &pms = registry->GetPmsByFreeMem();
+		std::set<std::pair<int, int> >::const_reverse_iterator it;
+		for (it = pms.rbegin(); it != pms.rend() && it->first >= mem; it++) {
+			if (registry->GetPm(it->second)->Fits(cpu, mem, disk))
+				return it->second;
+		}
+		return -1;
+	}
+}
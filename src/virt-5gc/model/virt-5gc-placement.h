@@ -0,0 +1,54 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef VIRT_5GC_PLACEMENT_H
+#define VIRT_5GC_PLACEMENT_H
+
+#include "ns3/object.h"
+#include "ns3/ptr.h"
+
+#include "virt-5gc-vm-registry.h"
+
+namespace ns3 {
+
+	/* Choose the PM of a new VM, e.g. when a function scales out.
+	 * The policies only read the indexes of the registry, so a decision
+	 * does not walk the VMs.
+	 */
+	class Virt5gcPlacement : public Object
+	{
+		public:
+			static TypeId GetTypeId (void);
+
+			/* Return the PM with room for a VM of the given sizes, or -1
+			 * if there is none. The VM is copied from a VM on sourcePm.
+			 */
+			virtual int SelectPm (Ptr<const Virt5gcVmRegistry> registry, int cpu, int mem, int disk, int sourcePm) const = 0;
+	};
+
+	/* The PM of the source VM, else the first PM by id on its ToR, else
+	 * the first PM by id.
+	 */
+	class Virt5gcFirstFitPlacement : public Virt5gcPlacement
+	{
+		public:
+			static TypeId GetTypeId (void);
+			virtual int SelectPm (Ptr<const Virt5gcVmRegistry> registry, int cpu, int mem, int disk, int sourcePm) const;
+	};
+
+	/* The PM with the least free memory left that fits the VM. */
+	class Virt5gcBestFitPlacement : public Virt5gcPlacement
+	{
+		public:
+			static TypeId GetTypeId (void);
+			virtual int SelectPm (Ptr<const Virt5gcVmRegistry> registry, int cpu, int mem, int disk, int sourcePm) const;
+	};
+
+	/* The PM with the most free memory that fits the VM. */
+	class Virt5gcLoadBalancedPlacement : public Virt5gcPlacement
+	{
+		public:
+			static TypeId GetTypeId (void);
+			virtual int SelectPm (Ptr<const Virt5gcVmRegistry> registry, int cpu, int mem, int disk, int sourcePm) const;
+	};
+};
+
+#endif /* VIRT_5GC_PLACEMENT_H */
@@ -0,0 +1,248 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "ns3/log.h"
+#include "ns3/uinteger.h"
+
+#include "virt-5gc-vm-registry.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace ns3 {
+
+	NS_LOG_COMPONENT_DEFINE("Virt5gcVmRegistry");
+
+	NS_OBJECT_ENSURE_REGISTERED (Virt5gcVmRegistry);
+
+	bool
+	Virt5gcVmRegistry::PmInfo::Fits (int cpu, int mem, int disk) const
+	{
+		return cpu <= GetFreeCpu() && mem <= GetFreeMem() && disk <= GetFreeDisk();
+	}
+
+	TypeId Virt5gcVmRegistry::GetTypeId(void)
+	{
+		static TypeId tid = TypeId("ns3::Virt5gcVmRegistry")
+			.SetParent<Object> ()
+			.SetGroupName("Virt5gc")
+			.AddConstructor<Virt5gcVmRegistry> ()
+			.AddAttribute ("PmCpuCapacity",
+					"CPU capacity of a PM whose capacity is not set.",
+					UintegerValue (4000),
+					MakeUintegerAccessor (&Virt5gcVmRegistry::m_pmCpu),
+					MakeUintegerChecker<uint32_t> ())
+			.AddAttribute ("PmMemoryCapacity",
+					"Memory capacity of a PM whose capacity is not set.",
+					UintegerValue (16384),
+					MakeUintegerAccessor (&Virt5gcVmRegistry::m_pmMem),
+					MakeUintegerChecker<uint32_t> ())
+			.AddAttribute ("PmDiskCapacity",
+					"Disk capacity of a PM whose capacity is not set.",
+					UintegerValue (200000),
+					MakeUintegerAccessor (&Virt5gcVmRegistry::m_pmDisk),
+					MakeUintegerChecker<uint32_t> ());
+		return tid;
+	}
+
+	Virt5gcVmRegistry::Virt5gcVmRegistry()
+		: m_lastVmId (0)
+	{
+		NS_LOG_FUNCTION (this);
+	}
+
+	Ptr<Virt5gcVm>
+	Virt5gcVmRegistry::Add (const Virt5gcVm &vm)
+	{
+		Ptr<Virt5gcVm> newVm = CreateObject<Virt5gcVm> (vm);
+		int vmId = newVm->GetVmId();
+		NS_LOG_FUNCTION (this << vmId);
+		NS_ASSERT_MSG (m_vms.find(vmId) == m_vms.end(), "VM " << vmId << " already registered");
+
+		m_vms[vmId] = newVm;
+		m_lastVmId = std::max(m_lastVmId, vmId);
+		AddToPm(newVm);
+		return newVm;
+	}
+
+	void
+	Virt5gcVmRegistry::Remove (int vmId)
+	{
+		NS_LOG_FUNCTION (this << vmId);
+		std::unordered_map<int, Ptr<Virt5gcVm> >::iterator it = m_vms.find(vmId);
+		NS_ASSERT_MSG (it != m_vms.end(), "Unknown VM " << vmId);
+		RemoveFromPm(it->second);
+		m_vms.erase(it);
+	}
+
+	Ptr<Virt5gcVm>
+	Virt5gcVmRegistry::Get (int vmId) const
+	{
+		std::unordered_map<int, Ptr<Virt5gcVm> >::const_iterator it = m_vms.find(vmId);
+		if (it == m_vms.end())
+			return 0;
+		return it->second;
+	}
+
+	uint32_t
+	Virt5gcVmRegistry::GetN (void) const
+	{
+		return m_vms.size();
+	}
+
+	int
+	Virt5gcVmRegistry::GetLastVmId (void) const
+	{
+		return m_lastVmId;
+	}
+
+	int
+	Virt5gcVmRegistry::SetLoad (int vmId, int cpu, int mem, int disk)
+	{
+		Ptr<Virt5gcVm> vm = Get(vmId);
+		NS_ASSERT_MSG (vm != 0, "Unknown VM " << vmId);
+		PmInfo &pm = m_pms[vm->GetPmId()];
+
+		int oldMem = vm->GetMemInfo().second;
+		pm.cpuLoad += cpu - vm->GetCpuInfo().second;
+		pm.memLoad += mem - oldMem;
+		pm.diskLoad += disk - vm->GetDiskInfo().second;
+		vm->ChangeCpuLoad(cpu);
+		vm->ChangeMemLoad(mem);
+		vm->ChangeDiskLoad(disk);
+		return abs(mem - oldMem);
+	}
+
+	void
+	Virt5gcVmRegistry::MoveVm (int vmId, int pmId)
+	{
+		NS_LOG_FUNCTION (this << vmId << pmId);
+		Ptr<Virt5gcVm> vm = Get(vmId);
+		NS_ASSERT_MSG (vm != 0, "Unknown VM " << vmId);
+		RemoveFromPm(vm);
+		std::map<int, PmInfo>::const_iterator pm = m_pms.find(pmId);
+		if (pm != m_pms.end())
+			vm->ChangeToR(pm->second.torId);
+		vm->ChangePm(pmId);
+		AddToPm(vm);
+	}
+
+	void
+	Virt5gcVmRegistry::SetPmCapacity (int pmId, int torId, int cpu, int mem, int disk)
+	{
+		NS_LOG_FUNCTION (this << pmId << torId << cpu << mem << disk);
+		PmInfo &pm = GetOrCreatePm(pmId, torId);
+		int oldFree = pm.GetFreeMem();
+		pm.cpuCapacity = cpu;
+		pm.memCapacity = mem;
+		pm.diskCapacity = disk;
+		UpdateFreeMem(pmId, pm, oldFree);
+	}
+
+	const Virt5gcVmRegistry::PmInfo *
+	Virt5gcVmRegistry::GetPm (int pmId) const
+	{
+		std::map<int, PmInfo>::const_iterator it = m_pms.find(pmId);
+		if (it == m_pms.end())
+			return 0;
+		return &it->second;
+	}
+
+	const std::map<int, Virt5gcVmRegistry::PmInfo> &
+	Virt5gcVmRegistry::GetPms (void) const
+	{
+		return m_pms;
+	}
+
+	const std::vector<int> &
+	Virt5gcVmRegistry::GetTorPms (int torId) const
+	{
+		static const std::vector<int> none;
+		std::map<int, std::vector<int> >::const_iterator it = m_torPms.find(torId);
+		if (it == m_torPms.end())
+			return none;
+		return it->second;
+	}
+
+	const std::set<std::pair<int, int> > &
+	Virt5gcVmRegistry::GetPmsByFreeMem (void) const
+	{
+		return m_pmsByFreeMem;
+	}
+
+	std::list<Virt5gcVm>
+	Virt5gcVmRegistry::GetVmList (void) const
+	{
+		std::vector<int> ids;
+		ids.reserve(m_vms.size());
+		std::unordered_map<int, Ptr<Virt5gcVm> >::const_iterator it;
+		for (it = m_vms.begin(); it != m_vms.end(); it++)
+			ids.push_back(it->first);
+		std::sort(ids.begin(), ids.end());
+
+		std::list<Virt5gcVm> vms;
+		for (std::vector<int>::iterator id = ids.begin(); id != ids.end(); id++)
+			vms.push_back(*m_vms.find(*id)->second);
+		return vms;
+	}
+
+	Virt5gcVmRegistry::PmInfo &
+	Virt5gcVmRegistry::GetOrCreatePm (int pmId, int torId)
+	{
+		std::map<int, PmInfo>::iterator it = m_pms.find(pmId);
+		if (it != m_pms.end())
+			return it->second;
+
+		PmInfo pm;
+		pm.torId = torId;
+		pm.cpuCapacity = m_pmCpu;
+		pm.memCapacity = m_pmMem;
+		pm.diskCapacity = m_pmDisk;
+		pm.cpuAllocated = pm.memAllocated = pm.diskAllocated = 0;
+		pm.cpuLoad = pm.memLoad = pm.diskLoad = 0;
+		m_torPms[torId].push_back(pmId);
+		m_pmsByFreeMem.insert(std::make_pair(pm.GetFreeMem(), pmId));
+		return m_pms.insert(std::make_pair(pmId, pm)).first->second;
+	}
+
+	void
+	Virt5gcVmRegistry::UpdateFreeMem (int pmId, PmInfo &pm, int oldFree)
+	{
+		m_pmsByFreeMem.erase(std::make_pair(oldFree, pmId));
+		m_pmsByFreeMem.insert(std::make_pair(pm.GetFreeMem(), pmId));
+	}
+
+	void
+	Virt5gcVmRegistry::AddToPm (Ptr<Virt5gcVm> vm)
+	{
+		int pmId = vm->GetPmId();
+		PmInfo &pm = GetOrCreatePm(pmId, vm->GetToRId());
+		int oldFree = pm.GetFreeMem();
+		pm.vms.push_back(vm->GetVmId());
+		pm.cpuAllocated += vm->GetCpuInfo().first;
+		pm.memAllocated += vm->GetMemInfo().first;
+		pm.diskAllocated += vm->GetDiskInfo().first;
+		pm.cpuLoad += vm->GetCpuInfo().second;
+		pm.memLoad += vm->GetMemInfo().second;
+		pm.diskLoad += vm->GetDiskInfo().second;
+		UpdateFreeMem(pmId, pm, oldFree);
+	}
+
+	void
+	Virt5gcVmRegistry::RemoveFromPm (Ptr<Virt5gcVm> vm)
+	{
+		int pmId = vm->GetPmId();
+		PmInfo &pm = m_pms[pmId];
+		int oldFree = pm.GetFreeMem();
+		std::vector<int>::iterator it = std::find(pm.vms.begin(), pm.vms.end(), vm->GetVmId());
+		NS_ASSERT (it != pm.vms.end());
+		*it = pm.vms.back();
+		pm.vms.pop_back();
+		pm.cpuAllocated -= vm->GetCpuInfo().first;
+		pm.memAllocated -= vm->GetMemInfo().first;
+		pm.diskAllocated -= vm->GetDiskInfo().first;
+		pm.cpuLoad -= vm->GetCpuInfo().second;
+		pm.memLoad -= vm->GetMemInfo().second;
+		pm.diskLoad -= vm->GetDiskInfo().second;
+		UpdateFreeMem(pmId, pm, oldFree);
+	}
+}
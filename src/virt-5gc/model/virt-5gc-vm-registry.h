@@ -0,0 +1,90 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef VIRT_5GC_VM_REGISTRY_H
+#define VIRT_5GC_VM_REGISTRY_H
+
+#include <list>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+#include "ns3/object.h"
+#include "ns3/ptr.h"
+
+#include "virt-5gc-vm.h"
+
+namespace ns3 {
+
+	/* The VMs of the data center, indexed by VM id, PM and ToR.
+	 *
+	 * Each PM keeps the sum of the sizes (allocated) and of the loads of
+	 * its VMs, so the room left on a PM is known without walking its VMs.
+	 * The loads of the VMs must be changed through SetLoad to keep these
+	 * sums up to date.
+	 */
+	class Virt5gcVmRegistry : public Object
+	{
+		public:
+			/* Resources of a PM */
+			struct PmInfo
+			{
+				int torId;
+				std::vector<int> vms; // VMs hosted by the PM
+				int cpuCapacity;
+				int memCapacity;
+				int diskCapacity;
+				int cpuAllocated; // sum of the sizes of the VMs
+				int memAllocated;
+				int diskAllocated;
+				int cpuLoad; // sum of the loads of the VMs
+				int memLoad;
+				int diskLoad;
+
+				int GetFreeCpu (void) const { return cpuCapacity - cpuAllocated; }
+				int GetFreeMem (void) const { return memCapacity - memAllocated; }
+				int GetFreeDisk (void) const { return diskCapacity - diskAllocated; }
+				bool Fits (int cpu, int mem, int disk) const;
+			};
+
+			static TypeId GetTypeId (void);
+			Virt5gcVmRegistry ();
+
+			Ptr<Virt5gcVm> Add (const Virt5gcVm &vm); // add a copy of a VM, on its PM
+			void Remove (int vmId);
+			Ptr<Virt5gcVm> Get (int vmId) const; // 0 if there is no such VM
+			uint32_t GetN (void) const;
+			int GetLastVmId (void) const; // largest VM id ever added
+
+			/* Set the loads of a VM. Return the memory moved to or from the
+			 * VM, i.e. the absolute change of its memory load.
+			 */
+			int SetLoad (int vmId, int cpu, int mem, int disk);
+			void MoveVm (int vmId, int pmId); // migrate a VM to another PM
+
+			void SetPmCapacity (int pmId, int torId, int cpu, int mem, int disk);
+			const PmInfo *GetPm (int pmId) const; // 0 if there is no such PM
+			const std::map<int, PmInfo> &GetPms (void) const; // by PM id
+			const std::vector<int> &GetTorPms (int torId) const;
+			const std::set<std::pair<int, int> > &GetPmsByFreeMem (void) const; // (free memory, PM id)
+
+			std::list<Virt5gcVm> GetVmList (void) const; // copies of the VMs, by id
+
+		private:
+			PmInfo &GetOrCreatePm (int pmId, int torId);
+			void UpdateFreeMem (int pmId, PmInfo &pm, int oldFree);
+			void AddToPm (Ptr<Virt5gcVm> vm);
+			void RemoveFromPm (Ptr<Virt5gcVm> vm);
+
+			std::unordered_map<int, Ptr<Virt5gcVm> > m_vms;
+			std::map<int, PmInfo> m_pms;
+			std::map<int, std::vector<int> > m_torPms;
+			std::set<std::pair<int, int> > m_pmsByFreeMem;
+			int m_lastVmId;
+
+			uint32_t m_pmCpu; // default capacity of a PM
+			uint32_t m_pmMem;
+			uint32_t m_pmDisk;
+	};
+};
+
+#endif /* VIRT_5GC_VM_REGISTRY_H */
@@ -1,6 +1,8 @@
 /* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
 
 #include "ns3/log.h"
+#include "ns3/ngc-n2ap.h"
+#include "ns3/ngc-smf-upf-application.h"
 
 #include "virt-5gc.h"
 
@@ -15,6 +17,29 @@ namespace ns3 {
 		static TypeId tid = TypeId("ns3::Virt5gc")
 			.SetParent<Object> ()
 			.SetGroupName("Virt5gc")
+			.AddAttribute ("MessageProcessingTime",
+					"Time for a VM to process a message of the core network, "
+					"besides the time per byte (TrafficLoadInit only).",
+					TimeValue (MicroSeconds (20)),
+					MakeTimeAccessor (&Virt5gc::m_messageTime),
+					MakeTimeChecker ())
+			.AddAttribute ("ByteProcessingTime",
+					"Time for a VM to process a byte of a message (TrafficLoadInit only).",
+					TimeValue (NanoSeconds (1)),
+					MakeTimeAccessor (&Virt5gc::m_byteTime),
+					MakeTimeChecker ())
+			.AddAttribute ("LoadAveragingWindow",
+					"Time constant of the exponential average of the processing time "
+					"and bytes of a function (TrafficLoadInit only).",
+					TimeValue (MilliSeconds (100)),
+					MakeTimeAccessor (&Virt5gc::m_loadWindow),
+					MakeTimeChecker (MicroSeconds (1)))
+			.AddAttribute ("Placement",
+					"Policy choosing the PM of the VMs added by a scale out; "
+					"first fit if not set.",
+					PointerValue (),
+					MakePointerAccessor (&Virt5gc::m_placement),
+					MakePointerChecker<Virt5gcPlacement> ())
 			.AddTraceSource ("ScalingDelay", 
 					"pass scaling delay", 
 					MakeTraceSourceAccessor (&Virt5gc::m_scalingTrace),
@@ -43,6 +68,9 @@ namespace ns3 {
 		scaleOutRate = 0;
 		mmeVmN = 0;
 		pgwVmN = 0;
+		m_amfLoad.enabled = false;
+		m_smfUpfLoad.enabled = false;
+		m_vms = CreateObject<Virt5gcVmRegistry> ();
 	}
 
 
@@ -154,7 +182,7 @@ namespace ns3 {
 					break;
 				}
 			}
-			vmList.push_back(tempVm);
+			m_vms->Add(tempVm);
 		}
 	}
 
@@ -291,10 +319,8 @@ namespace ns3 {
 	}
 
 	void
-	Virt5gc::DynamicLoadInit (double std)
+	Virt5gc::OpenTraceStreams (void)
 	{
-		loadStd = std;
-
 		std::string m_loadFile = "Virt5gc-load.data";
 		AsciiTraceHelper ascii;
 		loadStream = ascii.CreateFileStream (m_loadFile.c_str());
@@ -307,11 +333,180 @@ namespace ns3 {
 		*scalingStream->GetStream() << "0.0, 2, 0, 0.0000" << std::endl;
 		*scalingStream->GetStream() << "0.0, 1, 1, 0.0000" << std::endl;
 		*scalingStream->GetStream() << "0.0, 2, 1, 0.0000" << std::endl;
+	}
 
+	void
+	Virt5gc::DynamicLoadInit (double std)
+	{
+		loadStd = std;
+		OpenTraceStreams();
 
 		Simulator::Schedule(Seconds(1.2), &Virt5gc::DynamicLoad, this);
 	}
 
+	void
+	Virt5gc::TrafficLoadInit (void)
+	{
+		NS_ASSERT_MSG (ngcHelper != 0, "Read the topology before TrafficLoadInit");
+		OpenTraceStreams();
+		InitNfLoad(m_amfLoad, 0);
+		InitNfLoad(m_smfUpfLoad, 1);
+
+		if (m_amfLoad.enabled) {
+			Ptr<NgcN2apAmf> n2apAmf = ngcHelper->GetAmfNode()->GetObject<NgcN2apAmf> ();
+			NS_ASSERT_MSG (n2apAmf != 0, "No N2AP on the AMF node");
+			n2apAmf->SetProcessingDelayCallback(MakeCallback(&Virt5gc::ProcessAmfMessage, this));
+		}
+		if (m_smfUpfLoad.enabled) {
+			Ptr<Node> upfNode = ngcHelper->GetUpfNode();
+			for (uint32_t i = 0; i < upfNode->GetNApplications(); i++) {
+				Ptr<NgcSmfUpfApplication> app = DynamicCast<NgcSmfUpfApplication> (upfNode->GetApplication(i));
+				if (app != 0)
+					app->SetProcessingDelayCallback(MakeCallback(&Virt5gc::ProcessSmfUpfMessage, this));
+			}
+		}
+	}
+
+	void
+	Virt5gc::InitNfLoad (NfLoad &nf, int component)
+	{
+		nf.enabled = false;
+		for (nf.node = nodeList.begin(); nf.node != nodeList.end(); nf.node++) {
+			if ((*nf.node).GetComponent() == component) {
+				nf.enabled = true;
+				break;
+			}
+		}
+		if (!nf.enabled) {
+			NS_LOG_WARN ("No node of component " << component << " in the topology, its load is not modeled");
+			return;
+		}
+		nf.component = component;
+		nf.busyUntil = Seconds(0);
+		nf.scalingEnd = Seconds(0);
+		nf.lastUpdate = Simulator::Now();
+		nf.busy = 0;
+		nf.bytes = 0;
+		nf.baseMem = (*nf.node).GetMemInfo().second;
+	}
+
+	Time
+	Virt5gc::ProcessAmfMessage (uint32_t size)
+	{
+		return ProcessMessage(m_amfLoad, size);
+	}
+
+	Time
+	Virt5gc::ProcessSmfUpfMessage (uint32_t size)
+	{
+		return ProcessMessage(m_smfUpfLoad, size);
+	}
+
+	/* The VMs of a function serve its messages in FIFO order, each VM adding
+	 * to the processing rate; a message arriving during a scaling waits
+	 * for its end. A function without VM is saturated and drops its
+	 * messages, which is told by a negative delay.
+	 */
+	Time
+	Virt5gc::ProcessMessage (NfLoad &nf, uint32_t size)
+	{
+		if (!nf.enabled)
+			return Seconds(0);
+
+		Time now = Simulator::Now();
+		int vmN = nf.component == 0 ? mmeVmN : pgwVmN;
+		if (vmN <= 0) {
+			NS_LOG_WARN ("No VM for component " << nf.component << ", message dropped");
+			UpdateNfLoad(nf, 0, size);
+			return Seconds(-1);
+		}
+		double service = m_messageTime.GetSeconds() + size * m_byteTime.GetSeconds();
+
+		Time start = std::max(now, std::max(nf.busyUntil, nf.scalingEnd));
+		nf.busyUntil = start + Seconds(service / vmN);
+		UpdateNfLoad(nf, service, size);
+
+		if (now >= nf.scalingEnd)
+			CheckNfLoad(nf);
+		if (!nf.checkEvent.IsRunning())
+			nf.checkEvent = Simulator::Schedule(m_loadWindow, &Virt5gc::IdleNfLoad, this, &nf);
+
+		return nf.busyUntil - now;
+	}
+
+	/* Update the exponential averages of the processing time and bytes, and
+	 * the loads of the node: CPU in units of the per-VM capacity (full
+	 * without VM), bandwidth in Mb/s, and memory grown by the bytes waiting
+	 * in the queue (in MB).
+	 */
+	void
+	Virt5gc::UpdateNfLoad (NfLoad &nf, double service, uint32_t size)
+	{
+		Time now = Simulator::Now();
+		double window = m_loadWindow.GetSeconds();
+		double decay = exp(-(now - nf.lastUpdate).GetSeconds() / window);
+		nf.busy = nf.busy * decay + service;
+		nf.bytes = nf.bytes * decay + size;
+		nf.lastUpdate = now;
+
+		Virt5gcNode &node = *nf.node;
+		int vmN = nf.component == 0 ? mmeVmN : pgwVmN;
+		double byteRate = nf.bytes / window;
+		double queued = byteRate * std::max(0.0, (nf.busyUntil - now).GetSeconds());
+		if (vmN > 0)
+			node.ChangeCpuLoad(round(nf.busy / window * node.GetCpuInfo().first / vmN));
+		else
+			node.ChangeCpuLoad(node.GetCpuInfo().first);
+		node.ChangeMemLoad(nf.baseMem + round(queued / 1e6));
+		node.SetBwInfo(node.GetBwInfo().first, round(byteRate * 8 / 1e6));
+	}
+
+	/* Scale out when a load exceeds the capacity of the function, and scale
+	 * in when the loads leave one VM idle. No decision is taken during a
+	 * scaling.
+	 */
+	void
+	Virt5gc::CheckNfLoad (NfLoad &nf)
+	{
+		Virt5gcNode &node = *nf.node;
+		int &vmN = nf.component == 0 ? mmeVmN : pgwVmN;
+		if (vmN <= 0)
+			return; // a scale out copies one of the VMs of the function
+		std::pair<int, int> cpuInfo = node.GetCpuInfo();
+		std::pair<int, int> memInfo = node.GetMemInfo();
+		std::pair<int, int> bwInfo = node.GetBwInfo();
+
+		double delay;
+		if ((cpuInfo.first < cpuInfo.second) || (memInfo.first < memInfo.second) || (bwInfo.first < bwInfo.second)) {
+			delay = ScaleNodeOut(node, vmN);
+		}
+		else if (vmN > 1 && (cpuInfo.first - cpuInfo.second) >= (cpuInfo.first / vmN)
+				&& (memInfo.first - memInfo.second) >= (memInfo.first / vmN)
+				&& (bwInfo.first - bwInfo.second) >= (bwInfo.first / vmN)) {
+			delay = ScaleNodeIn(node, vmN);
+		}
+		else {
+			return;
+		}
+
+		Time now = Simulator::Now();
+		nf.scalingEnd = now + Seconds(delay);
+		*loadStream->GetStream() << now.GetSeconds() << " " << node.GetId() << " " << node.GetCpuInfo().second << " " << node.GetMemInfo().second << " " << node.GetDiskInfo().second << std::endl;
+	}
+
+	/* Without traffic the averages only decay, so the load is checked again
+	 * once per averaging window until the function is idle.
+	 */
+	void
+	Virt5gc::IdleNfLoad (NfLoad *nf)
+	{
+		UpdateNfLoad(*nf, 0, 0);
+		if (Simulator::Now() >= nf->scalingEnd)
+			CheckNfLoad(*nf);
+		if (nf->busy > 1e-9 || nf->bytes > 1)
+			nf->checkEvent = Simulator::Schedule(m_loadWindow, &Virt5gc::IdleNfLoad, this, nf);
+	}
+
 	void
 	Virt5gc::DynamicLoad (void)
 	{
@@ -391,31 +586,31 @@ namespace ns3 {
 		return delay;
 	}
 
-	/* Find a VM list using VM IDs */
-	std::list<Virt5gcVm*>
-	Virt5gc::GetNodeVms(std::list<int> vms)
+	/* Find the VMs of a node in the registry */
+	std::vector<Ptr<Virt5gcVm> >
+	Virt5gc::GetNodeVms(const std::list<int> &vms)
 	{
-		std::list<Virt5gcVm*> tempVms;
-		std::list<Virt5gcVm>::iterator itor;
-		std::list<int>::iterator itor2;
-		for (itor = vmList.begin(); itor != vmList.end(); itor++) {
-			for (itor2 = vms.begin(); itor2 != vms.end(); itor2++) {
-				if (*itor2 == (*itor).GetVmId())
-					tempVms.push_back(&(*itor));
-			}
+		std::vector<Ptr<Virt5gcVm> > tempVms;
+		tempVms.reserve(vms.size());
+		std::list<int>::const_iterator itor;
+		for (itor = vms.begin(); itor != vms.end(); itor++) {
+			Ptr<Virt5gcVm> vm = m_vms->Get(*itor);
+			if (vm != 0)
+				tempVms.push_back(vm);
 		}
 		return tempVms;
 	}
 
 	double
-	Virt5gc::scaleIn(std::list<Virt5gcVm*> *vms, std::pair<int, int> cpuInfo, std::pair<int, int> memInfo, std::pair<int, int> diskInfo) {
+	Virt5gc::scaleIn(std::vector<Ptr<Virt5gcVm> > &vms, std::pair<int, int> cpuInfo, std::pair<int, int> memInfo, std::pair<int, int> diskInfo) {
 		
 		double delay;
 		int evenMemLoad, memCapacity, currMemLoad, memRemain, migratedLoad;
 		int evenCpuLoad, cpuCapacity, currCpuLoad, cpuRemain;
 		int evenDiskLoad, diskCapacity, currDiskLoad, diskRemain;
-		std::list<Virt5gcVm*>::iterator itor;
-		int vmsSize = vms->size();
+		int newMemLoad, newCpuLoad, newDiskLoad;
+		std::vector<Ptr<Virt5gcVm> >::iterator itor;
+		int vmsSize = vms.size();
 
 		memCapacity = memInfo.first / (vmsSize + 1);
 		cpuCapacity = cpuInfo.first / (vmsSize + 1);
@@ -428,79 +623,76 @@ namespace ns3 {
 			evenCpuLoad = cpuInfo.second / vmsSize;
 			evenDiskLoad = diskInfo.second / vmsSize;
 
-			for (itor = vms->begin(); itor != vms->end(); itor++) {
-				currMemLoad = (**itor).GetMemInfo().second;
-				migratedLoad += abs(evenMemLoad - currMemLoad);
-				(**itor).ChangeMemLoad(evenMemLoad);
-				(**itor).ChangeCpuLoad(evenCpuLoad);
-				(**itor).ChangeDiskLoad(evenDiskLoad);
-			}
+			for (itor = vms.begin(); itor != vms.end(); itor++)
+				migratedLoad += m_vms->SetLoad((*itor)->GetVmId(), evenCpuLoad, evenMemLoad, evenDiskLoad);
 		}
 		else { // distribute a load from first VM in a VM list
 			memRemain = memInfo.second;
 			cpuRemain = cpuInfo.second;
 			diskRemain = diskInfo.second;
 
-			for (itor = vms->begin(); itor != vms->end(); itor++) {
-				currMemLoad = (**itor).GetMemInfo().second;
+			for (itor = vms.begin(); itor != vms.end(); itor++) {
+				currMemLoad = (*itor)->GetMemInfo().second;
 				memRemain -= currMemLoad;
-				currCpuLoad = (**itor).GetCpuInfo().second;
+				currCpuLoad = (*itor)->GetCpuInfo().second;
 				cpuRemain -= currCpuLoad;
-				currDiskLoad = (**itor).GetDiskInfo().second;
+				currDiskLoad = (*itor)->GetDiskInfo().second;
 				diskRemain -= currDiskLoad;
 
+				newMemLoad = currMemLoad;
+				newCpuLoad = currCpuLoad;
+				newDiskLoad = currDiskLoad;
 				if (memRemain != 0) {
 					if (memRemain < (memCapacity - currMemLoad)) {
 						migratedLoad += memRemain;
-						(**itor).ChangeMemLoad(currMemLoad + memRemain);
+						newMemLoad = currMemLoad + memRemain;
 						memRemain = 0;
 					}
 					else {
 						memRemain -= (memCapacity - currMemLoad);
 						migratedLoad += (memCapacity - currMemLoad);
-						(**itor).ChangeMemLoad(memCapacity);
+						newMemLoad = memCapacity;
 					}
 				}
 				if (cpuRemain != 0) {
 					if (cpuRemain < (cpuCapacity - currCpuLoad)) {
-						(**itor).ChangeCpuLoad(currCpuLoad + cpuRemain);
+						newCpuLoad = currCpuLoad + cpuRemain;
 						cpuRemain = 0;
 					}
 					else {
 						cpuRemain -= (cpuCapacity - currCpuLoad);
-						(**itor).ChangeCpuLoad(cpuCapacity);
+						newCpuLoad = cpuCapacity;
 					}
 				}
 				if (diskRemain != 0) {
 					if (diskRemain < (diskCapacity - currDiskLoad)) {
-						(**itor).ChangeDiskLoad(currDiskLoad + diskRemain);
+						newDiskLoad = currDiskLoad + diskRemain;
 						diskRemain = 0;
 					}
 					else {
 						diskRemain -= (diskCapacity - currDiskLoad);
-						(**itor).ChangeDiskLoad(diskCapacity);
+						newDiskLoad = diskCapacity;
 					}
 				}
+				m_vms->SetLoad((*itor)->GetVmId(), newCpuLoad, newMemLoad, newDiskLoad);
 			}
 		}
 
-		if (itor == vms->end())
-			--itor;
-		delay = ScalingDelay(true, migratedLoad, (**itor).GetBwInfo().second, 0);
+		delay = ScalingDelay(true, migratedLoad, vms.back()->GetBwInfo().second, 0);
 
 		return delay;
 	}
 	
 	
+	/* The last VM of vms is the new one, registered without load */
 	double
-	Virt5gc::scaleOut(std::list<Virt5gcVm*> *vms, std::pair<int, int> cpuInfo, std::pair<int, int> memInfo, std::pair<int, int> diskInfo) {
+	Virt5gc::scaleOut(std::vector<Ptr<Virt5gcVm> > &vms, std::pair<int, int> cpuInfo, std::pair<int, int> memInfo, std::pair<int, int> diskInfo) {
 
 		double delay;
 		int evenMemLoad, memCapacity, migratedLoad;
 		int evenCpuLoad, cpuCapacity; 
 		int evenDiskLoad, diskCapacity;
-		std::list<Virt5gcVm*>::iterator itor;
-		int vmsSize = vms->size();
+		int vmsSize = vms.size();
 	
 		int newMemLoad, newCpuLoad, newDiskLoad;
 		int cpuFlag, memFlag, diskFlag;
@@ -538,42 +730,99 @@ namespace ns3 {
 		else {
 			std::cout << "Error!! scale-out rate is negative\n";
 		}
-		migratedLoad = newMemLoad;
 
-		itor = vms->end();
-		itor--;
-		(**itor).ChangeMemLoad(newMemLoad);
-		(**itor).ChangeCpuLoad(newCpuLoad);
-		(**itor).ChangeDiskLoad(newDiskLoad);
+		Ptr<Virt5gcVm> newVm = vms.back();
+		migratedLoad = m_vms->SetLoad(newVm->GetVmId(), newCpuLoad, newMemLoad, newDiskLoad);
 
-		std::list<Virt5gcVm*>::iterator itor2;
 		evenMemLoad = (memInfo.second - newMemLoad) / (vmsSize - 1);
 		evenCpuLoad = (cpuInfo.second - newCpuLoad) / (vmsSize - 1);
 		evenDiskLoad = (diskInfo.second - newDiskLoad) / (vmsSize - 1);
-		for (itor2 = vms->begin(); itor2 != itor; itor2++) {
-			(**itor2).ChangeMemLoad(evenMemLoad);
-			(**itor2).ChangeCpuLoad(evenCpuLoad);
-			(**itor2).ChangeDiskLoad(evenDiskLoad);
-		}
+		for (int i = 0; i < vmsSize - 1; i++)
+			m_vms->SetLoad(vms[i]->GetVmId(), evenCpuLoad, evenMemLoad, evenDiskLoad);
 
-		delay = ScalingDelay(false, migratedLoad, (**itor).GetBwInfo().second, 0);
+		delay = ScalingDelay(false, migratedLoad, newVm->GetBwInfo().second, 0);
 
 		return delay;
 	}
 	 
 
+	/* Add a VM to a node, copied from its first VM and placed by the
+	 * placement policy, and move part of the load to it. Return the
+	 * scaling delay.
+	 */
+	double
+	Virt5gc::ScaleNodeOut (Virt5gcNode &node, int &vmN)
+	{
+		std::pair<int, int> cpuInfo = node.GetCpuInfo();
+		std::pair<int, int> diskInfo = node.GetDiskInfo();
+		std::pair<int, int> memInfo = node.GetMemInfo();
+		int lastVmId = m_vms->GetLastVmId();
+
+		std::vector<Ptr<Virt5gcVm> > tempVms = GetNodeVms(node.GetVms());
+		Virt5gcVm newVm = *tempVms.front();
+		newVm.SetId(++lastVmId);
+		newVm.ChangeCpuLoad(0);
+		newVm.ChangeMemLoad(0);
+		newVm.ChangeDiskLoad(0);
+
+		if (m_placement == 0)
+			m_placement = CreateObject<Virt5gcFirstFitPlacement> ();
+		int pmId = m_placement->SelectPm(m_vms, newVm.GetCpuInfo().first, newVm.GetMemInfo().first, newVm.GetDiskInfo().first, newVm.GetPmId());
+		if (pmId < 0) {
+			NS_LOG_WARN ("No PM has room for VM " << lastVmId << ", keeping it on PM " << newVm.GetPmId());
+		}
+		else if (pmId != newVm.GetPmId()) {
+			newVm.ChangePm(pmId);
+			newVm.ChangeToR(m_vms->GetPm(pmId)->torId);
+		}
+		tempVms.push_back(m_vms->Add(newVm));
+
+		double delay = scaleOut(tempVms, cpuInfo, memInfo, diskInfo);
+
+		node.SetVm(lastVmId);
+		node.SetMemInfo(memInfo.first + (memInfo.first/vmN), memInfo.second);
+		node.SetCpuInfo(cpuInfo.first + (cpuInfo.first/vmN), cpuInfo.second);
+		node.SetDiskInfo(diskInfo.first + (diskInfo.first/vmN), diskInfo.second);
+		vmN++;
+
+		*scalingStream->GetStream() << Simulator::Now().GetSeconds() << ", " << node.GetId() << ", 0, " << delay << std::endl;
+		return delay;
+	}
+
+	/* Remove the last VM of a node and spread its load over the others.
+	 * Return the scaling delay.
+	 */
+	double
+	Virt5gc::ScaleNodeIn (Virt5gcNode &node, int &vmN)
+	{
+		std::pair<int, int> cpuInfo = node.GetCpuInfo();
+		std::pair<int, int> diskInfo = node.GetDiskInfo();
+		std::pair<int, int> memInfo = node.GetMemInfo();
+
+		std::vector<Ptr<Virt5gcVm> > tempVms = GetNodeVms(node.GetVms());
+		Ptr<Virt5gcVm> lastVm = tempVms.back();
+
+		node.DeleteVm(lastVm->GetVmId());
+		tempVms.pop_back();
+		m_vms->Remove(lastVm->GetVmId());
+
+		double delay = scaleIn(tempVms, cpuInfo, memInfo, diskInfo);
+
+		node.SetMemInfo(memInfo.first - (memInfo.first/vmN), memInfo.second);
+		node.SetCpuInfo(cpuInfo.first - (cpuInfo.first/vmN), cpuInfo.second);
+		node.SetDiskInfo(diskInfo.first - (diskInfo.first/vmN), diskInfo.second);
+		vmN--;
+
+		*scalingStream->GetStream() << Simulator::Now().GetSeconds() << ", " << node.GetId() << ", 1, " << delay << std::endl;
+		return delay;
+	}
+
 	static GlobalValue g_delay = GlobalValue ("scalingDelay", "scaling delay", DoubleValue (-1.0), MakeDoubleChecker<double> ());
 	static GlobalValue g_time = GlobalValue ("scalingTime", "scaling time", TimeValue(Time(0)), MakeTimeChecker());
 
 	void
 	Virt5gc::Scaling (void)
 	{
-		std::list<Virt5gcVm*>::iterator itor2;
-		std::list<Virt5gcVm>::iterator it;
-		it = vmList.end();
-		--it;
-		int lastVmId = (*it).GetVmId();
-
 		bool outFlag = false;
 		int inFlag, comp;
 		std::list<Virt5gcNode>::iterator itor;
@@ -611,49 +860,12 @@ namespace ns3 {
 				
 				// do scale out
 				if (outFlag) {
-					std::list<int> vms = (*itor).GetVms();
-					std::list<Virt5gcVm*> tempVms = GetNodeVms(vms);
-					itor2 = tempVms.begin();
-					Virt5gcVm newVm = **itor2;
-					newVm.SetId(++lastVmId);
-					tempVms.push_back(&newVm);
-					
-					mme_delay = scaleOut(&tempVms, cpuInfo, memInfo, diskInfo);
-
-					vmList.push_back(newVm);
-					
-					(*itor).SetVm(lastVmId);
-					(*itor).SetMemInfo(memInfo.first + (memInfo.first/mmeVmN), memInfo.second);
-					(*itor).SetCpuInfo(cpuInfo.first + (cpuInfo.first/mmeVmN), cpuInfo.second);
-					(*itor).SetDiskInfo(diskInfo.first + (diskInfo.first/mmeVmN), diskInfo.second);
-					mmeVmN++;
-
-					*scalingStream->GetStream() << time.GetSeconds() << ", " << (*itor).GetId() << ", 0, " << mme_delay << std::endl;
-
+					mme_delay = ScaleNodeOut(*itor, mmeVmN);
 				}
 				
 				// do scale in
 				if (inFlag == 3) {
-					std::list<int> vms = (*itor).GetVms();
-					std::list<Virt5gcVm*> tempVms = GetNodeVms(vms);
-					itor2 = tempVms.end();
-					--itor2;
-
-					(*itor).DeleteVm((**itor2).GetVmId());
-					vmList.remove(**itor2);
-					tempVms.remove(*itor2);
-
-					mme_delay = scaleIn(&tempVms, cpuInfo, memInfo, diskInfo);
-					//g_delay.SetValue(DoubleValue(mme_delay));
-					//g_time.SetValue(TimeValue(time));
-
-					(*itor).SetMemInfo(memInfo.first - (memInfo.first/mmeVmN), memInfo.second);
-					(*itor).SetCpuInfo(cpuInfo.first - (cpuInfo.first/mmeVmN), cpuInfo.second);
-					(*itor).SetDiskInfo(diskInfo.first - (diskInfo.first/mmeVmN), diskInfo.second);
-
-					mmeVmN--;
-					*scalingStream->GetStream() << time.GetSeconds() << ", " << (*itor).GetId() << ", 1, " << mme_delay << std::endl;
-
+					mme_delay = ScaleNodeIn(*itor, mmeVmN);
 				}
 
 /*
@@ -690,48 +902,12 @@ namespace ns3 {
 				}
 	
 				if (outFlag) {
-					std::list<int> vms = (*itor).GetVms();
-					std::list<Virt5gcVm*> tempVms = GetNodeVms(vms);
-					itor2 = tempVms.begin();
-
-					Virt5gcVm newVm = **itor2;
-					newVm.SetId(++lastVmId);
-					tempVms.push_back(&newVm);
-					
-					pgw_delay = scaleOut(&tempVms, cpuInfo, memInfo, diskInfo);
-
-					vmList.push_back(newVm);
-					(*itor).SetVm(lastVmId);
-					(*itor).SetMemInfo(memInfo.first + (memInfo.first/pgwVmN), memInfo.second);
-					(*itor).SetCpuInfo(cpuInfo.first + (cpuInfo.first/pgwVmN), cpuInfo.second);
-					(*itor).SetDiskInfo(diskInfo.first + (diskInfo.first/pgwVmN), diskInfo.second);
-					pgwVmN++;
-
-					*scalingStream->GetStream() << time.GetSeconds() << ", " << (*itor).GetId() << ", 0, " << pgw_delay << std::endl;
+					pgw_delay = ScaleNodeOut(*itor, pgwVmN);
 				}
 
 				// do scale in
 				if (inFlag == 3) {
-					std::list<int> vms = (*itor).GetVms();
-					std::list<Virt5gcVm*> tempVms = GetNodeVms(vms);
-					itor2 = tempVms.end();
-					--itor2;
-
-					(*itor).DeleteVm((**itor2).GetVmId());
-					vmList.remove(**itor2);
-					tempVms.remove(*itor2);
-
-					pgw_delay = scaleIn(&tempVms, cpuInfo, memInfo, diskInfo);
-					//g_delay.SetValue(DoubleValue(pgw_delay));
-					//g_time.SetValue(TimeValue(time));
-
-					(*itor).SetMemInfo(memInfo.first - (memInfo.first/pgwVmN), memInfo.second);
-					(*itor).SetCpuInfo(cpuInfo.first - (cpuInfo.first/pgwVmN), cpuInfo.second);
-					(*itor).SetDiskInfo(diskInfo.first - (diskInfo.first/pgwVmN), diskInfo.second);
-
-					pgwVmN--;
-
-					*scalingStream->GetStream() << time.GetSeconds() << ", " << (*itor).GetId() << ", 1, " << pgw_delay << std::endl;	
+					pgw_delay = ScaleNodeIn(*itor, pgwVmN);
 				}
 
 				
@@ -833,7 +1009,19 @@ namespace ns3 {
 	std::list<Virt5gcVm>
 	Virt5gc::GetVmList (void)
 	{
-		return vmList; 
+		return m_vms->GetVmList();
+	}
+
+	Ptr<Virt5gcVmRegistry>
+	Virt5gc::GetVmRegistry (void)
+	{
+		return m_vms;
+	}
+
+	void
+	Virt5gc::SetPlacement (Ptr<Virt5gcPlacement> placement)
+	{
+		m_placement = placement;
 	}
 
 	std::istream&
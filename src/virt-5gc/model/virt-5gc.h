@@ -24,6 +24,10 @@
 
 #include "virt-5gc-node.h"
 #include "virt-5gc-vm.h"
+#include "virt-5gc-vm-registry.h"
+#include "virt-5gc-placement.h"
+
+class Virt5gcLoadModelTestCase;
 
 namespace ns3 {
 
@@ -53,20 +57,58 @@ namespace ns3 {
 			NetDeviceContainer GetEnbDevs (void);
 			NetDeviceContainer GetUeDevs (void);
 			std::list<Virt5gcVm> GetVmList (void);
+			Ptr<Virt5gcVmRegistry> GetVmRegistry (void);
+			void SetPlacement (Ptr<Virt5gcPlacement> placement); // PM of the VMs added by a scale out
 
 			void DynamicLoadInit (double std);
 			void DynamicLoad (void);
 			void SetMigrationRate (double scaleIn, double scaleOut);
 			void SetAllocationDelay (double delay);
 			void Scaling (void);
-			double scaleIn(std::list<Virt5gcVm*> *vms, std::pair<int, int> cpuInfo, std::pair<int, int> memInfo, std::pair<int, int> diskInfo);
-			double scaleOut(std::list<Virt5gcVm*> *vms, std::pair<int, int> cpuInfo, std::pair<int, int> memInfo, std::pair<int, int> diskInfo);	
+			double scaleIn(std::vector<Ptr<Virt5gcVm> > &vms, std::pair<int, int> cpuInfo, std::pair<int, int> memInfo, std::pair<int, int> diskInfo);
+			double scaleOut(std::vector<Ptr<Virt5gcVm> > &vms, std::pair<int, int> cpuInfo, std::pair<int, int> memInfo, std::pair<int, int> diskInfo);	
 			//double memMigration(std::list<Virt5gcVm*> *vms, int capa, int load, bool in);
 			double ScalingDelay (bool in, int migratedLoad, int bw, int mem);
-			std::list<Virt5gcVm*> GetNodeVms(std::list<int> vms);
+			std::vector<Ptr<Virt5gcVm> > GetNodeVms(const std::list<int> &vms);
+
+			/* Drive the load of the AMF and SMF/UPF VMs by the N2, N11 and
+			 * GTP-U traffic of the core network instead of DynamicLoad: each
+			 * message is queued and processed by the VMs of its function, and
+			 * the function scales when its load crosses its capacity.
+			 * To be called after Read.
+			 */
+			void TrafficLoadInit (void);
+			Time ProcessAmfMessage (uint32_t size); // queueing and processing delay of a N2 message, negative if dropped
+			Time ProcessSmfUpfMessage (uint32_t size); // same for a GTP-U packet or N11 request (size 0)
 
 			TracedCallback<uint32_t> m_scalingTrace;
 		private:
+			friend class ::Virt5gcLoadModelTestCase;
+
+			/* Load of a core network function, driven by its traffic */
+			struct NfLoad
+			{
+				std::list<Virt5gcNode>::iterator node; // node of the function
+				int component; // 0: AMF, 1: SMF/UPF
+				bool enabled; // false if the topology has no such function
+				Time busyUntil; // end of the processing of the queued messages
+				Time scalingEnd; // end of the ongoing scaling
+				Time lastUpdate; // time of the last update of the averages
+				double busy; // averaged processing time, in VM-seconds
+				double bytes; // averaged bytes received
+				int baseMem; // memory used by the function without traffic
+				EventId checkEvent; // next check of the load without traffic
+			};
+
+			void InitNfLoad (NfLoad &nf, int component);
+			Time ProcessMessage (NfLoad &nf, uint32_t size);
+			void UpdateNfLoad (NfLoad &nf, double service, uint32_t size);
+			void CheckNfLoad (NfLoad &nf);
+			void IdleNfLoad (NfLoad *nf);
+			double ScaleNodeOut (Virt5gcNode &node, int &vmN);
+			double ScaleNodeIn (Virt5gcNode &node, int &vmN);
+			void OpenTraceStreams (void);
+
 			std::string m_inputFile;
 			std::string m_topoFile;
 
@@ -79,7 +121,8 @@ namespace ns3 {
 			Ptr<NrHelper> nrHelper;
 			Ptr<PointToPointNgcHelper> ngcHelper;
 			//Ptr<OvsPointToPointEpcHelper> epcHelper;
-			std::list<Virt5gcVm> vmList;
+			Ptr<Virt5gcVmRegistry> m_vms;
+			Ptr<Virt5gcPlacement> m_placement;
 			std::list<std::pair<int, int>> vm_nodeList;
 
 			int pgwN;
@@ -97,6 +140,12 @@ namespace ns3 {
 			Ptr<OutputStreamWrapper> loadStream;
 			Ptr<OutputStreamWrapper> scalingStream;
 
+			Time m_messageTime;
+			Time m_byteTime;
+			Time m_loadWindow;
+			NfLoad m_amfLoad;
+			NfLoad m_smfUpfLoad;
+
 			static const char COMMENT_HEADER = '#';
 
 			std::istream& getline (std::istream& is, std::string &str);
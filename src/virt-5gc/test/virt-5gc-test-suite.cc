@@ -2,6 +2,8 @@
 
 // Include a header file from your module to test.
 #include "ns3/virt-5gc.h"
+#include "ns3/virt-5gc-vm-registry.h"
+#include "ns3/virt-5gc-placement.h"
 
 // An essential include is test.h
 #include "ns3/test.h"
@@ -46,6 +48,189 @@ Virt5gcTestCase1::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ_TOL (0.01, 0.01, 0.001, "Numbers are not equal within tolerance");
 }
 
+static Virt5gcVm
+MakeVm (int vmId, int torId, int pmId, int mem, int memLoad)
+{
+  Virt5gcVm vm (vmId, torId, pmId);
+  vm.SetNodeId (0);
+  vm.SetCpuInfo (1000, 0);
+  vm.SetMemInfo (mem, memLoad);
+  vm.SetDiskInfo (1000, 0);
+  vm.SetBwInfo (1000, 0);
+  return vm;
+}
+
+// Check that the registry keeps its PM indexes in step with the VMs
+class Virt5gcVmRegistryTestCase : public TestCase
+{
+public:
+  Virt5gcVmRegistryTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+Virt5gcVmRegistryTestCase::Virt5gcVmRegistryTestCase ()
+  : TestCase ("Virt5gc VM registry indexes")
+{
+}
+
+void
+Virt5gcVmRegistryTestCase::DoRun (void)
+{
+  Ptr<Virt5gcVmRegistry> registry = CreateObject<Virt5gcVmRegistry> ();
+  registry->SetPmCapacity (1, 0, 4000, 8000, 10000);
+  registry->SetPmCapacity (2, 0, 4000, 8000, 10000);
+  registry->Add (MakeVm (1, 0, 1, 2000, 500));
+  registry->Add (MakeVm (3, 0, 1, 2000, 0));
+  registry->Add (MakeVm (2, 0, 2, 1000, 0));
+
+  NS_TEST_ASSERT_MSG_EQ (registry->GetN (), 3u, "Wrong number of VMs");
+  NS_TEST_ASSERT_MSG_EQ (registry->GetLastVmId (), 3, "Wrong last VM id");
+  NS_TEST_ASSERT_MSG_EQ (registry->Get (2)->GetPmId (), 2, "Wrong VM found by id");
+  NS_TEST_ASSERT_MSG_EQ ((registry->Get (4) == 0), true, "Unknown VM found");
+  NS_TEST_ASSERT_MSG_EQ (registry->GetPm (1)->GetFreeMem (), 4000, "Wrong free memory");
+  NS_TEST_ASSERT_MSG_EQ (registry->GetPm (1)->memLoad, 500, "Wrong memory load");
+  NS_TEST_ASSERT_MSG_EQ (registry->GetTorPms (0).size (), 2u, "Wrong PMs on the ToR");
+  NS_TEST_ASSERT_MSG_EQ (registry->GetVmList ().front ().GetVmId (), 1, "VM list not sorted by id");
+
+  NS_TEST_ASSERT_MSG_EQ (registry->SetLoad (1, 0, 200, 0), 300, "Wrong migrated memory");
+  NS_TEST_ASSERT_MSG_EQ (registry->GetPm (1)->memLoad, 200, "Load sum not updated");
+
+  registry->MoveVm (3, 2);
+  NS_TEST_ASSERT_MSG_EQ (registry->GetPm (1)->vms.size (), 1u, "VM not moved out of its PM");
+  NS_TEST_ASSERT_MSG_EQ (registry->GetPm (2)->GetFreeMem (), 5000, "VM not moved to its PM");
+  NS_TEST_ASSERT_MSG_EQ (registry->GetPmsByFreeMem ().begin ()->second, 2, "Free memory index not updated");
+
+  registry->Remove (1);
+  NS_TEST_ASSERT_MSG_EQ ((registry->Get (1) == 0), true, "VM not removed");
+  NS_TEST_ASSERT_MSG_EQ (registry->GetPm (1)->GetFreeMem (), 8000, "Removed VM still allocated");
+  NS_TEST_ASSERT_MSG_EQ (registry->GetPm (1)->memLoad, 0, "Removed VM still loaded");
+}
+
+// Check the PM chosen by each placement policy
+class Virt5gcPlacementTestCase : public TestCase
+{
+public:
+  Virt5gcPlacementTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+Virt5gcPlacementTestCase::Virt5gcPlacementTestCase ()
+  : TestCase ("Virt5gc VM placement policies")
+{
+}
+
+void
+Virt5gcPlacementTestCase::DoRun (void)
+{
+  Ptr<Virt5gcVmRegistry> registry = CreateObject<Virt5gcVmRegistry> ();
+  // PM 1 and 2 on ToR 0, PM 3 on ToR 1
+  registry->SetPmCapacity (1, 0, 4000, 4000, 10000);
+  registry->SetPmCapacity (2, 0, 4000, 8000, 10000);
+  registry->SetPmCapacity (3, 1, 4000, 6000, 10000);
+  registry->Add (MakeVm (1, 0, 1, 3000, 0));
+  registry->Add (MakeVm (2, 0, 2, 1000, 0));
+
+  Ptr<Virt5gcPlacement> firstFit = CreateObject<Virt5gcFirstFitPlacement> ();
+  Ptr<Virt5gcPlacement> bestFit = CreateObject<Virt5gcBestFitPlacement> ();
+  Ptr<Virt5gcPlacement> balanced = CreateObject<Virt5gcLoadBalancedPlacement> ();
+
+  // free memory: PM 1 1000, PM 2 7000, PM 3 6000
+  NS_TEST_ASSERT_MSG_EQ (firstFit->SelectPm (registry, 1000, 1000, 1000, 1), 1, "First fit left the source PM");
+  NS_TEST_ASSERT_MSG_EQ (firstFit->SelectPm (registry, 1000, 3000, 1000, 1), 2, "First fit left the source ToR");
+  NS_TEST_ASSERT_MSG_EQ (firstFit->SelectPm (registry, 1000, 3000, 1000, 3), 3, "First fit left the source PM");
+  NS_TEST_ASSERT_MSG_EQ (bestFit->SelectPm (registry, 1000, 3000, 1000, 1), 3, "Best fit did not take the tightest PM");
+  NS_TEST_ASSERT_MSG_EQ (balanced->SelectPm (registry, 1000, 3000, 1000, 1), 2, "Load balancing did not take the emptiest PM");
+  NS_TEST_ASSERT_MSG_EQ (bestFit->SelectPm (registry, 5000, 1000, 1000, 1), -1, "A PM fits a VM larger than any PM");
+  NS_TEST_ASSERT_MSG_EQ (balanced->SelectPm (registry, 1000, 9000, 1000, 1), -1, "A PM fits a VM larger than any PM");
+}
+
+// Check the queueing delay and the CPU load given by the traffic load model
+class Virt5gcLoadModelTestCase : public TestCase
+{
+public:
+  Virt5gcLoadModelTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void CheckQueueing (void);
+  void CheckScaling (void);
+  void CheckNoVm (void);
+
+  Ptr<Virt5gc> m_virt5gc;
+};
+
+Virt5gcLoadModelTestCase::Virt5gcLoadModelTestCase ()
+  : TestCase ("Virt5gc traffic load model")
+{
+}
+
+void
+Virt5gcLoadModelTestCase::CheckQueueing (void)
+{
+  // the messages are served in FIFO order by two VMs, 1 ms each
+  NS_TEST_ASSERT_MSG_EQ (m_virt5gc->ProcessAmfMessage (0), MicroSeconds (500), "Wrong delay of the first message");
+  NS_TEST_ASSERT_MSG_EQ (m_virt5gc->ProcessAmfMessage (0), MicroSeconds (1000), "Wrong delay of the second message");
+  NS_TEST_ASSERT_MSG_EQ (m_virt5gc->ProcessAmfMessage (0), MicroSeconds (1500), "Wrong delay of the third message");
+  // 3 ms of processing in a 100 ms window, on half of the capacity
+  NS_TEST_ASSERT_MSG_EQ (m_virt5gc->nodeList.front ().GetCpuInfo ().second, 15, "Wrong CPU load");
+  NS_TEST_ASSERT_MSG_EQ (m_virt5gc->nodeList.front ().GetMemInfo ().second, 600, "Wrong memory load");
+
+  // the SMF/UPF is not in the topology, its messages are not delayed
+  NS_TEST_ASSERT_MSG_EQ (m_virt5gc->ProcessSmfUpfMessage (100), Seconds (0), "A function out of the topology delays its messages");
+}
+
+void
+Virt5gcLoadModelTestCase::CheckScaling (void)
+{
+  // a message arriving during a scaling waits for its end
+  m_virt5gc->m_amfLoad.scalingEnd = Simulator::Now () + MilliSeconds (10);
+  NS_TEST_ASSERT_MSG_EQ (m_virt5gc->ProcessAmfMessage (0), MicroSeconds (10500), "Message not delayed by the scaling");
+}
+
+void
+Virt5gcLoadModelTestCase::CheckNoVm (void)
+{
+  // a function without VM is saturated and drops the messages
+  m_virt5gc->mmeVmN = 0;
+  NS_TEST_ASSERT_MSG_EQ (m_virt5gc->ProcessAmfMessage (0).IsStrictlyNegative (), true, "Message not dropped without VM");
+  NS_TEST_ASSERT_MSG_EQ (m_virt5gc->nodeList.front ().GetCpuInfo ().second, 1000, "Function without VM not saturated");
+}
+
+void
+Virt5gcLoadModelTestCase::DoRun (void)
+{
+  m_virt5gc = CreateObject<Virt5gc> ();
+  m_virt5gc->SetAttribute ("MessageProcessingTime", TimeValue (MilliSeconds (1)));
+  m_virt5gc->SetAttribute ("ByteProcessingTime", TimeValue (Seconds (0)));
+  m_virt5gc->SetAttribute ("LoadAveragingWindow", TimeValue (MilliSeconds (100)));
+
+  // an AMF of two VMs, whose memory load keeps it from scaling in
+  Virt5gcNode amf (1, 0, 0, 0);
+  amf.SetVm (1);
+  amf.SetVm (2);
+  amf.SetCpuInfo (1000, 0);
+  amf.SetMemInfo (1000, 600);
+  amf.SetDiskInfo (1000, 0);
+  amf.SetBwInfo (1000, 0);
+  m_virt5gc->nodeList.push_back (amf);
+  m_virt5gc->mmeN = 1;
+  m_virt5gc->mmeVmN = 2;
+  m_virt5gc->InitNfLoad (m_virt5gc->m_amfLoad, 0);
+  m_virt5gc->InitNfLoad (m_virt5gc->m_smfUpfLoad, 1);
+
+  Simulator::Schedule (Seconds (1), &Virt5gcLoadModelTestCase::CheckQueueing, this);
+  Simulator::Schedule (Seconds (2), &Virt5gcLoadModelTestCase::CheckScaling, this);
+  Simulator::Schedule (Seconds (3), &Virt5gcLoadModelTestCase::CheckNoVm, this);
+  Simulator::Stop (Seconds (4));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  m_virt5gc = 0;
+}
+
 // The TestSuite class names the TestSuite, identifies what type of TestSuite,
 // and enables the TestCases to be run.  Typically, only the constructor for
 // this class must be defined
@@ -61,6 +246,9 @@ Virt5gcTestSuite::Virt5gcTestSuite ()
 {
   // TestDuration for TestCase can be QUICK, EXTENSIVE or TAKES_FOREVER
   AddTestCase (new Virt5gcTestCase1, TestCase::QUICK);
+  AddTestCase (new Virt5gcVmRegistryTestCase, TestCase::QUICK);
+  AddTestCase (new Virt5gcPlacementTestCase, TestCase::QUICK);
+  AddTestCase (new Virt5gcLoadModelTestCase, TestCase::QUICK);
 }
 
 // Do not forget to allocate an instance of this TestSuite